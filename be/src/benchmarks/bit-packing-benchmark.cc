@@ -22,6 +22,11 @@
 //    of 32 values.
 // * UnpackScalar - an implementation that can unpack a variable number of values, using
 //   Unpack32Scalar internally.
+// * UnpackAvx2 - the same implementation, which unpacks the batches of 32 values with
+//   AVX2 if the CPU supports it.
+// * DecodeScalar / DecodeAvx2 - unpacking of dictionary indices up to bit width 16 and
+//   decoding them with a dictionary of 4 byte values, without and with AVX2.
+// The results of the scalar and the AVX2 implementations are compared before measuring.
 //
 //
 // Machine Info: Intel(R) Core(TM) i7-7700 CPU @ 3.60GHz
@@ -279,10 +284,15 @@ static_assert(NUM_OUT_VALUES % 32 == 0, "NUM_OUT_VALUES must be divisible by 32"
 
 uint32_t out_buffer[NUM_OUT_VALUES];
 
+/// Maximum bit width of the dictionary decoding benchmarks.
+constexpr int MAX_DECODE_BIT_WIDTH = 16;
+
 struct BenchmarkParams {
   int bit_width;
   const uint8_t* data;
   int64_t data_len;
+  /// Dictionary with 2^bit_width values. Only set up to MAX_DECODE_BIT_WIDTH.
+  vector<uint32_t> dict;
 };
 
 /// Legacy value-at-a-time implementation of bit unpacking. Retained here for
@@ -447,6 +457,46 @@ void UnpackBenchmark(int batch_size, void* data) {
   }
 }
 
+void UnpackScalarBenchmark(int batch_size, void* data) {
+  CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+  UnpackBenchmark(batch_size, data);
+}
+
+/// Benchmark calling UnpackAndDecodeValues() to unpack and decode 32 * 'batch_size'
+/// values.
+void DecodeBenchmark(int batch_size, void* data) {
+  BenchmarkParams* p = reinterpret_cast<BenchmarkParams*>(data);
+  const int64_t total_values_to_unpack = 32L * batch_size;
+  bool decode_error = false;
+  for (int64_t unpacked = 0; unpacked < total_values_to_unpack;
+       unpacked += NUM_OUT_VALUES) {
+    const int64_t unpack_batch =
+        min<int64_t>(NUM_OUT_VALUES, total_values_to_unpack - unpacked);
+    BitPacking::UnpackAndDecodeValues(p->bit_width, p->data, p->data_len,
+        p->dict.data(), p->dict.size(), unpack_batch, out_buffer, sizeof(uint32_t),
+        &decode_error);
+  }
+  DCHECK(!decode_error);
+}
+
+void DecodeScalarBenchmark(int batch_size, void* data) {
+  CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+  DecodeBenchmark(batch_size, data);
+}
+
+/// Runs 'fn' over all of the values of 'params' with and without AVX2 and returns true
+/// if both produced the same output.
+bool ValidateAvx2(void (*fn)(int, void*), BenchmarkParams* params) {
+  const int batch_size = NUM_OUT_VALUES / 32;
+  fn(batch_size, params);
+  vector<uint32_t> avx2_out(out_buffer, out_buffer + NUM_OUT_VALUES);
+  {
+    CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+    fn(batch_size, params);
+  }
+  return std::equal(avx2_out.begin(), avx2_out.end(), out_buffer);
+}
+
 int main(int argc, char **argv) {
   CpuInfo::Init();
   cout << endl << Benchmark::GetMachineInfo() << endl;
@@ -457,10 +507,27 @@ int main(int argc, char **argv) {
     vector<uint8_t> data(data_len);
     std::iota(data.begin(), data.end(), 0);
     BenchmarkParams params{bit_width, data.data(), data_len};
+    const bool decode = bit_width > 0 && bit_width <= MAX_DECODE_BIT_WIDTH;
+    if (decode) {
+      params.dict.resize(1 << bit_width);
+      std::iota(params.dict.begin(), params.dict.end(), 1);
+    }
+    if (!ValidateAvx2(UnpackBenchmark, &params)
+        || (decode && !ValidateAvx2(DecodeBenchmark, &params))) {
+      LOG(ERROR) << "AVX2 results differ from scalar results. bit_width: " << bit_width;
+      exit(1);
+    }
     suite.AddBenchmark(Substitute("BitReader", bit_width), BitReaderBenchmark, &params);
     suite.AddBenchmark(
         Substitute("Unpack32Scalar", bit_width), Unpack32Benchmark, &params);
-    suite.AddBenchmark(Substitute("UnpackScalar", bit_width), UnpackBenchmark, &params);
+    suite.AddBenchmark(
+        Substitute("UnpackScalar", bit_width), UnpackScalarBenchmark, &params);
+    suite.AddBenchmark(Substitute("UnpackAvx2", bit_width), UnpackBenchmark, &params);
+    if (decode) {
+      suite.AddBenchmark(
+          Substitute("DecodeScalar", bit_width), DecodeScalarBenchmark, &params);
+      suite.AddBenchmark(Substitute("DecodeAvx2", bit_width), DecodeBenchmark, &params);
+    }
     cout << suite.Measure() << endl;
   }
   return 0;
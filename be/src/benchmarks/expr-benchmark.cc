@@ -24,6 +24,7 @@
 #include "exprs/scalar-expr-evaluator.h"
 #include "exprs/scalar-expr.h"
 #include "exprs/timezone_db.h"
+#include "exprs/vectorized-conjuncts.h"
 #include "util/benchmark.h"
 
 #include "codegen/llvm-codegen.h"
@@ -37,6 +38,7 @@
 #include "runtime/fragment-state.h"
 #include "runtime/mem-pool.h"
 #include "runtime/mem-tracker.h"
+#include "runtime/tuple.h"
 #include "service/fe-support.h"
 #include "service/frontend.h"
 #include "service/impala-server.h"
@@ -896,6 +898,172 @@ Benchmark* BenchmarkTimestampFunctions(bool codegen) {
   return suite;
 }
 
+// Compares the evaluation of predicates on an INT slot one row at a time with the
+// batch-at-a-time evaluation by VectorizedPredicate. The row-at-a-time versions do the
+// same work per row as a conjunct: load the tuple, check the null indicator, load the
+// slot and compare it. The 'row' versions are hand-written loops with the predicate
+// inlined, the 'row-call' versions call a function per row that returns a BooleanVal,
+// like the evaluation of a conjunct that is not inlined into its caller. Every tenth
+// slot is NULL and the values are uniformly distributed in [0, 1000).
+//
+// The results below were not produced by this binary but by a standalone build of
+// the kernels in vectorized-conjuncts.cc (g++ 12.2 -O3 -msse4.2) that runs the same
+// data and loops, best of 15 runs, in ns per row:
+// Machine Info: Intel(R) Xeon(R) Processor (family 6 model 143), 1 vCPU under KVM
+//                      lt       in
+//   row              1.65     1.77
+//   row-call         2.90     3.65
+//   vectorized       1.50     1.72
+// The kernels are about 2x faster than a call per row, but only on par with the
+// inlined loop, since gathering the slots into a dense array costs about as much as
+// the row-at-a-time comparison. The gain in SelectNode and the scanners depends on
+// whether codegen inlines the conjuncts.
+struct VectorizedPredicateData {
+  static const int NUM_ROWS = 1024;
+  static const int TUPLE_SIZE = 16;
+  static const int SLOT_OFFSET = 8;
+
+  VectorizedPredicateData() : tuple_mem(NUM_ROWS * TUPLE_SIZE, 0), sel(NUM_ROWS) {
+    for (int i = 0; i < NUM_ROWS; ++i) {
+      Tuple* tuple = reinterpret_cast<Tuple*>(tuple_mem.data() + i * TUPLE_SIZE);
+      if (i % 10 == 0) {
+        tuple->SetNull(null_indicator);
+      } else {
+        *tuple->GetIntSlot(SLOT_OFFSET) = rand() % 1000;
+      }
+      tuples.push_back(tuple);
+    }
+    VectorizedPredicate::Column col;
+    col.slot_offset = SLOT_OFFSET;
+    col.null_indicator = null_indicator;
+    col.slot_type = ColumnType(TYPE_INT);
+    col.compute_type = ColumnType(TYPE_INT);
+    VectorizedPredicate::Value c;
+    c.i = 500;
+    lt_pred = VectorizedPredicate::CreateCompare(
+        &pool, col, VectorizedPredicate::Op::LT, c, NUM_ROWS);
+    vector<VectorizedPredicate::Value> in_values(5);
+    for (int i = 0; i < in_values.size(); ++i) in_values[i].i = i * 100;
+    in_pred = VectorizedPredicate::CreateInList(&pool, col, false, in_values, NUM_ROWS);
+  }
+
+  /// Initializes 'sel' to all rows.
+  int* ResetSel() {
+    for (int i = 0; i < NUM_ROWS; ++i) sel[i] = i;
+    return sel.data();
+  }
+
+  ObjectPool pool;
+  NullIndicatorOffset null_indicator{0, 0};
+  vector<uint8_t> tuple_mem;
+  vector<Tuple*> tuples;
+  vector<int> sel;
+  VectorizedPredicate* lt_pred;
+  VectorizedPredicate* in_pred;
+  int64_t dummy_result = 0;
+};
+
+template <typename PRED>
+static void RowAtATimeFilter(int batch_size, VectorizedPredicateData* data, PRED pred) {
+  for (int i = 0; i < batch_size; ++i) {
+    int* sel = data->sel.data();
+    int num_selected = 0;
+    for (int r = 0; r < VectorizedPredicateData::NUM_ROWS; ++r) {
+      const Tuple* tuple = data->tuples[r];
+      if (tuple == nullptr || tuple->IsNull(data->null_indicator)) continue;
+      int32_t val = *reinterpret_cast<const int32_t*>(
+          tuple->GetSlot(VectorizedPredicateData::SLOT_OFFSET));
+      if (pred(val)) sel[num_selected++] = r;
+    }
+    data->dummy_result += num_selected;
+  }
+}
+
+typedef BooleanVal (*RowPredicateFn)(const Tuple*);
+
+static void RowCallFilter(int batch_size, VectorizedPredicateData* data,
+    RowPredicateFn pred_fn) {
+  for (int i = 0; i < batch_size; ++i) {
+    int* sel = data->sel.data();
+    int num_selected = 0;
+    for (int r = 0; r < VectorizedPredicateData::NUM_ROWS; ++r) {
+      BooleanVal result = pred_fn(data->tuples[r]);
+      if (!result.is_null && result.val) sel[num_selected++] = r;
+    }
+    data->dummy_result += num_selected;
+  }
+}
+
+// Returns false if the slot of 'tuple' is NULL, otherwise sets 'val' to its value.
+static inline bool GetIntSlot(const Tuple* tuple, int32_t* val) {
+  if (tuple == nullptr || tuple->IsNull(NullIndicatorOffset(0, 0))) return false;
+  *val = *reinterpret_cast<const int32_t*>(
+      tuple->GetSlot(VectorizedPredicateData::SLOT_OFFSET));
+  return true;
+}
+
+static BooleanVal __attribute__((noinline)) LessThanFn(const Tuple* tuple) {
+  int32_t v;
+  if (!GetIntSlot(tuple, &v)) return BooleanVal::null();
+  return BooleanVal(v < 500);
+}
+
+static BooleanVal __attribute__((noinline)) InListFn(const Tuple* tuple) {
+  int32_t v;
+  if (!GetIntSlot(tuple, &v)) return BooleanVal::null();
+  return BooleanVal(v == 0 || v == 100 || v == 200 || v == 300 || v == 400);
+}
+
+static void VectorizedFilter(
+    int batch_size, VectorizedPredicateData* data, VectorizedPredicate* pred) {
+  for (int i = 0; i < batch_size; ++i) {
+    data->dummy_result += pred->Filter(
+        data->tuples.data(), 1, data->ResetSel(), VectorizedPredicateData::NUM_ROWS);
+  }
+}
+
+void RowLessThan(int batch_size, void* d) {
+  RowAtATimeFilter(batch_size, reinterpret_cast<VectorizedPredicateData*>(d),
+      [](int32_t v) { return v < 500; });
+}
+
+void RowCallLessThan(int batch_size, void* d) {
+  RowCallFilter(batch_size, reinterpret_cast<VectorizedPredicateData*>(d), &LessThanFn);
+}
+
+void VectorizedLessThan(int batch_size, void* d) {
+  VectorizedPredicateData* data = reinterpret_cast<VectorizedPredicateData*>(d);
+  VectorizedFilter(batch_size, data, data->lt_pred);
+}
+
+void RowInList(int batch_size, void* d) {
+  RowAtATimeFilter(batch_size, reinterpret_cast<VectorizedPredicateData*>(d),
+      [](int32_t v) {
+        return v == 0 || v == 100 || v == 200 || v == 300 || v == 400;
+      });
+}
+
+void RowCallInList(int batch_size, void* d) {
+  RowCallFilter(batch_size, reinterpret_cast<VectorizedPredicateData*>(d), &InListFn);
+}
+
+void VectorizedInList(int batch_size, void* d) {
+  VectorizedPredicateData* data = reinterpret_cast<VectorizedPredicateData*>(d);
+  VectorizedFilter(batch_size, data, data->in_pred);
+}
+
+Benchmark* BenchmarkVectorizedPredicates() {
+  Benchmark* suite = new Benchmark("VectorizedPredicates");
+  VectorizedPredicateData* data = new VectorizedPredicateData();
+  suite->AddBenchmark("row-lt", RowLessThan, data);
+  suite->AddBenchmark("row-call-lt", RowCallLessThan, data);
+  suite->AddBenchmark("vectorized-lt", VectorizedLessThan, data);
+  suite->AddBenchmark("row-in", RowInList, data);
+  suite->AddBenchmark("row-call-in", RowCallInList, data);
+  suite->AddBenchmark("vectorized-in", VectorizedInList, data);
+  return suite;
+}
+
 typedef Benchmark* (*SingleBenchmark)(bool);
 
 int main(int argc, char** argv) {
@@ -937,6 +1105,7 @@ int main(int argc, char** argv) {
       cout << suite->Measure(50, 10, SetupBenchmark) << endl;
     }
   }
+  cout << BenchmarkVectorizedPredicates()->Measure() << endl;
 
   return 0;
 }
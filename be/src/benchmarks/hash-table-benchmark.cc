@@ -41,6 +41,9 @@ using namespace std;
 // name represents the name of benchmark (probe|build|memory).
 // XX represents the number of rows in the dataset.
 // YY represents the percentage of unique values in dataset.
+// Benchmarks with the _group suffix use a hash table with group probing and are
+// relative to the same benchmark with quadratic probing. They are not included in the
+// sample results below.
 // Runtime Benchmark
 // -----------------
 // 21/06/30 08:44:20 INFO util.JvmPauseMonitor: Starting JVM pause monitor
@@ -111,9 +114,12 @@ class TestCtx {
   MemTracker tracker_;
   MemPool mem_pool_;
   int initial_num_buckets;
-  void SetUp(int num_buckets) {
+  /// If true, the hash table uses group probing instead of quadratic probing.
+  bool group_probing = false;
+  void SetUp(int num_buckets, bool use_group_probing = false) {
     CreateTestEnv();
     initial_num_buckets = num_buckets;
+    group_probing = use_group_probing;
     bool ht_success = CreateHashTable();
     CHECK(ht_success) << "Creation of HashTable failed";
     RowDescriptor rd;
@@ -194,8 +200,8 @@ class TestCtx {
         pool_.Add(new Suballocator(buffer_pool, client, suballocator_buffer_len));
 
     int64_t max_num_buckets = 1L << 31;
-    hash_table_ = pool_.Add(HashTable::Create(
-        allocator, true, 1, nullptr, max_num_buckets, initial_num_buckets));
+    hash_table_ = pool_.Add(HashTable::Create(allocator, true, 1, nullptr,
+        max_num_buckets, initial_num_buckets, group_probing));
     status = hash_table_->Init(&success);
     if (!(status.ok() && success)) {
       std::cout << "HashTable Init failed" << std::endl;
@@ -310,7 +316,9 @@ std::string ResultString(
 int64_t GetMemoryBytesConsumed(HashTable* ht) {
   int empty_buckets = ht->EmptyBuckets();
   int64_t mem_size = ht->CurrentMemSize();
-  return mem_size - (empty_buckets * (HashTable::BUCKET_SIZE + 4));
+  // The bucket, the hash and, with group probing, the tag of each empty bucket.
+  int64_t empty_bucket_size = HashTable::BUCKET_SIZE + 4 + ht->is_group_probing();
+  return mem_size - empty_buckets * empty_bucket_size;
 }
 
 int main(int argc, char** argv) {
@@ -332,30 +340,47 @@ int main(int argc, char** argv) {
   vector<TestCtx*> ctxs;
   for (int num = 0; num < num_tuples.size(); num++) {
     for (int up = 0; up < unique_percent.size(); up++) {
-      std::stringstream pname;
-      std::stringstream bname;
-      pname << "probe_" << num_tuples[num] << "_" << unique_percent[up];
-      bname << "build_" << num_tuples[num] << "_" << unique_percent[up];
-      TestCtx* ctx = new TestCtx();
-      ctx->SetUp(num_tuples[num]);
-      ctxs.push_back(ctx);
-      ctx->CreateDataSet(num_tuples[num], unique_percent[up]);
-      hash_table_build.AddBenchmark(bname.str(), build::Benchmark, (void*)ctx, -1);
-      hash_table_probe.AddBenchmark(pname.str(), probe::Benchmark, (void*)ctx, -1);
+      int build_baseline = -1;
+      int probe_baseline = -1;
+      for (bool group_probing : {false, true}) {
+        std::stringstream pname;
+        std::stringstream bname;
+        const char* suffix = group_probing ? "_group" : "";
+        pname << "probe_" << num_tuples[num] << "_" << unique_percent[up] << suffix;
+        bname << "build_" << num_tuples[num] << "_" << unique_percent[up] << suffix;
+        TestCtx* ctx = new TestCtx();
+        ctx->SetUp(num_tuples[num], group_probing);
+        ctxs.push_back(ctx);
+        ctx->CreateDataSet(num_tuples[num], unique_percent[up]);
+        int build_idx = hash_table_build.AddBenchmark(
+            bname.str(), build::Benchmark, (void*)ctx, build_baseline);
+        int probe_idx = hash_table_probe.AddBenchmark(
+            pname.str(), probe::Benchmark, (void*)ctx, probe_baseline);
+        if (!group_probing) {
+          build_baseline = build_idx;
+          probe_baseline = probe_idx;
+        }
+      }
     }
   }
 
   // Create Probe benchmark for Data not found in the table
   for (int num = 0; num < num_tuples.size(); num++) {
-    TestCtx* ctx = new TestCtx();
-    ctx->SetUp(num_tuples[num]);
-    ctxs.push_back(ctx);
-    ctx->CreateDataSet(num_tuples[num], 10);
-    Build(ctx, ctx->data);
-    ctx->CreateAbsentKeysData(num_tuples[num]);
-    std::stringstream pname;
-    pname << "probe_" << num_tuples[num] << "_absentkeys";
-    hash_table_probe.AddBenchmark(pname.str(), probe::Benchmark, (void*)ctx, -1);
+    int probe_baseline = -1;
+    for (bool group_probing : {false, true}) {
+      TestCtx* ctx = new TestCtx();
+      ctx->SetUp(num_tuples[num], group_probing);
+      ctxs.push_back(ctx);
+      ctx->CreateDataSet(num_tuples[num], 10);
+      Build(ctx, ctx->data);
+      ctx->CreateAbsentKeysData(num_tuples[num]);
+      std::stringstream pname;
+      pname << "probe_" << num_tuples[num] << "_absentkeys"
+            << (group_probing ? "_group" : "");
+      int probe_idx = hash_table_probe.AddBenchmark(
+          pname.str(), probe::Benchmark, (void*)ctx, probe_baseline);
+      if (!group_probing) probe_baseline = probe_idx;
+    }
   }
   std::cout << hash_table_build.Measure(50, 10, build::SetUp) << std::endl;
   std::cout << hash_table_probe.Measure() << std::endl;
@@ -375,15 +400,18 @@ int main(int argc, char** argv) {
   num_tuples.push_back(4 * 1024 * 1024);
   for (int num = 0; num < num_tuples.size(); num++) {
     for (int up = 0; up < unique_percent.size(); up++) {
-      std::stringstream bname;
-      bname << "memory_" << num_tuples[num] << "_" << unique_percent[up];
-      TestCtx ctx;
-      ctx.SetUp(num_tuples[num]);
-      ctx.CreateDataSet(num_tuples[num], unique_percent[up]);
-      Build(&ctx, ctx.data);
-      benchmark_names.push_back(bname.str());
-      memory_consumption.push_back(GetMemoryBytesConsumed(ctx.hash_table_));
-      ctx.TearDown();
+      for (bool group_probing : {false, true}) {
+        std::stringstream bname;
+        bname << "memory_" << num_tuples[num] << "_" << unique_percent[up]
+              << (group_probing ? "_group" : "");
+        TestCtx ctx;
+        ctx.SetUp(num_tuples[num], group_probing);
+        ctx.CreateDataSet(num_tuples[num], unique_percent[up]);
+        Build(&ctx, ctx.data);
+        benchmark_names.push_back(bname.str());
+        memory_consumption.push_back(GetMemoryBytesConsumed(ctx.hash_table_));
+        ctx.TearDown();
+      }
     }
   }
   std::cout << ResultString(benchmark_names, memory_consumption) << std::endl;
@@ -0,0 +1,190 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "exec/parquet/parquet-encoding-converter.h"
+#include "runtime/mem-pool.h"
+#include "runtime/mem-tracker.h"
+#include "util/benchmark.h"
+#include "util/cpu-info.h"
+#include "util/debug-util.h"
+
+#include "common/names.h"
+
+using namespace impala;
+
+// Measures the Parquet encodings that pages are converted from and to by
+// ParquetEncodingConverter, on data that they are meant for:
+//  ids:        sorted BIGINT ids with small gaps.
+//  timestamps: INT64 timestamps in microseconds, a few seconds apart.
+//  strings:    strings with long common prefixes, like TPC-H c_name.
+//  doubles:    prices with two decimal digits.
+// For each data set the size of the encoded values is printed next to the size of the
+// PLAIN values. Compression is not applied, but the encoded values also compress better
+// than PLAIN ones since they contain fewer distinct bytes. The benchmarks are:
+//  plain_copy: copies the PLAIN values, which is the baseline of reading a PLAIN page.
+//  decode:     decodes the encoded values to PLAIN, as the scanner does for each page.
+//  encode:     encodes the PLAIN values, as the table writer does for each page.
+// The pages have 64K values.
+
+namespace parquetenc {
+
+static const int NUM_VALUES = 64 * 1024;
+
+struct TestData {
+  TestData(const string& name, parquet::Encoding::type encoding, parquet::Type::type type,
+      vector<uint8_t> plain, int num_values)
+    : name(name),
+      encoding(encoding),
+      type(type),
+      plain(std::move(plain)),
+      num_values(num_values),
+      pool(&tracker) {
+    out.resize(std::max<int64_t>(this->plain.size(),
+        ParquetEncodingConverter::MaxEncodedLen(encoding, type, this->plain.size())));
+    encoded.assign(out.begin(), out.begin() + Encode());
+  }
+
+  int64_t Encode() {
+    return ParquetEncodingConverter::EncodeFromPlain(
+        encoding, type, plain.data(), plain.size(), out.data());
+  }
+
+  const string name;
+  const parquet::Encoding::type encoding;
+  const parquet::Type::type type;
+  const vector<uint8_t> plain;
+  const int num_values;
+  vector<uint8_t> encoded;
+  // Output buffer of plain_copy and encode.
+  vector<uint8_t> out;
+  MemTracker tracker;
+  MemPool pool;
+};
+
+template <typename T>
+vector<uint8_t> ToPlain(const vector<T>& values) {
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(values.data());
+  return vector<uint8_t>(data, data + values.size() * sizeof(T));
+}
+
+vector<uint8_t> ToPlain(const vector<string>& values) {
+  vector<uint8_t> result;
+  for (const string& value : values) {
+    uint32_t len = value.size();
+    const uint8_t* len_ptr = reinterpret_cast<const uint8_t*>(&len);
+    result.insert(result.end(), len_ptr, len_ptr + sizeof(len));
+    result.insert(result.end(), value.begin(), value.end());
+  }
+  return result;
+}
+
+void PlainCopy(int batch_size, void* data) {
+  TestData* d = reinterpret_cast<TestData*>(data);
+  for (int i = 0; i < batch_size; ++i) {
+    memcpy(d->out.data(), d->plain.data(), d->plain.size());
+  }
+}
+
+void Decode(int batch_size, void* data) {
+  TestData* d = reinterpret_cast<TestData*>(data);
+  for (int i = 0; i < batch_size; ++i) {
+    uint8_t* plain;
+    int64_t plain_size;
+    Status status = ParquetEncodingConverter::DecodeToPlain(d->encoding, d->type, -1,
+        d->encoded.data(), d->encoded.size(), d->num_values, &d->pool, &plain,
+        &plain_size);
+    DCHECK(status.ok());
+    d->pool.Clear();
+  }
+}
+
+void Encode(int batch_size, void* data) {
+  TestData* d = reinterpret_cast<TestData*>(data);
+  for (int i = 0; i < batch_size; ++i) d->Encode();
+}
+
+// Checks that the encoded values decode to the PLAIN values.
+bool Verify(TestData* d) {
+  uint8_t* plain;
+  int64_t plain_size;
+  Status status = ParquetEncodingConverter::DecodeToPlain(d->encoding, d->type, -1,
+      d->encoded.data(), d->encoded.size(), d->num_values, &d->pool, &plain, &plain_size);
+  bool result = status.ok() && plain_size == static_cast<int64_t>(d->plain.size())
+      && memcmp(plain, d->plain.data(), plain_size) == 0;
+  d->pool.FreeAll();
+  return result;
+}
+
+} // namespace parquetenc
+
+int main(int argc, char** argv) {
+  CpuInfo::Init();
+  cout << endl << Benchmark::GetMachineInfo() << endl;
+  using parquetenc::NUM_VALUES;
+  using parquetenc::TestData;
+  using parquetenc::ToPlain;
+
+  std::mt19937_64 rng(NUM_VALUES);
+  vector<int64_t> ids(NUM_VALUES);
+  vector<int64_t> timestamps(NUM_VALUES);
+  vector<string> strings(NUM_VALUES);
+  vector<double> doubles(NUM_VALUES);
+  for (int i = 0; i < NUM_VALUES; ++i) {
+    ids[i] = (i == 0 ? 1000000000L : ids[i - 1]) + 1 + rng() % 4;
+    timestamps[i] = (i == 0 ? 1600000000000000L : timestamps[i - 1]) + rng() % 5000000;
+    char buf[32];
+    snprintf(buf, sizeof(buf), "Customer#%09d", static_cast<int>(i * 7 + rng() % 7));
+    strings[i] = buf;
+    doubles[i] = (rng() % 10000000) / 100.0;
+  }
+
+  vector<TestData*> data;
+  data.push_back(new TestData("ids", parquet::Encoding::DELTA_BINARY_PACKED,
+      parquet::Type::INT64, ToPlain(ids), NUM_VALUES));
+  data.push_back(new TestData("timestamps", parquet::Encoding::DELTA_BINARY_PACKED,
+      parquet::Type::INT64, ToPlain(timestamps), NUM_VALUES));
+  data.push_back(new TestData("strings", parquet::Encoding::DELTA_LENGTH_BYTE_ARRAY,
+      parquet::Type::BYTE_ARRAY, ToPlain(strings), NUM_VALUES));
+  data.push_back(new TestData("strings", parquet::Encoding::DELTA_BYTE_ARRAY,
+      parquet::Type::BYTE_ARRAY, ToPlain(strings), NUM_VALUES));
+  data.push_back(new TestData("doubles", parquet::Encoding::BYTE_STREAM_SPLIT,
+      parquet::Type::DOUBLE, ToPlain(doubles), NUM_VALUES));
+
+  for (TestData* d : data) {
+    string encoding = PrintThriftEnum(d->encoding);
+    if (!parquetenc::Verify(d)) {
+      cerr << "Decoding " << d->name << " " << encoding << " failed" << endl;
+      return 1;
+    }
+    cout << d->name << " " << encoding << ": PLAIN " << d->plain.size()
+         << " bytes, encoded " << d->encoded.size() << " bytes" << endl;
+    Benchmark suite(d->name + " " + encoding);
+    suite.AddBenchmark("plain_copy", parquetenc::PlainCopy, d);
+    suite.AddBenchmark("decode", parquetenc::Decode, d);
+    suite.AddBenchmark("encode", parquetenc::Encode, d);
+    cout << suite.Measure() << endl;
+    delete d;
+  }
+  return 0;
+}
@@ -0,0 +1,329 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <stdio.h>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
+
+#include "exec/hash-table.inline.h"
+#include "exprs/scalar-expr-evaluator.h"
+#include "exprs/slot-ref.h"
+#include "runtime/bufferpool/buffer-pool.h"
+#include "runtime/bufferpool/reservation-tracker.h"
+#include "runtime/bufferpool/suballocator.h"
+#include "runtime/mem-pool.h"
+#include "runtime/mem-tracker.h"
+#include "runtime/runtime-state.h"
+#include "runtime/test-env.h"
+#include "runtime/tuple-row.h"
+#include "service/fe-support.h"
+#include "util/benchmark.h"
+#include "util/cpu-info.h"
+
+#include "common/names.h"
+
+using namespace impala;
+
+// Compares hash aggregation of a high-cardinality GROUP BY with and without radix
+// partitioning the input first, as GroupingAggregator does with AGG_RADIX_PARTITIONING
+// once its hash tables are larger than the CPU caches. The query is modeled after the
+// subquery of TPC-H Q18:
+//
+//   select l_orderkey, sum(l_quantity) from lineitem group by l_orderkey
+//
+// with four rows per group in random order.
+//
+// The benchmark drives the HashTable and HashTableCtx that GroupingAggregator uses,
+// with one hash table per hash partition, and follows GroupingAggregator::AddBatchImpl()
+// and RadixPartitionBatch(). The expressions are interpreted, not codegen'd, and the
+// aggregate function is a plain addition. The benchmarks are:
+//  direct: aggregate batches of input rows, evaluating and hashing the grouping
+//          expression of a group of rows and prefetching their buckets first.
+//  radix:  hash each input row, deep-copy it into the buffer of its hash partition
+//          and aggregate a buffer at once when it is full, reusing the hashes.
+// The benchmark names end with the number of input rows.
+
+namespace radixagg {
+
+// Same as GroupingAggregator.
+static const int NUM_PARTITIONING_BITS = 4;
+static const int PARTITION_FANOUT = 1 << NUM_PARTITIONING_BITS;
+static const int BATCH_SIZE = 1024;
+
+// The input and intermediate tuples have the same layout: the null indicator byte,
+// followed by the grouping key and the sum.
+static const int KEY_OFFSET = 8;
+static const int SUM_OFFSET = 16;
+static const int TUPLE_SIZE = 24;
+
+static int64_t* GetKey(Tuple* tuple) {
+  return reinterpret_cast<int64_t*>(tuple->GetSlot(KEY_OFFSET));
+}
+
+static int64_t* GetSum(Tuple* tuple) {
+  return reinterpret_cast<int64_t*>(tuple->GetSlot(SUM_OFFSET));
+}
+
+class TestCtx {
+ public:
+  TestCtx(int64_t num_rows, bool radix)
+    : num_rows_(num_rows), radix_(radix), input_pool_(&tracker_),
+      expr_pool_(&tracker_) {}
+
+  void SetUp() {
+    test_env_.reset(new TestEnv());
+    const int64_t buffer_bytes_limit = 8L * 1024 * 1024 * 1024;
+    test_env_->SetBufferPoolArgs(64 * 1024, buffer_bytes_limit);
+    CHECK(test_env_->Init().ok());
+    TQueryOptions query_options;
+    query_options.__set_batch_size(BATCH_SIZE);
+    query_options.__set_buffer_pool_limit(buffer_bytes_limit);
+    CHECK(test_env_->CreateQueryState(0, &query_options, &runtime_state_).ok());
+
+    BufferPool* buffer_pool = test_env_->exec_env()->buffer_pool();
+    MemTracker* client_tracker =
+        pool_.Add(new MemTracker(-1, "client", runtime_state_->instance_mem_tracker()));
+    CHECK(buffer_pool->RegisterClient("radixagg", nullptr,
+        runtime_state_->instance_buffer_reservation(), client_tracker,
+        buffer_bytes_limit, RuntimeProfile::Create(&pool_, "radixagg"),
+        &client_).ok());
+    allocator_.reset(new Suballocator(buffer_pool, &client_, 64 * 1024));
+
+    RowDescriptor row_desc;
+    for (vector<ScalarExpr*>* exprs : {&build_exprs_, &probe_exprs_}) {
+      SlotRef* expr = pool_.Add(new SlotRef(ColumnType(TYPE_BIGINT), KEY_OFFSET, false));
+      CHECK(expr->Init(row_desc, true, nullptr).ok());
+      exprs->push_back(expr);
+    }
+    CHECK(HashTableCtx::Create(&pool_, runtime_state_, build_exprs_, probe_exprs_,
+        true, vector<bool>(build_exprs_.size(), false), 1, 0, 1, &expr_pool_,
+        &expr_pool_, &expr_pool_, &ht_ctx_).ok());
+    CHECK(ht_ctx_->Open(runtime_state_).ok());
+
+    std::mt19937_64 rng(num_rows_);
+    vector<int64_t> keys(num_rows_);
+    for (int64_t i = 0; i < num_rows_; ++i) keys[i] = i / 4 + 1;
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (int64_t key : keys) {
+      Tuple* tuple = Tuple::Create(TUPLE_SIZE, &input_pool_);
+      *GetKey(tuple) = key;
+      *GetSum(tuple) = rng() % 50 + 1;
+      TupleRow* row =
+          reinterpret_cast<TupleRow*>(input_pool_.Allocate(sizeof(Tuple*)));
+      row->SetTuple(0, tuple);
+      rows_.push_back(row);
+    }
+  }
+
+  void TearDown() {
+    CloseHashTables();
+    ht_ctx_->Close(runtime_state_);
+    ScalarExpr::Close(build_exprs_);
+    ScalarExpr::Close(probe_exprs_);
+    allocator_.reset();
+    test_env_->exec_env()->buffer_pool()->DeregisterClient(&client_);
+    input_pool_.FreeAll();
+    expr_pool_.FreeAll();
+    pool_.Clear();
+    test_env_.reset();
+  }
+
+  // Aggregates all input rows into new hash tables and saves a checksum of the result.
+  void Aggregate() {
+    CloseHashTables();
+    groups_pool_.reset(new MemPool(&tracker_));
+    for (int i = 0; i < PARTITION_FANOUT; ++i) {
+      hash_tbls_[i] = HashTable::Create(
+          allocator_.get(), false, 1, nullptr, 1L << 31, BATCH_SIZE);
+      bool got_memory;
+      CHECK(hash_tbls_[i]->Init(&got_memory).ok() && got_memory);
+    }
+    for (int64_t i = 0; i < num_rows_; i += BATCH_SIZE) {
+      int num_rows = min<int64_t>(BATCH_SIZE, num_rows_ - i);
+      if (radix_) {
+        RadixPartition(&rows_[i], num_rows);
+      } else {
+        AggregateRows(&rows_[i], nullptr, num_rows);
+      }
+    }
+    if (radix_) {
+      for (int i = 0; i < PARTITION_FANOUT; ++i) FlushBuffer(i);
+    }
+    checksum_ = 0;
+    for (HashTable* hash_tbl : hash_tbls_) {
+      for (HashTable::Iterator it = hash_tbl->Begin(ht_ctx_.get()); !it.AtEnd();
+           it.Next()) {
+        Tuple* tuple = it.GetTuple<HashTable::BucketType::MATCH_UNSET>();
+        checksum_ += *GetKey(tuple) * *GetSum(tuple);
+      }
+    }
+  }
+
+  uint64_t checksum() const { return checksum_; }
+
+ private:
+  // Same as AddBatchImpl() and ProcessRow() of GroupingAggregator for 'num_rows' rows
+  // from 'rows'. Uses 'hashes' as the hashes of the rows if not NULL.
+  void AggregateRows(TupleRow** rows, const uint32_t* hashes, int num_rows) {
+    HashTableCtx* ht_ctx = ht_ctx_.get();
+    for (HashTable* hash_tbl : hash_tbls_) {
+      bool got_memory;
+      CHECK(hash_tbl->CheckAndResize(num_rows, ht_ctx, &got_memory).ok() && got_memory);
+    }
+    HashTableCtx::ExprValuesCache* expr_vals_cache = ht_ctx->expr_values_cache();
+    const int cache_size = expr_vals_cache->capacity();
+    for (int group_start = 0; group_start < num_rows; group_start += cache_size) {
+      const int group_end = min(num_rows, group_start + cache_size);
+      expr_vals_cache->Reset();
+      for (int i = group_start; i < group_end; ++i) {
+        CHECK(ht_ctx->EvalAndHashProbe(
+            rows[i], hashes == nullptr ? nullptr : hashes + i));
+        const uint32_t hash = expr_vals_cache->CurExprValuesHash();
+        hash_tbls_[hash >> (32 - NUM_PARTITIONING_BITS)]->PrefetchBucket<false>(hash);
+        expr_vals_cache->NextRow();
+      }
+      expr_vals_cache->ResetForRead();
+      for (int i = group_start; i < group_end; ++i) {
+        const uint32_t hash = expr_vals_cache->CurExprValuesHash();
+        HashTable* hash_tbl = hash_tbls_[hash >> (32 - NUM_PARTITIONING_BITS)];
+        bool found;
+        HashTable::Iterator it =
+            hash_tbl->FindBuildRowBucket<HashTable::BucketType::MATCH_UNSET>(
+                ht_ctx, &found);
+        Tuple* input = rows[i]->GetTuple(0);
+        if (found) {
+          *GetSum(it.GetTuple<HashTable::BucketType::MATCH_UNSET>()) += *GetSum(input);
+        } else {
+          Tuple* group = Tuple::Create(TUPLE_SIZE, groups_pool_.get());
+          *GetKey(group) = *GetKey(input);
+          *GetSum(group) = *GetSum(input);
+          it.SetTuple(group, hash);
+        }
+        expr_vals_cache->NextRow();
+      }
+    }
+  }
+
+  // Same as GroupingAggregator::RadixPartitionBatch().
+  void RadixPartition(TupleRow** rows, int num_rows) {
+    HashTableCtx::ExprValuesCache* expr_vals_cache = ht_ctx_->expr_values_cache();
+    for (int i = 0; i < num_rows; ++i) {
+      expr_vals_cache->Reset();
+      CHECK(ht_ctx_->EvalAndHashProbe(rows[i]));
+      const uint32_t hash = expr_vals_cache->CurExprValuesHash();
+      const int partition_idx = hash >> (32 - NUM_PARTITIONING_BITS);
+      Buffer* buffer = &buffers_[partition_idx];
+      if (static_cast<int>(buffer->rows.size()) == BATCH_SIZE) FlushBuffer(partition_idx);
+      uint8_t* data = buffer->data + buffer->rows.size() * (sizeof(Tuple*) + TUPLE_SIZE);
+      TupleRow* dst = reinterpret_cast<TupleRow*>(data);
+      Tuple* tuple = reinterpret_cast<Tuple*>(data + sizeof(Tuple*));
+      memcpy(tuple, rows[i]->GetTuple(0), TUPLE_SIZE);
+      dst->SetTuple(0, tuple);
+      buffer->rows.push_back(dst);
+      buffer->hashes.push_back(hash);
+    }
+  }
+
+  void FlushBuffer(int partition_idx) {
+    Buffer* buffer = &buffers_[partition_idx];
+    AggregateRows(buffer->rows.data(), buffer->hashes.data(), buffer->rows.size());
+    buffer->rows.clear();
+    buffer->hashes.clear();
+  }
+
+  void CloseHashTables() {
+    for (HashTable*& hash_tbl : hash_tbls_) {
+      if (hash_tbl == nullptr) continue;
+      hash_tbl->Close();
+      delete hash_tbl;
+      hash_tbl = nullptr;
+    }
+    if (groups_pool_ != nullptr) groups_pool_->FreeAll();
+  }
+
+  const int64_t num_rows_;
+  const bool radix_;
+
+  unique_ptr<TestEnv> test_env_;
+  RuntimeState* runtime_state_ = nullptr;
+  ObjectPool pool_;
+  MemTracker tracker_;
+  MemPool input_pool_;
+  MemPool expr_pool_;
+  unique_ptr<MemPool> groups_pool_;
+  BufferPool::ClientHandle client_;
+  unique_ptr<Suballocator> allocator_;
+  vector<ScalarExpr*> build_exprs_;
+  vector<ScalarExpr*> probe_exprs_;
+  boost::scoped_ptr<HashTableCtx> ht_ctx_;
+  HashTable* hash_tbls_[PARTITION_FANOUT] = {};
+
+  // The input rows.
+  vector<TupleRow*> rows_;
+
+  // The deep-copied rows of a hash partition and their hashes.
+  struct Buffer {
+    Buffer() { rows.reserve(BATCH_SIZE); hashes.reserve(BATCH_SIZE); }
+    uint8_t data[BATCH_SIZE * (sizeof(Tuple*) + TUPLE_SIZE)];
+    vector<TupleRow*> rows;
+    vector<uint32_t> hashes;
+  };
+  Buffer buffers_[PARTITION_FANOUT];
+
+  uint64_t checksum_ = 0;
+};
+
+void Benchmark(int batch_size, void* data) {
+  TestCtx* ctx = reinterpret_cast<TestCtx*>(data);
+  for (int iter = 0; iter < batch_size; ++iter) ctx->Aggregate();
+}
+
+} // namespace radixagg
+
+int main(int argc, char** argv) {
+  impala::InitCommonRuntime(argc, argv, true, impala::TestInfo::BE_TEST);
+  impala::InitFeSupport();
+  cout << endl << Benchmark::GetMachineInfo() << endl;
+
+  char name[120];
+  for (int64_t num_rows : {1L << 20, 1L << 24}) {
+    snprintf(name, sizeof(name), "Q18 aggregation of %ld rows", num_rows);
+    Benchmark suite(name);
+    vector<radixagg::TestCtx*> ctxs;
+    for (bool radix : {false, true}) {
+      ctxs.push_back(new radixagg::TestCtx(num_rows, radix));
+      ctxs.back()->SetUp();
+      snprintf(name, sizeof(name), "%s_%ld", radix ? "radix" : "direct", num_rows);
+      suite.AddBenchmark(name, radixagg::Benchmark, ctxs.back());
+    }
+    cout << suite.Measure() << endl;
+    uint64_t expected_checksum = ctxs[0]->checksum();
+    for (radixagg::TestCtx* ctx : ctxs) {
+      if (ctx->checksum() != expected_checksum) {
+        cerr << "Checksum mismatch: " << ctx->checksum() << " != " << expected_checksum
+             << endl;
+        return 1;
+      }
+      ctx->TearDown();
+      delete ctx;
+    }
+  }
+  return 0;
+}
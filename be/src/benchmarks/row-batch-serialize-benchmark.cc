@@ -71,6 +71,12 @@
 //           deser_dups_baseline               114.8                  1X
 //                    deser_dups               208.5              1.817X
 //
+// The codec benchmarks ("serialize codecs" and "deserialize codecs") serialize and
+// deserialize the adjacent_dups batch with each of the codecs supported for exchanges,
+// relative to LZ4, which is the default. The "_columnar" variants additionally convert
+// the tuple data to the columnar layout (EXCHANGE_COLUMNAR_FORMAT) before compression.
+// The serialized size with each codec is printed before the results.
+//
 // Earlier results with LossyHashTable
 // serialize:            Function     Rate (iters/ms)          Comparison
 // ----------------------------------------------------------------------
@@ -305,6 +311,22 @@ class RowBatchSerializeBenchmark {
     }
   }
 
+  struct CodecSerializeArgs {
+    RowBatch* batch;
+    CompressionTypePB codec;
+    int compression_level;
+    bool columnar;
+  };
+
+  static void TestSerializeCodec(int batch_size, void* data) {
+    CodecSerializeArgs* args = reinterpret_cast<CodecSerializeArgs*>(data);
+    for (int iter = 0; iter < batch_size; ++iter) {
+      TRowBatch trow_batch;
+      ABORT_IF_ERROR(args->batch->Serialize(
+          &trow_batch, false, args->codec, args->compression_level, args->columnar));
+    }
+  }
+
   struct DeserializeArgs {
     TRowBatch* trow_batch;
     RowDescriptor* row_desc;
@@ -314,7 +336,10 @@ class RowBatchSerializeBenchmark {
   static void TestDeserialize(int batch_size, void* data) {
     struct DeserializeArgs* args = reinterpret_cast<struct DeserializeArgs*>(data);
     for (int iter = 0; iter < batch_size; ++iter) {
-      RowBatch deserialized_batch(args->row_desc, *args->trow_batch, args->tracker);
+      unique_ptr<RowBatch> deserialized_batch;
+      Status status = RowBatch::FromThrift(
+          args->row_desc, *args->trow_batch, args->tracker, &deserialized_batch);
+      DCHECK(status.ok()) << status.GetDetail();
     }
   }
 
@@ -404,6 +429,52 @@ class RowBatchSerializeBenchmark {
     deser_suite.AddBenchmark("deser_dups", TestDeserialize, &dup_deser_args, baseline);
 
     cout << deser_suite.Measure() << endl;
+
+    RunCodecBenchmarks(adjacent_dup_batch, &row_desc, &tracker);
+  }
+
+  // Benchmarks serialization and deserialization of 'batch' with each codec supported
+  // for exchanges, and prints the serialized size with each codec.
+  static void RunCodecBenchmarks(
+      RowBatch* batch, RowDescriptor* row_desc, MemTracker* tracker) {
+    const vector<pair<string, CodecSerializeArgs>> codecs = {
+        {"lz4", {batch, CompressionTypePB::LZ4, 0, false}},
+        {"none", {batch, CompressionTypePB::NONE, 0, false}},
+        {"zstd_1", {batch, CompressionTypePB::ZSTD, 1, false}},
+        {"zstd_3", {batch, CompressionTypePB::ZSTD, 3, false}},
+        {"zstd_9", {batch, CompressionTypePB::ZSTD, 9, false}},
+        {"lz4_columnar", {batch, CompressionTypePB::LZ4, 0, true}},
+        {"none_columnar", {batch, CompressionTypePB::NONE, 0, true}},
+        {"zstd_3_columnar", {batch, CompressionTypePB::ZSTD, 3, true}}};
+    vector<TRowBatch> tbatches(codecs.size());
+    vector<DeserializeArgs> deser_args;
+    for (int i = 0; i < codecs.size(); ++i) {
+      const CodecSerializeArgs& args = codecs[i].second;
+      ABORT_IF_ERROR(batch->Serialize(&tbatches[i], false, args.codec,
+          args.compression_level, args.columnar));
+      cout << "serialized size " << codecs[i].first << ": "
+           << RowBatch::GetSerializedSize(tbatches[i]) << endl;
+      deser_args.push_back({&tbatches[i], row_desc, tracker});
+    }
+    cout << endl;
+
+    int baseline = -1;
+    Benchmark ser_suite("serialize codecs");
+    for (const auto& codec : codecs) {
+      int idx = ser_suite.AddBenchmark("ser_codec_" + codec.first, TestSerializeCodec,
+          const_cast<CodecSerializeArgs*>(&codec.second), baseline);
+      if (baseline == -1) baseline = idx;
+    }
+    cout << ser_suite.Measure() << endl;
+
+    baseline = -1;
+    Benchmark deser_suite("deserialize codecs");
+    for (int i = 0; i < codecs.size(); ++i) {
+      int idx = deser_suite.AddBenchmark("deser_codec_" + codecs[i].first,
+          TestDeserialize, &deser_args[i], baseline);
+      if (baseline == -1) baseline = idx;
+    }
+    cout << deser_suite.Measure() << endl;
   }
 };
 
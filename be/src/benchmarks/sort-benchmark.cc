@@ -0,0 +1,260 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "gutil/strings/substitute.h"
+#include "util/benchmark.h"
+#include "util/cpu-info.h"
+#include "util/normalized-key.h"
+#include "util/radix-sort.h"
+
+#include "common/names.h"
+
+// Benchmark for the in-memory sort of a run of tuples with fixed-width sort keys, as
+// done by Sorter::TupleSorter. Each benchmark sorts NUM_TUPLES tuples:
+//  - quicksort_values: std::sort of tuple pointers, comparing the slot values through
+//    the pointers like the comparator-based quicksort.
+//  - sort_keys: std::sort of (normalized key, tuple pointer) entries by key.
+//  - radix_sort_keys: RadixSortByKey() of the same entries, which is what the Sorter
+//    uses when all ordering exprs are slot refs that fit into the normalized key.
+// The key layouts are:
+//  - int: a single random INT column.
+//  - date: a single DATE column with values from a range of ~30 years, so only some of
+//    the key bytes differ.
+//  - bigint_int: a random BIGINT column followed by an INT column with few values.
+//  - timestamp: a TIMESTAMP column with random dates and times in a ~30 year range.
+//
+// Run on the target machine to get the numbers, e.g.:
+//   be/build/latest/benchmarks/sort-benchmark
+
+using namespace impala;
+
+namespace {
+
+const int NUM_TUPLES = 64 * 1024;
+
+/// A sort tuple with up to two fixed-width slots.
+struct SortTuple {
+  int64_t slot0;
+  int64_t slot1;
+};
+
+struct KeyEntry {
+  NormalizedKeyEncoder::Key key;
+  const SortTuple* tuple;
+  int64_t index;
+};
+
+struct SortData {
+  /// Compares two tuples by their slots, like TupleRowLexicalComparator.
+  bool (*less)(const SortTuple*, const SortTuple*);
+  int num_key_bytes;
+  vector<SortTuple> tuples;
+  vector<KeyEntry> input;
+  vector<KeyEntry> entries;
+  vector<KeyEntry> scratch;
+  vector<const SortTuple*> tuple_ptrs;
+};
+
+/// Builds a normalized key byte by byte, like NormalizedKeyEncoder.
+class KeyBuilder {
+ public:
+  KeyBuilder() { memset(bytes_, 0, sizeof(bytes_)); }
+
+  /// Appends the null byte of a non-NULL value.
+  void AppendNotNull() { bytes_[offset_++] = 1; }
+
+  /// Appends the 'num_bytes' low bytes of 'value' in big-endian order.
+  void Append(uint64_t value, int num_bytes) {
+    for (int i = num_bytes - 1; i >= 0; --i) {
+      bytes_[offset_ + i] = static_cast<uint8_t>(value);
+      value >>= 8;
+    }
+    offset_ += num_bytes;
+  }
+
+  void Finish(NormalizedKeyEncoder::Key* key) const {
+    for (int i = 0; i < NormalizedKeyEncoder::KEY_BYTES / sizeof(uint64_t); ++i) {
+      uint64_t word = 0;
+      for (int j = 0; j < sizeof(uint64_t); ++j) {
+        word = (word << 8) | bytes_[i * sizeof(uint64_t) + j];
+      }
+      key->words[i] = word;
+    }
+  }
+
+ private:
+  uint8_t bytes_[NormalizedKeyEncoder::KEY_BYTES];
+  int offset_ = 0;
+};
+
+uint64_t FlipSign32(int32_t v) { return static_cast<uint32_t>(v) ^ (1U << 31); }
+uint64_t FlipSign64(int64_t v) { return static_cast<uint64_t>(v) ^ (1ULL << 63); }
+
+void InitData(SortData* data, int num_key_bytes,
+    const std::function<void(SortTuple*)>& generate) {
+  data->num_key_bytes = num_key_bytes;
+  data->tuples.resize(NUM_TUPLES);
+  for (SortTuple& tuple : data->tuples) generate(&tuple);
+  data->input.resize(NUM_TUPLES);
+  for (int i = 0; i < NUM_TUPLES; ++i) {
+    const SortTuple& tuple = data->tuples[i];
+    KeyEntry* entry = &data->input[i];
+    memset(&entry->key, 0, sizeof(entry->key));
+    entry->tuple = &tuple;
+    entry->index = i;
+  }
+  data->entries.resize(NUM_TUPLES);
+  data->scratch.resize(NUM_TUPLES);
+  data->tuple_ptrs.resize(NUM_TUPLES);
+}
+
+void QuicksortValues(int batch_size, void* d) {
+  SortData* data = reinterpret_cast<SortData*>(d);
+  for (int i = 0; i < batch_size; ++i) {
+    for (int j = 0; j < NUM_TUPLES; ++j) data->tuple_ptrs[j] = &data->tuples[j];
+    sort(data->tuple_ptrs.begin(), data->tuple_ptrs.end(), data->less);
+  }
+}
+
+void SortKeys(int batch_size, void* d) {
+  SortData* data = reinterpret_cast<SortData*>(d);
+  for (int i = 0; i < batch_size; ++i) {
+    data->entries = data->input;
+    sort(data->entries.begin(), data->entries.end(),
+        [](const KeyEntry& lhs, const KeyEntry& rhs) { return lhs.key < rhs.key; });
+  }
+}
+
+void RadixSortKeys(int batch_size, void* d) {
+  SortData* data = reinterpret_cast<SortData*>(d);
+  for (int i = 0; i < batch_size; ++i) {
+    data->entries = data->input;
+    RadixSortByKey(data->entries.data(), data->scratch.data(), NUM_TUPLES,
+        data->num_key_bytes);
+  }
+}
+
+/// Checks that both key sorts produce the same order as the value sort.
+void Validate(SortData* data, const string& name) {
+  QuicksortValues(1, data);
+  RadixSortKeys(1, data);
+  for (int i = 0; i < NUM_TUPLES; ++i) {
+    if (data->less(data->entries[i].tuple, data->tuple_ptrs[i])
+        || data->less(data->tuple_ptrs[i], data->entries[i].tuple)) {
+      cerr << "Radix sort produced a different order for " << name << endl;
+      exit(1);
+    }
+  }
+}
+
+void RunBenchmark(const string& name, SortData* data) {
+  Validate(data, name);
+  Benchmark suite(Substitute("sort $0", name));
+  int baseline = suite.AddBenchmark("quicksort_values", QuicksortValues, data, -1);
+  suite.AddBenchmark("sort_keys", SortKeys, data, baseline);
+  suite.AddBenchmark("radix_sort_keys", RadixSortKeys, data, baseline);
+  cout << suite.Measure() << endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  CpuInfo::Init();
+  cout << endl << Benchmark::GetMachineInfo() << endl;
+  mt19937_64 rng(0);
+
+  {
+    SortData data;
+    data.less = [](const SortTuple* a, const SortTuple* b) {
+      return static_cast<int32_t>(a->slot0) < static_cast<int32_t>(b->slot0);
+    };
+    InitData(&data, 5, [&](SortTuple* t) { t->slot0 = static_cast<int32_t>(rng()); });
+    for (KeyEntry& e : data.input) {
+      KeyBuilder builder;
+      builder.AppendNotNull();
+      builder.Append(FlipSign32(e.tuple->slot0), 4);
+      builder.Finish(&e.key);
+    }
+    RunBenchmark("int", &data);
+  }
+
+  {
+    SortData data;
+    data.less = [](const SortTuple* a, const SortTuple* b) {
+      return a->slot0 < b->slot0;
+    };
+    // Days since the epoch between 2000 and 2030.
+    InitData(&data, 5, [&](SortTuple* t) { t->slot0 = 10957 + rng() % 10957; });
+    for (KeyEntry& e : data.input) {
+      KeyBuilder builder;
+      builder.AppendNotNull();
+      builder.Append(FlipSign32(e.tuple->slot0), 4);
+      builder.Finish(&e.key);
+    }
+    RunBenchmark("date", &data);
+  }
+
+  {
+    SortData data;
+    data.less = [](const SortTuple* a, const SortTuple* b) {
+      return a->slot0 < b->slot0 || (a->slot0 == b->slot0 && a->slot1 < b->slot1);
+    };
+    InitData(&data, 14, [&](SortTuple* t) {
+      t->slot0 = static_cast<int64_t>(rng() % 1000) << 40;
+      t->slot1 = static_cast<int32_t>(rng() % 16);
+    });
+    for (KeyEntry& e : data.input) {
+      KeyBuilder builder;
+      builder.AppendNotNull();
+      builder.Append(FlipSign64(e.tuple->slot0), 8);
+      builder.AppendNotNull();
+      builder.Append(FlipSign32(e.tuple->slot1), 4);
+      builder.Finish(&e.key);
+    }
+    RunBenchmark("bigint_int", &data);
+  }
+
+  {
+    SortData data;
+    data.less = [](const SortTuple* a, const SortTuple* b) {
+      return a->slot0 < b->slot0 || (a->slot0 == b->slot0 && a->slot1 < b->slot1);
+    };
+    // Gregorian day numbers between 2000 and 2030 and nanoseconds of the day.
+    const int64_t NANOS_PER_DAY = 24LL * 3600 * 1000 * 1000 * 1000;
+    InitData(&data, 13, [&](SortTuple* t) {
+      t->slot0 = 2451545 + rng() % 10957;
+      t->slot1 = rng() % NANOS_PER_DAY;
+    });
+    for (KeyEntry& e : data.input) {
+      // The day number followed by the time of day.
+      KeyBuilder builder;
+      builder.AppendNotNull();
+      builder.Append(e.tuple->slot0, 4);
+      builder.Append(FlipSign64(e.tuple->slot1), 8);
+      builder.Finish(&e.key);
+    }
+    RunBenchmark("timestamp", &data);
+  }
+  return 0;
+}
@@ -202,7 +202,9 @@ ir_functions = [
   ["UNION_MATERIALIZE_BATCH",
   "_ZN6impala9UnionNode16MaterializeBatchEPNS_8RowBatchEPPh"],
   ["BLOOM_FILTER_INSERT", "_ZN6impala11BloomFilter8IrInsertEj"],
-  ["SELECT_NODE_COPY_ROWS", "_ZN6impala10SelectNode8CopyRowsEPNS_8RowBatchE"],
+  ["SELECT_NODE_FILTER_ROWS", "_ZN6impala10SelectNode10FilterRowsEv"],
+  ["SELECT_NODE_FILTER_AND_COPY_ROWS",
+   "_ZN6impala10SelectNode17FilterAndCopyRowsEPNS_8RowBatchE"],
   ["BOOL_MIN_MAX_FILTER_INSERT", "_ZN6impala16BoolMinMaxFilter6InsertEPKv"],
   ["TINYINT_MIN_MAX_FILTER_INSERT", "_ZN6impala19TinyIntMinMaxFilter6InsertEPKv"],
   ["SMALLINT_MIN_MAX_FILTER_INSERT", "_ZN6impala20SmallIntMinMaxFilter6InsertEPKv"],
@@ -225,6 +227,10 @@ ir_functions = [
   ["STRING_IN_LIST_FILTER_INSERT",  "_ZN6impala16InListFilterImplINS_11StringValueELNS_13PrimitiveTypeE10EE6InsertEPKv"],
   ["CHAR_IN_LIST_FILTER_INSERT",    "_ZN6impala16InListFilterImplINS_11StringValueELNS_13PrimitiveTypeE15EE6InsertEPKv"],
   ["VARCHAR_IN_LIST_FILTER_INSERT", "_ZN6impala16InListFilterImplINS_11StringValueELNS_13PrimitiveTypeE16EE6InsertEPKv"],
+  ["TINYINT_BITMAP_FILTER_INSERT",  "_ZN6impala12BitmapFilter6InsertIaEEvPKv"],
+  ["SMALLINT_BITMAP_FILTER_INSERT", "_ZN6impala12BitmapFilter6InsertIsEEvPKv"],
+  ["INT_BITMAP_FILTER_INSERT",      "_ZN6impala12BitmapFilter6InsertIiEEvPKv"],
+  ["BIGINT_BITMAP_FILTER_INSERT",   "_ZN6impala12BitmapFilter6InsertIlEEvPKv"],
   ["KRPC_DSS_GET_PART_EXPR_EVAL",
   "_ZN6impala20KrpcDataStreamSender25GetPartitionExprEvaluatorEi"],
   ["KRPC_DSS_HASH_AND_ADD_ROWS",
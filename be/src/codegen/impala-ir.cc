@@ -70,6 +70,7 @@
 #include "runtime/sorter-ir.cc"
 #include "runtime/tuple-ir.cc"
 #include "udf/udf-ir.cc"
+#include "util/bitmap-filter-ir.cc"
 #include "util/bloom-filter-ir.cc"
 #include "util/hash-util-ir.cc"
 #include "util/in-list-filter-ir.cc"
@@ -51,6 +51,8 @@ Status AggregationNode::Open(RuntimeState* state) {
   RowBatch child_batch(child(0)->row_desc(), state->batch_size(), mem_tracker());
 
   int num_aggs = aggs_.size();
+  // Filtered child batches can be passed to a single aggregator without compaction.
+  child_batch.set_selection_allowed(num_aggs == 1 && aggs_[0]->AcceptsSelection());
   // Create mini batches.
   vector<unique_ptr<RowBatch>> mini_batches;
   if (!replicate_input_ && num_aggs > 1) {
@@ -149,6 +149,10 @@ class Aggregator {
   /// Adds all of the rows in 'batch' to the aggregation.
   virtual Status AddBatch(RuntimeState* state, RowBatch* batch) = 0;
 
+  /// Returns true if AddBatch() only processes the active rows of a batch with a
+  /// selection vector (see RowBatch::set_selection_allowed()).
+  virtual bool AcceptsSelection() const { return false; }
+
   /// Used to insert input rows if this is a streaming pre-agg. Tries to aggregate all of
   /// the rows of 'child_batch', but if there isn't enough memory available rows will be
   /// streamed through and returned in 'out_batch'. If 'eos' is true, 'child_batch' was
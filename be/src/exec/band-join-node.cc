@@ -0,0 +1,647 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/band-join-node.h"
+
+#include <cstring>
+#include <sstream>
+
+#include "codegen/llvm-codegen.h"
+#include "exec/exec-node-util.h"
+#include "exec/exec-node.inline.h"
+#include "exprs/scalar-expr-evaluator.h"
+#include "exprs/scalar-expr.h"
+#include "exprs/slot-ref.h"
+#include "runtime/fragment-state.h"
+#include "runtime/mem-pool.h"
+#include "runtime/raw-value.inline.h"
+#include "runtime/row-batch.h"
+#include "runtime/runtime-state.h"
+#include "runtime/sorter-internal.h"
+#include "runtime/tuple-row.h"
+#include "util/runtime-profile-counters.h"
+#include "util/tuple-row-compare.h"
+
+#include "common/names.h"
+
+namespace impala {
+
+Status BandJoinSortSide::Init(const TSortInfo& sort_info, TTupleId sort_tuple_id,
+    const RowDescriptor& input_row_desc, FragmentState* state) {
+  ObjectPool* pool = state->obj_pool();
+  const DescriptorTbl& desc_tbl = state->desc_tbl();
+  TupleDescriptor* sort_tuple_desc = desc_tbl.GetTupleDescriptor(sort_tuple_id);
+  DCHECK(sort_tuple_desc != nullptr);
+  sort_row_desc = pool->Add(new RowDescriptor(sort_tuple_desc, false));
+  RETURN_IF_ERROR(ScalarExpr::Create(
+      sort_info.ordering_exprs, *sort_row_desc, state, &ordering_exprs));
+  DCHECK(sort_info.__isset.sort_tuple_slot_exprs);
+  RETURN_IF_ERROR(ScalarExpr::Create(
+      sort_info.sort_tuple_slot_exprs, input_row_desc, state, &sort_tuple_slot_exprs));
+  comparator_config =
+      pool->Add(new TupleRowComparatorConfig(sort_info, ordering_exprs));
+
+  const vector<TupleDescriptor*>& input_tuple_descs = input_row_desc.tuple_descriptors();
+  input_tuples.resize(input_tuple_descs.size());
+  for (int i = 0; i < input_tuple_descs.size(); ++i) {
+    input_tuples[i].desc = input_tuple_descs[i];
+  }
+  // The planner materializes every slot of the input into the sort tuple with a slot
+  // ref. The other slots hold sort exprs that were materialized and are not copied.
+  const vector<SlotDescriptor*>& sort_slots = sort_tuple_desc->slots();
+  DCHECK_EQ(sort_slots.size(), sort_tuple_slot_exprs.size());
+  for (int i = 0; i < sort_slots.size(); ++i) {
+    if (!sort_tuple_slot_exprs[i]->IsSlotRef()) continue;
+    const SlotRef* slot_ref = static_cast<const SlotRef*>(sort_tuple_slot_exprs[i]);
+    const SlotDescriptor* input_slot = desc_tbl.GetSlotDescriptor(slot_ref->slot_id());
+    DCHECK(input_slot != nullptr);
+    int tuple_idx = input_row_desc.GetTupleIdx(input_slot->parent()->id());
+    DCHECK_NE(tuple_idx, RowDescriptor::INVALID_IDX);
+    input_tuples[tuple_idx].slots.push_back({sort_slots[i], input_slot});
+  }
+  return Status::OK();
+}
+
+void BandJoinSortSide::Close() {
+  ScalarExpr::Close(ordering_exprs);
+  ScalarExpr::Close(sort_tuple_slot_exprs);
+}
+
+Status BandJoinSortSide::Codegen(FragmentState* state) {
+  llvm::Function* compare_fn = nullptr;
+  RETURN_IF_ERROR(comparator_config->Codegen(state, &compare_fn));
+  return Sorter::TupleSorter::Codegen(state, compare_fn, &codegend_sort_helper_fn);
+}
+
+Status BandJoinPlanNode::Init(const TPlanNode& tnode, FragmentState* state) {
+  RETURN_IF_ERROR(PlanNode::Init(tnode, state));
+  DCHECK(tnode.__isset.band_join_node);
+  DCHECK_EQ(tnode.join_node.join_op, TJoinOp::INNER_JOIN);
+  const TBandJoinNode& tband_join = tnode.band_join_node;
+  RETURN_IF_ERROR(probe_side_.Init(tband_join.probe_sort_info,
+      tband_join.probe_sort_tuple_id, *children_[0]->row_descriptor_, state));
+  RETURN_IF_ERROR(build_side_.Init(tband_join.build_sort_info,
+      tband_join.build_sort_tuple_id, *children_[1]->row_descriptor_, state));
+  DCHECK_EQ(probe_side_.ordering_exprs.size(), 1);
+  DCHECK_GE(build_side_.ordering_exprs.size(), 1);
+  DCHECK_LE(build_side_.ordering_exprs.size(), 2);
+  DCHECK_EQ(build_side_.ordering_exprs.size() == 2, tband_join.__isset.end_inclusive);
+  state->CheckAndAddCodegenDisabledMessage(codegen_status_msgs_);
+  return Status::OK();
+}
+
+void BandJoinPlanNode::Close() {
+  probe_side_.Close();
+  build_side_.Close();
+  PlanNode::Close();
+}
+
+Status BandJoinPlanNode::CreateExecNode(RuntimeState* state, ExecNode** node) const {
+  ObjectPool* pool = state->obj_pool();
+  *node = pool->Add(new BandJoinNode(pool, *this, state->desc_tbl()));
+  return Status::OK();
+}
+
+void BandJoinPlanNode::Codegen(FragmentState* state) {
+  DCHECK(state->ShouldCodegen());
+  PlanNode::Codegen(state);
+  if (IsNodeCodegenDisabled()) return;
+  AddCodegenStatus(probe_side_.Codegen(state), "Probe Sort");
+  AddCodegenStatus(build_side_.Codegen(state), "Build Sort");
+}
+
+BandJoinNode::BandJoinNode(
+    ObjectPool* pool, const BandJoinPlanNode& pnode, const DescriptorTbl& descs)
+  : ExecNode(pool, pnode, descs),
+    probe_side_(pnode.probe_side_),
+    build_side_(pnode.build_side_),
+    is_asc_(pnode.tnode_->band_join_node.probe_sort_info.is_asc_order[0]),
+    start_inclusive_(pnode.tnode_->band_join_node.start_inclusive),
+    end_inclusive_(pnode.tnode_->band_join_node.__isset.end_inclusive
+        && pnode.tnode_->band_join_node.end_inclusive),
+    has_end_(pnode.build_side_.ordering_exprs.size() == 2),
+    key_type_(pnode.probe_side_.ordering_exprs[0]->type()),
+    num_probe_tuples_(pnode.children_[0]->row_descriptor_->tuple_descriptors().size()),
+    num_build_tuples_(pnode.children_[1]->row_descriptor_->tuple_descriptors().size()) {
+  DCHECK_EQ(build_side_.ordering_exprs[0]->type(), key_type_);
+  runtime_profile()->AddInfoString("SortType", "Total");
+  add_batch_timer_ = ADD_SUMMARY_STATS_TIMER(runtime_profile(), "AddBatchTime");
+  num_probe_batches_ = ADD_COUNTER(runtime_profile(), "ProbeBatches", TUnit::UNIT);
+  num_active_rows_scanned_ =
+      ADD_COUNTER(runtime_profile(), "ActiveBuildRowsScanned", TUnit::UNIT);
+}
+
+BandJoinNode::~BandJoinNode() {
+}
+
+Status BandJoinNode::Prepare(RuntimeState* state) {
+  SCOPED_TIMER(runtime_profile_->total_time_counter());
+  RETURN_IF_ERROR(ExecNode::Prepare(state));
+
+  RETURN_IF_ERROR(ScalarExprEvaluator::Create(*probe_side_.ordering_exprs[0], state,
+      pool_, expr_perm_pool(), expr_results_pool(), &probe_key_eval_));
+  RETURN_IF_ERROR(ScalarExprEvaluator::Create(*probe_side_.ordering_exprs[0], state,
+      pool_, expr_perm_pool(), expr_results_pool(), &max_probe_key_eval_));
+  RETURN_IF_ERROR(ScalarExprEvaluator::Create(*build_side_.ordering_exprs[0], state,
+      pool_, expr_perm_pool(), expr_results_pool(), &build_start_eval_));
+  if (has_end_) {
+    RETURN_IF_ERROR(ScalarExprEvaluator::Create(*build_side_.ordering_exprs[1], state,
+        pool_, expr_perm_pool(), expr_results_pool(), &build_end_eval_));
+  }
+
+  // Each sorter reports its counters in its own profile.
+  RuntimeProfile* probe_sort_profile = RuntimeProfile::Create(pool_, "ProbeSorter");
+  RuntimeProfile* build_sort_profile = RuntimeProfile::Create(pool_, "BuildSorter");
+  runtime_profile()->AddChild(probe_sort_profile);
+  runtime_profile()->AddChild(build_sort_profile);
+  probe_sorter_.reset(new Sorter(*probe_side_.comparator_config,
+      probe_side_.sort_tuple_slot_exprs, probe_side_.sort_row_desc, mem_tracker(),
+      buffer_pool_client(), resource_profile_.spillable_buffer_size, probe_sort_profile,
+      state, label(), true, probe_side_.codegend_sort_helper_fn));
+  RETURN_IF_ERROR(probe_sorter_->Prepare(pool_));
+  build_sorter_.reset(new Sorter(*build_side_.comparator_config,
+      build_side_.sort_tuple_slot_exprs, build_side_.sort_row_desc, mem_tracker(),
+      buffer_pool_client(), resource_profile_.spillable_buffer_size, build_sort_profile,
+      state, label(), true, build_side_.codegend_sort_helper_fn));
+  RETURN_IF_ERROR(build_sorter_->Prepare(pool_));
+  DCHECK_GE(resource_profile_.min_reservation,
+      probe_sorter_->ComputeMinReservation() + build_sorter_->ComputeMinReservation()
+          + ActiveStreamsReservation());
+
+  probe_batch_.reset(
+      new RowBatch(probe_side_.sort_row_desc, state->batch_size(), mem_tracker()));
+  probe_rows_.reset(
+      new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker()));
+  build_batch_.reset(
+      new RowBatch(build_side_.sort_row_desc, state->batch_size(), mem_tracker()));
+  active_batch_.reset(
+      new RowBatch(build_side_.sort_row_desc, state->batch_size(), mem_tracker()));
+  build_rows_pool_.reset(new MemPool(mem_tracker()));
+  return Status::OK();
+}
+
+Status BandJoinNode::Open(RuntimeState* state) {
+  SCOPED_TIMER(runtime_profile_->total_time_counter());
+  ScopedOpenEventAdder ea(this);
+  RETURN_IF_ERROR(ExecNode::Open(state));
+  RETURN_IF_ERROR(probe_key_eval_->Open(state));
+  RETURN_IF_ERROR(max_probe_key_eval_->Open(state));
+  RETURN_IF_ERROR(build_start_eval_->Open(state));
+  if (build_end_eval_ != nullptr) RETURN_IF_ERROR(build_end_eval_->Open(state));
+
+  // Sort the build side first, like the build of the other blocking joins.
+  RETURN_IF_ERROR(child(1)->Open(state));
+  // Claim reservation after the child has been opened to reduce the peak reservation
+  // requirement.
+  if (!buffer_pool_client()->is_registered()) {
+    RETURN_IF_ERROR(ClaimBufferReservation(state));
+  }
+  // The build sorter uses all unused reservation while sorting. Set aside the
+  // reservation of the probe sorter and the active set until the build side is sorted.
+  if (saved_reservation_.is_closed()) saved_reservation_.Init(buffer_pool_client());
+  buffer_pool_client()->SaveReservation(&saved_reservation_,
+      probe_sorter_->ComputeMinReservation() + ActiveStreamsReservation());
+  RETURN_IF_ERROR(build_sorter_->Open());
+  RETURN_IF_CANCELLED(state);
+  RETURN_IF_ERROR(QueryMaintenance(state));
+  RETURN_IF_ERROR(SortInput(state, 1, build_sorter_.get()));
+
+  RETURN_IF_ERROR(child(0)->Open(state));
+  buffer_pool_client()->RestoreReservation(
+      &saved_reservation_, probe_sorter_->ComputeMinReservation());
+  RETURN_IF_ERROR(probe_sorter_->Open());
+  RETURN_IF_CANCELLED(state);
+  RETURN_IF_ERROR(QueryMaintenance(state));
+  RETURN_IF_ERROR(SortInput(state, 0, probe_sorter_.get()));
+
+  // The sweep is done on-demand as rows are requested in GetNext().
+  buffer_pool_client()->RestoreAllReservation(&saved_reservation_);
+  RETURN_IF_ERROR(CreateActiveStream(state, &next_active_stream_));
+  return Status::OK();
+}
+
+Status BandJoinNode::SortInput(RuntimeState* state, int child_idx, Sorter* sorter) {
+  RowBatch batch(child(child_idx)->row_desc(), state->batch_size(), mem_tracker());
+  bool eos;
+  do {
+    RETURN_IF_ERROR(child(child_idx)->GetNext(state, &batch, &eos));
+
+    MonotonicStopWatch timer;
+    timer.Start();
+    Status add_status = sorter->AddBatch(&batch);
+    timer.Stop();
+    add_batch_timer_->UpdateCounter(timer.ElapsedTime());
+    if (UNLIKELY(!add_status.ok())) return add_status;
+
+    batch.Reset();
+    RETURN_IF_CANCELLED(state);
+    RETURN_IF_ERROR(QueryMaintenance(state));
+  } while (!eos);
+
+  // Unless we are inside a subplan expecting to call Open()/GetNext() on the child
+  // again, the child can be closed at this point to release resources.
+  if (!IsInSubplan()) child(child_idx)->Close(state);
+
+  RETURN_IF_ERROR(sorter->InputDone());
+  return Status::OK();
+}
+
+Status BandJoinNode::CreateActiveStream(
+    RuntimeState* state, unique_ptr<BufferedTupleStream>* stream) {
+  DCHECK(*stream == nullptr);
+  stream->reset(new BufferedTupleStream(state, build_side_.sort_row_desc,
+      buffer_pool_client(), resource_profile_.spillable_buffer_size,
+      resource_profile_.max_row_buffer_size));
+  RETURN_IF_ERROR((*stream)->Init(label(), false));
+  bool got_buffer;
+  RETURN_IF_ERROR((*stream)->PrepareForWrite(&got_buffer));
+  DCHECK(got_buffer) << "Accounted in min reservation"
+                     << buffer_pool_client()->DebugString();
+  return Status::OK();
+}
+
+Status BandJoinNode::SwapActiveStreams(RuntimeState* state) {
+  DCHECK(active_stream_ == nullptr);
+  DCHECK_EQ(active_batch_->num_rows(), 0);
+  active_stream_ = move(next_active_stream_);
+  // Attach the pages to the batches as they are read, so that the reservation for the
+  // new active set is freed up as the old one is read.
+  bool got_buffer;
+  RETURN_IF_ERROR(active_stream_->PrepareForRead(true, &got_buffer));
+  DCHECK(got_buffer) << "Accounted in min reservation"
+                     << buffer_pool_client()->DebugString();
+  active_batch_pos_ = 0;
+  active_eos_ = false;
+  return CreateActiveStream(state, &next_active_stream_);
+}
+
+inline int BandJoinNode::CompareKeys(const void* lhs, const void* rhs) const {
+  int cmp = RawValue::Compare(lhs, rhs, key_type_);
+  return is_asc_ ? cmp : -cmp;
+}
+
+inline bool BandJoinNode::IsAfterStart(const void* key, const void* start) const {
+  int cmp = CompareKeys(key, start);
+  return cmp > 0 || (cmp == 0 && start_inclusive_);
+}
+
+inline bool BandJoinNode::IsBeforeEnd(const void* key, const void* end) const {
+  int cmp = CompareKeys(key, end);
+  return cmp < 0 || (cmp == 0 && end_inclusive_);
+}
+
+inline const void* BandJoinNode::MaxProbeKey() {
+  DCHECK_GT(num_probe_keys_, 0);
+  return max_probe_key_eval_->GetValue(probe_batch_->GetRow(num_probe_keys_ - 1));
+}
+
+void BandJoinNode::FindMatchingProbeRows(const void* start, const void* end) {
+  // Both predicates are monotonic over the sorted probe keys: the keys after the start
+  // are a suffix and the keys before the end are a prefix of the batch.
+  int lo = 0;
+  int hi = num_probe_keys_;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (IsAfterStart(probe_key_eval_->GetValue(probe_batch_->GetRow(mid)), start)) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  match_begin_ = lo;
+  hi = num_probe_keys_;
+  if (end != nullptr) {
+    while (lo < hi) {
+      int mid = lo + (hi - lo) / 2;
+      if (IsBeforeEnd(probe_key_eval_->GetValue(probe_batch_->GetRow(mid)), end)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+  }
+  match_end_ = hi;
+}
+
+void BandJoinNode::UnpackSortTuple(const BandJoinSortSide& side, TupleRow* sort_row,
+    MemPool* pool, TupleRow* row) {
+  Tuple* sort_tuple = sort_row->GetTuple(0);
+  for (int i = 0; i < side.input_tuples.size(); ++i) {
+    const BandJoinSortSide::InputTuple& input_tuple = side.input_tuples[i];
+    Tuple* tuple = Tuple::Create(input_tuple.desc->byte_size(), pool);
+    for (const BandJoinSortSide::SlotCopy& copy : input_tuple.slots) {
+      if (sort_tuple->IsNull(copy.src->null_indicator_offset())) {
+        tuple->SetNull(copy.dst->null_indicator_offset());
+      } else {
+        memcpy(tuple->GetSlot(copy.dst->tuple_offset()),
+            sort_tuple->GetSlot(copy.src->tuple_offset()), copy.dst->slot_size());
+      }
+    }
+    row->SetTuple(i, tuple);
+  }
+}
+
+Status BandJoinNode::NextProbeBatch(RuntimeState* state, RowBatch* out_batch) {
+  DCHECK_EQ(probe_batch_->num_rows(), 0);
+  DCHECK_EQ(probe_rows_->num_rows(), 0);
+  bool sorter_eos;
+  RETURN_IF_ERROR(probe_sorter_->GetNext(probe_batch_.get(), &sorter_eos));
+
+  // NULL keys never match and are sorted last. Find the first one.
+  int lo = 0;
+  int hi = probe_batch_->num_rows();
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (probe_key_eval_->GetValue(probe_batch_->GetRow(mid)) == nullptr) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  num_probe_keys_ = lo;
+  probe_eos_ = sorter_eos || num_probe_keys_ < probe_batch_->num_rows();
+  if (num_probe_keys_ == 0) {
+    // The batch may hold resources that the sorter needs back for the next batch.
+    probe_batch_->TransferResourceOwnership(out_batch);
+    if (probe_eos_) state_ = SweepState::DONE;
+    return Status::OK();
+  }
+  COUNTER_ADD(num_probe_batches_, 1);
+
+  MemPool* tuple_pool = probe_rows_->tuple_data_pool();
+  for (int i = 0; i < num_probe_keys_; ++i) {
+    TupleRow* row = probe_rows_->GetRow(probe_rows_->AddRow());
+    UnpackSortTuple(probe_side_, probe_batch_->GetRow(i), tuple_pool, row);
+    probe_rows_->CommitLastRow();
+  }
+  RETURN_IF_ERROR(SwapActiveStreams(state));
+  state_ = SweepState::MATCH_ACTIVE;
+  return Status::OK();
+}
+
+Status BandJoinNode::StartBuildRow(TupleRow* build_row, bool is_new, bool* consumed) {
+  DCHECK_EQ(match_begin_, match_end_);
+  const void* start = build_start_eval_->GetValue(build_row);
+  if (start == nullptr) {
+    // NULL starts are sorted last and are never added to the active set.
+    DCHECK(is_new);
+    build_eos_ = true;
+    *consumed = false;
+    return Status::OK();
+  }
+  const void* max_key = MaxProbeKey();
+  if (is_new && !IsAfterStart(max_key, start)) {
+    // The band starts after the probe batch. So do all bands of the rows after it.
+    *consumed = false;
+    return Status::OK();
+  }
+  *consumed = true;
+  const void* end = nullptr;
+  if (has_end_) {
+    end = build_end_eval_->GetValue(build_row);
+    if (end == nullptr) return Status::OK();
+  }
+  FindMatchingProbeRows(start, end);
+  current_build_sort_row_ = build_row;
+  current_build_row_ = nullptr;
+
+  // Later probe keys are after 'max_key', so the row can only match a later probe batch
+  // if its band does not end before 'max_key'.
+  if (end == nullptr || IsBeforeEnd(max_key, end)) {
+    Status status;
+    if (UNLIKELY(!next_active_stream_->AddRow(build_row, &status))) {
+      RETURN_IF_ERROR(status);
+      // The write page of the stream is included in the min reservation and the rows
+      // fit into the max row buffer.
+      return Status(TErrorCode::INTERNAL_ERROR, Substitute("Internal error: couldn't "
+          "add a row to the active set of band join node $0 with unused reservation:\n$1",
+          id(), buffer_pool_client()->DebugString()));
+    }
+  }
+  return Status::OK();
+}
+
+bool BandJoinNode::OutputMatches(RowBatch* out_batch) {
+  if (match_begin_ == match_end_) return true;
+  if (current_build_row_ == nullptr) {
+    current_build_row_ = reinterpret_cast<TupleRow*>(
+        build_rows_pool_->Allocate(num_build_tuples_ * sizeof(Tuple*)));
+    UnpackSortTuple(build_side_, current_build_sort_row_, build_rows_pool_.get(),
+        current_build_row_);
+  }
+  ScalarExprEvaluator* const* conjunct_evals = conjunct_evals_.data();
+  const int num_conjuncts = conjuncts_.size();
+  const int probe_row_size = num_probe_tuples_ * sizeof(Tuple*);
+  const int build_row_size = num_build_tuples_ * sizeof(Tuple*);
+  while (match_begin_ < match_end_) {
+    if (out_batch->AtCapacity()) return false;
+    TupleRow* out_row = out_batch->GetRow(out_batch->AddRow());
+    uint8_t* out_ptr = reinterpret_cast<uint8_t*>(out_row);
+    memcpy(out_ptr, probe_rows_->GetRow(match_begin_), probe_row_size);
+    memcpy(out_ptr + probe_row_size, current_build_row_, build_row_size);
+    ++match_begin_;
+    if (EvalConjuncts(conjunct_evals, num_conjuncts, out_row)) {
+      out_batch->CommitLastRow();
+      IncrementNumRowsReturned(1);
+      if (ReachedLimit()) return false;
+    }
+  }
+  return true;
+}
+
+void BandJoinNode::ReleaseBuildBatch(RowBatch* batch, RowBatch* out_batch) {
+  DCHECK_EQ(match_begin_, match_end_);
+  // Returned rows may reference the var-len data of the batch and the rows unpacked
+  // from it.
+  current_build_sort_row_ = nullptr;
+  current_build_row_ = nullptr;
+  out_batch->tuple_data_pool()->AcquireData(build_rows_pool_.get(), false);
+  batch->TransferResourceOwnership(out_batch);
+}
+
+void BandJoinNode::FinishProbeBatch(RowBatch* out_batch) {
+  DCHECK_EQ(active_batch_->num_rows(), 0);
+  // Returned rows reference the probe rows and their var-len data.
+  probe_rows_->TransferResourceOwnership(out_batch);
+  probe_batch_->TransferResourceOwnership(out_batch);
+  num_probe_keys_ = 0;
+  active_stream_->Close(out_batch, RowBatch::FlushMode::FLUSH_RESOURCES);
+  active_stream_.reset();
+  if (probe_eos_ || (build_eos_ && next_active_stream_->num_rows() == 0)) {
+    state_ = SweepState::DONE;
+  } else {
+    state_ = SweepState::NEXT_PROBE_BATCH;
+  }
+}
+
+Status BandJoinNode::Sweep(RuntimeState* state, RowBatch* out_batch) {
+  // Calls that need reservation, i.e. reading from the sorters and the streams, are
+  // only made at the start of an iteration. Resources that are attached to
+  // 'out_batch' with FLUSH_RESOURCES fill it up, so the parent frees them first.
+  while (!out_batch->AtCapacity() && state_ != SweepState::DONE) {
+    if (!OutputMatches(out_batch)) break;
+    bool consumed;
+    switch (state_) {
+      case SweepState::NEXT_PROBE_BATCH:
+        RETURN_IF_CANCELLED(state);
+        RETURN_IF_ERROR(QueryMaintenance(state));
+        RETURN_IF_ERROR(NextProbeBatch(state, out_batch));
+        break;
+      case SweepState::MATCH_ACTIVE:
+        if (active_batch_pos_ < active_batch_->num_rows()) {
+          RETURN_IF_ERROR(StartBuildRow(
+              active_batch_->GetRow(active_batch_pos_++), false, &consumed));
+          DCHECK(consumed);
+          break;
+        }
+        ReleaseBuildBatch(active_batch_.get(), out_batch);
+        active_batch_pos_ = 0;
+        if (active_eos_) {
+          state_ = SweepState::MATCH_NEW;
+        } else if (!out_batch->AtCapacity()) {
+          RETURN_IF_CANCELLED(state);
+          RETURN_IF_ERROR(QueryMaintenance(state));
+          RETURN_IF_ERROR(active_stream_->GetNext(active_batch_.get(), &active_eos_));
+          COUNTER_ADD(num_active_rows_scanned_, active_batch_->num_rows());
+        }
+        break;
+      case SweepState::MATCH_NEW:
+        if (!build_eos_ && build_batch_pos_ < build_batch_->num_rows()) {
+          RETURN_IF_ERROR(
+              StartBuildRow(build_batch_->GetRow(build_batch_pos_), true, &consumed));
+          if (consumed) {
+            ++build_batch_pos_;
+            break;
+          }
+        }
+        if (build_eos_ || build_batch_pos_ < build_batch_->num_rows()) {
+          // The remaining build rows start after the probe batch.
+          FinishProbeBatch(out_batch);
+          break;
+        }
+        ReleaseBuildBatch(build_batch_.get(), out_batch);
+        build_batch_pos_ = 0;
+        if (build_sorter_eos_) {
+          build_eos_ = true;
+        } else if (!out_batch->AtCapacity()) {
+          RETURN_IF_CANCELLED(state);
+          RETURN_IF_ERROR(QueryMaintenance(state));
+          RETURN_IF_ERROR(build_sorter_->GetNext(build_batch_.get(), &build_sorter_eos_));
+        }
+        break;
+      case SweepState::DONE:
+        DCHECK(false);
+        break;
+    }
+  }
+  return Status::OK();
+}
+
+Status BandJoinNode::GetNext(RuntimeState* state, RowBatch* row_batch, bool* eos) {
+  DCHECK(!row_batch->AtCapacity());
+  SCOPED_TIMER(runtime_profile_->total_time_counter());
+  ScopedGetNextEventAdder ea(this, eos);
+  RETURN_IF_ERROR(ExecDebugAction(TExecNodePhase::GETNEXT, state));
+  RETURN_IF_CANCELLED(state);
+  RETURN_IF_ERROR(QueryMaintenance(state));
+  *eos = false;
+
+  RETURN_IF_ERROR(Sweep(state, row_batch));
+  // OutputMatches() stops adding rows once the limit is reached.
+  if (ReachedLimit()) state_ = SweepState::DONE;
+  if (state_ == SweepState::DONE) {
+    *eos = true;
+    TransferAllResources(row_batch);
+  }
+  COUNTER_SET(rows_returned_counter_, rows_returned());
+  return Status::OK();
+}
+
+void BandJoinNode::TransferAllResources(RowBatch* out_batch) {
+  match_begin_ = match_end_ = 0;
+  current_build_sort_row_ = nullptr;
+  current_build_row_ = nullptr;
+  out_batch->tuple_data_pool()->AcquireData(build_rows_pool_.get(), false);
+  probe_rows_->TransferResourceOwnership(out_batch);
+  probe_batch_->TransferResourceOwnership(out_batch);
+  build_batch_->TransferResourceOwnership(out_batch);
+  active_batch_->TransferResourceOwnership(out_batch);
+  num_probe_keys_ = 0;
+  build_batch_pos_ = 0;
+  active_batch_pos_ = 0;
+  if (active_stream_ != nullptr) {
+    active_stream_->Close(out_batch, RowBatch::FlushMode::FLUSH_RESOURCES);
+    active_stream_.reset();
+  }
+  if (next_active_stream_ != nullptr) {
+    next_active_stream_->Close(nullptr, RowBatch::FlushMode::NO_FLUSH_RESOURCES);
+    next_active_stream_.reset();
+  }
+}
+
+Status BandJoinNode::Reset(RuntimeState* state, RowBatch* row_batch) {
+  TransferAllResources(row_batch);
+  if (probe_sorter_ != nullptr) probe_sorter_->Reset();
+  if (build_sorter_ != nullptr) build_sorter_->Reset();
+  state_ = SweepState::NEXT_PROBE_BATCH;
+  probe_eos_ = false;
+  build_sorter_eos_ = false;
+  build_eos_ = false;
+  active_eos_ = false;
+  return ExecNode::Reset(state, row_batch);
+}
+
+void BandJoinNode::Close(RuntimeState* state) {
+  if (is_closed()) return;
+  if (active_stream_ != nullptr) {
+    active_stream_->Close(nullptr, RowBatch::FlushMode::NO_FLUSH_RESOURCES);
+  }
+  if (next_active_stream_ != nullptr) {
+    next_active_stream_->Close(nullptr, RowBatch::FlushMode::NO_FLUSH_RESOURCES);
+  }
+  active_stream_.reset();
+  next_active_stream_.reset();
+  probe_batch_.reset();
+  probe_rows_.reset();
+  build_batch_.reset();
+  active_batch_.reset();
+  if (build_rows_pool_ != nullptr) build_rows_pool_->FreeAll();
+  if (probe_sorter_ != nullptr) probe_sorter_->Close(state);
+  if (build_sorter_ != nullptr) build_sorter_->Close(state);
+  probe_sorter_.reset();
+  build_sorter_.reset();
+  if (!saved_reservation_.is_closed()) saved_reservation_.Close();
+  if (probe_key_eval_ != nullptr) probe_key_eval_->Close(state);
+  if (max_probe_key_eval_ != nullptr) max_probe_key_eval_->Close(state);
+  if (build_start_eval_ != nullptr) build_start_eval_->Close(state);
+  if (build_end_eval_ != nullptr) build_end_eval_->Close(state);
+  ExecNode::Close(state);
+}
+
+void BandJoinNode::DebugString(int indentation_level, stringstream* out) const {
+  *out << string(indentation_level * 2, ' ');
+  *out << "BandJoinNode(probe_key="
+       << ScalarExpr::DebugString(probe_side_.ordering_exprs)
+       << " band=" << ScalarExpr::DebugString(build_side_.ordering_exprs)
+       << (is_asc_ ? " asc" : " desc")
+       << " start_inclusive=" << start_inclusive_;
+  if (has_end_) *out << " end_inclusive=" << end_inclusive_;
+  ExecNode::DebugString(indentation_level, out);
+  *out << ")";
+}
+
+}
@@ -0,0 +1,320 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "exec/exec-node.h"
+#include "runtime/buffered-tuple-stream.h"
+#include "runtime/bufferpool/buffer-pool.h"
+#include "runtime/sorter.h"
+
+#include "gen-cpp/PlanNodes_types.h"
+
+namespace impala {
+
+class MemPool;
+class RowBatch;
+class TupleRow;
+
+/// The sort of one input of a band join, and the mapping of the sorted tuples back to
+/// the row layout of the input.
+struct BandJoinSortSide {
+  /// Exprs over the sort tuple: the probe key, or the start and optional end of the
+  /// band on the build side.
+  std::vector<ScalarExpr*> ordering_exprs;
+
+  /// Exprs over the input row that materialize the sort tuple.
+  std::vector<ScalarExpr*> sort_tuple_slot_exprs;
+
+  /// Row with only the sort tuple. Owned by the FragmentState's object pool.
+  RowDescriptor* sort_row_desc = nullptr;
+
+  /// Owned by the FragmentState's object pool.
+  TupleRowComparatorConfig* comparator_config = nullptr;
+
+  /// Copies a slot of the sort tuple into the slot of an input tuple it was
+  /// materialized from.
+  struct SlotCopy {
+    const SlotDescriptor* src;
+    const SlotDescriptor* dst;
+  };
+
+  /// A tuple of the input row and the slots of the sort tuple that are copied into it.
+  struct InputTuple {
+    const TupleDescriptor* desc = nullptr;
+    std::vector<SlotCopy> slots;
+  };
+
+  /// The tuples of the input row, indexed by tuple index.
+  std::vector<InputTuple> input_tuples;
+
+  /// Codegened version of Sorter::TupleSorter::SortHelper().
+  CodegenFnPtr<Sorter::SortHelperFn> codegend_sort_helper_fn;
+
+  /// Creates the exprs and the slot copies from 'sort_info'. 'input_row_desc' is the row
+  /// of the input and 'sort_tuple_id' the id of the sort tuple.
+  Status Init(const TSortInfo& sort_info, TTupleId sort_tuple_id,
+      const RowDescriptor& input_row_desc, FragmentState* state);
+
+  void Close();
+
+  /// Codegens the comparator and the sort helper of the sorter.
+  Status Codegen(FragmentState* state);
+};
+
+class BandJoinPlanNode : public PlanNode {
+ public:
+  virtual Status Init(const TPlanNode& tnode, FragmentState* state) override;
+  virtual void Close() override;
+  virtual Status CreateExecNode(RuntimeState* state, ExecNode** node) const override;
+  virtual void Codegen(FragmentState* state) override;
+
+  ~BandJoinPlanNode() {}
+
+  BandJoinSortSide probe_side_;
+  BandJoinSortSide build_side_;
+};
+
+/// Inner join whose join predicates include one or two inequalities between a key of the
+/// probe (left) input and the bounds of a band on the build (right) input, e.g.
+/// 'probe.ts BETWEEN build.start_ts AND build.end_ts' or 'probe.x >= build.y'.
+///
+/// Instead of evaluating the predicates for every pair of input rows like
+/// NestedLoopJoinNode, both inputs are sorted with a Sorter: the probe input by its key
+/// and the build input by the start of its band, i.e. the bound that the probe keys reach
+/// first in the sort direction. A single-bound predicate 'probe.x <= build.y' is swept
+/// in descending order. The join then sweeps over the sorted probe rows one batch at a
+/// time and keeps the build rows whose band may still contain a future probe key in an
+/// unpinned BufferedTupleStream, the active set:
+///  1. Each build row in the active set is matched against the probe batch. Since the
+///     batch is sorted, the matching probe rows are a range that is found with two
+///     binary searches. Rows whose band ends before the largest key of the batch are
+///     dropped, the others are written to the active set of the next probe batch.
+///  2. Build rows whose band starts at or before the largest key of the batch are read
+///     from the build sorter, matched against the batch and added to the next active
+///     set. Build rows with a NULL bound never match.
+/// Each build row is therefore read once per probe batch while its band overlaps the
+/// probe keys, and each output row is produced once, instead of evaluating the
+/// predicates for all pairs of rows. The remaining join predicates are evaluated as
+/// conjuncts of the node.
+///
+/// The sorters materialize the input rows into sort tuples. The probe rows and the build
+/// rows that are returned are copied back into the tuple layout of the inputs, with
+/// var-len data referencing the sorted batches, which are attached to the output once
+/// they are no longer needed.
+///
+/// Both sorters and the streams of the active set share the node's buffer pool client.
+/// The reservation that the probe sorter and the streams need is saved while the build
+/// side is sorted, so that the merge of the build sorter can't use it.
+class BandJoinNode : public ExecNode {
+ public:
+  BandJoinNode(
+      ObjectPool* pool, const BandJoinPlanNode& pnode, const DescriptorTbl& descs);
+  virtual ~BandJoinNode();
+
+  virtual Status Prepare(RuntimeState* state) override;
+  virtual Status Open(RuntimeState* state) override;
+  virtual Status GetNext(RuntimeState* state, RowBatch* row_batch, bool* eos) override;
+  virtual Status Reset(RuntimeState* state, RowBatch* row_batch) override;
+  virtual void Close(RuntimeState* state) override;
+
+ protected:
+  virtual void DebugString(int indentation_level, std::stringstream* out) const override;
+
+ private:
+  /// Where GetNext() continues the sweep.
+  enum class SweepState {
+    /// Read the next probe batch and start matching it.
+    NEXT_PROBE_BATCH,
+    /// Matching the build rows of the active set.
+    MATCH_ACTIVE,
+    /// Matching the build rows that are added to the active set.
+    MATCH_NEW,
+    /// All output rows were returned.
+    DONE,
+  };
+
+  /// Feeds all rows of 'child_idx' to 'sorter' and sorts them.
+  Status SortInput(RuntimeState* state, int child_idx, Sorter* sorter) WARN_UNUSED_RESULT;
+
+  /// Reads the next sorted probe batch with at least one non-NULL key into
+  /// 'probe_batch_' and copies its rows into 'probe_rows_'. Sets 'state_' to DONE if
+  /// there are no more probe rows that can match.
+  Status NextProbeBatch(RuntimeState* state, RowBatch* out_batch) WARN_UNUSED_RESULT;
+
+  /// Swaps the active set that was written for the current probe batch with the one
+  /// that was read and prepares them for the next probe batch.
+  Status SwapActiveStreams(RuntimeState* state) WARN_UNUSED_RESULT;
+
+  /// Creates an unpinned stream of build sort tuples and prepares it for writing.
+  Status CreateActiveStream(RuntimeState* state,
+      std::unique_ptr<BufferedTupleStream>* stream) WARN_UNUSED_RESULT;
+
+  /// Returns -1, 0 or 1 if the value 'lhs' is before, equal to or after 'rhs' in the
+  /// direction of the sweep.
+  int CompareKeys(const void* lhs, const void* rhs) const;
+
+  /// Returns true if the probe key 'key' is inside the band that starts at 'start'.
+  bool IsAfterStart(const void* key, const void* start) const;
+
+  /// Returns true if the probe key 'key' is inside the band that ends at 'end'.
+  bool IsBeforeEnd(const void* key, const void* end) const;
+
+  /// Returns the largest probe key of the current probe batch.
+  const void* MaxProbeKey();
+
+  /// Sets 'match_begin_' and 'match_end_' to the range of rows in the current probe
+  /// batch that are inside the band from 'start' to 'end'. 'end' is nullptr if the band
+  /// has no end.
+  void FindMatchingProbeRows(const void* start, const void* end);
+
+  /// Matches 'build_row', a build sort tuple row, against the current probe batch and
+  /// adds it to 'next_active_stream_' if it can match a later probe batch. Returns
+  /// false in 'consumed' if the row starts after the current probe batch, which can
+  /// only happen if 'is_new' is true. Sets 'build_eos_' if a new row has a NULL start.
+  Status StartBuildRow(TupleRow* build_row, bool is_new, bool* consumed)
+      WARN_UNUSED_RESULT;
+
+  /// Adds the output rows of the current build row to 'out_batch' until it is full.
+  /// Returns true if all output rows of the build row were added.
+  bool OutputMatches(RowBatch* out_batch);
+
+  /// Copies the sort tuple of 'sort_row' into input tuples of 'side' that are allocated
+  /// from 'pool' and sets them in 'row'. Var-len data is not copied.
+  static void UnpackSortTuple(const BandJoinSortSide& side, TupleRow* sort_row,
+      MemPool* pool, TupleRow* row);
+
+  /// Transfers the resources of 'batch', which was read from the build sorter or the
+  /// active set, and the build rows unpacked from it to 'out_batch'.
+  void ReleaseBuildBatch(RowBatch* batch, RowBatch* out_batch);
+
+  /// Called once all build rows that can match the current probe batch were matched.
+  /// Transfers the resources of the probe batch and the active set that was read to
+  /// 'out_batch' and decides whether the sweep continues with the next probe batch.
+  void FinishProbeBatch(RowBatch* out_batch);
+
+  /// Transfers all resources that are still held to 'out_batch' at eos.
+  void TransferAllResources(RowBatch* out_batch);
+
+  /// Returns the reservation needed by the two streams of the active set.
+  int64_t ActiveStreamsReservation() const {
+    return 2 * resource_profile_.max_row_buffer_size;
+  }
+
+  /// Sweeps over the sorted inputs and adds output rows to 'out_batch'.
+  Status Sweep(RuntimeState* state, RowBatch* out_batch) WARN_UNUSED_RESULT;
+
+  const BandJoinSortSide& probe_side_;
+  const BandJoinSortSide& build_side_;
+
+  /// True if the probe keys are swept in ascending order.
+  const bool is_asc_;
+  const bool start_inclusive_;
+  const bool end_inclusive_;
+  const bool has_end_;
+
+  /// Type of the probe key and the bounds of the bands.
+  const ColumnType key_type_;
+
+  /// Number of tuples in the probe and build rows.
+  const int num_probe_tuples_;
+  const int num_build_tuples_;
+
+  /// Evaluators of the probe key. 'max_probe_key_eval_' is only used for the largest
+  /// key of the probe batch, so that its value stays valid while other keys are
+  /// evaluated.
+  ScalarExprEvaluator* probe_key_eval_ = nullptr;
+  ScalarExprEvaluator* max_probe_key_eval_ = nullptr;
+
+  /// Evaluators of the start and the optional end of the band of a build row.
+  ScalarExprEvaluator* build_start_eval_ = nullptr;
+  ScalarExprEvaluator* build_end_eval_ = nullptr;
+
+  /// Reservation for the probe sorter and the active set that is saved while the build
+  /// side is sorted.
+  BufferPool::SubReservation saved_reservation_;
+
+  /// Min and avg time spent in Sorter::AddBatch().
+  RuntimeProfile::SummaryStatsCounter* add_batch_timer_ = nullptr;
+
+  /// Number of probe batches that were swept.
+  RuntimeProfile::Counter* num_probe_batches_ = nullptr;
+
+  /// Number of times that a build row of the active set was matched against a probe
+  /// batch.
+  RuntimeProfile::Counter* num_active_rows_scanned_ = nullptr;
+
+  /////////////////////////////////////////
+  /// BEGIN: Members that must be Reset()
+
+  std::unique_ptr<Sorter> probe_sorter_;
+  std::unique_ptr<Sorter> build_sorter_;
+
+  SweepState state_ = SweepState::NEXT_PROBE_BATCH;
+
+  /// The current batch of sorted probe sort tuples, and its rows copied into the layout
+  /// of the probe input. 'num_probe_keys_' is the number of leading rows with a non-NULL
+  /// key. Only these rows are copied and can match.
+  std::unique_ptr<RowBatch> probe_batch_;
+  std::unique_ptr<RowBatch> probe_rows_;
+  int num_probe_keys_ = 0;
+
+  /// True if the probe sorter has no more rows with a non-NULL key.
+  bool probe_eos_ = false;
+
+  /// The current batch of sorted build sort tuples and the index of the next row to be
+  /// added to the active set.
+  std::unique_ptr<RowBatch> build_batch_;
+  int build_batch_pos_ = 0;
+
+  /// True if the build sorter returned its last batch.
+  bool build_sorter_eos_ = false;
+
+  /// True if no more build rows can be added to the active set.
+  bool build_eos_ = false;
+
+  /// The active set for the current probe batch, which is read, and the one for the next
+  /// probe batch, which is written.
+  std::unique_ptr<BufferedTupleStream> active_stream_;
+  std::unique_ptr<BufferedTupleStream> next_active_stream_;
+
+  /// The current batch read from 'active_stream_' and the index of the next row.
+  std::unique_ptr<RowBatch> active_batch_;
+  int active_batch_pos_ = 0;
+  bool active_eos_ = false;
+
+  /// Holds the build rows copied into the layout of the build input. Transferred to the
+  /// output together with the batches that the rows reference.
+  std::unique_ptr<MemPool> build_rows_pool_;
+
+  /// The build row whose output rows are being added, and the range of matching rows in
+  /// the current probe batch that were not output yet. 'current_build_row_' is in the
+  /// layout of the build input and is only copied from the sort tuple once the first
+  /// output row is added.
+  TupleRow* current_build_sort_row_ = nullptr;
+  TupleRow* current_build_row_ = nullptr;
+  int match_begin_ = 0;
+  int match_end_ = 0;
+
+  /// END: Members that must be Reset()
+  /////////////////////////////////////////
+};
+
+} // namespace impala
@@ -335,6 +335,7 @@ Status BlockingJoinNode::SendBuildInputToSink(
   DCHECK(!UseSeparateBuild(state->query_options()));
   RETURN_IF_ERROR(build_sink->Open(state));
   DCHECK_EQ(build_batch_->num_rows(), 0);
+  build_batch_->set_selection_allowed(build_sink->AcceptsSelection());
   bool eos = false;
   do {
     RETURN_IF_CANCELLED(state);
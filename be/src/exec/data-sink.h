@@ -134,6 +134,10 @@ class DataSink {
   /// make it possible to always acquire referenced memory.
   virtual Status Send(RuntimeState* state, RowBatch* batch) = 0;
 
+  /// Returns true if Send() only processes the active rows of a batch with a selection
+  /// vector (see RowBatch::set_selection_allowed()).
+  virtual bool AcceptsSelection() const { return false; }
+
   /// Flushes any remaining buffered state.
   /// Further Send() calls are illegal after FlushFinal(). This is to be called only
   /// before calling Close().
@@ -29,6 +29,7 @@
 #include "common/status.h"
 #include "exec/aggregation-node.h"
 #include "exec/analytic-eval-node.h"
+#include "exec/band-join-node.h"
 #include "exec/cardinality-check-node.h"
 #include "exec/data-source-scan-node.h"
 #include "exec/empty-set-node.h"
@@ -172,6 +173,9 @@ Status PlanNode::CreatePlanNode(
     case TPlanNodeType::NESTED_LOOP_JOIN_NODE:
       *node = pool->Add(new NestedLoopJoinPlanNode());
       break;
+    case TPlanNodeType::BAND_JOIN_NODE:
+      *node = pool->Add(new BandJoinPlanNode());
+      break;
     case TPlanNodeType::EMPTY_SET_NODE:
       *node = pool->Add(new EmptySetPlanNode());
       break;
@@ -21,6 +21,7 @@
 #include "exprs/scalar-expr-evaluator.h"
 #include "runtime/runtime-filter.inline.h"
 #include "runtime/tuple-row.h"
+#include "util/bitmap-filter.h"
 #include "util/min-max-filter.h"
 #include "util/runtime-profile-counters.h"
 #include "service/hs2-util.h"
@@ -90,6 +91,9 @@ void FilterContext::Insert(TupleRow* row) const noexcept {
     if (local_min_max_filter == nullptr || local_min_max_filter->AlwaysTrue()) return;
     void* val = expr_eval->GetValue(row);
     local_min_max_filter->Insert(val);
+  } else if (filter->is_bitmap_filter()) {
+    if (local_bitmap_filter == nullptr || local_bitmap_filter->AlwaysTrue()) return;
+    local_bitmap_filter->Insert(expr_eval->GetValue(row), expr_eval->root().type());
   } else {
     DCHECK(filter->is_in_list_filter());
     if (local_in_list_filter == nullptr || local_in_list_filter->AlwaysTrue()) return;
@@ -392,6 +396,8 @@ Status FilterContext::CodegenInsert(LlvmCodeGen* codegen, ScalarExpr* filter_exp
   llvm::Value* local_filter_arg;
   // The function for inserting into the in-list filter.
   llvm::Function* insert_in_list_filter_fn = nullptr;
+  // The function for inserting into the bitmap filter.
+  llvm::Function* insert_bitmap_filter_fn = nullptr;
   if (filter_desc.type == TRuntimeFilterType::BLOOM) {
     // Load 'local_bloom_filter' from 'this_arg' FilterContext object.
     llvm::Value* local_bloom_filter_ptr =
@@ -409,6 +415,40 @@ Status FilterContext::CodegenInsert(LlvmCodeGen* codegen, ScalarExpr* filter_exp
         local_min_max_filter_ptr, min_max_filter_type, "cast_min_max_filter_ptr");
     local_filter_arg =
         builder.CreateLoad(local_min_max_filter_ptr, "local_min_max_filter_arg");
+  } else if (filter_desc.type == TRuntimeFilterType::BITMAP) {
+    // Load 'local_bitmap_filter' from 'this_arg' FilterContext object.
+    llvm::Value* local_bitmap_filter_ptr =
+        builder.CreateStructGEP(nullptr, this_arg, 6, "local_bitmap_filter_ptr");
+    switch (filter_expr->type().type) {
+      case TYPE_TINYINT:
+        insert_bitmap_filter_fn = codegen->GetFunction(
+            IRFunction::TINYINT_BITMAP_FILTER_INSERT, false);
+        break;
+      case TYPE_SMALLINT:
+        insert_bitmap_filter_fn = codegen->GetFunction(
+            IRFunction::SMALLINT_BITMAP_FILTER_INSERT, false);
+        break;
+      case TYPE_INT:
+      case TYPE_DATE:
+        // DateValue only holds the int32_t days since epoch.
+        insert_bitmap_filter_fn = codegen->GetFunction(
+            IRFunction::INT_BITMAP_FILTER_INSERT, false);
+        break;
+      case TYPE_BIGINT:
+        insert_bitmap_filter_fn = codegen->GetFunction(
+            IRFunction::BIGINT_BITMAP_FILTER_INSERT, false);
+        break;
+      default:
+        DCHECK(false);
+        return Status("Unsupported type for bitmap filter: " +
+            filter_expr->type().DebugString());
+    }
+    llvm::PointerType* bitmap_filter_type =
+        codegen->GetPtrType(insert_bitmap_filter_fn->arg_begin()->getType());
+    local_bitmap_filter_ptr = builder.CreatePointerCast(
+        local_bitmap_filter_ptr, bitmap_filter_type, "cast_bitmap_filter_ptr");
+    local_filter_arg =
+        builder.CreateLoad(local_bitmap_filter_ptr, "local_bitmap_filter_arg");
   } else {
     DCHECK(filter_desc.type == TRuntimeFilterType::IN_LIST);
     // Load 'local_in_list_filter' from 'this_arg' FilterContext object.
@@ -581,6 +621,10 @@ Status FilterContext::CodegenInsert(LlvmCodeGen* codegen, ScalarExpr* filter_exp
 
     llvm::Value* insert_filter_args[] = {local_filter_arg, val_ptr_phi};
     builder.CreateCall(min_max_insert_fn, insert_filter_args);
+  } else if (filter_desc.type == TRuntimeFilterType::BITMAP) {
+    DCHECK(insert_bitmap_filter_fn != nullptr);
+    llvm::Value* insert_filter_args[] = {local_filter_arg, val_ptr_phi};
+    builder.CreateCall(insert_bitmap_filter_fn, insert_filter_args);
   } else {
     DCHECK(filter_desc.type == TRuntimeFilterType::IN_LIST);
     DCHECK(insert_in_list_filter_fn != nullptr);
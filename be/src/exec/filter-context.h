@@ -29,6 +29,7 @@ class Function;
 
 namespace impala {
 
+class BitmapFilter;
 class BloomFilter;
 class LlvmCodeGen;
 class MinMaxFilter;
@@ -106,6 +107,9 @@ struct FilterContext {
   /// Working copy of local in-list filter
   InListFilter* local_in_list_filter = nullptr;
 
+  /// Working copy of local bitmap filter
+  BitmapFilter* local_bitmap_filter = nullptr;
+
   /// Struct name in LLVM IR.
   static const char* LLVM_CLASS_NAME;
 
@@ -119,8 +123,9 @@ struct FilterContext {
   /// a match in 'filter'. Returns false otherwise.
   bool Eval(TupleRow* row) const noexcept;
 
-  /// Evaluates 'row' with 'expr_eval' and inserts the value into 'local_bloom_filter'
-  /// or 'local_min_max_filter' as appropriate.
+  /// Evaluates 'row' with 'expr_eval' and inserts the value into 'local_bloom_filter',
+  /// 'local_min_max_filter', 'local_in_list_filter' or 'local_bitmap_filter' as
+  /// appropriate.
   void Insert(TupleRow* row) const noexcept;
 
   /// Implements different flavors of insertion based on filter type and comparison
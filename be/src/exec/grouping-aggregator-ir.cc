@@ -38,16 +38,16 @@ Status GroupingAggregator::AddBatchImpl(RowBatch* batch,
   // will end up to the same partition.
   // TODO: Once we have a histogram with the number of rows per partition, we will have
   // accurate resize calls.
-  RETURN_IF_ERROR(
-      CheckAndResizeHashPartitions(AGGREGATED_ROWS, batch->num_rows(), ht_ctx));
+  // Only the active rows are processed if 'batch' has a selection vector.
+  const int num_rows = batch->num_active_rows();
+  RETURN_IF_ERROR(CheckAndResizeHashPartitions(AGGREGATED_ROWS, num_rows, ht_ctx));
 
   HashTableCtx::ExprValuesCache* expr_vals_cache = ht_ctx->expr_values_cache();
   const int cache_size = expr_vals_cache->capacity();
-  const int num_rows = batch->num_rows();
   for (int group_start = 0; group_start < num_rows; group_start += cache_size) {
     EvalAndHashPrefetchGroup<AGGREGATED_ROWS>(batch, group_start, prefetch_mode, ht_ctx);
 
-    FOREACH_ROW_LIMIT(batch, group_start, cache_size, batch_iter) {
+    FOREACH_ACTIVE_ROW_LIMIT(batch, group_start, cache_size, batch_iter) {
       RETURN_IF_ERROR(ProcessRow<AGGREGATED_ROWS>(batch_iter.Get(), ht_ctx,
           has_more_rows));
       expr_vals_cache->NextRow();
@@ -64,14 +64,18 @@ void IR_ALWAYS_INLINE GroupingAggregator::EvalAndHashPrefetchGroup(RowBatch* bat
   const int cache_size = expr_vals_cache->capacity();
 
   expr_vals_cache->Reset();
-  FOREACH_ROW_LIMIT(batch, start_row_idx, cache_size, batch_iter) {
+  int row_idx = start_row_idx;
+  FOREACH_ACTIVE_ROW_LIMIT(batch, start_row_idx, cache_size, batch_iter) {
     TupleRow* row = batch_iter.Get();
     bool is_null;
     if (AGGREGATED_ROWS) {
       is_null = !ht_ctx->EvalAndHashBuild(row);
     } else {
-      is_null = !ht_ctx->EvalAndHashProbe(row);
+      // Radix partitioned rows were already hashed by RadixPartitionBatch().
+      is_null = !ht_ctx->EvalAndHashProbe(
+          row, radix_hashes_ == nullptr ? nullptr : radix_hashes_ + row_idx);
     }
+    ++row_idx;
     // Hoist lookups out of non-null branch to speed up non-null case.
     const uint32_t hash = expr_vals_cache->CurExprValuesHash();
     const uint32_t partition_idx = hash >> (32 - NUM_PARTITIONING_BITS);
@@ -115,15 +119,13 @@ Status GroupingAggregator::ProcessRow(
   HashTable::Iterator it =
       hash_tbl->FindBuildRowBucket<BucketType::MATCH_UNSET>(ht_ctx, &found);
   DCHECK(!it.AtEnd()) << "Hash table had no free buckets";
-  if (AGGREGATED_ROWS) {
-    // If the row is already an aggregate row, it cannot match anything in the
-    // hash table since we process the aggregate rows first. These rows should
-    // have been aggregated in the initial pass.
-    DCHECK(!found);
-  } else if (found) {
-    // Row is already in hash table. Do the aggregation and we're done.
-    UpdateTuple(
-        dst_partition->agg_fn_evals.data(), it.GetTuple<BucketType::MATCH_UNSET>(), row);
+  if (found) {
+    // Row is already in hash table. Do the aggregation and we're done. Aggregated rows
+    // are processed first, so they only match each other if the spill cache wrote
+    // multiple partial aggregates of the group. These are merged.
+    DCHECK(!AGGREGATED_ROWS || use_spill_cache_);
+    UpdateTuple(dst_partition->agg_fn_evals.data(),
+        it.GetTuple<BucketType::MATCH_UNSET>(), row, AGGREGATED_ROWS);
     return Status::OK();
   }
 
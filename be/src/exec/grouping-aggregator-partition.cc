@@ -28,6 +28,7 @@
 #include "runtime/mem-pool.h"
 #include "runtime/row-batch.h"
 #include "runtime/runtime-state.h"
+#include "runtime/tuple.h"
 #include "util/runtime-profile-counters.h"
 
 #include "gen-cpp/PlanNodes_types.h"
@@ -89,7 +90,8 @@ Status GroupingAggregator::Partition::InitHashTable(bool* got_memory) {
   // It might be reasonable to limit individual hash table size for other reasons
   // though. Always start with small buffers.
   hash_tbl.reset(HashTable::Create(parent->ht_allocator_.get(), false, 1, nullptr,
-      1L << (32 - NUM_PARTITIONING_BITS), PAGG_DEFAULT_HASH_TABLE_SZ));
+      1L << (32 - NUM_PARTITIONING_BITS), PAGG_DEFAULT_HASH_TABLE_SZ,
+      parent->ht_ctx_->group_probing()));
   // Please update the error message in CreateHashPartitions() if initial size of
   // hash table changes.
   Status status = hash_tbl->Init(got_memory);
@@ -222,16 +224,9 @@ Status GroupingAggregator::Partition::Spill(bool more_aggregate_rows) {
   // continue appending rows to one of the streams in the partition.
   DCHECK(aggregated_row_stream->has_write_iterator());
   DCHECK(!unaggregated_row_stream->has_write_iterator());
-  if (more_aggregate_rows) {
-    RETURN_IF_ERROR(aggregated_row_stream->UnpinStream(
-        BufferedTupleStream::UNPIN_ALL_EXCEPT_CURRENT));
-  } else {
-    RETURN_IF_ERROR(aggregated_row_stream->UnpinStream(BufferedTupleStream::UNPIN_ALL));
-    bool got_buffer;
-    RETURN_IF_ERROR(unaggregated_row_stream->PrepareForWrite(&got_buffer));
-    DCHECK(got_buffer) << "Accounted in min reservation"
-                       << parent->buffer_pool_client()->DebugString();
-  }
+  RETURN_IF_ERROR(aggregated_row_stream->UnpinStream(
+      BufferedTupleStream::UNPIN_ALL_EXCEPT_CURRENT));
+  if (!more_aggregate_rows) RETURN_IF_ERROR(PrepareForUnaggregatedRows());
 
   COUNTER_ADD(parent->num_spilled_partitions_, 1);
   if (parent->num_spilled_partitions_->value() == 1) {
@@ -240,9 +235,175 @@ Status GroupingAggregator::Partition::Spill(bool more_aggregate_rows) {
   return Status::OK();
 }
 
+Status GroupingAggregator::Partition::PrepareForUnaggregatedRows() {
+  DCHECK(is_spilled());
+  DCHECK(!has_spill_cache());
+  DCHECK(!unaggregated_row_stream->has_write_iterator());
+  if (parent->use_spill_cache_) {
+    // The partial aggregates are appended to the aggregated stream, so it keeps its
+    // write buffer and the unaggregated stream does not need one.
+    DCHECK(aggregated_row_stream->has_write_iterator());
+    DCHECK_EQ(agg_fn_evals.size(), 0);
+    agg_fn_perm_pool.reset(new MemPool(parent->expr_mem_tracker_.get()));
+    AggFnEvaluator::ShallowClone(parent->partition_pool_.get(), agg_fn_perm_pool.get(),
+        parent->expr_results_pool_.get(), parent->agg_fn_evals_, &agg_fn_evals);
+    spill_cache_pool.reset(new MemPool(parent->spill_cache_mem_tracker_.get()));
+    spill_cache.assign(SPILL_CACHE_ENTRIES, nullptr);
+    spill_cache_hashes.assign(SPILL_CACHE_ENTRIES, 0);
+    spill_cache_input_rows = 0;
+    spill_cache_output_rows = 0;
+    spill_cache_rows_until_check = SPILL_CACHE_CHECK_ROWS;
+    return Status::OK();
+  }
+  RETURN_IF_ERROR(aggregated_row_stream->UnpinStream(BufferedTupleStream::UNPIN_ALL));
+  bool got_buffer;
+  RETURN_IF_ERROR(unaggregated_row_stream->PrepareForWrite(&got_buffer));
+  DCHECK(got_buffer) << "Accounted in min reservation"
+                     << parent->buffer_pool_client()->DebugString();
+  return Status::OK();
+}
+
+Status GroupingAggregator::Partition::AggregateIntoSpillCache(TupleRow* row) {
+  DCHECK(is_spilled());
+  DCHECK(has_spill_cache());
+  if (--spill_cache_rows_until_check == 0) {
+    spill_cache_rows_until_check = SPILL_CACHE_CHECK_ROWS;
+    if (!SpillCachePaysOff()) {
+      // The groups are too sparse to be aggregated in the cache.
+      VLOG(2) << "Disabling spill cache of " << DebugString() << " after "
+              << spill_cache_input_rows << " rows";
+      return DisableSpillCache(row);
+    }
+  }
+
+  HashTableCtx* ht_ctx = parent->ht_ctx_.get();
+  const uint32_t hash = ht_ctx->expr_values_cache()->CurExprValuesHash();
+  const int idx = hash & (SPILL_CACHE_ENTRIES - 1);
+  ++spill_cache_input_rows;
+  Tuple* cached_tuple = spill_cache[idx];
+  if (cached_tuple != nullptr && spill_cache_hashes[idx] == hash
+      && ht_ctx->CurrentRowEquals(reinterpret_cast<TupleRow*>(&cached_tuple))) {
+    parent->UpdateTuple(agg_fn_evals.data(), cached_tuple, row);
+    return Status::OK();
+  }
+
+  // Construct the new tuple from the current row of 'ht_ctx' before evicting the old
+  // one, since evicting it may spill other partitions.
+  Status status;
+  Tuple* tuple =
+      parent->ConstructIntermediateTuple(agg_fn_evals, spill_cache_pool.get(), &status);
+  if (UNLIKELY(tuple == nullptr)) {
+    // The cache is allocated outside of the reservation. It is only an optimization, so
+    // turn it off instead of failing the query if the memory is not available.
+    if (status.code() != TErrorCode::MEM_LIMIT_EXCEEDED) return status;
+    VLOG(2) << "Disabling spill cache of " << DebugString() << " after "
+            << spill_cache_input_rows << " rows: " << status.GetDetail();
+    return DisableSpillCache(row);
+  }
+  parent->UpdateTuple(agg_fn_evals.data(), tuple, row);
+  ++spill_cache_output_rows;
+  if (cached_tuple != nullptr) RETURN_IF_ERROR(SpillCachedTuple(cached_tuple));
+  spill_cache[idx] = tuple;
+  spill_cache_hashes[idx] = hash;
+  if (spill_cache_pool->total_allocated_bytes() > SPILL_CACHE_MAX_BYTES) {
+    RETURN_IF_ERROR(FlushSpillCache(/* release */ false));
+  }
+  return Status::OK();
+}
+
+Status GroupingAggregator::Partition::DisableSpillCache(TupleRow* row) {
+  DCHECK(has_spill_cache());
+  COUNTER_ADD(parent->num_spill_caches_disabled_, 1);
+  RETURN_IF_ERROR(FlushSpillCache(/* release */ true));
+  RETURN_IF_ERROR(aggregated_row_stream->UnpinStream(BufferedTupleStream::UNPIN_ALL));
+  bool got_buffer;
+  RETURN_IF_ERROR(unaggregated_row_stream->PrepareForWrite(&got_buffer));
+  DCHECK(got_buffer) << "Accounted in min reservation"
+                     << parent->buffer_pool_client()->DebugString();
+  return parent->AppendToSpilledStream(unaggregated_row_stream.get(), row,
+      /* more_aggregate_rows */ false);
+}
+
+bool GroupingAggregator::Partition::SpillCachePaysOff() const {
+  // Estimate the bytes spilled with and without the cache from the fixed-length parts
+  // of the rows. Each tuple created in the cache is eventually spilled.
+  int64_t input_row_size = 0;
+  for (const TupleDescriptor* desc : parent->input_row_desc_.tuple_descriptors()) {
+    input_row_size += desc->byte_size();
+  }
+  int64_t cached_bytes =
+      spill_cache_output_rows * parent->intermediate_tuple_desc_->byte_size();
+  return cached_bytes < spill_cache_input_rows * input_row_size;
+}
+
+Status GroupingAggregator::Partition::SpillCachedTuple(Tuple* tuple) {
+  if (parent->needs_serialize_) AggFnEvaluator::Serialize(agg_fn_evals, tuple);
+  return parent->AppendToSpilledStream(aggregated_row_stream.get(),
+      reinterpret_cast<TupleRow*>(&tuple), /* more_aggregate_rows */ false);
+}
+
+Status GroupingAggregator::Partition::FlushSpillCache(bool release) {
+  DCHECK(has_spill_cache());
+  for (Tuple*& tuple : spill_cache) {
+    if (tuple == nullptr) continue;
+    Tuple* evicted_tuple = tuple;
+    tuple = nullptr;
+    RETURN_IF_ERROR(SpillCachedTuple(evicted_tuple));
+  }
+  if (release) {
+    ReleaseSpillCache(/* cleanup_tuples */ false);
+    return Status::OK();
+  }
+  // All tuples were copied to the stream. Keep the chunks of the pool for the next
+  // tuples.
+  spill_cache_pool->Clear();
+  if (agg_fn_perm_pool->total_allocated_bytes() > SPILL_CACHE_MAX_BYTES) {
+    // Free the memory allocated by UDAs for the evicted tuples.
+    AggFnEvaluator::Close(agg_fn_evals, parent->state_);
+    agg_fn_evals.clear();
+    agg_fn_perm_pool->FreeAll();
+    AggFnEvaluator::ShallowClone(parent->partition_pool_.get(), agg_fn_perm_pool.get(),
+        parent->expr_results_pool_.get(), parent->agg_fn_evals_, &agg_fn_evals);
+  }
+  return Status::OK();
+}
+
+void GroupingAggregator::Partition::ReleaseSpillCache(bool cleanup_tuples) {
+  if (!has_spill_cache()) return;
+  if (cleanup_tuples && (parent->needs_finalize_ || parent->needs_serialize_)) {
+    // Same as CleanupHashTbl(), call Finalize() or Serialize() on the tuples to free any
+    // memory allocated by UDAs.
+    Tuple* dummy_dst = nullptr;
+    if (parent->needs_finalize_) {
+      dummy_dst = Tuple::Create(
+          parent->output_tuple_desc_->byte_size(), parent->tuple_pool_.get());
+    }
+    for (Tuple* tuple : spill_cache) {
+      if (tuple == nullptr) continue;
+      if (parent->needs_finalize_) {
+        AggFnEvaluator::Finalize(agg_fn_evals, tuple, dummy_dst);
+      } else {
+        AggFnEvaluator::Serialize(agg_fn_evals, tuple);
+      }
+      parent->expr_results_pool_->Clear();
+    }
+  }
+  COUNTER_ADD(parent->num_spill_cache_input_rows_, spill_cache_input_rows);
+  COUNTER_ADD(parent->num_spill_cache_output_rows_, spill_cache_output_rows);
+  std::vector<Tuple*>().swap(spill_cache);
+  std::vector<uint32_t>().swap(spill_cache_hashes);
+  spill_cache_pool->FreeAll();
+  spill_cache_pool.reset();
+  AggFnEvaluator::Close(agg_fn_evals, parent->state_);
+  agg_fn_evals.clear();
+  agg_fn_perm_pool->FreeAll();
+  agg_fn_perm_pool.reset();
+}
+
 void GroupingAggregator::Partition::Close(bool finalize_rows) {
   if (is_closed) return;
   is_closed = true;
+  ReleaseSpillCache(finalize_rows);
   if (aggregated_row_stream.get() != nullptr) {
     if (finalize_rows && hash_tbl.get() != nullptr) {
       // We need to walk all the rows and Finalize them here so the UDA gets a chance
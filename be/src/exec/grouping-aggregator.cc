@@ -38,6 +38,8 @@
 #include "runtime/string-value.h"
 #include "runtime/tuple-row.h"
 #include "runtime/tuple.h"
+#include "util/bit-util.h"
+#include "util/debug-util.h"
 #include "util/runtime-profile-counters.h"
 #include "util/string-parser.h"
 
@@ -119,8 +121,9 @@ Status GroupingAggregatorConfig::Init(
     needs_serialize_ |= aggregate_functions_[i]->SupportsSerialize();
   }
 
-  hash_table_config_ = state->obj_pool()->Add(new HashTableConfig(
-      build_exprs_, grouping_exprs_, true, vector<bool>(build_exprs_.size(), true)));
+  hash_table_config_ = state->obj_pool()->Add(new HashTableConfig(build_exprs_,
+      grouping_exprs_, true, vector<bool>(build_exprs_.size(), true),
+      state->query_options().hash_table_group_probing));
   return Status::OK();
 }
 
@@ -184,8 +187,32 @@ Status GroupingAggregator::Prepare(RuntimeState* state) {
     num_repartitions_ = ADD_COUNTER(runtime_profile(), "NumRepartitions", TUnit::UNIT);
     num_spilled_partitions_ =
         ADD_COUNTER(runtime_profile(), "SpilledPartitions", TUnit::UNIT);
+    use_spill_cache_ = state->query_options().spilled_agg_preagg;
+    if (!needs_serialize_) {
+      // Var-len aggregate slots are stored outside of the aggregated stream unless they
+      // are serialized, so partial aggregates with them can not be spilled.
+      auto agg_slot = intermediate_tuple_desc_->slots().begin() + grouping_exprs_.size();
+      for (; agg_slot != intermediate_tuple_desc_->slots().end(); ++agg_slot) {
+        if ((*agg_slot)->type().IsVarLenStringType()) use_spill_cache_ = false;
+      }
+    }
+    if (use_spill_cache_) {
+      num_spill_cache_input_rows_ =
+          ADD_COUNTER(runtime_profile(), "SpillCacheInputRows", TUnit::UNIT);
+      num_spill_cache_output_rows_ =
+          ADD_COUNTER(runtime_profile(), "SpillCacheOutputRows", TUnit::UNIT);
+      num_spill_caches_disabled_ =
+          ADD_COUNTER(runtime_profile(), "SpillCachesDisabled", TUnit::UNIT);
+      // The debug action simulates that no memory is left for the spill caches.
+      int64_t spill_cache_limit =
+          DebugAction(state->query_options(), "AGG_SPILL_CACHE_NO_MEM").ok() ? -1 : 0;
+      spill_cache_mem_tracker_.reset(
+          new MemTracker(spill_cache_limit, "SpillCaches", mem_tracker_.get(), false));
+    }
     max_partition_level_ =
         runtime_profile()->AddHighWaterMarkCounter("MaxPartitionLevel", TUnit::UNIT);
+    num_radix_partitioned_rows_ =
+        ADD_COUNTER(runtime_profile(), "RowsRadixPartitioned", TUnit::UNIT);
   }
 
   RETURN_IF_ERROR(HashTableCtx::Create(pool_, state, hash_table_config_,
@@ -435,11 +462,14 @@ Status GroupingAggregator::Reset(RuntimeState* state, RowBatch* row_batch) {
     output_partition_->aggregated_row_stream->Close(
         row_batch, RowBatch::FlushMode::FLUSH_RESOURCES);
   }
+  Status status = ReleaseRadixBuffers();
   ClosePartitions();
-  return Status::OK();
+  return status;
 }
 
 void GroupingAggregator::Close(RuntimeState* state) {
+  FreeRadixBuffers();
+  radix_batch_.reset();
   ClosePartitions();
 
   if (tuple_pool_.get() != nullptr) tuple_pool_->FreeAll();
@@ -455,6 +485,7 @@ void GroupingAggregator::Close(RuntimeState* state) {
   large_read_page_reservation_.Close();
   reservation_manager_.Close(state);
   if (reservation_tracker_ != nullptr) reservation_tracker_->Close();
+  if (spill_cache_mem_tracker_ != nullptr) spill_cache_mem_tracker_->Close();
   // Must be called after tuple_pool_ is freed, so that mem_tracker_ can be closed.
   Aggregator::Close(state);
 }
@@ -462,19 +493,178 @@ void GroupingAggregator::Close(RuntimeState* state) {
 Status GroupingAggregator::AddBatch(RuntimeState* state, RowBatch* batch) {
   SCOPED_TIMER(build_timer_);
   RETURN_IF_ERROR(QueryMaintenance(state));
-  num_input_rows_ += batch->num_rows();
+  num_input_rows_ += batch->num_active_rows();
+
+  // Once the hash tables are larger than the CPU caches, most rows of a high-cardinality
+  // aggregation miss the cache. The input is then radix partitioned first: the rows are
+  // buffered per hash partition and a buffer is aggregated at once, so that a single
+  // hash table is accessed at a time.
+  if (!radix_buffers_.empty()) return RadixPartitionBatch(batch);
+  RETURN_IF_ERROR(ProcessInputBatch(batch));
+  if (ShouldRadixPartition()) RETURN_IF_ERROR(StartRadixPartitioning());
+  return Status::OK();
+}
 
-  TPrefetchMode::type prefetch_mode = state->query_options().prefetch_mode;
+Status GroupingAggregator::ProcessInputBatch(RowBatch* batch) {
+  TPrefetchMode::type prefetch_mode = state_->query_options().prefetch_mode;
   GroupingAggregatorConfig::AddBatchImplFn add_batch_impl_fn = add_batch_impl_fn_.load();
   if (add_batch_impl_fn != nullptr) {
     RETURN_IF_ERROR(add_batch_impl_fn(this, batch, prefetch_mode, ht_ctx_.get(), true));
   } else {
     RETURN_IF_ERROR(AddBatchImpl<false>(batch, prefetch_mode, ht_ctx_.get(), true));
   }
+  return Status::OK();
+}
+
+bool GroupingAggregator::ShouldRadixPartition() const {
+  if (!state_->query_options().agg_radix_partitioning) return false;
+  int64_t ht_mem = 0;
+  int64_t ht_rows = 0;
+  for (const Partition* partition : hash_partitions_) {
+    if (partition->is_spilled()) continue;
+    ht_mem += partition->hash_tbl->CurrentMemSize();
+    ht_mem += partition->aggregated_row_stream->BytesPinned(false);
+    ht_rows += partition->hash_tbl->size();
+  }
+  return ht_mem >= RADIX_PARTITIONING_MIN_HT_BYTES
+      && ht_rows >= num_input_rows_ * RADIX_PARTITIONING_MIN_GROUP_RATIO;
+}
 
+Status GroupingAggregator::StartRadixPartitioning() {
+  DCHECK(radix_buffers_.empty());
+  BufferPool* buffer_pool = ExecEnv::GetInstance()->buffer_pool();
+  radix_buffer_len_ = buffer_pool->min_buffer_len();
+  if (radix_buffer_len_ < RADIX_BUFFER_LEN) radix_buffer_len_ = RADIX_BUFFER_LEN;
+  // The buffers must not take away reservation that the partitions need to grow their
+  // hash tables or to spill, so the reservation is increased for them.
+  if (!buffer_pool_client()->IncreaseReservation(radix_buffer_len_ * PARTITION_FANOUT)) {
+    VLOG(2) << "Not radix partitioning the input of aggregator " << id_
+            << ": could not increase the reservation";
+    return Status::OK();
+  }
+  VLOG(2) << "Radix partitioning the input of aggregator " << id_ << " after "
+          << num_input_rows_ << " rows";
+  if (radix_batch_ == nullptr) {
+    radix_batch_.reset(
+        new RowBatch(&input_row_desc_, state_->batch_size(), mem_tracker_.get()));
+  }
+  radix_buffers_.reserve(PARTITION_FANOUT);
+  for (int i = 0; i < PARTITION_FANOUT; ++i) {
+    radix_buffers_.emplace_back();
+    RadixBuffer* buffer = &radix_buffers_.back();
+    RETURN_IF_ERROR(buffer_pool->AllocateBuffer(
+        buffer_pool_client(), radix_buffer_len_, &buffer->buffer));
+    buffer->rows.reserve(state_->batch_size());
+    buffer->hashes.reserve(state_->batch_size());
+  }
   return Status::OK();
 }
 
+Status GroupingAggregator::RadixPartitionBatch(RowBatch* batch) {
+  DCHECK_EQ(radix_buffers_.size(), PARTITION_FANOUT);
+  HashTableCtx::ExprValuesCache* expr_vals_cache = ht_ctx_->expr_values_cache();
+  const vector<TupleDescriptor*>& descs = input_row_desc_.tuple_descriptors();
+  const int num_tuples = descs.size();
+  const int64_t row_ptrs_len = num_tuples * sizeof(Tuple*);
+  FOREACH_ACTIVE_ROW(batch, 0, batch_iter) {
+    TupleRow* row = batch_iter.Get();
+    // Only the first row of the cache is used to compute the hash. AddBatchImpl()
+    // evaluates the grouping exprs again when the buffer is aggregated, but uses this
+    // hash.
+    expr_vals_cache->Reset();
+    if (!ht_ctx_->EvalAndHashProbe(row)) continue;
+    uint32_t hash = expr_vals_cache->CurExprValuesHash();
+    RadixBuffer* buffer = &radix_buffers_[hash >> (32 - NUM_PARTITIONING_BITS)];
+
+    int64_t row_len = row_ptrs_len;
+    for (int i = 0; i < num_tuples; ++i) {
+      Tuple* tuple = row->GetTuple(i);
+      if (tuple != nullptr) row_len += tuple->TotalByteSize(*descs[i]);
+    }
+    if (row_len > radix_buffer_len_) {
+      // The row is too large for any buffer and still valid, so it is aggregated now.
+      COUNTER_ADD(num_radix_partitioned_rows_, 1);
+      RETURN_IF_ERROR(AggregateRadixRows(&row, &hash, 1));
+      continue;
+    }
+    if (buffer->bytes_used + row_len > radix_buffer_len_
+        || static_cast<int>(buffer->rows.size()) == radix_batch_->capacity()) {
+      RETURN_IF_ERROR(FlushRadixBuffer(buffer));
+    }
+
+    // The row is copied as its tuple pointers, followed by its tuples. Rows start at
+    // a multiple of the pointer size, so that the tuple pointers are aligned.
+    uint8_t* data = buffer->buffer.data() + buffer->bytes_used;
+    TupleRow* dst = reinterpret_cast<TupleRow*>(data);
+    char* tuple_data = reinterpret_cast<char*>(data + row_ptrs_len);
+    int offset = 0;
+    for (int i = 0; i < num_tuples; ++i) {
+      Tuple* tuple = row->GetTuple(i);
+      if (tuple == nullptr) {
+        dst->SetTuple(i, nullptr);
+      } else {
+        dst->SetTuple(i, reinterpret_cast<Tuple*>(tuple_data));
+        tuple->DeepCopy(*descs[i], &tuple_data, &offset);
+      }
+    }
+    DCHECK_EQ(row_ptrs_len + offset, row_len);
+    buffer->bytes_used = min(radix_buffer_len_,
+        BitUtil::RoundUpToPowerOf2(buffer->bytes_used + row_len, sizeof(Tuple*)));
+    buffer->rows.push_back(dst);
+    buffer->hashes.push_back(hash);
+  }
+  return Status::OK();
+}
+
+Status GroupingAggregator::AggregateRadixRows(
+    TupleRow** rows, const uint32_t* hashes, int num_rows) {
+  DCHECK_LE(num_rows, radix_batch_->capacity());
+  for (int i = 0; i < num_rows; ++i) {
+    radix_batch_->CopyRow(rows[i], radix_batch_->GetRow(i));
+  }
+  radix_batch_->CommitRows(num_rows);
+  radix_hashes_ = hashes;
+  Status status = ProcessInputBatch(radix_batch_.get());
+  radix_hashes_ = nullptr;
+  radix_batch_->Reset();
+  RETURN_IF_ERROR(status);
+  return QueryMaintenance(state_);
+}
+
+Status GroupingAggregator::FlushRadixBuffer(RadixBuffer* buffer) {
+  COUNTER_ADD(num_radix_partitioned_rows_, buffer->rows.size());
+  RETURN_IF_ERROR(AggregateRadixRows(
+      buffer->rows.data(), buffer->hashes.data(), buffer->rows.size()));
+  buffer->bytes_used = 0;
+  buffer->rows.clear();
+  buffer->hashes.clear();
+  return Status::OK();
+}
+
+Status GroupingAggregator::FlushRadixBuffers() {
+  if (radix_buffers_.empty()) return Status::OK();
+  for (RadixBuffer& buffer : radix_buffers_) RETURN_IF_ERROR(FlushRadixBuffer(&buffer));
+  return ReleaseRadixBuffers();
+}
+
+Status GroupingAggregator::ReleaseRadixBuffers() {
+  if (radix_buffers_.empty()) return Status::OK();
+  FreeRadixBuffers();
+  // Release the reservation of the buffers, so that it is available to other operators.
+  const int64_t radix_reservation = radix_buffer_len_ * PARTITION_FANOUT;
+  return buffer_pool_client()->DecreaseReservationTo(radix_reservation,
+      max(resource_profile_.min_reservation,
+          buffer_pool_client()->GetReservation() - radix_reservation));
+}
+
+void GroupingAggregator::FreeRadixBuffers() {
+  BufferPool* buffer_pool = ExecEnv::GetInstance()->buffer_pool();
+  for (RadixBuffer& buffer : radix_buffers_) {
+    buffer_pool->FreeBuffer(buffer_pool_client(), &buffer.buffer);
+  }
+  radix_buffers_.clear();
+}
+
 Status GroupingAggregator::AddBatchStreaming(
     RuntimeState* state, RowBatch* out_batch, RowBatch* child_batch, bool* eos) {
   RETURN_IF_ERROR(QueryMaintenance(state));
@@ -528,6 +718,8 @@ Status GroupingAggregator::AddBatchStreaming(
 }
 
 Status GroupingAggregator::InputDone() {
+  RETURN_IF_ERROR(FlushRadixBuffers());
+  RETURN_IF_ERROR(FlushSpillCaches());
   return MoveHashPartitions(num_input_rows_);
 }
 
@@ -657,9 +849,17 @@ Status GroupingAggregator::AppendSpilledRow(
     Partition* __restrict__ partition, TupleRow* __restrict__ row) {
   DCHECK(!is_streaming_preagg_);
   DCHECK(partition->is_spilled());
+  if (!AGGREGATED_ROWS && partition->has_spill_cache()) {
+    return partition->AggregateIntoSpillCache(row);
+  }
   BufferedTupleStream* stream = AGGREGATED_ROWS ?
       partition->aggregated_row_stream.get() :
       partition->unaggregated_row_stream.get();
+  return AppendToSpilledStream(stream, row, AGGREGATED_ROWS);
+}
+
+Status GroupingAggregator::AppendToSpilledStream(BufferedTupleStream* stream,
+    TupleRow* __restrict__ row, bool more_aggregate_rows) {
   DCHECK(!stream->is_pinned());
   Status status;
   if (LIKELY(AddRowToSpilledStream(stream, row, &status))) return Status::OK();
@@ -668,7 +868,7 @@ Status GroupingAggregator::AppendSpilledRow(
   // Keep trying to free memory by spilling and retry AddRow() until we run out of
   // partitions or hit an error.
   for (int n = GetNumPinnedPartitions(); n > 0; --n) {
-    RETURN_IF_ERROR(SpillPartition(AGGREGATED_ROWS));
+    RETURN_IF_ERROR(SpillPartition(more_aggregate_rows));
     if (LIKELY(AddRowToSpilledStream(stream, row, &status))) return Status::OK();
     RETURN_IF_ERROR(status);
   }
@@ -679,6 +879,24 @@ Status GroupingAggregator::AppendSpilledRow(
       DebugString(), buffer_pool_client()->DebugString()));
 }
 
+Status GroupingAggregator::FlushSpillCaches() {
+  if (!use_spill_cache_) return Status::OK();
+  // Flushing a cache may spill other partitions, which then set up their own cache, so
+  // repeat until no partition has a cache.
+  bool flushed = true;
+  while (flushed) {
+    flushed = false;
+    for (int i = 0; i < hash_partitions_.size(); ++i) {
+      Partition* partition = hash_partitions_[i];
+      if (partition == nullptr || i != partition->idx) continue;
+      if (!partition->has_spill_cache()) continue;
+      RETURN_IF_ERROR(partition->FlushSpillCache(/* release */ true));
+      flushed = true;
+    }
+  }
+  return Status::OK();
+}
+
 void GroupingAggregator::SetDebugOptions(const TDebugOptions& debug_options) {
   debug_options_ = debug_options;
 }
@@ -868,6 +1086,7 @@ Status GroupingAggregator::BuildSpilledPartition(Partition** built_partition) {
       /* has_more_streams */ src_partition->unaggregated_row_stream->num_rows() > 0));
   RETURN_IF_ERROR(ProcessStream<false>(src_partition->unaggregated_row_stream.get(),
       /* has_more_streams */ false));
+  RETURN_IF_ERROR(FlushSpillCaches());
   src_partition->Close(false);
   spilled_partitions_.pop_front();
   hash_partitions_.clear();
@@ -909,20 +1128,16 @@ Status GroupingAggregator::RepartitionSpilledPartition() {
 
   if (partition->unaggregated_row_stream->num_rows() > 0) {
     // Prepare write buffers so we can append spilled rows to unaggregated partitions.
+    // The aggregated rows have been repartitioned, so the write buffer of the aggregated
+    // stream is either freed up to pin the unaggregated write buffer or kept for the
+    // spill cache.
     for (Partition* hash_partition : hash_partitions_) {
       if (!hash_partition->is_spilled()) continue;
-      // The aggregated rows have been repartitioned. Free up at least a buffer's worth of
-      // reservation and use it to pin the unaggregated write buffer.
-      RETURN_IF_ERROR(hash_partition->aggregated_row_stream->UnpinStream(
-          BufferedTupleStream::UNPIN_ALL));
-      bool got_buffer;
-      RETURN_IF_ERROR(
-          hash_partition->unaggregated_row_stream->PrepareForWrite(&got_buffer));
-      DCHECK(got_buffer) << "Accounted in min reservation"
-                         << buffer_pool_client()->DebugString();
+      RETURN_IF_ERROR(hash_partition->PrepareForUnaggregatedRows());
     }
     RETURN_IF_ERROR(ProcessStream<false>(partition->unaggregated_row_stream.get(),
         /* has_more_streams */ false));
+    RETURN_IF_ERROR(FlushSpillCaches());
   }
 
   COUNTER_ADD(num_row_repartitioned_, partition->aggregated_row_stream->num_rows());
@@ -1079,6 +1294,7 @@ Status GroupingAggregator::MoveHashPartitions(int64_t num_input_rows) {
 Status GroupingAggregator::PushSpilledPartition(Partition* partition) {
   DCHECK(partition->is_spilled());
   DCHECK(partition->hash_tbl == nullptr);
+  DCHECK(!partition->has_spill_cache());
   // Ensure all pages in the spilled partition's streams are unpinned by invalidating
   // the streams' read and write iterators. We may need all the memory to process the
   // next spilled partitions.
@@ -1230,6 +1446,7 @@ Status GroupingAggregatorConfig::CodegenAddBatchImpl(
   DCHECK_GE(replaced_constants.stores_duplicates, 1);
   DCHECK_GE(replaced_constants.stores_tuples, 1);
   DCHECK_GE(replaced_constants.quadratic_probing, 1);
+  DCHECK_GE(replaced_constants.group_probing, 1);
 
   replaced = codegen->ReplaceCallSites(add_batch_impl_fn, update_tuple_fn, "UpdateTuple");
   DCHECK_GE(replaced, 1);
@@ -1306,6 +1523,7 @@ Status GroupingAggregatorConfig::CodegenAddBatchStreamingImpl(
   DCHECK_GE(replaced_constants.stores_duplicates, 1);
   DCHECK_GE(replaced_constants.stores_tuples, 1);
   DCHECK_GE(replaced_constants.quadratic_probing, 1);
+  DCHECK_GE(replaced_constants.group_probing, 1);
 
   DCHECK(add_batch_streaming_impl_fn != nullptr);
   add_batch_streaming_impl_fn = codegen->FinalizeFunction(add_batch_streaming_impl_fn);
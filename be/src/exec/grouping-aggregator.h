@@ -202,6 +202,7 @@ class GroupingAggregator : public Aggregator {
   virtual void Close(RuntimeState* state) override;
 
   virtual Status AddBatch(RuntimeState* state, RowBatch* batch) override;
+  virtual bool AcceptsSelection() const override { return !is_streaming_preagg_; }
   virtual Status AddBatchStreaming(RuntimeState* state, RowBatch* out_batch,
       RowBatch* child_batch, bool* eos) override;
   virtual Status InputDone() override;
@@ -247,6 +248,33 @@ class GroupingAggregator : public Aggregator {
   /// TODO: rethink this ?
   static const int64_t PAGG_DEFAULT_HASH_TABLE_SZ = 1024;
 
+  /// Number of entries in the cache of a spilled partition, see Partition::spill_cache.
+  /// Must be a power of 2.
+  static const int SPILL_CACHE_ENTRIES = 1024;
+
+  /// Maximum number of bytes allocated for the tuples of the cache of a spilled
+  /// partition before the cache is flushed. The same limit applies to the memory held
+  /// by the aggregate function states, which is freed when the cache is flushed.
+  static const int64_t SPILL_CACHE_MAX_BYTES = 256 * 1024;
+
+  /// Number of input rows of a spilled partition between checks of whether its cache
+  /// reduces the spilled bytes.
+  static const int64_t SPILL_CACHE_CHECK_ROWS = 16 * 1024;
+
+  /// Minimum size of the hash tables, including their tuples, before the input is
+  /// radix partitioned, see AddBatch(). Roughly the size of the last level cache of
+  /// common server CPUs. A constant since the cache sizes reported by CpuInfo are not
+  /// reliable in all environments.
+  static const int64_t RADIX_PARTITIONING_MIN_HT_BYTES = 32L * 1024 * 1024;
+
+  /// Minimum ratio of groups to input rows before the input is radix partitioned. With
+  /// fewer groups, most rows update groups that are already in the cache.
+  static constexpr double RADIX_PARTITIONING_MIN_GROUP_RATIO = 0.1;
+
+  /// Size of the buffer that holds the rows of a hash partition while the input is radix
+  /// partitioned. Raised to the minimum buffer size of the buffer pool if that is larger.
+  static const int64_t RADIX_BUFFER_LEN = 64 * 1024;
+
   /// Codegen doesn't allow for automatic Status variables because then exception
   /// handling code is needed to destruct the Status, and our function call substitution
   /// doesn't know how to deal with the LLVM IR 'invoke' instruction. Workaround that by
@@ -268,6 +296,16 @@ class GroupingAggregator : public Aggregator {
   /// True if any of the evaluators require the serialize step.
   bool needs_serialize_ = false;
 
+  /// True if unaggregated rows of spilled partitions are partially aggregated in a
+  /// cache before they are spilled. Set in Prepare() from the SPILLED_AGG_PREAGG query
+  /// option. Not supported for var-len aggregate slots without a serialize step, since
+  /// those are stored outside of the stream.
+  bool use_spill_cache_ = false;
+
+  /// Tracks the memory of the spill caches, which is not drawn from the reservation. A
+  /// child of 'mem_tracker_'. Only set if 'use_spill_cache_' is true.
+  std::unique_ptr<MemTracker> spill_cache_mem_tracker_;
+
   /// Exprs used to evaluate input rows
   const std::vector<ScalarExpr*>& grouping_exprs_;
 
@@ -315,6 +353,38 @@ class GroupingAggregator : public Aggregator {
   /// The number of rows that have been passed to AddBatch() or AddBatchStreaming().
   int64_t num_input_rows_ = 0;
 
+  /// Input rows of a hash partition that were deep-copied while the input is radix
+  /// partitioned, see AddBatch().
+  struct RadixBuffer {
+    /// Buffer from the buffer pool with the tuple pointers and the tuples of the rows.
+    BufferPool::BufferHandle buffer;
+
+    /// Number of bytes of 'buffer' that are used.
+    int64_t bytes_used = 0;
+
+    /// The rows in 'buffer' and the hashes of their grouping values.
+    std::vector<TupleRow*> rows;
+    std::vector<uint32_t> hashes;
+  };
+
+  /// The buffers of the hash partitions, used once the input is radix partitioned. The
+  /// rows of a buffer are aggregated together when it is full, so that only the hash
+  /// table of one partition is accessed at a time and is more likely to stay in the CPU
+  /// caches. The buffers use reservation that is acquired in StartRadixPartitioning()
+  /// in addition to the reservation of the partitions. Empty if the input is not radix
+  /// partitioned.
+  std::vector<RadixBuffer> radix_buffers_;
+
+  /// Length of each buffer in 'radix_buffers_'.
+  int64_t radix_buffer_len_ = 0;
+
+  /// Batch that references the rows of a radix buffer while they are aggregated.
+  std::unique_ptr<RowBatch> radix_batch_;
+
+  /// The hashes of the rows of the batch that is passed to AddBatchImpl(), if they were
+  /// computed by RadixPartitionBatch(). NULL otherwise.
+  const uint32_t* radix_hashes_ = nullptr;
+
   /// True if this aggregator is being executed in a subplan.
   const bool is_in_subplan_;
 
@@ -352,6 +422,18 @@ class GroupingAggregator : public Aggregator {
   /// Number of partitions that have been spilled.
   RuntimeProfile::Counter* num_spilled_partitions_ = nullptr;
 
+  /// Number of unaggregated rows of spilled partitions that were aggregated in the
+  /// cache of the partition and the number of partial aggregates spilled instead.
+  RuntimeProfile::Counter* num_spill_cache_input_rows_ = nullptr;
+  RuntimeProfile::Counter* num_spill_cache_output_rows_ = nullptr;
+
+  /// Number of spilled partitions whose cache was turned off because it did not reduce
+  /// the number of bytes spilled or because its memory could not be allocated.
+  RuntimeProfile::Counter* num_spill_caches_disabled_ = nullptr;
+
+  /// Number of input rows that were radix partitioned before being aggregated.
+  RuntimeProfile::Counter* num_radix_partitioned_rows_ = nullptr;
+
   /// The largest fraction after repartitioning. This is expected to be
   /// 1 / PARTITION_FANOUT. A value much larger indicates skew.
   RuntimeProfile::HighWaterMarkCounter* largest_partition_percent_ = nullptr;
@@ -450,9 +532,47 @@ class GroupingAggregator : public Aggregator {
     /// Spill this partition. 'more_aggregate_rows' = true means that more aggregate rows
     /// may be appended to the the partition before appending unaggregated rows. On
     /// success, one of the streams is left with a write iterator: the aggregated stream
-    /// if 'more_aggregate_rows' is true or the unaggregated stream otherwise.
+    /// if 'more_aggregate_rows' is true or the unaggregated stream otherwise, see
+    /// PrepareForUnaggregatedRows().
     Status Spill(bool more_aggregate_rows) WARN_UNUSED_RESULT;
 
+    /// Prepares this spilled partition to append unaggregated rows. If the aggregator
+    /// uses spill caches, sets up 'spill_cache' and keeps the write buffer of
+    /// 'aggregated_row_stream', which must have one. Otherwise moves the write buffer
+    /// to 'unaggregated_row_stream'.
+    Status PrepareForUnaggregatedRows() WARN_UNUSED_RESULT;
+
+    /// Aggregates the unaggregated 'row' into 'spill_cache'. The grouping values and
+    /// hash of 'row' must be the current row of the parent's 'ht_ctx_'. Evicts the
+    /// tuple of another group from the cache to 'aggregated_row_stream' if needed.
+    /// Turns the cache off if it does not reduce the number of bytes spilled or if the
+    /// memory for a new tuple can not be allocated.
+    Status AggregateIntoSpillCache(TupleRow* row) WARN_UNUSED_RESULT;
+
+    /// Flushes and releases 'spill_cache' and appends 'row' and all following
+    /// unaggregated rows of this partition to 'unaggregated_row_stream'.
+    Status DisableSpillCache(TupleRow* row) WARN_UNUSED_RESULT;
+
+    /// Returns true if the estimated number of bytes spilled for the rows aggregated
+    /// into 'spill_cache' so far is lower than without the cache.
+    bool SpillCachePaysOff() const;
+
+    /// Serializes 'tuple' from 'spill_cache' if needed and appends it to
+    /// 'aggregated_row_stream'.
+    Status SpillCachedTuple(Tuple* tuple) WARN_UNUSED_RESULT;
+
+    /// Appends all tuples in 'spill_cache' to 'aggregated_row_stream' and clears the
+    /// cache. If 'release' is true, also releases the memory of the cache so that no
+    /// more rows can be aggregated into it.
+    Status FlushSpillCache(bool release) WARN_UNUSED_RESULT;
+
+    /// Frees the tuples in 'spill_cache' and the cache itself without spilling them.
+    /// If 'cleanup_tuples' is true, the tuples are first serialized or finalized to
+    /// free any memory allocated by UDAs.
+    void ReleaseSpillCache(bool cleanup_tuples);
+
+    bool has_spill_cache() const { return !spill_cache.empty(); }
+
     bool is_spilled() const { return hash_tbl.get() == nullptr; }
 
     std::string DebugString() const;
@@ -495,8 +615,35 @@ class GroupingAggregator : public Aggregator {
 
     /// Unaggregated rows that are spilled. Always NULL for streaming pre-aggregations.
     /// Always unpinned. Has a write buffer allocated when the partition is spilled and
-    /// unaggregated rows are being processed.
+    /// unaggregated rows are being processed, unless 'spill_cache' is used.
     std::unique_ptr<BufferedTupleStream> unaggregated_row_stream;
+
+    /// Direct-mapped cache of intermediate tuples, indexed by the low bits of the hash
+    /// of their grouping values, that partially aggregates the unaggregated rows of
+    /// this partition after it was spilled. When a tuple is evicted, the partial
+    /// aggregate is appended to 'aggregated_row_stream' instead of spilling the rows
+    /// that it aggregates, so 'aggregated_row_stream' can have multiple rows per group
+    /// that are merged when the partition is processed. The aggregate function states
+    /// use 'agg_fn_evals', which are cloned again when the cache is set up. Empty if
+    /// the cache is not in use.
+    std::vector<Tuple*> spill_cache;
+
+    /// Hashes of the tuples in 'spill_cache'.
+    std::vector<uint32_t> spill_cache_hashes;
+
+    /// Pool for the tuples in 'spill_cache'. Freed whenever the cache is flushed. Its
+    /// memory is not drawn from the reservation, so the cache is turned off if it can
+    /// not be allocated.
+    std::unique_ptr<MemPool> spill_cache_pool;
+
+    /// Number of rows aggregated into 'spill_cache' and number of tuples created in it
+    /// since the cache was set up. Used to decide whether to keep the cache.
+    int64_t spill_cache_input_rows = 0;
+    int64_t spill_cache_output_rows = 0;
+
+    /// Number of rows left until AggregateIntoSpillCache() checks whether the cache
+    /// pays off. Counted down for every row, whether or not it hits the cache.
+    int64_t spill_cache_rows_until_check = 0;
   };
 
   /// Stream used to store serialized spilled rows. Only used if needs_serialize_
@@ -553,9 +700,10 @@ class GroupingAggregator : public Aggregator {
   Status IR_ALWAYS_INLINE AddBatchImpl(RowBatch* batch, TPrefetchMode::type prefetch_mode,
       HashTableCtx* ht_ctx, bool has_more_rows) WARN_UNUSED_RESULT;
 
-  /// Evaluates the rows in 'batch' starting at 'start_row_idx' and stores the results in
-  /// the expression values cache in 'ht_ctx'. The number of rows evaluated depends on
-  /// the capacity of the cache. 'prefetch_mode' specifies the prefetching mode in use.
+  /// Evaluates the active rows in 'batch' starting at the 'start_row_idx'th one and
+  /// stores the results in the expression values cache in 'ht_ctx'. The number of rows
+  /// evaluated depends on the capacity of the cache. 'prefetch_mode' specifies the
+  /// prefetching mode in use.
   /// If it's not PREFETCH_NONE, hash table buckets for the computed hashes will be
   /// prefetched. Note that codegen replaces 'prefetch_mode' with a constant.
   template <bool AGGREGATED_ROWS>
@@ -583,11 +731,58 @@ class GroupingAggregator : public Aggregator {
 
   /// Append a row to a spilled partition. The row may be aggregated or unaggregated
   /// according to AGGREGATED_ROWS. May spill partitions if needed to append the row
-  /// buffers.
+  /// buffers. Unaggregated rows are aggregated into the spill cache of the partition
+  /// instead if it has one.
   template <bool AGGREGATED_ROWS>
   Status IR_ALWAYS_INLINE AppendSpilledRow(
       Partition* partition, TupleRow* row) WARN_UNUSED_RESULT;
 
+  /// Appends 'row' to 'stream' of a spilled partition. If the row does not fit, spills
+  /// other partitions, passing 'more_aggregate_rows' to SpillPartition(), until it does.
+  Status AppendToSpilledStream(BufferedTupleStream* stream, TupleRow* row,
+      bool more_aggregate_rows) WARN_UNUSED_RESULT;
+
+  /// Flushes and releases the spill caches of all partitions in 'hash_partitions_'.
+  /// Must be called before the partitions are moved with MoveHashPartitions().
+  Status FlushSpillCaches() WARN_UNUSED_RESULT;
+
+  /// Aggregates 'batch' of input rows into 'hash_partitions_' with the codegen'd
+  /// AddBatchImpl() if available.
+  Status ProcessInputBatch(RowBatch* batch) WARN_UNUSED_RESULT;
+
+  /// Returns true if the AGG_RADIX_PARTITIONING query option is set and the hash tables
+  /// have grown so large and the input has so many distinct groups that the input
+  /// should be radix partitioned.
+  bool ShouldRadixPartition() const;
+
+  /// Tries to increase the reservation by one buffer per hash partition and allocates
+  /// 'radix_buffers_' from it. Leaves 'radix_buffers_' empty if the reservation is not
+  /// available, in which case the input is aggregated directly.
+  Status StartRadixPartitioning() WARN_UNUSED_RESULT;
+
+  /// Copies the active rows of 'batch' to 'radix_buffers_' according to the hash of
+  /// their grouping values. Aggregates the rows of a buffer when it is full. A row that
+  /// does not fit into an empty buffer is aggregated right away.
+  Status RadixPartitionBatch(RowBatch* batch) WARN_UNUSED_RESULT;
+
+  /// Aggregates 'num_rows' rows from 'rows' with the precomputed 'hashes' of their
+  /// grouping values.
+  Status AggregateRadixRows(TupleRow** rows, const uint32_t* hashes, int num_rows)
+      WARN_UNUSED_RESULT;
+
+  /// Aggregates the rows of 'buffer' and empties it.
+  Status FlushRadixBuffer(RadixBuffer* buffer) WARN_UNUSED_RESULT;
+
+  /// Aggregates the remaining rows of 'radix_buffers_' and calls ReleaseRadixBuffers().
+  Status FlushRadixBuffers() WARN_UNUSED_RESULT;
+
+  /// Frees the buffers of 'radix_buffers_' without aggregating their rows and releases
+  /// the reservation that was acquired for them.
+  Status ReleaseRadixBuffers() WARN_UNUSED_RESULT;
+
+  /// Frees the buffers of 'radix_buffers_' without aggregating their rows.
+  void FreeRadixBuffers();
+
   /// Reads all the rows from input_stream and process them by calling AddBatchImpl().
   template <bool AGGREGATED_ROWS>
   Status ProcessStream(BufferedTupleStream* input_stream, bool has_more_streams)
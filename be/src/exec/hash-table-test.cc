@@ -71,6 +71,9 @@ class HashTableTest : public testing::Test {
   vector<ScalarExprEvaluator*> probe_expr_evals_;
   int next_query_id_ = 0;
 
+  /// If true, CreateHashTable() creates hash tables that use group probing.
+  bool group_probing_ = false;
+
   virtual void SetUp() {
     test_env_.reset(new TestEnv());
     ASSERT_OK(test_env_->Init());
@@ -257,8 +260,8 @@ class HashTableTest : public testing::Test {
     // Initial_num_buckets must be a power of two.
     EXPECT_EQ(initial_num_buckets, BitUtil::RoundUpToPowerOfTwo(initial_num_buckets));
     int64_t max_num_buckets = 1L << 31;
-    *table = pool_.Add(new HashTable(
-        quadratic, allocator, true, 1, nullptr, max_num_buckets, initial_num_buckets));
+    *table = pool_.Add(new HashTable(quadratic, allocator, true, 1, nullptr,
+        max_num_buckets, initial_num_buckets, group_probing_));
     hash_tables_.push_back(*table);
     bool success;
     Status status = (*table)->Init(&success);
@@ -640,6 +643,62 @@ class HashTableTest : public testing::Test {
     EXPECT_TRUE(iter.AtEnd());
     ht_ctx->Close(runtime_state_);
   }
+
+  // Inserts the same rows, with duplicates, into a hash table with quadratic probing and
+  // one with group probing and checks that probes for present and absent rows find the
+  // same rows in both. The tables are kept small relative to the number of rows, so
+  // that many groups fill up and probes have to move on to other groups.
+  void GroupProbingMatchesQuadraticTest(int initial_num_buckets, int num_rows) {
+    HashTable* tables[2];
+    group_probing_ = false;
+    ASSERT_TRUE(CreateHashTable(true, initial_num_buckets, &tables[0]));
+    group_probing_ = true;
+    ASSERT_TRUE(CreateHashTable(true, initial_num_buckets, &tables[1]));
+    EXPECT_FALSE(tables[0]->is_group_probing());
+    EXPECT_TRUE(tables[1]->is_group_probing());
+    scoped_ptr<HashTableCtx> ht_ctx;
+    Status status = HashTableCtx::Create(&pool_, runtime_state_, build_exprs_,
+        probe_exprs_, false /* !stores_nulls_ */,
+        vector<bool>(build_exprs_.size(), false), 1, 0, 1, &mem_pool_, &mem_pool_,
+        &mem_pool_, &ht_ctx);
+    EXPECT_OK(status);
+    EXPECT_OK(ht_ctx->Open(runtime_state_));
+
+    // Values are inserted (val % 3) + 1 times.
+    for (int val = 0; val < num_rows; ++val) {
+      for (HashTable* table : tables) {
+        bool success;
+        EXPECT_OK(table->CheckAndResize(1, ht_ctx.get(), &success));
+        ASSERT_TRUE(success);
+        for (int i = 0; i <= val % 3; ++i) {
+          TupleRow* row = CreateTupleRow(val);
+          ASSERT_TRUE(ht_ctx->EvalAndHashBuild(row));
+          BufferedTupleStream::FlatRowPtr dummy_flat_row = nullptr;
+          ASSERT_TRUE(table->Insert(ht_ctx.get(), dummy_flat_row, row, &status));
+          ASSERT_OK(status);
+        }
+      }
+    }
+    EXPECT_EQ(tables[0]->size(), tables[1]->size());
+    EXPECT_EQ(tables[0]->num_buckets(), tables[1]->num_buckets());
+    EXPECT_EQ(tables[0]->EmptyBuckets(), tables[1]->EmptyBuckets());
+
+    for (int val = 0; val < 2 * num_rows; ++val) {
+      TupleRow* probe_row = CreateTupleRow(val);
+      ASSERT_TRUE(ht_ctx->EvalAndHashProbe(probe_row));
+      int num_matches[2] = {0, 0};
+      for (int t = 0; t < 2; ++t) {
+        for (HashTable::Iterator iter = tables[t]->FindProbeRow(ht_ctx.get());
+             !iter.AtEnd(); iter.NextDuplicate()) {
+          ValidateMatch(probe_row, iter.GetRow());
+          ++num_matches[t];
+        }
+      }
+      EXPECT_EQ(num_matches[0], val < num_rows ? val % 3 + 1 : 0) << val;
+      EXPECT_EQ(num_matches[0], num_matches[1]) << val;
+    }
+    ht_ctx->Close(runtime_state_);
+  }
 };
 
 TEST_F(HashTableTest, LinearSetupTest) {
@@ -662,10 +721,23 @@ TEST_F(HashTableTest, QuadraticSetupTest) {
   SetupTest(true, 4294967296, true); // 2^32
 }
 
+TEST_F(HashTableTest, GroupSetupTest) {
+  group_probing_ = true;
+  SetupTest(true, 1, false);
+  SetupTest(true, 1024, false);
+  SetupTest(true, 65536, false);
+  SetupTest(true, 4294967296, true); // 2^32
+}
+
 TEST_F(HashTableTest, NullBuildRowTest) {
   NullBuildRowTest();
 }
 
+TEST_F(HashTableTest, GroupNullBuildRowTest) {
+  group_probing_ = true;
+  NullBuildRowTest();
+}
+
 TEST_F(HashTableTest, LinearBasicTest) {
   BasicTest(false, 1);
   BasicTest(false, 1024);
@@ -678,6 +750,13 @@ TEST_F(HashTableTest, QuadraticBasicTest) {
   BasicTest(true, 65536);
 }
 
+TEST_F(HashTableTest, GroupBasicTest) {
+  group_probing_ = true;
+  BasicTest(true, 1);
+  BasicTest(true, 1024);
+  BasicTest(true, 65536);
+}
+
 // This test makes sure we can scan ranges of buckets.
 TEST_F(HashTableTest, LinearScanTest) {
   ScanTest(false, 1, 10, 5);
@@ -691,6 +770,13 @@ TEST_F(HashTableTest, QuadraticScanTest) {
   ScanTest(true, 1024, 1000, 500);
 }
 
+TEST_F(HashTableTest, GroupScanTest) {
+  group_probing_ = true;
+  ScanTest(true, 1, 10, 5);
+  ScanTest(true, 1024, 1000, 5);
+  ScanTest(true, 1024, 1000, 500);
+}
+
 TEST_F(HashTableTest, LinearGrowTableTest) {
   GrowTableTest(false);
 }
@@ -699,6 +785,11 @@ TEST_F(HashTableTest, QuadraticGrowTableTest) {
   GrowTableTest(true);
 }
 
+TEST_F(HashTableTest, GroupGrowTableTest) {
+  group_probing_ = true;
+  GrowTableTest(true);
+}
+
 TEST_F(HashTableTest, LinearInsertFullTest) {
   InsertFullTest(false, 1);
   InsertFullTest(false, 4);
@@ -715,6 +806,22 @@ TEST_F(HashTableTest, QuadraticInsertFullTest) {
   InsertFullTest(true, 65536);
 }
 
+// Tables with fewer than GROUP_SIZE buckets are a single padded group.
+TEST_F(HashTableTest, GroupInsertFullTest) {
+  group_probing_ = true;
+  InsertFullTest(true, 1);
+  InsertFullTest(true, 4);
+  InsertFullTest(true, 16);
+  InsertFullTest(true, 64);
+  InsertFullTest(true, 1024);
+  InsertFullTest(true, 65536);
+}
+
+TEST_F(HashTableTest, GroupProbingMatchesQuadraticTest) {
+  GroupProbingMatchesQuadraticTest(16, 1000);
+  GroupProbingMatchesQuadraticTest(1024, 100000);
+}
+
 // Test that hashing empty string updates hash value.
 TEST_F(HashTableTest, HashEmpty) {
   scoped_ptr<HashTableCtx> ht_ctx;
@@ -739,6 +846,8 @@ TEST_F(HashTableTest, HashEmpty) {
 TEST_F(HashTableTest, VeryLowMemTest) {
   VeryLowMemTest(true);
   VeryLowMemTest(false);
+  group_probing_ = true;
+  VeryLowMemTest(true);
 }
 
 // Test to ensure the bucket size doesn't change accidentally.
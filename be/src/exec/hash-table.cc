@@ -86,13 +86,14 @@ static_assert(sizeof(NULL_VALUE) >= ColumnType::MAX_CHAR_LENGTH,
 
 HashTableConfig::HashTableConfig(const std::vector<ScalarExpr*>& build_exprs,
     const std::vector<ScalarExpr*>& probe_exprs, const bool stores_nulls,
-    const std::vector<bool>& finds_nulls)
+    const std::vector<bool>& finds_nulls, const bool group_probing)
   : build_exprs(build_exprs),
     probe_exprs(probe_exprs),
     stores_nulls(stores_nulls),
     finds_nulls(finds_nulls),
     finds_some_nulls(std::accumulate(
         finds_nulls.begin(), finds_nulls.end(), false, std::logical_or<bool>())),
+    group_probing(group_probing),
     build_exprs_results_row_layout(build_exprs) {
   DCHECK_EQ(build_exprs.size(), finds_nulls.size());
   DCHECK_EQ(build_exprs.size(), probe_exprs.size());
@@ -110,6 +111,7 @@ HashTableCtx::HashTableCtx(const std::vector<ScalarExpr*>& build_exprs,
       finds_nulls_(finds_nulls),
       finds_some_nulls_(std::accumulate(
           finds_nulls_.begin(), finds_nulls_.end(), false, std::logical_or<bool>())),
+      group_probing_(false),
       level_(0),
       scratch_row_(NULL),
       expr_perm_pool_(expr_perm_pool),
@@ -141,6 +143,7 @@ HashTableCtx::HashTableCtx(const HashTableConfig& config, int32_t initial_seed,
     stores_nulls_(config.stores_nulls),
     finds_nulls_(config.finds_nulls),
     finds_some_nulls_(config.finds_some_nulls),
+    group_probing_(config.group_probing),
     level_(0),
     scratch_row_(NULL),
     expr_perm_pool_(expr_perm_pool),
@@ -454,22 +457,27 @@ void HashTableCtx::ExprValuesCache::ResetForRead() {
 
 constexpr double HashTable::MAX_FILL_FACTOR;
 constexpr int64_t HashTable::DATA_PAGE_SIZE;
+const int HashTable::GROUP_SIZE;
+const uint8_t HashTable::EMPTY_TAG;
+const uint8_t HashTable::PADDING_TAG;
 
 HashTable* HashTable::Create(Suballocator* allocator, bool stores_duplicates,
     int num_build_tuples, BufferedTupleStream* tuple_stream, int64_t max_num_buckets,
-    int64_t initial_num_buckets) {
+    int64_t initial_num_buckets, bool group_probing) {
   return new HashTable(FLAGS_enable_quadratic_probing, allocator, stores_duplicates,
-      num_build_tuples, tuple_stream, max_num_buckets, initial_num_buckets);
+      num_build_tuples, tuple_stream, max_num_buckets, initial_num_buckets,
+      group_probing);
 }
 
 HashTable::HashTable(bool quadratic_probing, Suballocator* allocator,
     bool stores_duplicates, int num_build_tuples, BufferedTupleStream* stream,
-    int64_t max_num_buckets, int64_t num_buckets)
+    int64_t max_num_buckets, int64_t num_buckets, bool group_probing)
   : allocator_(allocator),
     tuple_stream_(stream),
     stores_tuples_(num_build_tuples == 1),
     stores_duplicates_(stores_duplicates),
     quadratic_probing_(quadratic_probing),
+    group_probing_(group_probing),
     max_num_buckets_(max_num_buckets),
     num_buckets_(num_buckets),
     num_build_tuples_(num_build_tuples) {
@@ -483,21 +491,35 @@ Status HashTable::Init(bool* got_memory) {
   int64_t hash_byte_size = num_buckets_ * sizeof(uint32_t);
   RETURN_IF_ERROR(allocator_->Allocate(buckets_byte_size, &bucket_allocation_));
   RETURN_IF_ERROR(allocator_->Allocate(hash_byte_size, &hash_allocation_));
-  if (bucket_allocation_ == nullptr || hash_allocation_ == nullptr) {
+  if (group_probing_) {
+    RETURN_IF_ERROR(allocator_->Allocate(TagArraySize(num_buckets_), &tag_allocation_));
+  }
+  if (bucket_allocation_ == nullptr || hash_allocation_ == nullptr
+      || (group_probing_ && tag_allocation_ == nullptr)) {
     num_buckets_ = 0;
     *got_memory = false;
     if (bucket_allocation_ != nullptr) allocator_->Free(move(bucket_allocation_));
     if (hash_allocation_ != nullptr) allocator_->Free(move(hash_allocation_));
+    if (tag_allocation_ != nullptr) allocator_->Free(move(tag_allocation_));
     return Status::OK();
   }
   buckets_ = reinterpret_cast<Bucket*>(bucket_allocation_->data());
   memset(buckets_, 0, buckets_byte_size);
   hash_array_ = reinterpret_cast<uint32_t*>(hash_allocation_->data());
   memset(hash_array_, 0, hash_byte_size);
+  if (group_probing_) {
+    tag_array_ = tag_allocation_->data();
+    InitTagArray(tag_array_, num_buckets_);
+  }
   *got_memory = true;
   return Status::OK();
 }
 
+void HashTable::InitTagArray(uint8_t* tag_array, int64_t num_buckets) {
+  memset(tag_array, EMPTY_TAG, num_buckets);
+  memset(tag_array + num_buckets, PADDING_TAG, TagArraySize(num_buckets) - num_buckets);
+}
+
 unique_ptr<HashTableStatsProfile> HashTable::AddHashTableCounters(
     RuntimeProfile* parent_profile) {
   unique_ptr<HashTableStatsProfile> stats_profile(new HashTableStatsProfile());
@@ -525,6 +547,8 @@ void HashTable::Close() {
   data_pages_.clear();
   if (bucket_allocation_ != nullptr) allocator_->Free(move(bucket_allocation_));
   if (hash_allocation_ != nullptr) allocator_->Free(move(hash_allocation_));
+  if (tag_allocation_ != nullptr) allocator_->Free(move(tag_allocation_));
+  tag_array_ = nullptr;
   ResetState();
 }
 
@@ -587,9 +611,21 @@ Status HashTable::ResizeBuckets(
     if (new_allocation != NULL) allocator_->Free(move(new_allocation));
     return hash_allocation_status;
   }
-  if (new_allocation == NULL || new_hash_allocation == NULL) {
+  unique_ptr<Suballocation> new_tag_allocation;
+  if (group_probing_) {
+    Status tag_allocation_status =
+        allocator_->Allocate(TagArraySize(num_buckets), &new_tag_allocation);
+    if (!tag_allocation_status.ok()) {
+      if (new_allocation != NULL) allocator_->Free(move(new_allocation));
+      if (new_hash_allocation != NULL) allocator_->Free(move(new_hash_allocation));
+      return tag_allocation_status;
+    }
+  }
+  if (new_allocation == NULL || new_hash_allocation == NULL
+      || (group_probing_ && new_tag_allocation == NULL)) {
     if (new_allocation != NULL) allocator_->Free(move(new_allocation));
     if (new_hash_allocation != NULL) allocator_->Free(move(new_hash_allocation));
+    if (new_tag_allocation != NULL) allocator_->Free(move(new_tag_allocation));
     *got_memory = false;
     return Status::OK();
   }
@@ -597,6 +633,11 @@ Status HashTable::ResizeBuckets(
   memset(new_buckets, 0, new_size);
   uint32_t* new_hash_array = reinterpret_cast<uint32_t*>(new_hash_allocation->data());
   memset(new_hash_array, 0, new_hash_size);
+  uint8_t* new_tag_array = nullptr;
+  if (group_probing_) {
+    new_tag_array = new_tag_allocation->data();
+    InitTagArray(new_tag_array, num_buckets);
+  }
 
   // Walk the old table and copy all the filled buckets to the new (resized) table.
   // We do not have to do anything with the duplicate nodes. This operation is expected
@@ -608,22 +649,27 @@ Status HashTable::ResizeBuckets(
     bool found = false;
     BucketData bd;
     int64_t bucket_idx = Probe<true, false, HashTable::BucketType::MATCH_UNSET>(
-        new_buckets, new_hash_array, num_buckets, ht_ctx, hash, &found, &bd);
+        new_buckets, new_hash_array, new_tag_array, num_buckets, ht_ctx, hash, &found,
+        &bd);
     DCHECK(!found);
     DCHECK_NE(bucket_idx, Iterator::BUCKET_NOT_FOUND) << " Probe failed even though "
         " there are free buckets. " << num_buckets << " " << num_filled_buckets_;
     Bucket* dst_bucket = &new_buckets[bucket_idx];
     new_hash_array[bucket_idx] = hash;
+    if (group_probing_) new_tag_array[bucket_idx] = HashTag(hash);
     *dst_bucket = *bucket_to_copy;
   }
 
   num_buckets_ = num_buckets;
   allocator_->Free(move(bucket_allocation_));
   allocator_->Free(move(hash_allocation_));
+  if (group_probing_) allocator_->Free(move(tag_allocation_));
   bucket_allocation_ = move(new_allocation);
   hash_allocation_ = move(new_hash_allocation);
+  tag_allocation_ = move(new_tag_allocation);
   buckets_ = new_buckets;
   hash_array_ = new_hash_array;
+  tag_array_ = new_tag_array;
   *got_memory = true;
   return Status::OK();
 }
@@ -1339,5 +1385,7 @@ Status HashTableCtx::ReplaceHashTableConstants(LlvmCodeGen* codegen,
       fn, stores_duplicates, "stores_duplicates");
   replacement_counts->quadratic_probing = codegen->ReplaceCallSitesWithBoolConst(
       fn, FLAGS_enable_quadratic_probing, "quadratic_probing");
+  replacement_counts->group_probing = codegen->ReplaceCallSitesWithBoolConst(
+      fn, config.group_probing, "group_probing");
   return Status::OK();
 }
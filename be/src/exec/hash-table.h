@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -32,9 +33,11 @@
 #include "runtime/bufferpool/buffer-pool.h"
 #include "runtime/bufferpool/suballocator.h"
 #include "runtime/tuple-row.h"
+#include "util/bit-util.h"
 #include "util/bitmap.h"
 #include "util/hash-util.h"
 #include "util/runtime-profile.h"
+#include "util/sse-util.h"
 #include "util/tagged-ptr.h"
 
 namespace llvm {
@@ -96,6 +99,16 @@ struct ScalarExprsResultsRowLayout;
 /// We choose to use linear or quadratic probing because they exhibit good (predictable)
 /// cache behavior.
 ///
+/// Alternatively, the hash table can use group probing (see HashTableConfig). The
+/// buckets are then divided into groups of GROUP_SIZE consecutive buckets and a separate
+/// byte array holds a 7-bit tag taken from the hash of every filled bucket, or EMPTY_TAG
+/// for empty buckets. A probe loads the tags of a whole group with one SSE2 load and
+/// compares them with the tag of the probe hash, so only the buckets whose tag matches
+/// need to be looked at. If the group has an empty bucket, the probe ends there;
+/// otherwise it moves on to the next group with quadratic probing over the groups. Most
+/// probes that miss, and most hash collisions, are resolved from the tag array alone
+/// without touching the buckets, the hash array or the rows.
+///
 /// The first NUM_SMALL_BLOCKS of nodes_ are made of blocks less than the IO size (of 8MB)
 /// to reduce the memory footprint of small queries.
 ///
@@ -121,7 +134,7 @@ struct HashTableConfig {
   HashTableConfig() = delete;
   HashTableConfig(const std::vector<ScalarExpr*>& build_exprs,
       const std::vector<ScalarExpr*>& probe_exprs, const bool stores_nulls,
-      const std::vector<bool>& finds_nulls);
+      const std::vector<bool>& finds_nulls, const bool group_probing = false);
 
   /// The exprs used to evaluate rows for inserting rows into hash table.
   /// Also used when matching hash table entries against probe rows. Not Owned.
@@ -140,6 +153,12 @@ struct HashTableConfig {
   /// finds_some_nulls_ is just the logical OR of finds_nulls_.
   const bool finds_some_nulls;
 
+  /// If true, the hash tables used with this config probe the buckets in groups with
+  /// SIMD comparisons of their hash tags. Codegen'd code is specialized on this, so all
+  /// hash tables probed or built with contexts created from this config must be created
+  /// with the same value.
+  const bool group_probing;
+
   /// The memory efficient layout for storing the results of evaluating build expressions.
   const ScalarExprsResultsRowLayout build_exprs_results_row_layout;
 };
@@ -188,6 +207,10 @@ class HashTableCtx {
 
   TupleRow* ALWAYS_INLINE scratch_row() const { return scratch_row_; }
 
+  /// True if the hash tables used with this context should use group probing. See
+  /// HashTableConfig::group_probing.
+  bool group_probing() const { return group_probing_; }
+
   /// Returns the results of the expression at 'expr_idx' evaluated at the current row.
   /// This value is invalid if the expr evaluated to NULL.
   /// TODO: this is an awkward abstraction but aggregation node can take advantage of
@@ -212,6 +235,11 @@ class HashTableCtx {
   bool IR_ALWAYS_INLINE EvalAndHashBuild(const TupleRow* row);
   bool IR_ALWAYS_INLINE EvalAndHashProbe(const TupleRow* row);
 
+  /// Same as EvalAndHashProbe(), except that '*hash' is saved as the hash of the row
+  /// instead of hashing the evaluated values if 'hash' is non-NULL. 'hash' must have
+  /// been computed with EvalAndHashProbe() by a context at the same level.
+  bool IR_ALWAYS_INLINE EvalAndHashProbe(const TupleRow* row, const uint32_t* hash);
+
   /// Codegen for evaluating a tuple row. Codegen'd function matches the signature
   /// for EvalBuildRow and EvalTupleRow.
   /// If build_row is true, the codegen uses the build_exprs, otherwise the probe_exprs.
@@ -239,6 +267,7 @@ class HashTableCtx {
     int stores_tuples;
     int stores_duplicates;
     int quadratic_probing;
+    int group_probing;
   };
 
   /// Replace hash table parameters with constants in 'fn'. Updates 'replacement_counts'
@@ -435,6 +464,13 @@ class HashTableCtx {
 
   ExprValuesCache* ALWAYS_INLINE expr_values_cache() { return &expr_values_cache_; }
 
+  /// Returns true if the values of the current row in 'expr_values_cache_' are equal
+  /// to the build exprs evaluated over 'build_row'. NULLs are considered equal. Used
+  /// to match rows against tuples that are not stored in a hash table.
+  bool ALWAYS_INLINE CurrentRowEquals(const TupleRow* build_row) const {
+    return Equals<true>(build_row);
+  }
+
  private:
   friend class HashTable;
   friend class HashTableTest_HashEmpty_Test;
@@ -565,6 +601,10 @@ class HashTableCtx {
   /// finds_some_nulls_ is just the logical OR of finds_nulls_.
   const bool finds_some_nulls_;
 
+  /// Copied from HashTableConfig::group_probing. Always false for contexts that are
+  /// not created from a HashTableConfig.
+  const bool group_probing_;
+
   /// The current level this context is working on. Each level needs to use a
   /// different seed.
   int level_;
@@ -794,7 +834,7 @@ class HashTable {
   class Iterator;
 
   /// Returns a newly allocated HashTable. The probing algorithm is set by the
-  /// FLAG_enable_quadratic_probing.
+  /// FLAG_enable_quadratic_probing, unless 'group_probing' is true.
   ///  - allocator: allocator to allocate bucket directory and data pages from.
   ///  - stores_duplicates: true if rows with duplicate keys may be inserted into the
   ///    hash table.
@@ -807,9 +847,11 @@ class HashTable {
   ///    -1, if it unlimited.
   ///  - initial_num_buckets: number of buckets that the hash table should be initialized
   ///    with.
+  ///  - group_probing: if true, probe groups of buckets by their hash tags. Must match
+  ///    HashTableCtx::group_probing() of the contexts used with the table.
   static HashTable* Create(Suballocator* allocator, bool stores_duplicates,
       int num_build_tuples, BufferedTupleStream* tuple_stream, int64_t max_num_buckets,
-      int64_t initial_num_buckets);
+      int64_t initial_num_buckets, bool group_probing = false);
 
   /// Allocates the initial bucket structure. Returns a non-OK status if an error is
   /// encountered. If an OK status is returned , 'got_memory' is set to indicate whether
@@ -916,6 +958,10 @@ class HashTable {
   /// Return the size of a hash table bucket in bytes.
   static const int64_t BUCKET_SIZE = sizeof(Bucket);
 
+  /// Number of buckets whose tags are compared at once with group probing. This is the
+  /// number of bytes in an SSE2 register.
+  static const int GROUP_SIZE = 16;
+
   /// Returns the memory occupied by the hash table, takes into account the number of
   /// duplicates.
   /// Thread-safe for read-only hash tables.
@@ -936,9 +982,13 @@ class HashTable {
 
   /// Returns the number of bytes allocated to the hash table from the block manager.
   int64_t ByteSize() const {
-    return num_buckets_ * sizeof(Bucket) + total_data_page_size_;
+    int64_t tag_bytes = group_probing_ ? TagArraySize(num_buckets_) : 0;
+    return num_buckets_ * sizeof(Bucket) + tag_bytes + total_data_page_size_;
   }
 
+  /// Returns true if the table uses group probing.
+  bool is_group_probing() const { return group_probing_; }
+
   /// Returns an iterator at the beginning of the hash table.  Advancing this iterator
   /// will traverse all elements.
   /// Thread-safe for read-only hash tables.
@@ -1072,13 +1122,14 @@ class HashTable {
   /// Hash table constructor. Private because Create() should be used, instead
   /// of calling this constructor directly.
   ///  - quadratic_probing: set to true when the probing algorithm is quadratic, as
-  ///    opposed to linear.
+  ///    opposed to linear. Ignored if 'group_probing' is true.
+  ///  - group_probing: set to true to probe groups of buckets by their hash tags.
   HashTable(bool quadratic_probing, Suballocator* allocator, bool stores_duplicates,
       int num_build_tuples, BufferedTupleStream* tuple_stream, int64_t max_num_buckets,
-      int64_t initial_num_buckets);
+      int64_t initial_num_buckets, bool group_probing = false);
 
-  /// Performs the probing operation according to the probing algorithm (linear or
-  /// quadratic. Returns one of the following:
+  /// Performs the probing operation according to the probing algorithm (linear,
+  /// quadratic or group probing). Returns one of the following:
   /// (a) the index of the bucket that contains the entry matching 'hash' and, if
   ///     COMPARE_ROW is true, also equals the last row evaluated in 'ht_ctx'.
   ///     If COMPARE_ROW is false, returns the index of the first bucket with
@@ -1102,12 +1153,38 @@ class HashTable {
   ///
   /// 'hash' is the hash computed by EvalAndHashBuild() or EvalAndHashProbe().
   /// 'found' indicates that a bucket that contains an equal row is found.
+  /// 'tag_array' holds the tags of 'buckets' if the table uses group probing and is
+  /// unused otherwise.
   ///
   /// There are wrappers of this function that perform the Find and Insert logic.
   template <bool INCLUSIVE_EQUALITY, bool COMPARE_ROW, BucketType TYPE = MATCH_SET>
   int64_t IR_ALWAYS_INLINE Probe(Bucket* buckets, uint32_t* hash_array,
-      int64_t num_buckets, HashTableCtx* __restrict__ ht_ctx, uint32_t hash, bool* found,
-      BucketData* bd);
+      uint8_t* tag_array, int64_t num_buckets, HashTableCtx* __restrict__ ht_ctx,
+      uint32_t hash, bool* found, BucketData* bd);
+
+  /// Implementation of Probe() for group probing. Starts at the group that contains the
+  /// bucket 'hash' maps to and returns the first bucket of the group whose hash and row
+  /// match, or else the first empty bucket of the group. Moves on to the next group with
+  /// quadratic probing if the group is full and has no match.
+  template <bool INCLUSIVE_EQUALITY, bool COMPARE_ROW, BucketType TYPE>
+  int64_t IR_ALWAYS_INLINE GroupProbe(Bucket* buckets, uint32_t* hash_array,
+      uint8_t* tag_array, int64_t num_buckets, HashTableCtx* __restrict__ ht_ctx,
+      uint32_t hash, bool* found, BucketData* bd);
+
+  /// Returns the tag of filled buckets with 'hash' for group probing: the 7 most
+  /// significant bits of the hash. The bucket index is taken from the least significant
+  /// bits, so the tag still tells apart most hashes that map to the same group.
+  static uint8_t ALWAYS_INLINE HashTag(uint32_t hash) { return hash >> 25; }
+
+  /// Returns the number of bytes of the tag array for 'num_buckets' buckets. Tables with
+  /// fewer than GROUP_SIZE buckets are padded to a full group.
+  static int64_t TagArraySize(int64_t num_buckets) {
+    return std::max<int64_t>(num_buckets, GROUP_SIZE);
+  }
+
+  /// Sets the tags of all 'num_buckets' buckets in 'tag_array' to EMPTY_TAG and the
+  /// padding after them to PADDING_TAG.
+  static void InitTagArray(uint8_t* tag_array, int64_t num_buckets);
 
   /// Performs the insert logic. Returns the Bucket* of the bucket where the data
   /// should be inserted either in the bucket itself or in it's DuplicateNode.
@@ -1172,6 +1249,15 @@ class HashTable {
   bool IR_NO_INLINE stores_tuples() const { return stores_tuples_; }
   bool IR_NO_INLINE stores_duplicates() const { return stores_duplicates_; }
   bool IR_NO_INLINE quadratic_probing() const { return quadratic_probing_; }
+  bool IR_NO_INLINE group_probing() const { return group_probing_; }
+
+  /// Tag of empty buckets with group probing. Tags of filled buckets never have the most
+  /// significant bit set.
+  static const uint8_t EMPTY_TAG = 0x80;
+
+  /// Tag of the padding of the tag array of tables with fewer buckets than GROUP_SIZE.
+  /// Matches neither the tag of a filled bucket nor EMPTY_TAG.
+  static const uint8_t PADDING_TAG = 0xfe;
 
   /// Load factor that will trigger growing the hash table on insert.  This is
   /// defined as the number of non-empty buckets / total_buckets
@@ -1203,6 +1289,9 @@ class HashTable {
   /// Quadratic probing enabled (as opposed to linear).
   const bool quadratic_probing_;
 
+  /// Group probing enabled. Takes precedence over 'quadratic_probing_'.
+  const bool group_probing_;
+
   /// Data pages for all nodes. Allocated from suballocator to reduce memory
   /// consumption of small tables.
   std::vector<std::unique_ptr<Suballocation>> data_pages_;
@@ -1235,6 +1324,14 @@ class HashTable {
   /// This is not part of struct 'Bucket' to make sure 'sizeof(Bucket)' is power of 2.
   uint32_t* hash_array_;
 
+  /// Allocation containing the tag of every bucket. Only used with group probing.
+  std::unique_ptr<Suballocation> tag_allocation_;
+
+  /// The tags of the buckets for group probing: HashTag() of the hash of filled buckets
+  /// and EMPTY_TAG for empty buckets, followed by padding up to TagArraySize(). NULL if
+  /// the table does not use group probing.
+  uint8_t* tag_array_ = nullptr;
+
   /// Total number of buckets (filled and empty).
   int64_t num_buckets_;
 
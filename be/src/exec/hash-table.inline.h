@@ -40,6 +40,16 @@ inline bool HashTableCtx::EvalAndHashProbe(const TupleRow* row) {
   return true;
 }
 
+inline bool HashTableCtx::EvalAndHashProbe(const TupleRow* row, const uint32_t* hash) {
+  uint8_t* expr_values = expr_values_cache_.cur_expr_values();
+  uint8_t* expr_values_null = expr_values_cache_.cur_expr_values_null();
+  bool has_null = EvalProbeRow(row, expr_values, expr_values_null);
+  if (has_null && !(stores_nulls() && finds_some_nulls())) return false;
+  expr_values_cache_.SetCurExprValuesHash(
+      hash != nullptr ? *hash : HashRow(expr_values, expr_values_null));
+  return true;
+}
+
 inline void HashTableCtx::ExprValuesCache::NextRow() {
   cur_expr_values_ += expr_values_bytes_per_row_;
   cur_expr_values_null_ += num_exprs_;
@@ -49,13 +59,17 @@ inline void HashTableCtx::ExprValuesCache::NextRow() {
 
 template <bool INCLUSIVE_EQUALITY, bool COMPARE_ROW, HashTable::BucketType TYPE>
 inline int64_t HashTable::Probe(Bucket* buckets, uint32_t* hash_array,
-    int64_t num_buckets, HashTableCtx* __restrict__ ht_ctx, uint32_t hash, bool* found,
-    BucketData* bd) {
+    uint8_t* tag_array, int64_t num_buckets, HashTableCtx* __restrict__ ht_ctx,
+    uint32_t hash, bool* found, BucketData* bd) {
   DCHECK(ht_ctx != nullptr);
   DCHECK(buckets != nullptr);
   DCHECK_GT(num_buckets, 0);
   *found = false;
   ++ht_ctx->num_probes_;
+  if (group_probing()) {
+    return GroupProbe<INCLUSIVE_EQUALITY, COMPARE_ROW, TYPE>(
+        buckets, hash_array, tag_array, num_buckets, ht_ctx, hash, found, bd);
+  }
   int64_t bucket_idx = hash & (num_buckets - 1);
 
   // In case of linear probing it counts the total number of steps for statistics and
@@ -97,13 +111,67 @@ inline int64_t HashTable::Probe(Bucket* buckets, uint32_t* hash_array,
   return Iterator::BUCKET_NOT_FOUND;
 }
 
+template <bool INCLUSIVE_EQUALITY, bool COMPARE_ROW, HashTable::BucketType TYPE>
+inline int64_t HashTable::GroupProbe(Bucket* buckets, uint32_t* hash_array,
+    uint8_t* tag_array, int64_t num_buckets, HashTableCtx* __restrict__ ht_ctx,
+    uint32_t hash, bool* found, BucketData* bd) {
+  DCHECK(tag_array != nullptr);
+  // Tables with fewer than GROUP_SIZE buckets have a single, padded group.
+  int64_t num_groups = std::max<int64_t>(num_buckets / GROUP_SIZE, 1);
+  int64_t group_idx = (hash & (num_buckets - 1)) / GROUP_SIZE;
+  const __m128i tag = _mm_set1_epi8(static_cast<char>(HashTag(hash)));
+  const __m128i empty_tag = _mm_set1_epi8(static_cast<char>(EMPTY_TAG));
+
+  // Counts the number of groups visited and is used for the quadratic probing of the
+  // groups, like 'step' in Probe().
+  int64_t step = 0;
+  do {
+    int64_t group_start = group_idx * GROUP_SIZE;
+    const __m128i group_tags =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(tag_array + group_start));
+    // Bit i of 'matches' is set if bucket i of the group has the same tag as 'hash'.
+    unsigned int matches = _mm_movemask_epi8(_mm_cmpeq_epi8(group_tags, tag));
+    while (matches != 0) {
+      int64_t bucket_idx = group_start + BitUtil::CountTrailingZeros(matches);
+      matches &= matches - 1;
+      DCHECK(buckets[bucket_idx].IsFilled());
+      if (hash == hash_array[bucket_idx]) {
+        if (COMPARE_ROW
+            && ht_ctx->Equals<INCLUSIVE_EQUALITY>(
+                   GetRow<TYPE>(&buckets[bucket_idx], ht_ctx->scratch_row_, bd))) {
+          *found = true;
+          return bucket_idx;
+        }
+        // Row equality failed, or not performed. This is a hash collision.
+        ++ht_ctx->num_hash_collisions_;
+      }
+    }
+    // Buckets are never removed, so if the group has an empty bucket, no later group
+    // can contain an entry for 'hash'.
+    unsigned int empty = _mm_movemask_epi8(_mm_cmpeq_epi8(group_tags, empty_tag));
+    if (LIKELY(empty != 0)) {
+      int64_t bucket_idx = group_start + BitUtil::CountTrailingZeros(empty);
+      DCHECK(!buckets[bucket_idx].IsFilled());
+      return bucket_idx;
+    }
+    ++step;
+    group_idx = (group_idx + step) & (num_groups - 1);
+  } while (LIKELY(step < num_groups));
+
+  ht_ctx->travel_length_ += step;
+
+  DCHECK_EQ(num_filled_buckets_, num_buckets)
+      << "Group probing of a non-full table failed: " << hash;
+  return Iterator::BUCKET_NOT_FOUND;
+}
+
 inline HashTable::Bucket* HashTable::InsertInternal(
     HashTableCtx* __restrict__ ht_ctx, Status* status) {
   bool found = false;
   uint32_t hash = ht_ctx->expr_values_cache()->CurExprValuesHash();
   BucketData bd;
-  int64_t bucket_idx =
-      Probe<true, true>(buckets_, hash_array_, num_buckets_, ht_ctx, hash, &found, &bd);
+  int64_t bucket_idx = Probe<true, true>(
+      buckets_, hash_array_, tag_array_, num_buckets_, ht_ctx, hash, &found, &bd);
   DCHECK_NE(bucket_idx, Iterator::BUCKET_NOT_FOUND);
   if (found) {
     // We need to insert a duplicate node, note that this may fail to allocate memory.
@@ -149,14 +217,17 @@ inline void HashTable::PrefetchBucket(uint32_t hash) {
   // TODO: Reconsider the locality level with smaller prefetch batch size.
   __builtin_prefetch(&buckets_[bucket_idx], READ ? 0 : 1, 1);
   __builtin_prefetch(&hash_array_[bucket_idx], READ ? 0 : 1, 1);
+  if (group_probing()) {
+    __builtin_prefetch(&tag_array_[bucket_idx & ~(GROUP_SIZE - 1)], READ ? 0 : 1, 1);
+  }
 }
 
 inline HashTable::Iterator HashTable::FindProbeRow(HashTableCtx* __restrict__ ht_ctx) {
   bool found = false;
   uint32_t hash = ht_ctx->expr_values_cache()->CurExprValuesHash();
   BucketData bd;
-  int64_t bucket_idx =
-      Probe<false, true>(buckets_, hash_array_, num_buckets_, ht_ctx, hash, &found, &bd);
+  int64_t bucket_idx = Probe<false, true>(
+      buckets_, hash_array_, tag_array_, num_buckets_, ht_ctx, hash, &found, &bd);
   if (found) {
     return Iterator(this, ht_ctx->scratch_row(), bucket_idx,
         stores_duplicates() ? bd.duplicates : NULL);
@@ -171,7 +242,7 @@ inline HashTable::Iterator HashTable::FindBuildRowBucket(
   uint32_t hash = ht_ctx->expr_values_cache()->CurExprValuesHash();
   BucketData bd;
   int64_t bucket_idx = Probe<true, true, TYPE>(
-      buckets_, hash_array_, num_buckets_, ht_ctx, hash, found, &bd);
+      buckets_, hash_array_, tag_array_, num_buckets_, ht_ctx, hash, found, &bd);
   DuplicateNode* duplicates = NULL;
   if (stores_duplicates() && LIKELY(bucket_idx != Iterator::BUCKET_NOT_FOUND)) {
     duplicates = bd.duplicates;
@@ -222,6 +293,7 @@ inline void HashTable::PrepareBucketForInsert(int64_t bucket_idx, uint32_t hash)
   ++num_filled_buckets_;
   bucket->PrepareBucketForInsert();
   hash_array_[bucket_idx] = hash;
+  if (group_probing()) tag_array_[bucket_idx] = HashTag(hash);
 }
 
 inline HashTable::DuplicateNode* HashTable::AppendNextNode(Bucket* bucket) {
@@ -418,7 +490,8 @@ inline void HashTableCtx::set_level(int level) {
 }
 
 inline int64_t HashTable::CurrentMemSize() const {
-  return num_buckets_ * (sizeof(Bucket) + sizeof(uint32_t))
+  int64_t tag_bytes = group_probing_ ? TagArraySize(num_buckets_) : 0;
+  return num_buckets_ * (sizeof(Bucket) + sizeof(uint32_t)) + tag_bytes
       + num_duplicate_nodes_ * sizeof(DuplicateNode);
 }
 
@@ -24,8 +24,8 @@ namespace impala {
 
 int HdfsColumnarScanner::ProcessScratchBatch(RowBatch* dst_batch) {
   DCHECK(scratch_batch_ != nullptr);
-  ScalarExprEvaluator* const* conjunct_evals = conjunct_evals_->data();
-  const int num_conjuncts = conjunct_evals_->size();
+  ScalarExprEvaluator* const* conjunct_evals = row_conjunct_evals_.data();
+  const int num_conjuncts = row_conjunct_evals_.size();
 
   // Start/end/current iterators over the output rows.
   Tuple** output_row_start =
@@ -44,9 +44,19 @@ int HdfsColumnarScanner::ProcessScratchBatch(RowBatch* dst_batch) {
   // Do not use batch_->AtCapacity() in this loop because it is not necessary
   // to perform the memory capacity check.
   bool* is_selected = scratch_batch_->selected_rows.get() + scratch_batch_->tuple_idx;
+  // Results of the vectorized conjuncts and dictionary row filters, if any. See
+  // EvalVectorizedConjuncts() and MergeDictFilterResults().
+  const bool* passed_vectorized_conjuncts =
+      vectorized_conjuncts_.empty() && !scratch_batch_->has_dict_filter_results ?
+      nullptr :
+      scratch_batch_->passed_vectorized_conjuncts.get() + scratch_batch_->tuple_idx;
   while (scratch_tuple != scratch_tuple_end) {
     *output_row = reinterpret_cast<Tuple*>(scratch_tuple);
     scratch_tuple += tuple_size;
+    if (passed_vectorized_conjuncts != nullptr && !*passed_vectorized_conjuncts++) {
+      *is_selected++ = false;
+      continue;
+    }
     // Evaluate runtime filters and conjuncts. Short-circuit the evaluation if
     // the filters/conjuncts are empty to avoid function calls.
     if (!EvalRuntimeFilters(reinterpret_cast<TupleRow*>(output_row))) {
@@ -103,9 +103,59 @@ Status HdfsColumnarScanner::Open(ScannerContext* context) {
   io_total_bytes_ = PROFILE_IoReadTotalBytes.Instantiate(profile);
   io_skipped_bytes_ = PROFILE_IoReadSkippedBytes.Instantiate(profile);
   num_file_metadata_read_ = PROFILE_NumFileMetadataRead.Instantiate(profile);
+
+  const vector<ScalarExpr*>& conjuncts = scan_node_->conjuncts();
+  DCHECK_EQ(conjuncts.size(), conjunct_evals_->size());
+  vector<int> vectorized_idxs;
+  vector<ScalarExpr*> row_conjuncts;
+  PartitionConjuncts(state_->query_options(), conjuncts, &vectorized_idxs,
+      &row_conjuncts);
+  RETURN_IF_ERROR(vectorized_conjuncts_.Init(state_, &obj_pool_, conjuncts,
+      *conjunct_evals_, vectorized_idxs, state_->batch_size()));
+  for (int i = 0; i < conjunct_evals_->size(); ++i) {
+    auto it = find(vectorized_idxs.begin(), vectorized_idxs.end(), i);
+    if (it == vectorized_idxs.end()) row_conjunct_evals_.push_back((*conjunct_evals_)[i]);
+  }
+  if (!vectorized_conjuncts_.empty()) {
+    scratch_tuples_.reset(new Tuple*[state_->batch_size()]);
+    scratch_sel_.reset(new int[state_->batch_size()]);
+  }
   return Status::OK();
 }
 
+void HdfsColumnarScanner::PartitionConjuncts(const TQueryOptions& query_options,
+    const vector<ScalarExpr*>& conjuncts, vector<int>* vectorized_idxs,
+    vector<ScalarExpr*>* row_conjuncts) {
+  if (query_options.vectorized_conjuncts) {
+    VectorizedConjuncts::Partition(conjuncts, vectorized_idxs, row_conjuncts);
+  } else {
+    row_conjuncts->insert(row_conjuncts->end(), conjuncts.begin(), conjuncts.end());
+  }
+}
+
+void HdfsColumnarScanner::EvalVectorizedConjuncts() {
+  const int num_tuples = scratch_batch_->num_tuples;
+  DCHECK_LE(num_tuples, state_->batch_size());
+  Tuple** tuples = scratch_tuples_.get();
+  for (int i = 0; i < num_tuples; ++i) tuples[i] = scratch_batch_->GetTuple(i);
+  int* sel = scratch_sel_.get();
+  int num_selected = vectorized_conjuncts_.Filter(tuples, 1, num_tuples, sel);
+  bool* passed = scratch_batch_->passed_vectorized_conjuncts.get();
+  memset(passed, 0, num_tuples * sizeof(bool));
+  for (int i = 0; i < num_selected; ++i) passed[sel[i]] = true;
+}
+
+void HdfsColumnarScanner::MergeDictFilterResults() {
+  const int num_tuples = scratch_batch_->num_tuples;
+  bool* passed = scratch_batch_->passed_vectorized_conjuncts.get();
+  const bool* passed_dict_filters = scratch_batch_->passed_dict_filters.get();
+  if (vectorized_conjuncts_.empty()) {
+    memcpy(passed, passed_dict_filters, num_tuples * sizeof(bool));
+  } else {
+    for (int i = 0; i < num_tuples; ++i) passed[i] &= passed_dict_filters[i];
+  }
+}
+
 int HdfsColumnarScanner::FilterScratchBatch(RowBatch* dst_batch) {
   // This function must not be called when the output batch is already full. As long as
   // we always call CommitRows() after TransferScratchTuples(), the output batch can
@@ -129,6 +179,12 @@ int HdfsColumnarScanner::FilterScratchBatch(RowBatch* dst_batch) {
     DCHECK_EQ(0, scratch_batch_->total_allocated_bytes());
     return num_tuples;
   }
+  // Evaluate the vectorized conjuncts on the whole scratch batch the first time that
+  // it is processed and combine them with the dictionary row filters, if any.
+  if (scratch_batch_->tuple_idx == 0) {
+    if (!vectorized_conjuncts_.empty()) EvalVectorizedConjuncts();
+    if (scratch_batch_->has_dict_filter_results) MergeDictFilterResults();
+  }
   return ProcessScratchBatchCodegenOrInterpret(dst_batch);
 }
 
@@ -150,9 +206,14 @@ Status HdfsColumnarScanner::Codegen(HdfsScanPlanNode* node, FragmentState* state
   llvm::Function* fn = codegen->GetFunction(IRFunction::PROCESS_SCRATCH_BATCH, true);
   DCHECK(fn != nullptr);
 
+  // The vectorized conjuncts are evaluated outside of ProcessScratchBatch().
   llvm::Function* eval_conjuncts_fn;
-  const vector<ScalarExpr*>& conjuncts = node->conjuncts_;
-  RETURN_IF_ERROR(ExecNode::CodegenEvalConjuncts(codegen, conjuncts, &eval_conjuncts_fn));
+  vector<int> vectorized_idxs;
+  vector<ScalarExpr*> row_conjuncts;
+  PartitionConjuncts(
+      state->query_options(), node->conjuncts_, &vectorized_idxs, &row_conjuncts);
+  RETURN_IF_ERROR(
+      ExecNode::CodegenEvalConjuncts(codegen, row_conjuncts, &eval_conjuncts_fn));
   DCHECK(eval_conjuncts_fn != nullptr);
 
   int replaced = codegen->ReplaceCallSites(fn, eval_conjuncts_fn, "EvalConjuncts");
@@ -19,8 +19,11 @@
 
 #include "exec/hdfs-scanner.h"
 
+#include <boost/scoped_array.hpp>
 #include <boost/scoped_ptr.hpp>
 
+#include "exprs/vectorized-conjuncts.h"
+
 namespace impala {
 
 class HdfsScanNodeBase;
@@ -28,6 +31,7 @@ class HdfsScanPlanNode;
 class RowBatch;
 class RuntimeState;
 struct ScratchTupleBatch;
+class TQueryOptions;
 
 /// Parent class for scanners that read values into a scratch batch before applying
 /// conjuncts and runtime filters.
@@ -87,6 +91,20 @@ class HdfsColumnarScanner : public HdfsScanner {
   /// Function type: ProcessScratchBatchFn
   const CodegenFnPtrBase* codegend_process_scratch_batch_fn_ = nullptr;
 
+  /// The conjuncts on the scanned tuple that are evaluated on a whole scratch batch at
+  /// once by EvalVectorizedConjuncts(). Only used if the VECTORIZED_CONJUNCTS query
+  /// option is set.
+  VectorizedConjuncts vectorized_conjuncts_;
+
+  /// Evaluators of the conjuncts that are not in 'vectorized_conjuncts_'. These are
+  /// evaluated row by row in ProcessScratchBatch().
+  std::vector<ScalarExprEvaluator*> row_conjunct_evals_;
+
+  /// Scratch space for EvalVectorizedConjuncts() with an entry per tuple of
+  /// 'scratch_batch_'. Only allocated if 'vectorized_conjuncts_' is not empty.
+  boost::scoped_array<Tuple*> scratch_tuples_;
+  boost::scoped_array<int> scratch_sel_;
+
   /// Filters out tuples from 'scratch_batch_' and adds the surviving tuples
   /// to the given batch. Finalizing transfer of batch is not done here.
   /// Returns the number of tuples that should be committed to the given batch.
@@ -107,6 +125,24 @@ class HdfsColumnarScanner : public HdfsScanner {
   /// materialized tuples. This is a separate function so it can be codegened.
   int ProcessScratchBatch(RowBatch* dst_batch);
 
+  /// Evaluates 'vectorized_conjuncts_' on all tuples of 'scratch_batch_' and records
+  /// the result in 'scratch_batch_->passed_vectorized_conjuncts'.
+  void EvalVectorizedConjuncts();
+
+  /// Combines 'scratch_batch_->passed_dict_filters', which the Parquet scanner fills
+  /// before filtering the scratch batch, into
+  /// 'scratch_batch_->passed_vectorized_conjuncts' so that ProcessScratchBatch() drops
+  /// the rows rejected by either of them.
+  void MergeDictFilterResults();
+
+  /// Splits 'conjuncts' into the conjuncts that are evaluated by VectorizedConjuncts,
+  /// whose indices are appended to 'vectorized_idxs', and the remaining ones, which are
+  /// appended to 'row_conjuncts'. All conjuncts are row conjuncts unless the
+  /// VECTORIZED_CONJUNCTS query option is set.
+  static void PartitionConjuncts(const TQueryOptions& query_options,
+      const std::vector<ScalarExpr*>& conjuncts, std::vector<int>* vectorized_idxs,
+      std::vector<ScalarExpr*>* row_conjuncts);
+
   /// List of pair of (column index, reservation allocated).
   typedef std::vector<std::pair<int, int64_t>> ColumnReservations;
   /// List of column range lengths.
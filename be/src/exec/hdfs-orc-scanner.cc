@@ -27,6 +27,8 @@
 #include "exprs/scalar-expr.h"
 #include "runtime/collection-value-builder.h"
 #include "runtime/exec-env.h"
+#include "runtime/io/disk-io-mgr.h"
+#include "runtime/io/file-metadata-cache.h"
 #include "runtime/io/request-context.h"
 #include "runtime/mem-tracker.h"
 #include "runtime/runtime-filter.inline.h"
@@ -496,6 +498,20 @@ void HdfsOrcScanner::Close(RowBatch* row_batch) {
 }
 
 Status HdfsOrcScanner::ProcessFileTail() {
+  // Reuse the file tail of this file if another scanner has read it before. The ORC
+  // reader then skips reading the postscript, footer and metadata.
+  FileMetadataCache* metadata_cache =
+      ExecEnv::GetInstance()->disk_io_mgr()->file_metadata_cache();
+  string cache_key;
+  shared_ptr<const string> cached_tail;
+  if (metadata_cache != nullptr) {
+    int64_t partition_id = context_->partition_descriptor()->id();
+    const HdfsFileDesc* file_desc = scan_node_->GetFileDesc(partition_id, filename());
+    cache_key = FileMetadataCache::MakeKey(FileMetadataCache::Kind::ORC_FILE_TAIL,
+        filename(), file_desc->mtime, file_desc->file_length);
+    cached_tail = metadata_cache->Lookup<string>(cache_key);
+  }
+  reader_options_.setSerializedFileTail(cached_tail != nullptr ? *cached_tail : "");
   try {
     // ScanRangeInputStream keeps a pointer to this HdfsOrcScanner so we can hack
     // async IO behind the orc::InputStream interface. The ranges of the
@@ -504,6 +520,11 @@ Status HdfsOrcScanner::ProcessFileTail() {
     VLOG_FILE << "Processing FileTail of ORC file: " << input_stream->getName()
               << ", file_length: " << input_stream->getLength();
     reader_ = orc::createReader(move(input_stream), reader_options_);
+    if (metadata_cache != nullptr && cached_tail == nullptr) {
+      string tail = reader_->getSerializedFileTail();
+      int64_t charge = tail.size();
+      metadata_cache->Insert(cache_key, make_shared<const string>(move(tail)), charge);
+    }
   } RETURN_ON_ORC_EXCEPTION("Encountered parse error in tail of ORC file $0: $1");
 
   if (reader_->getNumberOfRows() == 0)  return Status::OK();
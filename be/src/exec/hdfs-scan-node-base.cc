@@ -919,8 +919,24 @@ void HdfsScanNodeBase::InitNullCollectionValues(RowBatch* row_batch) const {
 
 bool HdfsScanNodeBase::PartitionPassesFilters(int32_t partition_id,
     const string& stats_name, const vector<FilterContext>& filter_ctxs) {
+  return EvalPartitionFilters(partition_id, &stats_name, filter_ctxs);
+}
+
+bool HdfsScanNodeBase::PartitionStillPassesFilters(
+    int32_t partition_id, const vector<FilterContext>& filter_ctxs) {
+  return EvalPartitionFilters(partition_id, nullptr, filter_ctxs);
+}
+
+bool HdfsScanNodeBase::EvalPartitionFilters(int32_t partition_id,
+    const string* stats_name, const vector<FilterContext>& filter_ctxs) {
   if (filter_ctxs.empty()) return true;
-  if (FilterContext::CheckForAlwaysFalse(stats_name, filter_ctxs)) return false;
+  if (stats_name != nullptr) {
+    if (FilterContext::CheckForAlwaysFalse(*stats_name, filter_ctxs)) return false;
+  } else {
+    for (const FilterContext& ctx : filter_ctxs) {
+      if (ctx.filter->AlwaysFalse()) return false;
+    }
+  }
   DCHECK_EQ(filter_ctxs.size(), filter_ctxs_.size())
       << "Mismatched number of filter contexts";
   Tuple* template_tuple = GetTemplateTupleForPartitionId(partition_id);
@@ -934,7 +950,9 @@ bool HdfsScanNodeBase::PartitionPassesFilters(int32_t partition_id,
 
     bool has_filter = ctx.filter->HasFilter();
     bool passed_filter = !has_filter || ctx.Eval(tuple_row_mem);
-    ctx.stats->IncrCounters(stats_name, 1, has_filter, !passed_filter);
+    if (stats_name != nullptr) {
+      ctx.stats->IncrCounters(*stats_name, 1, has_filter, !passed_filter);
+    }
     if (!passed_filter) return false;
   }
 
@@ -640,6 +640,12 @@ class HdfsScanNodeBase : public ScanNode {
   bool PartitionPassesFilters(int32_t partition_id, const std::string& stats_name,
       const std::vector<FilterContext>& filter_ctxs);
 
+  /// Same as PartitionPassesFilters(), but does not update the filter statistics. Used
+  /// to check a partition again after more filters arrived, when it was already counted
+  /// in the statistics.
+  bool PartitionStillPassesFilters(
+      int32_t partition_id, const std::vector<FilterContext>& filter_ctxs);
+
   /// Update book-keeping to skip the scan range if it has been issued but will not be
   /// processed by a scanner. E.g. used to cancel ranges that are filtered out by
   /// late-arriving filters that could not be applied in IssueInitialScanRanges()
@@ -937,6 +943,11 @@ class HdfsScanNodeBase : public ScanNode {
   typedef std::map<std::tuple<THdfsFileFormat::type, bool, HdfsCompressionTypesSet>, int>
       FileTypeCountsMap;
   FileTypeCountsMap file_type_counts_;
+
+  /// Implements PartitionPassesFilters() and PartitionStillPassesFilters(). The
+  /// statistics under 'stats_name' are only updated if it is non-NULL.
+  bool EvalPartitionFilters(int32_t partition_id, const std::string* stats_name,
+      const std::vector<FilterContext>& filter_ctxs);
 };
 }
 
@@ -38,6 +38,7 @@
 #include "runtime/runtime-state.h"
 #include "runtime/scanner-mem-limiter.h"
 #include "runtime/thread-resource-mgr.h"
+#include "util/bit-util.h"
 #include "util/debug-util.h"
 #include "util/disk-info.h"
 #include "util/runtime-profile-counters.h"
@@ -102,6 +103,12 @@ Status HdfsScanNode::GetNext(RuntimeState* state, RowBatch* row_batch, bool* eos
       return status;
     }
 
+    // Filters that did not arrive while IssueInitialScanRanges() waited for them may
+    // still arrive while rows are being queued.
+    for (int i = 0; i < filter_ctxs_.size() && i < MAX_LATE_FILTERS; ++i) {
+      if (!filter_ctxs_[i].filter->HasFilter()) late_filters_ |= 1ULL << i;
+    }
+
     // Release the scanner threads
     discard_result(ranges_issued_barrier_.Notify());
 
@@ -132,7 +139,18 @@ Status HdfsScanNode::GetNextInternal(
   *eos = false;
   unique_ptr<RowBatch> materialized_batch = thread_state_.batch_queue()->GetBatch();
   if (materialized_batch != NULL) {
+    uint64_t applied_filters = late_filters_;
+    if (late_filters_ != 0) {
+      lock_guard<SpinLock> l(late_filters_lock_);
+      auto it = batch_arrived_filters_.find(materialized_batch.get());
+      DCHECK(it != batch_arrived_filters_.end());
+      if (it != batch_arrived_filters_.end()) {
+        applied_filters = it->second;
+        batch_arrived_filters_.erase(it);
+      }
+    }
     row_batch->AcquireState(materialized_batch.get());
+    if (applied_filters != late_filters_) ApplyLateFilters(applied_filters, row_batch);
     // Note that the scanner threads may have processed and queued up extra rows before
     // this thread incremented the rows returned.
     if (CheckLimitAndTruncateRowBatchIfNeededShared(row_batch, eos)) SetDone();
@@ -147,6 +165,58 @@ Status HdfsScanNode::GetNextInternal(
   return status_;
 }
 
+uint64_t HdfsScanNode::ArrivedLateFilters() const {
+  uint64_t arrived = 0;
+  for (uint64_t remaining = late_filters_; remaining != 0; remaining &= remaining - 1) {
+    int idx = BitUtil::CountTrailingZeros(remaining);
+    if (filter_ctxs_[idx].filter->HasFilter()) arrived |= 1ULL << idx;
+  }
+  return arrived;
+}
+
+void HdfsScanNode::ApplyLateFilters(uint64_t applied_filters, RowBatch* row_batch) {
+  // No scanner evaluated the filters that had not arrived when 'row_batch' was queued
+  // against any of its rows, since arrival is permanent. Filters that arrived while the
+  // batch was being built were applied to only some rows; the rows that they miss are
+  // still removed by the join that produced the filter.
+  vector<const FilterContext*> filters;
+  for (uint64_t remaining = late_filters_ & ~applied_filters; remaining != 0;
+       remaining &= remaining - 1) {
+    const FilterContext& ctx = filter_ctxs_[BitUtil::CountTrailingZeros(remaining)];
+    if (!ctx.filter->HasFilter() || ctx.filter->AlwaysTrue()) continue;
+    filters.push_back(&ctx);
+  }
+  if (filters.empty()) return;
+
+  // Compact the rows that pass all filters in place. The memory referenced by the
+  // removed rows stays attached to 'row_batch'.
+  vector<int> num_processed(filters.size(), 0);
+  vector<int> num_rejected(filters.size(), 0);
+  int num_rows = row_batch->num_rows();
+  int num_passed = 0;
+  for (int i = 0; i < num_rows; ++i) {
+    TupleRow* row = row_batch->GetRow(i);
+    bool passed = true;
+    for (int j = 0; j < filters.size(); ++j) {
+      ++num_processed[j];
+      if (!filters[j]->Eval(row)) {
+        ++num_rejected[j];
+        passed = false;
+        break;
+      }
+    }
+    if (!passed) continue;
+    if (num_passed != i) row_batch->CopyRow(row, row_batch->GetRow(num_passed));
+    ++num_passed;
+  }
+  row_batch->set_num_rows(num_passed);
+  for (int j = 0; j < filters.size(); ++j) {
+    filters[j]->stats->IncrCounters(
+        FilterStats::ROWS_KEY, num_processed[j], num_processed[j], num_rejected[j]);
+  }
+  COUNTER_ADD(rows_filtered_late_counter_, num_rows - num_passed);
+}
+
 Status HdfsScanNode::Prepare(RuntimeState* state) {
   SCOPED_TIMER(runtime_profile_->total_time_counter());
   RETURN_IF_ERROR(HdfsScanNodeBase::Prepare(state));
@@ -155,6 +225,8 @@ Status HdfsScanNode::Prepare(RuntimeState* state) {
       ADD_COUNTER(runtime_profile(), "NumScannerThreadReservationsDenied", TUnit::UNIT);
   scanner_thread_workless_loops_counter_ =
       ADD_COUNTER(runtime_profile(), "ScannerThreadWorklessLoops", TUnit::UNIT);
+  rows_filtered_late_counter_ =
+      ADD_COUNTER(runtime_profile(), "RowsRejectedByLateRuntimeFilters", TUnit::UNIT);
   return Status::OK();
 }
 
@@ -179,6 +251,7 @@ void HdfsScanNode::Close(RuntimeState* state) {
     state->resource_pool()->RemoveThreadAvailableCb(thread_avail_cb_id_);
   }
   thread_state_.Close(this);
+  batch_arrived_filters_.clear();
 #ifndef NDEBUG
   // At this point, the other threads have been joined, and
   // remaining_scan_range_submissions_ should be 0, if the
@@ -204,6 +277,11 @@ void HdfsScanNode::TransferToScanNodePool(MemPool* pool) {
 
 void HdfsScanNode::AddMaterializedRowBatch(unique_ptr<RowBatch> row_batch) {
   InitNullCollectionValues(row_batch.get());
+  if (late_filters_ != 0) {
+    uint64_t arrived = ArrivedLateFilters();
+    lock_guard<SpinLock> l(late_filters_lock_);
+    batch_arrived_filters_[row_batch.get()] = arrived;
+  }
   thread_state_.EnqueueBatch(move(row_batch));
 }
 
@@ -21,6 +21,7 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/scoped_ptr.hpp>
@@ -156,6 +157,25 @@ class HdfsScanNode : public HdfsScanNodeBase {
   /// Number of times scanner thread didn't find work to do.
   RuntimeProfile::Counter* scanner_thread_workless_loops_counter_ = nullptr;
 
+  /// Bitmask over 'filter_ctxs_' of the runtime filters that had not arrived when the
+  /// initial scan ranges were issued. Scanners start applying such a filter to the rows
+  /// they materialize once it arrives, but the batches that were already queued at that
+  /// time do not reflect it, so GetNextInternal() applies it to them. Only the first
+  /// MAX_LATE_FILTERS filters are tracked. Set before the scanner threads are released
+  /// and not modified afterwards.
+  static const int MAX_LATE_FILTERS = 64;
+  uint64_t late_filters_ = 0;
+
+  /// Maps each queued batch to the bitmask of the filters in 'late_filters_' that had
+  /// arrived when the batch was added to the queue. A scanner may have evaluated those
+  /// filters against the rows of the batch, but none of the others, so the others are
+  /// applied exactly once. Protected by 'late_filters_lock_'.
+  std::unordered_map<const RowBatch*, uint64_t> batch_arrived_filters_;
+  SpinLock late_filters_lock_;
+
+  /// Number of rows that were removed from queued batches by late filters.
+  RuntimeProfile::Counter* rows_filtered_late_counter_ = nullptr;
+
   /// Compute the estimated memory consumption of a scanner thread in bytes for the
   /// purposes of deciding whether to start a new scanner thread.
   int64_t EstimateScannerThreadMemConsumption() const;
@@ -197,6 +217,14 @@ class HdfsScanNode : public HdfsScanNodeBase {
   Status GetNextInternal(RuntimeState* state, RowBatch* row_batch, bool* eos)
       WARN_UNUSED_RESULT;
 
+  /// Returns the bitmask of the filters in 'late_filters_' that have arrived.
+  uint64_t ArrivedLateFilters() const;
+
+  /// Applies the filters in 'late_filters_' that have arrived, except those in
+  /// 'applied_filters', to 'row_batch', which was just taken from the queue, and removes
+  /// the rows that they reject.
+  void ApplyLateFilters(uint64_t applied_filters, RowBatch* row_batch);
+
   /// Sets done_ to true, updates status_ if there was an error and triggers threads to
   /// cleanup. Must be called with lock_ taken. Calling it repeatedly ignores subsequent
   /// calls.
@@ -123,6 +123,9 @@ Status HdfsScanner::ProcessSplit() {
   DCHECK(scan_node_->HasRowBatchQueue());
   HdfsScanNode* scan_node = static_cast<HdfsScanNode*>(scan_node_);
   bool returned_rows = false;
+  // The partition was checked against the filters that had arrived when the range was
+  // started. Check it again whenever another filter on partition columns arrives.
+  int num_partition_filters = NumArrivedPartitionFilters();
   do {
     // IMPALA-3798, IMPALA-3804: For sequence-based files, the filters are only
     // applied in HdfsScanNode::ProcessSplit()
@@ -133,6 +136,15 @@ Status HdfsScanner::ProcessSplit() {
       eos_ = true;
       break;
     }
+    if (!is_sequence_based && NumArrivedPartitionFilters() != num_partition_filters) {
+      num_partition_filters = NumArrivedPartitionFilters();
+      // The split was already counted in the SPLITS statistics when it was started.
+      if (!scan_node_->PartitionStillPassesFilters(
+          context_->partition_descriptor()->id(), context_->filter_ctxs())) {
+        eos_ = true;
+        break;
+      }
+    }
     unique_ptr<RowBatch> batch = std::make_unique<RowBatch>(scan_node_->row_desc(),
         state_->batch_size(), scan_node_->mem_tracker());
     if (scan_node_->is_partition_key_scan()) batch->limit_capacity(1);
@@ -148,6 +160,17 @@ Status HdfsScanner::ProcessSplit() {
   return Status::OK();
 }
 
+int HdfsScanner::NumArrivedPartitionFilters() const {
+  int num_arrived = 0;
+  for (const FilterContext& ctx : context_->filter_ctxs()) {
+    const RuntimeFilter* filter = ctx.filter;
+    if (filter->IsBoundByPartitionColumn(scan_node_->id()) && filter->HasFilter()) {
+      ++num_arrived;
+    }
+  }
+  return num_arrived;
+}
+
 void HdfsScanner::Close() {
   DCHECK(scan_node_->HasRowBatchQueue());
   RowBatch* final_batch = new RowBatch(scan_node_->row_desc(), state_->batch_size(),
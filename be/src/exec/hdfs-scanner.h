@@ -399,6 +399,10 @@ class HdfsScanner {
   /// replaced by generated code at runtime.
   bool EvalRuntimeFilters(TupleRow* row);
 
+  /// Returns the number of runtime filters on partition columns of this scan node that
+  /// have arrived. Used by ProcessSplit() to notice filters that arrive mid-range.
+  int NumArrivedPartitionFilters() const;
+
   /// Find and return the last split in the file if it is assigned to this scan node.
   /// Returns NULL otherwise.
   static io::ScanRange* FindFooterSplit(HdfsFileDesc* file);
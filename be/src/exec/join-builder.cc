@@ -17,9 +17,17 @@
 
 #include "exec/join-builder.h"
 
+#include "exprs/scalar-expr-evaluator.h"
+#include "exprs/scalar-expr.h"
+#include "runtime/runtime-filter-bank.h"
+#include "runtime/runtime-filter.h"
 #include "service/hs2-util.h"
+#include "util/bitmap-filter.h"
+#include "util/bloom-filter.h"
 #include "util/debug-util.h"
+#include "util/in-list-filter.h"
 #include "util/min-max-filter.h"
+#include "util/pretty-printer.h"
 #include "util/runtime-profile-counters.h"
 
 #include "common/names.h"
@@ -76,8 +84,16 @@ Status JoinBuilder::WaitForInitialBuild(RuntimeState* join_node_state) {
   unique_lock<mutex> l(separate_build_lock_);
   // Wait until either the build is ready to use or this finstance has been cancelled.
   // We can't safely pick up the build side if the build side was cancelled - instead we
-  // need to wait for this finstance to be cancelled.
+  // need to wait for this finstance to be cancelled. Help with the build if there are
+  // any tasks from RunBuildTasks() left in the meantime.
+  int worker = -1;
   while (!ready_to_probe_ && !join_node_state->is_cancelled()) {
+    if (HasBuildTask()) {
+      if (worker == -1) worker = ++num_build_workers_;
+      DCHECK_LE(worker, num_probe_threads_);
+      RunBuildTasksLoop(worker, &l);
+      continue;
+    }
     probe_wakeup_cv_.Wait(l);
   }
   if (join_node_state->is_cancelled()) {
@@ -127,16 +143,80 @@ void JoinBuilder::HandoffToProbesAndWait(RuntimeState* build_side_state) {
   }
 }
 
+Status JoinBuilder::RunBuildTasks(
+    int num_tasks, const std::function<Status(int, int)>& task_fn) {
+  DCHECK(is_separate_build_) << "Doesn't make sense for embedded builder.";
+  unique_lock<mutex> l(separate_build_lock_);
+  DCHECK(build_task_fn_ == nullptr);
+  DCHECK(!ready_to_probe_);
+  build_task_fn_ = &task_fn;
+  num_build_tasks_ = num_tasks;
+  next_build_task_ = 0;
+  build_tasks_status_ = Status::OK();
+  probe_wakeup_cv_.NotifyAll();
+  RunBuildTasksLoop(0, &l);
+  // The remaining tasks were picked up by probe-side threads. Wait for them to finish,
+  // which does not depend on the probe side making progress otherwise.
+  while (running_build_tasks_ > 0) build_wakeup_cv_.Wait(l);
+  VLOG(3) << "JoinBuilder (id=" << join_node_id_ << ") ran " << num_tasks
+          << " build tasks with the help of " << num_build_workers_ << " probe threads.";
+  build_task_fn_ = nullptr;
+  return build_tasks_status_;
+}
+
+void JoinBuilder::RunBuildTasksLoop(int worker, unique_lock<mutex>* lock) {
+  DCHECK(lock->owns_lock());
+  while (HasBuildTask()) {
+    int task = next_build_task_++;
+    const std::function<Status(int, int)>& task_fn = *build_task_fn_;
+    ++running_build_tasks_;
+    lock->unlock();
+    Status status = task_fn(task, worker);
+    lock->lock();
+    --running_build_tasks_;
+    if (!status.ok() && build_tasks_status_.ok()) build_tasks_status_ = status;
+    if (running_build_tasks_ == 0) build_wakeup_cv_.NotifyAll();
+  }
+}
+
 void JoinBuilder::PublishRuntimeFilters(const std::vector<FilterContext>& filter_ctxs,
     RuntimeState* runtime_state, float minmax_filter_threshold, int64_t num_build_rows) {
   VLOG(3) << name() << " publishing "
           << filter_ctxs.size() << " filters.";
   int32_t num_enabled_filters = 0;
+  int64_t bloom_bytes_saved = 0;
+  SelectExactFilters(filter_ctxs);
   for (const FilterContext& ctx : filter_ctxs) {
     BloomFilter* bloom_filter = nullptr;
+    int64_t bloom_ndv_upper_bound = 0;
     if (ctx.local_bloom_filter != nullptr) {
-      bloom_filter = ctx.local_bloom_filter;
-      ++num_enabled_filters;
+      bloom_ndv_upper_bound = BuildNdvUpperBound(filter_ctxs, ctx, num_build_rows);
+      if (IsRedundantBloomFilter(filter_ctxs, ctx)) {
+        // Publishing an always true filter disables it at the targets.
+        VLOG(3) << "Bloom filter " << ctx.filter->id() << " is redundant with an "
+                << "in-list or bitmap filter. Disabled.";
+        bloom_bytes_saved += ctx.local_bloom_filter->GetBufferPoolSpaceUsed();
+      } else if (!ctx.filter->filter_desc().is_broadcast_join) {
+        // The filters of the other producers hold different values, so only the
+        // coordinator knows how large the aggregated filter needs to be. It shrinks the
+        // filter once all updates were received.
+        bloom_filter = ctx.local_bloom_filter;
+        ++num_enabled_filters;
+      } else {
+        int64_t bytes_saved = 0;
+        Status status = ShrinkBloomFilter(
+            runtime_state, ctx, bloom_ndv_upper_bound, &bytes_saved);
+        if (status.ok()) {
+          bloom_bytes_saved += bytes_saved;
+          bloom_filter = ctx.local_bloom_filter;
+          ++num_enabled_filters;
+        } else {
+          // The directory is lost if reallocating it failed. Publish an always true
+          // filter instead.
+          VLOG(2) << "Could not shrink bloom filter " << ctx.filter->id() << ": "
+                  << status.GetDetail();
+        }
+      }
     } else if (ctx.local_min_max_filter != nullptr) {
       /// Apply the column min/max stats (if applicable) to shut down the min/max
       /// filter early by setting always true flag for the filter. Do this only if
@@ -172,10 +252,17 @@ void JoinBuilder::PublishRuntimeFilters(const std::vector<FilterContext>& filter
       if (!ctx.local_in_list_filter->AlwaysTrue()) {
         ++num_enabled_filters;
       }
+    } else if (ctx.local_bitmap_filter != nullptr) {
+      if (!ctx.local_bitmap_filter->AlwaysTrue()) {
+        ++num_enabled_filters;
+      }
+      VLOG(3) << name() << " publishing " << ctx.local_bitmap_filter->DebugString()
+              << ", id=" << ctx.filter->id();
     }
 
-    runtime_state->filter_bank()->UpdateFilterFromLocal(ctx.filter->id(),
-        bloom_filter, ctx.local_min_max_filter, ctx.local_in_list_filter);
+    runtime_state->filter_bank()->UpdateFilterFromLocal(ctx.filter->id(), bloom_filter,
+        ctx.local_min_max_filter, ctx.local_in_list_filter, ctx.local_bitmap_filter,
+        bloom_ndv_upper_bound);
 
     if (ctx.local_min_max_filter != nullptr) {
       VLOG(3) << name() << " published min/max filter: "
@@ -196,5 +283,129 @@ void JoinBuilder::PublishRuntimeFilters(const std::vector<FilterContext>& filter
     }
     profile()->AddInfoString("Runtime filters", info_string);
   }
+  if (bloom_bytes_saved > 0) {
+    COUNTER_ADD(ADD_COUNTER(profile(), "BloomFilterBytesSaved", TUnit::BYTES),
+        bloom_bytes_saved);
+  }
+}
+
+int64_t JoinBuilder::BuildNdvUpperBound(const vector<FilterContext>& filter_ctxs,
+    const FilterContext& ctx, int64_t num_build_rows) {
+  const TExpr& src_expr = ctx.filter->filter_desc().src_expr;
+  int64_t ndv = num_build_rows;
+  for (const FilterContext& other : filter_ctxs) {
+    if (&other == &ctx || !(other.filter->filter_desc().src_expr == src_expr)) continue;
+    if (other.local_in_list_filter != nullptr
+        && !other.local_in_list_filter->AlwaysTrue()) {
+      // One more for NULL, which in-list and min-max filters do not hold.
+      ndv = min<int64_t>(ndv, other.local_in_list_filter->NumItems() + 1);
+    } else if (other.local_min_max_filter != nullptr
+        && !other.local_min_max_filter->AlwaysFalse()) {
+      // Integer min-max filters are only set to always true when they are not useful,
+      // in which case they still hold the range of the build values.
+      const ColumnType& type = other.expr_eval->root().type();
+      int64_t min_val, max_val;
+      if (!type.IsIntegerType()
+          || !other.local_min_max_filter->GetCastIntMinMax(type, &min_val, &max_val)) {
+        continue;
+      }
+      // Computed as unsigned to not overflow for BIGINT.
+      uint64_t range = static_cast<uint64_t>(max_val) - static_cast<uint64_t>(min_val);
+      if (range < static_cast<uint64_t>(ndv)) ndv = range + 2;
+    }
+  }
+  return ndv;
+}
+
+/// Returns true if 'ctx' has an in-list or bitmap filter that holds exactly the build
+/// values, i.e. that is not always true.
+static bool IsExactFilter(const FilterContext& ctx) {
+  return (ctx.local_in_list_filter != nullptr && !ctx.local_in_list_filter->AlwaysTrue())
+      || (ctx.local_bitmap_filter != nullptr && !ctx.local_bitmap_filter->AlwaysTrue());
+}
+
+/// Returns the number of bytes that the exact filter of 'ctx' is published with. In-list
+/// filters are sent as a list of values, which take 8 bytes each for the integer types
+/// that bitmap filters support.
+static int64_t ExactFilterBytes(const FilterContext& ctx) {
+  DCHECK(IsExactFilter(ctx));
+  if (ctx.local_bitmap_filter != nullptr) return ctx.local_bitmap_filter->NumBytes();
+  return ctx.local_in_list_filter->NumItems() * sizeof(int64_t);
+}
+
+/// Returns true if 'other' has the same build expr as 'desc' and is applied to every
+/// target expr of 'desc'.
+static bool CoversTargets(
+    const TRuntimeFilterDesc& desc, const TRuntimeFilterDesc& other) {
+  if (!(other.src_expr == desc.src_expr)) return false;
+  for (const TRuntimeFilterTargetDesc& target : desc.targets) {
+    auto it = find_if(other.targets.begin(), other.targets.end(),
+        [&target](const TRuntimeFilterTargetDesc& t) {
+          return t.node_id == target.node_id && t.target_expr == target.target_expr;
+        });
+    if (it == other.targets.end()) return false;
+  }
+  return true;
+}
+
+void JoinBuilder::SelectExactFilters(const vector<FilterContext>& filter_ctxs) {
+  for (const FilterContext& ctx : filter_ctxs) {
+    const TRuntimeFilterDesc& desc = ctx.filter->filter_desc();
+    if (!desc.is_broadcast_join || !IsExactFilter(ctx)) continue;
+    int64_t bytes = ExactFilterBytes(ctx);
+    for (const FilterContext& other : filter_ctxs) {
+      if (&other == &ctx || !IsExactFilter(other)
+          || !CoversTargets(desc, other.filter->filter_desc())) {
+        continue;
+      }
+      int64_t other_bytes = ExactFilterBytes(other);
+      if (other_bytes > bytes
+          || (other_bytes == bytes && other.local_bitmap_filter == nullptr)) {
+        continue;
+      }
+      VLOG(3) << "Filter " << ctx.filter->id() << " of " << bytes << " bytes is "
+              << "redundant with filter " << other.filter->id() << " of " << other_bytes
+              << " bytes. Disabled.";
+      if (ctx.local_in_list_filter != nullptr) {
+        ctx.local_in_list_filter->SetAlwaysTrue();
+      } else {
+        ctx.local_bitmap_filter->SetAlwaysTrue();
+      }
+      break;
+    }
+  }
+}
+
+bool JoinBuilder::IsRedundantBloomFilter(
+    const vector<FilterContext>& filter_ctxs, const FilterContext& ctx) {
+  const TRuntimeFilterDesc& desc = ctx.filter->filter_desc();
+  // The local filters of a partitioned join only hold the values of one partition. An
+  // exact local filter may still become always true when it is aggregated.
+  if (!desc.is_broadcast_join) return false;
+  for (const FilterContext& other : filter_ctxs) {
+    if (IsExactFilter(other) && CoversTargets(desc, other.filter->filter_desc())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Status JoinBuilder::ShrinkBloomFilter(RuntimeState* runtime_state,
+    const FilterContext& ctx, int64_t ndv, int64_t* bytes_saved) {
+  *bytes_saved = 0;
+  BloomFilter* bloom_filter = ctx.local_bloom_filter;
+  if (bloom_filter->AlwaysFalse()) return Status::OK();
+  int log_size =
+      RuntimeFilterBank::MinBloomFilterLogSpace(runtime_state->query_options(), ndv);
+  int64_t old_size = bloom_filter->GetBufferPoolSpaceUsed();
+  if (log_size >= bloom_filter->log_bufferpool_space()) return Status::OK();
+  RETURN_IF_ERROR(bloom_filter->Fold(log_size, mem_tracker()));
+  if (bloom_filter->GetBufferPoolSpaceUsed() == old_size) return Status::OK();
+  VLOG(3) << "Shrunk bloom filter " << ctx.filter->id() << " from "
+          << PrettyPrinter::PrintBytes(old_size) << " to "
+          << PrettyPrinter::PrintBytes(bloom_filter->GetBufferPoolSpaceUsed())
+          << " for at most " << ndv << " distinct values";
+  *bytes_saved = old_size - bloom_filter->GetBufferPoolSpaceUsed();
+  return Status::OK();
 }
 } // namespace impala
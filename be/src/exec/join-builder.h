@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <functional>
 #include <mutex>
 
 #include "exec/data-sink.h"
@@ -197,6 +198,20 @@ class JoinBuilder : public DataSink {
   // Protected by 'separate_build_lock_'.
   int probe_refcount_ = 0;
 
+  // State of the tasks run by RunBuildTasks(). 'build_task_fn_' is non-null while
+  // RunBuildTasks() is running. 'next_build_task_' is the next task to be picked up,
+  // 'running_build_tasks_' the number of tasks that were picked up but did not finish
+  // yet and 'num_build_workers_' the number of probe-side threads that picked up tasks
+  // so far, which are numbered from 1 in the order that they first did so.
+  // 'build_tasks_status_' is the first error returned by a task.
+  // Protected by 'separate_build_lock_'.
+  const std::function<Status(int, int)>* build_task_fn_ = nullptr;
+  int num_build_tasks_ = 0;
+  int next_build_task_ = 0;
+  int running_build_tasks_ = 0;
+  int num_build_workers_ = 0;
+  Status build_tasks_status_;
+
   /// END: Members that are used only when is_separate_build_ is true
   /////////////////////////////////////////////////////////////////////
 
@@ -212,12 +227,76 @@ class JoinBuilder : public DataSink {
   /// of being blocked indefinitely.
   void HandoffToProbesAndWait(RuntimeState* build_side_state);
 
+  /// Called by the build-side thread of a separate join build to run 'task_fn' for the
+  /// tasks 0 to 'num_tasks' - 1 before the initial build is handed off. Probe-side
+  /// threads that are blocked in WaitForInitialBuild() in the meantime pick up some of
+  /// the tasks, so that the build can use the threads of all fragment instances that
+  /// share it. 'task_fn' is called with the task and with the index of the calling
+  /// thread, which is 0 for the build-side thread and in [1, num_probe_threads_] for
+  /// the probe-side threads, so that each thread can use its own copy of state that is
+  /// not thread-safe. No more tasks are picked up once a task returned an error.
+  /// Returns when all tasks that were picked up are finished, with the first error
+  /// returned by a task, if any.
+  Status RunBuildTasks(int num_tasks, const std::function<Status(int, int)>& task_fn);
+
   /// Publish the runtime filters as described in 'filter_ctxs' to the fragment-local
   /// RuntimeFilterBank in 'runtime_state'. 'minmax_filter_threshold' specifies the
-  /// threshold to determine the usefulness of a min/max filter. 'num_build_rows' is used
-  /// to determine whether the computed filters have an unacceptably high false-positive
-  /// rate.
+  /// threshold to determine the usefulness of a min/max filter. 'num_build_rows' bounds
+  /// the number of distinct build values, which is used to shrink bloom filters to the
+  /// size that they need: locally for broadcast joins, or by the coordinator after
+  /// aggregating the filters of a partitioned join.
   void PublishRuntimeFilters(const std::vector<FilterContext>& filter_ctxs,
       RuntimeState* runtime_state, float minmax_filter_threshold, int64_t num_build_rows);
+
+ private:
+  /// Returns true if there is a task of RunBuildTasks() left to be picked up.
+  /// 'separate_build_lock_' must be held.
+  bool HasBuildTask() const {
+    return build_task_fn_ != nullptr && next_build_task_ < num_build_tasks_
+        && build_tasks_status_.ok();
+  }
+
+  /// Runs tasks of RunBuildTasks() on the thread with index 'worker' until none are
+  /// left. 'lock' must hold 'separate_build_lock_', which is released while a task runs.
+  void RunBuildTasksLoop(int worker, std::unique_lock<std::mutex>* lock);
+
+  /// Returns an upper bound on the number of distinct values of the build expr of
+  /// 'ctx', which is one of 'filter_ctxs', including NULL. The bound is derived from
+  /// 'num_build_rows' and from the contents of the in-list and integer min-max filters
+  /// in 'filter_ctxs' that have the same build expr.
+  static int64_t BuildNdvUpperBound(const std::vector<FilterContext>& filter_ctxs,
+      const FilterContext& ctx, int64_t num_build_rows);
+
+  /// The planner can only estimate the NDV and the range of the build values, so it may
+  /// generate an in-list, a bitmap and a bloom filter for the same join predicate. Once
+  /// the build is complete, picks the filter that fits the observed values best among
+  /// the filters in 'filter_ctxs' with the same build expr and target exprs. An in-list
+  /// or bitmap filter that is not always true holds exactly the build values. Of two
+  /// such exact filters, the one that is published with fewer bytes is kept: usually
+  /// the in-list filter for a few scattered values, the bitmap filter for values in a
+  /// dense range. On a tie the bitmap filter is kept, since it is cheaper to probe. The
+  /// other one is set to always true. Bloom filters that an exact filter makes redundant
+  /// are found by IsRedundantBloomFilter(). Min-max filters are always kept, since they
+  /// also prune row groups and pages. Only done for broadcast joins, whose local filters
+  /// hold every build value.
+  static void SelectExactFilters(const std::vector<FilterContext>& filter_ctxs);
+
+  /// Returns true if the bloom filter of 'ctx' is redundant: 'ctx' belongs to a broadcast
+  /// join and another filter in 'filter_ctxs' is an in-list or bitmap filter on the same
+  /// build expr that holds every build value and is applied to the same target exprs.
+  static bool IsRedundantBloomFilter(
+      const std::vector<FilterContext>& filter_ctxs, const FilterContext& ctx);
+
+  /// Shrinks the bloom filter of 'ctx' to the smallest size that achieves the target
+  /// false positive rate of the query for 'ndv' distinct values, but not below the
+  /// minimum filter size. The planner sized the filter from an NDV estimate, which is
+  /// often far too high for selective builds. Smaller filters are cheaper to send and
+  /// probe. Only used for broadcast joins, whose filter holds every build value; the
+  /// coordinator shrinks the aggregated filters of partitioned joins. Sets 'bytes_saved'
+  /// to the number of bytes that the filter shrank by. The memory needed to shrink the
+  /// filter is charged to the builder's MemTracker; the filter is left as it is if that
+  /// fails. If an error is returned, the filter must not be published.
+  Status ShrinkBloomFilter(RuntimeState* runtime_state, const FilterContext& ctx,
+      int64_t ndv, int64_t* bytes_saved) WARN_UNUSED_RESULT;
 };
 }
@@ -41,11 +41,13 @@
 #include "runtime/collection-value-builder.h"
 #include "runtime/exec-env.h"
 #include "runtime/io/disk-io-mgr.h"
+#include "runtime/io/file-metadata-cache.h"
 #include "runtime/io/request-context.h"
 #include "runtime/runtime-filter.inline.h"
 #include "runtime/runtime-state.h"
 #include "runtime/scoped-buffer.h"
 #include "service/hs2-util.h"
+#include "util/bitmap-filter.h"
 #include "util/dict-encoding.h"
 #include "util/parquet-bloom-filter.h"
 #include "util/pretty-printer.h"
@@ -95,8 +97,10 @@ HdfsParquetScanner::HdfsParquetScanner(HdfsScanNodeBase* scan_node, RuntimeState
     num_bloom_filtered_row_groups_counter_(nullptr),
     num_rowgroups_skipped_by_unuseful_filters_counter_(nullptr),
     num_row_groups_counter_(nullptr),
+    num_split_row_groups_counter_(nullptr),
     num_minmax_filtered_pages_counter_(nullptr),
     num_dict_filtered_row_groups_counter_(nullptr),
+    num_dict_filtered_rows_counter_(nullptr),
     parquet_compressed_page_size_counter_(nullptr),
     parquet_uncompressed_page_size_counter_(nullptr),
     coll_items_read_counter_(0),
@@ -126,6 +130,8 @@ Status HdfsParquetScanner::Open(ScannerContext* context) {
   num_row_groups_with_page_index_counter_ =
       ADD_COUNTER(scan_node_->runtime_profile(), "NumRowGroupsWithPageIndex",
           TUnit::UNIT);
+  num_split_row_groups_counter_ =
+      ADD_COUNTER(scan_node_->runtime_profile(), "NumSplitRowGroups", TUnit::UNIT);
   num_stats_filtered_pages_counter_ =
       ADD_COUNTER(scan_node_->runtime_profile(), "NumStatsFilteredPages", TUnit::UNIT);
   num_minmax_filtered_pages_counter_ =
@@ -137,6 +143,8 @@ Status HdfsParquetScanner::Open(ScannerContext* context) {
           TUnit::UNIT);
   num_dict_filtered_row_groups_counter_ =
       ADD_COUNTER(scan_node_->runtime_profile(), "NumDictFilteredRowGroups", TUnit::UNIT);
+  num_dict_filtered_rows_counter_ =
+      ADD_COUNTER(scan_node_->runtime_profile(), "NumDictFilteredRows", TUnit::UNIT);
   parquet_compressed_page_size_counter_ = ADD_SUMMARY_STATS_COUNTER(
       scan_node_->runtime_profile(), "ParquetCompressedPageSize", TUnit::BYTES);
   parquet_uncompressed_page_size_counter_ = ADD_SUMMARY_STATS_COUNTER(
@@ -212,7 +220,7 @@ Status HdfsParquetScanner::Open(ScannerContext* context) {
   schema_resolver_.reset(new ParquetSchemaResolver(*scan_node_->hdfs_table(),
       state_->query_options().parquet_fallback_schema_resolution,
       state_->query_options().parquet_array_resolution));
-  RETURN_IF_ERROR(schema_resolver_->Init(&file_metadata_, filename()));
+  RETURN_IF_ERROR(schema_resolver_->Init(file_metadata_.get(), filename()));
 
   // We've processed the metadata and there are columns that need to be materialized.
   RETURN_IF_ERROR(CreateColumnReaders(
@@ -347,6 +355,13 @@ static int64_t GetColumnStartOffset(const parquet::ColumnMetaData& column) {
   return column.data_page_offset;
 }
 
+// Get the file offset of the end of the row group.
+static int64_t GetRowGroupEndOffset(const parquet::RowGroup& row_group) {
+  const parquet::ColumnMetaData& last_column =
+      row_group.columns[row_group.columns.size() - 1].meta_data;
+  return GetColumnStartOffset(last_column) + last_column.total_compressed_size;
+}
+
 // Get the file offset of the middle of the row group.
 static int64_t GetRowGroupMidOffset(const parquet::RowGroup& row_group) {
   int64_t start_offset = GetColumnStartOffset(row_group.columns[0].meta_data);
@@ -459,8 +474,8 @@ Status HdfsParquetScanner::GetNextInternal(RowBatch* row_batch) {
       if (!status.ok()) RETURN_IF_ERROR(state_->LogOrReturnError(status.msg()));
     }
     RETURN_IF_ERROR(NextRowGroup());
-    DCHECK_LE(group_idx_, file_metadata_.row_groups.size());
-    if (group_idx_ == file_metadata_.row_groups.size()) {
+    DCHECK_LE(group_idx_, file_metadata_->row_groups.size());
+    if (group_idx_ == file_metadata_->row_groups.size()) {
       eos_ = true;
       DCHECK(parse_status_.ok());
       return Status::OK();
@@ -677,6 +692,14 @@ Status HdfsParquetScanner::EvaluateOverlapForRowGroup(
     // We skip row group filtering if the column is not present in the data files.
     if (!filter->IsColumnInDataFile(GetScanNodeId())) continue;
 
+    BitmapFilter* bitmap_filter = GetBitmapFilter(filter);
+    if (bitmap_filter != nullptr) {
+      RETURN_IF_ERROR(EvaluateBitmapFilterForRowGroup(
+          file_metadata, row_group, idx, slot_idx, bitmap_filter, skip_row_group));
+      if (*skip_row_group) break;
+      continue;
+    }
+
     MinMaxFilter* minmax_filter = GetMinMaxFilter(filter);
 
     VLOG(3) << "Try to filter out a rowgroup via overlap predicate filter: "
@@ -797,6 +820,72 @@ Status HdfsParquetScanner::EvaluateOverlapForRowGroup(
   return Status::OK();
 }
 
+Status HdfsParquetScanner::EvaluateBitmapFilterForRowGroup(
+    const parquet::FileMetaData& file_metadata, const parquet::RowGroup& row_group,
+    int idx, int slot_idx, const BitmapFilter* bitmap_filter, bool* skip_row_group) {
+  DCHECK(bitmap_filter != nullptr);
+  *skip_row_group = false;
+  if (bitmap_filter->AlwaysTrue() || !filter_stats_[idx].enabled_for_rowgroup) {
+    filter_stats_[idx].enabled_for_rowgroup = false;
+    filter_stats_[idx].enabled_for_page = false;
+    filter_ctxs_[idx]->stats->IncrCounters(FilterStats::ROW_GROUPS_KEY, 1, 1, 0);
+    return Status::OK();
+  }
+
+  SlotDescriptor* slot_desc = scan_node_->stats_tuple_desc()->slots()[slot_idx];
+  bool missing_field = false;
+  SchemaNode* node = nullptr;
+  RETURN_IF_ERROR(ResolveSchemaForStatFiltering(slot_desc, &missing_field, &node));
+  if (missing_field) return Status::OK();
+
+  ColumnStatsReader stats_reader =
+      CreateStatsReader(file_metadata, row_group, node, slot_desc->type());
+  bool all_nulls = false;
+  if (stats_reader.AllNulls(&all_nulls) && all_nulls) {
+    *skip_row_group = !bitmap_filter->ContainsNull();
+  } else {
+    void* min_slot = nullptr;
+    void* max_slot = nullptr;
+    GetMinMaxSlotsForOverlapPred(slot_idx, &min_slot, &max_slot);
+    if (!stats_reader.ReadMinMaxFromThrift(min_slot, max_slot)) return Status::OK();
+    const ColumnType& col_type = slot_desc->type();
+    *skip_row_group = !bitmap_filter->AnyInRange(
+        BitmapFilter::GetValue(min_slot, col_type),
+        BitmapFilter::GetValue(max_slot, col_type));
+  }
+  if (state_->query_options().minmax_filtering_level
+      == TMinmaxFilteringLevel::ROW_GROUP) {
+    filter_stats_[idx].enabled_for_page = false;
+  }
+  VLOG(3) << "Evaluated bitmap filter on rowgroup: fid="
+          << filter_ctxs_[idx]->filter->id() << ", skip=" << *skip_row_group
+          << ", content=" << bitmap_filter->DebugString();
+  filter_ctxs_[idx]->stats->IncrCounters(
+      FilterStats::ROW_GROUPS_KEY, 1, 1, *skip_row_group ? 1 : 0);
+  return Status::OK();
+}
+
+bool HdfsParquetScanner::ShouldSplitRowGroup(const parquet::RowGroup& row_group,
+    int64_t split_offset, int64_t split_length) {
+  const TQueryOptions& query_options = state_->query_options();
+  if (!query_options.parquet_split_row_groups) return false;
+  if (!query_options.parquet_read_page_index) return false;
+  // Only the instances of HdfsScanNodeMt take the splits from a queue that they share,
+  // so that the splits of a row group are likely to be scanned in parallel.
+  if (scan_node_->HasRowBatchQueue()) return false;
+  int64_t row_group_start = GetColumnStartOffset(row_group.columns[0].meta_data);
+  int64_t row_group_end = GetRowGroupEndOffset(row_group);
+  if (split_offset <= row_group_start && split_offset + split_length >= row_group_end) {
+    return false;
+  }
+  for (const parquet::ColumnChunk& col_chunk : row_group.columns) {
+    if (!col_chunk.__isset.offset_index_offset || col_chunk.offset_index_length <= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool HdfsParquetScanner::ShouldProcessPageIndex() {
   if (!state_->query_options().parquet_read_page_index) return false;
   if (!stats_conjunct_evals_.empty()) return true;
@@ -834,7 +923,7 @@ Status HdfsParquetScanner::NextRowGroup() {
     DCHECK_EQ(0, context_->NumStreams());
 
     ++group_idx_;
-    if (group_idx_ >= file_metadata_.row_groups.size()) {
+    if (group_idx_ >= file_metadata_->row_groups.size()) {
       if (start_with_first_row_group && misaligned_row_group_skipped) {
         // We started with the first row group and skipped all the row groups because
         // they were misaligned. The execution flow won't reach this point if there is at
@@ -843,20 +932,33 @@ Status HdfsParquetScanner::NextRowGroup() {
       }
       break;
     }
-    const parquet::RowGroup& row_group = file_metadata_.row_groups[group_idx_];
-    // Also check 'file_metadata_.num_rows' to make sure 'select count(*)' and 'select *'
-    // behave consistently for corrupt files that have 'file_metadata_.num_rows == 0'
+    const parquet::RowGroup& row_group = file_metadata_->row_groups[group_idx_];
+    // Also check 'file_metadata_->num_rows' to make sure 'select count(*)' and 'select *'
+    // behave consistently for corrupt files that have 'file_metadata_->num_rows == 0'
     // but some data in row groups.
-    if (row_group.num_rows == 0 || file_metadata_.num_rows == 0) continue;
+    if (row_group.num_rows == 0 || file_metadata_->num_rows == 0) continue;
 
     RETURN_IF_ERROR(ParquetMetadataUtils::ValidateColumnOffsets(
         file_desc->filename, file_desc->file_length, row_group));
 
     // A row group is processed by the scanner whose split overlaps with the row
-    // group's mid point.
+    // group's mid point, unless its rows are divided among the scanners of all the
+    // splits that it overlaps.
     int64_t row_group_mid_pos = GetRowGroupMidOffset(row_group);
-    if (!(row_group_mid_pos >= split_offset &&
-        row_group_mid_pos < split_offset + split_length)) {
+    bool split_contains_mid_pos = row_group_mid_pos >= split_offset &&
+        row_group_mid_pos < split_offset + split_length;
+    split_row_group_ = ShouldSplitRowGroup(row_group, split_offset, split_length);
+    if (split_row_group_) {
+      if (!ComputeSplitRowRange(row_group.num_rows,
+          GetColumnStartOffset(row_group.columns[0].meta_data),
+          GetRowGroupEndOffset(row_group), split_offset, split_offset + split_length,
+          &split_row_range_)) {
+        // None of the rows belong to this split.
+        misaligned_row_group_skipped |=
+            CheckRowGroupOverlapsSplit(row_group, split_range);
+        continue;
+      }
+    } else if (!split_contains_mid_pos) {
       // The mid-point does not fall within the split, this row group will be handled by a
       // different scanner.
       // If the row group overlaps with the split, we found a misaligned row group.
@@ -873,7 +975,7 @@ Status HdfsParquetScanner::NextRowGroup() {
     // Evaluate row group statistics with stats conjuncts.
     bool skip_row_group_on_stats;
     RETURN_IF_ERROR(
-        EvaluateStatsConjuncts(file_metadata_, row_group, &skip_row_group_on_stats));
+        EvaluateStatsConjuncts(*file_metadata_, row_group, &skip_row_group_on_stats));
     if (skip_row_group_on_stats) {
       COUNTER_ADD(num_stats_filtered_row_groups_counter_, 1);
       continue;
@@ -882,16 +984,29 @@ Status HdfsParquetScanner::NextRowGroup() {
     // Evaluate row group statistics with min/max filters.
     bool skip_row_group_on_minmax;
     RETURN_IF_ERROR(
-      EvaluateOverlapForRowGroup(file_metadata_, row_group, &skip_row_group_on_minmax));
+      EvaluateOverlapForRowGroup(*file_metadata_, row_group, &skip_row_group_on_minmax));
     if (skip_row_group_on_minmax) {
       COUNTER_ADD(num_minmax_filtered_row_groups_counter_, 1);
       continue;
     }
 
-    // Evaluate page index with min-max conjuncts and/or min/max overlap predicates.
-    if (ShouldProcessPageIndex()) {
+    // Evaluate page index with min-max conjuncts and/or min/max overlap predicates, and
+    // restrict the rows to scan to 'split_row_range_'.
+    if (split_row_group_ || ShouldProcessPageIndex()) {
       Status page_index_status = ProcessPageIndex();
-      if (!page_index_status.ok()) {
+      if (split_row_group_) {
+        // The scanners of the other splits of the row group read their shares of its
+        // rows regardless of this scanner, so the rows of this split would be lost or
+        // read twice if it did not restrict itself to them.
+        if (page_index_status.ok() && !filter_pages_) {
+          page_index_status = Status(Substitute("Could not use the page index of row "
+              "group $0 in file '$1' to divide its rows among the splits of the file. "
+              "Set PARQUET_SPLIT_ROW_GROUPS=false to scan the file.",
+              group_idx_, filename()));
+        }
+        RETURN_IF_ERROR(page_index_status);
+        COUNTER_ADD(num_split_row_groups_counter_, 1);
+      } else if (!page_index_status.ok()) {
         RETURN_IF_ERROR(state_->LogOrReturnError(page_index_status.msg()));
       }
       if (filter_pages_ && candidate_ranges_.empty()) {
@@ -904,6 +1019,9 @@ Status HdfsParquetScanner::NextRowGroup() {
         COUNTER_ADD(num_stats_filtered_row_groups_counter_, 1);
         continue;
       }
+    } else if (filter_pages_) {
+      // Clear the page filtering of a previous row group that was split.
+      ResetPageFiltering();
     }
 
     if (state_->query_options().parquet_bloom_filtering) {
@@ -997,8 +1115,8 @@ bool HdfsParquetScanner::ReadStatFromIndex(const ColumnStatsReader& stats_reader
 }
 
 Status HdfsParquetScanner::AddToSkipRanges(void* min_slot, void* max_slot,
-    parquet::RowGroup& row_group, int page_idx, const ColumnType& col_type, int col_idx,
-    const parquet::ColumnChunk& col_chunk, vector<RowRange>* skip_ranges,
+    const parquet::RowGroup& row_group, int page_idx, const ColumnType& col_type,
+    int col_idx, const parquet::ColumnChunk& col_chunk, vector<RowRange>* skip_ranges,
     int* filtered_pages) {
   VLOG(3) << "Page " << page_idx << " was filtered out."
           << "data min=" << RawValue::PrintValue(min_slot, col_type, col_type.scale)
@@ -1116,11 +1234,13 @@ Status HdfsParquetScanner::ConvertStatsIntoInternalValuesBatch(
   return Status::OK();
 }
 
-Status HdfsParquetScanner::SkipPagesBatch(parquet::RowGroup& row_group,
+Status HdfsParquetScanner::SkipPagesBatch(const parquet::RowGroup& row_group,
     const ColumnStatsReader& stats_reader, const parquet::ColumnIndex& column_index,
     int start_page_idx, int end_page_idx, const ColumnType& col_type, int col_idx,
     const parquet::ColumnChunk& col_chunk, const MinMaxFilter* minmax_filter,
-    vector<RowRange>* skip_ranges, int* filtered_pages) {
+    const BitmapFilter* bitmap_filter, vector<RowRange>* skip_ranges,
+    int* filtered_pages) {
+  DCHECK_NE(minmax_filter == nullptr, bitmap_filter == nullptr);
   BaseScalarColumnReader* scalar_reader = scalar_reader_map_[col_idx];
   parquet::OffsetIndex& offset_index = scalar_reader->offset_index_;
   if (UNLIKELY(offset_index.page_locations.empty())) {
@@ -1144,7 +1264,7 @@ Status HdfsParquetScanner::SkipPagesBatch(parquet::RowGroup& row_group,
       state_->query_options().minmax_filter_fast_code_path;
   // A vector of booleans used only for verification.
   std::vector<bool> pageIndicesFromFastSearch(end_page_idx + 1, false);
-  if (fast_code_path_mode != TMinmaxFilterFastCodePathMode::OFF
+  if (fast_code_path_mode != TMinmaxFilterFastCodePathMode::OFF && minmax_filter
       && column_index.boundary_order == parquet::BoundaryOrder::ASCENDING
       && col_type.type == minmax_filter->type() && GetCompareLessFunc(col_type)) {
     validate_fast_code_path =
@@ -1225,7 +1345,11 @@ Status HdfsParquetScanner::SkipPagesBatch(parquet::RowGroup& row_group,
     VLOG(3) << "stats for page[" << i << "]: "
             << "min=" << RawValue::PrintValue(min_slot, col_type, col_type.scale)
             << ", max=" << RawValue::PrintValue(max_slot, col_type, col_type.scale);
-    if (!minmax_filter->EvalOverlap(col_type, min_slot, max_slot)) {
+    bool overlap = minmax_filter != nullptr ?
+        minmax_filter->EvalOverlap(col_type, min_slot, max_slot) :
+        bitmap_filter->AnyInRange(BitmapFilter::GetValue(min_slot, col_type),
+            BitmapFilter::GetValue(max_slot, col_type));
+    if (!overlap) {
       RETURN_IF_ERROR(AddToSkipRanges(min_slot, max_slot, row_group, i, col_type,
           col_idx, col_chunk, skip_ranges, filtered_pages));
 
@@ -1306,6 +1430,13 @@ MinMaxFilter* HdfsParquetScanner::GetMinMaxFilter(const RuntimeFilter* filter) {
   return nullptr;
 }
 
+BitmapFilter* HdfsParquetScanner::GetBitmapFilter(const RuntimeFilter* filter) {
+  if (filter && filter->is_bitmap_filter()) {
+    return filter->get_bitmap_filter();
+  }
+  return nullptr;
+}
+
 bool HdfsParquetScanner::IsBoundByPartitionColumn(int filter_idx) {
   DCHECK_LE(0, filter_idx);
   DCHECK_LT(filter_idx,filter_ctxs_.size());
@@ -1394,7 +1525,7 @@ Status HdfsParquetScanner::FindSkipRangesForPagesWithMinMaxFilters(
   }
 
   min_max_tuple_->Init(min_max_tuple_desc->byte_size());
-  parquet::RowGroup& row_group = file_metadata_.row_groups[group_idx_];
+  const parquet::RowGroup& row_group = file_metadata_->row_groups[group_idx_];
 
   int filtered_pages = 0;
 
@@ -1405,7 +1536,13 @@ Status HdfsParquetScanner::FindSkipRangesForPagesWithMinMaxFilters(
     int filter_idx = FindFilterIndex(filter_id);
     const RuntimeFilter* filter = GetFilter(filter_idx);
     MinMaxFilter* minmax_filter = GetMinMaxFilter(filter);
-    if (!minmax_filter || !IsFilterWorthyForOverlapCheck(filter_idx)) {
+    BitmapFilter* bitmap_filter = GetBitmapFilter(filter);
+    if ((!minmax_filter && !bitmap_filter)
+        || !IsFilterWorthyForOverlapCheck(filter_idx)) {
+      continue;
+    }
+    // Null pages are skipped below, which is only correct if the filter rejects NULLs.
+    if (bitmap_filter && (bitmap_filter->AlwaysTrue() || bitmap_filter->ContainsNull())) {
       continue;
     }
 
@@ -1433,7 +1570,7 @@ Status HdfsParquetScanner::FindSkipRangesForPagesWithMinMaxFilters(
     }
 
     ColumnStatsReader stats_reader =
-        CreateStatsReader(file_metadata_, row_group, node, slot_desc->type());
+        CreateStatsReader(*file_metadata_, row_group, node, slot_desc->type());
 
     DCHECK_LT(col_idx, row_group.columns.size());
     const parquet::ColumnChunk& col_chunk = row_group.columns[col_idx];
@@ -1452,7 +1589,8 @@ Status HdfsParquetScanner::FindSkipRangesForPagesWithMinMaxFilters(
 
     VLOG(3) << "Try to filter out pages via overlap predicate."
             << "  fid=" << filter_id << ", columnType=" << col_type.DebugString()
-            << ", filter=" << minmax_filter->DebugString()
+            << ", filter=" << (minmax_filter != nullptr ?
+                   minmax_filter->DebugString() : bitmap_filter->DebugString())
             << ", #pages=" << num_of_pages;
     int first_not_null_page_idx = -1;
 
@@ -1469,7 +1607,7 @@ Status HdfsParquetScanner::FindSkipRangesForPagesWithMinMaxFilters(
         if (LIKELY(first_not_null_page_idx != -1)) {
           RETURN_IF_ERROR(SkipPagesBatch(row_group, stats_reader, column_index,
               first_not_null_page_idx, page_idx - 1, col_type, col_idx, col_chunk,
-              minmax_filter, skip_ranges, &filtered_pages));
+              minmax_filter, bitmap_filter, skip_ranges, &filtered_pages));
         }
 
         first_not_null_page_idx = -1;
@@ -1486,7 +1624,7 @@ Status HdfsParquetScanner::FindSkipRangesForPagesWithMinMaxFilters(
     if (LIKELY(first_not_null_page_idx != -1)) {
       RETURN_IF_ERROR(SkipPagesBatch(row_group, stats_reader, column_index,
           first_not_null_page_idx, num_of_pages - 1, col_type, col_idx, col_chunk,
-          minmax_filter, skip_ranges, &filtered_pages));
+          minmax_filter, bitmap_filter, skip_ranges, &filtered_pages));
     }
   }
 
@@ -1497,7 +1635,7 @@ Status HdfsParquetScanner::FindSkipRangesForPagesWithMinMaxFilters(
 }
 
 Status HdfsParquetScanner::EvaluatePageIndex() {
-  parquet::RowGroup& row_group = file_metadata_.row_groups[group_idx_];
+  const parquet::RowGroup& row_group = file_metadata_->row_groups[group_idx_];
   vector<RowRange> skip_ranges;
 
   for (int i = 0; i < stats_conjunct_evals_.size(); ++i) {
@@ -1516,7 +1654,7 @@ Status HdfsParquetScanner::EvaluatePageIndex() {
     }
     int col_idx = node->col_idx;;
     ColumnStatsReader stats_reader =
-        CreateStatsReader(file_metadata_, row_group, node, slot_desc->type());
+        CreateStatsReader(*file_metadata_, row_group, node, slot_desc->type());
 
     DCHECK_LT(col_idx, row_group.columns.size());
     const parquet::ColumnChunk& col_chunk = row_group.columns[col_idx];
@@ -1559,7 +1697,17 @@ Status HdfsParquetScanner::EvaluatePageIndex() {
     RETURN_IF_ERROR(FindSkipRangesForPagesWithMinMaxFilters(&skip_ranges));
   }
 
-  if (skip_ranges.empty()) return Status::OK();
+  if (split_row_group_) {
+    // Skip the rows that belong to the splits of other scanners.
+    if (split_row_range_.first > 0) {
+      skip_ranges.push_back({0, split_row_range_.first - 1});
+    }
+    if (split_row_range_.last < row_group.num_rows - 1) {
+      skip_ranges.push_back({split_row_range_.last + 1, row_group.num_rows - 1});
+    }
+  } else if (skip_ranges.empty()) {
+    return Status::OK();
+  }
 
   for (BaseScalarColumnReader* scalar_reader : scalar_readers_) {
     const parquet::ColumnChunk& col_chunk = row_group.columns[scalar_reader->col_idx()];
@@ -1587,7 +1735,7 @@ Status HdfsParquetScanner::EvaluatePageIndex() {
 Status HdfsParquetScanner::ComputeCandidatePagesForColumns() {
   if (candidate_ranges_.empty()) return Status::OK();
 
-  parquet::RowGroup& row_group = file_metadata_.row_groups[group_idx_];
+  const parquet::RowGroup& row_group = file_metadata_->row_groups[group_idx_];
   for (BaseScalarColumnReader* scalar_reader : scalar_readers_) {
     const auto& page_locations = scalar_reader->offset_index_.page_locations;
     if (!ComputeCandidatePages(page_locations, candidate_ranges_, row_group.num_rows,
@@ -1601,6 +1749,14 @@ Status HdfsParquetScanner::ComputeCandidatePagesForColumns() {
   for (BaseScalarColumnReader* scalar_reader : scalar_readers_) {
     const auto& page_locations = scalar_reader->offset_index_.page_locations;
     int total_page_count = page_locations.size();
+    if (split_row_group_) {
+      // Don't count the pages of the rows that belong to the splits of other scanners.
+      vector<int> split_pages;
+      bool success = ComputeCandidatePages(
+          page_locations, {split_row_range_}, row_group.num_rows, &split_pages);
+      DCHECK(success);
+      total_page_count = split_pages.size();
+    }
     int candidate_pages_count = scalar_reader->candidate_data_pages_.size();
     COUNTER_ADD(num_stats_filtered_pages_counter_,
         total_page_count - candidate_pages_count);
@@ -1762,6 +1918,7 @@ bool HdfsParquetScanner::IsDictionaryEncoded(
 Status HdfsParquetScanner::EvalDictionaryFilters(const parquet::RowGroup& row_group,
     bool* row_group_eliminated) {
   *row_group_eliminated = false;
+  dict_row_filters_.clear();
   // Check if there's anything to do here.
   if (dict_filterable_readers_.empty()) return Status::OK();
 
@@ -1831,6 +1988,15 @@ Status HdfsParquetScanner::EvalDictionaryFilters(const parquet::RowGroup& row_gr
 
     DCHECK(dict_filter_tuple != nullptr);
     void* slot = dict_filter_tuple->GetSlot(slot_desc->tuple_offset());
+    TupleRow row;
+    row.SetTuple(0, dict_filter_tuple);
+    // If a dictionary row filter is built, the conjuncts are evaluated on all entries
+    // and the results are recorded, instead of stopping at the first match.
+    bool build_row_filter = dict_filter_conjunct_evals != nullptr
+        && CanBuildDictRowFilter(scalar_reader, dictionary->num_entries(),
+            row_group.num_rows);
+    vector<const char*> entry_ptrs;
+    vector<bool> entry_passed;
     bool column_has_match = false;
     bool should_eval_runtime_filter = dictionary->num_entries() <=
         state_->query_options().parquet_dictionary_runtime_filter_entry_limit;
@@ -1845,13 +2011,16 @@ Status HdfsParquetScanner::EvalDictionaryFilters(const parquet::RowGroup& row_gr
 
       // If any dictionary value passes the conjuncts and runtime filters, then move on to
       // the next column.
-      TupleRow row;
-      row.SetTuple(0, dict_filter_tuple);
-      if (dict_filter_conjunct_evals != nullptr
-          && !ExecNode::EvalConjuncts(dict_filter_conjunct_evals->data(),
-              dict_filter_conjunct_evals->size(), &row)) {
-        continue; // Failed the conjunct check, move on to the next entry.
+      bool passed_conjuncts = dict_filter_conjunct_evals == nullptr
+          || ExecNode::EvalConjuncts(dict_filter_conjunct_evals->data(),
+              dict_filter_conjunct_evals->size(), &row);
+      if (build_row_filter) {
+        entry_ptrs.push_back(static_cast<StringValue*>(slot)->ptr);
+        entry_passed.push_back(passed_conjuncts);
       }
+      // Move on to the next entry if this one failed the conjunct check or if a match
+      // was already found and the entries are only visited for the row filter.
+      if (!passed_conjuncts || column_has_match) continue;
       column_has_match = true; // match caused by conjunct evaluation
       if (runtime_filters != nullptr && should_eval_runtime_filter) {
         for (int rf_idx = 0; rf_idx < runtime_filters->size(); rf_idx++) {
@@ -1861,12 +2030,16 @@ Status HdfsParquetScanner::EvalDictionaryFilters(const parquet::RowGroup& row_gr
             break;
           }
         }
-        if (column_has_match) {
-          break; // Passed the conjunct and there were no runtime filter miss.
-        }
-      } else {
-        break; // Passed the conjunct and runtime filter does not exist.
       }
+      // Passed the conjunct and there were no runtime filter miss.
+      if (column_has_match && !build_row_filter) break;
+    }
+    bool null_passed = false;
+    if (build_row_filter && column_has_match) {
+      dict_filter_tuple->SetNull(slot_desc->null_indicator_offset());
+      null_passed = ExecNode::EvalConjuncts(dict_filter_conjunct_evals->data(),
+          dict_filter_conjunct_evals->size(), &row);
+      dict_filter_tuple->SetNotNull(slot_desc->null_indicator_offset());
     }
     // Free all expr result allocations now that we're done with the filter.
     context_->expr_results_pool()->Clear();
@@ -1885,8 +2058,12 @@ Status HdfsParquetScanner::EvalDictionaryFilters(const parquet::RowGroup& row_gr
     if (!column_has_match) {
       *row_group_eliminated = true;
       COUNTER_ADD(num_dict_filtered_row_groups_counter_, 1);
+      dict_row_filters_.clear();
       return Status::OK();
     }
+    if (build_row_filter) {
+      AddDictRowFilter(slot_desc, entry_ptrs, entry_passed, null_passed);
+    }
   }
 
   // Any columns that were not 100% dictionary encoded need to initialize
@@ -1896,6 +2073,92 @@ Status HdfsParquetScanner::EvalDictionaryFilters(const parquet::RowGroup& row_gr
   return Status::OK();
 }
 
+bool HdfsParquetScanner::CanBuildDictRowFilter(
+    BaseScalarColumnReader* scalar_reader, int num_dict_entries, int64_t num_rows) {
+  if (!state_->query_options().parquet_dictionary_row_filtering) return false;
+  // Only the values of string columns point into the dictionary.
+  if (!scalar_reader->slot_desc()->type().IsVarLenStringType()) return false;
+  // The filters are evaluated on the top-level tuples of the scratch batch.
+  if (scalar_reader->max_rep_level() > 0
+      || std::find(column_readers_.begin(), column_readers_.end(), scalar_reader)
+          == column_readers_.end()) {
+    return false;
+  }
+  // Evaluating the conjuncts on every dictionary entry is only worth it if there are
+  // fewer entries than rows.
+  return num_dict_entries < num_rows;
+}
+
+void HdfsParquetScanner::AddDictRowFilter(const SlotDescriptor* slot_desc,
+    const vector<const char*>& entry_ptrs, const vector<bool>& entry_passed,
+    bool null_passed) {
+  DCHECK_EQ(entry_ptrs.size(), entry_passed.size());
+  if (entry_ptrs.empty()) return;
+  // A filter that rejects nothing would only cost time in EvalDictRowFilters().
+  if (null_passed
+      && std::find(entry_passed.begin(), entry_passed.end(), false)
+          == entry_passed.end()) {
+    return;
+  }
+  uintptr_t min_ptr = reinterpret_cast<uintptr_t>(entry_ptrs[0]);
+  uintptr_t max_ptr = min_ptr;
+  for (const char* ptr : entry_ptrs) {
+    min_ptr = min(min_ptr, reinterpret_cast<uintptr_t>(ptr));
+    max_ptr = max(max_ptr, reinterpret_cast<uintptr_t>(ptr));
+  }
+  if (max_ptr - min_ptr >= DICT_ROW_FILTER_MAX_DICT_BYTES) return;
+
+  DictRowFilter filter;
+  filter.tuple_offset = slot_desc->tuple_offset();
+  filter.null_indicator_offset = slot_desc->null_indicator_offset();
+  filter.dict_data = min_ptr;
+  filter.rejected.resize(max_ptr - min_ptr + 1, 0);
+  filter.null_rejected = !null_passed;
+  // Each entry of a PLAIN encoded dictionary page has its own data, so different
+  // entries never share an offset. The passing entries are applied last regardless, so
+  // that a value is only dropped if it certainly fails the conjuncts.
+  for (int i = 0; i < entry_ptrs.size(); ++i) {
+    if (!entry_passed[i]) {
+      filter.rejected[reinterpret_cast<uintptr_t>(entry_ptrs[i]) - min_ptr] = 1;
+    }
+  }
+  for (int i = 0; i < entry_ptrs.size(); ++i) {
+    if (entry_passed[i]) {
+      filter.rejected[reinterpret_cast<uintptr_t>(entry_ptrs[i]) - min_ptr] = 0;
+    }
+  }
+  dict_row_filters_.push_back(move(filter));
+}
+
+void HdfsParquetScanner::EvalDictRowFilters() {
+  DCHECK(!dict_row_filters_.empty());
+  const int num_tuples = scratch_batch_->num_tuples;
+  bool* passed = scratch_batch_->passed_dict_filters.get();
+  memset(passed, 1, num_tuples * sizeof(bool));
+  for (const DictRowFilter& filter : dict_row_filters_) {
+    const uint8_t* rejected = filter.rejected.data();
+    const uintptr_t num_offsets = filter.rejected.size();
+    for (int i = 0; i < num_tuples; ++i) {
+      const Tuple* tuple = scratch_batch_->GetTuple(i);
+      bool is_rejected;
+      if (tuple->IsNull(filter.null_indicator_offset)) {
+        is_rejected = filter.null_rejected;
+      } else {
+        // Values that don't point into the dictionary wrap around to large offsets.
+        uintptr_t offset =
+            reinterpret_cast<uintptr_t>(tuple->GetStringSlot(filter.tuple_offset)->ptr)
+            - filter.dict_data;
+        is_rejected = offset < num_offsets && rejected[offset];
+      }
+      passed[i] &= !is_rejected;
+    }
+  }
+  int num_passed = 0;
+  for (int i = 0; i < num_tuples; ++i) num_passed += passed[i];
+  COUNTER_ADD(num_dict_filtered_rows_counter_, num_tuples - num_passed);
+  scratch_batch_->has_dict_filter_results = true;
+}
+
 Status HdfsParquetScanner::ReadToBuffer(uint64_t offset, uint8_t* buffer, uint64_t size) {
   DCHECK(context_ != nullptr);
   DCHECK(metadata_range_ != nullptr);
@@ -2187,6 +2450,7 @@ Status HdfsParquetScanner::AssembleRowsWithoutLateMaterialization(
       }
       last_num_tuples = scratch_batch_->num_tuples;
     }
+    if (!dict_row_filters_.empty()) EvalDictRowFilters();
     RETURN_IF_ERROR(CheckPageFiltering());
     num_rows_read += scratch_batch_->num_tuples;
     int num_row_to_commit = TransferScratchTuples(row_batch);
@@ -2259,6 +2523,9 @@ Status HdfsParquetScanner::AssembleRows(RowBatch* row_batch, bool* skip_row_grou
         &scratch_batch_->num_tuples));
     if (*skip_row_group) { return Status::OK(); }
     num_rows_read += scratch_batch_->num_tuples;
+    // Drop the rows whose dictionary codes fail the conjuncts before the remaining
+    // conjuncts are evaluated and before the non-filter columns are read.
+    if (!dict_row_filters_.empty()) EvalDictRowFilters();
     bool row_group_end = filter_readers_[0]->RowGroupAtEnd();
     int num_row_to_commit = FilterScratchBatch(row_batch);
     if (num_row_to_commit == 0) {
@@ -2643,6 +2910,69 @@ Status HdfsParquetScanner::ProcessFooter() {
   }
   uint8_t* metadata_ptr = metadata_size_ptr - metadata_size;
 
+  // Other scanners may have deserialized the footer of this file before, e.g. for other
+  // splits or queries. The footer bytes are still read above to validate the magic
+  // number and the metadata size, but its deserialization is skipped.
+  FileMetadataCache* metadata_cache =
+      ExecEnv::GetInstance()->disk_io_mgr()->file_metadata_cache();
+  string cache_key;
+  shared_ptr<const parquet::FileMetaData> cached_metadata;
+  if (metadata_cache != nullptr) {
+    cache_key = FileMetadataCache::MakeKey(FileMetadataCache::Kind::PARQUET_FOOTER,
+        filename(), stream_->file_desc()->mtime, file_len);
+    cached_metadata = metadata_cache->Lookup<parquet::FileMetaData>(cache_key);
+  }
+  if (cached_metadata != nullptr) {
+    file_metadata_ = move(cached_metadata);
+  } else {
+    RETURN_IF_ERROR(ReadFileMetadata(metadata_ptr, metadata_size, metadata_start,
+        remaining_bytes_buffered));
+    if (metadata_cache != nullptr) {
+      metadata_cache->Insert(cache_key, file_metadata_,
+          EstimateFileMetadataBytes(*file_metadata_, metadata_size));
+    }
+  }
+
+  RETURN_IF_ERROR(ParquetMetadataUtils::ValidateFileVersion(*file_metadata_, filename()));
+
+  // IMPALA-3943: Do not throw an error for empty files for backwards compatibility.
+  if (file_metadata_->num_rows == 0) {
+    // Warn if the num_rows is inconsistent with the row group metadata.
+    if (!file_metadata_->row_groups.empty()) {
+      bool has_non_empty_row_group = false;
+      for (const parquet::RowGroup& row_group : file_metadata_->row_groups) {
+        if (row_group.num_rows > 0) {
+          has_non_empty_row_group = true;
+          break;
+        }
+      }
+      // Warn if there is at least one non-empty row group.
+      if (has_non_empty_row_group) {
+        ErrorMsg msg(TErrorCode::PARQUET_ZERO_ROWS_IN_NON_EMPTY_FILE, filename());
+        state_->LogError(msg);
+      }
+    }
+    return Status::OK();
+  }
+
+  // Parse out the created by application version string
+  if (file_metadata_->__isset.created_by) {
+    file_version_ = ParquetFileVersion(file_metadata_->created_by);
+  }
+  if (file_metadata_->row_groups.empty()) {
+    return Status(
+        Substitute("Invalid file. This file: $0 has no row groups", filename()));
+  }
+  if (file_metadata_->num_rows < 0) {
+    return Status(Substitute("Corrupt Parquet file '$0': negative row count $1 in "
+        "file metadata", filename(), file_metadata_->num_rows));
+  }
+  return Status::OK();
+}
+
+Status HdfsParquetScanner::ReadFileMetadata(uint8_t* metadata_ptr,
+    uint32_t metadata_size, int64_t metadata_start, int remaining_bytes_buffered) {
+  const int64_t file_len = stream_->file_desc()->file_length;
   // If the metadata was too big, we need to read it into a contiguous buffer before
   // deserializing it.
   ScopedBuffer metadata_buffer(scan_node_->mem_tracker());
@@ -2669,49 +2999,30 @@ Status HdfsParquetScanner::ProcessFooter() {
 
   // Deserialize file footer
   // TODO: this takes ~7ms for a 1000-column table, figure out how to reduce this.
+  shared_ptr<parquet::FileMetaData> file_metadata = make_shared<parquet::FileMetaData>();
   Status status =
-      DeserializeThriftMsg(metadata_ptr, &metadata_size, true, &file_metadata_);
+      DeserializeThriftMsg(metadata_ptr, &metadata_size, true, file_metadata.get());
   if (!status.ok()) {
     return Status(Substitute("File '$0' of length $1 bytes has invalid file metadata "
         "at file offset $2, Error = $3.", filename(), file_len, metadata_start,
         status.GetDetail()));
   }
+  file_metadata_ = move(file_metadata);
 
-  RETURN_IF_ERROR(ParquetMetadataUtils::ValidateFileVersion(file_metadata_, filename()));
-
-  // IMPALA-3943: Do not throw an error for empty files for backwards compatibility.
-  if (file_metadata_.num_rows == 0) {
-    // Warn if the num_rows is inconsistent with the row group metadata.
-    if (!file_metadata_.row_groups.empty()) {
-      bool has_non_empty_row_group = false;
-      for (const parquet::RowGroup& row_group : file_metadata_.row_groups) {
-        if (row_group.num_rows > 0) {
-          has_non_empty_row_group = true;
-          break;
-        }
-      }
-      // Warn if there is at least one non-empty row group.
-      if (has_non_empty_row_group) {
-        ErrorMsg msg(TErrorCode::PARQUET_ZERO_ROWS_IN_NON_EMPTY_FILE, filename());
-        state_->LogError(msg);
-      }
-    }
-    return Status::OK();
-  }
+  return Status::OK();
+}
 
-  // Parse out the created by application version string
-  if (file_metadata_.__isset.created_by) {
-    file_version_ = ParquetFileVersion(file_metadata_.created_by);
-  }
-  if (file_metadata_.row_groups.empty()) {
-    return Status(
-        Substitute("Invalid file. This file: $0 has no row groups", filename()));
+int64_t HdfsParquetScanner::EstimateFileMetadataBytes(
+    const parquet::FileMetaData& file_metadata, int64_t metadata_size) {
+  // The strings and statistics take about as much memory as they take in the
+  // serialized footer, the rest is dominated by the structs of the schema and the
+  // column chunks.
+  int64_t result = sizeof(file_metadata) + metadata_size
+      + file_metadata.schema.size() * sizeof(parquet::SchemaElement);
+  for (const parquet::RowGroup& row_group : file_metadata.row_groups) {
+    result += sizeof(row_group) + row_group.columns.size() * sizeof(parquet::ColumnChunk);
   }
-  if (file_metadata_.num_rows < 0) {
-    return Status(Substitute("Corrupt Parquet file '$0': negative row count $1 in "
-        "file metadata", filename(), file_metadata_.num_rows));
-  }
-  return Status::OK();
+  return result;
 }
 
 Status HdfsParquetScanner::CreateColumnReaders(const TupleDescriptor& tuple_desc,
@@ -2870,7 +3181,7 @@ Status HdfsParquetScanner::InitScalarColumns() {
   int64_t partition_id = context_->partition_descriptor()->id();
   const HdfsFileDesc* file_desc = scan_node_->GetFileDesc(partition_id, filename());
   DCHECK(file_desc != nullptr);
-  parquet::RowGroup& row_group = file_metadata_.row_groups[group_idx_];
+  const parquet::RowGroup& row_group = file_metadata_->row_groups[group_idx_];
 
   // Used to validate that the number of values in each reader in column_readers_ at the
   // same SchemaElement is the same.
@@ -2927,7 +3238,7 @@ Status HdfsParquetScanner::ValidateEndOfRowGroup(
       // These column readers materialize table-level values (vs. collection values).
       // Test if the expected number of rows from the file metadata matches the actual
       // number of rows read from the file.
-      int64_t expected_rows_in_group = file_metadata_.row_groups[row_group_idx].num_rows;
+      int64_t expected_rows_in_group = file_metadata_->row_groups[row_group_idx].num_rows;
       if (rows_read != expected_rows_in_group) {
         return Status(TErrorCode::PARQUET_GROUP_ROW_COUNT_ERROR, filename(),
             row_group_idx, expected_rows_in_group, rows_read);
@@ -30,6 +30,7 @@
 
 namespace impala {
 
+class BitmapFilter;
 class CollectionValueBuilder;
 struct HdfsFileDesc;
 class Literal;
@@ -392,7 +393,7 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
 
  protected:
   virtual int64_t GetNumberOfRowsInFile() const override {
-    return file_metadata_.num_rows;
+    return file_metadata_->num_rows;
   }
 
  private:
@@ -434,8 +435,9 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
   /// Column readers among 'column_readers_' not used for filtering
   std::vector<ParquetColumnReader*> non_filter_readers_;
 
-  /// File metadata thrift object
-  parquet::FileMetaData file_metadata_;
+  /// File metadata thrift object. It is shared with the FileMetadataCache and other
+  /// scanners of the same file if the cache is enabled, so it must not be modified.
+  std::shared_ptr<const parquet::FileMetaData> file_metadata_;
 
   /// Version of the application that wrote this file.
   ParquetFileVersion file_version_;
@@ -456,6 +458,15 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
   /// evaluating the page index.
   std::vector<RowRange> candidate_ranges_;
 
+  /// True if the rows of the current row group are divided among the scanners of the
+  /// splits that it overlaps, see ShouldSplitRowGroup(). This scanner then only reads
+  /// the rows in 'split_row_range_', which are applied as page index filtering.
+  bool split_row_group_ = false;
+
+  /// The rows of the current row group that belong to the split of this scanner. Only
+  /// valid if 'split_row_group_' is true.
+  RowRange split_row_range_;
+
   /// Column readers that are eligible for dictionary filtering.
   /// These are pointers to elements of column_readers_. Materialized columns that are
   /// dictionary encoded correspond to scalar columns that are either top-level columns
@@ -488,6 +499,34 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
   /// perm_pool_.
   std::unordered_map<const TupleDescriptor*, Tuple*> dict_filter_tuple_map_;
 
+  /// Filter that drops the rows of the current row group whose value of a top-level
+  /// string column fails the column's dictionary filter conjuncts, without evaluating
+  /// the conjuncts on each row. Built by EvalDictionaryFilters() from the results of the
+  /// conjuncts on each dictionary entry. The StringValues decoded from a dictionary
+  /// point to the data of their entry in the dictionary page, so the entry of a value,
+  /// i.e. its dictionary code, is identified by the offset of its data in the page.
+  struct DictRowFilter {
+    /// Offset of the column's slot in the scan tuple.
+    int tuple_offset;
+    NullIndicatorOffset null_indicator_offset;
+    /// The lowest address of the data of a dictionary entry.
+    uintptr_t dict_data;
+    /// Indexed by the offset of the data of a value from 'dict_data'. Non-zero if the
+    /// dictionary entry with the data at that offset fails the conjuncts. Values that
+    /// were not decoded from the dictionary, e.g. from PLAIN pages, don't point to an
+    /// entry and are left to the row conjuncts.
+    std::vector<uint8_t> rejected;
+    /// True if NULL fails the conjuncts.
+    bool null_rejected;
+  };
+
+  /// The dictionary row filters of the current row group. Only built if the
+  /// PARQUET_DICTIONARY_ROW_FILTERING query option is set.
+  std::vector<DictRowFilter> dict_row_filters_;
+
+  /// Upper bound of the size of the dictionary data that a DictRowFilter is built for.
+  static const int64_t DICT_ROW_FILTER_MAX_DICT_BYTES = 8L * 1024L * 1024L;
+
   /// Average and min/max time spent processing the page index for each row group.
   RuntimeProfile::SummaryStatsCounter* process_page_index_stats_;
 
@@ -511,6 +550,10 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
   /// Number of row groups with page index.
   RuntimeProfile::Counter* num_row_groups_with_page_index_counter_;
 
+  /// Number of row groups of which only the rows that belong to the split of the scanner
+  /// were read, see 'split_row_group_'.
+  RuntimeProfile::Counter* num_split_row_groups_counter_;
+
   /// Number of pages that are skipped because of Parquet page statistics.
   RuntimeProfile::Counter* num_stats_filtered_pages_counter_;
 
@@ -531,6 +574,9 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
   /// and runtime bloom filters on the dictionary entries.
   RuntimeProfile::Counter* num_dict_filtered_row_groups_counter_;
 
+  /// Number of rows that are dropped by dictionary row filters.
+  RuntimeProfile::Counter* num_dict_filtered_rows_counter_;
+
   /// Tracks the size of any compressed pages read. If no compressed pages are read, this
   /// counter is empty
   RuntimeProfile::SummaryStatsCounter* parquet_compressed_page_size_counter_;
@@ -606,6 +652,16 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
   bool FilterAlreadyDisabledOrOverlapWithColumnStats(
       int filter_id, MinMaxFilter* minmax_filter, int idx, float threshold);
 
+  /// Evaluates the bitmap filter 'bitmap_filter' at 'filter_ctxs_[idx]' against the
+  /// min/max stats of the column in 'row_group' behind the overlap predicate slots at
+  /// 'slot_idx'. Sets 'skip_row_group' to true if no value in the filter falls into
+  /// the [min, max] range of the row group. Unlike a min/max filter, the bitmap is
+  /// exact so it can also reject a row group whose range falls into a gap between the
+  /// build side values.
+  Status EvaluateBitmapFilterForRowGroup(const parquet::FileMetaData& file_metadata,
+      const parquet::RowGroup& row_group, int idx, int slot_idx,
+      const BitmapFilter* bitmap_filter, bool* skip_row_group);
+
   /// Detect if a column is a collection or missing for a column chunk described by a
   /// schema path in a slot descriptor 'slot_desc'.
   /// On return:
@@ -632,6 +688,10 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
   /// Return nullptr if no min/max filter is present.
   MinMaxFilter* GetMinMaxFilter(const RuntimeFilter* filter);
 
+  /// Return the bitmap filter of 'filter'.
+  /// Return nullptr if no bitmap filter is present.
+  BitmapFilter* GetBitmapFilter(const RuntimeFilter* filter);
+
   /// Return true when the filter at filter_ctx_[filter_idx] is bound by a
   /// partition column and false otherwise.
   bool IsBoundByPartitionColumn(int filter_idx);
@@ -646,6 +706,22 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
   ///  2. there exist min/max conjuncts or some min/max filters from joins are available.
   bool ShouldProcessPageIndex();
 
+  /// Decide whether the rows of 'row_group' should be divided among the scanners of all
+  /// the splits that it overlaps, instead of being read by the scanner of the split that
+  /// contains its midpoint. Return true when
+  ///  1. Query options parquet_split_row_groups and parquet_read_page_index are set to
+  ///     true, and
+  ///  2. the scan node is a HdfsScanNodeMt, and
+  ///  3. 'row_group' does not lie within the split ['split_offset', 'split_offset' +
+  ///     'split_length'), and
+  ///  4. all the columns of 'row_group' have an offset index, so that the scanners can
+  ///     read just the pages of their rows.
+  /// The decision depends only on the file metadata, so the scanners of all the splits
+  /// make the same one. A scanner of a split row group fails if it cannot use the page
+  /// index, since no other scanner reads its rows.
+  bool ShouldSplitRowGroup(const parquet::RowGroup& row_group, int64_t split_offset,
+      int64_t split_length);
+
   /// Find skip ranges for pages in the current row group that are outside the min/max
   /// ranges defined by overlap predicate min/max filters. These filters are specified
   /// by GetOverlapPredStartIndex().
@@ -656,23 +732,25 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
 
   /// Construct a RowRange with the begin and end row in page 'page_idx' and store the
   /// object into 'skip_ranges'.
-  Status AddToSkipRanges(void* min_slot, void* max_slot, parquet::RowGroup& row_group,
-      int page_idx, const ColumnType& col_type, int col_idx,
-      const parquet::ColumnChunk& col_chunk, vector<RowRange>* skip_ranges,
+  Status AddToSkipRanges(void* min_slot, void* max_slot,
+      const parquet::RowGroup& row_group, int page_idx, const ColumnType& col_type,
+      int col_idx, const parquet::ColumnChunk& col_chunk, vector<RowRange>* skip_ranges,
       int* filtered_pages);
 
   /// Batch read a range ['start_page_idx', 'end_page_idx'] of min/max stats of non-null
   /// pages for column 'col_idx' from 'column_index' and filter out those that are outside
-  /// the min/max range specified in 'minmax_filter'.
+  /// the min/max range specified in 'minmax_filter', or that hold no value of
+  /// 'bitmap_filter'. Exactly one of the two filters is not null.
   ///
   /// On return:
   ///   *skip_ranges is appended with new row ranges in those skipped pages,
   //    *filtered_pages is incremented with the number of skipped pages.
-  Status SkipPagesBatch(parquet::RowGroup& row_group,
+  Status SkipPagesBatch(const parquet::RowGroup& row_group,
       const ColumnStatsReader& stats_reader, const parquet::ColumnIndex& column_index,
       int start_page_idx, int end_page_idx, const ColumnType& col_type, int col_idx,
       const parquet::ColumnChunk& col_chunk, const MinMaxFilter* minmax_filter,
-      vector<RowRange>* skip_ranges, int* filtered_pages);
+      const BitmapFilter* bitmap_filter, vector<RowRange>* skip_ranges,
+      int* filtered_pages);
 
   /// Convert page column stats of column 'column_index' and type 'col_type' into internal
   /// format. The range of the pages to convert is ['start_page_idx', 'end_page_idx'].
@@ -781,9 +859,22 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
       bool materialize_tuple, MemPool* pool, Tuple* tuple) const;
 
   /// Process the file footer and parse file_metadata_.  This should be called with the
-  /// last PARQUET_FOOTER_SIZE bytes in context_.
+  /// last PARQUET_FOOTER_SIZE bytes in context_. The parsed footer is taken from, or
+  /// added to, the process-wide FileMetadataCache if it is enabled.
   Status ProcessFooter() WARN_UNUSED_RESULT;
 
+  /// Helper for ProcessFooter() that deserializes the 'metadata_size' bytes of metadata
+  /// starting at 'metadata_start' in the file into file_metadata_. 'metadata_ptr' points
+  /// to them in the footer buffer, unless they don't fit into the
+  /// 'remaining_bytes_buffered' bytes of it, in which case they are read from the file.
+  Status ReadFileMetadata(uint8_t* metadata_ptr, uint32_t metadata_size,
+      int64_t metadata_start, int remaining_bytes_buffered) WARN_UNUSED_RESULT;
+
+  /// Returns the estimated memory consumption of 'file_metadata', which was deserialized
+  /// from 'metadata_size' bytes. Used as its charge in the FileMetadataCache.
+  static int64_t EstimateFileMetadataBytes(
+      const parquet::FileMetaData& file_metadata, int64_t metadata_size);
+
   /// Populates 'column_readers' for the slots in 'tuple_desc', including creating child
   /// readers for any collections. Schema resolution is handled in this function as
   /// well. Fills in the appropriate template tuple slot with NULL for any materialized
@@ -865,9 +956,30 @@ class HdfsParquetScanner : public HdfsColumnarScanner {
   /// Checks to see if this row group can be eliminated based on applying conjuncts
   /// to the dictionary values. Specifically, if any dictionary-encoded column has
   /// no values that pass the relevant conjuncts, then the row group can be skipped.
+  /// Also builds dict_row_filters_ for the columns that all rows of the row group can
+  /// be filtered on by their dictionary codes.
   Status EvalDictionaryFilters(const parquet::RowGroup& row_group,
       bool* skip_row_group) WARN_UNUSED_RESULT;
 
+  /// Returns true if a DictRowFilter can be built for 'scalar_reader', whose dictionary
+  /// has 'num_dict_entries' entries, for a row group with 'num_rows' rows.
+  bool CanBuildDictRowFilter(
+      BaseScalarColumnReader* scalar_reader, int num_dict_entries, int64_t num_rows);
+
+  /// Adds a DictRowFilter for the column of 'slot_desc' to dict_row_filters_.
+  /// 'entry_ptrs' and 'entry_passed' are the data pointer of each dictionary entry and
+  /// whether the entry passes the conjuncts. Does nothing if the filter would reject
+  /// no value, i.e. all entries and NULL pass, or if the entries' data is too far
+  /// apart.
+  void AddDictRowFilter(const SlotDescriptor* slot_desc,
+      const std::vector<const char*>& entry_ptrs, const std::vector<bool>& entry_passed,
+      bool null_passed);
+
+  /// Evaluates dict_row_filters_ on the tuples of 'scratch_batch_' and stores the
+  /// results in 'scratch_batch_->passed_dict_filters'. Must only be called if
+  /// dict_row_filters_ is not empty, after the filter columns were read.
+  void EvalDictRowFilters();
+
   /// Read 'size' bytes from 'metadata_range_' starting at 'offset' into 'buffer'. The
   /// provided buffer must be preallocated to hold at least 'size' bytes.
   Status ReadToBuffer(uint64_t offset, uint8_t* buffer, uint64_t size) WARN_UNUSED_RESULT;
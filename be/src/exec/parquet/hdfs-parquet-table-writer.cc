@@ -23,6 +23,7 @@
 #include "common/version.h"
 #include "exec/hdfs-table-sink.h"
 #include "exec/parquet/parquet-column-stats.inline.h"
+#include "exec/parquet/parquet-encoding-converter.h"
 #include "exec/parquet/parquet-metadata-utils.h"
 #include "exec/parquet/parquet-bloom-filter-util.h"
 #include "exprs/scalar-expr-evaluator.h"
@@ -44,6 +45,7 @@
 #include "util/dict-encoding.h"
 #include "util/hdfs-util.h"
 #include "util/parquet-bloom-filter.h"
+#include "util/parse-util.h"
 #include "util/pretty-printer.h"
 #include "util/rle-encoding.h"
 #include "util/string-util.h"
@@ -132,6 +134,8 @@ class HdfsParquetTableWriter::BaseColumnWriter {
       dict_encoder_base_(nullptr),
       def_levels_(nullptr),
       values_buffer_len_(DEFAULT_DATA_PAGE_SIZE),
+      encoded_values_buffer_(nullptr),
+      encoded_values_buffer_len_(0),
       page_stats_base_(nullptr),
       row_group_stats_base_(nullptr),
       table_sink_mem_tracker_(parent_->parent_->mem_tracker()),
@@ -327,6 +331,10 @@ class HdfsParquetTableWriter::BaseColumnWriter {
   // Writes out the dictionary encoded data buffered in dict_encoder_.
   void WriteDictDataPage();
 
+  // Re-encodes the PLAIN values buffered in values_buffer_ with 'current_encoding_',
+  // which is one of the encodings supported by ParquetEncodingConverter.
+  void EncodeDataPage();
+
   struct DataPage {
     // Page header.  This is a union of all page types.
     parquet::PageHeader header;
@@ -407,6 +415,12 @@ class HdfsParquetTableWriter::BaseColumnWriter {
   // The size of values_buffer_.
   int values_buffer_len_;
 
+  // Buffer that EncodeDataPage() encodes the values to. It is swapped with
+  // values_buffer_ afterwards, so both buffers are reused across pages.
+  uint8_t* encoded_values_buffer_;
+  // The size of encoded_values_buffer_.
+  int encoded_values_buffer_len_;
+
   // Pointers to statistics, created, owned, and set by the derived class.
   ColumnStatsBase* page_stats_base_;
   ColumnStatsBase* row_group_stats_base_;
@@ -478,11 +492,21 @@ class HdfsParquetTableWriter::ColumnWriter :
     valid_column_index_ = true;
     // Default to dictionary encoding.  If the cardinality ends up being too high,
     // it will fall back to plain.
-    current_encoding_ = DataPageDictionaryEncoding();
-    next_page_encoding_ = DataPageDictionaryEncoding();
-    dict_encoder_.reset(new DictEncoder<T>(parent_->per_file_mem_pool_.get(),
-        plain_encoded_value_size_, parent_->parent_->mem_tracker()));
-    dict_encoder_base_ = dict_encoder_.get();
+    // PARQUET_WRITE_ENCODINGS can choose a different encoding for the type instead.
+    auto it = parent_->write_encodings_.find(ToThrift(type().type));
+    if (it != parent_->write_encodings_.end()
+        && ParquetEncodingConverter::CanEncodeFromPlain(it->second, parquet_type_)) {
+      current_encoding_ = it->second;
+      next_page_encoding_ = it->second;
+      dict_encoder_.reset();
+      dict_encoder_base_ = nullptr;
+    } else {
+      current_encoding_ = DataPageDictionaryEncoding();
+      next_page_encoding_ = DataPageDictionaryEncoding();
+      dict_encoder_.reset(new DictEncoder<T>(parent_->per_file_mem_pool_.get(),
+          plain_encoded_value_size_, parent_->parent_->mem_tracker()));
+      dict_encoder_base_ = dict_encoder_.get();
+    }
     page_stats_.reset(
         new ColumnStats<T>(parent_->per_file_mem_pool_.get(), plain_encoded_value_size_));
     page_stats_base_ = page_stats_.get();
@@ -522,7 +546,9 @@ class HdfsParquetTableWriter::ColumnWriter :
         return false;
       }
       parent_->file_size_estimate_ += *bytes_needed;
-    } else if (current_encoding_ == parquet::Encoding::PLAIN) {
+    } else {
+      // Values of the other encodings are buffered as PLAIN and encoded by
+      // EncodeDataPage() when the page is finalized.
       *bytes_needed = plain_encoded_value_size_ < 0 ?
           ParquetPlainEncoder::ByteSize<T>(*val) :
           plain_encoded_value_size_;
@@ -535,9 +561,6 @@ class HdfsParquetTableWriter::ColumnWriter :
           ParquetPlainEncoder::Encode(*val, plain_encoded_value_size_, dst_ptr);
       DCHECK_EQ(*bytes_needed, written_len);
       current_page_->header.uncompressed_page_size += written_len;
-    } else {
-      // TODO: support other encodings here
-      DCHECK(false);
     }
     // IMPALA-8498: Write column index for floating types when NaN is not present
     if (std::is_same<float, std::remove_cv_t<T>>::value &&
@@ -964,6 +987,27 @@ inline void HdfsParquetTableWriter::BaseColumnWriter::WriteDictDataPage() {
   current_page_->header.uncompressed_page_size = len;
 }
 
+void HdfsParquetTableWriter::BaseColumnWriter::EncodeDataPage() {
+  parquet::Type::type parquet_type = ParquetMetadataUtils::ConvertInternalToParquetType(
+      type().type, parent_->timestamp_type_);
+  int64_t plain_size = current_page_->header.uncompressed_page_size;
+  int64_t max_len = ParquetEncodingConverter::MaxEncodedLen(
+      current_encoding_, parquet_type, plain_size);
+  if (encoded_values_buffer_len_ < max_len) {
+    // Allocate at least 'values_buffer_len_' bytes so that the buffer is large enough
+    // for PLAIN values of a full page once it is swapped with 'values_buffer_'.
+    encoded_values_buffer_len_ = max<int64_t>(max_len, values_buffer_len_);
+    encoded_values_buffer_ =
+        parent_->reusable_col_mem_pool_->Allocate(encoded_values_buffer_len_);
+  }
+  int64_t len = ParquetEncodingConverter::EncodeFromPlain(current_encoding_,
+      parquet_type, values_buffer_, plain_size, encoded_values_buffer_);
+  DCHECK_LE(len, max_len);
+  std::swap(values_buffer_, encoded_values_buffer_);
+  std::swap(values_buffer_len_, encoded_values_buffer_len_);
+  current_page_->header.uncompressed_page_size = len;
+}
+
 Status HdfsParquetTableWriter::BaseColumnWriter::Flush(int64_t* file_pos,
    int64_t* first_data_page, int64_t* first_dictionary_page) {
   if (current_page_ == nullptr) {
@@ -1098,7 +1142,11 @@ Status HdfsParquetTableWriter::BaseColumnWriter::FinalizeCurrentPage() {
   // around a parquet MR bug (see IMPALA-759 for more details).
   if (current_page_->num_non_null == 0) current_encoding_ = parquet::Encoding::PLAIN;
 
-  if (IsDictionaryEncoding(current_encoding_)) WriteDictDataPage();
+  if (IsDictionaryEncoding(current_encoding_)) {
+    WriteDictDataPage();
+  } else if (current_encoding_ != parquet::Encoding::PLAIN) {
+    EncodeDataPage();
+  }
 
   parquet::PageHeader& header = current_page_->header;
   header.data_page_header.encoding = current_encoding_;
@@ -1334,6 +1382,9 @@ Status HdfsParquetTableWriter::Init() {
     page_row_count_limit_ = query_options.parquet_page_row_count_limit;
   }
 
+  RETURN_IF_ERROR(ParseUtil::ParseParquetWriteEncodings(
+      query_options.parquet_write_encodings, &write_encodings_));
+
   int num_cols = table_desc_->num_cols() - table_desc_->num_clustering_cols();
   // When opening files using the hdfsOpenFile() API, the maximum block size is limited to
   // 2GB.
@@ -243,6 +243,10 @@ class HdfsParquetTableWriter : public HdfsTableWriter {
   /// The Timestamp type used to write timestamp values.
   TParquetTimestampType::type timestamp_type_;
 
+  /// Encodings of the data pages of columns by type, from PARQUET_WRITE_ENCODINGS.
+  /// Columns of other types use dictionary encoding, falling back to PLAIN.
+  std::map<TPrimitiveType::type, parquet::Encoding::type> write_encodings_;
+
   /// True if we are writing an Iceberg data file. In that case the writer behaves a
   /// bit differently, e.g. writes specific type of timestamps, fills some extra metadata.
   bool is_iceberg_file_ = false;
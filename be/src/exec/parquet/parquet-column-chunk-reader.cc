@@ -19,10 +19,12 @@
 
 #include <string>
 
+#include "exec/parquet/parquet-encoding-converter.h"
 #include "runtime/mem-pool.h"
 #include "runtime/runtime-state.h"
 #include "runtime/scoped-buffer.h"
 #include "util/codec.h"
+#include "util/debug-util.h"
 
 #include "common/names.h"
 
@@ -299,6 +301,23 @@ Status ParquetColumnChunkReader::ReadDataPageData(uint8_t** data, int* data_size
   return Status::OK();
 }
 
+Status ParquetColumnChunkReader::DecodeDataPageToPlain(
+    parquet::Type::type type, int type_length, uint8_t** data, int* data_size) {
+  uint8_t* plain;
+  int64_t plain_size;
+  Status status = ParquetEncodingConverter::DecodeToPlain(encoding(), type, type_length,
+      *data, *data_size, CurrentPageHeader().data_page_header.num_values,
+      data_page_pool_.get(), &plain, &plain_size);
+  if (!status.ok()) {
+    if (status.IsMemLimitExceeded()) return status;
+    return Status(TErrorCode::PARQUET_CORRUPT_ENCODED_VALUES, filename(),
+        PrintThriftEnum(encoding()), schema_name_, status.GetDetail());
+  }
+  *data = plain;
+  *data_size = plain_size;
+  return Status::OK();
+}
+
 Status ParquetColumnChunkReader::AllocateUncompressedDataPage(int64_t size,
     const char* err_ctx, uint8_t** buffer) {
   *buffer = data_page_pool_->TryAllocate(size);
@@ -139,6 +139,15 @@ class ParquetColumnChunkReader {
   /// function call that advances the buffer.
   Status ReadDataPageData(uint8_t** data, int* data_size);
 
+  /// Decodes the values of the current data page to PLAIN if they use an encoding that
+  /// ParquetEncodingConverter::CanDecodeToPlain() supports for 'type'. '*data' and
+  /// '*data_size' point to the values and are updated to point to the PLAIN values,
+  /// which are allocated from 'data_page_pool_' and so have the same lifetime as the data
+  /// returned by ReadDataPageData(). 'type_length' is the length of
+  /// FIXED_LEN_BYTE_ARRAY values.
+  Status DecodeDataPageToPlain(
+      parquet::Type::type type, int type_length, uint8_t** data, int* data_size);
+
  private:
   HdfsParquetScanner* parent_;
   std::string schema_name_;
@@ -23,6 +23,7 @@
 #include "exec/parquet/hdfs-parquet-scanner.h"
 #include "exec/parquet/parquet-bool-decoder.h"
 #include "exec/parquet/parquet-data-converter.h"
+#include "exec/parquet/parquet-encoding-converter.h"
 #include "exec/parquet/parquet-level-decoder.h"
 #include "exec/parquet/parquet-metadata-utils.h"
 #include "exec/parquet/parquet-struct-column-reader.h"
@@ -344,6 +345,16 @@ Status ScalarColumnReader<InternalType, PARQUET_TYPE, MATERIALIZED>::InitDataPag
   DCHECK(slot_desc_ == nullptr || slot_desc_->type().type != TYPE_BOOLEAN)
       << "Bool has specialized impl";
   page_encoding_ = col_chunk_reader_.encoding();
+  if (ParquetEncodingConverter::CanDecodeToPlain(page_encoding_, PARQUET_TYPE)) {
+    // The values are decoded value by value only from PLAIN or dictionary encoded
+    // pages. Pages with the delta and byte stream split encodings are decoded to PLAIN
+    // up front and then read like PLAIN pages.
+    RETURN_IF_ERROR(col_chunk_reader_.DecodeDataPageToPlain(
+        PARQUET_TYPE, node_.element->type_length, &data, &size));
+    data_ = data;
+    data_end_ = data + size;
+    page_encoding_ = parquet::Encoding::PLAIN;
+  }
   if (!IsDictionaryEncoding(page_encoding_)
       && page_encoding_ != parquet::Encoding::PLAIN) {
     return GetUnsupportedDecodingError();
@@ -1001,7 +1012,7 @@ void BaseScalarColumnReader::CreateSubRanges(vector<ScanRange::SubRange>* sub_ra
 Status BaseScalarColumnReader::Reset(const HdfsFileDesc& file_desc,
     const parquet::ColumnChunk& col_chunk, int row_group_idx) {
   // Ensure metadata is valid before using it to initialize the reader.
-  RETURN_IF_ERROR(ParquetMetadataUtils::ValidateRowGroupColumn(parent_->file_metadata_,
+  RETURN_IF_ERROR(ParquetMetadataUtils::ValidateRowGroupColumn(*parent_->file_metadata_,
       parent_->filename(), row_group_idx, col_idx(), schema_element(),
       parent_->state_));
   num_buffered_values_ = 0;
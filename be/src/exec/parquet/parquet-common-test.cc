@@ -129,4 +129,55 @@ TEST(ParquetCommon, ComputeCandidatePages) {
   ValidatePagesError({0, 5, 10}, {{15, 20}}, 12, {0});
 }
 
+void ValidateSplitRows(int64_t num_rows, int64_t rg_start, int64_t rg_end,
+    int64_t split_start, int64_t split_end, const RangeVec& expected) {
+  RowRange result;
+  bool success = ComputeSplitRowRange(
+      num_rows, rg_start, rg_end, split_start, split_end, &result);
+  EXPECT_EQ(!expected.empty(), success);
+  if (success) EXPECT_EQ(expected, RangeVec({result}));
+}
+
+/// This test exercises the logic of ComputeSplitRowRange(). It checks that the rows of
+/// a row group are divided among the splits that overlap it in proportion to the
+/// overlap, and that the rows of the splits of a file cover each row exactly once.
+TEST(ParquetCommon, ComputeSplitRowRange) {
+  ValidateSplitRows(1000, 100, 1100, 0, 600, {{0, 499}});
+  ValidateSplitRows(1000, 100, 1100, 600, 1200, {{500, 999}});
+  ValidateSplitRows(1000, 100, 1100, 0, 2000, {{0, 999}});
+  ValidateSplitRows(1000, 100, 1100, 0, 100, {});
+  ValidateSplitRows(1000, 100, 1100, 1100, 1500, {});
+  ValidateSplitRows(7, 0, 10, 0, 3, {{0, 2}});
+  ValidateSplitRows(7, 0, 10, 3, 6, {{3, 4}});
+  ValidateSplitRows(7, 0, 10, 6, 10, {{5, 6}});
+  // A split that overlaps only a small part of the row group might not get any rows.
+  ValidateSplitRows(10, 0, 1000, 0, 995, {{0, 9}});
+  ValidateSplitRows(10, 0, 1000, 995, 2000, {});
+  // The product of the offsets and the number of rows doesn't fit into 64 bits.
+  ValidateSplitRows(1LL << 33, 0, 1LL << 40, 0, 1LL << 39, {{0, (1LL << 32) - 1}});
+  ValidateSplitRows(1LL << 33, 0, 1LL << 40, 1LL << 39, 1LL << 40,
+      {{1LL << 32, (1LL << 33) - 1}});
+
+  // Split a file into splits of different lengths and check that the rows of every row
+  // group are scanned exactly once.
+  const vector<int64_t> row_group_offsets = {4, 1000, 1001, 5000, 12345};
+  const vector<int64_t> row_group_rows = {3, 1, 10000, 77};
+  for (int64_t split_len : {1, 7, 100, 999, 4096, 20000}) {
+    for (int rg = 0; rg < row_group_rows.size(); ++rg) {
+      int64_t next_row = 0;
+      for (int64_t split_start = 0; split_start < row_group_offsets.back();
+           split_start += split_len) {
+        RowRange rows;
+        if (!ComputeSplitRowRange(row_group_rows[rg], row_group_offsets[rg],
+            row_group_offsets[rg + 1], split_start, split_start + split_len, &rows)) {
+          continue;
+        }
+        EXPECT_EQ(next_row, rows.first);
+        next_row = rows.last + 1;
+      }
+      EXPECT_EQ(row_group_rows[rg], next_row);
+    }
+  }
+}
+
 }
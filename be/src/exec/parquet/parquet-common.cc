@@ -201,6 +201,28 @@ bool ComputeCandidatePages(
   return true;
 }
 
+/// Returns the first row of the row group that belongs to the file offset 'offset' or
+/// after it, see ComputeSplitRowRange().
+static int64_t FirstRowAtOffset(int64_t num_rows, int64_t row_group_start,
+    int64_t row_group_end, int64_t offset) {
+  int64_t row_group_len = row_group_end - row_group_start;
+  offset = std::min(std::max(offset, row_group_start), row_group_end);
+  // The product of the offset and the number of rows might not fit into 64 bits.
+  __int128 scaled = static_cast<__int128>(offset - row_group_start) * num_rows;
+  return static_cast<int64_t>((scaled + row_group_len - 1) / row_group_len);
+}
+
+bool ComputeSplitRowRange(int64_t num_rows, int64_t row_group_start,
+    int64_t row_group_end, int64_t split_start, int64_t split_end, RowRange* split_rows) {
+  DCHECK_GT(num_rows, 0);
+  DCHECK_LT(row_group_start, row_group_end);
+  split_rows->first =
+      FirstRowAtOffset(num_rows, row_group_start, row_group_end, split_start);
+  split_rows->last =
+      FirstRowAtOffset(num_rows, row_group_start, row_group_end, split_end) - 1;
+  return split_rows->first <= split_rows->last;
+}
+
 bool ParquetTimestampDecoder::GetTimestampInfoFromSchema(const parquet::SchemaElement& e,
     Precision& precision, bool& needs_conversion) {
   if (e.type == parquet::Type::INT96) {
@@ -134,6 +134,16 @@ bool ComputeCandidatePages(
     const std::vector<RowRange>& candidate_ranges,
     const int64_t num_rows, std::vector<int>* candidate_pages);
 
+/// Divides the 'num_rows' rows of a row group that occupies the file range
+/// ['row_group_start', 'row_group_end') among the splits of the file that overlap it.
+/// Row 'r' belongs to the split that contains the file offset
+/// 'row_group_start + r * (row_group_end - row_group_start) / num_rows', so the splits
+/// get a number of rows proportional to their overlap with the row group and the rows
+/// of adjacent splits don't overlap or leave gaps. Sets 'split_rows' to the rows of the
+/// split ['split_start', 'split_end'). Returns false if no row belongs to the split.
+bool ComputeSplitRowRange(int64_t num_rows, int64_t row_group_start,
+    int64_t row_group_end, int64_t split_start, int64_t split_end, RowRange* split_rows);
+
 /// The plain encoding does not maintain any state so all these functions
 /// are static helpers.
 /// TODO: we are using templates to provide a generic interface (over the
@@ -0,0 +1,216 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "exec/parquet/parquet-encoding-converter.h"
+#include "gutil/strings/substitute.h"
+#include "runtime/mem-pool.h"
+#include "runtime/mem-tracker.h"
+#include "testutil/gtest-util.h"
+
+#include "common/names.h"
+
+using parquet::Encoding;
+using parquet::Type;
+
+namespace impala {
+
+class ParquetEncodingConverterTest : public testing::Test {
+ protected:
+  ParquetEncodingConverterTest() : pool_(&tracker_) {}
+
+  virtual void TearDown() override { pool_.FreeAll(); }
+
+  /// Decodes 'encoded' to PLAIN and returns the status. On success the PLAIN values are
+  /// stored in 'decoded_'.
+  Status Decode(Encoding::type encoding, Type::type type, const vector<uint8_t>& encoded,
+      int64_t size, int64_t max_values, int type_length = -1) {
+    uint8_t* plain;
+    int64_t plain_size;
+    RETURN_IF_ERROR(ParquetEncodingConverter::DecodeToPlain(encoding, type, type_length,
+        encoded.data(), size, max_values, &pool_, &plain, &plain_size));
+    decoded_.assign(plain, plain + plain_size);
+    return Status::OK();
+  }
+
+  /// Decodes truncated and randomly corrupted copies of 'encoded'. The results are not
+  /// checked, the decoder must just not crash or read out of bounds.
+  void DecodeCorrupted(Encoding::type encoding, Type::type type,
+      const vector<uint8_t>& encoded, int64_t max_values) {
+    int64_t len = encoded.size();
+    for (int64_t l = 0; l < len; l += std::max<int64_t>(1, len / 50)) {
+      Status status = Decode(encoding, type, encoded, l, max_values);
+    }
+    std::mt19937 rng(len);
+    for (int i = 0; i < 200 && len > 0; ++i) {
+      vector<uint8_t> corrupted = encoded;
+      corrupted[rng() % len] ^= 1 << (rng() % 8);
+      Status status = Decode(encoding, type, corrupted, len, max_values);
+    }
+  }
+
+  /// Encodes the PLAIN values in 'plain' with 'encoding' and checks that decoding them
+  /// returns the same values.
+  void TestRoundTrip(Encoding::type encoding, Type::type type,
+      const vector<uint8_t>& plain, int64_t num_values) {
+    ASSERT_TRUE(ParquetEncodingConverter::CanEncodeFromPlain(encoding, type));
+    ASSERT_TRUE(ParquetEncodingConverter::CanDecodeToPlain(encoding, type));
+    vector<uint8_t> encoded(
+        ParquetEncodingConverter::MaxEncodedLen(encoding, type, plain.size()));
+    int64_t len = ParquetEncodingConverter::EncodeFromPlain(
+        encoding, type, plain.data(), plain.size(), encoded.data());
+    ASSERT_LE(len, encoded.size());
+    encoded.resize(len);
+    ASSERT_OK(Decode(encoding, type, encoded, len, num_values));
+    EXPECT_EQ(plain, decoded_);
+    // A page with fewer values than encoded is corrupt.
+    if (num_values > 0) EXPECT_FALSE(Decode(encoding, type, encoded, len, 0).ok());
+    DecodeCorrupted(encoding, type, encoded, num_values);
+  }
+
+  template <typename T>
+  static vector<uint8_t> ToPlain(const vector<T>& values) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(values.data());
+    return vector<uint8_t>(data, data + values.size() * sizeof(T));
+  }
+
+  static vector<uint8_t> ToPlain(const vector<string>& values) {
+    vector<uint8_t> result;
+    for (const string& value : values) {
+      uint32_t len = value.size();
+      const uint8_t* len_ptr = reinterpret_cast<const uint8_t*>(&len);
+      result.insert(result.end(), len_ptr, len_ptr + sizeof(len));
+      result.insert(result.end(), value.begin(), value.end());
+    }
+    return result;
+  }
+
+  MemTracker tracker_;
+  MemPool pool_;
+  vector<uint8_t> decoded_;
+};
+
+/// The value counts cover empty pages, partial and full miniblocks and blocks.
+static const int NUM_VALUES[] = {0, 1, 2, 31, 32, 33, 127, 128, 129, 1000, 4097};
+
+TEST_F(ParquetEncodingConverterTest, DeltaBinaryPacked) {
+  std::mt19937_64 rng(1);
+  for (int n : NUM_VALUES) {
+    vector<int32_t> ints(n);
+    vector<int64_t> bigints(n);
+    // Random values.
+    for (int i = 0; i < n; ++i) {
+      ints[i] = rng();
+      bigints[i] = rng();
+    }
+    TestRoundTrip(Encoding::DELTA_BINARY_PACKED, Type::INT32, ToPlain(ints), n);
+    TestRoundTrip(Encoding::DELTA_BINARY_PACKED, Type::INT64, ToPlain(bigints), n);
+    // Nearly sorted values, which is what the encoding is meant for.
+    for (int i = 0; i < n; ++i) {
+      ints[i] = 1000 + i * 3 + rng() % 2;
+      bigints[i] = -5000000000L + i * 1000000L + rng() % 100;
+    }
+    TestRoundTrip(Encoding::DELTA_BINARY_PACKED, Type::INT32, ToPlain(ints), n);
+    TestRoundTrip(Encoding::DELTA_BINARY_PACKED, Type::INT64, ToPlain(bigints), n);
+    // Deltas that overflow.
+    for (int i = 0; i < n; ++i) {
+      ints[i] = i % 2 ? std::numeric_limits<int32_t>::min() :
+                        std::numeric_limits<int32_t>::max();
+      bigints[i] = i % 2 ? std::numeric_limits<int64_t>::min() :
+                           std::numeric_limits<int64_t>::max();
+    }
+    TestRoundTrip(Encoding::DELTA_BINARY_PACKED, Type::INT32, ToPlain(ints), n);
+    TestRoundTrip(Encoding::DELTA_BINARY_PACKED, Type::INT64, ToPlain(bigints), n);
+  }
+}
+
+TEST_F(ParquetEncodingConverterTest, DeltaBinaryPackedSpecExamples) {
+  // The examples of the Parquet spec, with blocks of 128 values and 4 miniblocks.
+  // 1 2 3 4 5: all deltas are 1, so the miniblocks have a bit width of 0.
+  vector<uint8_t> example1 = {0x80, 0x01, 0x04, 0x05, 0x02, 0x02, 0, 0, 0, 0};
+  ASSERT_OK(Decode(Encoding::DELTA_BINARY_PACKED, Type::INT32, example1,
+      example1.size(), 5));
+  EXPECT_EQ(ToPlain(vector<int32_t>({1, 2, 3, 4, 5})), decoded_);
+
+  // 7 5 3 1 2 3 4 5: the min delta is -2 and the relative deltas are 0 0 0 3 3 3 3.
+  vector<uint8_t> example2 = {0x80, 0x01, 0x04, 0x08, 0x0e, 0x03, 0x02, 0, 0, 0,
+      0xc0, 0x3f, 0, 0, 0, 0, 0, 0};
+  vector<uint8_t> expected = ToPlain(vector<int32_t>({7, 5, 3, 1, 2, 3, 4, 5}));
+  ASSERT_OK(Decode(Encoding::DELTA_BINARY_PACKED, Type::INT32, example2,
+      example2.size(), 8));
+  EXPECT_EQ(expected, decoded_);
+  // Some writers leave out the padding of the last miniblock.
+  ASSERT_OK(Decode(Encoding::DELTA_BINARY_PACKED, Type::INT32, example2, 12, 8));
+  EXPECT_EQ(expected, decoded_);
+  // Values that are missing are an error though.
+  EXPECT_FALSE(Decode(Encoding::DELTA_BINARY_PACKED, Type::INT32, example2, 11, 8).ok());
+}
+
+TEST_F(ParquetEncodingConverterTest, DeltaByteArrays) {
+  for (int n : NUM_VALUES) {
+    vector<string> values(n);
+    for (int i = 0; i < n; ++i) {
+      values[i] = i % 13 == 0 ? "" : Substitute("customer#$0", 1000000000 + i * 7);
+    }
+    vector<uint8_t> plain = ToPlain(values);
+    TestRoundTrip(Encoding::DELTA_LENGTH_BYTE_ARRAY, Type::BYTE_ARRAY, plain, n);
+    TestRoundTrip(Encoding::DELTA_BYTE_ARRAY, Type::BYTE_ARRAY, plain, n);
+  }
+}
+
+TEST_F(ParquetEncodingConverterTest, DeltaByteArrayFixedLen) {
+  // The writer only produces BYTE_ARRAY values, but the PLAIN encoding of
+  // FIXED_LEN_BYTE_ARRAY values is just the values without lengths.
+  vector<uint8_t> plain = ToPlain(vector<string>({"abcd", "abce", "xbce", "xbcf"}));
+  vector<uint8_t> encoded(ParquetEncodingConverter::MaxEncodedLen(
+      Encoding::DELTA_BYTE_ARRAY, Type::BYTE_ARRAY, plain.size()));
+  int64_t len = ParquetEncodingConverter::EncodeFromPlain(Encoding::DELTA_BYTE_ARRAY,
+      Type::BYTE_ARRAY, plain.data(), plain.size(), encoded.data());
+  encoded.resize(len);
+  ASSERT_OK(Decode(Encoding::DELTA_BYTE_ARRAY, Type::FIXED_LEN_BYTE_ARRAY, encoded, len,
+      4, 4));
+  EXPECT_EQ(string("abcdabcexbcexbcf"), string(decoded_.begin(), decoded_.end()));
+  // Values that do not have the length of the type are an error.
+  EXPECT_FALSE(Decode(Encoding::DELTA_BYTE_ARRAY, Type::FIXED_LEN_BYTE_ARRAY, encoded,
+      len, 4, 5).ok());
+}
+
+TEST_F(ParquetEncodingConverterTest, ByteStreamSplit) {
+  std::mt19937_64 rng(2);
+  for (int n : NUM_VALUES) {
+    vector<float> floats(n);
+    vector<double> doubles(n);
+    for (int i = 0; i < n; ++i) {
+      floats[i] = static_cast<float>(rng()) / 7;
+      doubles[i] = static_cast<double>(rng()) / 11;
+    }
+    TestRoundTrip(Encoding::BYTE_STREAM_SPLIT, Type::FLOAT, ToPlain(floats), n);
+    TestRoundTrip(Encoding::BYTE_STREAM_SPLIT, Type::DOUBLE, ToPlain(doubles), n);
+  }
+  // The bytes of each value are stored in separate streams.
+  vector<uint8_t> encoded = {0x01, 0x11, 0x02, 0x12, 0x03, 0x13, 0x04, 0x14};
+  ASSERT_OK(Decode(Encoding::BYTE_STREAM_SPLIT, Type::INT32, encoded, encoded.size(), 2));
+  EXPECT_EQ(vector<uint8_t>({0x01, 0x02, 0x03, 0x04, 0x11, 0x12, 0x13, 0x14}), decoded_);
+  // The size must be a multiple of the value size.
+  EXPECT_FALSE(Decode(Encoding::BYTE_STREAM_SPLIT, Type::INT32, encoded, 7, 2).ok());
+}
+
+}
@@ -0,0 +1,534 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/parquet/parquet-encoding-converter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "gutil/strings/substitute.h"
+#include "runtime/mem-pool.h"
+#include "runtime/mem-tracker.h"
+#include "util/bit-stream-utils.inline.h"
+#include "util/bit-util.h"
+
+#include "common/names.h"
+
+using strings::Substitute;
+
+namespace impala {
+
+template <typename T>
+bool DeltaBinaryPackedDecoder<T>::Init(const uint8_t* data, int64_t size) {
+  reader_.Reset(data, size);
+  data_end_ = data + size;
+  uint32_t block_size;
+  uint32_t num_miniblocks;
+  uint32_t num_values;
+  int64_t first_value;
+  if (!reader_.GetUleb128(&block_size) || !reader_.GetUleb128(&num_miniblocks)
+      || !reader_.GetUleb128(&num_values) || !reader_.GetZigZagInteger(&first_value)) {
+    return false;
+  }
+  // The spec requires the block size to be a multiple of 128 and the number of values
+  // in a miniblock to be a multiple of 32.
+  if (block_size == 0 || block_size % 128 != 0 || num_miniblocks == 0
+      || block_size % num_miniblocks != 0 || block_size / num_miniblocks % 32 != 0) {
+    return false;
+  }
+  num_values_ = num_values;
+  num_miniblocks_ = num_miniblocks;
+  values_per_miniblock_ = block_size / num_miniblocks;
+  first_value_ = static_cast<T>(first_value);
+  return true;
+}
+
+template <typename T>
+bool DeltaBinaryPackedDecoder<T>::Decode(T* out) {
+  if (num_values_ == 0) return true;
+  T value = first_value_;
+  out[0] = value;
+  int64_t i = 1;
+  while (i < num_values_) {
+    int64_t min_delta;
+    if (!reader_.GetZigZagInteger(&min_delta)) return false;
+    // The bit widths of all miniblocks precede the data of the first one.
+    BatchedBitReader bit_widths = reader_;
+    if (!reader_.SkipBatch(8, num_miniblocks_)) return false;
+    for (int m = 0; m < num_miniblocks_ && i < num_values_; ++m) {
+      uint8_t bit_width;
+      bool ret = bit_widths.GetBytes(1, &bit_width);
+      DCHECK(ret);
+      if (bit_width > sizeof(T) * 8) return false;
+      int n = std::min<int64_t>(values_per_miniblock_, num_values_ - i);
+      if (reader_.UnpackBatch(bit_width, n, out + i) != n) return false;
+      // The last miniblock is padded to its full size. Some writers leave out the
+      // padding at the end of the data, which is accepted.
+      int64_t padding = values_per_miniblock_ * bit_width / 8
+          - BitUtil::Ceil(static_cast<int64_t>(n) * bit_width, 8);
+      if (padding > reader_.bytes_left()) {
+        if (i + n < num_values_) return false;
+        padding = reader_.bytes_left();
+      }
+      if (padding > 0 && !reader_.SkipBatch(8, padding)) return false;
+      for (int j = 0; j < n; ++j) {
+        value += static_cast<T>(min_delta) + out[i + j];
+        out[i + j] = value;
+      }
+      i += n;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+int64_t DeltaBinaryPackedEncoder<T>::MaxEncodedLen(int64_t num_values) {
+  // The header has four integers. Each block has the min delta, a byte per miniblock
+  // and at most sizeof(T) bytes per value.
+  const int max_vlq_len = BatchedBitReader::max_vlq_byte_len<uint64_t>();
+  int64_t num_blocks = BitUtil::Ceil(std::max<int64_t>(num_values - 1, 0), BLOCK_SIZE);
+  return 4 * max_vlq_len
+      + num_blocks * (max_vlq_len + MINIBLOCKS_PER_BLOCK + BLOCK_SIZE * sizeof(T));
+}
+
+template <typename T>
+int64_t DeltaBinaryPackedEncoder<T>::Encode(
+    const T* values, int64_t num_values, uint8_t* out) {
+  using SignedT = std::make_signed_t<T>;
+  BitWriter writer(out, MaxEncodedLen(num_values));
+  bool ret = writer.PutUleb128<uint32_t>(BLOCK_SIZE);
+  ret &= writer.PutUleb128<uint32_t>(MINIBLOCKS_PER_BLOCK);
+  ret &= writer.PutUleb128<uint32_t>(num_values);
+  // Values are sign extended, so INT32 and INT64 values are written the same way.
+  ret &= writer.PutZigZagInteger<int64_t>(
+      num_values == 0 ? 0 : static_cast<SignedT>(values[0]));
+  T deltas[BLOCK_SIZE];
+  for (int64_t i = 1; i < num_values; i += BLOCK_SIZE) {
+    int n = std::min<int64_t>(BLOCK_SIZE, num_values - i);
+    SignedT min_delta = std::numeric_limits<SignedT>::max();
+    for (int j = 0; j < n; ++j) {
+      deltas[j] = values[i + j] - values[i + j - 1];
+      min_delta = std::min(min_delta, static_cast<SignedT>(deltas[j]));
+    }
+    for (int j = 0; j < n; ++j) deltas[j] -= static_cast<T>(min_delta);
+    // The last miniblock is padded with zeros. Unused miniblocks have a bit width of 0
+    // and no data.
+    std::fill(deltas + n, deltas + BLOCK_SIZE, 0);
+    int num_miniblocks = BitUtil::Ceil(n, VALUES_PER_MINIBLOCK);
+    uint8_t bit_widths[MINIBLOCKS_PER_BLOCK] = {0};
+    for (int m = 0; m < num_miniblocks; ++m) {
+      T bits = 0;
+      for (int j = 0; j < VALUES_PER_MINIBLOCK; ++j) {
+        bits |= deltas[m * VALUES_PER_MINIBLOCK + j];
+      }
+      bit_widths[m] = BitUtil::Log2Floor64(bits) + 1;
+    }
+    ret &= writer.PutZigZagInteger<int64_t>(min_delta);
+    for (int m = 0; m < MINIBLOCKS_PER_BLOCK; ++m) {
+      ret &= writer.PutAligned<uint8_t>(bit_widths[m], 1);
+    }
+    for (int j = 0; j < num_miniblocks * VALUES_PER_MINIBLOCK; ++j) {
+      ret &= writer.PutValue(deltas[j], bit_widths[j / VALUES_PER_MINIBLOCK]);
+    }
+  }
+  DCHECK(ret);
+  writer.Flush();
+  return writer.bytes_written();
+}
+
+template class DeltaBinaryPackedDecoder<uint32_t>;
+template class DeltaBinaryPackedDecoder<uint64_t>;
+template class DeltaBinaryPackedEncoder<uint32_t>;
+template class DeltaBinaryPackedEncoder<uint64_t>;
+
+namespace {
+
+/// Allocates a buffer of 'size' bytes from 'pool'. The decoded pages are read like
+/// other data pages, so their size must fit into an int.
+Status Allocate(MemPool* pool, int64_t size, uint8_t** buffer) {
+  if (size > std::numeric_limits<int32_t>::max()) {
+    return Status(Substitute("decoded data of $0 bytes is too large", size));
+  }
+  *buffer = pool->TryAllocate(size);
+  if (*buffer == nullptr) {
+    return pool->mem_tracker()->MemLimitExceeded(
+        nullptr, "Failed to allocate buffer for decoded Parquet data page", size);
+  }
+  return Status::OK();
+}
+
+/// Decodes DELTA_BINARY_PACKED values to a buffer allocated from 'pool'. If 'end' is
+/// not nullptr, it is set to the byte after the values.
+template <typename T>
+Status DecodeDeltaBinaryPacked(const uint8_t* data, int64_t size, int64_t max_values,
+    MemPool* pool, T** values, int64_t* num_values, const uint8_t** end) {
+  DeltaBinaryPackedDecoder<T> decoder;
+  if (!decoder.Init(data, size)) return Status("invalid DELTA_BINARY_PACKED header");
+  if (decoder.num_values() > max_values) {
+    return Status(Substitute("DELTA_BINARY_PACKED data has $0 values, but the page has "
+        "only $1", decoder.num_values(), max_values));
+  }
+  uint8_t* buffer;
+  RETURN_IF_ERROR(Allocate(pool, decoder.num_values() * sizeof(T), &buffer));
+  *values = reinterpret_cast<T*>(buffer);
+  if (!decoder.Decode(*values)) return Status("invalid DELTA_BINARY_PACKED data");
+  *num_values = decoder.num_values();
+  if (end != nullptr) *end = decoder.end();
+  return Status::OK();
+}
+
+/// Decodes DELTA_LENGTH_BYTE_ARRAY values: the DELTA_BINARY_PACKED lengths followed by
+/// the concatenated bytes of the values.
+Status DecodeDeltaLengthByteArray(const uint8_t* data, int64_t size,
+    int64_t max_values, MemPool* pool, uint8_t** plain, int64_t* plain_size) {
+  uint32_t* lengths;
+  int64_t num_values;
+  const uint8_t* bytes;
+  RETURN_IF_ERROR(DecodeDeltaBinaryPacked(
+      data, size, max_values, pool, &lengths, &num_values, &bytes));
+  int64_t total_len = 0;
+  for (int64_t i = 0; i < num_values; ++i) {
+    if (lengths[i] > std::numeric_limits<int32_t>::max()) {
+      return Status(Substitute("invalid value length $0", lengths[i]));
+    }
+    total_len += lengths[i];
+  }
+  if (total_len > data + size - bytes) {
+    return Status(Substitute("value lengths add up to $0 bytes, but only $1 are left",
+        total_len, data + size - bytes));
+  }
+  *plain_size = num_values * sizeof(int32_t) + total_len;
+  RETURN_IF_ERROR(Allocate(pool, *plain_size, plain));
+  uint8_t* out = *plain;
+  for (int64_t i = 0; i < num_values; ++i) {
+    memcpy(out, &lengths[i], sizeof(int32_t));
+    memcpy(out + sizeof(int32_t), bytes, lengths[i]);
+    out += sizeof(int32_t) + lengths[i];
+    bytes += lengths[i];
+  }
+  return Status::OK();
+}
+
+/// Decodes DELTA_BYTE_ARRAY values: the DELTA_BINARY_PACKED lengths of the prefixes
+/// that are shared with the previous value, followed by the suffixes as
+/// DELTA_LENGTH_BYTE_ARRAY. If 'type_length' is not -1, the values are
+/// FIXED_LEN_BYTE_ARRAY values of that length.
+Status DecodeDeltaByteArray(const uint8_t* data, int64_t size, int type_length,
+    int64_t max_values, MemPool* pool, uint8_t** plain, int64_t* plain_size) {
+  uint32_t* prefix_lengths;
+  uint32_t* suffix_lengths;
+  int64_t num_values;
+  int64_t num_suffixes;
+  const uint8_t* suffixes;
+  RETURN_IF_ERROR(DecodeDeltaBinaryPacked(
+      data, size, max_values, pool, &prefix_lengths, &num_values, &suffixes));
+  RETURN_IF_ERROR(DecodeDeltaBinaryPacked(suffixes, data + size - suffixes, max_values,
+      pool, &suffix_lengths, &num_suffixes, &suffixes));
+  if (num_suffixes != num_values) {
+    return Status(Substitute("DELTA_BYTE_ARRAY data has $0 prefixes, but $1 suffixes",
+        num_values, num_suffixes));
+  }
+  int64_t total_suffix_len = 0;
+  int64_t total_len = 0;
+  int64_t prev_len = 0;
+  for (int64_t i = 0; i < num_values; ++i) {
+    int64_t len = static_cast<int64_t>(prefix_lengths[i]) + suffix_lengths[i];
+    if (prefix_lengths[i] > prev_len || len > std::numeric_limits<int32_t>::max()
+        || (type_length != -1 && len != type_length)) {
+      return Status(Substitute("invalid prefix length $0 or suffix length $1 of value $2",
+          prefix_lengths[i], suffix_lengths[i], i));
+    }
+    total_suffix_len += suffix_lengths[i];
+    total_len += len;
+    prev_len = len;
+  }
+  if (total_suffix_len > data + size - suffixes) {
+    return Status(Substitute("suffix lengths add up to $0 bytes, but only $1 are left",
+        total_suffix_len, data + size - suffixes));
+  }
+  const int len_size = type_length == -1 ? sizeof(int32_t) : 0;
+  *plain_size = num_values * len_size + total_len;
+  RETURN_IF_ERROR(Allocate(pool, *plain_size, plain));
+  uint8_t* out = *plain;
+  const uint8_t* prev_value = nullptr;
+  for (int64_t i = 0; i < num_values; ++i) {
+    int32_t len = prefix_lengths[i] + suffix_lengths[i];
+    if (len_size > 0) memcpy(out, &len, sizeof(int32_t));
+    out += len_size;
+    if (prefix_lengths[i] > 0) memcpy(out, prev_value, prefix_lengths[i]);
+    memcpy(out + prefix_lengths[i], suffixes, suffix_lengths[i]);
+    suffixes += suffix_lengths[i];
+    prev_value = out;
+    out += len;
+  }
+  return Status::OK();
+}
+
+/// Copies byte 'b' of value 'i' between 'split[b * num_values + i]' and
+/// 'plain[i * WIDTH + b]'. Specialized for the common widths so that the loops can be
+/// vectorized.
+template <int WIDTH, bool TO_PLAIN>
+void TransposeFixedWidthByteStreams(
+    int64_t num_values, const uint8_t* in, uint8_t* out) {
+  for (int b = 0; b < WIDTH; ++b) {
+    for (int64_t i = 0; i < num_values; ++i) {
+      if (TO_PLAIN) {
+        out[i * WIDTH + b] = in[b * num_values + i];
+      } else {
+        out[b * num_values + i] = in[i * WIDTH + b];
+      }
+    }
+  }
+}
+
+template <bool TO_PLAIN>
+void TransposeByteStreams(int width, int64_t num_values, const uint8_t* in,
+    uint8_t* out) {
+  switch (width) {
+    case 4:
+      TransposeFixedWidthByteStreams<4, TO_PLAIN>(num_values, in, out);
+      return;
+    case 8:
+      TransposeFixedWidthByteStreams<8, TO_PLAIN>(num_values, in, out);
+      return;
+    default:
+      for (int b = 0; b < width; ++b) {
+        for (int64_t i = 0; i < num_values; ++i) {
+          if (TO_PLAIN) {
+            out[i * width + b] = in[b * num_values + i];
+          } else {
+            out[b * num_values + i] = in[i * width + b];
+          }
+        }
+      }
+  }
+}
+
+/// Returns the size of PLAIN values of the fixed-width 'type'.
+int FixedValueSize(parquet::Type::type type, int type_length) {
+  switch (type) {
+    case parquet::Type::INT32:
+    case parquet::Type::FLOAT:
+      return 4;
+    case parquet::Type::INT64:
+    case parquet::Type::DOUBLE:
+      return 8;
+    case parquet::Type::FIXED_LEN_BYTE_ARRAY:
+      return type_length;
+    default:
+      DCHECK(false) << type;
+      return -1;
+  }
+}
+
+/// Decodes BYTE_STREAM_SPLIT values, which store byte i of all values in the i-th of
+/// 'width' streams.
+Status DecodeByteStreamSplit(const uint8_t* data, int64_t size, int width,
+    int64_t max_values, MemPool* pool, uint8_t** plain, int64_t* plain_size) {
+  if (width <= 0 || size % width != 0 || size / width > max_values) {
+    return Status(Substitute("invalid BYTE_STREAM_SPLIT data of $0 bytes for $1 values "
+        "of $2 bytes", size, max_values, width));
+  }
+  RETURN_IF_ERROR(Allocate(pool, size, plain));
+  TransposeByteStreams<true>(width, size / width, data, *plain);
+  *plain_size = size;
+  return Status::OK();
+}
+
+/// Calls 'fn' with the pointer and length of each BYTE_ARRAY value in the PLAIN values
+/// at 'plain'. The values were written by the table writer, so they are not validated.
+template <typename Fn>
+void ForEachPlainByteArray(const uint8_t* plain, int64_t plain_size, Fn fn) {
+  const uint8_t* end = plain + plain_size;
+  while (plain < end) {
+    uint32_t len;
+    memcpy(&len, plain, sizeof(len));
+    fn(plain + sizeof(len), len);
+    plain += sizeof(len) + len;
+  }
+  DCHECK(plain == end);
+}
+
+int64_t EncodeDeltaLengthByteArray(
+    const uint8_t* plain, int64_t plain_size, uint8_t* out) {
+  vector<uint32_t> lengths;
+  ForEachPlainByteArray(plain, plain_size,
+      [&](const uint8_t* value, uint32_t len) { lengths.push_back(len); });
+  uint8_t* pos = out;
+  pos += DeltaBinaryPackedEncoder<uint32_t>::Encode(lengths.data(), lengths.size(), pos);
+  ForEachPlainByteArray(plain, plain_size, [&](const uint8_t* value, uint32_t len) {
+    memcpy(pos, value, len);
+    pos += len;
+  });
+  return pos - out;
+}
+
+int64_t EncodeDeltaByteArray(const uint8_t* plain, int64_t plain_size, uint8_t* out) {
+  vector<uint32_t> prefix_lengths;
+  vector<uint32_t> suffix_lengths;
+  const uint8_t* prev_value = nullptr;
+  uint32_t prev_len = 0;
+  ForEachPlainByteArray(plain, plain_size, [&](const uint8_t* value, uint32_t len) {
+    uint32_t max_prefix = std::min(len, prev_len);
+    uint32_t prefix = 0;
+    while (prefix < max_prefix && value[prefix] == prev_value[prefix]) ++prefix;
+    prefix_lengths.push_back(prefix);
+    suffix_lengths.push_back(len - prefix);
+    prev_value = value;
+    prev_len = len;
+  });
+  uint8_t* pos = out;
+  pos += DeltaBinaryPackedEncoder<uint32_t>::Encode(
+      prefix_lengths.data(), prefix_lengths.size(), pos);
+  pos += DeltaBinaryPackedEncoder<uint32_t>::Encode(
+      suffix_lengths.data(), suffix_lengths.size(), pos);
+  int64_t i = 0;
+  ForEachPlainByteArray(plain, plain_size, [&](const uint8_t* value, uint32_t len) {
+    memcpy(pos, value + prefix_lengths[i], suffix_lengths[i]);
+    pos += suffix_lengths[i];
+    ++i;
+  });
+  return pos - out;
+}
+
+} // anonymous namespace
+
+bool ParquetEncodingConverter::CanDecodeToPlain(
+    parquet::Encoding::type encoding, parquet::Type::type type) {
+  switch (encoding) {
+    case parquet::Encoding::DELTA_BINARY_PACKED:
+      return type == parquet::Type::INT32 || type == parquet::Type::INT64;
+    case parquet::Encoding::DELTA_LENGTH_BYTE_ARRAY:
+      return type == parquet::Type::BYTE_ARRAY;
+    case parquet::Encoding::DELTA_BYTE_ARRAY:
+      return type == parquet::Type::BYTE_ARRAY
+          || type == parquet::Type::FIXED_LEN_BYTE_ARRAY;
+    case parquet::Encoding::BYTE_STREAM_SPLIT:
+      return type == parquet::Type::INT32 || type == parquet::Type::INT64
+          || type == parquet::Type::FLOAT || type == parquet::Type::DOUBLE
+          || type == parquet::Type::FIXED_LEN_BYTE_ARRAY;
+    default:
+      return false;
+  }
+}
+
+Status ParquetEncodingConverter::DecodeToPlain(parquet::Encoding::type encoding,
+    parquet::Type::type type, int type_length, const uint8_t* data, int64_t size,
+    int64_t max_values, MemPool* pool, uint8_t** plain, int64_t* plain_size) {
+  DCHECK(CanDecodeToPlain(encoding, type));
+  switch (encoding) {
+    case parquet::Encoding::DELTA_BINARY_PACKED: {
+      // PLAIN INT32 and INT64 values are the little-endian values themselves.
+      int64_t num_values;
+      if (type == parquet::Type::INT32) {
+        uint32_t* values;
+        RETURN_IF_ERROR(DecodeDeltaBinaryPacked(
+            data, size, max_values, pool, &values, &num_values, nullptr));
+        *plain = reinterpret_cast<uint8_t*>(values);
+        *plain_size = num_values * sizeof(uint32_t);
+      } else {
+        uint64_t* values;
+        RETURN_IF_ERROR(DecodeDeltaBinaryPacked(
+            data, size, max_values, pool, &values, &num_values, nullptr));
+        *plain = reinterpret_cast<uint8_t*>(values);
+        *plain_size = num_values * sizeof(uint64_t);
+      }
+      return Status::OK();
+    }
+    case parquet::Encoding::DELTA_LENGTH_BYTE_ARRAY:
+      return DecodeDeltaLengthByteArray(data, size, max_values, pool, plain, plain_size);
+    case parquet::Encoding::DELTA_BYTE_ARRAY:
+      return DecodeDeltaByteArray(data, size,
+          type == parquet::Type::FIXED_LEN_BYTE_ARRAY ? type_length : -1, max_values,
+          pool, plain, plain_size);
+    case parquet::Encoding::BYTE_STREAM_SPLIT:
+      return DecodeByteStreamSplit(data, size, FixedValueSize(type, type_length),
+          max_values, pool, plain, plain_size);
+    default:
+      DCHECK(false);
+      return Status("unsupported encoding");
+  }
+}
+
+bool ParquetEncodingConverter::CanEncodeFromPlain(
+    parquet::Encoding::type encoding, parquet::Type::type type) {
+  switch (encoding) {
+    case parquet::Encoding::DELTA_BINARY_PACKED:
+      return type == parquet::Type::INT32 || type == parquet::Type::INT64;
+    case parquet::Encoding::DELTA_LENGTH_BYTE_ARRAY:
+    case parquet::Encoding::DELTA_BYTE_ARRAY:
+      return type == parquet::Type::BYTE_ARRAY;
+    case parquet::Encoding::BYTE_STREAM_SPLIT:
+      return type == parquet::Type::FLOAT || type == parquet::Type::DOUBLE;
+    default:
+      return false;
+  }
+}
+
+int64_t ParquetEncodingConverter::MaxEncodedLen(
+    parquet::Encoding::type encoding, parquet::Type::type type, int64_t plain_size) {
+  DCHECK(CanEncodeFromPlain(encoding, type));
+  // Each BYTE_ARRAY value takes at least 4 bytes in PLAIN.
+  int64_t max_lengths_len =
+      DeltaBinaryPackedEncoder<uint32_t>::MaxEncodedLen(plain_size / sizeof(int32_t));
+  switch (encoding) {
+    case parquet::Encoding::DELTA_BINARY_PACKED:
+      if (type == parquet::Type::INT32) return max_lengths_len;
+      return DeltaBinaryPackedEncoder<uint64_t>::MaxEncodedLen(
+          plain_size / sizeof(int64_t));
+    case parquet::Encoding::DELTA_LENGTH_BYTE_ARRAY:
+      return max_lengths_len + plain_size;
+    case parquet::Encoding::DELTA_BYTE_ARRAY:
+      return 2 * max_lengths_len + plain_size;
+    case parquet::Encoding::BYTE_STREAM_SPLIT:
+      return plain_size;
+    default:
+      DCHECK(false);
+      return -1;
+  }
+}
+
+int64_t ParquetEncodingConverter::EncodeFromPlain(parquet::Encoding::type encoding,
+    parquet::Type::type type, const uint8_t* plain, int64_t plain_size, uint8_t* out) {
+  DCHECK(CanEncodeFromPlain(encoding, type));
+  switch (encoding) {
+    case parquet::Encoding::DELTA_BINARY_PACKED:
+      if (type == parquet::Type::INT32) {
+        return DeltaBinaryPackedEncoder<uint32_t>::Encode(
+            reinterpret_cast<const uint32_t*>(plain), plain_size / sizeof(uint32_t), out);
+      }
+      return DeltaBinaryPackedEncoder<uint64_t>::Encode(
+          reinterpret_cast<const uint64_t*>(plain), plain_size / sizeof(uint64_t), out);
+    case parquet::Encoding::DELTA_LENGTH_BYTE_ARRAY:
+      return EncodeDeltaLengthByteArray(plain, plain_size, out);
+    case parquet::Encoding::DELTA_BYTE_ARRAY:
+      return EncodeDeltaByteArray(plain, plain_size, out);
+    case parquet::Encoding::BYTE_STREAM_SPLIT: {
+      int width = FixedValueSize(type, -1);
+      TransposeByteStreams<false>(width, plain_size / width, plain, out);
+      return plain_size;
+    }
+    default:
+      DCHECK(false);
+      return -1;
+  }
+}
+
+} // namespace impala
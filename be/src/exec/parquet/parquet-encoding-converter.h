@@ -0,0 +1,121 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/status.h"
+#include "gen-cpp/parquet_types.h"
+#include "util/bit-stream-utils.h"
+
+namespace impala {
+
+class MemPool;
+
+/// Decoder for DELTA_BINARY_PACKED encoded INT32 and INT64 values. 'T' is uint32_t or
+/// uint64_t respectively. As the Parquet spec requires, the deltas are added with
+/// wrap-around arithmetic. The encoding is:
+///   <block size> <miniblocks per block> <total value count> <first value>
+///   <block>*
+/// where each block is:
+///   <min delta> <bit width of each miniblock, one byte each> <miniblock>*
+/// The sizes are ULEB128 encoded, the first value and the min delta are ZigZag ULEB128
+/// encoded and each miniblock is the bit-packed values of delta - <min delta>.
+template <typename T>
+class DeltaBinaryPackedDecoder {
+ public:
+  /// Reads the header of the values at 'data'. Returns false if it is invalid.
+  bool Init(const uint8_t* data, int64_t size);
+
+  /// The number of values, read from the header.
+  int64_t num_values() const { return num_values_; }
+
+  /// Decodes all values to 'out', which must have room for num_values() values.
+  /// Returns false if the data is corrupt.
+  bool Decode(T* out);
+
+  /// Returns a pointer after the last byte of the encoded values. Only valid after
+  /// Decode() returned true. Used by the encodings that store other data after them.
+  const uint8_t* end() { return data_end_ - reader_.bytes_left(); }
+
+ private:
+  BatchedBitReader reader_;
+  const uint8_t* data_end_ = nullptr;
+  int64_t num_values_ = 0;
+  int num_miniblocks_ = 0;
+  int64_t values_per_miniblock_ = 0;
+  T first_value_ = 0;
+};
+
+/// Encoder for DELTA_BINARY_PACKED, see DeltaBinaryPackedDecoder for the format. Uses
+/// blocks of 128 values with 4 miniblocks each, like other Parquet writers do.
+template <typename T>
+class DeltaBinaryPackedEncoder {
+ public:
+  static const int BLOCK_SIZE = 128;
+  static const int MINIBLOCKS_PER_BLOCK = 4;
+  static const int VALUES_PER_MINIBLOCK = BLOCK_SIZE / MINIBLOCKS_PER_BLOCK;
+
+  /// Returns the maximum number of bytes needed to encode 'num_values' values.
+  static int64_t MaxEncodedLen(int64_t num_values);
+
+  /// Encodes 'num_values' values from 'values' to 'out', which must have room for
+  /// MaxEncodedLen(num_values) bytes. Returns the number of bytes written.
+  static int64_t Encode(const T* values, int64_t num_values, uint8_t* out);
+};
+
+/// Converts the values of data pages between PLAIN and the encodings that the column
+/// readers and writers do not handle value by value: DELTA_BINARY_PACKED,
+/// DELTA_LENGTH_BYTE_ARRAY, DELTA_BYTE_ARRAY and BYTE_STREAM_SPLIT. These are usually
+/// chosen for sorted or high cardinality columns, where they are much smaller than PLAIN
+/// after compression. Converting a whole page at once keeps the value-by-value paths of
+/// the column readers and writers, including type conversions and page filtering,
+/// limited to PLAIN and dictionary encoded values.
+class ParquetEncodingConverter {
+ public:
+  /// Returns true if DecodeToPlain() supports values of 'type' encoded with 'encoding'.
+  static bool CanDecodeToPlain(
+      parquet::Encoding::type encoding, parquet::Type::type type);
+
+  /// Decodes the 'size' bytes of values at 'data', which are of 'type' and encoded with
+  /// 'encoding', to PLAIN. 'type_length' is the length of FIXED_LEN_BYTE_ARRAY values.
+  /// 'max_values' is the number of values of the data page, including NULLs. The PLAIN
+  /// values are allocated from 'pool', along with some temporary buffers. On success,
+  /// '*plain' and '*plain_size' are set to the PLAIN values. Returns an error if the
+  /// data is corrupt or if the memory could not be allocated.
+  static Status DecodeToPlain(parquet::Encoding::type encoding, parquet::Type::type type,
+      int type_length, const uint8_t* data, int64_t size, int64_t max_values,
+      MemPool* pool, uint8_t** plain, int64_t* plain_size);
+
+  /// Returns true if EncodeFromPlain() supports values of 'type' with 'encoding'.
+  static bool CanEncodeFromPlain(
+      parquet::Encoding::type encoding, parquet::Type::type type);
+
+  /// Returns the maximum number of bytes that EncodeFromPlain() writes for 'plain_size'
+  /// bytes of PLAIN values.
+  static int64_t MaxEncodedLen(
+      parquet::Encoding::type encoding, parquet::Type::type type, int64_t plain_size);
+
+  /// Encodes the 'plain_size' bytes of PLAIN values of 'type' at 'plain' with
+  /// 'encoding'. 'out' must have room for MaxEncodedLen() bytes. Returns the number of
+  /// bytes written.
+  static int64_t EncodeFromPlain(parquet::Encoding::type encoding,
+      parquet::Type::type type, const uint8_t* plain, int64_t plain_size, uint8_t* out);
+};
+
+} // namespace impala
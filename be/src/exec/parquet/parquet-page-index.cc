@@ -20,6 +20,9 @@
 #include "exec/parquet/parquet-page-index.h"
 #include "gutil/strings/substitute.h"
 #include "rpc/thrift-util.h"
+#include "runtime/exec-env.h"
+#include "runtime/io/disk-io-mgr.h"
+#include "runtime/io/file-metadata-cache.h"
 #include "runtime/io/request-context.h"
 #include "runtime/io/request-ranges.h"
 
@@ -68,7 +71,7 @@ bool ParquetPageIndex::DeterminePageIndexRangesInRowGroup(
 Status ParquetPageIndex::ReadAll(int row_group_idx) {
   DCHECK(page_index_buffer_.buffer() == nullptr);
   bool has_page_index = DeterminePageIndexRangesInRowGroup(
-      scanner_->file_metadata_.row_groups[row_group_idx],
+      scanner_->file_metadata_->row_groups[row_group_idx],
       &column_index_base_offset_, &column_index_size_,
       &offset_index_base_offset_, &offset_index_size_);
 
@@ -93,6 +96,25 @@ Status ParquetPageIndex::ReadAll(int row_group_idx) {
         "page index for file '$1'.", buffer_size, scanner_->filename()));
   }
   int64_t partition_id = scanner_->context_->partition_descriptor()->id();
+
+  // The page index of this row group may have been read before by another scanner.
+  FileMetadataCache* metadata_cache =
+      ExecEnv::GetInstance()->disk_io_mgr()->file_metadata_cache();
+  string cache_key;
+  if (metadata_cache != nullptr) {
+    const HdfsFileDesc* file_desc =
+        scanner_->scan_node_->GetFileDesc(partition_id, scanner_->filename());
+    cache_key = FileMetadataCache::MakeKey(FileMetadataCache::Kind::PARQUET_PAGE_INDEX,
+        scanner_->filename(), file_desc->mtime, file_desc->file_length, row_group_idx);
+    shared_ptr<const vector<uint8_t>> cached_page_index =
+        metadata_cache->Lookup<vector<uint8_t>>(cache_key);
+    if (cached_page_index != nullptr) {
+      DCHECK_EQ(static_cast<int64_t>(cached_page_index->size()), buffer_size);
+      memcpy(page_index_buffer_.buffer(), cached_page_index->data(), buffer_size);
+      return Status::OK();
+    }
+  }
+
   int cache_options =
       scanner_->metadata_range_->cache_options() & ~BufferOpts::USE_HDFS_CACHE;
   ScanRange* object_range = scanner_->scan_node_->AllocateScanRange(
@@ -116,6 +138,12 @@ Status ParquetPageIndex::ReadAll(int row_group_idx) {
   scanner_->AddSyncReadBytesCounter(io_buffer->len());
   object_range->ReturnBuffer(move(io_buffer));
 
+  if (metadata_cache != nullptr) {
+    uint8_t* page_index = page_index_buffer_.buffer();
+    metadata_cache->Insert(cache_key,
+        make_shared<const vector<uint8_t>>(page_index, page_index + buffer_size),
+        buffer_size);
+  }
   return Status::OK();
 }
 
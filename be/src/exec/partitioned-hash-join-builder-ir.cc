@@ -47,7 +47,7 @@ Status PhjBuilder::ProcessBuildBatch(
   Status status;
   HashTableCtx::ExprValuesCache* expr_vals_cache = ctx->expr_values_cache();
   expr_vals_cache->Reset();
-  FOREACH_ROW(build_batch, 0, build_batch_iter) {
+  FOREACH_ACTIVE_ROW(build_batch, 0, build_batch_iter) {
     TupleRow* build_row = build_batch_iter.Get();
     if (!ctx->EvalAndHashBuild(build_row)) {
       if (is_null_aware) {
@@ -127,7 +127,7 @@ Status PhjBuilderConfig::InitExprsAndFilters(FragmentState* state,
 
   hash_table_config_ = state->obj_pool()->Add(new HashTableConfig(build_exprs_,
       build_exprs_, PhjBuilder::HashTableStoresNulls(join_op_, is_not_distinct_from_),
-      is_not_distinct_from_));
+      is_not_distinct_from_, state->query_options().hash_table_group_probing));
   state->CheckAndAddCodegenDisabledMessage(codegen_status_msgs_);
   return Status::OK();
 }
@@ -240,6 +240,8 @@ Status PhjBuilder::Prepare(RuntimeState* state, MemTracker* parent_mem_tracker)
   build_hash_table_timer_ = ADD_TIMER(profile(), "HashTablesBuildTime");
   num_hash_table_builds_skipped_ =
       ADD_COUNTER(profile(), "NumHashTableBuildsSkipped", TUnit::UNIT);
+  num_hash_tables_built_by_probe_threads_ =
+      ADD_COUNTER(profile(), "NumHashTablesBuiltByProbeThreads", TUnit::UNIT);
   repartition_timer_ = ADD_TIMER(profile(), "RepartitionTime");
 
   if (is_separate_build_) {
@@ -303,7 +305,7 @@ Status PhjBuilder::Send(RuntimeState* state, RowBatch* batch) {
   SCOPED_TIMER(profile()->total_time_counter());
   SCOPED_TIMER(partition_build_rows_timer_);
   RETURN_IF_ERROR(AddBatch(batch));
-  COUNTER_ADD(num_build_rows_, batch->num_rows());
+  COUNTER_ADD(num_build_rows_, batch->num_active_rows());
   return Status::OK();
 }
 
@@ -446,6 +448,13 @@ void PhjBuilder::Close(RuntimeState* state) {
     ht_ctx_->Close(state);
     ht_ctx_.reset();
   }
+  for (const unique_ptr<HashTableCtx>& ctx : helper_ht_ctxs_) {
+    ctx->StatsCountersAdd(ht_stats_profile_.get());
+    ctx->Close(state);
+  }
+  helper_ht_ctxs_.clear();
+  for (const unique_ptr<MemPool>& pool : helper_expr_results_pools_) pool->FreeAll();
+  helper_expr_results_pools_.clear();
   for (const FilterContext& ctx : filter_ctxs_) {
     if (ctx.expr_eval != nullptr) ctx.expr_eval->Close(state);
   }
@@ -631,16 +640,27 @@ Status PhjBuilder::BuildHashTablesAndReserveProbeBuffers(HashJoinState next_stat
   // won't fit in memory alongside the required probe buffers.
   RETURN_IF_ERROR(ReserveProbeBuffers(next_state));
 
+  vector<PhjBuilderPartition*> partitions_to_build;
   for (int i = 0; i < PARTITION_FANOUT; ++i) {
     PhjBuilderPartition* partition = hash_partitions_[i].get();
     if (partition->IsClosed() || partition->is_spilled()) continue;
-
-    bool built = false;
     DCHECK(partition->build_rows()->is_pinned());
-    RETURN_IF_ERROR(partition->BuildHashTable(&built));
-    // If we did not have enough memory to build this hash table, we need to spill this
-    // partition (clean up the hash table, unpin build).
-    if (!built) RETURN_IF_ERROR(partition->Spill(BufferedTupleStream::UNPIN_ALL));
+    partitions_to_build.push_back(partition);
+  }
+  // The probe-side threads of a separate build are idle until the initial build is
+  // handed off to them, so let them help with building the hash tables.
+  if (is_separate_build_ && num_probe_threads_ > 1
+      && next_state == HashJoinState::PARTITIONING_PROBE
+      && partitions_to_build.size() > 1) {
+    RETURN_IF_ERROR(BuildHashTablesInParallel(partitions_to_build));
+  } else {
+    for (PhjBuilderPartition* partition : partitions_to_build) {
+      bool built = false;
+      RETURN_IF_ERROR(partition->BuildHashTable(&built));
+      // If we did not have enough memory to build this hash table, we need to spill
+      // this partition (clean up the hash table, unpin build).
+      if (!built) RETURN_IF_ERROR(partition->Spill(BufferedTupleStream::UNPIN_ALL));
+    }
   }
   // We may have spilled additional partitions while building hash tables, we need to
   // reserve memory for the probe buffers for those additional spilled partitions.
@@ -653,6 +673,65 @@ Status PhjBuilder::BuildHashTablesAndReserveProbeBuffers(HashJoinState next_stat
   return Status::OK();
 }
 
+Status PhjBuilder::BuildHashTablesInParallel(
+    const vector<PhjBuilderPartition*>& partitions) {
+  DCHECK(is_separate_build_);
+  SCOPED_TIMER(build_hash_table_timer_);
+  // The buffer pool client can't be used by multiple threads at the same time, so pin
+  // the streams and allocate the buckets up front. Inserting the rows only allocates
+  // memory from 'ht_allocator_' for duplicates, which is synchronized below.
+  vector<PhjBuilderPartition*> prepared_partitions;
+  for (PhjBuilderPartition* partition : partitions) {
+    bool built = false;
+    RETURN_IF_ERROR(partition->PrepareHashTable(&built));
+    if (built) {
+      prepared_partitions.push_back(partition);
+    } else {
+      RETURN_IF_ERROR(partition->Spill(BufferedTupleStream::UNPIN_ALL));
+    }
+  }
+  if (helper_ht_ctxs_.empty()) {
+    // Expr evaluators are not thread-safe, so each thread needs its own context.
+    for (int i = 0; i < num_probe_threads_; ++i) {
+      helper_expr_results_pools_.emplace_back(new MemPool(expr_mem_tracker_.get()));
+      MemPool* pool = helper_expr_results_pools_.back().get();
+      scoped_ptr<HashTableCtx> ctx;
+      RETURN_IF_ERROR(HashTableCtx::Create(&obj_pool_, runtime_state_,
+          hash_table_config_, hash_seed_, MAX_PARTITION_DEPTH,
+          row_desc_->tuple_descriptors().size(), expr_perm_pool_.get(), pool, pool,
+          &ctx));
+      helper_ht_ctxs_.emplace_back(ctx.release());
+      RETURN_IF_ERROR(helper_ht_ctxs_.back()->Open(runtime_state_));
+    }
+  }
+
+  ht_allocator_->set_lock(&ht_allocator_lock_);
+  Status status = RunBuildTasks(prepared_partitions.size(),
+      [this, &prepared_partitions](int task, int worker) {
+        RETURN_IF_CANCELLED(runtime_state_);
+        RETURN_IF_ERROR(DebugAction(runtime_state_->query_options(),
+            "PHJ_BUILD_HASH_TABLE_TASK"));
+        HashTableCtx* ctx = ht_ctx_.get();
+        MemPool* pool = expr_results_pool_.get();
+        if (worker > 0) {
+          ctx = helper_ht_ctxs_[worker - 1].get();
+          pool = helper_expr_results_pools_[worker - 1].get();
+          COUNTER_ADD(num_hash_tables_built_by_probe_threads_, 1);
+        }
+        bool built;
+        return prepared_partitions[task]->InsertIntoHashTable(ctx, pool, &built);
+      });
+  ht_allocator_->set_lock(nullptr);
+  RETURN_IF_ERROR(status);
+  for (PhjBuilderPartition* partition : prepared_partitions) {
+    // The hash table was closed if it did not fit into memory.
+    if (partition->hash_tbl() == nullptr) {
+      RETURN_IF_ERROR(partition->Spill(BufferedTupleStream::UNPIN_ALL));
+    }
+  }
+  return Status::OK();
+}
+
 Status PhjBuilder::ReserveProbeBuffers(HashJoinState next_state) {
   DCHECK_EQ(PARTITION_FANOUT, hash_partitions_.size());
   int64_t curr_reservation = probe_stream_reservation_.GetReservation();
@@ -949,6 +1028,10 @@ void PhjBuilder::AllocateRuntimeFilters() {
           runtime_state_->filter_bank()->AllocateScratchMinMaxFilter(
               filter_ctx.filter->id(), filter_ctx.expr_eval->root().type());
       minmax_filter_ctxs_.push_back(&filter_ctx);
+    } else if (filter_ctx.filter->is_bitmap_filter()) {
+      filter_ctx.local_bitmap_filter =
+          runtime_state_->filter_bank()->AllocateScratchBitmapFilter(
+              filter_ctx.filter->id());
     } else {
       DCHECK(filter_ctx.filter->is_in_list_filter());
       filter_ctx.local_in_list_filter =
@@ -1217,6 +1300,13 @@ Status PhjBuilderPartition::Spill(BufferedTupleStream::UnpinMode mode) {
 
 Status PhjBuilderPartition::BuildHashTable(bool* built) {
   SCOPED_TIMER(parent_->build_hash_table_timer_);
+  RETURN_IF_ERROR(PrepareHashTable(built));
+  if (!*built) return Status::OK();
+  return InsertIntoHashTable(
+      parent_->ht_ctx_.get(), parent_->expr_results_pool_.get(), built);
+}
+
+Status PhjBuilderPartition::PrepareHashTable(bool* built) {
   DCHECK(build_rows_ != nullptr);
   *built = false;
 
@@ -1224,13 +1314,6 @@ Status PhjBuilderPartition::BuildHashTable(bool* built) {
   RETURN_IF_ERROR(build_rows_->PinStream(built));
   if (!*built) return Status::OK();
 
-  RuntimeState* state = parent_->runtime_state_;
-  HashTableCtx* ctx = parent_->ht_ctx_.get();
-  ctx->set_level(level()); // Set the hash function for building the hash table.
-  RowBatch batch(parent_->row_desc_, state->batch_size(), parent_->mem_tracker());
-  vector<BufferedTupleStream::FlatRowPtr> flat_rows;
-  bool eos = false;
-
   // Allocate the partition-local hash table. Initialize the number of buckets based on
   // the number of build rows (the number of rows is known at this point). This assumes
   // there are no duplicates which can be wrong. However, the upside in the common case
@@ -1247,13 +1330,32 @@ Status PhjBuilderPartition::BuildHashTable(bool* built) {
   hash_tbl_.reset(HashTable::Create(parent_->ht_allocator_.get(),
       true /* store_duplicates */, parent_->row_desc_->tuple_descriptors().size(),
       build_rows(), 1 << (32 - PhjBuilder::NUM_PARTITIONING_BITS),
-      estimated_num_buckets));
+      estimated_num_buckets, parent_->ht_ctx_->group_probing()));
   bool success;
   Status status = hash_tbl_->Init(&success);
-  if (!status.ok() || !success) goto not_built;
-  status = build_rows_->PrepareForRead(false, &success);
-  if (!status.ok()) goto not_built;
-  DCHECK(success) << "Stream was already pinned.";
+  if (status.ok() && success) {
+    status = build_rows_->PrepareForRead(false, &success);
+    if (status.ok()) {
+      DCHECK(success) << "Stream was already pinned.";
+      return Status::OK();
+    }
+  }
+  *built = false;
+  hash_tbl_->Close();
+  hash_tbl_.reset();
+  return status;
+}
+
+Status PhjBuilderPartition::InsertIntoHashTable(
+    HashTableCtx* ctx, MemPool* expr_results_pool, bool* built) {
+  DCHECK(hash_tbl_ != nullptr);
+  *built = true;
+  RuntimeState* state = parent_->runtime_state_;
+  ctx->set_level(level()); // Set the hash function for building the hash table.
+  RowBatch batch(parent_->row_desc_, state->batch_size(), parent_->mem_tracker());
+  vector<BufferedTupleStream::FlatRowPtr> flat_rows;
+  bool eos = false;
+  Status status;
 
   do {
     status = build_rows_->GetNext(&batch, &eos, &flat_rows);
@@ -1281,7 +1383,7 @@ Status PhjBuilderPartition::BuildHashTable(bool* built) {
     RETURN_IF_CANCELLED(state);
     RETURN_IF_ERROR(state->GetQueryStatus());
     // Free any expr result allocations made while inserting.
-    parent_->expr_results_pool_->Clear();
+    expr_results_pool->Clear();
     batch.Reset();
   } while (!eos);
 
@@ -1411,6 +1513,7 @@ Status PhjBuilderConfig::CodegenProcessBuildBatch(LlvmCodeGen* codegen,
   DCHECK_EQ(replaced_constants.stores_duplicates, 0);
   DCHECK_EQ(replaced_constants.stores_tuples, 0);
   DCHECK_EQ(replaced_constants.quadratic_probing, 0);
+  DCHECK_EQ(replaced_constants.group_probing, 0);
 
   llvm::Value* is_null_aware_arg = codegen->GetArgument(process_build_batch_fn, 5);
   is_null_aware_arg->replaceAllUsesWith(
@@ -1499,6 +1602,7 @@ Status PhjBuilderConfig::CodegenInsertBatch(LlvmCodeGen* codegen, llvm::Function
   DCHECK_GE(replaced_constants.stores_duplicates, 1);
   DCHECK_GE(replaced_constants.stores_tuples, 1);
   DCHECK_GE(replaced_constants.quadratic_probing, 1);
+  DCHECK_GE(replaced_constants.group_probing, 1);
 
   llvm::Function* insert_batch_fn_level0 = codegen->CloneFunction(insert_batch_fn);
 
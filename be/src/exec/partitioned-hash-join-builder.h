@@ -220,6 +220,16 @@ class PhjBuilderPartition {
   /// encountered.
   Status BuildHashTable(bool* built) WARN_UNUSED_RESULT;
 
+  /// The two steps of BuildHashTable(). PrepareHashTable() pins the build rows and
+  /// allocates the buckets of the hash table. InsertIntoHashTable() then inserts the
+  /// build rows using 'ctx' and frees the expr results in 'expr_results_pool' after each
+  /// batch. Both set *built like BuildHashTable(). Different partitions can run
+  /// InsertIntoHashTable() concurrently if the hash table allocator is synchronized, see
+  /// PhjBuilder::BuildHashTablesInParallel().
+  Status PrepareHashTable(bool* built) WARN_UNUSED_RESULT;
+  Status InsertIntoHashTable(HashTableCtx* ctx, MemPool* expr_results_pool,
+      bool* built) WARN_UNUSED_RESULT;
+
   /// Spills this partition, the partition's stream is unpinned with 'mode' and
   /// its hash table is destroyed if it was built. Calling with 'mode' UNPIN_ALL
   /// unpins all pages and frees all buffers associated with the partition so that
@@ -378,6 +388,7 @@ class PhjBuilder : public JoinBuilder {
   virtual Status Prepare(RuntimeState* state, MemTracker* parent_mem_tracker) override;
   virtual Status Open(RuntimeState* state) override;
   virtual Status Send(RuntimeState* state, RowBatch* batch) override;
+  virtual bool AcceptsSelection() const override { return true; }
   virtual Status FlushFinal(RuntimeState* state) override;
   virtual void Close(RuntimeState* state) override;
 
@@ -590,7 +601,7 @@ class PhjBuilder : public JoinBuilder {
   Status CreateAndPreparePartition(int level,
       std::unique_ptr<PhjBuilderPartition>* partition);
 
-  /// Reads the rows in build_batch and partitions them into hash_partitions_. If
+  /// Reads the active rows in build_batch and partitions them into hash_partitions_. If
   /// 'build_filters' is true, runtime filters are populated. 'is_null_aware' is
   /// set to true if the join type is a null aware join.
   Status ProcessBuildBatch(
@@ -647,6 +658,14 @@ class PhjBuilder : public JoinBuilder {
   /// tables, either PARTITIONING_PROBE or REPARTITIONING_PROBE.
   Status BuildHashTablesAndReserveProbeBuffers(HashJoinState next_state);
 
+  /// Builds the hash tables of 'partitions', which must be pinned, as part of the
+  /// initial build of a separate build with multiple probe threads. The streams are
+  /// pinned and the hash tables allocated on this thread, then the rows are inserted
+  /// with RunBuildTasks(), one partition per task, so that the probe-side threads that
+  /// wait for the initial build help with it. Spills the partitions whose hash tables
+  /// don't fit into memory.
+  Status BuildHashTablesInParallel(const std::vector<PhjBuilderPartition*>& partitions);
+
   /// Ensures that 'probe_stream_reservation_' has enough reservation for a stream per
   /// spilled partition in 'hash_partitions_', plus for the input stream if the input
   /// is a spilled partition (determined by 'next_state' - either PARTITIONING_PROBE or
@@ -760,6 +779,9 @@ class PhjBuilder : public JoinBuilder {
   /// Allocator for hash table memory.
   boost::scoped_ptr<Suballocator> ht_allocator_;
 
+  /// Synchronizes 'ht_allocator_' while hash tables are built in parallel.
+  std::mutex ht_allocator_lock_;
+
   /// Expressions over input rows for hash table build.
   const std::vector<ScalarExpr*>& build_exprs_;
 
@@ -790,6 +812,13 @@ class PhjBuilder : public JoinBuilder {
   /// The level is set to the same level as 'hash_partitions_'.
   boost::scoped_ptr<HashTableCtx> ht_ctx_;
 
+  /// Hash table contexts and their expr results pools for the probe-side threads that
+  /// insert rows in BuildHashTablesInParallel(). The thread with index i of
+  /// RunBuildTasks() uses the entries at i - 1, the build-side thread uses 'ht_ctx_'.
+  /// Created by the first call to BuildHashTablesInParallel().
+  std::vector<std::unique_ptr<HashTableCtx>> helper_ht_ctxs_;
+  std::vector<std::unique_ptr<MemPool>> helper_expr_results_pools_;
+
   /// Counters and profile objects for HashTable stats
   std::unique_ptr<HashTableStatsProfile> ht_stats_profile_;
 
@@ -819,6 +848,9 @@ class PhjBuilder : public JoinBuilder {
   /// hash table.
   RuntimeProfile::Counter* num_hash_table_builds_skipped_ = nullptr;
 
+  /// Number of hash tables that probe-side threads built in BuildHashTablesInParallel().
+  RuntimeProfile::Counter* num_hash_tables_built_by_probe_threads_ = nullptr;
+
   /// Time spent repartitioning and building hash tables of any resulting partitions
   /// that were not spilled.
   RuntimeProfile::Counter* repartition_timer_ = nullptr;
@@ -73,13 +73,24 @@ struct ScratchTupleBatch {
   // 'selected_rows[i]' would be true else false.
   boost::scoped_array<bool> selected_rows;
 
+  // Stores bool array of size 'capacity' with the results of the vectorized conjuncts
+  // of the scanner. Only valid if the scanner has vectorized conjuncts.
+  boost::scoped_array<bool> passed_vectorized_conjuncts;
+
+  // Stores bool array of size 'capacity' with the results of the dictionary row filters
+  // of the Parquet scanner. Only valid if 'has_dict_filter_results' is true.
+  boost::scoped_array<bool> passed_dict_filters;
+  bool has_dict_filter_results = false;
+
   ScratchTupleBatch(
       const RowDescriptor& row_desc, int batch_size, MemTracker* mem_tracker)
     : capacity(batch_size),
       tuple_byte_size(row_desc.GetRowSize()),
       tuple_mem_pool(mem_tracker),
       aux_mem_pool(mem_tracker),
-      selected_rows(new bool[batch_size]) {
+      selected_rows(new bool[batch_size]),
+      passed_vectorized_conjuncts(new bool[batch_size]),
+      passed_dict_filters(new bool[batch_size]) {
     DCHECK_EQ(row_desc.tuple_descriptors().size(), 1);
   }
 
@@ -87,6 +98,7 @@ struct ScratchTupleBatch {
     tuple_idx = 0;
     num_tuples = 0;
     num_tuples_transferred = 0;
+    has_dict_filter_results = false;
     if (tuple_mem == nullptr) {
       int64_t dummy;
       RETURN_IF_ERROR(RowBatch::ResizeAndAllocateTupleBuffer(
@@ -22,18 +22,35 @@
 
 using namespace impala;
 
-void SelectNode::CopyRows(RowBatch* output_batch) {
-  ScalarExprEvaluator* const* conjunct_evals = conjunct_evals_.data();
-  int num_conjuncts = conjuncts_.size();
-  DCHECK_EQ(num_conjuncts, conjunct_evals_.size());
+int SelectNode::FilterRows() {
+  ScalarExprEvaluator* const* conjunct_evals = row_conjunct_evals_.data();
+  const int num_conjuncts = row_conjunct_evals_.size();
+  int* child_sel = child_sel_.get();
+  const int num_child_selected = num_child_selected_;
 
-  FOREACH_ROW(child_row_batch_.get(), child_row_idx_, batch_iter) {
-    // Add a new row to output_batch
-    int dst_row_idx = output_batch->AddRow();
-    TupleRow* dst_row = output_batch->GetRow(dst_row_idx);
-    TupleRow* src_row = batch_iter.Get();
-    ++child_row_idx_;
+  // Compact 'child_sel' in place without branching on the result of the conjuncts.
+  int num_selected = 0;
+  for (int i = 0; i < num_child_selected; ++i) {
+    const int row_idx = child_sel[i];
+    child_sel[num_selected] = row_idx;
+    num_selected +=
+        EvalConjuncts(conjunct_evals, num_conjuncts, child_row_batch_->GetRow(row_idx));
+  }
+  return num_selected;
+}
+
+void SelectNode::FilterAndCopyRows(RowBatch* output_batch) {
+  ScalarExprEvaluator* const* conjunct_evals = row_conjunct_evals_.data();
+  int num_conjuncts = row_conjunct_evals_.size();
+  const int* child_sel = child_sel_.get();
+
+  while (child_sel_idx_ < num_child_selected_) {
+    TupleRow* src_row = child_row_batch_->GetRow(child_sel[child_sel_idx_]);
+    ++child_sel_idx_;
     if (EvalConjuncts(conjunct_evals, num_conjuncts, src_row)) {
+      // Add a new row to output_batch
+      int dst_row_idx = output_batch->AddRow();
+      TupleRow* dst_row = output_batch->GetRow(dst_row_idx);
       output_batch->CopyRow(src_row, dst_row);
       output_batch->CommitLastRow();
       IncrementNumRowsReturned(1);
@@ -17,6 +17,8 @@
 
 #include "exec/select-node.h"
 
+#include <algorithm>
+
 #include "codegen/llvm-codegen.h"
 #include "exec/exec-node-util.h"
 #include "exprs/scalar-expr-evaluator.h"
@@ -32,6 +34,17 @@
 
 namespace impala {
 
+Status SelectPlanNode::Init(const TPlanNode& tnode, FragmentState* state) {
+  RETURN_IF_ERROR(PlanNode::Init(tnode, state));
+  if (state->query_options().vectorized_conjuncts) {
+    VectorizedConjuncts::Partition(
+        conjuncts_, &vectorized_conjunct_idxs_, &row_conjuncts_);
+  } else {
+    row_conjuncts_ = conjuncts_;
+  }
+  return Status::OK();
+}
+
 Status SelectPlanNode::CreateExecNode(RuntimeState* state, ExecNode** node) const {
   ObjectPool* pool = state->obj_pool();
   *node = pool->Add(new SelectNode(pool, *this, state->desc_tbl()));
@@ -42,13 +55,23 @@ SelectNode::SelectNode(
     ObjectPool* pool, const SelectPlanNode& pnode, const DescriptorTbl& descs)
   : ExecNode(pool, pnode, descs),
     child_row_batch_(NULL),
-    child_row_idx_(0),
+    num_child_selected_(0),
+    child_sel_idx_(0),
+    child_sel_filtered_(false),
     child_eos_(false),
-    codegend_copy_rows_fn_(pnode.codegend_copy_rows_fn_) {}
+    codegend_filter_rows_fn_(pnode.codegend_filter_rows_fn_),
+    codegend_filter_and_copy_rows_fn_(pnode.codegend_filter_and_copy_rows_fn_) {}
 
 Status SelectNode::Prepare(RuntimeState* state) {
   SCOPED_TIMER(runtime_profile_->total_time_counter());
   RETURN_IF_ERROR(ExecNode::Prepare(state));
+  const SelectPlanNode& pnode = static_cast<const SelectPlanNode&>(plan_node_);
+  const vector<int>& vectorized_idxs = pnode.vectorized_conjunct_idxs_;
+  for (int i = 0; i < conjunct_evals_.size(); ++i) {
+    auto it = find(vectorized_idxs.begin(), vectorized_idxs.end(), i);
+    if (it == vectorized_idxs.end()) row_conjunct_evals_.push_back(conjunct_evals_[i]);
+  }
+  DCHECK_EQ(row_conjunct_evals_.size(), pnode.row_conjuncts_.size());
   return Status::OK();
 }
 
@@ -56,26 +79,38 @@ void SelectPlanNode::Codegen(FragmentState* state) {
   DCHECK(state->ShouldCodegen());
   PlanNode::Codegen(state);
   if (IsNodeCodegenDisabled()) return;
-  AddCodegenStatus(CodegenCopyRows(state));
+  AddCodegenStatus(CodegenFilterRows(state));
 }
 
-Status SelectPlanNode::CodegenCopyRows(FragmentState* state) {
+Status SelectPlanNode::CodegenFilterRows(FragmentState* state) {
   LlvmCodeGen* codegen = state->codegen();
   DCHECK(codegen != nullptr);
-  llvm::Function* copy_rows_fn =
-      codegen->GetFunction(IRFunction::SELECT_NODE_COPY_ROWS, true);
-  DCHECK(copy_rows_fn != nullptr);
+  llvm::Function* filter_rows_fn =
+      codegen->GetFunction(IRFunction::SELECT_NODE_FILTER_ROWS, true);
+  DCHECK(filter_rows_fn != nullptr);
+  llvm::Function* filter_and_copy_rows_fn =
+      codegen->GetFunction(IRFunction::SELECT_NODE_FILTER_AND_COPY_ROWS, true);
+  DCHECK(filter_and_copy_rows_fn != nullptr);
 
   llvm::Function* eval_conjuncts_fn;
   RETURN_IF_ERROR(
-      ExecNode::CodegenEvalConjuncts(codegen, conjuncts_, &eval_conjuncts_fn));
+      ExecNode::CodegenEvalConjuncts(codegen, row_conjuncts_, &eval_conjuncts_fn));
 
-  int replaced = codegen->ReplaceCallSites(copy_rows_fn, eval_conjuncts_fn,
+  int replaced = codegen->ReplaceCallSites(filter_rows_fn, eval_conjuncts_fn,
       "EvalConjuncts");
   DCHECK_REPLACE_COUNT(replaced, 1);
-  copy_rows_fn = codegen->FinalizeFunction(copy_rows_fn);
-  if (copy_rows_fn == nullptr) return Status("Failed to finalize CopyRows().");
-  codegen->AddFunctionToJit(copy_rows_fn, &codegend_copy_rows_fn_);
+  filter_rows_fn = codegen->FinalizeFunction(filter_rows_fn);
+  if (filter_rows_fn == nullptr) return Status("Failed to finalize FilterRows().");
+
+  replaced = codegen->ReplaceCallSites(filter_and_copy_rows_fn, eval_conjuncts_fn,
+      "EvalConjuncts");
+  DCHECK_REPLACE_COUNT(replaced, 1);
+  filter_and_copy_rows_fn = codegen->FinalizeFunction(filter_and_copy_rows_fn);
+  if (filter_and_copy_rows_fn == nullptr) {
+    return Status("Failed to finalize FilterAndCopyRows().");
+  }
+  codegen->AddFunctionToJit(filter_rows_fn, &codegend_filter_rows_fn_);
+  codegen->AddFunctionToJit(filter_and_copy_rows_fn, &codegend_filter_and_copy_rows_fn_);
   return Status::OK();
 }
 
@@ -83,9 +118,17 @@ Status SelectNode::Open(RuntimeState* state) {
   SCOPED_TIMER(runtime_profile_->total_time_counter());
   ScopedOpenEventAdder ea(this);
   RETURN_IF_ERROR(ExecNode::Open(state));
+  if (vectorized_conjuncts_.empty()) {
+    // The constants of the conjuncts are read from the opened evaluators. They don't
+    // change when the node is reopened in a subplan.
+    const SelectPlanNode& pnode = static_cast<const SelectPlanNode&>(plan_node_);
+    RETURN_IF_ERROR(vectorized_conjuncts_.Init(state, pool_, conjuncts_,
+        conjunct_evals_, pnode.vectorized_conjunct_idxs_, state->batch_size()));
+  }
   RETURN_IF_ERROR(child(0)->Open(state));
   child_row_batch_.reset(
       new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker()));
+  child_sel_.reset(new int[state->batch_size()]);
   return Status::OK();
 }
 
@@ -101,29 +144,98 @@ Status SelectNode::GetNext(RuntimeState* state, RowBatch* row_batch, bool* eos)
       // Fetch rows from child if either child row batch has been
       // consumed completely or it is empty.
       RETURN_IF_ERROR(child(0)->GetNext(state, child_row_batch_.get(), &child_eos_));
+      num_child_selected_ =
+          vectorized_conjuncts_.Filter(child_row_batch_.get(), child_sel_.get());
+      // Only build the full selection vector if it can be handed over to the consumer.
+      // Otherwise the row conjuncts are evaluated while copying the rows.
+      child_sel_filtered_ = row_batch->selection_allowed();
+      if (child_sel_filtered_ && !row_conjunct_evals_.empty()) {
+        num_child_selected_ = FilterRowsCodegenOrInterpret();
+      }
     }
 
-    SelectPlanNode::CopyRowsFn copy_rows_fn = codegend_copy_rows_fn_.load();
-    if (copy_rows_fn != nullptr) {
-      copy_rows_fn(this, row_batch);
-    } else {
+    if (CanPassThroughSelection(row_batch)) {
+      RETURN_IF_ERROR(PassThroughSelection(row_batch));
+    } else if (child_sel_filtered_) {
       CopyRows(row_batch);
+    } else {
+      SelectPlanNode::FilterAndCopyRowsFn filter_and_copy_rows_fn =
+          codegend_filter_and_copy_rows_fn_.load();
+      if (filter_and_copy_rows_fn != nullptr) {
+        filter_and_copy_rows_fn(this, row_batch);
+      } else {
+        FilterAndCopyRows(row_batch);
+      }
     }
     COUNTER_SET(rows_returned_counter_, rows_returned());
-    *eos = ReachedLimit()
-        || (child_row_idx_ == child_row_batch_->num_rows() && child_eos_);
-    if (*eos || child_row_idx_ == child_row_batch_->num_rows()) {
-      child_row_idx_ = 0;
+    *eos = ReachedLimit() || (child_sel_idx_ == num_child_selected_ && child_eos_);
+    if (*eos || child_sel_idx_ == num_child_selected_) {
+      child_sel_idx_ = 0;
+      num_child_selected_ = 0;
       child_row_batch_->TransferResourceOwnership(row_batch);
       child_row_batch_->Reset();
     }
-  } while (!*eos && !row_batch->AtCapacity());
+    // No rows can be added to a batch with a selection vector.
+  } while (!*eos && !row_batch->AtCapacity() && !row_batch->has_selection());
+  return Status::OK();
+}
+
+int SelectNode::FilterRowsCodegenOrInterpret() {
+  SelectPlanNode::FilterRowsFn filter_rows_fn = codegend_filter_rows_fn_.load();
+  if (filter_rows_fn != nullptr) return filter_rows_fn(this);
+  return FilterRows();
+}
+
+void SelectNode::CopyRows(RowBatch* output_batch) {
+  const int* child_sel = child_sel_.get();
+  while (child_sel_idx_ < num_child_selected_) {
+    TupleRow* src_row = child_row_batch_->GetRow(child_sel[child_sel_idx_]);
+    ++child_sel_idx_;
+    int dst_row_idx = output_batch->AddRow();
+    output_batch->CopyRow(src_row, output_batch->GetRow(dst_row_idx));
+    output_batch->CommitLastRow();
+    IncrementNumRowsReturned(1);
+    if (ReachedLimit() || output_batch->AtCapacity()) return;
+  }
+}
+
+bool SelectNode::CanPassThroughSelection(RowBatch* output_batch) const {
+  // The child batch must not be partially consumed and its state can only be moved to
+  // an empty batch without attached buffers and with the same capacity.
+  return output_batch->selection_allowed() && child_sel_filtered_ && child_sel_idx_ == 0
+      && num_child_selected_ > 0
+      && num_child_selected_ * MIN_SELECTION_DENSITY >= child_row_batch_->num_rows()
+      && output_batch->num_rows() == 0 && output_batch->num_buffers() == 0
+      && output_batch->InitialCapacity() == child_row_batch_->InitialCapacity();
+}
+
+Status SelectNode::PassThroughSelection(RowBatch* output_batch) {
+  int num_selected = num_child_selected_;
+  if (limit_ != -1) {
+    num_selected = min<int64_t>(num_selected, limit_ - rows_returned());
+  }
+  DCHECK_GT(num_selected, 0);
+  if (num_selected < child_row_batch_->num_rows()) {
+    // Allocate the selection vector before the rows are moved so that nothing is lost
+    // if the allocation fails.
+    int* selection;
+    RETURN_IF_ERROR(output_batch->GetSelectionBuffer(&selection));
+    memcpy(selection, child_sel_.get(), num_selected * sizeof(int));
+    output_batch->AcquireState(child_row_batch_.get());
+    output_batch->SetSelection(num_selected);
+  } else {
+    output_batch->AcquireState(child_row_batch_.get());
+  }
+  child_sel_idx_ = num_child_selected_;
+  IncrementNumRowsReturned(num_selected);
   return Status::OK();
 }
 
 Status SelectNode::Reset(RuntimeState* state, RowBatch* row_batch) {
   child_row_batch_->TransferResourceOwnership(row_batch);
-  child_row_idx_ = 0;
+  num_child_selected_ = 0;
+  child_sel_idx_ = 0;
+  child_sel_filtered_ = false;
   child_eos_ = false;
   return ExecNode::Reset(state, row_batch);
 }
@@ -131,6 +243,7 @@ Status SelectNode::Reset(RuntimeState* state, RowBatch* row_batch) {
 void SelectNode::Close(RuntimeState* state) {
   if (is_closed()) return;
   child_row_batch_.reset();
+  child_sel_.reset();
   ExecNode::Close(state);
 }
 
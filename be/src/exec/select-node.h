@@ -23,6 +23,7 @@
 
 #include "codegen/codegen-fn-ptr.h"
 #include "exec/exec-node.h"
+#include "exprs/vectorized-conjuncts.h"
 #include "runtime/mem-pool.h"
 
 namespace impala {
@@ -33,22 +34,41 @@ class TupleRow;
 
 class SelectPlanNode : public PlanNode {
  public:
+  virtual Status Init(const TPlanNode& tnode, FragmentState* state) override;
   virtual Status CreateExecNode(RuntimeState* state, ExecNode** node) const override;
   virtual void Codegen(FragmentState* state) override;
 
   ~SelectPlanNode(){}
 
-  /// Codegened version of SelectNode::CopyRows().
-  typedef void (*CopyRowsFn)(SelectNode*, RowBatch*);
-  CodegenFnPtr<CopyRowsFn> codegend_copy_rows_fn_;
+  /// Codegened version of SelectNode::FilterRows().
+  typedef int (*FilterRowsFn)(SelectNode*);
+  CodegenFnPtr<FilterRowsFn> codegend_filter_rows_fn_;
+
+  /// Codegened version of SelectNode::FilterAndCopyRows().
+  typedef void (*FilterAndCopyRowsFn)(SelectNode*, RowBatch*);
+  CodegenFnPtr<FilterAndCopyRowsFn> codegend_filter_and_copy_rows_fn_;
+
+  /// Indices into 'conjuncts_' of the conjuncts that are evaluated batch-at-a-time by
+  /// VectorizedConjuncts. Empty unless the VECTORIZED_CONJUNCTS query option is set.
+  std::vector<int> vectorized_conjunct_idxs_;
+
+  /// The other conjuncts, which are evaluated row by row in FilterRows() or
+  /// FilterAndCopyRows().
+  std::vector<ScalarExpr*> row_conjuncts_;
 
  private:
-  /// Codegen SelectNode::CopyRows().
-  Status CodegenCopyRows(FragmentState* state);
+  /// Codegen SelectNode::FilterRows() and SelectNode::FilterAndCopyRows().
+  Status CodegenFilterRows(FragmentState* state);
 };
 
 /// Node that evaluates conjuncts and enforces a limit but otherwise passes along
 /// the rows pulled from its child unchanged.
+///
+/// The row conjuncts are evaluated while copying the rows of each child batch to the
+/// output batch. If the consumer allows selection vectors in the output batch (see
+/// RowBatch::set_selection_allowed()), the rows that pass the conjuncts are instead
+/// collected in a selection vector first, and the child batch is handed over as the
+/// output batch with the selection vector attached, which avoids copying the rows.
 
 class SelectNode : public ExecNode {
  public:
@@ -67,8 +87,19 @@ class SelectNode : public ExecNode {
   /// current row batch of child
   boost::scoped_ptr<RowBatch> child_row_batch_;
 
-  /// index of current row in child_row_batch_
-  int child_row_idx_;
+  /// Indices of the rows of child_row_batch_ that passed the vectorized conjuncts and,
+  /// if 'child_sel_filtered_' is true, the row conjuncts. Has room for a full child row
+  /// batch.
+  std::unique_ptr<int[]> child_sel_;
+
+  /// Number of valid entries in 'child_sel_'.
+  int num_child_selected_;
+
+  /// index of the next entry of 'child_sel_' to process
+  int child_sel_idx_;
+
+  /// True if the row conjuncts were already applied to 'child_sel_' by FilterRows().
+  bool child_sel_filtered_;
 
   /// true if last GetNext() call on child signalled eos
   bool child_eos_;
@@ -78,11 +109,46 @@ class SelectNode : public ExecNode {
 
   /// Reference to the codegened function pointer owned by the SelectPlanNode object that
   /// was used to create this instance.
-  const CodegenFnPtr<SelectPlanNode::CopyRowsFn>& codegend_copy_rows_fn_;
+  const CodegenFnPtr<SelectPlanNode::FilterRowsFn>& codegend_filter_rows_fn_;
+  const CodegenFnPtr<SelectPlanNode::FilterAndCopyRowsFn>&
+      codegend_filter_and_copy_rows_fn_;
+
+  /// Evaluates the plan node's 'vectorized_conjunct_idxs_'. Initialized in Open().
+  VectorizedConjuncts vectorized_conjuncts_;
 
-  /// Copy rows from child_row_batch_ for which conjuncts_ evaluate to true to
-  /// output_batch, up to limit_ or till the output row batch reaches capacity.
+  /// Evaluators of the plan node's 'row_conjuncts_'. Subset of 'conjunct_evals_'.
+  std::vector<ScalarExprEvaluator*> row_conjunct_evals_;
+
+  /// A child batch is only handed over with a selection vector if at least
+  /// 1/MIN_SELECTION_DENSITY of its rows are selected. Sparser batches are compacted so
+  /// that the consumer does not have to process many nearly empty batches.
+  static const int MIN_SELECTION_DENSITY = 4;
+
+  /// Evaluates the row conjuncts on the rows in 'child_sel_' and removes the rows for
+  /// which they are not true from 'child_sel_'. Returns the number of remaining rows.
+  int FilterRows();
+
+  /// Calls the codegen'd FilterRows() if available, otherwise the interpreted one.
+  int FilterRowsCodegenOrInterpret();
+
+  /// Copy the rows in 'child_sel_' starting at 'child_sel_idx_' for which the row
+  /// conjuncts evaluate to true to output_batch, up to limit_ or till the output row
+  /// batch reaches capacity.
+  void FilterAndCopyRows(RowBatch* output_batch);
+
+  /// Copy the rows in 'child_sel_' starting at 'child_sel_idx_' to output_batch, up to
+  /// limit_ or till the output row batch reaches capacity. Only used if
+  /// 'child_sel_filtered_' is true.
   void CopyRows(RowBatch* output_batch);
+
+  /// Returns true if the current child batch can be handed over to 'output_batch' with
+  /// PassThroughSelection().
+  bool CanPassThroughSelection(RowBatch* output_batch) const;
+
+  /// Moves the rows of the current child batch to 'output_batch', which must be empty,
+  /// and attaches the rows in 'child_sel_', up to limit_, as its selection vector.
+  /// Returns an error if the selection vector can't be allocated.
+  Status PassThroughSelection(RowBatch* output_batch);
 };
 
 }
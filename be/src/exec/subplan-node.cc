@@ -120,6 +120,8 @@ Status SubplanNode::GetNext(RuntimeState* state, RowBatch* row_batch, bool* eos)
         // Continue fetching rows from the open subplan into the output row_batch.
         DCHECK(!row_batch->AtCapacity());
         RETURN_IF_ERROR(child(1)->GetNext(state, row_batch, &subplan_eos_));
+        // More rows may be appended to 'row_batch' below.
+        row_batch->CompactSelection();
         // Apply limit and check whether the output batch is at capacity.
         if (limit_ != -1 && rows_returned() + row_batch->num_rows() >= limit_) {
           row_batch->set_num_rows(limit_ - rows_returned());
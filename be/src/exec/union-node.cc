@@ -200,6 +200,8 @@ Status UnionNode::GetNextPassThrough(RuntimeState* state, RowBatch* row_batch) {
   if (child_eos_) RETURN_IF_ERROR(child(child_idx_)->Open(state));
   DCHECK_EQ(row_batch->num_rows(), 0);
   RETURN_IF_ERROR(child(child_idx_)->GetNext(state, row_batch, &child_eos_));
+  // The rows are counted and truncated to the limit by the caller.
+  row_batch->CompactSelection();
   if (child_eos_) {
     // Even though the child is at eos, it's not OK to Close() it here. Once we close
     // the child, the row batches that it produced are invalid. Marking the batch as
@@ -67,6 +67,9 @@ class Expr {
  public:
   const std::string& function_name() const { return fn_.name.function_name; }
 
+  /// Returns true if 'fn_' is an Impala builtin rather than a UDF.
+  bool IsBuiltinFn() const { return fn_.binary_type == TFunctionBinaryType::BUILTIN; }
+
   virtual ~Expr();
 
   /// Returns true if the given Expr is an AggFn. Overridden by AggFn.
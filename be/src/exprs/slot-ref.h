@@ -60,6 +60,13 @@ class SlotRef : public ScalarExpr {
   static const char* LLVM_CLASS_NAME;
   NullIndicatorOffset GetNullIndicatorOffset() const { return null_indicator_offset_; }
   int GetSlotOffset() const { return slot_offset_; }
+  int GetTupleIdx() const { return tuple_idx_; }
+
+  /// Returns true if the slot is a field of a struct slot. Such slots are located in
+  /// the tuple of the struct's top-level slot.
+  bool IsStructField() const {
+    return slot_desc_ != nullptr && slot_desc_->parent()->isTupleOfStructSlot();
+  }
   virtual const TupleDescriptor* GetCollectionTupleDesc() const override;
 
  protected:
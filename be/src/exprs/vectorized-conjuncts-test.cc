@@ -0,0 +1,333 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+
+#include "common/object-pool.h"
+#include "exprs/vectorized-conjuncts.h"
+#include "runtime/tuple.h"
+#include "testutil/gtest-util.h"
+
+#include "common/names.h"
+
+namespace impala {
+
+typedef VectorizedPredicate::Op Op;
+typedef VectorizedPredicate::ArithOp ArithOp;
+
+/// Tests the VectorizedPredicates against a row-at-a-time evaluation of the same
+/// predicate. The rows have two tuples: the first one is never NULL, the second one is
+/// NULL in some rows. Both tuples have a nullable slot at offset 8, whose null indicator
+/// is the first bit of the tuple.
+class VectorizedPredicateTest : public testing::Test {
+ protected:
+  static const int NUM_ROWS = 1000;
+  static const int TUPLE_SIZE = 16;
+  static const int SLOT_OFFSET = 8;
+
+  /// Row-at-a-time version of a predicate. Returns false if the predicate is false or
+  /// NULL for the slot value 'value', which is 'is_null' if it is NULL.
+  template <typename S>
+  using RowPredicate = std::function<bool(S value, bool is_null)>;
+
+  ObjectPool pool_;
+  std::mt19937 rng_{1234};
+
+  vector<uint8_t> tuple_mem_;
+  vector<Tuple*> tuple_ptrs_;
+
+  /// Fills the slots of the tuples with 'values'. Every fifth slot is NULL and every
+  /// seventh tuple of the second tuple index is NULL.
+  template <typename S>
+  void InitRows(const vector<S>& values) {
+    DCHECK_EQ(values.size(), NUM_ROWS);
+    tuple_mem_.assign(2 * NUM_ROWS * TUPLE_SIZE, 0);
+    tuple_ptrs_.resize(2 * NUM_ROWS);
+    for (int i = 0; i < 2 * NUM_ROWS; ++i) {
+      Tuple* tuple = reinterpret_cast<Tuple*>(tuple_mem_.data() + i * TUPLE_SIZE);
+      int row = i / 2;
+      if (row % 5 == 0) {
+        tuple->SetNull(NullIndicatorOffset(0, 0));
+      } else {
+        *reinterpret_cast<S*>(tuple->GetSlot(SLOT_OFFSET)) = values[row];
+      }
+      bool null_tuple = i % 2 == 1 && row % 7 == 0;
+      tuple_ptrs_[i] = null_tuple ? nullptr : tuple;
+    }
+  }
+
+  template <typename S>
+  vector<S> RandomValues(S min, S max) {
+    vector<S> values;
+    for (int i = 0; i < NUM_ROWS; ++i) {
+      double r = std::uniform_real_distribution<double>(0, 1)(rng_);
+      double range = static_cast<double>(max) - static_cast<double>(min);
+      values.push_back(static_cast<S>(static_cast<double>(min) + r * range));
+    }
+    return values;
+  }
+
+  VectorizedPredicate::Column MakeColumn(int tuple_idx, const ColumnType& slot_type,
+      const ColumnType& compute_type) {
+    VectorizedPredicate::Column col;
+    col.tuple_idx = tuple_idx;
+    col.slot_offset = SLOT_OFFSET;
+    col.null_indicator = NullIndicatorOffset(0, 0);
+    col.slot_type = slot_type;
+    col.compute_type = compute_type;
+    return col;
+  }
+
+  /// Evaluates 'pred' on the rows in 'sel' and checks that the result matches 'expected'
+  /// on the same rows.
+  template <typename S>
+  void CheckFilter(const VectorizedPredicate::Column& col, VectorizedPredicate* pred,
+      const RowPredicate<S>& expected, const vector<int>& sel) {
+    vector<int> expected_sel;
+    for (int row : sel) {
+      const Tuple* tuple = tuple_ptrs_[row * 2 + col.tuple_idx];
+      bool is_null = tuple == nullptr || tuple->IsNull(col.null_indicator);
+      S value = is_null ? S() : *reinterpret_cast<const S*>(tuple->GetSlot(SLOT_OFFSET));
+      if (expected(value, is_null)) expected_sel.push_back(row);
+    }
+    vector<int> actual_sel(sel);
+    int num_selected = pred->Filter(tuple_ptrs_.data(), 2, actual_sel.data(), sel.size());
+    actual_sel.resize(num_selected);
+    EXPECT_EQ(expected_sel, actual_sel);
+  }
+
+  /// Checks 'pred' on all rows and on a selection vector of a third of the rows.
+  template <typename S>
+  void CheckFilter(const VectorizedPredicate::Column& col, VectorizedPredicate* pred,
+      const RowPredicate<S>& expected) {
+    vector<int> all_rows;
+    vector<int> some_rows;
+    for (int i = 0; i < NUM_ROWS; ++i) {
+      all_rows.push_back(i);
+      if (i % 3 != 1) some_rows.push_back(i);
+    }
+    CheckFilter<S>(col, pred, expected, all_rows);
+    CheckFilter<S>(col, pred, expected, some_rows);
+  }
+
+  /// Checks the comparisons of a slot of type 'S' with 'c' for all comparison ops.
+  /// 'T' is the compute type.
+  template <typename S, typename T>
+  void TestCompare(const ColumnType& slot_type, const ColumnType& compute_type,
+      const VectorizedPredicate::Value& c, T c_val) {
+    const Op ops[] = {Op::EQ, Op::NE, Op::LT, Op::LE, Op::GT, Op::GE};
+    for (Op op : ops) {
+      for (int tuple_idx = 0; tuple_idx < 2; ++tuple_idx) {
+        VectorizedPredicate::Column col = MakeColumn(tuple_idx, slot_type, compute_type);
+        VectorizedPredicate* pred =
+            VectorizedPredicate::CreateCompare(&pool_, col, op, c, NUM_ROWS);
+        CheckFilter<S>(col, pred, [op, c_val](S value, bool is_null) {
+          if (is_null) return false;
+          T v = static_cast<T>(value);
+          switch (op) {
+            case Op::EQ: return v == c_val;
+            case Op::NE: return v != c_val;
+            case Op::LT: return v < c_val;
+            case Op::LE: return v <= c_val;
+            case Op::GT: return v > c_val;
+            case Op::GE: return v >= c_val;
+            default: return false;
+          }
+        });
+      }
+    }
+  }
+};
+
+static VectorizedPredicate::Value IntValue(int64_t i) {
+  VectorizedPredicate::Value v;
+  v.i = i;
+  return v;
+}
+
+static VectorizedPredicate::Value DoubleValue(double d) {
+  VectorizedPredicate::Value v;
+  v.d = d;
+  return v;
+}
+
+TEST_F(VectorizedPredicateTest, CompareInt) {
+  InitRows<int32_t>(RandomValues<int32_t>(-50, 50));
+  ColumnType type(TYPE_INT);
+  for (int c : {-51, -7, 0, 13, 50}) {
+    TestCompare<int32_t, int32_t>(type, type, IntValue(c), c);
+  }
+}
+
+TEST_F(VectorizedPredicateTest, CompareWidenedTinyInt) {
+  InitRows<int8_t>(RandomValues<int8_t>(-128, 127));
+  TestCompare<int8_t, int32_t>(
+      ColumnType(TYPE_TINYINT), ColumnType(TYPE_TINYINT), IntValue(-3), -3);
+  TestCompare<int8_t, int64_t>(
+      ColumnType(TYPE_TINYINT), ColumnType(TYPE_BIGINT), IntValue(100), 100);
+  TestCompare<int8_t, double>(
+      ColumnType(TYPE_TINYINT), ColumnType(TYPE_DOUBLE), DoubleValue(2.5), 2.5);
+}
+
+TEST_F(VectorizedPredicateTest, CompareBigInt) {
+  const int64_t max = std::numeric_limits<int64_t>::max() / 2;
+  InitRows<int64_t>(RandomValues<int64_t>(-max, max));
+  ColumnType type(TYPE_BIGINT);
+  TestCompare<int64_t, int64_t>(type, type, IntValue(0), 0);
+  TestCompare<int64_t, int64_t>(type, type, IntValue(max / 3), max / 3);
+}
+
+TEST_F(VectorizedPredicateTest, CompareDecimalAndDate) {
+  InitRows<int32_t>(RandomValues<int32_t>(-99999, 99999));
+  ColumnType decimal_type = ColumnType::CreateDecimalType(9, 2);
+  TestCompare<int32_t, int32_t>(decimal_type, decimal_type, IntValue(1234), 1234);
+  ColumnType date_type(TYPE_DATE);
+  TestCompare<int32_t, int32_t>(date_type, date_type, IntValue(-17), -17);
+}
+
+TEST_F(VectorizedPredicateTest, CompareFloatingPoint) {
+  vector<float> values = RandomValues<float>(-10, 10);
+  for (int i = 0; i < values.size(); i += 11) {
+    values[i] = std::numeric_limits<float>::quiet_NaN();
+  }
+  InitRows<float>(values);
+  ColumnType float_type(TYPE_FLOAT);
+  TestCompare<float, float>(float_type, float_type, DoubleValue(0.5), 0.5f);
+  TestCompare<float, double>(
+      float_type, ColumnType(TYPE_DOUBLE), DoubleValue(-1.25), -1.25);
+  TestCompare<float, float>(float_type, float_type,
+      DoubleValue(std::numeric_limits<double>::quiet_NaN()),
+      std::numeric_limits<float>::quiet_NaN());
+
+  vector<double> double_values = RandomValues<double>(-1e10, 1e10);
+  double_values[3] = std::numeric_limits<double>::quiet_NaN();
+  InitRows<double>(double_values);
+  ColumnType double_type(TYPE_DOUBLE);
+  TestCompare<double, double>(double_type, double_type, DoubleValue(1e9), 1e9);
+}
+
+// Arithmetic on BIGINT wraps around on overflow.
+TEST_F(VectorizedPredicateTest, Arithmetic) {
+  const int64_t max = std::numeric_limits<int64_t>::max();
+  InitRows<int32_t>(RandomValues<int32_t>(-1000, 1000));
+  VectorizedPredicate::Column col =
+      MakeColumn(0, ColumnType(TYPE_INT), ColumnType(TYPE_BIGINT));
+  // (100 - (col * 3)) + max > 0
+  col.steps.push_back({ArithOp::MULTIPLY, false, IntValue(3)});
+  col.steps.push_back({ArithOp::SUBTRACT, true, IntValue(100)});
+  col.steps.push_back({ArithOp::ADD, false, IntValue(max)});
+  VectorizedPredicate* pred =
+      VectorizedPredicate::CreateCompare(&pool_, col, Op::GT, IntValue(0), NUM_ROWS);
+  CheckFilter<int32_t>(col, pred, [max](int32_t value, bool is_null) {
+    if (is_null) return false;
+    uint64_t v = 100 - static_cast<uint64_t>(value) * 3 + static_cast<uint64_t>(max);
+    return static_cast<int64_t>(v) > 0;
+  });
+
+  InitRows<double>(RandomValues<double>(-10, 10));
+  col = MakeColumn(1, ColumnType(TYPE_DOUBLE), ColumnType(TYPE_DOUBLE));
+  // col - 0.5 <= 2.0
+  col.steps.push_back({ArithOp::SUBTRACT, false, DoubleValue(0.5)});
+  pred = VectorizedPredicate::CreateCompare(
+      &pool_, col, Op::LE, DoubleValue(2), NUM_ROWS);
+  CheckFilter<double>(col, pred, [](double value, bool is_null) {
+    return !is_null && value - 0.5 <= 2.0;
+  });
+}
+
+TEST_F(VectorizedPredicateTest, InList) {
+  InitRows<int64_t>(RandomValues<int64_t>(0, 40));
+  ColumnType type(TYPE_BIGINT);
+  for (int list_size : {1, 3, 8, 9, 30}) {
+    vector<VectorizedPredicate::Value> list;
+    vector<int64_t> list_vals;
+    for (int i = 0; i < list_size; ++i) {
+      int64_t v = (i * 7) % 45;
+      list.push_back(IntValue(v));
+      list_vals.push_back(v);
+    }
+    for (bool not_in : {false, true}) {
+      VectorizedPredicate::Column col = MakeColumn(1, type, type);
+      VectorizedPredicate* pred =
+          VectorizedPredicate::CreateInList(&pool_, col, not_in, list, NUM_ROWS);
+      CheckFilter<int64_t>(col, pred, [&](int64_t value, bool is_null) {
+        if (is_null) return false;
+        bool found =
+            std::find(list_vals.begin(), list_vals.end(), value) != list_vals.end();
+        return found != not_in;
+      });
+    }
+  }
+}
+
+TEST_F(VectorizedPredicateTest, IsNull) {
+  InitRows<int32_t>(RandomValues<int32_t>(0, 10));
+  for (int tuple_idx = 0; tuple_idx < 2; ++tuple_idx) {
+    // The slot type does not matter for IS NULL.
+    VectorizedPredicate::Column col =
+        MakeColumn(tuple_idx, ColumnType(TYPE_STRING), ColumnType(TYPE_STRING));
+    for (bool is_not_null : {false, true}) {
+      VectorizedPredicate* pred =
+          VectorizedPredicate::CreateIsNull(&pool_, col, is_not_null);
+      CheckFilter<int32_t>(col, pred, [is_not_null](int32_t value, bool is_null) {
+        return is_null != is_not_null;
+      });
+    }
+  }
+}
+
+TEST_F(VectorizedPredicateTest, AlwaysFalse) {
+  InitRows<int32_t>(RandomValues<int32_t>(0, 10));
+  VectorizedPredicate::Column col =
+      MakeColumn(0, ColumnType(TYPE_INT), ColumnType(TYPE_INT));
+  CheckFilter<int32_t>(col, VectorizedPredicate::CreateAlwaysFalse(&pool_),
+      [](int32_t value, bool is_null) { return false; });
+}
+
+TEST_F(VectorizedPredicateTest, SupportedColumns) {
+  ColumnType tinyint_type(TYPE_TINYINT);
+  ColumnType int_type(TYPE_INT);
+  ColumnType bigint_type(TYPE_BIGINT);
+  ColumnType float_type(TYPE_FLOAT);
+  ColumnType double_type(TYPE_DOUBLE);
+  EXPECT_TRUE(VectorizedPredicate::IsSupportedColumn(int_type, int_type, false));
+  EXPECT_TRUE(VectorizedPredicate::IsSupportedColumn(tinyint_type, int_type, false));
+  EXPECT_TRUE(VectorizedPredicate::IsSupportedColumn(int_type, bigint_type, true));
+  EXPECT_TRUE(VectorizedPredicate::IsSupportedColumn(float_type, double_type, true));
+  EXPECT_TRUE(VectorizedPredicate::IsSupportedColumn(
+      ColumnType::CreateDecimalType(18, 4), ColumnType::CreateDecimalType(18, 4), false));
+  // Arithmetic is only supported on BIGINT and DOUBLE.
+  EXPECT_FALSE(VectorizedPredicate::IsSupportedColumn(int_type, int_type, true));
+  EXPECT_FALSE(VectorizedPredicate::IsSupportedColumn(float_type, float_type, true));
+  // Narrowing and lossy casts are not supported.
+  EXPECT_FALSE(VectorizedPredicate::IsSupportedColumn(bigint_type, int_type, false));
+  EXPECT_FALSE(VectorizedPredicate::IsSupportedColumn(int_type, float_type, false));
+  EXPECT_FALSE(VectorizedPredicate::IsSupportedColumn(double_type, float_type, false));
+  // Unsupported slot types.
+  EXPECT_FALSE(VectorizedPredicate::IsSupportedColumn(
+      ColumnType::CreateDecimalType(38, 4), ColumnType::CreateDecimalType(38, 4), false));
+  EXPECT_FALSE(VectorizedPredicate::IsSupportedColumn(
+      ColumnType(TYPE_STRING), ColumnType(TYPE_STRING), false));
+  EXPECT_FALSE(VectorizedPredicate::IsSupportedColumn(
+      ColumnType(TYPE_TIMESTAMP), ColumnType(TYPE_TIMESTAMP), false));
+}
+
+}
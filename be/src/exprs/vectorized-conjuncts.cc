@@ -0,0 +1,803 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exprs/vectorized-conjuncts.h"
+
+#include <algorithm>
+
+#include "common/object-pool.h"
+#include "exprs/scalar-expr-evaluator.h"
+#include "exprs/scalar-expr.h"
+#include "exprs/slot-ref.h"
+#include "runtime/row-batch.h"
+#include "runtime/tuple.h"
+#include "util/bit-util.h"
+#include "util/sse-util.h"
+
+#include "common/names.h"
+
+namespace impala {
+
+typedef VectorizedPredicate::Op Op;
+typedef VectorizedPredicate::ArithOp ArithOp;
+
+namespace {
+
+/// Number of values that are compared at a time. Must fit into the bits of a uint32_t
+/// and match the number of null bytes loaded into one SSE register.
+const int BLOCK_SIZE = 16;
+
+/// IN lists with up to this many values are evaluated by comparing the values with every
+/// list entry. Longer lists are searched with a binary search.
+const int MAX_SIMD_IN_LIST_SIZE = 8;
+
+/// The representations of the slot types in a tuple.
+enum class PhysicalType { INVALID, INT8, INT16, INT32, INT64, FLOAT, DOUBLE };
+
+PhysicalType GetPhysicalType(const ColumnType& type) {
+  switch (type.type) {
+    case TYPE_TINYINT: return PhysicalType::INT8;
+    case TYPE_SMALLINT: return PhysicalType::INT16;
+    case TYPE_INT:
+    case TYPE_DATE:
+      return PhysicalType::INT32;
+    case TYPE_BIGINT: return PhysicalType::INT64;
+    case TYPE_FLOAT: return PhysicalType::FLOAT;
+    case TYPE_DOUBLE: return PhysicalType::DOUBLE;
+    case TYPE_DECIMAL:
+      switch (type.GetByteSize()) {
+        case 4: return PhysicalType::INT32;
+        case 8: return PhysicalType::INT64;
+        default: return PhysicalType::INVALID;
+      }
+    default: return PhysicalType::INVALID;
+  }
+}
+
+bool IsIntegerType(const ColumnType& type) {
+  return type.type == TYPE_TINYINT || type.type == TYPE_SMALLINT
+      || type.type == TYPE_INT || type.type == TYPE_BIGINT;
+}
+
+/// Returns the mask of the null bytes 'nulls[0, BLOCK_SIZE)', which are either 0 or
+/// 0xFF.
+inline uint32_t NullMask(const uint8_t* nulls) {
+  return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(nulls)));
+}
+
+/// Appends the entries of 'block_sel' whose bits are set in 'mask' to 'sel', starting
+/// at 'num_out'. Returns the new number of entries in 'sel'. 'sel' and 'block_sel' may
+/// point into the same selection vector as long as 'block_sel' does not start before
+/// 'sel + num_out'.
+inline int Compact(uint32_t mask, const int* block_sel, int* sel, int num_out) {
+  while (mask != 0) {
+    sel[num_out++] = block_sel[BitUtil::CountTrailingZeros(mask)];
+    mask &= mask - 1;
+  }
+  return num_out;
+}
+
+template <typename T>
+inline T FromValue(const VectorizedPredicate::Value& v) {
+  return static_cast<T>(v.i);
+}
+
+template <>
+inline float FromValue<float>(const VectorizedPredicate::Value& v) {
+  return static_cast<float>(v.d);
+}
+
+template <>
+inline double FromValue<double>(const VectorizedPredicate::Value& v) {
+  return v.d;
+}
+
+template <typename T, Op OP>
+inline bool CompareValue(T v, T c) {
+  switch (OP) {
+    case Op::EQ: return v == c;
+    case Op::NE: return v != c;
+    case Op::LT: return v < c;
+    case Op::LE: return v <= c;
+    case Op::GT: return v > c;
+    case Op::GE: return v >= c;
+    default: DCHECK(false); return false;
+  }
+}
+
+/// Compares BLOCK_SIZE values with a constant. Returns a mask with bit 'j' set if
+/// 'values[j] OP c' is true. The generic version is left to the compiler to vectorize:
+/// SSE2 has no 64-bit integer comparisons, and sse2neon does not implement the double
+/// comparisons.
+template <typename T, Op OP>
+struct BlockComparator {
+  static inline uint32_t Compare(const T* values, T c) {
+    uint32_t mask = 0;
+    for (int j = 0; j < BLOCK_SIZE; ++j) {
+      mask |= static_cast<uint32_t>(CompareValue<T, OP>(values[j], c)) << j;
+    }
+    return mask;
+  }
+};
+
+template <Op OP>
+struct BlockComparator<int32_t, OP> {
+  static inline uint32_t Compare(const int32_t* values, int32_t c) {
+    const __m128i cv = _mm_set1_epi32(c);
+    uint32_t mask = 0;
+    for (int j = 0; j < BLOCK_SIZE; j += 4) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + j));
+      mask |= static_cast<uint32_t>(CompareLanes(v, cv)) << j;
+    }
+    return mask;
+  }
+
+  /// Returns the 4-bit mask of the lanes of 'v' for which 'v OP c' is true.
+  static inline int CompareLanes(__m128i v, __m128i c) {
+    switch (OP) {
+      case Op::EQ: return MoveMask(_mm_cmpeq_epi32(v, c));
+      case Op::NE: return MoveMask(_mm_cmpeq_epi32(v, c)) ^ 0xF;
+      case Op::LT: return MoveMask(_mm_cmpgt_epi32(c, v));
+      case Op::LE: return MoveMask(_mm_cmpgt_epi32(v, c)) ^ 0xF;
+      case Op::GT: return MoveMask(_mm_cmpgt_epi32(v, c));
+      case Op::GE: return MoveMask(_mm_cmpgt_epi32(c, v)) ^ 0xF;
+      default: DCHECK(false); return 0;
+    }
+  }
+
+  static inline int MoveMask(__m128i lanes) {
+    return _mm_movemask_ps(_mm_castsi128_ps(lanes));
+  }
+};
+
+template <Op OP>
+struct BlockComparator<float, OP> {
+  static inline uint32_t Compare(const float* values, float c) {
+    const __m128 cv = _mm_set1_ps(c);
+    uint32_t mask = 0;
+    for (int j = 0; j < BLOCK_SIZE; j += 4) {
+      __m128 v = _mm_loadu_ps(values + j);
+      mask |= static_cast<uint32_t>(_mm_movemask_ps(CompareLanes(v, cv))) << j;
+    }
+    return mask;
+  }
+
+  /// The ordered comparisons are false and _mm_cmpneq_ps() is true if either value is
+  /// NaN, like the C++ operators used by the row-at-a-time comparisons.
+  static inline __m128 CompareLanes(__m128 v, __m128 c) {
+    switch (OP) {
+      case Op::EQ: return _mm_cmpeq_ps(v, c);
+      case Op::NE: return _mm_cmpneq_ps(v, c);
+      case Op::LT: return _mm_cmplt_ps(v, c);
+      case Op::LE: return _mm_cmple_ps(v, c);
+      case Op::GT: return _mm_cmpgt_ps(v, c);
+      case Op::GE: return _mm_cmpge_ps(v, c);
+      default: DCHECK(false); return v;
+    }
+  }
+};
+
+/// Gathers the values of the slot described by 'col' of the rows in 'sel[0, n)' into
+/// 'values', converted from the slot's type 'S' to the compute type 'T'. Sets
+/// 'nulls[k]' to 0xFF if the value of row 'sel[k]' is NULL and to 0 otherwise. NULL
+/// values are stored as 0 so that arithmetic on them is harmless.
+template <typename S, typename T>
+void Gather(const VectorizedPredicate::Column& col, Tuple* const* tuples,
+    int num_tuples_per_row, const int* sel, int n, T* values, uint8_t* nulls) {
+  const int tuple_idx = col.tuple_idx;
+  const int slot_offset = col.slot_offset;
+  const NullIndicatorOffset null_indicator = col.null_indicator;
+  for (int k = 0; k < n; ++k) {
+    const Tuple* tuple = tuples[sel[k] * num_tuples_per_row + tuple_idx];
+    if (tuple == nullptr || tuple->IsNull(null_indicator)) {
+      nulls[k] = 0xFF;
+      values[k] = 0;
+    } else {
+      nulls[k] = 0;
+      const S* slot = reinterpret_cast<const S*>(tuple->GetSlot(slot_offset));
+      values[k] = static_cast<T>(*slot);
+    }
+  }
+}
+
+template <typename T>
+using GatherFn = void (*)(const VectorizedPredicate::Column&, Tuple* const*, int,
+    const int*, int, T*, uint8_t*);
+
+template <typename T>
+GatherFn<T> GetGatherFn(const ColumnType& slot_type) {
+  switch (GetPhysicalType(slot_type)) {
+    case PhysicalType::INT8: return &Gather<int8_t, T>;
+    case PhysicalType::INT16: return &Gather<int16_t, T>;
+    case PhysicalType::INT32: return &Gather<int32_t, T>;
+    case PhysicalType::INT64: return &Gather<int64_t, T>;
+    case PhysicalType::FLOAT: return &Gather<float, T>;
+    case PhysicalType::DOUBLE: return &Gather<double, T>;
+    default: DCHECK(false); return nullptr;
+  }
+}
+
+/// The type in which arithmetic on T is done. BIGINT arithmetic wraps around on
+/// overflow, like the row-at-a-time operators, without relying on signed overflow.
+template <typename T>
+struct ArithType {
+  typedef T type;
+};
+
+template <>
+struct ArithType<int64_t> {
+  typedef uint64_t type;
+};
+
+template <typename T, ArithOp OP, bool CONST_ON_LEFT>
+void ApplyArith(T c, T* values, int n) {
+  typedef typename ArithType<T>::type A;
+  const A ac = static_cast<A>(c);
+  for (int k = 0; k < n; ++k) {
+    const A v = static_cast<A>(values[k]);
+    A result;
+    switch (OP) {
+      case ArithOp::ADD: result = v + ac; break;
+      case ArithOp::SUBTRACT: result = CONST_ON_LEFT ? ac - v : v - ac; break;
+      case ArithOp::MULTIPLY: result = v * ac; break;
+    }
+    values[k] = static_cast<T>(result);
+  }
+}
+
+/// Applies the arithmetic 'steps' to 'values[0, n)'. Only instantiated for the compute
+/// types of arithmetic, i.e. int64_t and double.
+template <typename T>
+void ApplySteps(
+    const vector<VectorizedPredicate::ArithStep>& steps, T* values, int n) {
+  for (const VectorizedPredicate::ArithStep& step : steps) {
+    const T c = FromValue<T>(step.c);
+    switch (step.op) {
+      case ArithOp::ADD:
+        ApplyArith<T, ArithOp::ADD, false>(c, values, n);
+        break;
+      case ArithOp::SUBTRACT:
+        if (step.const_on_left) {
+          ApplyArith<T, ArithOp::SUBTRACT, true>(c, values, n);
+        } else {
+          ApplyArith<T, ArithOp::SUBTRACT, false>(c, values, n);
+        }
+        break;
+      case ArithOp::MULTIPLY:
+        ApplyArith<T, ArithOp::MULTIPLY, false>(c, values, n);
+        break;
+    }
+  }
+}
+
+template <>
+void ApplySteps<int32_t>(
+    const vector<VectorizedPredicate::ArithStep>& steps, int32_t* values, int n) {
+  DCHECK(steps.empty());
+}
+
+template <>
+void ApplySteps<float>(
+    const vector<VectorizedPredicate::ArithStep>& steps, float* values, int n) {
+  DCHECK(steps.empty());
+}
+
+/// Base class of the predicates that operate on the gathered values of a column.
+template <typename T>
+class ColumnKernel : public VectorizedPredicate {
+ public:
+  ColumnKernel(const Column& col, int capacity)
+    : col_(col),
+      gather_fn_(GetGatherFn<T>(col.slot_type)),
+      values_(capacity),
+      nulls_(capacity) {}
+
+ protected:
+  /// Gathers the values of the rows in 'sel[0, n)' into 'values_' and 'nulls_' and
+  /// applies the arithmetic steps.
+  void GatherValues(Tuple* const* tuples, int num_tuples_per_row, const int* sel, int n) {
+    DCHECK_LE(n, values_.size());
+    gather_fn_(col_, tuples, num_tuples_per_row, sel, n, values_.data(), nulls_.data());
+    ApplySteps<T>(col_.steps, values_.data(), n);
+  }
+
+  const Column col_;
+  const GatherFn<T> gather_fn_;
+  vector<T> values_;
+  vector<uint8_t> nulls_;
+};
+
+template <typename T, Op OP>
+class CompareKernel : public ColumnKernel<T> {
+ public:
+  CompareKernel(const VectorizedPredicate::Column& col, T c, int capacity)
+    : ColumnKernel<T>(col, capacity), c_(c) {}
+
+  virtual int Filter(Tuple* const* tuples, int num_tuples_per_row, int* sel,
+      int num_selected) override {
+    this->GatherValues(tuples, num_tuples_per_row, sel, num_selected);
+    const T* values = this->values_.data();
+    const uint8_t* nulls = this->nulls_.data();
+    int num_out = 0;
+    int k = 0;
+    for (; k + BLOCK_SIZE <= num_selected; k += BLOCK_SIZE) {
+      uint32_t mask = BlockComparator<T, OP>::Compare(values + k, c_);
+      num_out = Compact(mask & ~NullMask(nulls + k), sel + k, sel, num_out);
+    }
+    for (; k < num_selected; ++k) {
+      sel[num_out] = sel[k];
+      num_out += (nulls[k] == 0) & CompareValue<T, OP>(values[k], c_);
+    }
+    return num_out;
+  }
+
+ private:
+  const T c_;
+};
+
+template <typename T>
+class InListKernel : public ColumnKernel<T> {
+ public:
+  InListKernel(const VectorizedPredicate::Column& col, bool not_in, vector<T> list,
+      int capacity)
+    : ColumnKernel<T>(col, capacity), not_in_(not_in), list_(move(list)) {
+    sort(list_.begin(), list_.end());
+    list_.erase(std::unique(list_.begin(), list_.end()), list_.end());
+  }
+
+  virtual int Filter(Tuple* const* tuples, int num_tuples_per_row, int* sel,
+      int num_selected) override {
+    this->GatherValues(tuples, num_tuples_per_row, sel, num_selected);
+    const T* values = this->values_.data();
+    const uint8_t* nulls = this->nulls_.data();
+    const uint32_t all_mask = (1U << BLOCK_SIZE) - 1;
+    int num_out = 0;
+    int k = 0;
+    for (; k + BLOCK_SIZE <= num_selected; k += BLOCK_SIZE) {
+      uint32_t mask = 0;
+      if (list_.size() <= MAX_SIMD_IN_LIST_SIZE) {
+        for (T c : list_) mask |= BlockComparator<T, Op::EQ>::Compare(values + k, c);
+      } else {
+        for (int j = 0; j < BLOCK_SIZE; ++j) {
+          mask |= static_cast<uint32_t>(Contains(values[k + j])) << j;
+        }
+      }
+      if (not_in_) mask ^= all_mask;
+      num_out = Compact(mask & ~NullMask(nulls + k), sel + k, sel, num_out);
+    }
+    for (; k < num_selected; ++k) {
+      sel[num_out] = sel[k];
+      num_out += (nulls[k] == 0) & (Contains(values[k]) != not_in_);
+    }
+    return num_out;
+  }
+
+ private:
+  bool Contains(T v) const {
+    return std::binary_search(list_.begin(), list_.end(), v);
+  }
+
+  const bool not_in_;
+
+  /// The sorted, distinct list values.
+  vector<T> list_;
+};
+
+class IsNullKernel : public VectorizedPredicate {
+ public:
+  IsNullKernel(const Column& col, bool is_not_null)
+    : tuple_idx_(col.tuple_idx),
+      null_indicator_(col.null_indicator),
+      is_not_null_(is_not_null) {}
+
+  virtual int Filter(Tuple* const* tuples, int num_tuples_per_row, int* sel,
+      int num_selected) override {
+    int num_out = 0;
+    for (int k = 0; k < num_selected; ++k) {
+      const Tuple* tuple = tuples[sel[k] * num_tuples_per_row + tuple_idx_];
+      bool is_null = tuple == nullptr || tuple->IsNull(null_indicator_);
+      sel[num_out] = sel[k];
+      num_out += is_null != is_not_null_;
+    }
+    return num_out;
+  }
+
+ private:
+  const int tuple_idx_;
+  const NullIndicatorOffset null_indicator_;
+  const bool is_not_null_;
+};
+
+class AlwaysFalseKernel : public VectorizedPredicate {
+ public:
+  virtual int Filter(Tuple* const* tuples, int num_tuples_per_row, int* sel,
+      int num_selected) override {
+    return 0;
+  }
+};
+
+template <typename T>
+VectorizedPredicate* CreateCompareKernel(ObjectPool* pool,
+    const VectorizedPredicate::Column& col, Op op, T c, int capacity) {
+  switch (op) {
+    case Op::EQ: return pool->Add(new CompareKernel<T, Op::EQ>(col, c, capacity));
+    case Op::NE: return pool->Add(new CompareKernel<T, Op::NE>(col, c, capacity));
+    case Op::LT: return pool->Add(new CompareKernel<T, Op::LT>(col, c, capacity));
+    case Op::LE: return pool->Add(new CompareKernel<T, Op::LE>(col, c, capacity));
+    case Op::GT: return pool->Add(new CompareKernel<T, Op::GT>(col, c, capacity));
+    case Op::GE: return pool->Add(new CompareKernel<T, Op::GE>(col, c, capacity));
+    default: DCHECK(false); return nullptr;
+  }
+}
+
+template <typename T>
+VectorizedPredicate* CreateInListKernel(ObjectPool* pool,
+    const VectorizedPredicate::Column& col, bool not_in,
+    const vector<VectorizedPredicate::Value>& values, int capacity) {
+  vector<T> list;
+  for (const VectorizedPredicate::Value& v : values) list.push_back(FromValue<T>(v));
+  return pool->Add(new InListKernel<T>(col, not_in, move(list), capacity));
+}
+
+} // anonymous namespace
+
+bool VectorizedPredicate::IsSupportedColumn(const ColumnType& slot_type,
+    const ColumnType& compute_type, bool has_steps) {
+  if (GetPhysicalType(slot_type) == PhysicalType::INVALID) return false;
+  if (has_steps && compute_type.type != TYPE_BIGINT && compute_type.type != TYPE_DOUBLE) {
+    return false;
+  }
+  if (slot_type == compute_type) return true;
+  // Widening casts: integers to larger integers or DOUBLE, and FLOAT to DOUBLE.
+  if (IsIntegerType(slot_type) && IsIntegerType(compute_type)) {
+    return slot_type.GetByteSize() < compute_type.GetByteSize();
+  }
+  return compute_type.type == TYPE_DOUBLE
+      && (IsIntegerType(slot_type) || slot_type.type == TYPE_FLOAT);
+}
+
+VectorizedPredicate* VectorizedPredicate::CreateCompare(ObjectPool* pool,
+    const Column& col, Op op, const Value& c, int capacity) {
+  DCHECK(IsSupportedColumn(col.slot_type, col.compute_type, !col.steps.empty()));
+  switch (GetPhysicalType(col.compute_type)) {
+    case PhysicalType::INT8:
+    case PhysicalType::INT16:
+    case PhysicalType::INT32:
+      return CreateCompareKernel<int32_t>(pool, col, op, FromValue<int32_t>(c), capacity);
+    case PhysicalType::INT64:
+      return CreateCompareKernel<int64_t>(pool, col, op, FromValue<int64_t>(c), capacity);
+    case PhysicalType::FLOAT:
+      return CreateCompareKernel<float>(pool, col, op, FromValue<float>(c), capacity);
+    case PhysicalType::DOUBLE:
+      return CreateCompareKernel<double>(pool, col, op, FromValue<double>(c), capacity);
+    default: DCHECK(false); return nullptr;
+  }
+}
+
+VectorizedPredicate* VectorizedPredicate::CreateIsNull(
+    ObjectPool* pool, const Column& col, bool is_not_null) {
+  return pool->Add(new IsNullKernel(col, is_not_null));
+}
+
+VectorizedPredicate* VectorizedPredicate::CreateInList(ObjectPool* pool,
+    const Column& col, bool not_in, const vector<Value>& values, int capacity) {
+  DCHECK(IsSupportedColumn(col.slot_type, col.compute_type, !col.steps.empty()));
+  switch (GetPhysicalType(col.compute_type)) {
+    case PhysicalType::INT8:
+    case PhysicalType::INT16:
+    case PhysicalType::INT32:
+      return CreateInListKernel<int32_t>(pool, col, not_in, values, capacity);
+    case PhysicalType::INT64:
+      return CreateInListKernel<int64_t>(pool, col, not_in, values, capacity);
+    default: DCHECK(false); return nullptr;
+  }
+}
+
+VectorizedPredicate* VectorizedPredicate::CreateAlwaysFalse(ObjectPool* pool) {
+  return pool->Add(new AlwaysFalseKernel());
+}
+
+namespace {
+
+/// The column operand of a conjunct, as matched by MatchColumn().
+struct ColumnMatch {
+  const SlotRef* slot_ref = nullptr;
+  ColumnType compute_type;
+  /// The arithmetic exprs applied to the slot value, innermost first.
+  vector<const ScalarExpr*> arith_exprs;
+};
+
+bool GetArithOp(const ScalarExpr& expr, ArithOp* op) {
+  if (expr.GetNumChildren() != 2 || !expr.IsBuiltinFn()) return false;
+  const string& name = expr.function_name();
+  if (name == "add") {
+    *op = ArithOp::ADD;
+  } else if (name == "subtract") {
+    *op = ArithOp::SUBTRACT;
+  } else if (name == "multiply") {
+    *op = ArithOp::MULTIPLY;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool GetCompareOp(const ScalarExpr& expr, Op* op) {
+  if (expr.GetNumChildren() != 2 || !expr.IsBuiltinFn()) return false;
+  const string& name = expr.function_name();
+  if (name == "eq") {
+    *op = Op::EQ;
+  } else if (name == "ne") {
+    *op = Op::NE;
+  } else if (name == "lt") {
+    *op = Op::LT;
+  } else if (name == "le") {
+    *op = Op::LE;
+  } else if (name == "gt") {
+    *op = Op::GT;
+  } else if (name == "ge") {
+    *op = Op::GE;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/// Returns the comparison that is equivalent to 'op' with its operands swapped.
+Op SwapOperands(Op op) {
+  switch (op) {
+    case Op::LT: return Op::GT;
+    case Op::LE: return Op::GE;
+    case Op::GT: return Op::LT;
+    case Op::GE: return Op::LE;
+    default: return op;
+  }
+}
+
+bool IsInList(const ScalarExpr& expr, bool* not_in) {
+  if (expr.GetNumChildren() < 2 || !expr.IsBuiltinFn()) return false;
+  const string& name = expr.function_name();
+  *not_in = name == "not_in_iterate" || name == "not_in_set_lookup";
+  return *not_in || name == "in_iterate" || name == "in_set_lookup";
+}
+
+bool IsSupportedSlotRef(const ScalarExpr& expr) {
+  if (!expr.IsSlotRef()) return false;
+  const SlotRef& slot_ref = static_cast<const SlotRef&>(expr);
+  return !slot_ref.IsStructField() && !expr.type().IsComplexType();
+}
+
+/// Matches the column operand 'expr': a SlotRef, optionally wrapped in a cast and in
+/// arithmetic with constants. Returns false if 'expr' is not supported.
+bool MatchColumn(const ScalarExpr& expr, ColumnMatch* match) {
+  if (IsSupportedSlotRef(expr)) {
+    match->slot_ref = static_cast<const SlotRef*>(&expr);
+    match->compute_type = expr.type();
+  } else if (expr.GetNumChildren() == 1 && expr.IsBuiltinFn()
+      && expr.function_name().find("castto") == 0
+      && IsSupportedSlotRef(*expr.GetChild(0))) {
+    match->slot_ref = static_cast<const SlotRef*>(expr.GetChild(0));
+    match->compute_type = expr.type();
+  } else {
+    ArithOp op;
+    if (!GetArithOp(expr, &op)) return false;
+    const ScalarExpr* lhs = expr.GetChild(0);
+    const ScalarExpr* rhs = expr.GetChild(1);
+    if (lhs->is_constant() == rhs->is_constant()) return false;
+    const ScalarExpr* col = lhs->is_constant() ? rhs : lhs;
+    if (lhs->type() != expr.type() || rhs->type() != expr.type()) return false;
+    if (!MatchColumn(*col, match)) return false;
+    match->arith_exprs.push_back(&expr);
+  }
+  return VectorizedPredicate::IsSupportedColumn(match->slot_ref->type(),
+      match->compute_type, !match->arith_exprs.empty());
+}
+
+/// Analyzes the conjunct 'expr'. Returns false if it is not supported. Otherwise sets
+/// 'op', 'column' and 'consts', which are the constant operands: the right-hand side of
+/// a comparison or the values of an IN list.
+bool MatchConjunct(const ScalarExpr& expr, Op* op, ColumnMatch* column,
+    vector<const ScalarExpr*>* consts) {
+  if (expr.type().type != TYPE_BOOLEAN) return false;
+  const string& name = expr.function_name();
+  if ((name == "is_null_pred" || name == "is_not_null_pred")
+      && expr.GetNumChildren() == 1 && expr.IsBuiltinFn()) {
+    if (!IsSupportedSlotRef(*expr.GetChild(0))) return false;
+    *op = name == "is_null_pred" ? Op::IS_NULL : Op::IS_NOT_NULL;
+    column->slot_ref = static_cast<const SlotRef*>(expr.GetChild(0));
+    column->compute_type = expr.GetChild(0)->type();
+    return true;
+  }
+  bool not_in;
+  if (GetCompareOp(expr, op)) {
+    const ScalarExpr* lhs = expr.GetChild(0);
+    const ScalarExpr* rhs = expr.GetChild(1);
+    if (lhs->is_constant() == rhs->is_constant()) return false;
+    if (lhs->type() != rhs->type()) return false;
+    if (lhs->is_constant()) {
+      *op = SwapOperands(*op);
+      swap(lhs, rhs);
+    }
+    consts->push_back(rhs);
+    return MatchColumn(*lhs, column);
+  } else if (IsInList(expr, &not_in)) {
+    *op = not_in ? Op::NOT_IN : Op::IN;
+    const ScalarExpr* col = expr.GetChild(0);
+    for (int i = 1; i < expr.GetNumChildren(); ++i) {
+      const ScalarExpr* value = expr.GetChild(i);
+      if (!value->is_constant() || value->type() != col->type()) return false;
+      consts->push_back(value);
+    }
+    if (!MatchColumn(*col, column)) return false;
+    PrimitiveType type = column->compute_type.type;
+    return IsIntegerType(column->compute_type) || type == TYPE_DATE
+        || type == TYPE_DECIMAL;
+  }
+  return false;
+}
+
+/// Evaluates the constant 'expr' with 'eval'. Sets 'is_null' if the value is NULL and
+/// 'value' otherwise.
+Status GetConstant(RuntimeState* state, ScalarExprEvaluator* eval,
+    const ScalarExpr& expr, bool* is_null, VectorizedPredicate::Value* value) {
+  AnyVal* val;
+  RETURN_IF_ERROR(eval->GetConstValue(state, expr, &val));
+  DCHECK(val != nullptr);
+  *is_null = val->is_null;
+  if (*is_null) return Status::OK();
+  const ColumnType& type = expr.type();
+  switch (type.type) {
+    case TYPE_TINYINT: value->i = static_cast<TinyIntVal*>(val)->val; break;
+    case TYPE_SMALLINT: value->i = static_cast<SmallIntVal*>(val)->val; break;
+    case TYPE_INT: value->i = static_cast<IntVal*>(val)->val; break;
+    case TYPE_BIGINT: value->i = static_cast<BigIntVal*>(val)->val; break;
+    case TYPE_DATE: value->i = static_cast<DateVal*>(val)->val; break;
+    case TYPE_FLOAT: value->d = static_cast<FloatVal*>(val)->val; break;
+    case TYPE_DOUBLE: value->d = static_cast<DoubleVal*>(val)->val; break;
+    case TYPE_DECIMAL:
+      if (type.GetByteSize() == 4) {
+        value->i = static_cast<DecimalVal*>(val)->val4;
+      } else {
+        DCHECK_EQ(type.GetByteSize(), 8);
+        value->i = static_cast<DecimalVal*>(val)->val8;
+      }
+      break;
+    default:
+      DCHECK(false) << type.DebugString();
+      return Status("Unsupported type of vectorized predicate constant");
+  }
+  return Status::OK();
+}
+
+/// Creates the predicate for the supported conjunct 'expr' in '*pred'.
+Status CreatePredicate(RuntimeState* state, ObjectPool* pool, const ScalarExpr& expr,
+    ScalarExprEvaluator* eval, int capacity, VectorizedPredicate** pred) {
+  Op op;
+  ColumnMatch match;
+  vector<const ScalarExpr*> consts;
+  bool supported = MatchConjunct(expr, &op, &match, &consts);
+  DCHECK(supported) << expr.DebugString();
+  if (!supported) return Status("Conjunct cannot be vectorized: " + expr.DebugString());
+
+  VectorizedPredicate::Column col;
+  col.tuple_idx = match.slot_ref->GetTupleIdx();
+  col.slot_offset = match.slot_ref->GetSlotOffset();
+  col.null_indicator = match.slot_ref->GetNullIndicatorOffset();
+  col.slot_type = match.slot_ref->type();
+  col.compute_type = match.compute_type;
+  if (op == Op::IS_NULL || op == Op::IS_NOT_NULL) {
+    *pred = VectorizedPredicate::CreateIsNull(pool, col, op == Op::IS_NOT_NULL);
+    return Status::OK();
+  }
+  for (const ScalarExpr* arith_expr : match.arith_exprs) {
+    VectorizedPredicate::ArithStep step;
+    bool is_arith = GetArithOp(*arith_expr, &step.op);
+    DCHECK(is_arith);
+    step.const_on_left = arith_expr->GetChild(0)->is_constant();
+    const ScalarExpr* c = arith_expr->GetChild(step.const_on_left ? 0 : 1);
+    bool is_null;
+    RETURN_IF_ERROR(GetConstant(state, eval, *c, &is_null, &step.c));
+    // Arithmetic with NULL is NULL for every row.
+    if (is_null) {
+      *pred = VectorizedPredicate::CreateAlwaysFalse(pool);
+      return Status::OK();
+    }
+    col.steps.push_back(step);
+  }
+
+  vector<VectorizedPredicate::Value> values;
+  bool has_null = false;
+  for (const ScalarExpr* c : consts) {
+    VectorizedPredicate::Value value;
+    bool is_null;
+    RETURN_IF_ERROR(GetConstant(state, eval, *c, &is_null, &value));
+    if (is_null) {
+      has_null = true;
+    } else {
+      values.push_back(value);
+    }
+  }
+  if (op == Op::IN || op == Op::NOT_IN) {
+    // 'x NOT IN (..., NULL)' is false or NULL for every row.
+    if (op == Op::NOT_IN && has_null) {
+      *pred = VectorizedPredicate::CreateAlwaysFalse(pool);
+    } else {
+      *pred = VectorizedPredicate::CreateInList(
+          pool, col, op == Op::NOT_IN, values, capacity);
+    }
+  } else if (has_null) {
+    // Comparisons with NULL are NULL.
+    *pred = VectorizedPredicate::CreateAlwaysFalse(pool);
+  } else {
+    DCHECK_EQ(values.size(), 1);
+    *pred = VectorizedPredicate::CreateCompare(pool, col, op, values[0], capacity);
+  }
+  return Status::OK();
+}
+
+} // anonymous namespace
+
+bool VectorizedConjuncts::IsSupported(const ScalarExpr& expr) {
+  Op op;
+  ColumnMatch match;
+  vector<const ScalarExpr*> consts;
+  return MatchConjunct(expr, &op, &match, &consts);
+}
+
+void VectorizedConjuncts::Partition(const vector<ScalarExpr*>& conjuncts,
+    vector<int>* vectorized_idxs, vector<ScalarExpr*>* row_conjuncts) {
+  for (int i = 0; i < conjuncts.size(); ++i) {
+    if (IsSupported(*conjuncts[i])) {
+      vectorized_idxs->push_back(i);
+    } else {
+      row_conjuncts->push_back(conjuncts[i]);
+    }
+  }
+}
+
+Status VectorizedConjuncts::Init(RuntimeState* state, ObjectPool* pool,
+    const vector<ScalarExpr*>& conjuncts, const vector<ScalarExprEvaluator*>& evals,
+    const vector<int>& idxs, int capacity) {
+  DCHECK_EQ(conjuncts.size(), evals.size());
+  DCHECK(preds_.empty());
+  for (int idx : idxs) {
+    VectorizedPredicate* pred;
+    RETURN_IF_ERROR(
+        CreatePredicate(state, pool, *conjuncts[idx], evals[idx], capacity, &pred));
+    preds_.push_back(pred);
+  }
+  return Status::OK();
+}
+
+int VectorizedConjuncts::Filter(
+    Tuple* const* tuples, int num_tuples_per_row, int num_rows, int* sel) {
+  for (int i = 0; i < num_rows; ++i) sel[i] = i;
+  int num_selected = num_rows;
+  for (VectorizedPredicate* pred : preds_) {
+    if (num_selected == 0) break;
+    num_selected = pred->Filter(tuples, num_tuples_per_row, sel, num_selected);
+  }
+  return num_selected;
+}
+
+int VectorizedConjuncts::Filter(RowBatch* batch, int* sel) {
+  if (batch->num_rows() == 0) return 0;
+  return Filter(reinterpret_cast<Tuple* const*>(batch->GetRow(0)),
+      batch->num_tuples_per_row(), batch->num_rows(), sel);
+}
+
+}
@@ -0,0 +1,166 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/status.h"
+#include "runtime/descriptors.h"
+#include "runtime/types.h"
+
+namespace impala {
+
+class ObjectPool;
+class RowBatch;
+class RuntimeState;
+class ScalarExpr;
+class ScalarExprEvaluator;
+class Tuple;
+
+/// A boolean predicate over a single fixed-width slot that is evaluated a batch of rows
+/// at a time instead of one row at a time through ScalarExprEvaluator.
+///
+/// The rows to evaluate are given by a selection vector: an increasing list of row
+/// indices. Filter() first gathers the slot value of every selected row into a dense
+/// array of the compute type (INT, BIGINT, FLOAT or DOUBLE), together with a null mask.
+/// Arithmetic with constants is then applied to the whole array, and the values are
+/// compared with the constant(s) 16 at a time with SSE2 instructions, producing a
+/// bitmask of the selected rows. Finally, the selection vector is compacted in place to
+/// the rows for which the predicate is true. NULL values never pass a predicate, except
+/// for IS NULL. The results match the row-at-a-time evaluation of the same expr.
+class VectorizedPredicate {
+ public:
+  enum class Op { EQ, NE, LT, LE, GT, GE, IS_NULL, IS_NOT_NULL, IN, NOT_IN };
+  enum class ArithOp { ADD, SUBTRACT, MULTIPLY };
+
+  /// A constant operand. 'i' holds the value of integer, DATE and DECIMAL types (the
+  /// unscaled value for DECIMAL) and 'd' the value of FLOAT and DOUBLE types.
+  struct Value {
+    int64_t i = 0;
+    double d = 0;
+  };
+
+  /// An arithmetic operation with a constant that is applied to the column value:
+  /// 'value OP c', or 'c OP value' if 'const_on_left' is true.
+  struct ArithStep {
+    ArithOp op;
+    bool const_on_left;
+    Value c;
+  };
+
+  /// The column operand of a predicate: a fixed-width slot, which is converted to
+  /// 'compute_type' and then transformed by 'steps' in order.
+  struct Column {
+    /// Index of the slot's tuple in the row and location of the slot in the tuple.
+    int tuple_idx = 0;
+    int slot_offset = 0;
+    NullIndicatorOffset null_indicator;
+
+    /// Type of the slot. One of TINYINT, SMALLINT, INT, BIGINT, FLOAT, DOUBLE, DATE or
+    /// DECIMAL with precision <= 18.
+    ColumnType slot_type;
+
+    /// Type of the value that the predicate operates on. Either 'slot_type' or an
+    /// integer or floating point type that 'slot_type' is widened to. If 'steps' is
+    /// non-empty, it must be BIGINT or DOUBLE.
+    ColumnType compute_type;
+
+    std::vector<ArithStep> steps;
+  };
+
+  virtual ~VectorizedPredicate() {}
+
+  /// Returns true if a Column with these types can be evaluated.
+  static bool IsSupportedColumn(const ColumnType& slot_type,
+      const ColumnType& compute_type, bool has_steps);
+
+  /// Creates a predicate 'col OP c' for a comparison 'op'. 'capacity' is the maximum
+  /// number of rows that will be passed to Filter(). The predicate is owned by 'pool'.
+  static VectorizedPredicate* CreateCompare(ObjectPool* pool, const Column& col, Op op,
+      const Value& c, int capacity);
+
+  /// Creates a predicate 'col IS NULL' or 'col IS NOT NULL'. Only the null indicator
+  /// of the slot is read, so the slot can have any type.
+  static VectorizedPredicate* CreateIsNull(
+      ObjectPool* pool, const Column& col, bool is_not_null);
+
+  /// Creates a predicate 'col IN (values)' or 'col NOT IN (values)'. The compute type
+  /// of 'col' must be an integer type. NULL entries of the list must be removed by the
+  /// caller: they never make a row pass IN and make NOT IN false for every row.
+  static VectorizedPredicate* CreateInList(ObjectPool* pool, const Column& col,
+      bool not_in, const std::vector<Value>& values, int capacity);
+
+  /// Creates a predicate that is false (or NULL) for every row.
+  static VectorizedPredicate* CreateAlwaysFalse(ObjectPool* pool);
+
+  /// Evaluates the predicate on the 'num_selected' rows whose indices are in 'sel'.
+  /// 'tuples' points to the tuple pointers of the first row; row 'r' has its tuples at
+  /// 'tuples + r * num_tuples_per_row'. Removes the rows for which the predicate is not
+  /// true from 'sel', preserving the order of the others, and returns their number.
+  virtual int Filter(Tuple* const* tuples, int num_tuples_per_row, int* sel,
+      int num_selected) = 0;
+};
+
+/// The conjuncts of an operator that can be evaluated with VectorizedPredicates.
+///
+/// Supported conjuncts have one of these forms, where 'col' is a SlotRef of a type
+/// supported by VectorizedPredicate, optionally wrapped in a widening cast and in
+/// BIGINT or DOUBLE add, subtract or multiply with constants, and 'c' is a constant:
+///   col <op> c, c <op> col  where <op> is =, !=, <, <=, > or >=
+///   col IS NULL, col IS NOT NULL  where col can be a SlotRef of any type
+///   col [NOT] IN (c1, c2, ...)  where col has an integer, DATE or DECIMAL type
+/// The other conjuncts must still be evaluated row by row.
+///
+/// The operator decides which conjuncts to vectorize with Partition() when it is
+/// prepared, which only looks at the structure of the exprs and therefore can be done
+/// before codegen. Init() reads the constants from the opened evaluators.
+class VectorizedConjuncts {
+ public:
+  /// Returns true if the conjunct 'expr' can be evaluated by a VectorizedPredicate.
+  static bool IsSupported(const ScalarExpr& expr);
+
+  /// Appends the indices of the conjuncts in 'conjuncts' that are supported to
+  /// 'vectorized_idxs' and the other conjuncts to 'row_conjuncts'.
+  static void Partition(const std::vector<ScalarExpr*>& conjuncts,
+      std::vector<int>* vectorized_idxs, std::vector<ScalarExpr*>* row_conjuncts);
+
+  /// Creates the predicates for the conjuncts in 'conjuncts' at 'idxs'. 'evals' are the
+  /// opened evaluators of 'conjuncts' and are used to evaluate the constant operands.
+  /// 'capacity' is the maximum number of rows passed to Filter().
+  Status Init(RuntimeState* state, ObjectPool* pool,
+      const std::vector<ScalarExpr*>& conjuncts,
+      const std::vector<ScalarExprEvaluator*>& evals, const std::vector<int>& idxs,
+      int capacity) WARN_UNUSED_RESULT;
+
+  bool empty() const { return preds_.empty(); }
+
+  /// Evaluates all predicates on the first 'num_rows' rows, given by 'tuples' and
+  /// 'num_tuples_per_row' as in VectorizedPredicate::Filter(). Writes the indices of
+  /// the rows that pass all of them to 'sel' in increasing order and returns their
+  /// number. 'sel' must have room for 'num_rows' entries.
+  int Filter(Tuple* const* tuples, int num_tuples_per_row, int num_rows, int* sel);
+
+  /// Same as above for all rows of 'batch'.
+  int Filter(RowBatch* batch, int* sel);
+
+ private:
+  std::vector<VectorizedPredicate*> preds_;
+};
+
+}
@@ -20,6 +20,7 @@
 #include <limits>
 #include <random>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/scoped_ptr.hpp>
@@ -349,6 +350,48 @@ TEST_F(SuballocatorTest, RandomAllocations) {
   ExpectReservationUnused(client);
 }
 
+/// Check that threads can share a suballocator once a lock is set, as hash tables of
+/// different partitions do when they are built in parallel.
+TEST_F(SuballocatorTest, ConcurrentAllocations) {
+  const int NUM_THREADS = 4;
+  const int64_t TOTAL_MEM = TEST_BUFFER_LEN * 100;
+  InitPool(TEST_BUFFER_LEN, TOTAL_MEM);
+  BufferPool::ClientHandle* client;
+  RegisterClient(&global_reservation_, &client);
+  Suballocator allocator(buffer_pool(), client, TEST_BUFFER_LEN);
+  mutex lock;
+  allocator.set_lock(&lock);
+
+  vector<vector<unique_ptr<Suballocation>>> allocs(NUM_THREADS);
+  vector<std::thread> threads;
+  for (int t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&allocator, &allocs, t]() {
+      // Each thread repeatedly fills its share of the memory and frees half of it.
+      const int64_t alloc_size = Suballocator::MIN_ALLOCATION_BYTES << (t % 3);
+      const size_t max_allocs = TOTAL_MEM / NUM_THREADS / alloc_size;
+      for (int iter = 0; iter < 100; ++iter) {
+        while (allocs[t].size() < max_allocs) {
+          unique_ptr<Suballocation> alloc;
+          EXPECT_OK(allocator.Allocate(alloc_size, &alloc));
+          if (alloc == nullptr) break;
+          allocs[t].push_back(move(alloc));
+        }
+        while (allocs[t].size() > max_allocs / 2) {
+          allocator.Free(move(allocs[t].back()));
+          allocs[t].pop_back();
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (vector<unique_ptr<Suballocation>>& thread_allocs : allocs) {
+    AssertMemoryValid(thread_allocs);
+    FreeAllocations(&allocator, &thread_allocs);
+  }
+  allocator.set_lock(nullptr);
+  ExpectReservationUnused(client);
+}
+
 void SuballocatorTest::AssertMemoryValid(
     const vector<unique_ptr<Suballocation>>& allocs) {
   for (int64_t i = 0; i < allocs.size(); ++i) {
@@ -51,6 +51,8 @@ Status Suballocator::Allocate(int64_t bytes, unique_ptr<Suballocation>* result)
                              "supported of $1 bytes",
         bytes, MAX_ALLOCATION_BYTES));
   }
+  unique_lock<mutex> l;
+  if (lock_ != nullptr) l = unique_lock<mutex>(*lock_);
   unique_ptr<Suballocation> free_node;
   bytes = max(bytes, MIN_ALLOCATION_BYTES);
   const int target_list_idx = ComputeListIndex(bytes);
@@ -152,6 +154,8 @@ Status Suballocator::SplitToSize(unique_ptr<Suballocation> free_node,
 
 void Suballocator::Free(unique_ptr<Suballocation> allocation) {
   if (allocation == nullptr) return;
+  unique_lock<mutex> l;
+  if (lock_ != nullptr) l = unique_lock<mutex>(*lock_);
 
   DCHECK(allocation->in_use_);
   allocation->in_use_ = false;
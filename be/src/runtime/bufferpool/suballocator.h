@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <mutex>
 
 #include "runtime/bufferpool/buffer-pool.h"
 
@@ -89,6 +90,12 @@ class Suballocator {
   /// failed Allocate() call).
   void Free(std::unique_ptr<Suballocation> allocation);
 
+  /// If 'lock' is non-null, Allocate() and Free() hold it while they run, so that the
+  /// suballocator can be shared by multiple threads as long as no other operation on
+  /// the client runs concurrently. Used when hash tables of different partitions are
+  /// built in parallel.
+  void set_lock(std::mutex* lock) { lock_ = lock; }
+
   /// Upper bounds on the max allocation size and the number of different
   /// power-of-two allocation sizes. Used to bound the number of free lists.
   static constexpr int LOG_MAX_ALLOCATION_BYTES = BufferPool::LOG_MAX_BUFFER_BYTES;
@@ -144,6 +151,9 @@ class Suballocator {
   /// Track how much memory has been returned in allocations but not freed.
   int64_t allocated_;
 
+  /// See set_lock(). Not owned.
+  std::mutex* lock_ = nullptr;
+
   /// Free lists for each supported power-of-two size. Statically allocate the maximum
   /// possible number of lists for simplicity. Indexed by log2 of the allocation size
   /// minus log2 of the minimum allocation size, e.g. 16k allocations are at index 2.
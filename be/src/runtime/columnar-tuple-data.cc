@@ -0,0 +1,425 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/columnar-tuple-data.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <unordered_map>
+
+#include "gutil/strings/substitute.h"
+#include "runtime/descriptors.h"
+#include "util/bit-packing.inline.h"
+#include "util/bit-stream-utils.inline.h"
+#include "util/bit-util.h"
+
+#include "common/names.h"
+
+using strings::Substitute;
+
+namespace impala {
+
+namespace {
+
+/// Encodings of a column. Stored as the first byte of each column.
+enum ColumnEncoding : uint8_t {
+  PLAIN = 0,
+  RLE = 1,
+  DICT = 2,
+  FOR = 3,
+  DELTA_FOR = 4,
+};
+
+/// The maximum number of distinct values of a DICT encoded column.
+constexpr int MAX_DICT_SIZE = 256;
+
+/// Returns the number of bits required to represent 'v'.
+int NumRequiredBits(uint64_t v) {
+  return v == 0 ? 0 : BitUtil::Log2FloorNonZero64(v) + 1;
+}
+
+/// Returns the number of bytes of 'num_values' bit-packed values of 'bit_width' bits.
+int64_t BitPackedBytes(int64_t num_values, int bit_width) {
+  return BitUtil::RoundUpNumBytes(num_values * bit_width);
+}
+
+/// Appends the lowest 'width' bytes of 'v' to 'out'.
+void AppendValue(uint64_t v, int width, string* out) {
+  out->append(reinterpret_cast<const char*>(&v), width);
+}
+
+/// Appends 'num_values' values returned by 'get_value' bit-packed with 'bit_width' bits
+/// to 'out'.
+template <typename GetValueFn>
+void AppendBitPacked(
+    int64_t num_values, int bit_width, const GetValueFn& get_value, string* out) {
+  if (bit_width == 0) return;
+  int64_t num_bytes = BitPackedBytes(num_values, bit_width);
+  int64_t start = out->size();
+  out->resize(start + num_bytes);
+  BitWriter writer(reinterpret_cast<uint8_t*>(&(*out)[start]), num_bytes);
+  for (int64_t i = 0; i < num_values; ++i) {
+    bool success = writer.PutValue(get_value(i), bit_width);
+    DCHECK(success);
+  }
+  writer.Flush();
+  DCHECK_EQ(writer.bytes_written(), num_bytes);
+}
+
+/// Reads 'width' bytes from '*data' into 'v' and advances '*data'. Returns false if
+/// there are fewer than 'width' bytes before 'end'.
+bool ReadValue(const uint8_t** data, const uint8_t* end, int width, uint64_t* v) {
+  if (end - *data < width) return false;
+  *v = 0;
+  memcpy(v, *data, width);
+  *data += width;
+  return true;
+}
+
+/// Unpacks 'num_values' values of 'bit_width' bits from '*data' into 'out' and advances
+/// '*data'. Returns false if the data is truncated.
+bool ReadBitPacked(const uint8_t** data, const uint8_t* end, int bit_width,
+    int64_t num_values, uint64_t* out) {
+  if (bit_width > 64) return false;
+  if (bit_width == 0) {
+    std::fill(out, out + num_values, 0);
+    return true;
+  }
+  int64_t num_bytes = BitPackedBytes(num_values, bit_width);
+  if (end - *data < num_bytes) return false;
+  int64_t num_read =
+      BitPacking::UnpackValues(bit_width, *data, num_bytes, num_values, out).second;
+  if (num_read != num_values) return false;
+  *data += num_bytes;
+  return true;
+}
+
+} // anonymous namespace
+
+Status ColumnarTupleData::ComputeLayout(const RowDescriptor& row_desc,
+    const int32_t* tuple_offsets, int num_offsets, int64_t tuple_data_len,
+    Layout* layout) {
+  const vector<TupleDescriptor*>& tuple_descs = row_desc.tuple_descriptors();
+  const int num_tuples_per_row = tuple_descs.size();
+  layout->columns.clear();
+  layout->tuples.clear();
+  layout->tuples.resize(num_tuples_per_row);
+  layout->ordered_tuples.clear();
+
+  for (int j = 0; j < num_tuples_per_row; ++j) {
+    const TupleDescriptor* desc = tuple_descs[j];
+    const int byte_size = desc->byte_size();
+    if (byte_size == 0) continue;
+    // Split the tuple at the boundaries of slots and null indicators so that each
+    // column holds the bytes of a single field.
+    set<int> boundaries = {0, byte_size};
+    for (const SlotDescriptor* slot : desc->slots()) {
+      boundaries.insert(slot->tuple_offset());
+      boundaries.insert(slot->tuple_offset() + slot->slot_size());
+    }
+    boundaries.insert(desc->null_bytes_offset());
+    boundaries.insert(desc->null_bytes_offset() + desc->num_null_bytes());
+    int start = 0;
+    for (int boundary : boundaries) {
+      if (boundary <= start || boundary > byte_size) continue;
+      while (start < boundary) {
+        int width = 8;
+        while (width > boundary - start) width /= 2;
+        layout->columns.push_back({j, start, width});
+        start += width;
+      }
+    }
+  }
+
+  // The serialized tuples are laid out in the order they are first referenced, so a
+  // tuple is a new distinct tuple iff its offset is past the last distinct tuple.
+  // Zero-length tuples share their offset with the next tuple and are skipped.
+  int32_t last_offset = -1;
+  int64_t last_end = 0;
+  for (int i = 0; i < num_offsets; ++i) {
+    const int32_t offset = tuple_offsets[i];
+    const int j = i % num_tuples_per_row;
+    const int byte_size = tuple_descs[j]->byte_size();
+    if (offset == -1 || byte_size == 0) continue;
+    if (UNLIKELY(offset < 0)) {
+      return Status(Substitute("Invalid tuple offset $0 in row batch", offset));
+    }
+    if (offset <= last_offset) continue;
+    if (UNLIKELY(offset < last_end || offset + byte_size > tuple_data_len)) {
+      return Status(Substitute("Tuple at offset $0 of size $1 overlaps another tuple or "
+          "exceeds the tuple data of $2 bytes", offset, byte_size, tuple_data_len));
+    }
+    layout->tuples[j].push_back(offset);
+    layout->ordered_tuples.emplace_back(offset, j);
+    last_offset = offset;
+    last_end = offset + byte_size;
+  }
+  return Status::OK();
+}
+
+Status ColumnarTupleData::Encode(const RowDescriptor& row_desc,
+    const int32_t* tuple_offsets, int num_offsets, const uint8_t* tuple_data,
+    int64_t tuple_data_len, string* out) {
+  Layout layout;
+  RETURN_IF_ERROR(
+      ComputeLayout(row_desc, tuple_offsets, num_offsets, tuple_data_len, &layout));
+  out->clear();
+  out->reserve(tuple_data_len + layout.columns.size());
+
+  vector<uint64_t> values;
+  for (const Column& column : layout.columns) {
+    const vector<int32_t>& offsets = layout.tuples[column.tuple_idx];
+    if (offsets.empty()) continue;
+    values.resize(offsets.size());
+    for (int i = 0; i < offsets.size(); ++i) {
+      values[i] = 0;
+      memcpy(&values[i], tuple_data + offsets[i] + column.offset, column.width);
+    }
+    EncodeColumn(values, column.width, out);
+  }
+
+  // Append all bytes outside of the fixed-length parts of the tuples.
+  const vector<TupleDescriptor*>& tuple_descs = row_desc.tuple_descriptors();
+  int64_t var_len_start = 0;
+  for (const std::pair<int32_t, int>& tuple : layout.ordered_tuples) {
+    out->append(reinterpret_cast<const char*>(tuple_data) + var_len_start,
+        tuple.first - var_len_start);
+    var_len_start = tuple.first + tuple_descs[tuple.second]->byte_size();
+  }
+  out->append(reinterpret_cast<const char*>(tuple_data) + var_len_start,
+      tuple_data_len - var_len_start);
+  return Status::OK();
+}
+
+int64_t ColumnarTupleData::MaxEncodedLen(
+    const RowDescriptor& row_desc, int64_t tuple_data_len) {
+  // Each column is at least one byte wide, so the byte sizes of the tuples bound the
+  // number of columns.
+  int64_t max_columns = 0;
+  for (const TupleDescriptor* tuple_desc : row_desc.tuple_descriptors()) {
+    max_columns += tuple_desc->byte_size();
+  }
+  return tuple_data_len + max_columns;
+}
+
+Status ColumnarTupleData::Decode(const RowDescriptor& row_desc,
+    const int32_t* tuple_offsets, int num_offsets, const uint8_t* encoded,
+    int64_t encoded_len, uint8_t* tuple_data, int64_t tuple_data_len) {
+  Layout layout;
+  RETURN_IF_ERROR(
+      ComputeLayout(row_desc, tuple_offsets, num_offsets, tuple_data_len, &layout));
+  const uint8_t* data = encoded;
+  const uint8_t* end = encoded + encoded_len;
+
+  vector<uint64_t> values;
+  for (const Column& column : layout.columns) {
+    const vector<int32_t>& offsets = layout.tuples[column.tuple_idx];
+    if (offsets.empty()) continue;
+    if (UNLIKELY(!DecodeColumn(&data, end, column.width, offsets.size(), &values))) {
+      return Status(Substitute("Corrupt columnar row batch: failed to decode column at "
+          "offset $0 of tuple $1", column.offset, column.tuple_idx));
+    }
+    for (int i = 0; i < offsets.size(); ++i) {
+      memcpy(tuple_data + offsets[i] + column.offset, &values[i], column.width);
+    }
+  }
+
+  const vector<TupleDescriptor*>& tuple_descs = row_desc.tuple_descriptors();
+  int64_t var_len_start = 0;
+  auto copy_var_len = [&](int64_t var_len_end) {
+    int64_t len = var_len_end - var_len_start;
+    if (UNLIKELY(end - data < len)) return false;
+    memcpy(tuple_data + var_len_start, data, len);
+    data += len;
+    return true;
+  };
+  for (const std::pair<int32_t, int>& tuple : layout.ordered_tuples) {
+    if (UNLIKELY(!copy_var_len(tuple.first))) break;
+    var_len_start = tuple.first + tuple_descs[tuple.second]->byte_size();
+  }
+  if (UNLIKELY(!copy_var_len(tuple_data_len) || data != end)) {
+    return Status(Substitute("Corrupt columnar row batch: $0 bytes of columnar data do "
+        "not decode to $1 bytes of tuple data", encoded_len, tuple_data_len));
+  }
+  return Status::OK();
+}
+
+void ColumnarTupleData::EncodeColumn(
+    const vector<uint64_t>& values, int width, string* out) {
+  DCHECK(!values.empty());
+  const int64_t num_values = values.size();
+  const uint64_t mask = width == 8 ? ~0ULL : (1ULL << (width * 8)) - 1;
+
+  // Collect the statistics of the values needed to size each encoding.
+  uint64_t min_value = values[0];
+  uint64_t max_value = values[0];
+  uint64_t min_delta = ~0ULL;
+  uint64_t max_delta = 0;
+  int64_t num_runs = 1;
+  std::unordered_map<uint64_t, int> dict;
+  dict.emplace(values[0], 0);
+  for (int64_t i = 1; i < num_values; ++i) {
+    const uint64_t v = values[i];
+    min_value = std::min(min_value, v);
+    max_value = std::max(max_value, v);
+    const uint64_t delta = (v - values[i - 1]) & mask;
+    min_delta = std::min(min_delta, delta);
+    max_delta = std::max(max_delta, delta);
+    if (v != values[i - 1]) ++num_runs;
+    if (dict.size() <= MAX_DICT_SIZE) dict.emplace(v, dict.size());
+  }
+
+  const int for_bits = NumRequiredBits(max_value - min_value);
+  const int delta_bits = num_values > 1 ? NumRequiredBits(max_delta - min_delta) : 0;
+  const int dict_bits = NumRequiredBits(dict.size() - 1);
+  const int64_t plain_size = num_values * width;
+  const int64_t rle_size = sizeof(int32_t) + num_runs * (sizeof(int32_t) + width);
+  const int64_t for_size = width + 1 + BitPackedBytes(num_values, for_bits);
+  const int64_t delta_size = num_values > 1 ?
+      2 * width + 1 + BitPackedBytes(num_values - 1, delta_bits) :
+      std::numeric_limits<int64_t>::max();
+  const int64_t dict_size = dict.size() <= MAX_DICT_SIZE ?
+      sizeof(uint16_t) + dict.size() * width + 1 + BitPackedBytes(num_values, dict_bits) :
+      std::numeric_limits<int64_t>::max();
+  const int64_t best_size =
+      std::min({plain_size, rle_size, for_size, delta_size, dict_size});
+
+  if (best_size == for_size) {
+    out->push_back(FOR);
+    AppendValue(min_value, width, out);
+    out->push_back(for_bits);
+    AppendBitPacked(num_values, for_bits,
+        [&](int64_t i) { return values[i] - min_value; }, out);
+  } else if (best_size == delta_size) {
+    out->push_back(DELTA_FOR);
+    AppendValue(values[0], width, out);
+    AppendValue(min_delta, width, out);
+    out->push_back(delta_bits);
+    AppendBitPacked(num_values - 1, delta_bits,
+        [&](int64_t i) { return ((values[i + 1] - values[i]) & mask) - min_delta; },
+        out);
+  } else if (best_size == dict_size) {
+    out->push_back(DICT);
+    vector<uint64_t> dict_values(dict.size());
+    for (const std::pair<const uint64_t, int>& entry : dict) {
+      dict_values[entry.second] = entry.first;
+    }
+    uint16_t num_entries = dict_values.size();
+    out->append(reinterpret_cast<const char*>(&num_entries), sizeof(num_entries));
+    for (uint64_t v : dict_values) AppendValue(v, width, out);
+    out->push_back(dict_bits);
+    AppendBitPacked(num_values, dict_bits,
+        [&](int64_t i) { return static_cast<uint64_t>(dict[values[i]]); }, out);
+  } else if (best_size == rle_size) {
+    out->push_back(RLE);
+    int32_t num_runs_32 = num_runs;
+    out->append(reinterpret_cast<const char*>(&num_runs_32), sizeof(num_runs_32));
+    int64_t run_start = 0;
+    for (int64_t i = 1; i <= num_values; ++i) {
+      if (i < num_values && values[i] == values[run_start]) continue;
+      int32_t run_length = i - run_start;
+      out->append(reinterpret_cast<const char*>(&run_length), sizeof(run_length));
+      AppendValue(values[run_start], width, out);
+      run_start = i;
+    }
+  } else {
+    out->push_back(PLAIN);
+    for (uint64_t v : values) AppendValue(v, width, out);
+  }
+}
+
+bool ColumnarTupleData::DecodeColumn(const uint8_t** data, const uint8_t* end,
+    int width, int num_values, vector<uint64_t>* values) {
+  DCHECK_GT(num_values, 0);
+  const uint64_t mask = width == 8 ? ~0ULL : (1ULL << (width * 8)) - 1;
+  values->resize(num_values);
+  uint64_t* out = values->data();
+  if (*data >= end) return false;
+  const uint8_t encoding = *(*data)++;
+  switch (encoding) {
+    case PLAIN:
+      for (int i = 0; i < num_values; ++i) {
+        if (!ReadValue(data, end, width, &out[i])) return false;
+      }
+      return true;
+    case RLE: {
+      int32_t num_runs;
+      if (end - *data < sizeof(num_runs)) return false;
+      memcpy(&num_runs, *data, sizeof(num_runs));
+      *data += sizeof(num_runs);
+      int64_t num_decoded = 0;
+      for (int32_t run = 0; run < num_runs; ++run) {
+        int32_t run_length;
+        uint64_t v;
+        if (end - *data < sizeof(run_length)) return false;
+        memcpy(&run_length, *data, sizeof(run_length));
+        *data += sizeof(run_length);
+        if (!ReadValue(data, end, width, &v)) return false;
+        if (run_length <= 0 || run_length > num_values - num_decoded) return false;
+        std::fill(out + num_decoded, out + num_decoded + run_length, v);
+        num_decoded += run_length;
+      }
+      return num_decoded == num_values;
+    }
+    case DICT: {
+      uint16_t num_entries;
+      if (end - *data < sizeof(num_entries)) return false;
+      memcpy(&num_entries, *data, sizeof(num_entries));
+      *data += sizeof(num_entries);
+      if (num_entries == 0 || num_entries > MAX_DICT_SIZE) return false;
+      uint64_t dict[MAX_DICT_SIZE];
+      for (int i = 0; i < num_entries; ++i) {
+        if (!ReadValue(data, end, width, &dict[i])) return false;
+      }
+      if (*data >= end) return false;
+      const int bit_width = *(*data)++;
+      if (!ReadBitPacked(data, end, bit_width, num_values, out)) return false;
+      for (int i = 0; i < num_values; ++i) {
+        if (out[i] >= num_entries) return false;
+        out[i] = dict[out[i]];
+      }
+      return true;
+    }
+    case FOR: {
+      uint64_t min_value;
+      if (!ReadValue(data, end, width, &min_value) || *data >= end) return false;
+      const int bit_width = *(*data)++;
+      if (!ReadBitPacked(data, end, bit_width, num_values, out)) return false;
+      for (int i = 0; i < num_values; ++i) out[i] = (out[i] + min_value) & mask;
+      return true;
+    }
+    case DELTA_FOR: {
+      uint64_t first_value;
+      uint64_t min_delta;
+      if (!ReadValue(data, end, width, &first_value)) return false;
+      if (!ReadValue(data, end, width, &min_delta) || *data >= end) return false;
+      const int bit_width = *(*data)++;
+      if (!ReadBitPacked(data, end, bit_width, num_values - 1, out + 1)) return false;
+      out[0] = first_value;
+      for (int i = 1; i < num_values; ++i) {
+        out[i] = (out[i - 1] + out[i] + min_delta) & mask;
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+} // namespace impala
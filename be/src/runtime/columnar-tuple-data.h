@@ -0,0 +1,120 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/status.h"
+
+namespace impala {
+
+class RowDescriptor;
+
+/// Converts the row-major tuple data of a serialized row batch to and from a columnar
+/// (PAX) layout that compresses better on the wire.
+///
+/// The row-major layout produced by RowBatch::Serialize() stores each distinct tuple as
+/// its fixed-length part followed by the var-len data (strings, collections) it
+/// references. The distinct tuples and their order are fully determined by the tuple
+/// offsets, so the columnar layout only needs to rearrange the bytes of 'tuple_data':
+///
+///   [column 0][column 1]...[column n-1][var-len data]
+///
+/// The fixed-length part of each tuple descriptor is split into columns at slot and
+/// null indicator boundaries, and further into columns of at most 8 bytes. Each column
+/// holds the values of all distinct tuples of that descriptor and is stored with the
+/// smallest of the encodings below:
+///
+///   PLAIN:     the raw values.
+///   RLE:       runs of identical values.
+///   DICT:      a dictionary of up to 256 distinct values and bit-packed codes.
+///   FOR:       the minimum value and bit-packed differences to it.
+///   DELTA_FOR: the first value and the deltas between consecutive values, stored as
+///              FOR. This fits the offsets of var-len data, which increase by small
+///              amounts.
+///
+/// The var-len data of all tuples is concatenated in tuple order without any
+/// transformation. Both sides derive the column layout from the row descriptor, so
+/// nothing describing the layout is sent on the wire. The columnar data is meant to be
+/// compressed by a general purpose codec afterwards.
+class ColumnarTupleData {
+ public:
+  /// Encodes 'tuple_data' of 'tuple_data_len' bytes, which is in the row-major layout
+  /// with 'num_offsets' tuple offsets 'tuple_offsets' described by 'row_desc', into
+  /// 'out'. The size of 'out' may be slightly larger than 'tuple_data_len' if nothing
+  /// can be encoded more compactly.
+  static Status Encode(const RowDescriptor& row_desc, const int32_t* tuple_offsets,
+      int num_offsets, const uint8_t* tuple_data, int64_t tuple_data_len,
+      std::string* out) WARN_UNUSED_RESULT;
+
+  /// Returns an upper bound of the size of the columnar data that Encode() produces for
+  /// 'tuple_data_len' bytes of tuple data described by 'row_desc'. Every column adds at
+  /// most one byte to the size of its PLAIN values.
+  static int64_t MaxEncodedLen(const RowDescriptor& row_desc, int64_t tuple_data_len);
+
+  /// Decodes 'encoded_len' bytes of columnar data 'encoded' produced by Encode() back
+  /// into the row-major layout in 'tuple_data', which must have room for
+  /// 'tuple_data_len' bytes, the size of the data passed to Encode(). Returns an error
+  /// if 'encoded' or the tuple offsets are inconsistent.
+  static Status Decode(const RowDescriptor& row_desc, const int32_t* tuple_offsets,
+      int num_offsets, const uint8_t* encoded, int64_t encoded_len, uint8_t* tuple_data,
+      int64_t tuple_data_len) WARN_UNUSED_RESULT;
+
+ private:
+  /// A column of the fixed-length part of a tuple descriptor.
+  struct Column {
+    /// Index of the tuple descriptor in the row descriptor.
+    int tuple_idx;
+    /// Offset of the column within the tuple.
+    int offset;
+    /// Width of the column's values in bytes. One of 1, 2, 4 or 8.
+    int width;
+  };
+
+  /// The layout of the distinct tuples in the row-major 'tuple_data'.
+  struct Layout {
+    std::vector<Column> columns;
+    /// Offsets of the distinct tuples of each tuple descriptor in 'tuple_data', indexed
+    /// by tuple descriptor.
+    std::vector<std::vector<int32_t>> tuples;
+    /// Offsets and tuple descriptor indexes of all distinct tuples in the order they
+    /// appear in 'tuple_data'.
+    std::vector<std::pair<int32_t, int>> ordered_tuples;
+  };
+
+  /// Computes the columns and the distinct tuples of 'tuple_data' of 'tuple_data_len'
+  /// bytes from the row descriptor and the tuple offsets. Returns an error if the tuple
+  /// offsets are not valid for 'tuple_data_len'.
+  static Status ComputeLayout(const RowDescriptor& row_desc, const int32_t* tuple_offsets,
+      int num_offsets, int64_t tuple_data_len, Layout* layout);
+
+  /// Appends the encoding of 'values' of 'width' bytes each to 'out'.
+  static void EncodeColumn(
+      const std::vector<uint64_t>& values, int width, std::string* out);
+
+  /// Decodes 'num_values' values of 'width' bytes each from the column starting at
+  /// '*data' into 'values'. Advances '*data' past the column. Returns false if the
+  /// column does not fit before 'end' or is malformed.
+  static bool DecodeColumn(const uint8_t** data, const uint8_t* end, int width,
+      int num_values, std::vector<uint64_t>* values);
+};
+
+} // namespace impala
@@ -46,7 +46,7 @@ struct Coordinator::FilterTarget {
 };
 
 /// State of runtime filters that are received for aggregation. A runtime filter will
-/// contain a bloom or min-max filter.
+/// contain a bloom, min-max, in-list or bitmap filter.
 ///
 /// A broadcast join filter is published as soon as the first update is received for it
 /// and subsequent updates are ignored (as they will be the same).
@@ -73,6 +73,7 @@ class Coordinator::FilterState {
   std::string& bloom_filter_directory() { return bloom_filter_directory_; }
   MinMaxFilterPB& min_max_filter() { return min_max_filter_; }
   InListFilterPB& in_list_filter() { return in_list_filter_; }
+  BitmapFilterPB& bitmap_filter() { return bitmap_filter_; }
   std::vector<FilterTarget>* targets() { return &targets_; }
   const std::vector<FilterTarget>& targets() const { return targets_; }
   int64_t first_arrival_time() const { return first_arrival_time_; }
@@ -81,6 +82,7 @@ class Coordinator::FilterState {
   bool is_bloom_filter() const { return desc_.type == TRuntimeFilterType::BLOOM; }
   bool is_min_max_filter() const { return desc_.type == TRuntimeFilterType::MIN_MAX; }
   bool is_in_list_filter() const { return desc_.type == TRuntimeFilterType::IN_LIST; }
+  bool is_bitmap_filter() const { return desc_.type == TRuntimeFilterType::BITMAP; }
   int pending_count() const { return pending_count_; }
   void set_pending_count(int pending_count) { pending_count_ = pending_count; }
   int num_producers() const { return num_producers_; }
@@ -90,6 +92,8 @@ class Coordinator::FilterState {
       return bloom_filter_.always_true();
     } else if (is_min_max_filter()) {
       return min_max_filter_.always_true();
+    } else if (is_bitmap_filter()) {
+      return bitmap_filter_.always_true();
     } else {
       DCHECK(is_in_list_filter());
       return in_list_filter_.always_true();
@@ -108,8 +112,13 @@ class Coordinator::FilterState {
   void ApplyUpdate(const UpdateFilterParamsPB& params, Coordinator* coord,
       kudu::rpc::RpcContext* context);
 
-  /// Disables the filter and releases the consumed memory if the filter is a Bloom
-  /// filter.
+  /// Shrinks the aggregated bloom filter to the size that the summed NDV upper bounds of
+  /// the updates need, and releases the memory that is no longer used. Called once all
+  /// updates were applied.
+  void ShrinkBloomFilter(Coordinator* coord);
+
+  /// Disables the filter and releases the consumed memory if the filter is a Bloom or
+  /// bitmap filter.
   void DisableAndRelease(MemTracker* tracker, const bool all_updates_received);
   /// Disables the filter but does not release the consumed memory.
   void Disable(const bool all_updates_received);
@@ -154,8 +163,14 @@ class Coordinator::FilterState {
   /// When the filter is a Bloom filter, we use this string to store the contents of the
   /// aggregated Bloom filter.
   std::string bloom_filter_directory_;
+  /// Sum of the NDV upper bounds of the Bloom filter updates received so far, or -1 if
+  /// an update did not have one.
+  int64_t bloom_filter_ndv_upper_bound_ = 0;
   MinMaxFilterPB min_max_filter_;
   InListFilterPB in_list_filter_;
+  /// The words of the aggregated bitmap filter are tracked by the coordinator's filter
+  /// MemTracker, like 'bloom_filter_directory_'.
+  BitmapFilterPB bitmap_filter_;
 
   /// Time at which first local filter arrived.
   int64_t first_arrival_time_ = 0L;
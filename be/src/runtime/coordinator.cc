@@ -48,11 +48,13 @@
 #include "runtime/query-exec-mgr.h"
 #include "runtime/query-state.h"
 #include "runtime/raw-value.h"
+#include "runtime/runtime-filter-bank.h"
 #include "scheduling/admission-control-client.h"
 #include "scheduling/scheduler.h"
 #include "service/client-request-state.h"
 #include "service/frontend.h"
 #include "util/bit-util.h"
+#include "util/bitmap-filter.h"
 #include "util/bloom-filter.h"
 #include "util/hdfs-bulk-ops.h"
 #include "util/hdfs-util.h"
@@ -702,6 +704,30 @@ string Coordinator::FilterDebugString() {
       } else {
         row.push_back("PartialUpdates");
       }
+    } else if (state.is_bitmap_filter()) {
+      row.push_back(PrintThriftEnum(state.desc().type));
+      row.push_back("");
+      const BitmapFilterPB& bitmap_filterPB =
+          const_cast<FilterState*>(&state)->bitmap_filter();
+      if (state.AlwaysTrueFilterReceived()) {
+        row.push_back("AlwaysTrue");
+        row.push_back("AlwaysTrue");
+      } else if (state.received_all_updates()) {
+        if (state.AlwaysFalseFlippedToFalse()
+            || BitmapFilter::AlwaysFalse(bitmap_filterPB)) {
+          row.push_back("AlwaysFalse");
+          row.push_back("AlwaysFalse");
+        } else {
+          row.push_back(bitmap_filterPB.has_min() ?
+              std::to_string(bitmap_filterPB.min()) : "NULL");
+          row.push_back(bitmap_filterPB.has_max() ?
+              std::to_string(bitmap_filterPB.max()) : "NULL");
+        }
+      } else {
+        row.push_back("PartialUpdates");
+        row.push_back("PartialUpdates");
+      }
+      row.push_back("");
     }
     table_printer.AddRow(row);
   }
@@ -1515,6 +1541,8 @@ void Coordinator::UpdateFilter(const UpdateFilterParamsPB& params, RpcContext* c
 
     } else if (state->is_min_max_filter()) {
       MinMaxFilter::Copy(state->min_max_filter(), rpc_params.mutable_min_max_filter());
+    } else if (state->is_bitmap_filter()) {
+      *rpc_params.mutable_bitmap_filter() = state->bitmap_filter();
     } else {
       DCHECK(state->is_in_list_filter());
       *rpc_params.mutable_in_list_filter() = state->in_list_filter();
@@ -1559,6 +1587,11 @@ void Coordinator::FilterState::ApplyUpdate(
   --pending_count_;
   if (is_bloom_filter()) {
     DCHECK(params.has_bloom_filter());
+    if (!params.has_bloom_filter_ndv_upper_bound()) {
+      bloom_filter_ndv_upper_bound_ = -1;
+    } else if (bloom_filter_ndv_upper_bound_ >= 0) {
+      bloom_filter_ndv_upper_bound_ += params.bloom_filter_ndv_upper_bound();
+    }
     if (params.bloom_filter().always_true()) {
       // An always_true filter is received. We don't need to wait for other pending
       // backends.
@@ -1620,6 +1653,36 @@ void Coordinator::FilterState::ApplyUpdate(
       MinMaxFilter::Or(params.min_max_filter(), &min_max_filter_, col_type);
     }
     VLOG(3) << " Updated accumulated filter=" << DebugString();
+  } else if (is_bitmap_filter()) {
+    DCHECK(params.has_bitmap_filter());
+    VLOG(3) << "Update bitmap filter " << params.filter_id() << ", "
+            << BitmapFilter::DebugString(params.bitmap_filter());
+    if (params.bitmap_filter().always_true()) {
+      // An always_true filter is received. We don't need to wait for other pending
+      // backends.
+      always_true_filter_received_ = true;
+      DisableAndRelease(coord->filter_mem_tracker_, true);
+    } else {
+      int64_t old_size = bitmap_filter_.words_size() * sizeof(uint64_t);
+      BitmapFilter::Or(params.bitmap_filter(), &bitmap_filter_, desc_.filter_size_bytes);
+      int64_t new_size = bitmap_filter_.words_size() * sizeof(uint64_t);
+      if (bitmap_filter_.always_true()) {
+        // The values of the producers span a wider range than the filter can hold. Or()
+        // dropped the words.
+        coord->filter_mem_tracker_->Release(old_size);
+        always_true_filter_received_ = true;
+        DisableAndRelease(coord->filter_mem_tracker_, true);
+      } else if (!coord->filter_mem_tracker_->TryConsume(new_size - old_size)) {
+        VLOG_QUERY << "Not enough memory to allocate filter: "
+                   << PrettyPrinter::Print(new_size, TUnit::BYTES)
+                   << " (query_id=" << PrintId(coord->query_id()) << ")";
+        // Only 'old_size' bytes of the words are tracked.
+        bitmap_filter_.clear_words();
+        coord->filter_mem_tracker_->Release(old_size);
+        // Disable, as one missing update means a correct filter cannot be produced.
+        DisableAndRelease(coord->filter_mem_tracker_, false);
+      }
+    }
   } else {
     DCHECK(is_in_list_filter());
     DCHECK(params.has_in_list_filter());
@@ -1631,11 +1694,35 @@ void Coordinator::FilterState::ApplyUpdate(
     in_list_filter_ = params.in_list_filter();
   }
 
+  if (pending_count_ == 0 && enabled() && is_bloom_filter()) ShrinkBloomFilter(coord);
   if (pending_count_ == 0 || disabled()) {
     completion_time_ = coord->query_events_->ElapsedTime();
   }
 }
 
+void Coordinator::FilterState::ShrinkBloomFilter(Coordinator* coord) {
+  // The bound is only known for partitioned joins. The producers of broadcast joins
+  // shrink their filters themselves.
+  if (bloom_filter_ndv_upper_bound_ < 0 || bloom_filter_.always_false()) return;
+  int log_space = RuntimeFilterBank::MinBloomFilterLogSpace(
+      coord->exec_params_.query_options(), bloom_filter_ndv_upper_bound_);
+  if (log_space >= bloom_filter_.log_bufferpool_space()) return;
+  int64_t old_size = bloom_filter_directory_.size();
+  // The directory is folded in place, but its memory is only released by copying it
+  // into a string of the folded size. The copy is tracked until the old directory is
+  // freed. If it can not be tracked, the filter is sent unfolded.
+  int64_t new_size = BloomFilter::GetExpectedMemoryUsed(log_space);
+  if (!coord->filter_mem_tracker_->TryConsume(new_size)) return;
+  BloomFilter::Fold(log_space, &bloom_filter_, &bloom_filter_directory_);
+  DCHECK_EQ(new_size, bloom_filter_directory_.size());
+  bloom_filter_directory_ = string(bloom_filter_directory_);
+  coord->filter_mem_tracker_->Release(old_size);
+  VLOG(3) << "Shrunk aggregated bloom filter " << desc_.filter_id << " from "
+          << PrettyPrinter::PrintBytes(old_size) << " to "
+          << PrettyPrinter::PrintBytes(bloom_filter_directory_.size()) << " for at most "
+          << bloom_filter_ndv_upper_bound_ << " distinct values";
+}
+
 void Coordinator::FilterState::DisableAndRelease(
     MemTracker* tracker, const bool all_updates_received) {
   Disable(all_updates_received);
@@ -1656,6 +1743,11 @@ void Coordinator::FilterState::Disable(bool all_updates_received) {
       always_false_flipped_to_false_ = true;
     }
     min_max_filter_.set_always_false(false);
+  } else if (is_bitmap_filter()) {
+    if (BitmapFilter::AlwaysFalse(bitmap_filter_)) {
+      always_false_flipped_to_false_ = true;
+    }
+    bitmap_filter_.set_always_true(true);
   } else {
     DCHECK(is_in_list_filter());
     if (InListFilter::AlwaysFalse(in_list_filter_)) {
@@ -1672,6 +1764,10 @@ void Coordinator::FilterState::Release(MemTracker* tracker) {
     tracker->Release(bloom_filter_directory_.size());
     bloom_filter_directory_.clear();
     bloom_filter_directory_.shrink_to_fit();
+  } else if (is_bitmap_filter()) {
+    tracker->Release(bitmap_filter_.words_size() * sizeof(uint64_t));
+    // Swap with an empty field to free the memory, which clear_words() would keep.
+    google::protobuf::RepeatedField<uint64_t>().Swap(bitmap_filter_.mutable_words());
   }
 }
 
@@ -261,6 +261,7 @@ Status FragmentInstanceState::Prepare() {
   row_batch_.reset(
       new RowBatch(exec_tree_->row_desc(), runtime_state_->batch_size(),
         runtime_state_->instance_mem_tracker()));
+  row_batch_->set_selection_allowed(sink_->AcceptsSelection());
   VLOG(2) << "plan_root=\n" << exec_tree_->DebugString();
   return Status::OK();
 }
@@ -341,8 +342,10 @@ void FragmentInstanceState::GetStatusReport(FragmentInstanceExecStatusPB* instan
         // row count stats for a join node
         string hash_type = PrintThriftEnum(TPlanNodeType::HASH_JOIN_NODE);
         string nested_loop_type = PrintThriftEnum(TPlanNodeType::NESTED_LOOP_JOIN_NODE);
+        string band_type = PrintThriftEnum(TPlanNodeType::BAND_JOIN_NODE);
         if (node->name().rfind(hash_type, 0) == 0
-            || node->name().rfind(nested_loop_type, 0) == 0) {
+            || node->name().rfind(nested_loop_type, 0) == 0
+            || node->name().rfind(band_type, 0) == 0) {
           per_join_rows_produced[node->metadata().plan_node_id] = rows_counter->value();
         }
       }
@@ -448,7 +451,7 @@ Status FragmentInstanceState::ExecInternal() {
     }
     UpdateState(StateEvent::BATCH_PRODUCED);
     if (VLOG_ROW_IS_ON) row_batch_->VLogRows("FragmentInstanceState::ExecInternal()");
-    COUNTER_ADD(rows_produced_counter_, row_batch_->num_rows());
+    COUNTER_ADD(rows_produced_counter_, row_batch_->num_active_rows());
     RETURN_IF_ERROR(sink_->Send(runtime_state_, row_batch_.get()));
     UpdateState(StateEvent::BATCH_SENT);
   } while (!exec_tree_complete);
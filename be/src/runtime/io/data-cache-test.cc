@@ -28,6 +28,7 @@
 #include "runtime/io/data-cache.h"
 #include "runtime/io/data-cache-trace.h"
 #include "runtime/io/request-ranges.h"
+#include "runtime/mem-tracker.h"
 #include "runtime/test-env.h"
 #include "service/fe-support.h"
 #include "testutil/gtest-util.h"
@@ -58,10 +59,15 @@
 
 DECLARE_bool(cache_force_single_shard);
 DECLARE_bool(data_cache_anonymize_trace);
+DECLARE_bool(data_cache_enable_range_lookup);
 DECLARE_bool(data_cache_enable_tracing);
 DECLARE_int64(data_cache_file_max_size_bytes);
 DECLARE_int32(data_cache_max_opened_files);
+DECLARE_bool(data_cache_persist_metadata);
+DECLARE_int32(data_cache_checkpoint_interval_s);
 DECLARE_int32(data_cache_write_concurrency);
+DECLARE_int64(data_cache_write_queue_bytes);
+DECLARE_int64(data_cache_write_batch_bytes);
 DECLARE_string(data_cache_eviction_policy);
 DECLARE_string(data_cache_trace_dir);
 DECLARE_int32(max_data_cache_trace_file_size);
@@ -337,6 +343,288 @@ TEST_P(DataCacheTest, TestBasics) {
   ASSERT_EQ(0, cache.Lookup(FNAME, MTIME, 0, -5000, buffer));
 }
 
+// Tests sub-range and overlapping-range lookups and the trimming of insertions which
+// overlap with cached ranges when --data_cache_enable_range_lookup is true.
+TEST_P(DataCacheTest, RangeLookup) {
+  FLAGS_data_cache_enable_range_lookup = true;
+  StringPiece delimiter(",");
+  string cache_base = JoinStrings(data_cache_dirs(), delimiter);
+  const int64_t cache_size = DEFAULT_CACHE_SIZE;
+  DataCache cache(Substitute("$0:$1", cache_base, std::to_string(cache_size)));
+  ASSERT_OK(cache.Init());
+
+  uint8_t buffer[TEST_BUFFER_SIZE];
+  // Cache [0, 4096) and look up sub-ranges of it.
+  ASSERT_TRUE(cache.Store(FNAME, MTIME, 0, test_buffer(), TEMP_BUFFER_SIZE));
+  for (int64_t offset : {1L, 1000L, 4000L, 4095L}) {
+    const int64_t len = TEMP_BUFFER_SIZE - offset;
+    memset(buffer, 0, TEST_BUFFER_SIZE);
+    ASSERT_EQ(len, cache.Lookup(FNAME, MTIME, offset, len, buffer)) << offset;
+    ASSERT_EQ(0, memcmp(buffer, test_buffer() + offset, len));
+    // A lookup extending past the cached range is a partial hit.
+    ASSERT_EQ(len, cache.Lookup(FNAME, MTIME, offset, len + 100, buffer)) << offset;
+  }
+  ASSERT_EQ(0, cache.Lookup(FNAME, MTIME, TEMP_BUFFER_SIZE, 100, buffer));
+  ASSERT_EQ(0, cache.Lookup(FNAME, MTIME + 1, 1000, 100, buffer));
+
+  // Inserting a range already covered by the cache is a no-op.
+  ASSERT_FALSE(cache.Store(FNAME, MTIME, 100, test_buffer() + 100, 1000));
+
+  // Inserting an overlapping range only stores the uncovered bytes. A lookup spanning
+  // both ranges is served by stitching them together.
+  ASSERT_TRUE(cache.Store(FNAME, MTIME, 4000, test_buffer() + 4000, 4000));
+  memset(buffer, 0, TEST_BUFFER_SIZE);
+  ASSERT_EQ(8000 - 100, cache.Lookup(FNAME, MTIME, 100, 8000 - 100, buffer));
+  ASSERT_EQ(0, memcmp(buffer, test_buffer() + 100, 8000 - 100));
+
+  // Inserting a range containing cached ranges replaces them.
+  const string& alt_fname = "random";
+  ASSERT_TRUE(cache.Store(alt_fname, MTIME, 1000, test_buffer() + 1000, 1000));
+  ASSERT_TRUE(cache.Store(alt_fname, MTIME, 3000, test_buffer() + 3000, 1000));
+  ASSERT_TRUE(cache.Store(alt_fname, MTIME, 0, test_buffer(), TEST_BUFFER_SIZE));
+  memset(buffer, 0, TEST_BUFFER_SIZE);
+  ASSERT_EQ(TEST_BUFFER_SIZE,
+      cache.Lookup(alt_fname, MTIME, 0, TEST_BUFFER_SIZE, buffer));
+  ASSERT_EQ(0, memcmp(buffer, test_buffer(), TEST_BUFFER_SIZE));
+  memset(buffer, 0, TEST_BUFFER_SIZE);
+  ASSERT_EQ(TEST_BUFFER_SIZE - 3500,
+      cache.Lookup(alt_fname, MTIME, 3500, TEST_BUFFER_SIZE, buffer));
+  ASSERT_EQ(0, memcmp(buffer, test_buffer() + 3500, TEST_BUFFER_SIZE - 3500));
+
+  // Verify the backing files don't exceed size limits.
+  ASSERT_OK(cache.CloseFilesAndVerifySizes());
+}
+
+// Tests that the cached content survives re-creating the cache with
+// --data_cache_persist_metadata and that a corrupted checkpoint is ignored.
+TEST_P(DataCacheTest, PersistMetadata) {
+  FLAGS_data_cache_persist_metadata = true;
+  FLAGS_data_cache_checkpoint_interval_s = 0;
+  const string& config =
+      Substitute("$0:$1", data_cache_dirs()[0], std::to_string(DEFAULT_CACHE_SIZE));
+  const int num_entries = 100;
+  uint8_t buffer[TEMP_BUFFER_SIZE];
+  {
+    DataCache cache(config);
+    ASSERT_OK(cache.Init());
+    for (int64_t offset = 0; offset < num_entries; ++offset) {
+      ASSERT_TRUE(cache.Store(FNAME, MTIME, offset, test_buffer() + offset,
+          TEMP_BUFFER_SIZE));
+    }
+    // The destructor checkpoints the metadata.
+  }
+  {
+    DataCache cache(config);
+    ASSERT_OK(cache.Init());
+    for (int64_t offset = 0; offset < num_entries; ++offset) {
+      memset(buffer, 0, TEMP_BUFFER_SIZE);
+      ASSERT_EQ(TEMP_BUFFER_SIZE,
+          cache.Lookup(FNAME, MTIME, offset, TEMP_BUFFER_SIZE, buffer)) << offset;
+      ASSERT_EQ(0, memcmp(buffer, test_buffer() + offset, TEMP_BUFFER_SIZE));
+    }
+    // New entries can be added alongside the reloaded ones.
+    ASSERT_TRUE(cache.Store(FNAME, MTIME, num_entries, test_buffer() + num_entries,
+        TEMP_BUFFER_SIZE));
+    ASSERT_OK(cache.CloseFilesAndVerifySizes());
+  }
+
+  // Corrupt the checkpoint. The cache should start out empty.
+  const string& metadata_path = data_cache_dirs()[0] + "/impala-cache-metadata";
+  {
+    fstream metadata(metadata_path, ios::in | ios::out | ios::binary);
+    ASSERT_TRUE(metadata.is_open());
+    metadata.seekp(16);
+    metadata.put('X');
+  }
+  {
+    DataCache cache(config);
+    ASSERT_OK(cache.Init());
+    for (int64_t offset = 0; offset <= num_entries; ++offset) {
+      ASSERT_EQ(0, cache.Lookup(FNAME, MTIME, offset, TEMP_BUFFER_SIZE, buffer));
+    }
+  }
+
+  // Take a valid checkpoint again.
+  {
+    DataCache cache(config);
+    ASSERT_OK(cache.Init());
+    ASSERT_TRUE(cache.Store(FNAME, MTIME, 0, test_buffer(), TEMP_BUFFER_SIZE));
+    ASSERT_OK(cache.Checkpoint());
+    ASSERT_TRUE(boost::filesystem::exists(metadata_path));
+  }
+
+  // Without persistence, the checkpoint is ignored and deleted along with all backing
+  // files.
+  FLAGS_data_cache_persist_metadata = false;
+  {
+    DataCache cache(config);
+    ASSERT_OK(cache.Init());
+    ASSERT_FALSE(boost::filesystem::exists(metadata_path));
+    ASSERT_EQ(0, cache.Lookup(FNAME, MTIME, 0, TEMP_BUFFER_SIZE, buffer));
+    // No checkpoint is written on release either.
+  }
+  ASSERT_FALSE(boost::filesystem::exists(metadata_path));
+}
+
+// Tests that the entries reloaded from a checkpoint can be evicted, and that the
+// evicted entries are not restored by the next checkpoint.
+TEST_P(DataCacheTest, PersistMetadataEviction) {
+  // This test relies on LRU evicting all existing entries for an entry as large as the
+  // cache.
+  if (FLAGS_data_cache_eviction_policy != "LRU") return;
+  FLAGS_data_cache_persist_metadata = true;
+  FLAGS_data_cache_checkpoint_interval_s = 0;
+  const int64_t cache_size = DEFAULT_CACHE_SIZE;
+  const string& config =
+      Substitute("$0:$1", data_cache_dirs()[0], std::to_string(cache_size));
+  const int num_entries = 100;
+  uint8_t buffer[TEMP_BUFFER_SIZE];
+  {
+    DataCache cache(config);
+    ASSERT_OK(cache.Init());
+    for (int64_t offset = 0; offset < num_entries; ++offset) {
+      ASSERT_TRUE(cache.Store(FNAME, MTIME, offset, test_buffer() + offset,
+          TEMP_BUFFER_SIZE));
+    }
+  }
+  unique_ptr<uint8_t[]> large_buffer(new uint8_t[cache_size]);
+  for (int64_t offset = 0; offset < cache_size; offset += TEST_BUFFER_SIZE) {
+    memcpy(large_buffer.get() + offset, test_buffer(), TEST_BUFFER_SIZE);
+  }
+  const string& alt_fname = "random";
+  {
+    DataCache cache(config);
+    ASSERT_OK(cache.Init());
+    ASSERT_EQ(TEMP_BUFFER_SIZE, cache.Lookup(FNAME, MTIME, 0, TEMP_BUFFER_SIZE, buffer));
+    // Evict all the reloaded entries.
+    ASSERT_TRUE(cache.Store(alt_fname, MTIME, 0, large_buffer.get(), cache_size));
+    for (int64_t offset = 0; offset < num_entries; ++offset) {
+      ASSERT_EQ(0, cache.Lookup(FNAME, MTIME, offset, TEMP_BUFFER_SIZE, buffer));
+    }
+    // The space of the evicted entries is released.
+    ASSERT_OK(cache.CloseFilesAndVerifySizes());
+  }
+  {
+    DataCache cache(config);
+    ASSERT_OK(cache.Init());
+    for (int64_t offset = 0; offset < num_entries; ++offset) {
+      ASSERT_EQ(0, cache.Lookup(FNAME, MTIME, offset, TEMP_BUFFER_SIZE, buffer));
+    }
+    unique_ptr<uint8_t[]> temp_buffer(new uint8_t[cache_size]);
+    ASSERT_EQ(cache_size, cache.Lookup(alt_fname, MTIME, 0, cache_size,
+        temp_buffer.get()));
+    ASSERT_EQ(0, memcmp(temp_buffer.get(), large_buffer.get(), cache_size));
+  }
+  FLAGS_data_cache_persist_metadata = false;
+  {
+    // Delete the checkpoint and backing files so that TearDown() finds empty
+    // directories.
+    DataCache cache(config);
+    ASSERT_OK(cache.Init());
+  }
+}
+
+// Tests inserting through the write-behind queue. Entries become visible once the
+// writer thread has written them and inserts are dropped once the queue is full.
+TEST_P(DataCacheTest, WriteBehindQueue) {
+  // Coalesce up to 4 entries per write.
+  FLAGS_data_cache_write_queue_bytes = 64 * TEMP_BUFFER_SIZE;
+  FLAGS_data_cache_write_batch_bytes = 4 * TEMP_BUFFER_SIZE;
+  const int64_t cache_size = DEFAULT_CACHE_SIZE;
+  DataCache cache(Substitute("$0:$1", data_cache_dirs()[0], std::to_string(cache_size)));
+  ASSERT_OK(cache.Init());
+
+  // Entries of all sizes up to TEMP_BUFFER_SIZE to exercise the padding between them.
+  const int num_entries = 32;
+  uint8_t buffer[TEMP_BUFFER_SIZE];
+  for (int64_t i = 0; i < num_entries; ++i) {
+    int64_t len = TEMP_BUFFER_SIZE - i * 100;
+    ASSERT_TRUE(cache.Store(FNAME, MTIME, i, test_buffer() + i, len));
+  }
+  cache.WaitForPendingWrites();
+  for (int64_t i = 0; i < num_entries; ++i) {
+    int64_t len = TEMP_BUFFER_SIZE - i * 100;
+    memset(buffer, 0, TEMP_BUFFER_SIZE);
+    ASSERT_EQ(len, cache.Lookup(FNAME, MTIME, i, len, buffer)) << i;
+    ASSERT_EQ(0, memcmp(buffer, test_buffer() + i, len));
+  }
+
+  // Storing an existing entry is a no-op.
+  ASSERT_FALSE(cache.Store(FNAME, MTIME, 0, test_buffer(), TEMP_BUFFER_SIZE));
+
+  // Inserts larger than the queue are always dropped.
+  FLAGS_data_cache_write_queue_bytes = TEMP_BUFFER_SIZE;
+  DataCache small_queue_cache(
+      Substitute("$0:$1", data_cache_dirs()[1], std::to_string(cache_size)));
+  ASSERT_OK(small_queue_cache.Init());
+  ASSERT_FALSE(small_queue_cache.Store(FNAME, MTIME, 0, test_buffer(),
+      TEMP_BUFFER_SIZE + 1));
+  ASSERT_TRUE(small_queue_cache.Store(FNAME, MTIME, 0, test_buffer(),
+      TEMP_BUFFER_SIZE));
+  small_queue_cache.WaitForPendingWrites();
+  ASSERT_EQ(TEMP_BUFFER_SIZE,
+      small_queue_cache.Lookup(FNAME, MTIME, 0, TEMP_BUFFER_SIZE, buffer));
+
+  ASSERT_OK(cache.CloseFilesAndVerifySizes());
+  ASSERT_OK(small_queue_cache.CloseFilesAndVerifySizes());
+}
+
+// Tests that the ranges superseded by a queued insert stay cached until it's written,
+// that overlapping inserts are not stored twice and that the queued data is charged to
+// the MemTracker.
+TEST_P(DataCacheTest, WriteBehindQueueRanges) {
+  FLAGS_data_cache_enable_range_lookup = true;
+  FLAGS_data_cache_write_queue_bytes = 64 * TEMP_BUFFER_SIZE;
+  MemTracker parent_tracker(3 * TEMP_BUFFER_SIZE);
+  const int64_t cache_size = DEFAULT_CACHE_SIZE;
+  DataCache cache(Substitute("$0:$1", data_cache_dirs()[0], std::to_string(cache_size)),
+      /*trace_replay=*/false, &parent_tracker);
+  ASSERT_OK(cache.Init());
+
+  uint8_t buffer[TEST_BUFFER_SIZE];
+  ASSERT_TRUE(cache.Store(FNAME, MTIME, 1000, test_buffer() + 1000, 1000));
+  ASSERT_TRUE(cache.Store(FNAME, MTIME, 3000, test_buffer() + 3000, 1000));
+  cache.WaitForPendingWrites();
+  EXPECT_EQ(0, parent_tracker.consumption());
+
+  // Queue an insert containing both ranges. They can be read back whether or not it's
+  // written yet. Overlapping inserts are dropped either as pending or as cached.
+  ASSERT_TRUE(cache.Store(FNAME, MTIME, 0, test_buffer(), TEMP_BUFFER_SIZE));
+  memset(buffer, 0, TEST_BUFFER_SIZE);
+  ASSERT_EQ(1000, cache.Lookup(FNAME, MTIME, 1000, 1000, buffer));
+  ASSERT_EQ(0, memcmp(buffer, test_buffer() + 1000, 1000));
+  ASSERT_FALSE(cache.Store(FNAME, MTIME, 500, test_buffer() + 500, 1000));
+  ASSERT_FALSE(cache.Store(FNAME, MTIME, 0, test_buffer(), TEMP_BUFFER_SIZE));
+  cache.WaitForPendingWrites();
+  memset(buffer, 0, TEST_BUFFER_SIZE);
+  ASSERT_EQ(TEMP_BUFFER_SIZE, cache.Lookup(FNAME, MTIME, 0, TEMP_BUFFER_SIZE, buffer));
+  ASSERT_EQ(0, memcmp(buffer, test_buffer(), TEMP_BUFFER_SIZE));
+  // Once the insert is written, the part past it can be stored again.
+  ASSERT_TRUE(cache.Store(FNAME, MTIME, 500, test_buffer() + 500, TEMP_BUFFER_SIZE));
+  cache.WaitForPendingWrites();
+  memset(buffer, 0, TEST_BUFFER_SIZE);
+  ASSERT_EQ(TEMP_BUFFER_SIZE + 500, cache.Lookup(FNAME, MTIME, 0, TEST_BUFFER_SIZE,
+      buffer));
+  ASSERT_EQ(0, memcmp(buffer, test_buffer(), TEMP_BUFFER_SIZE + 500));
+
+  // Inserts exceeding the memory limit are dropped even if the queue has space. The
+  // memory is released once the inserts are written.
+  const string& alt_fname = "random";
+  const int64_t large_len = 4 * TEMP_BUFFER_SIZE;
+  unique_ptr<uint8_t[]> large_buffer(new uint8_t[large_len]);
+  memset(large_buffer.get(), 0, large_len);
+  ASSERT_FALSE(cache.Store(alt_fname, MTIME, 0, large_buffer.get(), large_len));
+  EXPECT_EQ(0, parent_tracker.consumption());
+  ASSERT_TRUE(cache.Store(alt_fname, MTIME, 0, test_buffer(), TEST_BUFFER_SIZE));
+  cache.WaitForPendingWrites();
+  EXPECT_EQ(0, parent_tracker.consumption());
+  ASSERT_EQ(TEST_BUFFER_SIZE, cache.Lookup(alt_fname, MTIME, 0, TEST_BUFFER_SIZE,
+      buffer));
+
+  ASSERT_OK(cache.CloseFilesAndVerifySizes());
+  cache.ReleaseResources();
+}
+
 // Tests backing file rotation by setting FLAGS_data_cache_file_max_size_bytes to be 1/4
 // of the cache size. This forces rotation of backing files.
 TEST_P(DataCacheTest, RotateFiles) {
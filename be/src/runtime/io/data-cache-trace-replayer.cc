@@ -15,7 +15,9 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <cstring>
 #include <fstream>
 #include <gflags/gflags.h>
 #include <iostream>
@@ -62,6 +64,15 @@
 //
 // These commands put output in the glog INFO file. For JSON output, see the
 // output_file option.
+//
+// To see how much sub-range and overlapping-range lookups would help a workload, pass
+// --compare_range_lookup. The trace is then replayed twice against the same
+// configuration, once with exact-key lookups only and once with
+// --data_cache_enable_range_lookup, and the byte hit ratios of both runs are reported.
+//
+// Similarly, --compare_admission_policy replays the trace once with the ALWAYS and once
+// with the TINYLFU --data_cache_admission_policy to show how much a scan-heavy workload
+// gains from frequency-based admission.
 
 // One of either trace_file or trace_directory must be specified
 DEFINE_string(trace_file, "", "Single trace file to replay");
@@ -79,6 +90,16 @@ DEFINE_string(data_cache_configuration, "", "Cache configuration string in the s
 // filename. If not specified, output goes to the INFO log.
 DEFINE_string(output_file, "", "File to write with JSON output containing hits/misses");
 
+DEFINE_bool(compare_range_lookup, false, "If true, replays the trace both with and "
+    "without range lookups in the data cache and reports the difference in hit ratio.");
+
+DEFINE_bool(compare_admission_policy, false, "If true, replays the trace with both "
+    "the ALWAYS and the TINYLFU data cache admission policy and reports the difference "
+    "in hit ratio.");
+
+DECLARE_bool(data_cache_enable_range_lookup);
+DECLARE_string(data_cache_admission_policy);
+
 using namespace impala;
 using namespace impala::io;
 using namespace impala::io::trace;
@@ -101,6 +122,13 @@ Value CacheHitStatisticsToJson(Document* document, const CacheHitStatistics& sta
   return json_value;
 }
 
+// Returns the fraction of the looked up bytes which were served from the cache.
+double ByteHitRatio(const CacheHitStatistics& stats) {
+  uint64_t total_bytes = stats.hit_bytes + stats.miss_bytes;
+  if (total_bytes == 0) return 0;
+  return static_cast<double>(stats.hit_bytes) / total_bytes;
+}
+
 // Output CacheHitStatistics to the INFO glog.
 void DumpStatisticsToLog(const CacheHitStatistics& stats) {
   LOG(INFO) << "Hits: " << std::to_string(stats.hits)
@@ -113,9 +141,14 @@ void DumpStatisticsToLog(const CacheHitStatistics& stats) {
 }
 
 // Write a JSON structure with both the original trace cache hit statistics and
-// the replay cache hit statistics.
+// the replay cache hit statistics. If 'range_stats' and 'exact_stats' are not null,
+// the statistics of the replays with and without range lookups are added as well.
+// Same for 'always_stats' and 'tinylfu_stats' and the replays with the ALWAYS and
+// TINYLFU admission policies.
 void DumpStatisticsToJSON(const CacheHitStatistics& trace_stats,
-    const CacheHitStatistics& replay_stats, std::string filename) {
+    const CacheHitStatistics& replay_stats, const CacheHitStatistics* exact_stats,
+    const CacheHitStatistics* range_stats, const CacheHitStatistics* always_stats,
+    const CacheHitStatistics* tinylfu_stats, std::string filename) {
   Document document;
   document.SetObject();
 
@@ -124,6 +157,28 @@ void DumpStatisticsToJSON(const CacheHitStatistics& trace_stats,
   document.AddMember("original_trace_stats", trace_stats_json, document.GetAllocator());
   Value replay_stats_json = CacheHitStatisticsToJson(&document, replay_stats);
   document.AddMember("replay_stats", replay_stats_json, document.GetAllocator());
+  if (exact_stats != nullptr && range_stats != nullptr) {
+    Value exact_stats_json = CacheHitStatisticsToJson(&document, *exact_stats);
+    document.AddMember("exact_lookup_replay_stats", exact_stats_json,
+        document.GetAllocator());
+    Value range_stats_json = CacheHitStatisticsToJson(&document, *range_stats);
+    document.AddMember("range_lookup_replay_stats", range_stats_json,
+        document.GetAllocator());
+    document.AddMember("range_lookup_byte_hit_ratio_gain",
+        Value(ByteHitRatio(*range_stats) - ByteHitRatio(*exact_stats)),
+        document.GetAllocator());
+  }
+  if (always_stats != nullptr && tinylfu_stats != nullptr) {
+    Value always_stats_json = CacheHitStatisticsToJson(&document, *always_stats);
+    document.AddMember("always_admission_replay_stats", always_stats_json,
+        document.GetAllocator());
+    Value tinylfu_stats_json = CacheHitStatisticsToJson(&document, *tinylfu_stats);
+    document.AddMember("tinylfu_admission_replay_stats", tinylfu_stats_json,
+        document.GetAllocator());
+    document.AddMember("tinylfu_admission_byte_hit_ratio_gain",
+        Value(ByteHitRatio(*tinylfu_stats) - ByteHitRatio(*always_stats)),
+        document.GetAllocator());
+  }
 
   ofstream ofs(filename);
   OStreamWrapper osw(ofs);
@@ -168,6 +223,27 @@ Status ValidateFlags() {
   return Status::OK();
 }
 
+// Replays the trace specified by --trace_file or --trace_directory with a newly created
+// TraceReplayer. 'replay_stats' is set to the hit statistics of the replay and
+// 'original_trace_stats' to those recorded in the trace if not null.
+Status Replay(CacheHitStatistics* replay_stats,
+    CacheHitStatistics* original_trace_stats) {
+  TraceReplayer replayer(FLAGS_data_cache_configuration);
+  RETURN_IF_ERROR(replayer.Init());
+  if (FLAGS_trace_file.size() != 0) {
+    LOG(INFO) << "Replaying file: " << FLAGS_trace_file;
+    RETURN_IF_ERROR(replayer.ReplayFile(FLAGS_trace_file));
+  } else if (FLAGS_trace_directory.size() != 0) {
+    LOG(INFO) << "Replaying directory: " << FLAGS_trace_directory;
+    RETURN_IF_ERROR(replayer.ReplayDirectory(FLAGS_trace_directory));
+  }
+  *replay_stats = replayer.GetReplayStatistics();
+  if (original_trace_stats != nullptr) {
+    *original_trace_stats = replayer.GetOriginalTraceStatistics();
+  }
+  return Status::OK();
+}
+
 int main(int argc, char **argv) {
   InitCommonRuntime(argc, argv, false);
 
@@ -175,29 +251,78 @@ int main(int argc, char **argv) {
   if (!status.ok()) CLEAN_EXIT_WITH_ERROR(status.GetDetail());
 
   LOG(INFO) << "Initialize cache with configuration: " << FLAGS_data_cache_configuration;
-  TraceReplayer replayer(FLAGS_data_cache_configuration);
-  status = replayer.Init();
+  CacheHitStatistics original_trace_stats;
+  CacheHitStatistics replay_stats;
+  status = Replay(&replay_stats, &original_trace_stats);
   if (!status.ok()) CLEAN_EXIT_WITH_ERROR(status.GetDetail());
 
-  if (FLAGS_trace_file.size() != 0) {
-    LOG(INFO) << "Replaying file: " << FLAGS_trace_file;
-    status = replayer.ReplayFile(FLAGS_trace_file);
-  } else if (FLAGS_trace_directory.size() != 0) {
-    LOG(INFO) << "Replaying directory: " << FLAGS_trace_directory;
-    status = replayer.ReplayDirectory(FLAGS_trace_directory);
+  // Replay a second time with range lookups toggled so both variants are available.
+  CacheHitStatistics exact_stats;
+  CacheHitStatistics range_stats;
+  if (FLAGS_compare_range_lookup) {
+    const bool range_lookup = FLAGS_data_cache_enable_range_lookup;
+    FLAGS_data_cache_enable_range_lookup = !range_lookup;
+    LOG(INFO) << "Replaying with data_cache_enable_range_lookup="
+              << FLAGS_data_cache_enable_range_lookup;
+    status = Replay(range_lookup ? &exact_stats : &range_stats, nullptr);
+    FLAGS_data_cache_enable_range_lookup = range_lookup;
+    if (!status.ok()) CLEAN_EXIT_WITH_ERROR(status.GetDetail());
+    if (range_lookup) {
+      range_stats = replay_stats;
+    } else {
+      exact_stats = replay_stats;
+    }
   }
-  if (!status.ok()) CLEAN_EXIT_WITH_ERROR(status.GetDetail());
 
-  CacheHitStatistics original_trace_stats = replayer.GetOriginalTraceStatistics();
-  CacheHitStatistics replay_stats = replayer.GetReplayStatistics();
+  // Replay with each admission policy which wasn't used by the replay above.
+  CacheHitStatistics always_stats;
+  CacheHitStatistics tinylfu_stats;
+  if (FLAGS_compare_admission_policy) {
+    const string admission_policy = FLAGS_data_cache_admission_policy;
+    for (const char* policy : {"ALWAYS", "TINYLFU"}) {
+      CacheHitStatistics* stats =
+          strcmp(policy, "ALWAYS") == 0 ? &always_stats : &tinylfu_stats;
+      if (boost::iequals(policy, admission_policy)) {
+        *stats = replay_stats;
+        continue;
+      }
+      FLAGS_data_cache_admission_policy = policy;
+      LOG(INFO) << "Replaying with data_cache_admission_policy=" << policy;
+      status = Replay(stats, nullptr);
+      FLAGS_data_cache_admission_policy = admission_policy;
+      if (!status.ok()) CLEAN_EXIT_WITH_ERROR(status.GetDetail());
+    }
+  }
 
   if (FLAGS_output_file.size() != 0) {
-    DumpStatisticsToJSON(original_trace_stats, replay_stats, FLAGS_output_file);
+    DumpStatisticsToJSON(original_trace_stats, replay_stats,
+        FLAGS_compare_range_lookup ? &exact_stats : nullptr,
+        FLAGS_compare_range_lookup ? &range_stats : nullptr,
+        FLAGS_compare_admission_policy ? &always_stats : nullptr,
+        FLAGS_compare_admission_policy ? &tinylfu_stats : nullptr, FLAGS_output_file);
   } else {
     LOG(INFO) << "Cache hit statistics from the original trace:";
     DumpStatisticsToLog(original_trace_stats);
     LOG(INFO) << "Cache hit statistics from the replay:";
     DumpStatisticsToLog(replay_stats);
+    if (FLAGS_compare_range_lookup) {
+      LOG(INFO) << "Cache hit statistics from the replay with exact lookups only:";
+      DumpStatisticsToLog(exact_stats);
+      LOG(INFO) << "Cache hit statistics from the replay with range lookups:";
+      DumpStatisticsToLog(range_stats);
+      LOG(INFO) << Substitute("Byte hit ratio: $0 (exact lookups) vs $1 (range lookups)."
+          " Gain: $2", ByteHitRatio(exact_stats), ByteHitRatio(range_stats),
+          ByteHitRatio(range_stats) - ByteHitRatio(exact_stats));
+    }
+    if (FLAGS_compare_admission_policy) {
+      LOG(INFO) << "Cache hit statistics from the replay with ALWAYS admission:";
+      DumpStatisticsToLog(always_stats);
+      LOG(INFO) << "Cache hit statistics from the replay with TINYLFU admission:";
+      DumpStatisticsToLog(tinylfu_stats);
+      LOG(INFO) << Substitute("Byte hit ratio: $0 (ALWAYS) vs $1 (TINYLFU). Gain: $2",
+          ByteHitRatio(always_stats), ByteHitRatio(tinylfu_stats),
+          ByteHitRatio(tinylfu_stats) - ByteHitRatio(always_stats));
+    }
   }
   return 0;
 }
@@ -35,6 +35,8 @@
 #include "gutil/strings/split.h"
 #include "gutil/walltime.h"
 #include "runtime/io/data-cache-trace.h"
+#include "runtime/io/io-uring.h"
+#include "runtime/mem-tracker.h"
 #include "util/bit-util.h"
 #include "util/cache/cache.h"
 #include "util/error-util.h"
@@ -47,6 +49,8 @@
 #include "util/pretty-printer.h"
 #include "util/scope-exit-trigger.h"
 #include "util/test-info.h"
+#include "util/thread.h"
+#include "util/time.h"
 #include "util/uid-util.h"
 
 #ifndef FALLOC_FL_PUNCH_HOLE
@@ -81,6 +85,16 @@ DEFINE_int32(data_cache_max_opened_files, 1000,
 DEFINE_int32(data_cache_write_concurrency, 1,
     "(Advanced) Number of concurrent threads allowed to insert into the cache per "
     "partition.");
+DEFINE_int64(data_cache_write_queue_bytes, 0,
+    "(Advanced) If positive, Store() copies the data into a write-behind queue of the "
+    "partition and returns without waiting for the write to the backing file. This is "
+    "the maximum number of bytes queued per partition. Inserts are dropped once the "
+    "queue is full. --data_cache_write_concurrency doesn't apply in this mode. If 0, "
+    "inserts are written synchronously by the caller of Store().");
+DEFINE_int64(data_cache_write_batch_bytes, 4L << 20,
+    "(Advanced) The maximum number of bytes of queued inserts which are coalesced into "
+    "a single sequential write to a backing file when --data_cache_write_queue_bytes is "
+    "positive.");
 DEFINE_bool(data_cache_checksum, ENABLE_CHECKSUMMING,
     "(Advanced) Enable checksumming for the cached buffer.");
 
@@ -92,6 +106,8 @@ DEFINE_bool(data_cache_anonymize_trace, false,
 DEFINE_int32(data_cache_trace_percentage, 100, "The percentage of cache lookups that "
     "should be emitted to the trace file.");
 DECLARE_string(log_dir);
+DECLARE_bool(use_io_uring);
+DECLARE_int64(io_uring_chunk_bytes);
 DEFINE_string(data_cache_trace_dir, "", "The base directory for data cache tracing. "
     "The data cache trace files for each cache directory are placed in separate "
     "subdirectories underneath this base directory. If blank, defaults to "
@@ -107,12 +123,40 @@ DEFINE_string(data_cache_eviction_policy, "LRU",
     "(Advanced) The cache eviction policy to use for the data cache. "
     "Either 'LRU' (default) or 'LIRS' (experimental)");
 
+DEFINE_string(data_cache_admission_policy, "ALWAYS",
+    "(Advanced) The cache admission policy to use for the data cache. Either 'ALWAYS' "
+    "(default), which caches every inserted range, or 'TINYLFU', which only caches a "
+    "range if it would evict a range which was looked up less frequently. TINYLFU "
+    "prevents large scans from flushing out the frequently accessed ranges.");
+
+DEFINE_bool(data_cache_enable_range_lookup, false,
+    "(Advanced) If true, the data cache keeps a per-file index of the cached ranges so "
+    "that a lookup can be served from any cached ranges covering it and insertions of "
+    "ranges overlapping cached data only store the bytes not already cached. All ranges "
+    "of a file are placed in the same cache partition in this mode.");
+
+DEFINE_bool(data_cache_persist_metadata, false,
+    "(Advanced) If true, each data cache partition periodically checkpoints the "
+    "metadata of its cached entries into a file next to its backing files. On startup, "
+    "the metadata is reloaded and the backing files are reused instead of being deleted, "
+    "so the content of the cache survives restarts. Entries which were evicted since the "
+    "last checkpoint are detected and dropped on reload.");
+DEFINE_int32(data_cache_checkpoint_interval_s, 60,
+    "(Advanced) Interval in seconds between metadata checkpoints of the data cache when "
+    "--data_cache_persist_metadata is true. If 0, the metadata is only checkpointed when "
+    "the cache is shut down.");
+
 namespace impala {
 namespace io {
 
 static const int64_t PAGE_SIZE = 1L << 12;
 const char* DataCache::Partition::CACHE_FILE_PREFIX = "impala-cache-file-";
+const char* DataCache::Partition::METADATA_FILE_NAME = "impala-cache-metadata";
 const int MAX_FILE_DELETER_QUEUE_SIZE = 500;
+
+/// Magic number at the start of a metadata checkpoint file. Bump the version in the last
+/// byte when changing the format.
+static const uint64_t METADATA_MAGIC = 0x31444d4341434449; // "IDCACMD1"
 static const char* PARTITION_PATH_METRIC_KEY_TEMPLATE =
     "impala-server.io-mgr.remote-data-cache-partition-$0.path";
 static const char* PARTITION_READ_LATENCY_METRIC_KEY_TEMPLATE =
@@ -121,6 +165,11 @@ static const char* PARTITION_WRITE_LATENCY_METRIC_KEY_TEMPLATE =
     "impala-server.io-mgr.remote-data-cache-partition-$0.write-latency";
 static const char* PARTITION_EVICTION_LATENCY_METRIC_KEY_TEMPLATE =
     "impala-server.io-mgr.remote-data-cache-partition-$0.eviction-latency";
+static const char* PARTITION_WRITE_QUEUE_LATENCY_METRIC_KEY_TEMPLATE =
+    "impala-server.io-mgr.remote-data-cache-partition-$0.write-queue-latency";
+
+/// Zeros for padding the entries of a coalesced write to page boundaries.
+static const uint8_t ZERO_PAGE[PAGE_SIZE] = {};
 
 
 /// This class is an implementation of backing files in a cache partition.
@@ -151,14 +200,38 @@ static const char* PARTITION_EVICTION_LATENCY_METRIC_KEY_TEMPLATE =
 class DataCache::CacheFile {
  public:
   ~CacheFile() {
-    // Close file if it's not closed already.
-    DeleteFile();
+    // Close file if it's not closed already. Keep the file around if its content is
+    // referenced by a metadata checkpoint.
+    if (keep_on_destruction_) {
+      Close();
+    } else {
+      DeleteFile();
+    }
   }
 
   static Status Create(std::string path, std::unique_ptr<CacheFile>* cache_file_ptr) {
     unique_ptr<CacheFile> cache_file(new CacheFile(path));
     KUDU_RETURN_IF_ERROR(kudu::Env::Default()->NewRWFile(path, &cache_file->file_),
         "Failed to create cache file");
+    RETURN_IF_ERROR(cache_file->OpenIoUringFd());
+    *cache_file_ptr = std::move(cache_file);
+    return Status::OK();
+  }
+
+  // Opens an existing backing file created by a previous run of Impala. The file is
+  // read-only in the sense that no new data will be appended to it.
+  static Status Open(std::string path, std::unique_ptr<CacheFile>* cache_file_ptr) {
+    unique_ptr<CacheFile> cache_file(new CacheFile(path));
+    kudu::RWFileOptions opts;
+    opts.mode = Env::MUST_EXIST;
+    KUDU_RETURN_IF_ERROR(
+        kudu::Env::Default()->NewRWFile(opts, path, &cache_file->file_),
+        "Failed to open cache file");
+    uint64_t size;
+    KUDU_RETURN_IF_ERROR(cache_file->file_->Size(&size), "Failed to get file size");
+    cache_file->current_offset_.Store(BitUtil::RoundUp(size, PAGE_SIZE));
+    cache_file->allow_append_ = false;
+    RETURN_IF_ERROR(cache_file->OpenIoUringFd());
     *cache_file_ptr = std::move(cache_file);
     return Status::OK();
   }
@@ -176,6 +249,10 @@ class DataCache::CacheFile {
           status.ToString());
     }
     file_.reset();
+    if (io_uring_fd_ >= 0) {
+      close(io_uring_fd_);
+      io_uring_fd_ = -1;
+    }
     allow_append_ = false;
   }
 
@@ -211,15 +288,28 @@ class DataCache::CacheFile {
     return insertion_offset;
   }
 
-  // Reads from byte offset 'offset' for 'bytes_to_read' bytes into 'buffer'.
+  // Reads from byte offset 'offset' for 'bytes_to_read' bytes into 'buffer'. 'offset'
+  // need not be page aligned as a sub-range lookup may start in the middle of an entry.
   // Returns true iff read succeeded. Returns false on error or if the file
   // is already closed.
   bool Read(int64_t offset, uint8_t* buffer, int64_t bytes_to_read) {
-    DCHECK_EQ(offset % PAGE_SIZE, 0);
     // Hold the lock in shared mode to check if 'file_' is not closed already.
     kudu::shared_lock<rw_spinlock> lock(lock_.get_lock());
     if (UNLIKELY(!file_)) return false;
     DCHECK_LE(offset + bytes_to_read, current_offset_.Load());
+    IoUring* ring = GetIoUring();
+    if (ring != nullptr) {
+      int64_t bytes_read = 0;
+      Status status = ring->Read(io_uring_fd_, buffer, bytes_to_read, offset,
+          FLAGS_io_uring_chunk_bytes, &bytes_read);
+      if (UNLIKELY(!status.ok() || bytes_read < bytes_to_read)) {
+        LOG(ERROR) << Substitute("Failed to read from $0 at offset $1 for $2 bytes: $3",
+            path_, offset, PrettyPrinter::PrintBytes(bytes_to_read),
+            status.ok() ? "unexpected end of file" : status.GetDetail());
+        return false;
+      }
+      return true;
+    }
     kudu::Status status = file_->Read(offset, Slice(buffer, bytes_to_read));
     if (UNLIKELY(!status.ok())) {
       LOG(ERROR) << Substitute("Failed to read from $0 at offset $1 for $2 bytes: $3",
@@ -239,6 +329,17 @@ class DataCache::CacheFile {
     kudu::shared_lock<rw_spinlock> lock(lock_.get_lock());
     if (UNLIKELY(!file_)) return false;
     DCHECK_LE(offset + buffer_len, current_offset_.Load());
+    IoUring* ring = GetIoUring();
+    if (ring != nullptr) {
+      Status status = ring->Write(
+          io_uring_fd_, buffer, buffer_len, offset, FLAGS_io_uring_chunk_bytes);
+      if (UNLIKELY(!status.ok())) {
+        LOG(ERROR) << Substitute("Failed to write to $0 at offset $1 for $2 bytes: $3",
+            path_, offset, PrettyPrinter::PrintBytes(buffer_len), status.GetDetail());
+        return false;
+      }
+      return true;
+    }
     kudu::Status status = file_->Write(offset, Slice(buffer, buffer_len));
     if (UNLIKELY(!status.ok())) {
       LOG(ERROR) << Substitute("Failed to write to $0 at offset $1 for $2 bytes: $3",
@@ -248,6 +349,48 @@ class DataCache::CacheFile {
     return true;
   }
 
+  // Writes the buffers in 'data' back to back starting at byte offset 'offset' in the
+  // file with a single vectored write. Returns true iff write succeeded. Returns false
+  // on errors or if the file is already closed.
+  bool WriteV(int64_t offset, const vector<Slice>& data, int64_t total_len) {
+    DCHECK_EQ(offset % PAGE_SIZE, 0);
+    kudu::shared_lock<rw_spinlock> lock(lock_.get_lock());
+    if (UNLIKELY(!file_)) return false;
+    DCHECK_LE(offset + total_len, current_offset_.Load());
+    IoUring* ring = GetIoUring();
+    if (ring != nullptr) {
+      // All buffers are in flight at the same time instead of a single vectored write.
+      vector<unique_ptr<IoUring::Transfer>> transfers;
+      int64_t buffer_offset = offset;
+      for (const Slice& buffer : data) {
+        transfers.emplace_back(new IoUring::Transfer(IoUring::Opcode::WRITE,
+            io_uring_fd_, const_cast<uint8_t*>(buffer.data()), buffer.size(),
+            buffer_offset, FLAGS_io_uring_chunk_bytes));
+        ring->Start(transfers.back().get());
+        buffer_offset += buffer.size();
+      }
+      DCHECK_EQ(buffer_offset - offset, total_len);
+      Status status;
+      for (const unique_ptr<IoUring::Transfer>& transfer : transfers) {
+        ring->WaitFor(transfer.get());
+        if (status.ok()) status = transfer->GetStatus();
+      }
+      if (UNLIKELY(!status.ok())) {
+        LOG(ERROR) << Substitute("Failed to write to $0 at offset $1 for $2 bytes: $3",
+            path_, offset, PrettyPrinter::PrintBytes(total_len), status.GetDetail());
+        return false;
+      }
+      return true;
+    }
+    kudu::Status status = file_->WriteV(offset, data);
+    if (UNLIKELY(!status.ok())) {
+      LOG(ERROR) << Substitute("Failed to write to $0 at offset $1 for $2 bytes: $3",
+          path_, offset, PrettyPrinter::PrintBytes(total_len), status.ToString());
+      return false;
+    }
+    return true;
+  }
+
   void PunchHole(int64_t offset, int64_t hole_size) {
     DCHECK_EQ(offset % PAGE_SIZE, 0);
     DCHECK_EQ(hole_size % PAGE_SIZE, 0);
@@ -262,12 +405,42 @@ class DataCache::CacheFile {
     }
   }
 
+  // Flushes the content of the file to the storage. Returns true iff the flush
+  // succeeded. Returns false on error or if the file is already closed.
+  bool Sync() {
+    kudu::shared_lock<rw_spinlock> lock(lock_.get_lock());
+    if (UNLIKELY(!file_)) return false;
+    kudu::Status status = file_->Sync();
+    if (UNLIKELY(!status.ok())) {
+      LOG(WARNING) << Substitute("Failed to sync $0: $1", path_, status.ToString());
+      return false;
+    }
+    return true;
+  }
+
+  // Retrieves the live (i.e. not punched) extents of the file into 'extents'.
+  Status GetExtentMap(RWFile::ExtentMap* extents) {
+    kudu::shared_lock<rw_spinlock> lock(lock_.get_lock());
+    if (UNLIKELY(!file_)) return Status(Substitute("$0 is already closed", path_));
+    KUDU_RETURN_IF_ERROR(file_->GetExtentMap(extents),
+        Substitute("Failed to get extents of $0", path_));
+    return Status::OK();
+  }
+
   const string& path() const { return path_; }
 
+  // Returns the offset in the file at which the next insertion would be appended.
+  int64_t size() const { return current_offset_.Load(); }
+
+  void set_keep_on_destruction() { keep_on_destruction_ = true; }
+
  private:
   /// Full path of the backing file in the local storage.
   const string path_;
 
+  /// If true, the file is only closed but not deleted on destruction.
+  bool keep_on_destruction_ = false;
+
   /// The underlying backing file. NULL if the file has been closed.
   unique_ptr<RWFile> file_;
 
@@ -285,9 +458,31 @@ class DataCache::CacheFile {
   /// punched after it has been closed. The only operation allowed is to deletion.
   percpu_rwlock lock_;
 
+  /// A second file descriptor of the file for reads and writes through io_uring, as
+  /// 'file_' doesn't expose its own. -1 if --use_io_uring isn't set, io_uring isn't
+  /// supported or the file has been closed.
+  int io_uring_fd_ = -1;
+
   /// C'tor of CacheFile to be called by Create() only.
   explicit CacheFile(std::string path) : path_(move(path)) { }
 
+  /// Opens 'io_uring_fd_' if --use_io_uring is set and io_uring is supported.
+  Status OpenIoUringFd() {
+    if (!FLAGS_use_io_uring || !IoUring::IsSupported()) return Status::OK();
+    io_uring_fd_ = open(path_.c_str(), O_RDWR | O_CLOEXEC);
+    if (io_uring_fd_ < 0) {
+      return Status(Substitute("Failed to open $0 for io_uring: $1", path_,
+          GetStrErrMsg()));
+    }
+    return Status::OK();
+  }
+
+  /// Returns the io_uring of the calling thread if reads and writes of the file should
+  /// go through it, otherwise nullptr. The caller must hold 'lock_' in shared mode.
+  IoUring* GetIoUring() {
+    return io_uring_fd_ >= 0 ? IoUring::ThreadLocal() : nullptr;
+  }
+
   DISALLOW_COPY_AND_ASSIGN(CacheFile);
 };
 
@@ -328,19 +523,27 @@ class DataCache::CacheEntry {
 /// The key used for look up in the cache.
 struct DataCache::CacheKey {
  public:
-  explicit CacheKey(const string& filename, int64_t mtime, int64_t offset)
+  explicit CacheKey(const Slice& filename, int64_t mtime, int64_t offset)
     : key_(filename.size() + sizeof(mtime) + sizeof(offset)) {
     DCHECK_GE(mtime, 0);
     DCHECK_GE(offset, 0);
     key_.append(&mtime, sizeof(mtime));
     key_.append(&offset, sizeof(offset));
-    key_.append(filename);
+    key_.append(filename.data(), filename.size());
   }
 
   int64_t Hash() const {
     return HashUtil::FastHash64(key_.data(), key_.size(), 0);
   }
 
+  /// Hash of (mtime, filename) only. Used for picking the partition when all ranges
+  /// of a file need to end up in the same partition.
+  int64_t FileHash() const {
+    uint64_t hash = HashUtil::FastHash64(key_.data() + OFFSETOF_FILENAME,
+        key_.size() - OFFSETOF_FILENAME, 0);
+    return HashUtil::FastHash64(key_.data() + OFFSETOF_MTIME, sizeof(int64_t), hash);
+  }
+
   Slice filename() const {
     return Slice(key_.data() + OFFSETOF_FILENAME, key_.size() - OFFSETOF_FILENAME);
   }
@@ -357,6 +560,37 @@ struct DataCache::CacheKey {
     return key_;
   }
 
+  /// Returns the identifier of the file version (i.e. (mtime, filename)) referenced
+  /// by this key. Used as the key of the per-file range index.
+  string FileKey() const {
+    return FileKey(ToSlice());
+  }
+
+  /// Same as above but for a key encoded in 'key' (e.g. a key passed to the eviction
+  /// callback).
+  static string FileKey(const Slice& key) {
+    DCHECK_GE(key.size(), OFFSETOF_FILENAME);
+    string file_key(reinterpret_cast<const char*>(key.data()) + OFFSETOF_MTIME,
+        sizeof(int64_t));
+    file_key.append(reinterpret_cast<const char*>(key.data()) + OFFSETOF_FILENAME,
+        key.size() - OFFSETOF_FILENAME);
+    return file_key;
+  }
+
+  /// Returns the file offset, mtime and filename of a key encoded in 'key'.
+  static int64_t Offset(const Slice& key) {
+    DCHECK_GE(key.size(), OFFSETOF_FILENAME);
+    return UNALIGNED_LOAD64(key.data() + OFFSETOF_OFFSET);
+  }
+  static int64_t Mtime(const Slice& key) {
+    DCHECK_GE(key.size(), OFFSETOF_FILENAME);
+    return UNALIGNED_LOAD64(key.data() + OFFSETOF_MTIME);
+  }
+  static Slice Filename(const Slice& key) {
+    DCHECK_GE(key.size(), OFFSETOF_FILENAME);
+    return Slice(key.data() + OFFSETOF_FILENAME, key.size() - OFFSETOF_FILENAME);
+  }
+
  private:
   // Key encoding stored in key_:
   //
@@ -377,16 +611,31 @@ static Cache::EvictionPolicy GetCacheEvictionPolicy(const std::string& policy_st
   return policy;
 }
 
+// The expected average size of a cached entry. Only used for sizing the frequency
+// sketch of the TinyLFU admission policy, which tolerates a bad estimate.
+static const int64_t EXPECTED_ENTRY_SIZE = 1L << 20;
+
+// Minimum number of entries for sizing the frequency sketch.
+static const int64_t MIN_EXPECTED_ENTRIES = 1024;
+
 DataCache::Partition::Partition(
     int32_t index, const string& path, int64_t capacity, int max_opened_files,
-    bool trace_replay)
+    bool trace_replay, MemTracker* write_queue_mem_tracker)
   : index_(index),
     path_(path),
     capacity_(max<int64_t>(capacity, PAGE_SIZE)),
     max_opened_files_(max_opened_files),
     trace_replay_(trace_replay),
+    enable_range_lookup_(FLAGS_data_cache_enable_range_lookup),
+    count_range_misses_(enable_range_lookup_ &&
+        Cache::ParseAdmissionPolicy(FLAGS_data_cache_admission_policy)
+            == Cache::AdmissionPolicy::TINY_LFU),
+    persist_metadata_(FLAGS_data_cache_persist_metadata && !trace_replay),
+    write_queue_capacity_(trace_replay ? 0 : FLAGS_data_cache_write_queue_bytes),
+    write_queue_mem_tracker_(write_queue_mem_tracker),
     meta_cache_(NewCache(GetCacheEvictionPolicy(FLAGS_data_cache_eviction_policy),
-        capacity_, path_)) {}
+        capacity_, path_, Cache::ParseAdmissionPolicy(FLAGS_data_cache_admission_policy),
+        max(capacity_ / EXPECTED_ENTRY_SIZE, MIN_EXPECTED_ENTRIES))) {}
 
 DataCache::Partition::~Partition() {
   if (!closed_) ReleaseResources();
@@ -406,12 +655,18 @@ Status DataCache::Partition::CreateCacheFile() {
 
 Status DataCache::Partition::DeleteExistingFiles() const {
   DCHECK(!trace_replay_);
+  // Backing files reloaded from a metadata checkpoint are kept.
+  set<string> files_to_keep;
+  for (const auto& cache_file : cache_files_) files_to_keep.insert(cache_file->path());
   vector<string> entries;
   RETURN_IF_ERROR(FileSystemUtil::Directory::GetEntryNames(path_, &entries, 0,
       FileSystemUtil::Directory::EntryType::DIR_ENTRY_REG));
   for (const string& entry : entries) {
-    if (entry.find(CACHE_FILE_PREFIX) == 0) {
-      const string file_path = JoinPathSegments(path_, entry);
+    const string file_path = JoinPathSegments(path_, entry);
+    // A stale metadata checkpoint is deleted if persistence is disabled.
+    bool is_stale_metadata = !persist_metadata_ && entry == METADATA_FILE_NAME;
+    if ((entry.find(CACHE_FILE_PREFIX) == 0 && files_to_keep.count(file_path) == 0)
+        || is_stale_metadata) {
       KUDU_RETURN_IF_ERROR(kudu::Env::Default()->DeleteFile(file_path),
           Substitute("Failed to delete old cache file $0", file_path));
       LOG(INFO) << Substitute("Deleted old cache file $0", file_path);
@@ -435,12 +690,28 @@ Status DataCache::Partition::Init() {
   }
   RETURN_IF_ERROR(FileSystemUtil::VerifyIsDirectory(path_));
 
-  // Delete all existing backing files left over from previous runs.
+  // Try reloading the cached entries from the metadata checkpoint of the previous run.
+  // The cache starts out empty if it cannot be reloaded for any reason.
+  int64_t restored_bytes = 0;
+  if (persist_metadata_) {
+    Status load_status = LoadCheckpoint(&restored_bytes);
+    if (!load_status.ok()) {
+      LOG(WARNING) << Substitute("Failed to load data cache metadata from $0. Starting "
+          "with an empty cache: $1", path_, load_status.GetDetail());
+      DCHECK(cache_files_.empty());
+      restored_bytes = 0;
+    }
+  }
+
+  // Delete all existing backing files left over from previous runs which are not
+  // referenced by the reloaded entries.
   RETURN_IF_ERROR(DeleteExistingFiles());
 
-  // Check if there is enough space available at this point in time.
+  // Check if there is enough space available at this point in time. Space used by the
+  // reloaded entries counts towards the capacity.
   uint64_t available_bytes;
   RETURN_IF_ERROR(FileSystemUtil::GetSpaceAvailable(path_, &available_bytes));
+  available_bytes += restored_bytes;
   if (available_bytes < capacity_) {
     const string& err = Substitute("Insufficient space for $0. Required $1. Only $2 is "
         "available", path_, PrettyPrinter::PrintBytes(capacity_),
@@ -478,9 +749,17 @@ Status DataCache::Partition::Init() {
   // Create metrics for this partition
   InitMetrics();
 
-  // Create a backing file for the partition.
+  // Create a backing file for the partition. Reloaded backing files are never appended
+  // to so a new one is always needed.
   RETURN_IF_ERROR(CreateCacheFile());
   oldest_opened_file_ = 0;
+
+  // Start the thread which drains the write-behind queue.
+  if (write_queue_capacity_ > 0) {
+    RETURN_IF_ERROR(Thread::Create("impala-server",
+        Substitute("data-cache-writer-$0", index_), &DataCache::Partition::WriterLoop,
+        this, &writer_thread_));
+  }
   return Status::OK();
 }
 
@@ -503,9 +782,13 @@ void DataCache::Partition::InitMetrics() {
     eviction_latency_ =
       ImpaladMetrics::IO_MGR_METRICS->FindMetricForTesting<HistogramMetric>(
           Substitute(PARTITION_EVICTION_LATENCY_METRIC_KEY_TEMPLATE, i_string));
+    write_queue_latency_ =
+      ImpaladMetrics::IO_MGR_METRICS->FindMetricForTesting<HistogramMetric>(
+          Substitute(PARTITION_WRITE_QUEUE_LATENCY_METRIC_KEY_TEMPLATE, i_string));
     DCHECK(read_latency_ != nullptr);
     DCHECK(write_latency_ != nullptr);
     DCHECK(eviction_latency_ != nullptr);
+    DCHECK(write_queue_latency_ != nullptr);
     return;
   }
   // Two cases:
@@ -514,6 +797,7 @@ void DataCache::Partition::InitMetrics() {
   DCHECK(read_latency_ == nullptr);
   DCHECK(write_latency_ == nullptr);
   DCHECK(eviction_latency_ == nullptr);
+  DCHECK(write_queue_latency_ == nullptr);
   int64_t ONE_HOUR_IN_NS = 60L * 60L * NANOS_PER_SEC;
   ImpaladMetrics::IO_MGR_METRICS->AddProperty<string>(
       PARTITION_PATH_METRIC_KEY_TEMPLATE, path_, i_string);
@@ -527,6 +811,10 @@ void DataCache::Partition::InitMetrics() {
       ImpaladMetrics::IO_MGR_METRICS->RegisterMetric(new HistogramMetric(
           MetricDefs::Get(PARTITION_EVICTION_LATENCY_METRIC_KEY_TEMPLATE, i_string),
           ONE_HOUR_IN_NS, 3));
+  write_queue_latency_ =
+      ImpaladMetrics::IO_MGR_METRICS->RegisterMetric(new HistogramMetric(
+          MetricDefs::Get(PARTITION_WRITE_QUEUE_LATENCY_METRIC_KEY_TEMPLATE, i_string),
+          ONE_HOUR_IN_NS, 3));
 }
 
 Status DataCache::Partition::CloseFilesAndVerifySizes() {
@@ -554,19 +842,52 @@ Status DataCache::Partition::CloseFilesAndVerifySizes() {
 }
 
 void DataCache::Partition::ReleaseResources() {
+  // Stop the writer thread. Queued inserts which haven't been written yet are dropped.
+  if (writer_thread_ != nullptr) {
+    {
+      std::lock_guard<std::mutex> l(write_queue_lock_);
+      write_queue_shut_down_ = true;
+    }
+    write_queue_cv_.NotifyAll();
+    writer_thread_->Join();
+    writer_thread_.reset();
+  }
+  // Checkpoint the metadata before closing so the backing files can be reused by the
+  // next run.
+  bool keep_files = false;
+  if (persist_metadata_ && !closed_) {
+    Status status = Checkpoint();
+    if (!status.ok()) {
+      LOG(WARNING) << Substitute("Failed to checkpoint data cache metadata in $0: $1",
+          path_, status.GetDetail());
+    }
+    keep_files = status.ok();
+  }
   std::unique_lock<SpinLock> partition_lock(lock_);
   if (closed_) return;
   closed_ = true;
-  // Close and delete all backing files in this partition.
+  // Close and delete all backing files in this partition unless they are referenced
+  // by the checkpoint.
+  if (keep_files) {
+    for (auto& cache_file : cache_files_) cache_file->set_keep_on_destruction();
+  }
   cache_files_.clear();
   // Free all memory consumed by the metadata cache.
   meta_cache_.reset();
+  {
+    std::lock_guard<SpinLock> l(range_index_lock_);
+    range_index_.clear();
+    pending_range_index_.clear();
+  }
+  std::lock_guard<SpinLock> l(entry_keys_lock_);
+  entry_keys_.clear();
 }
 
 int64_t DataCache::Partition::Lookup(const CacheKey& cache_key, int64_t bytes_to_read,
     uint8_t* buffer) {
   DCHECK(!closed_);
   DCHECK(trace_replay_ ? buffer == nullptr : buffer != nullptr);
+  if (enable_range_lookup_) return LookupRanges(cache_key, bytes_to_read, buffer);
   Slice key = cache_key.ToSlice();
   Cache::UniqueHandle handle(meta_cache_->Lookup(key));
 
@@ -606,6 +927,187 @@ int64_t DataCache::Partition::Lookup(const CacheKey& cache_key, int64_t bytes_to
   return bytes_to_read;
 }
 
+int64_t DataCache::Partition::LookupRanges(const CacheKey& cache_key,
+    int64_t bytes_to_read, uint8_t* buffer) {
+  DCHECK(enable_range_lookup_);
+  const string& file_key = cache_key.FileKey();
+  int64_t offset = cache_key.offset();
+  int64_t bytes_read = 0;
+  // Copy out from consecutive cached ranges until either 'bytes_to_read' bytes are read
+  // or there is a gap in the cached ranges.
+  while (bytes_read < bytes_to_read) {
+    int64_t range_start;
+    int64_t range_len;
+    if (!FindCoveringRange(file_key, offset, &range_start, &range_len)) break;
+    const CacheKey range_key(cache_key.filename(), cache_key.mtime(), range_start);
+    int64_t read_len = min(range_start + range_len - offset, bytes_to_read - bytes_read);
+    int64_t len = ReadFromEntry(range_key, offset - range_start, read_len,
+        buffer == nullptr ? nullptr : buffer + bytes_read);
+    if (len == 0) break;
+    bytes_read += len;
+    offset += len;
+  }
+  // The missing part would be inserted with the key at the first byte not read. Count
+  // an access to that key for the TinyLFU admission policy, as a plain lookup would.
+  if (count_range_misses_ && bytes_read < bytes_to_read) {
+    meta_cache_->Lookup(
+        CacheKey(cache_key.filename(), cache_key.mtime(), offset).ToSlice());
+  }
+  if (bytes_read == 0) {
+    Trace(trace::EventType::MISS, cache_key, bytes_to_read, /*entry_len=*/-1);
+  } else {
+    Trace(trace::EventType::HIT, cache_key, bytes_to_read, bytes_read);
+  }
+  return bytes_read;
+}
+
+int64_t DataCache::Partition::ReadFromEntry(const CacheKey& cache_key,
+    int64_t entry_offset, int64_t bytes_to_read, uint8_t* buffer) {
+  Slice key = cache_key.ToSlice();
+  Cache::UniqueHandle handle(meta_cache_->Lookup(key));
+  if (handle.get() == nullptr) return 0;
+
+  CacheEntry entry(meta_cache_->Value(handle));
+  if (entry_offset >= entry.len()) return 0;
+  bytes_to_read = min(entry.len() - entry_offset, bytes_to_read);
+  // Skip the actual reads if doing trace replay
+  if (LIKELY(!trace_replay_)) {
+    CacheFile* cache_file = entry.file();
+    VLOG(3) << Substitute("Reading file $0 offset $1 len $2 checksum $3 entry_offset $4 "
+        "bytes_to_read $5", cache_file->path(), entry.offset(), entry.len(),
+        entry.checksum(), entry_offset, bytes_to_read);
+    bool read_success;
+    {
+      ScopedHistogramTimer read_timer(read_latency_);
+      read_success =
+          cache_file->Read(entry.offset() + entry_offset, buffer, bytes_to_read);
+    }
+    if (UNLIKELY(!read_success)) {
+      meta_cache_->Erase(key);
+      return 0;
+    }
+
+    // Checksum can only be verified if the entire entry is read.
+    if (FLAGS_data_cache_checksum && entry_offset == 0 && bytes_to_read == entry.len()
+        && !VerifyChecksum("read", entry, buffer, bytes_to_read)) {
+      meta_cache_->Erase(key);
+      return 0;
+    }
+  }
+  return bytes_to_read;
+}
+
+bool DataCache::Partition::FindCoveringRange(const string& file_key, int64_t offset,
+    int64_t* range_start, int64_t* range_len) {
+  std::lock_guard<SpinLock> l(range_index_lock_);
+  auto file_it = range_index_.find(file_key);
+  if (file_it == range_index_.end()) return false;
+  const RangeMap& ranges = file_it->second;
+  // Find the last range starting at or before 'offset'.
+  auto it = ranges.upper_bound(offset);
+  if (it == ranges.begin()) return false;
+  --it;
+  if (it->first + it->second <= offset) return false;
+  *range_start = it->first;
+  *range_len = it->second;
+  return true;
+}
+
+bool DataCache::Partition::TrimToUncovered(const string& file_key, int64_t* start,
+    int64_t* end, vector<int64_t>* contained_ranges) {
+  std::lock_guard<SpinLock> l(range_index_lock_);
+  auto file_it = range_index_.find(file_key);
+  if (file_it != range_index_.end()) {
+    const RangeMap& ranges = file_it->second;
+    // Advance 'start' past any cached ranges covering it. Adjacent ranges may cover
+    // more than one range's worth so keep going until hitting a gap.
+    while (*start < *end) {
+      auto it = ranges.upper_bound(*start);
+      if (it == ranges.begin()) break;
+      --it;
+      if (it->first + it->second <= *start) break;
+      *start = it->first + it->second;
+    }
+    // Pull back 'end' before any cached ranges covering the last byte.
+    while (*start < *end) {
+      auto it = ranges.upper_bound(*end - 1);
+      if (it == ranges.begin()) break;
+      --it;
+      if (it->first + it->second < *end || it->first <= *start) break;
+      *end = it->first;
+    }
+    if (*start >= *end) return true;
+    // Ranges which lie entirely within [start, end) are superseded by the new entry.
+    for (auto it = ranges.upper_bound(*start);
+         it != ranges.end() && it->first < *end; ++it) {
+      if (it->first + it->second <= *end) contained_ranges->push_back(it->first);
+    }
+  }
+  if (*start >= *end) return true;
+  // The pending ranges never overlap each other, so only the last one starting before
+  // 'end' may overlap [start, end).
+  RangeMap& pending_ranges = pending_range_index_[file_key];
+  auto it = pending_ranges.lower_bound(*end);
+  if (it != pending_ranges.begin() && (--it)->first + it->second > *start) {
+    contained_ranges->clear();
+    return false;
+  }
+  pending_ranges.emplace(*start, *end - *start);
+  return true;
+}
+
+void DataCache::Partition::RemovePendingRange(const string& file_key, int64_t start) {
+  std::lock_guard<SpinLock> l(range_index_lock_);
+  auto file_it = pending_range_index_.find(file_key);
+  // The index is cleared by ReleaseResources() while inserts may still be queued.
+  if (file_it == pending_range_index_.end()) return;
+  file_it->second.erase(start);
+  if (file_it->second.empty()) pending_range_index_.erase(file_it);
+}
+
+void DataCache::Partition::AddRange(const string& file_key, int64_t start,
+    int64_t len) {
+  std::lock_guard<SpinLock> l(range_index_lock_);
+  // Keep the longer range if there are concurrent insertions at the same offset.
+  int64_t& range_len = range_index_[file_key][start];
+  range_len = max(range_len, len);
+}
+
+void DataCache::Partition::RemoveRange(const string& file_key, int64_t start,
+    int64_t len) {
+  std::lock_guard<SpinLock> l(range_index_lock_);
+  auto file_it = range_index_.find(file_key);
+  if (file_it == range_index_.end()) return;
+  RangeMap& ranges = file_it->second;
+  auto it = ranges.find(start);
+  // An entry may be replaced by a longer one with the same key. Don't remove the
+  // range of the new entry when the old entry is evicted.
+  if (it == ranges.end() || it->second != len) return;
+  ranges.erase(it);
+  if (ranges.empty()) range_index_.erase(file_it);
+}
+
+void DataCache::Partition::TrackEntry(const Slice& key, int64_t len) {
+  if (enable_range_lookup_) AddRange(CacheKey::FileKey(key), CacheKey::Offset(key), len);
+  if (persist_metadata_) {
+    std::lock_guard<SpinLock> l(entry_keys_lock_);
+    int64_t& entry_len = entry_keys_[key.ToString()];
+    entry_len = max(entry_len, len);
+  }
+}
+
+void DataCache::Partition::UntrackEntry(const Slice& key, int64_t len) {
+  if (enable_range_lookup_) {
+    RemoveRange(CacheKey::FileKey(key), CacheKey::Offset(key), len);
+  }
+  if (persist_metadata_) {
+    std::lock_guard<SpinLock> l(entry_keys_lock_);
+    auto it = entry_keys_.find(key.ToString());
+    // Same as RemoveRange(), don't untrack the entry which replaced this one.
+    if (it != entry_keys_.end() && it->second == len) entry_keys_.erase(it);
+  }
+}
+
 bool DataCache::Partition::HandleExistingEntry(const Slice& key,
     const Cache::UniqueHandle& handle, const uint8_t* buffer, int64_t buffer_len) {
   // Unpack the cache entry.
@@ -660,12 +1162,22 @@ bool DataCache::Partition::InsertIntoCache(const Slice& key, CacheFile* cache_fi
     }
   }
 
-  // Insert the new entry into the cache.
+  // Insert the new entry into the cache. The entry is tracked before it becomes visible
+  // so that the eviction callback always finds it.
   CacheEntry entry(cache_file, insertion_offset, buffer_len, checksum);
   memcpy(meta_cache_->MutableValue(&pending_handle), &entry, sizeof(CacheEntry));
+  TrackEntry(key, buffer_len);
+  // Trace replays do not keep metrics. The entry is accounted for before Insert() as
+  // the eviction callback undoes this if the entry is evicted or rejected by the
+  // admission policy during Insert().
+  if (LIKELY(!trace_replay_)) {
+    ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_TOTAL_BYTES->Increment(charge_len);
+    ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_NUM_ENTRIES->Increment(1);
+  }
   Cache::UniqueHandle handle(meta_cache_->Insert(std::move(pending_handle), this));
   // Check for failure of Insert(), which means the entry was evicted during Insert()
   if (UNLIKELY(handle.get() == nullptr)){
+    UntrackEntry(key, buffer_len);
     // Trace replays do not keep metrics
     if (LIKELY(!trace_replay_)) {
       ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_INSTANT_EVICTIONS->Increment(1);
@@ -674,8 +1186,6 @@ bool DataCache::Partition::InsertIntoCache(const Slice& key, CacheFile* cache_fi
   }
   // Trace replays do not keep metrics
   if (LIKELY(!trace_replay_)) {
-    ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_TOTAL_BYTES->Increment(charge_len);
-    ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_NUM_ENTRIES->Increment(1);
     ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_NUM_WRITES->Increment(1);
   }
   return true;
@@ -685,6 +1195,43 @@ bool DataCache::Partition::Store(const CacheKey& cache_key, const uint8_t* buffe
     int64_t buffer_len, bool* start_reclaim) {
   DCHECK(!closed_);
   *start_reclaim = false;
+  if (enable_range_lookup_) {
+    // Only store the part of the buffer not already covered by cached ranges.
+    int64_t start = cache_key.offset();
+    int64_t end = start + buffer_len;
+    vector<int64_t> contained_ranges;
+    const string& file_key = cache_key.FileKey();
+    if (!TrimToUncovered(file_key, &start, &end, &contained_ranges)) {
+      // Another insert of an overlapping range is in progress.
+      Trace(trace::EventType::STORE_FAILED_BUSY, cache_key, /*lookup_len=*/-1,
+          buffer_len);
+      return false;
+    }
+    if (start >= end) return false;
+    const CacheKey trimmed_key(cache_key.filename(), cache_key.mtime(), start);
+    const uint8_t* trimmed_buffer =
+        buffer == nullptr ? nullptr : buffer + (start - cache_key.offset());
+    bool success = StoreInternal(trimmed_key, trimmed_buffer, end - start,
+        move(contained_ranges), start_reclaim);
+    // The writer thread removes the pending range of a queued insert once it's written.
+    if (!success || write_queue_capacity_ == 0) RemovePendingRange(file_key, start);
+    return success;
+  }
+  return StoreInternal(cache_key, buffer, buffer_len, {}, start_reclaim);
+}
+
+void DataCache::Partition::EraseContainedRanges(const Slice& key,
+    const vector<int64_t>& contained_ranges) {
+  const Slice& filename = CacheKey::Filename(key);
+  const int64_t mtime = CacheKey::Mtime(key);
+  for (int64_t range_start : contained_ranges) {
+    meta_cache_->Erase(CacheKey(filename, mtime, range_start).ToSlice());
+  }
+}
+
+bool DataCache::Partition::StoreInternal(const CacheKey& cache_key,
+    const uint8_t* buffer, int64_t buffer_len, vector<int64_t> contained_ranges,
+    bool* start_reclaim) {
   Slice key = cache_key.ToSlice();
   const int64_t charge_len = BitUtil::RoundUp(buffer_len, PAGE_SIZE);
   if (charge_len > capacity_) return false;
@@ -697,6 +1244,11 @@ bool DataCache::Partition::Store(const CacheKey& cache_key, const uint8_t* buffe
     }
   }
 
+  if (write_queue_capacity_ > 0) {
+    return EnqueueWrite(cache_key, buffer, buffer_len, move(contained_ranges),
+        start_reclaim);
+  }
+
   CacheFile* cache_file;
   int64_t insertion_offset;
   if (LIKELY(!trace_replay_)) {
@@ -705,9 +1257,7 @@ bool DataCache::Partition::Store(const CacheKey& cache_key, const uint8_t* buffe
     // Limit the write concurrency to avoid blocking the caller (which could be calling
     // from the critical path of an IO read) when the cache becomes IO bound due to either
     // limited memory for page cache or the cache is undersized which leads to eviction.
-    //
-    // TODO: defer the writes to another thread which writes asynchronously. Need to bound
-    // the extra memory consumption for holding the temporary buffer though.
+    // See EnqueueWrite() for the asynchronous alternative.
     const bool exceed_concurrency =
         pending_insert_set_.size() >= FLAGS_data_cache_write_concurrency;
     if (exceed_concurrency ||
@@ -754,6 +1304,8 @@ bool DataCache::Partition::Store(const CacheKey& cache_key, const uint8_t* buffe
   bool insert_success = InsertIntoCache(key, cache_file, insertion_offset, buffer,
       buffer_len);
   if (insert_success) {
+    // The ranges contained in the newly inserted entry are now redundant.
+    EraseContainedRanges(key, contained_ranges);
     Trace(trace::EventType::STORE, cache_key, /* lookup_len=*/-1, buffer_len);
   } else {
     Trace(trace::EventType::STORE_FAILED, cache_key, /*lookup_len=*/ -1, buffer_len);
@@ -761,6 +1313,179 @@ bool DataCache::Partition::Store(const CacheKey& cache_key, const uint8_t* buffe
   return insert_success;
 }
 
+bool DataCache::Partition::EnqueueWrite(const CacheKey& cache_key,
+    const uint8_t* buffer, int64_t buffer_len, vector<int64_t> contained_ranges,
+    bool* start_reclaim) {
+  DCHECK(!trace_replay_);
+  string key = cache_key.ToSlice().ToString();
+  {
+    std::lock_guard<SpinLock> partition_lock(lock_);
+    if (pending_insert_set_.find(key) != pending_insert_set_.end()) {
+      Trace(trace::EventType::STORE_FAILED_BUSY, cache_key, /*lookup_len=*/-1,
+          buffer_len);
+      return false;
+    }
+    // The writer thread may have rotated the backing files since the last Store().
+    *start_reclaim = cache_files_.size() > max_opened_files_;
+    pending_insert_set_.emplace(key);
+  }
+  {
+    std::lock_guard<std::mutex> l(write_queue_lock_);
+    if (write_queue_bytes_ + buffer_len <= write_queue_capacity_
+        && write_queue_mem_tracker_->TryConsume(buffer_len)) {
+      // Take a copy of the buffer as the caller may reuse it as soon as we return.
+      PendingWrite write;
+      write.key = key;
+      write.buffer.reset(new uint8_t[buffer_len]);
+      memcpy(write.buffer.get(), buffer, buffer_len);
+      write.len = buffer_len;
+      write.enqueue_time_ns = MonotonicNanos();
+      write.contained_ranges = move(contained_ranges);
+      write_queue_.emplace_back(move(write));
+      write_queue_bytes_ += buffer_len;
+      ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_DEPTH->Increment(1);
+      ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_BYTES->Increment(buffer_len);
+      write_queue_cv_.NotifyOne();
+      return true;
+    }
+  }
+  // The queue is full or the memory limit is reached. Drop the insert.
+  {
+    std::lock_guard<SpinLock> partition_lock(lock_);
+    pending_insert_set_.erase(key);
+  }
+  ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_DROPPED_BYTES->Increment(buffer_len);
+  ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_DROPPED_ENTRIES->Increment(1);
+  Trace(trace::EventType::STORE_FAILED_BUSY, cache_key, /*lookup_len=*/-1, buffer_len);
+  return false;
+}
+
+void DataCache::Partition::WriterLoop() {
+  while (true) {
+    // Take the longest prefix of the queue which fits in a batch. A batch has at least
+    // one entry.
+    vector<PendingWrite> batch;
+    int64_t batch_bytes = 0;
+    {
+      std::unique_lock<std::mutex> l(write_queue_lock_);
+      while (write_queue_.empty() && !write_queue_shut_down_) write_queue_cv_.Wait(l);
+      if (write_queue_shut_down_) break;
+      int64_t batch_charge = 0;
+      while (!write_queue_.empty()) {
+        int64_t charge_len = BitUtil::RoundUp(write_queue_.front().len, PAGE_SIZE);
+        if (!batch.empty() &&
+            batch_charge + charge_len > FLAGS_data_cache_write_batch_bytes) {
+          break;
+        }
+        batch_charge += charge_len;
+        batch_bytes += write_queue_.front().len;
+        batch.emplace_back(move(write_queue_.front()));
+        write_queue_.pop_front();
+      }
+    }
+    WriteBatch(&batch);
+    const int64_t batch_size = batch.size();
+    // Free the copies of the data before releasing their memory.
+    batch.clear();
+    {
+      // The bytes are only released after the write so that the memory of the batch
+      // being written still counts towards the bound.
+      std::lock_guard<std::mutex> l(write_queue_lock_);
+      write_queue_bytes_ -= batch_bytes;
+    }
+    write_queue_mem_tracker_->Release(batch_bytes);
+    write_queue_drained_cv_.NotifyAll();
+    ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_DEPTH->Increment(-batch_size);
+    ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_BYTES->Increment(-batch_bytes);
+  }
+  // Drop whatever is left in the queue on shutdown.
+  std::lock_guard<std::mutex> l(write_queue_lock_);
+  ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_DEPTH->Increment(
+      -write_queue_.size());
+  ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_BYTES->Increment(
+      -write_queue_bytes_);
+  write_queue_.clear();
+  write_queue_mem_tracker_->Release(write_queue_bytes_);
+  write_queue_bytes_ = 0;
+}
+
+void DataCache::Partition::WriteBatch(vector<PendingWrite>* batch) {
+  DCHECK(!batch->empty());
+  // Remove the keys from the pending insertion set once done with the batch.
+  auto remove_from_pending_set = MakeScopeExitTrigger([this, batch]() {
+    std::lock_guard<SpinLock> partition_lock(lock_);
+    for (const PendingWrite& write : *batch) pending_insert_set_.erase(write.key);
+  });
+
+  // Lay out the entries back to back, each starting at a page boundary, so the whole
+  // batch goes out as a single sequential write.
+  vector<Slice> slices;
+  int64_t total_len = 0;
+  for (const PendingWrite& write : *batch) {
+    slices.emplace_back(write.buffer.get(), write.len);
+    int64_t padding = BitUtil::RoundUp(write.len, PAGE_SIZE) - write.len;
+    if (padding > 0) slices.emplace_back(ZERO_PAGE, padding);
+    total_len += write.len + padding;
+  }
+
+  // Allocate space for the whole batch in the current backing file.
+  CacheFile* cache_file;
+  int64_t insertion_offset;
+  {
+    std::unique_lock<SpinLock> partition_lock(lock_);
+    CHECK(!cache_files_.empty());
+    cache_file = cache_files_.back().get();
+    insertion_offset = cache_file->Allocate(total_len, partition_lock);
+    if (UNLIKELY(insertion_offset < 0) && CreateCacheFile().ok()) {
+      cache_file = cache_files_.back().get();
+      insertion_offset = cache_file->Allocate(total_len, partition_lock);
+    }
+  }
+  bool write_success = insertion_offset >= 0;
+  if (LIKELY(write_success)) {
+    VLOG(3) << Substitute("Storing $0 entries in file $1 offset $2 len $3",
+        batch->size(), cache_file->path(), insertion_offset, total_len);
+    ScopedHistogramTimer write_timer(write_latency_);
+    write_success = cache_file->WriteV(insertion_offset, slices, total_len);
+  }
+
+  // Insert the entries into the metadata cache. Space of the entries which failed to
+  // be inserted is reclaimed right away.
+  int64_t offset = insertion_offset;
+  int64_t now = MonotonicNanos();
+  for (const PendingWrite& write : *batch) {
+    write_queue_latency_->Update(now - write.enqueue_time_ns);
+    const int64_t charge_len = BitUtil::RoundUp(write.len, PAGE_SIZE);
+    const Slice key(write.key);
+    // Rebuild the cache key for tracing.
+    const CacheKey cache_key(CacheKey::Filename(key), CacheKey::Mtime(key),
+        CacheKey::Offset(key));
+    bool insert_success = write_success && InsertEntry(key,
+        CacheEntry(cache_file, offset, write.len,
+            FLAGS_data_cache_checksum ? Checksum(write.buffer.get(), write.len) : 0));
+    if (insert_success) {
+      // The ranges contained in the newly inserted entry are now redundant.
+      EraseContainedRanges(key, write.contained_ranges);
+      ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_NUM_WRITES->Increment(1);
+      Trace(trace::EventType::STORE, cache_key, /* lookup_len=*/-1, write.len);
+    } else {
+      if (write_success) cache_file->PunchHole(offset, charge_len);
+      Trace(trace::EventType::STORE_FAILED, cache_key, /*lookup_len=*/ -1, write.len);
+    }
+    if (enable_range_lookup_) {
+      RemovePendingRange(CacheKey::FileKey(key), CacheKey::Offset(key));
+    }
+    offset += charge_len;
+  }
+}
+
+void DataCache::Partition::WaitForPendingWrites() {
+  std::unique_lock<std::mutex> l(write_queue_lock_);
+  while (write_queue_bytes_ > 0 && !write_queue_shut_down_) {
+    write_queue_drained_cv_.Wait(l);
+  }
+}
+
 void DataCache::Partition::DeleteOldFiles() {
   std::unique_lock<SpinLock> partition_lock(lock_);
   DCHECK_GE(oldest_opened_file_, 0);
@@ -772,10 +1497,11 @@ void DataCache::Partition::DeleteOldFiles() {
 
 void DataCache::Partition::EvictedEntry(Slice key, Slice value) {
   if (closed_) return;
-  if (UNLIKELY(trace_replay_)) return;
-  ScopedHistogramTimer eviction_timer(eviction_latency_);
   // Unpack the cache entry.
   CacheEntry entry(value);
+  UntrackEntry(key, entry.len());
+  if (UNLIKELY(trace_replay_)) return;
+  ScopedHistogramTimer eviction_timer(eviction_latency_);
   int64_t eviction_len = BitUtil::RoundUp(entry.len(), PAGE_SIZE);
   DCHECK_EQ(entry.offset() % PAGE_SIZE, 0);
   entry.file()->PunchHole(entry.offset(), eviction_len);
@@ -803,12 +1529,299 @@ bool DataCache::Partition::VerifyChecksum(const string& ops_name, const CacheEnt
   return true;
 }
 
+namespace {
+
+/// Helper for appending fixed-width values to a metadata checkpoint.
+template <typename T>
+void AppendValue(faststring* buf, T val) {
+  buf->append(&val, sizeof(T));
+}
+
+/// Helper for reading fixed-width values and byte strings of a metadata checkpoint.
+/// Reads fail once the end of the buffer is reached.
+class MetadataReader {
+ public:
+  MetadataReader(const uint8_t* data, int64_t len) : pos_(data), end_(data + len) {}
+
+  template <typename T>
+  bool Read(T* val) {
+    if (end_ - pos_ < sizeof(T)) return false;
+    memcpy(val, pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool ReadBytes(uint32_t len, Slice* bytes) {
+    if (end_ - pos_ < len) return false;
+    *bytes = Slice(pos_, len);
+    pos_ += len;
+    return true;
+  }
+
+ private:
+  const uint8_t* pos_;
+  const uint8_t* end_;
+};
+
+/// Returns true iff the range ['offset', 'offset' + 'len') is entirely covered by the
+/// live extents in 'extents', i.e. no part of it was punched out.
+bool IsRangeLive(const RWFile::ExtentMap& extents, int64_t offset, int64_t len) {
+  uint64_t pos = offset;
+  const uint64_t end = offset + len;
+  auto it = extents.upper_bound(pos);
+  if (it == extents.begin()) return false;
+  --it;
+  while (pos < end) {
+    if (it == extents.end() || it->first > pos || it->first + it->second <= pos) {
+      return false;
+    }
+    pos = it->first + it->second;
+    ++it;
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+Status DataCache::Partition::Checkpoint() {
+  DCHECK(persist_metadata_);
+  std::lock_guard<std::mutex> checkpoint_lock(checkpoint_lock_);
+  // Snapshot the opened backing files.
+  vector<CacheFile*> files;
+  {
+    std::lock_guard<SpinLock> partition_lock(lock_);
+    if (closed_) return Status(Substitute("Partition $0 is already closed", path_));
+    for (int i = max(oldest_opened_file_, 0); i < cache_files_.size(); ++i) {
+      files.push_back(cache_files_[i].get());
+    }
+  }
+  // Snapshot the keys and look up each entry before syncing the files, so that the
+  // content of every recorded entry was written before the sync. Entries inserted
+  // afterwards are left for the next checkpoint. Entries evicted in the meantime are
+  // skipped.
+  vector<string> keys;
+  {
+    std::lock_guard<SpinLock> l(entry_keys_lock_);
+    keys.reserve(entry_keys_.size());
+    for (const auto& entry_key : entry_keys_) keys.push_back(entry_key.first);
+  }
+  std::unordered_map<CacheFile*, uint32_t> file_indices;
+  for (uint32_t i = 0; i < files.size(); ++i) file_indices.emplace(files[i], i);
+  struct CheckpointEntry {
+    const string* key;
+    uint32_t file_idx;
+    CacheEntry entry;
+  };
+  vector<CheckpointEntry> entries;
+  entries.reserve(keys.size());
+  for (const string& key : keys) {
+    Cache::UniqueHandle handle(meta_cache_->Lookup(key, Cache::NO_UPDATE));
+    if (handle.get() == nullptr) continue;
+    CacheEntry entry(meta_cache_->Value(handle));
+    auto it = file_indices.find(entry.file());
+    if (it == file_indices.end()) continue;
+    entries.push_back({&key, it->second, entry});
+  }
+
+  // Make sure the cached content referenced by the checkpoint is durable.
+  vector<bool> synced(files.size());
+  faststring buf;
+  AppendValue<uint64_t>(&buf, METADATA_MAGIC);
+  AppendValue<uint32_t>(&buf, files.size());
+  for (uint32_t i = 0; i < files.size(); ++i) {
+    // Closed files are recorded with an empty name so that the indices still line up.
+    string file_name;
+    synced[i] = files[i]->Sync();
+    if (synced[i]) file_name = kudu::BaseName(files[i]->path());
+    AppendValue<uint32_t>(&buf, file_name.size());
+    buf.append(file_name);
+  }
+  uint64_t num_entries = 0;
+  for (const CheckpointEntry& e : entries) {
+    if (!synced[e.file_idx]) continue;
+    AppendValue<uint32_t>(&buf, e.key->size());
+    buf.append(*e.key);
+    AppendValue<uint32_t>(&buf, e.file_idx);
+    AppendValue<int64_t>(&buf, e.entry.offset());
+    AppendValue<int64_t>(&buf, e.entry.len());
+    AppendValue<uint64_t>(&buf, e.entry.checksum());
+    ++num_entries;
+  }
+  AppendValue<uint64_t>(&buf, num_entries);
+  AppendValue<uint64_t>(&buf, Checksum(buf.data(), buf.size()));
+
+  // Write to a temporary file first and rename it so that a crash midway doesn't leave
+  // behind a partially written checkpoint.
+  const string& metadata_path = JoinPathSegments(path_, METADATA_FILE_NAME);
+  const string& tmp_path = metadata_path + ".tmp";
+  KUDU_RETURN_IF_ERROR(kudu::WriteStringToFileSync(Env::Default(), buf, tmp_path),
+      Substitute("Failed to write data cache metadata $0", tmp_path));
+  KUDU_RETURN_IF_ERROR(Env::Default()->RenameFile(tmp_path, metadata_path),
+      Substitute("Failed to rename data cache metadata to $0", metadata_path));
+  VLOG(2) << Substitute("Checkpointed $0 data cache entries to $1", num_entries,
+      metadata_path);
+  return Status::OK();
+}
+
+Status DataCache::Partition::LoadCheckpoint(int64_t* restored_bytes) {
+  DCHECK(persist_metadata_);
+  lock_.DCheckLocked();
+  DCHECK(cache_files_.empty());
+  *restored_bytes = 0;
+  const string& metadata_path = JoinPathSegments(path_, METADATA_FILE_NAME);
+  if (!Env::Default()->FileExists(metadata_path)) {
+    LOG(INFO) << Substitute("No data cache metadata found at $0", metadata_path);
+    return Status::OK();
+  }
+  faststring buf;
+  KUDU_RETURN_IF_ERROR(kudu::ReadFileToString(Env::Default(), metadata_path, &buf),
+      Substitute("Failed to read data cache metadata $0", metadata_path));
+
+  // Verify the trailing checksum and the magic number before trusting any content.
+  const int64_t TRAILER_LEN = 2 * sizeof(uint64_t);
+  if (buf.size() < sizeof(uint64_t) + sizeof(uint32_t) + TRAILER_LEN) {
+    return Status(Substitute("Data cache metadata $0 is truncated", metadata_path));
+  }
+  const int64_t body_len = buf.size() - sizeof(uint64_t);
+  if (Checksum(buf.data(), body_len) != UNALIGNED_LOAD64(buf.data() + body_len)) {
+    return Status(Substitute("Checksum mismatch in data cache metadata $0",
+        metadata_path));
+  }
+  MetadataReader reader(buf.data(), buf.size() - TRAILER_LEN);
+  uint64_t magic;
+  uint32_t num_files;
+  if (!reader.Read(&magic) || magic != METADATA_MAGIC || !reader.Read(&num_files)) {
+    return Status(Substitute("Unknown data cache metadata format in $0", metadata_path));
+  }
+  const uint64_t num_entries = UNALIGNED_LOAD64(buf.data() + buf.size() - TRAILER_LEN);
+
+  // Reopen the backing files and fetch their live extents. Files which cannot be
+  // reopened are left as nullptr and the entries referencing them are skipped.
+  vector<unique_ptr<CacheFile>> files(num_files);
+  vector<RWFile::ExtentMap> extents(num_files);
+  for (uint32_t i = 0; i < num_files; ++i) {
+    uint32_t name_len;
+    Slice name;
+    if (!reader.Read(&name_len) || !reader.ReadBytes(name_len, &name)) {
+      return Status(Substitute("Data cache metadata $0 is corrupted", metadata_path));
+    }
+    const string& file_name = name.ToString();
+    if (file_name.find(CACHE_FILE_PREFIX) != 0 || file_name.find('/') != string::npos) {
+      continue;
+    }
+    const string& file_path = JoinPathSegments(path_, file_name);
+    Status status = CacheFile::Open(file_path, &files[i]);
+    if (status.ok()) status = files[i]->GetExtentMap(&extents[i]);
+    if (!status.ok()) {
+      LOG(WARNING) << Substitute("Skipping data cache file $0: $1", file_path,
+          status.GetDetail());
+      files[i].reset();
+    }
+  }
+
+  // Parse all entries before restoring any so that a corrupted checkpoint doesn't leave
+  // behind entries referencing the files which are about to be deleted.
+  struct CheckpointEntry {
+    Slice key;
+    uint32_t file_idx;
+    int64_t offset;
+    int64_t len;
+    uint64_t checksum;
+  };
+  vector<CheckpointEntry> entries(num_entries);
+  for (CheckpointEntry& e : entries) {
+    uint32_t key_len;
+    if (!reader.Read(&key_len) || !reader.ReadBytes(key_len, &e.key)
+        || !reader.Read(&e.file_idx) || !reader.Read(&e.offset) || !reader.Read(&e.len)
+        || !reader.Read(&e.checksum)) {
+      return Status(Substitute("Data cache metadata $0 is corrupted", metadata_path));
+    }
+  }
+
+  // Restore the entries whose content is still intact in the backing files. Entries
+  // evicted after the checkpoint was taken have been punched out.
+  vector<vector<std::pair<int64_t, int64_t>>> live_ranges(num_files);
+  int64_t num_restored = 0;
+  for (const CheckpointEntry& e : entries) {
+    if (e.file_idx >= num_files || files[e.file_idx] == nullptr) continue;
+    CacheFile* cache_file = files[e.file_idx].get();
+    const int64_t charge_len = BitUtil::RoundUp(e.len, PAGE_SIZE);
+    if (e.offset < 0 || e.offset % PAGE_SIZE != 0 || e.len <= 0
+        || e.offset + charge_len > cache_file->size()
+        || !IsRangeLive(extents[e.file_idx], e.offset, charge_len)) {
+      continue;
+    }
+    if (!InsertEntry(e.key, CacheEntry(cache_file, e.offset, e.len, e.checksum))) {
+      continue;
+    }
+    live_ranges[e.file_idx].emplace_back(e.offset, charge_len);
+    *restored_bytes += charge_len;
+    ++num_restored;
+  }
+
+  // Punch out the content not referenced by any restored entry (e.g. data written
+  // after the checkpoint was taken) so it doesn't count towards the quota. Files
+  // without any restored entry are deleted.
+  for (uint32_t i = 0; i < num_files; ++i) {
+    if (files[i] == nullptr) continue;
+    if (live_ranges[i].empty()) {
+      files[i].reset();
+      continue;
+    }
+    // Entries in a backing file never overlap so the ranges are also sorted by end.
+    vector<std::pair<int64_t, int64_t>>& ranges = live_ranges[i];
+    sort(ranges.begin(), ranges.end());
+    for (const auto& extent : extents[i]) {
+      int64_t pos = BitUtil::RoundUp(extent.first, PAGE_SIZE);
+      const int64_t extent_end = min<int64_t>(files[i]->size(),
+          BitUtil::RoundDown(extent.first + extent.second, PAGE_SIZE));
+      auto range = std::lower_bound(ranges.begin(), ranges.end(), pos,
+          [](const std::pair<int64_t, int64_t>& r, int64_t p) {
+            return r.first + r.second <= p;
+          });
+      for (; range != ranges.end() && range->first < extent_end; ++range) {
+        if (range->first > pos) files[i]->PunchHole(pos, range->first - pos);
+        pos = max(pos, range->first + range->second);
+      }
+      if (pos < extent_end) files[i]->PunchHole(pos, extent_end - pos);
+    }
+    cache_files_.emplace_back(move(files[i]));
+  }
+  LOG(INFO) << Substitute("Restored $0 entries ($1) of data cache partition $2 from $3",
+      num_restored, PrettyPrinter::PrintBytes(*restored_bytes), path_, metadata_path);
+  return Status::OK();
+}
+
+bool DataCache::Partition::InsertEntry(const Slice& key, const CacheEntry& entry) {
+  const int64_t charge_len = BitUtil::RoundUp(entry.len(), PAGE_SIZE);
+  Cache::UniquePendingHandle pending_handle(
+      meta_cache_->Allocate(key, sizeof(CacheEntry), charge_len));
+  if (UNLIKELY(pending_handle.get() == nullptr)) return false;
+  memcpy(meta_cache_->MutableValue(&pending_handle), &entry, sizeof(CacheEntry));
+  TrackEntry(key, entry.len());
+  // See InsertIntoCache() for why the metrics are updated first.
+  ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_TOTAL_BYTES->Increment(charge_len);
+  ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_NUM_ENTRIES->Increment(1);
+  Cache::UniqueHandle handle(meta_cache_->Insert(std::move(pending_handle), this));
+  if (UNLIKELY(handle.get() == nullptr)) {
+    UntrackEntry(key, entry.len());
+    ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_INSTANT_EVICTIONS->Increment(1);
+    return false;
+  }
+  return true;
+}
+
 Status DataCache::Init() {
+  enable_range_lookup_ = FLAGS_data_cache_enable_range_lookup;
   // Verifies all the configured flags are sane.
   if (FLAGS_data_cache_file_max_size_bytes < PAGE_SIZE) {
     return Status(Substitute("Misconfigured --data_cache_file_max_size_bytes: $0 bytes. "
         "Must be at least $1 bytes", FLAGS_data_cache_file_max_size_bytes, PAGE_SIZE));
   }
+  if (FLAGS_data_cache_write_queue_bytes > 0 && FLAGS_data_cache_write_batch_bytes < 1) {
+    return Status(Substitute("Misconfigured --data_cache_write_batch_bytes: $0. "
+        "Must be at least 1.", FLAGS_data_cache_write_batch_bytes));
+  }
   if (FLAGS_data_cache_write_concurrency < 1) {
     return Status(Substitute("Misconfigured --data_cache_write_concurrency: $0. "
         "Must be at least 1.", FLAGS_data_cache_write_concurrency));
@@ -841,13 +1854,18 @@ Status DataCache::Init() {
     return Status(Substitute("Misconfigured --data_cache_max_opened_files: $0. Must be "
         "at least $1.", FLAGS_data_cache_max_opened_files, cache_dirs.size()));
   }
+  if (!trace_replay_ && FLAGS_data_cache_write_queue_bytes > 0) {
+    write_queue_mem_tracker_.reset(
+        new MemTracker(-1, "Data Cache Write Queue", parent_mem_tracker_));
+  }
   int32_t partition_idx = 0;
   for (const string& dir_path : cache_dirs) {
     LOG(INFO) << "Adding partition " << dir_path << " with capacity "
               << PrettyPrinter::PrintBytes(capacity);
     std::unique_ptr<Partition> partition =
         make_unique<Partition>(partition_idx, dir_path, capacity,
-            max_opened_files_per_partition, trace_replay_);
+            max_opened_files_per_partition, trace_replay_,
+            write_queue_mem_tracker_.get());
     RETURN_IF_ERROR(partition->Init());
     partitions_.emplace_back(move(partition));
     ++partition_idx;
@@ -863,16 +1881,61 @@ Status DataCache::Init() {
         "data-cache-file-deleter", 1, MAX_FILE_DELETER_QUEUE_SIZE,
         bind<void>(&DataCache::DeleteOldFiles, this, _1, _2)));
     RETURN_IF_ERROR(file_deleter_pool_->Init());
+
+    // Starts a thread which periodically checkpoints the metadata of all partitions.
+    if (FLAGS_data_cache_persist_metadata && FLAGS_data_cache_checkpoint_interval_s > 0) {
+      RETURN_IF_ERROR(Thread::Create("impala-server", "data-cache-checkpointer",
+          &DataCache::CheckpointLoop, this, &checkpoint_thread_));
+    }
   }
 
   return Status::OK();
 }
 
+DataCache::DataCache(const string config, bool trace_replay,
+    MemTracker* parent_mem_tracker)
+  : config_(config),
+    trace_replay_(trace_replay),
+    parent_mem_tracker_(parent_mem_tracker) {}
+
+DataCache::~DataCache() {
+  ReleaseResources();
+  if (write_queue_mem_tracker_ != nullptr) write_queue_mem_tracker_->Close();
+}
+
 void DataCache::ReleaseResources() {
+  if (checkpoint_thread_ != nullptr) {
+    shut_down_promise_.Set(true);
+    checkpoint_thread_->Join();
+    checkpoint_thread_.reset();
+  }
   if (file_deleter_pool_) file_deleter_pool_->Shutdown();
   for (auto& partition : partitions_) partition->ReleaseResources();
 }
 
+Status DataCache::Checkpoint() {
+  if (!FLAGS_data_cache_persist_metadata || trace_replay_) return Status::OK();
+  Status result;
+  for (auto& partition : partitions_) {
+    Status status = partition->Checkpoint();
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to checkpoint data cache metadata: " << status.GetDetail();
+      if (result.ok()) result = status;
+    }
+  }
+  return result;
+}
+
+void DataCache::CheckpointLoop() {
+  while (true) {
+    // This Get() will time out until shutdown, when the promise is set.
+    bool timed_out;
+    shut_down_promise_.Get(FLAGS_data_cache_checkpoint_interval_s * 1000L, &timed_out);
+    if (!timed_out) break;
+    discard_result(Checkpoint());
+  }
+}
+
 int64_t DataCache::Lookup(const string& filename, int64_t mtime, int64_t offset,
     int64_t bytes_to_read, uint8_t* buffer) {
   DCHECK(!partitions_.empty());
@@ -885,7 +1948,7 @@ int64_t DataCache::Lookup(const string& filename, int64_t mtime, int64_t offset,
 
   // Construct a cache key. The cache key is also hashed to compute the partition index.
   const CacheKey key(filename, mtime, offset);
-  int idx = key.Hash() % partitions_.size();
+  int idx = PartitionIndex(key);
   int64_t bytes_read = partitions_[idx]->Lookup(key, bytes_to_read, buffer);
   if (VLOG_IS_ON(3)) {
     stringstream ss;
@@ -909,7 +1972,7 @@ bool DataCache::Store(const string& filename, int64_t mtime, int64_t offset,
 
   // Construct a cache key. The cache key is also hashed to compute the partition index.
   const CacheKey key(filename, mtime, offset);
-  int idx = key.Hash() % partitions_.size();
+  int idx = PartitionIndex(key);
   bool start_reclaim;
   bool stored = partitions_[idx]->Store(key, buffer, buffer_len, &start_reclaim);
   if (VLOG_IS_ON(3)) {
@@ -922,6 +1985,17 @@ bool DataCache::Store(const string& filename, int64_t mtime, int64_t offset,
   return stored;
 }
 
+int DataCache::PartitionIndex(const CacheKey& key) const {
+  // With range lookups, all ranges of a file must be in the same partition for the
+  // per-file range index to see all of them.
+  uint64_t hash = enable_range_lookup_ ? key.FileHash() : key.Hash();
+  return hash % partitions_.size();
+}
+
+void DataCache::WaitForPendingWrites() {
+  for (auto& partition : partitions_) partition->WaitForPendingWrites();
+}
+
 Status DataCache::CloseFilesAndVerifySizes() {
   for (auto& partition : partitions_) {
     RETURN_IF_ERROR(partition->CloseFilesAndVerifySizes());
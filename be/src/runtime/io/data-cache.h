@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <deque>
+#include <map>
 #include <mutex>
 #include <string>
 #include <unistd.h>
@@ -26,9 +28,12 @@
 
 #include "common/status.h"
 #include "util/cache/cache.h"
+#include "util/condition-variable.h"
 #include "util/metrics-fwd.h"
+#include "util/promise.h"
 #include "util/spinlock.h"
 #include "util/thread-pool.h"
+#include "util/thread.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/slice.h"
 
@@ -70,22 +75,52 @@
 /// with what was inserted and to verify that multiple attempted insertions with the same
 /// cache key have the same cache content.
 ///
-/// Note that the cache currently doesn't support sub-ranges lookup and or handle
-/// overlapping ranges. In other words, if the cache has an entry for a file at range
-/// [0,4095], a look up for range [4000,4095] will result in a miss even though it's a
-/// sub-range of [0,4095]. Also inserting the range [4000,4095] will not consolidate
-/// with any overlapping ranges. In other words, inserting entries for ranges [0,4095]
-/// and [4000,4095] will result in caching the data for range [4000,4095] twice. This
-/// hasn't been a major concern in practice when testing with TPC-DS + parquet but this
-/// requires more investigation for other file formats and workloads.
+/// By default, a lookup only hits on an exact (filename, mtime, offset) key and
+/// overlapping ranges are cached independently. If --data_cache_enable_range_lookup is
+/// true, each partition also keeps a per-file index of the cached ranges (see
+/// Partition::range_index_). A lookup of range [4000,4095] can then be served from a
+/// cached range [0,4095] and a lookup spanning several adjacent cached ranges is served
+/// by stitching them together. An insertion only stores the part of the range which is
+/// not already covered by cached ranges and cached ranges fully contained in the newly
+/// inserted one are dropped, so the same bytes of a file are not cached twice. In this
+/// mode, a partition is picked by hashing (filename, mtime) only so that all ranges of
+/// a file are in the same partition.
+///
+/// By default, every range passed to Store() is cached, evicting other entries as
+/// needed. If --data_cache_admission_policy is 'TINYLFU', the metadata cache of each
+/// partition estimates the lookup frequency of keys with a count-min sketch and a new
+/// entry is only admitted if its key was looked up more often than the key of the
+/// entry it would evict first. This keeps ranges read once by large scans from
+/// flushing out the frequently read ranges. See Cache::AdmissionPolicy.
+///
+/// By default, all backing files are deleted when the cache is initialized so the cache
+/// always starts out empty. If --data_cache_persist_metadata is true, each partition
+/// checkpoints the metadata of its entries (i.e. the cache keys and where the cached
+/// data is stored) into a file next to its backing files every
+/// --data_cache_checkpoint_interval_s seconds and on shutdown. The checkpoint is
+/// written to a temporary file and renamed so a crash never leaves behind a partial
+/// checkpoint. It also has a checksum to detect corruption. Init() reloads the entries
+/// from the checkpoint and keeps the backing files they reference. Since backing files
+/// are append-only and evicted entries are punched out, an entry evicted after the last
+/// checkpoint is detected by checking for holes in its range and is dropped. Content
+/// of the backing files not referenced by any reloaded entry is punched out as well.
+/// Reloaded backing files are never appended to.
 ///
 /// To probe for cached data in the cache, the interface Lookup() is used; To insert
-/// data into the cache, the interface Store() is used. Write to the backing file and
-/// eviction from it happen synchronously. Currently, Store() is limited to the
-/// concurrency of one thread per partition to prevent slowing down the caller in case
-/// the cache is thrashing and it becomes IO bound. The write concurrency can be tuned
-/// via the knob --data_cache_write_concurrency. Also, Store() has a minimum granularity
-/// of 4KB so any data inserted will be rounded up to the nearest multiple of 4KB.
+/// data into the cache, the interface Store() is used. By default, write to the backing
+/// file and eviction from it happen synchronously. In that case, Store() is limited to
+/// the concurrency of one thread per partition to prevent slowing down the caller in
+/// case the cache is thrashing and it becomes IO bound. The write concurrency can be
+/// tuned via the knob --data_cache_write_concurrency. If --data_cache_write_queue_bytes
+/// is positive, Store() instead copies the data into a bounded write-behind queue of
+/// the partition and returns immediately. A writer thread per partition drains the queue,
+/// coalescing up to --data_cache_write_batch_bytes of queued entries into a single
+/// sequential write to the backing file. Inserts are dropped when the queue is full so
+/// a thrashing cache never blocks the caller nor uses unbounded memory. The copies of
+/// the queued data are charged to a MemTracker and inserts are also dropped if the
+/// process memory limit would be exceeded. An insert which supersedes cached ranges only
+/// replaces them once it's written. Store() has a minimum granularity of 4KB so any
+/// data inserted will be rounded up to the nearest multiple of 4KB.
 ///
 /// The number of backing files in all partitions is bound by
 /// --data_cache_max_opened_files. Once the number of files exceeds that set limit, files
@@ -94,7 +129,6 @@
 /// indirectly via eviction.
 ///
 /// Future work:
-/// - investigate the overlapping ranges support
 /// - be more selective on what to cache
 /// - asynchronous eviction
 /// - better data placement: put on hot data on faster media and lukewarm data in not
@@ -105,6 +139,9 @@
 ///
 
 namespace impala {
+
+class MemTracker;
+
 namespace io {
 
 namespace trace {
@@ -122,23 +159,31 @@ class DataCache {
   /// caching directories. If 'trace_replay' is set to true, the cache operates in a
   /// an optimized mode that skips all file operations and only does the metadata
   /// operations. This is used to replay the access trace and compare different cache
-  /// configurations. See data-cache-trace.h
-  explicit DataCache(const std::string config, bool trace_replay = false)
-    : config_(config), trace_replay_(trace_replay) { }
+  /// configurations. See data-cache-trace.h. The memory of the write-behind queues is
+  /// tracked by a child MemTracker of 'parent_mem_tracker', which may be nullptr.
+  explicit DataCache(const std::string config, bool trace_replay = false,
+      MemTracker* parent_mem_tracker = nullptr);
 
-  ~DataCache() { ReleaseResources(); }
+  ~DataCache();
 
   /// Parses the configuration string, initializes all partitions in the cache by
   /// checking for storage space available and creates a backing file for caching.
   /// Return error if any of the partitions failed to be initialized.
   Status Init();
 
-  /// Releases any resources (e.g. backing files) consumed by all partitions.
+  /// Releases any resources (e.g. backing files) consumed by all partitions. With
+  /// --data_cache_persist_metadata, the metadata is checkpointed first and the backing
+  /// files are kept for reuse by the next run.
   void ReleaseResources();
 
+  /// Checkpoints the metadata of all partitions if --data_cache_persist_metadata is
+  /// true. Called periodically by 'checkpoint_thread_' and on shutdown. Returns the
+  /// first error encountered.
+  Status Checkpoint();
+
   /// Looks up a cached entry and copies any cached content from the cache into 'buffer'.
-  /// (filename, mtime, offset) forms a cache key. Please note that sub-range lookup is
-  /// currently not supported. See header comments for details.
+  /// (filename, mtime, offset) forms a cache key. Sub-range lookup is only supported
+  /// with --data_cache_enable_range_lookup. See header comments for details.
   ///
   /// 'filename'      : name of the requested file
   /// 'mtime'         : the modification time of the requested file
@@ -177,9 +222,12 @@ class DataCache {
   ///   new data.
   /// - a pending entry with the same key is already being installed.
   /// - the maximum write concurrency (via --data_cache_write_concurrency) is reached.
+  /// - the write-behind queue is full (with --data_cache_write_queue_bytes).
   /// - IO error when writing to the backing file.
   ///
-  /// Returns true iff the entry is installed successfully.
+  /// Returns true iff the entry is installed successfully. With the write-behind queue,
+  /// returns true iff the entry is queued. The entry becomes visible to Lookup() once
+  /// it's written, which may still fail.
   ///
   bool Store(const std::string& filename, int64_t mtime, int64_t offset,
       const uint8_t* buffer, int64_t buffer_len);
@@ -190,6 +238,10 @@ class DataCache {
   /// partitions before verifying their sizes. Used by test only.
   Status CloseFilesAndVerifySizes();
 
+  /// Blocks until the write-behind queues of all partitions are drained. Used by test
+  /// only.
+  void WaitForPendingWrites();
+
  private:
   friend class DataCacheBaseTest;
   friend class DataCacheTest;
@@ -208,12 +260,13 @@ class DataCache {
     /// If 'trace_replay' is true, this only performs metadata operations for the
     /// access trace functionality.
     Partition(int32_t index, const std::string& path, int64_t capacity,
-        int max_opened_files, bool trace_replay);
+        int max_opened_files, bool trace_replay, MemTracker* write_queue_mem_tracker);
 
     ~Partition();
 
     /// Initializes the current partition:
     /// - verifies if the specified directory is valid
+    /// - reloads the entries from the metadata checkpoint if persistence is enabled
     /// - removes any stale backing file in this partition
     /// - checks if there is enough storage space
     /// - checks if the filesystem supports hole punching
@@ -229,7 +282,8 @@ class DataCache {
     /// Looks up in the meta-data cache with key 'cache_key'. If found, try copying
     /// 'bytes_to_read' bytes from the backing file into 'buffer'. If trace_replay
     /// is enabled, the buffer is null and no bytes are copied. Returns number
-    /// of bytes read from the cache. Returns 0 if there is a cache miss.
+    /// of bytes read from the cache. Returns 0 if there is a cache miss. With range
+    /// lookup enabled, any cached ranges covering 'cache_key' are used instead.
     int64_t Lookup(const CacheKey& cache_key, int64_t bytes_to_read, uint8_t* buffer);
 
     /// Inserts a entry with key 'cache_key' and data in 'buffer' into the cache.
@@ -257,10 +311,19 @@ class DataCache {
     /// Returns OK otherwise.
     Status CloseFilesAndVerifySizes();
 
+    /// Blocks until the write-behind queue is drained or the partition is shut down.
+    /// Used by test only.
+    void WaitForPendingWrites();
+
     /// Deletes old backing files until number of backing files is no larger than
     /// --data_cache_max_opened_files.
     void DeleteOldFiles();
 
+    /// Writes the metadata of all entries stored in the opened backing files into the
+    /// checkpoint file METADATA_FILE_NAME in 'path_'. The backing files are synced
+    /// first so the checkpoint never references content which isn't durable.
+    Status Checkpoint();
+
    private:
     friend class DataCacheBaseTest;
     friend class DataCacheTest;
@@ -284,6 +347,14 @@ class DataCache {
     /// There is no need to perform any filesystem operations.
     bool trace_replay_;
 
+    /// Value of --data_cache_enable_range_lookup when this partition was created.
+    const bool enable_range_lookup_;
+
+    /// True if range lookup is enabled with the TinyLFU admission policy. Range lookup
+    /// misses then also count as accesses of the key the missing data would be stored
+    /// with, see LookupRanges().
+    const bool count_range_misses_;
+
     /// True if this partition has been closed. Expected to be set after all IO
     /// threads have been joined.
     bool closed_ = false;
@@ -291,9 +362,67 @@ class DataCache {
     /// The prefix of the names of the cache backing files.
     static const char* CACHE_FILE_PREFIX;
 
+    /// The name of the metadata checkpoint file.
+    static const char* METADATA_FILE_NAME;
+
+    /// Value of --data_cache_persist_metadata when this partition was created. Always
+    /// false for trace replay.
+    const bool persist_metadata_;
+
+    /// Serializes concurrent calls to Checkpoint().
+    std::mutex checkpoint_lock_;
+
+    /// Protects 'entry_keys_'. Never held while calling into 'meta_cache_'.
+    SpinLock entry_keys_lock_;
+
+    /// Keys of all entries in 'meta_cache_' and their lengths. Only maintained with
+    /// persistence enabled as the metadata cache doesn't support iterating over its
+    /// entries for checkpointing.
+    std::unordered_map<std::string, int64_t> entry_keys_;
+
     /// Protects the following fields.
     SpinLock lock_;
 
+    /// Value of --data_cache_write_queue_bytes when this partition was created. Always 0
+    /// for trace replay. If positive, inserts are written by 'writer_thread_'.
+    const int64_t write_queue_capacity_;
+
+    /// Tracks the memory of the buffers of the queued inserts. Owned by the DataCache.
+    MemTracker* const write_queue_mem_tracker_;
+
+    /// An insert queued for 'writer_thread_'. Owns a copy of the data.
+    struct PendingWrite {
+      std::string key;
+      std::unique_ptr<uint8_t[]> buffer;
+      int64_t len;
+      int64_t enqueue_time_ns;
+      /// Starting offsets of the cached ranges superseded by this insert. Erased once
+      /// the insert is in the cache. Only used with range lookup enabled.
+      std::vector<int64_t> contained_ranges;
+    };
+
+    /// Protects the following fields of the write-behind queue.
+    std::mutex write_queue_lock_;
+
+    /// Signalled when an insert is queued or on shutdown.
+    ConditionVariable write_queue_cv_;
+
+    /// Signalled after each batch is written. Only used by WaitForPendingWrites().
+    ConditionVariable write_queue_drained_cv_;
+
+    /// Inserts waiting to be written, in the order of Store().
+    std::deque<PendingWrite> write_queue_;
+
+    /// Total length of the inserts in 'write_queue_' and in the batch being written.
+    /// Bounded by 'write_queue_capacity_'.
+    int64_t write_queue_bytes_ = 0;
+
+    /// Set in ReleaseResources() to stop 'writer_thread_'.
+    bool write_queue_shut_down_ = false;
+
+    /// Drains 'write_queue_'. Only created if 'write_queue_capacity_' is positive.
+    std::unique_ptr<Thread> writer_thread_;
+
     /// Index into 'cache_files_' of the oldest opened file.
     int oldest_opened_file_ = -1;
 
@@ -319,6 +448,24 @@ class DataCache {
     /// content. Please see comments at CachedEntry for details.
     std::unique_ptr<Cache> meta_cache_;
 
+    /// Map of starting offset to length of the cached ranges of a file.
+    typedef std::map<int64_t, int64_t> RangeMap;
+
+    /// Protects 'range_index_'. Never held while calling into 'meta_cache_' as the
+    /// eviction callback acquires it.
+    SpinLock range_index_lock_;
+
+    /// Per-file index of the ranges in 'meta_cache_', keyed by CacheKey::FileKey().
+    /// Only maintained with range lookup enabled. A range is added right before its
+    /// entry is inserted into 'meta_cache_' and removed when the entry is evicted.
+    std::unordered_map<std::string, RangeMap> range_index_;
+
+    /// Per-file index of the ranges being inserted, including those waiting in the
+    /// write-behind queue. A Store() overlapping any of them is dropped so that
+    /// concurrent inserts never store the same bytes twice. Only maintained with range
+    /// lookup enabled. Protected by 'range_index_lock_'.
+    std::unordered_map<std::string, RangeMap> pending_range_index_;
+
     std::unique_ptr<trace::Tracer> tracer_;
 
     /// Metrics to track performance of the underlying filesystem for the data cache
@@ -327,6 +474,8 @@ class DataCache {
     HistogramMetric* read_latency_ = nullptr;
     HistogramMetric* write_latency_ = nullptr;
     HistogramMetric* eviction_latency_ = nullptr;
+    /// Time an insert spends in the write-behind queue until it's written.
+    HistogramMetric* write_queue_latency_ = nullptr;
 
     /// Initialize the metrics
     void InitMetrics();
@@ -336,13 +485,91 @@ class DataCache {
     /// error on failure.
     Status CreateCacheFile();
 
-    /// Utility function to delete cache files left over from previous runs of Impala.
-    /// Returns error on failure.
+    /// Utility function to delete cache files left over from previous runs of Impala
+    /// except for those in 'cache_files_' which were reloaded from a checkpoint. Also
+    /// deletes any stale checkpoint if persistence is disabled. Returns error on failure.
     Status DeleteExistingFiles() const;
 
+    /// Reloads the entries from the metadata checkpoint in 'path_' if one exists. The
+    /// backing files referenced by the reloaded entries are added to 'cache_files_'.
+    /// 'restored_bytes' is set to the storage consumed by the reloaded entries. The
+    /// partition's lock needs to be held when calling this function. Returns error if
+    /// the checkpoint is corrupted, in which case no entry is reloaded.
+    Status LoadCheckpoint(int64_t* restored_bytes);
+
+    /// Inserts 'entry' whose data is already in a backing file (i.e. reloaded from a
+    /// checkpoint or written by 'writer_thread_') with key 'key' into 'meta_cache_'.
+    /// Returns true iff the insertion succeeded.
+    bool InsertEntry(const kudu::Slice& key, const CacheEntry& entry);
+
+    /// Adds or removes the entry with key 'key' and length 'len' to or from the range
+    /// index and 'entry_keys_' as needed.
+    void TrackEntry(const kudu::Slice& key, int64_t len);
+    void UntrackEntry(const kudu::Slice& key, int64_t len);
+
     /// Utility function for computing the checksum of 'buffer' with length 'buffer_len'.
     static uint64_t Checksum(const uint8_t* buffer, int64_t buffer_len);
 
+    /// Implementation of Store() for a range which doesn't need any trimming. The
+    /// entries starting at 'contained_ranges' of the same file are erased once the new
+    /// entry is in the cache, i.e. after the write with the write-behind queue.
+    bool StoreInternal(const CacheKey& cache_key, const uint8_t* buffer,
+        int64_t buffer_len, std::vector<int64_t> contained_ranges, bool* start_reclaim);
+
+    /// Copies 'buffer' into the write-behind queue. Returns false and drops the insert
+    /// if the queue is full, the memory for the copy cannot be reserved or the same key
+    /// is already pending.
+    bool EnqueueWrite(const CacheKey& cache_key, const uint8_t* buffer,
+        int64_t buffer_len, std::vector<int64_t> contained_ranges, bool* start_reclaim);
+
+    /// Erases the entries of the file of 'key' which start at 'contained_ranges' and are
+    /// superseded by the entry with key 'key'.
+    void EraseContainedRanges(const kudu::Slice& key,
+        const std::vector<int64_t>& contained_ranges);
+
+    /// Body of 'writer_thread_'. Pops batches of up to --data_cache_write_batch_bytes
+    /// off the write-behind queue and writes them with WriteBatch() until shut down.
+    void WriterLoop();
+
+    /// Writes all entries in 'batch' with a single write to the current backing file and
+    /// inserts them into 'meta_cache_'. Each entry is padded to a page boundary.
+    void WriteBatch(std::vector<PendingWrite>* batch);
+
+    /// Implementation of Lookup() with range lookup enabled. Reads from consecutive
+    /// cached ranges starting at the range covering the offset of 'cache_key' until
+    /// 'bytes_to_read' bytes are read or there is a gap in the cached ranges.
+    int64_t LookupRanges(const CacheKey& cache_key, int64_t bytes_to_read,
+        uint8_t* buffer);
+
+    /// Reads up to 'bytes_to_read' bytes starting at 'entry_offset' bytes into the entry
+    /// with key 'cache_key' into 'buffer'. Returns the number of bytes read, which is 0
+    /// if the entry doesn't exist or the read failed.
+    int64_t ReadFromEntry(const CacheKey& cache_key, int64_t entry_offset,
+        int64_t bytes_to_read, uint8_t* buffer);
+
+    /// Finds the cached range of 'file_key' which covers 'offset'. Returns true and sets
+    /// 'range_start' and 'range_len' if found. Returns false otherwise.
+    bool FindCoveringRange(const std::string& file_key, int64_t offset,
+        int64_t* range_start, int64_t* range_len);
+
+    /// Shrinks the range ['start', 'end') of 'file_key' so it doesn't overlap with the
+    /// cached ranges at either end. Starting offsets of the cached ranges contained in
+    /// the resulting range are appended to 'contained_ranges'. 'start' >= 'end' on
+    /// return if the range is completely covered by cached ranges. Otherwise, returns
+    /// false if the resulting range overlaps a range being inserted. Returns true and
+    /// adds the resulting range to 'pending_range_index_' otherwise, after which the
+    /// caller must remove it with RemovePendingRange() once the insert is done.
+    bool TrimToUncovered(const std::string& file_key, int64_t* start, int64_t* end,
+        std::vector<int64_t>* contained_ranges);
+
+    /// Removes the range starting at 'start' of 'file_key' from 'pending_range_index_'.
+    void RemovePendingRange(const std::string& file_key, int64_t start);
+
+    /// Adds or removes the range ['start', 'start' + 'len') of 'file_key' to or from
+    /// 'range_index_'.
+    void AddRange(const std::string& file_key, int64_t start, int64_t len);
+    void RemoveRange(const std::string& file_key, int64_t start, int64_t len);
+
     /// Helper function which handles the case in which the key to be inserted already
     /// exists in the cache. With checksumming enabled, it also verifies that the content
     /// in 'buffer' matches the expected checksum in the cache's metadata. Please note
@@ -387,6 +614,17 @@ class DataCache {
   /// operations, and no filesystem operations are required.
   bool trace_replay_;
 
+  /// Value of --data_cache_enable_range_lookup at Init().
+  bool enable_range_lookup_ = false;
+
+  /// The parent of 'write_queue_mem_tracker_'. May be nullptr.
+  MemTracker* const parent_mem_tracker_;
+
+  /// Tracks the memory of the write-behind queues of all partitions. Only created with
+  /// a positive --data_cache_write_queue_bytes. Declared before 'partitions_' so that
+  /// it outlives them.
+  std::unique_ptr<MemTracker> write_queue_mem_tracker_;
+
   /// The set of all cache partitions.
   std::vector<std::unique_ptr<Partition>> partitions_;
 
@@ -399,6 +637,20 @@ class DataCache {
   /// in partitions_[partition_idx].
   void DeleteOldFiles(uint32_t thread_id, int partition_idx);
 
+  /// Returns the index into 'partitions_' of the partition for 'key'.
+  int PartitionIndex(const CacheKey& key) const;
+
+  /// Thread which periodically checkpoints the metadata of all partitions. Only
+  /// created with --data_cache_persist_metadata and a positive
+  /// --data_cache_checkpoint_interval_s.
+  std::unique_ptr<Thread> checkpoint_thread_;
+
+  /// Set in ReleaseResources() to stop 'checkpoint_thread_'.
+  Promise<bool> shut_down_promise_;
+
+  /// Thread function of 'checkpoint_thread_'.
+  void CheckpointLoop();
+
 };
 
 } // namespace io
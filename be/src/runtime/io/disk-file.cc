@@ -20,6 +20,7 @@
 #include <mutex>
 #include <thread>
 #include "common/names.h"
+#include "runtime/io/io-uring-file-writer.h"
 #include "runtime/io/local-file-writer.h"
 #include "util/filesystem-util.h"
 #include "util/spinlock.h"
@@ -27,6 +28,16 @@
 using namespace impala;
 using namespace impala::io;
 
+DECLARE_bool(use_io_uring);
+
+// Returns a writer for the local file system, which writes through io_uring if
+// --use_io_uring is true.
+static FileWriter* NewLocalFileWriter(
+    DiskIoMgr* io_mgr, const string& path, int64_t file_size = 0) {
+  if (FLAGS_use_io_uring) return new IoUringFileWriter(io_mgr, path.c_str(), file_size);
+  return new LocalFileWriter(io_mgr, path.c_str(), file_size);
+}
+
 static const Status& DISK_FILE_DELETE_FAILED_INCORRECT_STATUS = Status(ErrorMsg::Init(
     TErrorCode::GENERAL, "DiskFile::Delete() failed with incorrect status"));
 
@@ -47,7 +58,7 @@ DiskFile::DiskFile(const string& path, DiskIoMgr* io_mgr)
   : path_(path),
     disk_type_(DiskFileType::LOCAL),
     file_status_(DiskFileStatus::INWRITING),
-    file_writer_(new LocalFileWriter(io_mgr, path.c_str())),
+    file_writer_(NewLocalFileWriter(io_mgr, path)),
     space_reserved_(true) {}
 
 DiskFile::DiskFile(const string& path, DiskIoMgr* io_mgr, int64_t file_size,
@@ -58,7 +69,7 @@ DiskFile::DiskFile(const string& path, DiskIoMgr* io_mgr, int64_t file_size,
     file_status_(DiskFileStatus::INWRITING) {
   DCHECK(disk_type != DiskFileType::LOCAL);
   if (disk_type == DiskFileType::LOCAL_BUFFER) {
-    file_writer_.reset(new LocalFileWriter(io_mgr, path.c_str(), file_size));
+    file_writer_.reset(NewLocalFileWriter(io_mgr, path, file_size));
     hdfs_conn_ = nullptr;
     space_reserved_.Store(false);
   } else {
@@ -54,6 +54,8 @@ class HistogramMetric;
 
 namespace io {
 
+class IoUring;
+
 // Indicates if file handle caching should be used
 static inline bool is_file_handle_caching_enabled() {
   return FLAGS_max_cached_file_handles > 0;
@@ -121,11 +123,22 @@ class DiskQueue {
   IntCounter* write_io_err() const { return write_io_err_; }
 
  private:
-  /// Called from the disk thread to get the next range to process. Wait until a scan
-  /// is available to process, a write range is available, or 'shut_down_' is set to
-  /// true. Returns the range to process and the RequestContext that the range belongs
-  /// to. Only returns NULL if the disk thread should be shut down.
-  RequestRange* GetNextRequestRange(RequestContext** request_context);
+  /// Called from the disk thread to get the next range to process. If 'block' is true,
+  /// waits until a scan is available to process, a write range is available, or
+  /// 'shut_down_' is set to true. Returns the range to process and the RequestContext
+  /// that the range belongs to. Returns NULL if the disk thread should be shut down or,
+  /// if 'block' is false, if no work is available.
+  RequestRange* GetNextRequestRange(RequestContext** request_context, bool block);
+
+  /// Disk worker thread loop of local disks if --use_io_uring is set. Unlike
+  /// DiskThreadLoop(), it keeps up to ring->queue_depth() reads and writes of different
+  /// ranges in flight on 'ring' and completes them in the order they finish. Ranges
+  /// that can't be issued through io_uring are processed synchronously.
+  void IoUringThreadLoop(IoUring* ring);
+
+  /// Processes 'range' of 'worker_context' synchronously: performs the read, write or
+  /// upload and reports its outcome to 'worker_context'.
+  void ProcessRequestRange(RequestContext* worker_context, RequestRange* range);
 
   /// Disk id (0-based)
   const int disk_id_;
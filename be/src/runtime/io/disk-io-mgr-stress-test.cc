@@ -19,7 +19,7 @@
 
 #include "common/init.h"
 #include "runtime/io/disk-io-mgr-stress.h"
-#include "common/init.h"
+#include "runtime/io/io-uring.h"
 #include "runtime/test-env.h"
 #include "service/fe-support.h"
 #include "util/string-parser.h"
@@ -42,6 +42,12 @@ const int64_t BUFFER_POOL_CAPACITY = 1024L * 1024L * 1024L * 4L;
 
 DEFINE_int64(duration_sec, DEFAULT_DURATION_SEC,
     "Disk I/O Manager stress test duration in seconds. 0 means run indefinitely.");
+DEFINE_bool(stress_io_uring, false,
+    "If true, sets --use_io_uring, so that the local reads and writes of the disk "
+    "threads go through io_uring with many requests in flight per thread. Fails if "
+    "io_uring is not supported.");
+
+DECLARE_bool(use_io_uring);
 
 int main(int argc, char** argv) {
   impala::InitCommonRuntime(argc, argv, true, impala::TestInfo::BE_TEST);
@@ -53,6 +59,15 @@ int main(int argc, char** argv) {
     printf("Running stress test indefinitely.\n");
   }
 
+  if (FLAGS_stress_io_uring) {
+    if (!IoUring::IsSupported()) {
+      printf("io_uring is not supported by this kernel.\n");
+      return 1;
+    }
+    printf("Reading and writing through io_uring.\n");
+    FLAGS_use_io_uring = true;
+  }
+
   TestEnv test_env;
   // Tests try to allocate arbitrarily small buffers. Ensure Buffer Pool allows it.
   test_env.SetBufferPoolArgs(DiskIoMgrStress::MIN_READ_BUFFER_SIZE, BUFFER_POOL_CAPACITY);
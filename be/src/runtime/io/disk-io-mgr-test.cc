@@ -18,6 +18,7 @@
 #include <sched.h>
 #include <boost/bind.hpp>
 #include <boost/thread/thread.hpp>
+#include <fcntl.h>
 #include <sys/stat.h>
 
 #include "runtime/bufferpool/buffer-pool.h"
@@ -27,6 +28,7 @@
 #include "runtime/io/disk-io-mgr-stress.h"
 #include "runtime/io/disk-io-mgr.h"
 #include "runtime/io/local-file-system-with-fault-injection.h"
+#include "runtime/io/io-uring.h"
 #include "runtime/io/request-context.h"
 #include "runtime/test-env.h"
 #include "runtime/tmp-file-mgr-internal.h"
@@ -59,6 +61,7 @@ DECLARE_int32(num_oss_io_threads);
 DECLARE_int32(num_remote_hdfs_file_oper_io_threads);
 DECLARE_int32(num_s3_file_oper_io_threads);
 DECLARE_int32(num_sfs_io_threads);
+DECLARE_bool(use_io_uring);
 
 #ifndef NDEBUG
 DECLARE_int32(stress_disk_read_delay_ms);
@@ -322,6 +325,8 @@ class DiskIoMgrTest : public testing::Test {
   void SingleReaderTestBody(const char* data, const char* expected_result,
       vector<ScanRange::SubRange> sub_ranges = {});
 
+  void SingleWriterTestBody();
+
   void CachedReadsTestBody(const char* data, const char* expected,
       bool fake_cache, vector<ScanRange::SubRange> sub_ranges = {});
 
@@ -404,6 +409,10 @@ TEST_F(DiskIoMgrTest, TestDisk) {
 // complete successfully.
 TEST_F(DiskIoMgrTest, SingleWriter) {
   InitRootReservation(LARGE_RESERVATION_LIMIT);
+  SingleWriterTestBody();
+}
+
+void DiskIoMgrTest::SingleWriterTestBody() {
   num_ranges_written_ = 0;
   string tmp_file = "/tmp/disk_io_mgr_test.txt";
   int num_ranges = 100;
@@ -1337,6 +1346,158 @@ TEST_F(DiskIoMgrTest, StressTest) {
   test.Run(2); // In seconds
 }
 
+// Same as StressTest, but with local reads going through io_uring. Falls back to
+// blocking reads if io_uring isn't supported.
+TEST_F(DiskIoMgrTest, IoUringStressTest) {
+  auto s = ScopedFlagSetter<bool>::Make(&FLAGS_use_io_uring, true);
+  DiskIoMgrStress test(5, 5, 10, true);
+  test.Run(2); // In seconds
+}
+
+// Same as SingleReader and SingleWriter, but with the disk threads keeping the reads and
+// writes of many ranges in flight through io_uring. Falls back to blocking I/O if
+// io_uring isn't supported.
+TEST_F(DiskIoMgrTest, IoUringSingleReaderWriter) {
+  auto s = ScopedFlagSetter<bool>::Make(&FLAGS_use_io_uring, true);
+  InitRootReservation(LARGE_RESERVATION_LIMIT);
+  const char* data = "abcdefghijklm";
+  SingleReaderTestBody(data, data);
+  SingleWriterTestBody();
+}
+
+// Test that transfers of an IoUring are in flight at the same time and complete
+// independently of each other, including a failing transfer and a blocking read that is
+// issued while the others are in flight.
+TEST_F(DiskIoMgrTest, IoUringConcurrentTransfers) {
+  if (!IoUring::IsSupported()) {
+    LOG(INFO) << "Skipping test, io_uring is not supported.";
+    return;
+  }
+  const char* tmp_file = "/tmp/disk_io_mgr_test_io_uring.txt";
+  const int NUM_TRANSFERS = 20;
+  const int64_t TRANSFER_LEN = 100;
+  const int64_t DATA_LEN = NUM_TRANSFERS * TRANSFER_LEN;
+  const int64_t CHUNK_LEN = 7;
+  vector<uint8_t> data(DATA_LEN);
+  for (int i = 0; i < DATA_LEN; ++i) data[i] = 'a' + i % 26;
+
+  IoUring ring;
+  ASSERT_OK(ring.Init(4));
+  int fd = open(tmp_file, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  ASSERT_GE(fd, 0);
+  int write_only_fd = open(tmp_file, O_WRONLY);
+  ASSERT_GE(write_only_fd, 0);
+
+  // Start all writes before waiting for any of them.
+  vector<unique_ptr<IoUring::Transfer>> writes;
+  for (int i = 0; i < NUM_TRANSFERS; ++i) {
+    writes.emplace_back(new IoUring::Transfer(IoUring::Opcode::WRITE, fd,
+        data.data() + i * TRANSFER_LEN, TRANSFER_LEN, i * TRANSFER_LEN, CHUNK_LEN));
+    ring.Start(writes.back().get());
+  }
+  EXPECT_EQ(NUM_TRANSFERS, ring.num_started());
+  int num_finished = 0;
+  while (num_finished < NUM_TRANSFERS) {
+    ring.Poll(/*wait=*/true);
+    IoUring::Transfer* transfer;
+    while ((transfer = ring.PopFinished()) != nullptr) {
+      EXPECT_EQ(0, transfer->error());
+      EXPECT_EQ(TRANSFER_LEN, transfer->bytes_transferred());
+      ++num_finished;
+    }
+  }
+  EXPECT_EQ(0, ring.num_started());
+
+  // Start reads of all parts of the file in reverse order, the last part reading past
+  // the end of the file, and a read which fails.
+  vector<uint8_t> result(DATA_LEN + 100);
+  vector<unique_ptr<IoUring::Transfer>> reads;
+  for (int i = NUM_TRANSFERS - 1; i >= 0; --i) {
+    int64_t len = i == NUM_TRANSFERS - 1 ? TRANSFER_LEN + 100 : TRANSFER_LEN;
+    reads.emplace_back(new IoUring::Transfer(IoUring::Opcode::READ, fd,
+        result.data() + i * TRANSFER_LEN, len, i * TRANSFER_LEN, CHUNK_LEN));
+    ring.Start(reads.back().get());
+  }
+  uint8_t failed_buffer[10];
+  IoUring::Transfer failed_read(
+      IoUring::Opcode::READ, write_only_fd, failed_buffer, 10, 0, CHUNK_LEN);
+  ring.Start(&failed_read);
+
+  // A blocking read while the other transfers are in flight.
+  vector<uint8_t> sync_result(TRANSFER_LEN);
+  int64_t bytes_read;
+  ASSERT_OK(ring.Read(fd, sync_result.data(), TRANSFER_LEN, 0, CHUNK_LEN, &bytes_read));
+  EXPECT_EQ(TRANSFER_LEN, bytes_read);
+  EXPECT_EQ(0, memcmp(data.data(), sync_result.data(), TRANSFER_LEN));
+
+  num_finished = 0;
+  while (num_finished < NUM_TRANSFERS + 1) {
+    ring.Poll(/*wait=*/true);
+    IoUring::Transfer* transfer;
+    while ((transfer = ring.PopFinished()) != nullptr) {
+      ++num_finished;
+      if (transfer == &failed_read) {
+        EXPECT_EQ(EBADF, transfer->error());
+        EXPECT_FALSE(transfer->GetStatus().ok());
+      } else {
+        EXPECT_EQ(0, transfer->error());
+        EXPECT_EQ(TRANSFER_LEN, transfer->bytes_transferred());
+      }
+    }
+  }
+  EXPECT_EQ(0, ring.num_started());
+  EXPECT_EQ(0, memcmp(data.data(), result.data(), DATA_LEN));
+  close(write_only_fd);
+  close(fd);
+  remove(tmp_file);
+}
+
+// Test reads and writes through IoUring which are split into more chunks than fit into
+// the queue, including a read past the end of the file.
+TEST_F(DiskIoMgrTest, IoUringChunkedReadWrite) {
+  if (!IoUring::IsSupported()) {
+    LOG(INFO) << "Skipping test, io_uring is not supported.";
+    return;
+  }
+  const char* tmp_file = "/tmp/disk_io_mgr_test_io_uring.txt";
+  const int64_t DATA_LEN = 1000;
+  const int64_t CHUNK_LEN = 7;
+  vector<uint8_t> data(DATA_LEN);
+  for (int i = 0; i < DATA_LEN; ++i) data[i] = 'a' + i % 26;
+
+  IoUring ring;
+  ASSERT_OK(ring.Init(4));
+  int fd = open(tmp_file, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  ASSERT_GE(fd, 0);
+  // Write the second half before the first half.
+  ASSERT_OK(ring.Write(fd, data.data() + DATA_LEN / 2, DATA_LEN / 2, DATA_LEN / 2,
+      CHUNK_LEN));
+  ASSERT_OK(ring.Write(fd, data.data(), DATA_LEN / 2, 0, CHUNK_LEN));
+
+  vector<uint8_t> result(DATA_LEN + 100);
+  int64_t bytes_read;
+  ASSERT_OK(ring.Read(fd, result.data(), DATA_LEN, 0, CHUNK_LEN, &bytes_read));
+  EXPECT_EQ(DATA_LEN, bytes_read);
+  EXPECT_EQ(0, memcmp(data.data(), result.data(), DATA_LEN));
+
+  // Reading past the end of the file returns the bytes up to the end.
+  ASSERT_OK(ring.Read(fd, result.data(), 200, DATA_LEN - 50, CHUNK_LEN, &bytes_read));
+  EXPECT_EQ(50, bytes_read);
+  EXPECT_EQ(0, memcmp(data.data() + DATA_LEN - 50, result.data(), 50));
+  ASSERT_OK(ring.Read(fd, result.data(), 10, DATA_LEN + 10, CHUNK_LEN, &bytes_read));
+  EXPECT_EQ(0, bytes_read);
+
+  // Errors are returned, e.g. for reads of a file opened for writing only.
+  int write_only_fd = open(tmp_file, O_WRONLY);
+  ASSERT_GE(write_only_fd, 0);
+  EXPECT_FALSE(
+      ring.Read(write_only_fd, result.data(), 10, 0, CHUNK_LEN, &bytes_read).ok());
+  EXPECT_EQ(EBADF, errno);
+  close(write_only_fd);
+  close(fd);
+  remove(tmp_file);
+}
+
 // IMPALA-2366: handle partial read where range goes past end of file.
 TEST_F(DiskIoMgrTest, PartialRead) {
   InitRootReservation(LARGE_RESERVATION_LIMIT);
@@ -26,8 +26,14 @@
 #include "runtime/io/disk-file.h"
 #include "runtime/io/disk-io-mgr-internal.h"
 #include "runtime/io/error-converter.h"
+#include "runtime/io/file-metadata-cache.h"
 #include "runtime/io/file-writer.h"
 #include "runtime/io/handle-cache.inline.h"
+#include "runtime/io/io-uring.h"
+#include "runtime/io/io-uring-file-reader.h"
+#include "runtime/io/io-uring-file-writer.h"
+
+#include <unordered_map>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
@@ -42,8 +48,10 @@
 #include "util/filesystem-util.h"
 #include "util/hdfs-util.h"
 #include "util/histogram-metric.h"
+#include "util/mem-info.h"
 #include "util/metrics.h"
 #include "util/os-util.h"
+#include "util/parse-util.h"
 #include "util/test-info.h"
 #include "util/time.h"
 
@@ -75,6 +83,23 @@ DEFINE_string(data_cache, "", "The configuration string for IO data cache. "
     "a capacity quota per directory. For example /data/0,/data/1:1TB means the cache "
     "may use up to 2TB, with 1TB max in /data/0 and /data/1 respectively. Please note "
     "that each Impala daemon on a host must have a unique caching directory.");
+// File metadata cache configuration
+DEFINE_string(file_metadata_cache_capacity, "0", "(Experimental) The maximum memory "
+    "used by the cache of file metadata, such as Parquet footers and page indexes and "
+    "ORC file tails, that is shared by all queries. Specified as number of bytes "
+    "('<int>[bB]?'), megabytes ('<float>[mM]'), gigabytes ('<float>[gG]') or percentage "
+    "of the physical memory ('<int>%'). 0, the default, disables the cache.");
+
+// io_uring configuration for local reads and writes, e.g. of scratch files.
+DEFINE_bool(use_io_uring, false, "(Experimental) If true, local disk reads and writes, "
+    "including those of scratch files and the data cache, are issued through io_uring, "
+    "which allows each disk thread to keep reads and writes of many ranges in flight. "
+    "Falls back to blocking I/O if the kernel doesn't support io_uring.");
+DEFINE_int32(io_uring_queue_depth, 64, "(Advanced) The maximum number of requests each "
+    "thread keeps in flight when --use_io_uring is true.");
+DEFINE_int64(io_uring_chunk_bytes, 256L * 1024L, "(Advanced) Local reads and writes "
+    "larger than this are split into requests of this size which are issued "
+    "concurrently when --use_io_uring is true.");
 
 // Rotational disks should have 1 thread per disk to minimize seeks.  Non-rotational
 // don't have this penalty and benefit from multiple concurrent IO requests.
@@ -283,6 +308,27 @@ Status WriteRange::DoWrite() {
   return DoWriteEnd(queue, ret_status);
 }
 
+unique_ptr<IoUringWrite> WriteRange::StartWrite(IoUring* ring, Status* status) {
+  // Remote scratch files are written sequentially through a shared file handle, so
+  // only writes to local files are issued asynchronously.
+  IoUringFileWriter* file_writer = disk_file_->disk_type() == DiskFileType::LOCAL ?
+      dynamic_cast<IoUringFileWriter*>(disk_file_->GetFileWriter()) :
+      nullptr;
+  if (file_writer == nullptr) {
+    *status = DoWrite();
+    return nullptr;
+  }
+  unique_ptr<IoUringWrite> write;
+  *status = file_writer->StartWriteOne(ring, this, &write);
+  return write;
+}
+
+Status WriteRange::FinishWrite(unique_ptr<IoUringWrite> write) {
+  IoUringFileWriter* file_writer =
+      static_cast<IoUringFileWriter*>(disk_file_->GetFileWriter());
+  return file_writer->FinishWriteOne(this, move(write));
+}
+
 Status WriteRange::DoWriteEnd(DiskQueue* queue, const Status& ret_status) {
   if (ret_status.ok()) {
     queue->write_size()->Update(len());
@@ -461,6 +507,17 @@ DiskIoMgr::~DiskIoMgr() {
 }
 
 Status DiskIoMgr::Init() {
+  if (FLAGS_use_io_uring) {
+    if (FLAGS_io_uring_queue_depth <= 0 || FLAGS_io_uring_chunk_bytes <= 0) {
+      return Status(Substitute("--io_uring_queue_depth ($0) and --io_uring_chunk_bytes "
+          "($1) must be positive.", FLAGS_io_uring_queue_depth,
+          FLAGS_io_uring_chunk_bytes));
+    }
+    if (!IoUring::IsSupported()) {
+      LOG(WARNING) << "--use_io_uring is set but io_uring is not supported by the "
+                   << "kernel. Local disk I/O uses blocking system calls.";
+    }
+  }
   for (int i = 0; i < disk_queues_.size(); ++i) {
     disk_queues_[i] = new DiskQueue(i);
     int num_threads_per_disk;
@@ -596,10 +653,28 @@ Status DiskIoMgr::Init() {
   ret = hadoopRzOptionsSetByteBufferPool(cached_read_options_, nullptr);
   DCHECK_EQ(ret, 0);
 
+  // The process MemTracker does not exist yet in some backend tests.
+  ExecEnv* exec_env = ExecEnv::GetInstance();
+  MemTracker* process_mem_tracker =
+      exec_env != nullptr ? exec_env->process_mem_tracker() : nullptr;
   if (!FLAGS_data_cache.empty()) {
-    remote_data_cache_.reset(new DataCache(FLAGS_data_cache));
+    remote_data_cache_.reset(new DataCache(FLAGS_data_cache, /*trace_replay=*/false,
+        process_mem_tracker));
     RETURN_IF_ERROR(remote_data_cache_->Init());
   }
+
+  bool is_percent; // not used
+  int64_t file_metadata_cache_capacity = ParseUtil::ParseMemSpec(
+      FLAGS_file_metadata_cache_capacity, &is_percent, MemInfo::physical_mem());
+  if (file_metadata_cache_capacity < 0) {
+    return Status(Substitute("Invalid file metadata cache capacity: '$0'",
+        FLAGS_file_metadata_cache_capacity));
+  }
+  if (file_metadata_cache_capacity > 0) {
+    file_metadata_cache_.reset(
+        new FileMetadataCache(file_metadata_cache_capacity, process_mem_tracker));
+    RETURN_IF_ERROR(file_metadata_cache_->Init());
+  }
   return Status::OK();
 }
 
@@ -681,24 +756,25 @@ int64_t DiskIoMgr::ComputeIdealBufferReservation(int64_t scan_range_len) {
   }
 }
 
-// This function gets the next RequestRange to work on for this disk. It blocks until
-// work is available or the thread is shut down.
+// This function gets the next RequestRange to work on for this disk. If 'block' is
+// true, it blocks until work is available or the thread is shut down.
 // Work is available if there is a RequestContext with
 //  - A ScanRange with a buffer available, or
 //  - A WriteRange in unstarted_write_ranges_ or
 //  - A RemoteOperRange in unstarted_remote_upload_ranges_
-RequestRange* DiskQueue::GetNextRequestRange(RequestContext** request_context) {
-  // This loops returns either with work to do or when the disk IoMgr shuts down.
+RequestRange* DiskQueue::GetNextRequestRange(
+    RequestContext** request_context, bool block) {
+  // This loops returns either with work to do, when the disk IoMgr shuts down or, if
+  // 'block' is false, when no context is queued.
   while (true) {
     *request_context = nullptr;
     {
       unique_lock<mutex> disk_lock(lock_);
-      while (!shut_down_ && request_contexts_.empty()) {
+      while (block && !shut_down_ && request_contexts_.empty()) {
         // wait if there are no readers on the queue
         work_available_.Wait(disk_lock);
       }
-      if (shut_down_) break;
-      DCHECK(!request_contexts_.empty());
+      if (shut_down_ || request_contexts_.empty()) break;
 
       // Get the next reader and remove the reader so that another disk thread
       // can't pick it up. It will be enqueued before issuing the read to HDFS
@@ -715,17 +791,25 @@ RequestRange* DiskQueue::GetNextRequestRange(RequestContext** request_context) {
     RequestRange* range = (*request_context)->GetNextRequestRange(disk_id_);
     if (range != nullptr) return range;
   }
-  DCHECK(shut_down_);
+  DCHECK(shut_down_ || !block);
   return nullptr;
 }
 
 void DiskQueue::DiskThreadLoop(DiskIoMgr* io_mgr) {
+  // Threads of local disks keep many reads and writes in flight if io_uring is used.
+  if (FLAGS_use_io_uring && disk_id_ < io_mgr->num_local_disks()) {
+    IoUring* ring = IoUring::ThreadLocal();
+    if (ring != nullptr) {
+      IoUringThreadLoop(ring);
+      return;
+    }
+  }
   // The thread waits until there is work or the queue is shut down. If there is work,
   // performs the read or write requested. Locks are not taken when reading from or
   // writing to disk.
   while (true) {
     RequestContext* worker_context = nullptr;
-    RequestRange* range = GetNextRequestRange(&worker_context);
+    RequestRange* range = GetNextRequestRange(&worker_context, /*block=*/true);
     if (range == nullptr) {
       DCHECK(shut_down_);
       return;
@@ -734,43 +818,124 @@ void DiskQueue::DiskThreadLoop(DiskIoMgr* io_mgr) {
     // See also IMPALA-6254 and IMPALA-6417.
     ScopedThreadContext tdi_scope(GetThreadDebugInfo(), worker_context->query_id(),
         worker_context->instance_id());
+    ProcessRequestRange(worker_context, range);
+  }
+}
 
-    switch (range->request_type()) {
-      case RequestType::READ: {
-        ScanRange* scan_range = static_cast<ScanRange*>(range);
-        ReadOutcome outcome = scan_range->DoRead(this, disk_id_);
-        worker_context->ReadDone(disk_id_, outcome, scan_range);
+void DiskQueue::IoUringThreadLoop(IoUring* ring) {
+  // A read or write that is in flight on 'ring'.
+  struct InFlightRequest {
+    RequestContext* context;
+    RequestRange* range;
+    unique_ptr<IoUringRead> read;
+    unique_ptr<IoUringWrite> write;
+  };
+  std::unordered_map<IoUring::Transfer*, InFlightRequest> in_flight;
+  bool shut_down = false;
+  // Submissions are separate from completions: the thread starts as many ranges as fit
+  // on the ring, then waits for any of them to complete. It only blocks waiting for
+  // new work if nothing is in flight, and drains the requests in flight before exiting.
+  while (!shut_down || !in_flight.empty()) {
+    // Ranges that are processed synchronously also count towards the limit, so that the
+    // completions are reaped regularly.
+    for (int i = 0; !shut_down && i < ring->queue_depth()
+         && static_cast<int>(in_flight.size()) < ring->queue_depth(); ++i) {
+      RequestContext* worker_context = nullptr;
+      const bool block = in_flight.empty();
+      RequestRange* range = GetNextRequestRange(&worker_context, block);
+      if (range == nullptr) {
+        shut_down = block;
         break;
       }
-      case RequestType::WRITE: {
+      // We are now working on behalf of a query, so set thread state appropriately.
+      // See also IMPALA-6254 and IMPALA-6417.
+      ScopedThreadContext tdi_scope(GetThreadDebugInfo(), worker_context->query_id(),
+          worker_context->instance_id());
+      InFlightRequest request{worker_context, range, nullptr, nullptr};
+      if (range->request_type() == RequestType::READ) {
+        ScanRange* scan_range = static_cast<ScanRange*>(range);
+        ReadOutcome outcome;
+        request.read = scan_range->StartRead(this, disk_id_, ring, &outcome);
+        if (request.read == nullptr) {
+          worker_context->ReadDone(disk_id_, outcome, scan_range);
+          continue;
+        }
+        IoUring::Transfer* transfer = request.read.get();
+        in_flight.emplace(transfer, move(request));
+      } else if (range->request_type() == RequestType::WRITE) {
         WriteRange* write_range = static_cast<WriteRange*>(range);
-        Status status = write_range->DoWrite();
-        worker_context->OperDone(write_range, status);
-        break;
-      }
-      case RequestType::FILE_UPLOAD: {
-        RemoteOperRange* oper_range = static_cast<RemoteOperRange*>(range);
-        int64_t size = oper_range->block_size();
-        // Use malloc to get the memory in case there is no available space
-        // in the buffer pool because spilling to disk happens when scarcity
-        // of memory in the buffer pool. Be better to preserve memory than
-        // malloc.
-        uint8_t* buffer = static_cast<uint8_t*>(malloc(size));
-        if (UNLIKELY(buffer == nullptr)) {
-          worker_context->OperDone(oper_range,
-              Status(Substitute("Couldn't allocate memory for remote file operations, "
-                                "block size: '$0'",
-                  size)));
-        } else {
-          Status oper_status = oper_range->DoOper(buffer, size);
-          worker_context->OperDone(oper_range, oper_status);
-          free(buffer);
+        Status status;
+        request.write = write_range->StartWrite(ring, &status);
+        if (request.write == nullptr) {
+          worker_context->OperDone(write_range, status);
+          continue;
         }
-        break;
+        IoUring::Transfer* transfer = request.write.get();
+        in_flight.emplace(transfer, move(request));
+      } else {
+        ProcessRequestRange(worker_context, range);
+      }
+    }
+    if (in_flight.empty()) continue;
+    ring->Poll(/*wait=*/true);
+    IoUring::Transfer* transfer;
+    while ((transfer = ring->PopFinished()) != nullptr) {
+      auto it = in_flight.find(transfer);
+      DCHECK(it != in_flight.end());
+      InFlightRequest request = move(it->second);
+      in_flight.erase(it);
+      ScopedThreadContext tdi_scope(GetThreadDebugInfo(), request.context->query_id(),
+          request.context->instance_id());
+      if (request.read != nullptr) {
+        ScanRange* scan_range = static_cast<ScanRange*>(request.range);
+        ReadOutcome outcome = scan_range->FinishRead(this, move(request.read));
+        request.context->ReadDone(disk_id_, outcome, scan_range);
+      } else {
+        WriteRange* write_range = static_cast<WriteRange*>(request.range);
+        Status status = write_range->FinishWrite(move(request.write));
+        request.context->OperDone(write_range, status);
+      }
+    }
+  }
+  DCHECK_EQ(ring->num_started(), 0);
+}
+
+void DiskQueue::ProcessRequestRange(RequestContext* worker_context, RequestRange* range) {
+  switch (range->request_type()) {
+    case RequestType::READ: {
+      ScanRange* scan_range = static_cast<ScanRange*>(range);
+      ReadOutcome outcome = scan_range->DoRead(this, disk_id_);
+      worker_context->ReadDone(disk_id_, outcome, scan_range);
+      break;
+    }
+    case RequestType::WRITE: {
+      WriteRange* write_range = static_cast<WriteRange*>(range);
+      Status status = write_range->DoWrite();
+      worker_context->OperDone(write_range, status);
+      break;
+    }
+    case RequestType::FILE_UPLOAD: {
+      RemoteOperRange* oper_range = static_cast<RemoteOperRange*>(range);
+      int64_t size = oper_range->block_size();
+      // Use malloc to get the memory in case there is no available space
+      // in the buffer pool because spilling to disk happens when scarcity
+      // of memory in the buffer pool. Be better to preserve memory than
+      // malloc.
+      uint8_t* buffer = static_cast<uint8_t*>(malloc(size));
+      if (UNLIKELY(buffer == nullptr)) {
+        worker_context->OperDone(oper_range,
+            Status(Substitute("Couldn't allocate memory for remote file operations, "
+                              "block size: '$0'",
+                size)));
+      } else {
+        Status oper_status = oper_range->DoOper(buffer, size);
+        worker_context->OperDone(oper_range, oper_status);
+        free(buffer);
       }
-      default:
-        DCHECK(false) << "Invalid request type: " << range->request_type();
+      break;
     }
+    default:
+      DCHECK(false) << "Invalid request type: " << range->request_type();
   }
 }
 
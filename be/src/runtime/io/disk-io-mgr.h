@@ -41,6 +41,7 @@ namespace io {
 
 class DataCache;
 class DiskQueue;
+class FileMetadataCache;
 
 /// Manager object that schedules IO for all queries on all disks and remote filesystems
 /// (such as S3). Each query maps to one or more RequestContext objects, each of which
@@ -416,6 +417,8 @@ class DiskIoMgr : public CacheLineAligned {
 
   DataCache* remote_data_cache() { return remote_data_cache_.get(); }
 
+  FileMetadataCache* file_metadata_cache() { return file_metadata_cache_.get(); }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(DiskIoMgr);
   friend class DiskIoMgrTest_Buffers_Test;
@@ -432,6 +435,7 @@ class DiskIoMgr : public CacheLineAligned {
   friend class RemoteOperRange;
   friend class HdfsFileReader;
   friend class LocalFileWriter;
+  friend class IoUringFileWriter;
 
   /// Write the specified range to disk and calls writer_context->WriteDone() when done.
   /// Responsible for opening and closing the file that is written.
@@ -496,6 +500,10 @@ class DiskIoMgr : public CacheLineAligned {
   /// non-local reads and data read from remote data nodes will be stored in it. If not
   /// configured, this would be NULL.
   std::unique_ptr<DataCache> remote_data_cache_;
+
+  /// Singleton cache of file metadata such as Parquet footers, shared by the scanners of
+  /// all queries. NULL if disabled with --file_metadata_cache_capacity=0.
+  std::unique_ptr<FileMetadataCache> file_metadata_cache_;
 };
 }
 }
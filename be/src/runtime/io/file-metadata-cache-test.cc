@@ -0,0 +1,192 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/io/file-metadata-cache.h"
+
+#include <gflags/gflags.h>
+
+#include "runtime/mem-tracker.h"
+#include "runtime/test-env.h"
+#include "testutil/gtest-util.h"
+#include "testutil/scoped-flag-setter.h"
+#include "util/impalad-metrics.h"
+#include "util/metrics.h"
+
+#include "common/names.h"
+
+DECLARE_bool(cache_force_single_shard);
+
+namespace impala {
+namespace io {
+
+class FileMetadataCacheTest : public testing::Test {
+ protected:
+  virtual void SetUp() override {
+    test_env_.reset(new TestEnv());
+    ASSERT_OK(test_env_->Init());
+  }
+
+  virtual void TearDown() override { test_env_.reset(); }
+
+  /// Creates a cache with a single shard, so that entries are evicted only once the
+  /// total charge exceeds 'capacity'.
+  unique_ptr<FileMetadataCache> CreateCache(
+      int64_t capacity, MemTracker* parent_mem_tracker = nullptr) {
+    auto single_shard = ScopedFlagSetter<bool>::Make(&FLAGS_cache_force_single_shard,
+        true);
+    unique_ptr<FileMetadataCache> cache(
+        new FileMetadataCache(capacity, parent_mem_tracker));
+    EXPECT_OK(cache->Init());
+    return cache;
+  }
+
+  static string FooterKey(const string& path, int64_t mtime = 1000, int64_t len = 100) {
+    return FileMetadataCache::MakeKey(
+        FileMetadataCache::Kind::PARQUET_FOOTER, path, mtime, len);
+  }
+
+  static int64_t Hits() {
+    return ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_HIT_COUNT->GetValue();
+  }
+  static int64_t Misses() {
+    return ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_MISS_COUNT->GetValue();
+  }
+  static int64_t TotalBytes() {
+    return ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_TOTAL_BYTES->GetValue();
+  }
+  static int64_t NumEntries() {
+    return ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_NUM_ENTRIES->GetValue();
+  }
+
+  unique_ptr<TestEnv> test_env_;
+};
+
+// Test that values are returned for the keys they were inserted with and that the hit
+// and miss metrics are updated.
+TEST_F(FileMetadataCacheTest, LookupAndInsert) {
+  unique_ptr<FileMetadataCache> cache = CreateCache(1024);
+  int64_t hits = Hits();
+  int64_t misses = Misses();
+  EXPECT_EQ(nullptr, cache->Lookup<string>(FooterKey("/a")));
+  EXPECT_EQ(misses + 1, Misses());
+
+  cache->Insert(FooterKey("/a"), make_shared<const string>("footer a"), 100);
+  shared_ptr<const string> value = cache->Lookup<string>(FooterKey("/a"));
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ("footer a", *value);
+  EXPECT_EQ(hits + 1, Hits());
+  EXPECT_EQ(100, TotalBytes());
+  EXPECT_EQ(1, NumEntries());
+
+  // Inserting the same key again replaces the value.
+  cache->Insert(FooterKey("/a"), make_shared<const string>("footer a2"), 200);
+  EXPECT_EQ("footer a2", *cache->Lookup<string>(FooterKey("/a")));
+  EXPECT_EQ(200, TotalBytes());
+  EXPECT_EQ(1, NumEntries());
+
+  cache.reset();
+  EXPECT_EQ(0, TotalBytes());
+  EXPECT_EQ(0, NumEntries());
+}
+
+// Test that a file that was modified or has a different length, and metadata of a
+// different kind or sub key, are not looked up from the entries of another.
+TEST_F(FileMetadataCacheTest, KeyDistinguishesFiles) {
+  unique_ptr<FileMetadataCache> cache = CreateCache(1024);
+  cache->Insert(FooterKey("/a", 1000, 100), make_shared<const string>("footer"), 10);
+  EXPECT_NE(nullptr, cache->Lookup<string>(FooterKey("/a", 1000, 100)));
+  EXPECT_EQ(nullptr, cache->Lookup<string>(FooterKey("/a", 1001, 100)));
+  EXPECT_EQ(nullptr, cache->Lookup<string>(FooterKey("/a", 1000, 101)));
+  EXPECT_EQ(nullptr, cache->Lookup<string>(FooterKey("/b", 1000, 100)));
+  EXPECT_EQ(nullptr, cache->Lookup<string>(FileMetadataCache::MakeKey(
+      FileMetadataCache::Kind::ORC_FILE_TAIL, "/a", 1000, 100)));
+  EXPECT_EQ(nullptr, cache->Lookup<string>(FileMetadataCache::MakeKey(
+      FileMetadataCache::Kind::PARQUET_FOOTER, "/a", 1000, 100, 1)));
+  // A path that contains the separator of the key must not collide either.
+  cache->Insert(FooterKey("1:/c"), make_shared<const string>("footer c"), 10);
+  EXPECT_EQ(nullptr, cache->Lookup<string>(FileMetadataCache::MakeKey(
+      FileMetadataCache::Kind::PARQUET_FOOTER, "/c", 1000, 100, 1)));
+}
+
+// Test that the least recently used entries are evicted once the capacity is exceeded,
+// and that evicted values stay valid while they are referenced.
+TEST_F(FileMetadataCacheTest, Eviction) {
+  unique_ptr<FileMetadataCache> cache = CreateCache(300);
+  for (int i = 0; i < 3; ++i) {
+    cache->Insert(FooterKey(Substitute("/$0", i)),
+        make_shared<const string>(Substitute("footer $0", i)), 100);
+  }
+  EXPECT_EQ(300, TotalBytes());
+  EXPECT_EQ(3, NumEntries());
+  shared_ptr<const string> footer1 = cache->Lookup<string>(FooterKey("/1"));
+  ASSERT_NE(nullptr, footer1);
+  // Touch /0 so that /1 is the least recently used entry.
+  EXPECT_NE(nullptr, cache->Lookup<string>(FooterKey("/0")));
+  cache->Insert(FooterKey("/3"), make_shared<const string>("footer 3"), 100);
+  EXPECT_EQ(300, TotalBytes());
+  EXPECT_EQ(3, NumEntries());
+  EXPECT_EQ(nullptr, cache->Lookup<string>(FooterKey("/1")));
+  EXPECT_NE(nullptr, cache->Lookup<string>(FooterKey("/0")));
+  EXPECT_NE(nullptr, cache->Lookup<string>(FooterKey("/3")));
+  EXPECT_EQ("footer 1", *footer1);
+
+  // Values larger than the capacity are not cached and don't evict other entries.
+  cache->Insert(FooterKey("/4"), make_shared<const string>("footer 4"), 301);
+  EXPECT_EQ(nullptr, cache->Lookup<string>(FooterKey("/4")));
+  EXPECT_EQ(3, NumEntries());
+}
+
+// Test that values of different types can be stored side by side.
+TEST_F(FileMetadataCacheTest, ValueTypes) {
+  unique_ptr<FileMetadataCache> cache = CreateCache(1024);
+  string page_index_key = FileMetadataCache::MakeKey(
+      FileMetadataCache::Kind::PARQUET_PAGE_INDEX, "/a", 1000, 100, 2);
+  cache->Insert(page_index_key, make_shared<const vector<uint8_t>>(16, 7), 16);
+  cache->Insert(FooterKey("/a"), make_shared<const string>("footer"), 10);
+  shared_ptr<const vector<uint8_t>> page_index =
+      cache->Lookup<vector<uint8_t>>(page_index_key);
+  ASSERT_NE(nullptr, page_index);
+  EXPECT_EQ(vector<uint8_t>(16, 7), *page_index);
+  EXPECT_EQ("footer", *cache->Lookup<string>(FooterKey("/a")));
+}
+
+// Test that the charges of the entries are tracked against the parent MemTracker and
+// that entries are not cached if the parent's limit would be exceeded.
+TEST_F(FileMetadataCacheTest, MemTracking) {
+  MemTracker parent_tracker(250);
+  unique_ptr<FileMetadataCache> cache = CreateCache(1024, &parent_tracker);
+  cache->Insert(FooterKey("/a"), make_shared<const string>("footer a"), 100);
+  cache->Insert(FooterKey("/b"), make_shared<const string>("footer b"), 100);
+  EXPECT_EQ(200, parent_tracker.consumption());
+
+  // Over the limit of the parent, even though the cache has room for it.
+  cache->Insert(FooterKey("/c"), make_shared<const string>("footer c"), 100);
+  EXPECT_EQ(nullptr, cache->Lookup<string>(FooterKey("/c")));
+  EXPECT_EQ(200, parent_tracker.consumption());
+  EXPECT_EQ(2, NumEntries());
+
+  // Replacing an entry releases the charge of the old value.
+  cache->Insert(FooterKey("/a"), make_shared<const string>("footer a2"), 50);
+  EXPECT_EQ(150, parent_tracker.consumption());
+  EXPECT_EQ("footer a2", *cache->Lookup<string>(FooterKey("/a")));
+
+  cache.reset();
+  EXPECT_EQ(0, parent_tracker.consumption());
+}
+
+} // namespace io
+} // namespace impala
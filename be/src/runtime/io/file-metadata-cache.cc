@@ -0,0 +1,109 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/io/file-metadata-cache.h"
+
+#include <cstring>
+#include <limits>
+
+#include "gutil/strings/substitute.h"
+#include "runtime/mem-tracker.h"
+#include "util/impalad-metrics.h"
+#include "util/metrics.h"
+
+#include "common/names.h"
+
+using kudu::Slice;
+using strings::Substitute;
+
+namespace impala {
+namespace io {
+
+FileMetadataCache::FileMetadataCache(int64_t capacity, MemTracker* parent_mem_tracker)
+  : capacity_(capacity),
+    mem_tracker_(new MemTracker(-1, "File Metadata Cache", parent_mem_tracker)),
+    cache_(NewCache(Cache::EvictionPolicy::LRU, capacity, "file-metadata-cache")) {}
+
+FileMetadataCache::~FileMetadataCache() {
+  // Destroying the cache calls EvictedEntry() for the remaining entries.
+  cache_.reset();
+  DCHECK_EQ(mem_tracker_->consumption(), 0);
+  mem_tracker_->Close();
+}
+
+Status FileMetadataCache::Init() {
+  RETURN_IF_ERROR(cache_->Init());
+  LOG(INFO) << "File metadata cache initialized with capacity " << capacity_ << " bytes";
+  return Status::OK();
+}
+
+string FileMetadataCache::MakeKey(Kind kind, const string& path, int64_t mtime,
+    int64_t file_length, int64_t sub_key) {
+  return Substitute("$0:$1:$2:$3:$4", static_cast<int>(kind), mtime, file_length,
+      sub_key, path);
+}
+
+shared_ptr<const void> FileMetadataCache::LookupInternal(const string& key) {
+  Cache::UniqueHandle handle(cache_->Lookup(key));
+  if (handle.get() == nullptr) {
+    ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_MISS_COUNT->Increment(1);
+    return nullptr;
+  }
+  ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_HIT_COUNT->Increment(1);
+  Entry* entry;
+  Slice value = cache_->Value(handle);
+  DCHECK_EQ(value.size(), sizeof(entry));
+  memcpy(&entry, value.data(), sizeof(entry));
+  // Copying the shared_ptr while holding the handle keeps the value alive after the
+  // entry is evicted.
+  return entry->value;
+}
+
+void FileMetadataCache::Insert(
+    const string& key, shared_ptr<const void> value, int64_t charge) {
+  DCHECK(value != nullptr);
+  if (charge > capacity_) return;
+  DCHECK_LE(charge, numeric_limits<int>::max());
+  // Caching is best effort, so give up rather than exceed the process memory limit.
+  if (!mem_tracker_->TryConsume(charge)) return;
+  Cache::UniquePendingHandle pending_handle(
+      cache_->Allocate(key, sizeof(Entry*), static_cast<int>(charge)));
+  if (pending_handle.get() == nullptr) {
+    mem_tracker_->Release(charge);
+    return;
+  }
+  Entry* entry = new Entry{move(value), charge};
+  memcpy(cache_->MutableValue(&pending_handle), &entry, sizeof(entry));
+  // The entry is accounted for before Insert() as the eviction callback undoes this if
+  // the entry is evicted during Insert().
+  ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_TOTAL_BYTES->Increment(charge);
+  ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_NUM_ENTRIES->Increment(1);
+  Cache::UniqueHandle handle(cache_->Insert(move(pending_handle), this));
+}
+
+void FileMetadataCache::EvictedEntry(Slice key, Slice value) {
+  Entry* entry;
+  DCHECK_EQ(value.size(), sizeof(entry));
+  memcpy(&entry, value.data(), sizeof(entry));
+  ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_TOTAL_BYTES->Increment(-entry->charge);
+  ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_NUM_ENTRIES->Increment(-1);
+  mem_tracker_->Release(entry->charge);
+  delete entry;
+}
+
+} // namespace io
+} // namespace impala
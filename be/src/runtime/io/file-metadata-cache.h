@@ -0,0 +1,111 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "common/status.h"
+#include "util/cache/cache.h"
+
+namespace impala {
+
+class MemTracker;
+
+namespace io {
+
+/// Process-wide cache of the metadata that scanners read from the tails of files and
+/// deserialize for every split, e.g. Parquet footers and page indexes and ORC file
+/// tails. It is shared across queries and scanners, so that scanning the same files
+/// again skips the I/O for the metadata and usually its deserialization too, which can
+/// dominate the scan time of tables with many small files and wide schemas.
+///
+/// The entries are keyed by the path, the modification time and the length of the file.
+/// Files that are rewritten get a different key, so stale entries are never returned
+/// and just age out of the cache. The values are immutable objects held by
+/// std::shared_ptr, so an entry that is evicted stays valid for the scanners that still
+/// use it. The cache is bounded by the estimated memory consumption of its values, as
+/// passed to Insert(), and uses LRU eviction. The charges of the entries are tracked
+/// against a MemTracker that is a child of the process MemTracker, and entries are not
+/// cached if that would exceed the process memory limit.
+///
+/// Hits, misses, the number of entries and their total size are exposed as metrics.
+/// The cache is thread-safe.
+class FileMetadataCache : public Cache::EvictionCallback {
+ public:
+  /// The kinds of metadata cached. Each kind is stored as a different type, see the
+  /// callers of Lookup() and Insert().
+  enum class Kind : uint8_t {
+    /// A parquet::FileMetaData object.
+    PARQUET_FOOTER,
+    /// The raw bytes of the page index of a row group, as a std::vector<uint8_t>.
+    PARQUET_PAGE_INDEX,
+    /// The serialized file tail returned by orc::Reader, as a std::string.
+    ORC_FILE_TAIL,
+  };
+
+  /// 'capacity' is the maximum total charge of the entries in bytes. The MemTracker of
+  /// the cache is a child of 'parent_mem_tracker', which is usually the process
+  /// MemTracker.
+  FileMetadataCache(int64_t capacity, MemTracker* parent_mem_tracker);
+  ~FileMetadataCache();
+
+  Status Init();
+
+  /// Returns the key of the metadata of 'kind' of the file at 'path' with the
+  /// modification time 'mtime' and length 'file_length'. 'sub_key' distinguishes
+  /// multiple entries of the same kind, e.g. the page indexes of the row groups.
+  static std::string MakeKey(Kind kind, const std::string& path, int64_t mtime,
+      int64_t file_length, int64_t sub_key = 0);
+
+  /// Returns the value cached for 'key', which must have been inserted with type 'T', or
+  /// nullptr if there is none. Updates the hit and miss metrics.
+  template <typename T>
+  std::shared_ptr<const T> Lookup(const std::string& key) {
+    return std::static_pointer_cast<const T>(LookupInternal(key));
+  }
+
+  /// Caches 'value' under 'key'. 'charge' is the estimated memory consumption of the
+  /// value in bytes. The value may be evicted right away, or not cached at all if
+  /// 'charge' exceeds the capacity or the memory limit of an ancestor MemTracker.
+  void Insert(
+      const std::string& key, std::shared_ptr<const void> value, int64_t charge);
+
+  /// Implementation of Cache::EvictionCallback. Frees the value and updates the metrics.
+  virtual void EvictedEntry(kudu::Slice key, kudu::Slice value) override;
+
+ private:
+  /// The value of each cache entry is a pointer to an Entry.
+  struct Entry {
+    std::shared_ptr<const void> value;
+    int64_t charge;
+  };
+
+  std::shared_ptr<const void> LookupInternal(const std::string& key);
+
+  const int64_t capacity_;
+
+  /// Tracks the total charge of the entries in 'cache_'.
+  std::unique_ptr<MemTracker> mem_tracker_;
+
+  std::unique_ptr<Cache> cache_;
+};
+
+} // namespace io
+} // namespace impala
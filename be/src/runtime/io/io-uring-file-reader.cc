@@ -0,0 +1,130 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/io/io-uring-file-reader.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "runtime/io/disk-io-mgr-internal.h"
+#include "runtime/io/io-uring.h"
+#include "runtime/io/request-ranges.h"
+#include "util/histogram-metric.h"
+#include "util/metrics.h"
+
+#include "common/names.h"
+
+DECLARE_int64(io_uring_chunk_bytes);
+#ifndef NDEBUG
+DECLARE_int32(stress_disk_read_delay_ms);
+#endif
+
+namespace impala {
+namespace io {
+
+Status IoUringFileReader::ReadFromPos(DiskQueue* queue, int64_t file_offset,
+    uint8_t* buffer, int64_t bytes_to_read, int64_t* bytes_read, bool* eof) {
+  IoUring* ring = IoUring::ThreadLocal();
+  if (ring == nullptr) {
+    return LocalFileReader::ReadFromPos(
+        queue, file_offset, buffer, bytes_to_read, bytes_read, eof);
+  }
+  DCHECK(scan_range_->read_in_flight());
+  DCHECK_GE(bytes_to_read, 0);
+  // Delay before acquiring the lock, to allow triggering IMPALA-6587 race.
+#ifndef NDEBUG
+  if (FLAGS_stress_disk_read_delay_ms > 0) {
+    SleepForMs(FLAGS_stress_disk_read_delay_ms);
+  }
+#endif
+  unique_lock<SpinLock> fs_lock(lock_);
+  RETURN_IF_ERROR(scan_range_->cancel_status_);
+
+  *eof = false;
+  *bytes_read = 0;
+
+  DCHECK(file_ != nullptr);
+  Status status;
+  {
+    ScopedHistogramTimer read_timer(queue->read_latency());
+    // The reads are positional, so the position of 'file_' doesn't matter.
+    status = ring->Read(fileno(file_), buffer, bytes_to_read, file_offset,
+        FLAGS_io_uring_chunk_bytes, bytes_read);
+  }
+  if (!status.ok()) {
+    return Status(TErrorCode::DISK_IO_ERROR, GetBackendString(),
+        Substitute("Error reading from $0 at byte offset: $1: $2",
+            *scan_range_->file_string(), file_offset, status.GetDetail()));
+  }
+  DCHECK_GE(*bytes_read, 0);
+  DCHECK_LE(*bytes_read, bytes_to_read);
+  queue->read_size()->Update(*bytes_read);
+  if (*bytes_read < bytes_to_read) *eof = true;
+  return Status::OK();
+}
+
+IoUringRead::~IoUringRead() {
+  close(fd_);
+}
+
+Status IoUringFileReader::StartRead(IoUring* ring, int64_t file_offset, uint8_t* buffer,
+    int64_t bytes_to_read, unique_ptr<IoUringRead>* read) {
+  DCHECK(scan_range_->read_in_flight());
+  DCHECK_GE(bytes_to_read, 0);
+#ifndef NDEBUG
+  if (FLAGS_stress_disk_read_delay_ms > 0) {
+    SleepForMs(FLAGS_stress_disk_read_delay_ms);
+  }
+#endif
+  unique_lock<SpinLock> fs_lock(lock_);
+  RETURN_IF_ERROR(scan_range_->cancel_status_);
+  DCHECK(file_ != nullptr);
+  // Cancelling the range closes 'file_', which may happen while the read is in flight,
+  // so the read uses its own file descriptor.
+  int fd = dup(fileno(file_));
+  if (fd < 0) {
+    return Status(TErrorCode::DISK_IO_ERROR, GetBackendString(),
+        Substitute("Could not duplicate file descriptor of $0: $1",
+            *scan_range_->file_string(), GetStrErrMsg()));
+  }
+  read->reset(new IoUringRead(
+      fd, buffer, bytes_to_read, file_offset, FLAGS_io_uring_chunk_bytes));
+  (*read)->timer_.Start();
+  ring->Start(read->get());
+  return Status::OK();
+}
+
+Status IoUringFileReader::FinishRead(DiskQueue* queue, const IoUringRead& read,
+    int64_t* bytes_read, bool* eof) {
+  DCHECK(read.done());
+  queue->read_latency()->Update(read.timer_.ElapsedTime());
+  *eof = false;
+  *bytes_read = 0;
+  if (read.error() != 0) {
+    return Status(TErrorCode::DISK_IO_ERROR, GetBackendString(),
+        Substitute("Error reading from $0 at byte offset: $1: $2",
+            *scan_range_->file_string(), read.offset_, read.GetStatus().GetDetail()));
+  }
+  *bytes_read = read.bytes_transferred();
+  DCHECK_LE(*bytes_read, read.len_);
+  queue->read_size()->Update(*bytes_read);
+  if (*bytes_read < read.len_) *eof = true;
+  return Status::OK();
+}
+
+}
+}
@@ -0,0 +1,88 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "runtime/io/io-uring.h"
+#include "runtime/io/local-file-reader.h"
+#include "util/stopwatch.h"
+
+namespace impala {
+namespace io {
+
+class BufferDescriptor;
+
+/// A read of a buffer of a scan range that is in flight on an io_uring, see
+/// IoUringFileReader::StartRead().
+class IoUringRead : public IoUring::Transfer {
+ public:
+  ~IoUringRead();
+
+  /// The buffer that is read into. Owned by the read while it is in flight.
+  std::unique_ptr<BufferDescriptor> buffer_desc;
+
+ private:
+  friend class IoUringFileReader;
+
+  IoUringRead(int fd, uint8_t* buffer, int64_t len, int64_t offset, int64_t chunk_len)
+    : IoUring::Transfer(IoUring::Opcode::READ, fd, buffer, len, offset, chunk_len),
+      fd_(fd),
+      offset_(offset),
+      len_(len) {}
+
+  /// A duplicate of the file descriptor of the reader, so that the reader can be
+  /// closed, e.g. by a cancellation, while the read is in flight.
+  const int fd_;
+
+  const int64_t offset_;
+  const int64_t len_;
+
+  /// Measures the latency of the read.
+  MonotonicStopWatch timer_;
+};
+
+/// File reader class for the local file system which reads through the io_uring of the
+/// calling disk thread. Each read is split into chunks of --io_uring_chunk_bytes which
+/// are in flight concurrently. ReadFromPos() blocks until the read is done, while
+/// StartRead() and FinishRead() let a disk thread keep reads of many ranges in flight.
+/// Opening and closing the file is done by LocalFileReader. Falls back to
+/// LocalFileReader's blocking reads if io_uring isn't available.
+class IoUringFileReader : public LocalFileReader {
+ public:
+  IoUringFileReader(ScanRange* scan_range) : LocalFileReader(scan_range) {}
+  ~IoUringFileReader() {}
+
+  virtual Status ReadFromPos(DiskQueue* disk_queue, int64_t file_offset, uint8_t* buffer,
+      int64_t bytes_to_read, int64_t* bytes_read, bool* eof) override;
+
+  /// Starts reading 'bytes_to_read' bytes at 'file_offset' into 'buffer' on 'ring'. The
+  /// file must be open. On success, sets 'read' to the started read, which must be
+  /// passed to FinishRead() once it is done. Returns an error if the range was
+  /// cancelled.
+  Status StartRead(IoUring* ring, int64_t file_offset, uint8_t* buffer,
+      int64_t bytes_to_read, std::unique_ptr<IoUringRead>* read);
+
+  /// Completes 'read' like ReadFromPos() completes a read: updates the read metrics of
+  /// 'disk_queue' and sets 'bytes_read' and 'eof'. Returns an error if the read failed.
+  Status FinishRead(DiskQueue* disk_queue, const IoUringRead& read, int64_t* bytes_read,
+      bool* eof);
+};
+
+}
+}
@@ -0,0 +1,157 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/io/io-uring-file-writer.h"
+
+#include <stdio.h>
+
+#include "runtime/io/disk-io-mgr-internal.h"
+#include "runtime/io/error-converter.h"
+#include "runtime/io/io-uring.h"
+#include "runtime/io/request-ranges.h"
+#include "util/histogram-metric.h"
+#include "util/impalad-metrics.h"
+#include "util/metrics.h"
+
+#include "common/names.h"
+
+DECLARE_int64(io_uring_chunk_bytes);
+#ifndef NDEBUG
+DECLARE_int32(stress_scratch_write_delay_ms);
+#endif
+
+namespace impala {
+namespace io {
+
+Status IoUringFileWriter::WriteRangeHelper(IoUring* ring, int fd,
+    const WriteRange* range, int64_t offset) {
+#ifndef NDEBUG
+  if (FLAGS_stress_scratch_write_delay_ms > 0) {
+    SleepForMs(FLAGS_stress_scratch_write_delay_ms);
+  }
+#endif
+  Status status =
+      ring->Write(fd, range->data(), range->len(), offset, FLAGS_io_uring_chunk_bytes);
+  if (!status.ok()) {
+    // Write() sets errno on failure.
+    return ErrorConverter::GetErrorStatusFromErrno("io_uring write", range->file(),
+        errno, {{"range_length", SimpleItoa(range->len())}});
+  }
+  ImpaladMetrics::IO_MGR_BYTES_WRITTEN->Increment(range->len());
+  return Status::OK();
+}
+
+Status IoUringFileWriter::Write(WriteRange* range, int64_t* written_bytes) {
+  IoUring* ring = IoUring::ThreadLocal();
+  if (ring == nullptr) return LocalFileWriter::Write(range, written_bytes);
+  lock_guard<mutex> lock(lock_);
+  if (file_ == nullptr) {
+    return Status(Substitute("File handle of $0 has been closed.", file_path_));
+  }
+  // Like LocalFileWriter::Write(), this bypasses the buffer of 'file_' so that the data
+  // can be read back as soon as the write completes. The ranges are appended, so the
+  // range is written at the current end of the data.
+  RETURN_IF_ERROR(WriteRangeHelper(ring, fileno(file_), range, written_bytes_));
+  range->SetOffset(written_bytes_);
+  written_bytes_ += range->len();
+  *written_bytes = written_bytes_;
+  return Status::OK();
+}
+
+Status IoUringFileWriter::WriteOne(WriteRange* write_range) {
+  DCHECK(write_range != nullptr);
+  IoUring* ring = IoUring::ThreadLocal();
+  if (ring == nullptr) return LocalFileWriter::WriteOne(write_range);
+  Status ret_status = Status::OK();
+  // Do not need to acquire the lock_ because we open a new file handle in WriteOne
+  // for writing, instead of sharing the same file handle.
+  FILE* file_handle = nullptr;
+  Status close_status = Status::OK();
+  DiskQueue* queue = io_mgr_->disk_queues_[write_range->disk_id()];
+
+  {
+    ScopedHistogramTimer write_timer(queue->write_latency());
+    ret_status = io_mgr_->local_file_system_->OpenForWrite(
+        write_range->file(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR, &file_handle);
+    if (!ret_status.ok()) goto end;
+
+    ret_status = WriteRangeHelper(
+        ring, fileno(file_handle), write_range, write_range->offset());
+
+    close_status = io_mgr_->local_file_system_->Fclose(file_handle, write_range->file());
+    if (ret_status.ok() && !close_status.ok()) ret_status = close_status;
+  }
+
+end:
+  if (ret_status.ok()) {
+    queue->write_size()->Update(write_range->len());
+  } else {
+    queue->write_io_err()->Increment(1);
+  }
+  return ret_status;
+}
+
+Status IoUringFileWriter::StartWriteOne(IoUring* ring, WriteRange* write_range,
+    unique_ptr<IoUringWrite>* write) {
+  DCHECK(write_range != nullptr);
+#ifndef NDEBUG
+  if (FLAGS_stress_scratch_write_delay_ms > 0) {
+    SleepForMs(FLAGS_stress_scratch_write_delay_ms);
+  }
+#endif
+  MonotonicStopWatch timer;
+  timer.Start();
+  FILE* file_handle = nullptr;
+  Status status = io_mgr_->local_file_system_->OpenForWrite(
+      write_range->file(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR, &file_handle);
+  if (!status.ok()) {
+    io_mgr_->disk_queues_[write_range->disk_id()]->write_io_err()->Increment(1);
+    return status;
+  }
+  // Like WriteOne(), this writes through its own file handle, so 'lock_' isn't needed.
+  write->reset(new IoUringWrite(file_handle, write_range->data(), write_range->len(),
+      write_range->offset(), FLAGS_io_uring_chunk_bytes));
+  (*write)->timer_ = timer;
+  ring->Start(write->get());
+  return Status::OK();
+}
+
+Status IoUringFileWriter::FinishWriteOne(
+    WriteRange* write_range, unique_ptr<IoUringWrite> write) {
+  DCHECK(write->done());
+  DiskQueue* queue = io_mgr_->disk_queues_[write_range->disk_id()];
+  Status ret_status;
+  if (write->error() != 0) {
+    ret_status = ErrorConverter::GetErrorStatusFromErrno("io_uring write",
+        write_range->file(), write->error(),
+        {{"range_length", SimpleItoa(write_range->len())}});
+  } else {
+    ImpaladMetrics::IO_MGR_BYTES_WRITTEN->Increment(write_range->len());
+  }
+  Status close_status =
+      io_mgr_->local_file_system_->Fclose(write->file_, write_range->file());
+  if (ret_status.ok() && !close_status.ok()) ret_status = close_status;
+  queue->write_latency()->Update(write->timer_.ElapsedTime());
+  if (ret_status.ok()) {
+    queue->write_size()->Update(write_range->len());
+  } else {
+    queue->write_io_err()->Increment(1);
+  }
+  return ret_status;
+}
+} // namespace io
+} // namespace impala
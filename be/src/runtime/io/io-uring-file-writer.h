@@ -0,0 +1,79 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdio.h>
+#include <memory>
+
+#include "runtime/io/io-uring.h"
+#include "runtime/io/local-file-writer.h"
+#include "util/stopwatch.h"
+
+namespace impala {
+namespace io {
+
+/// A write of a WriteRange that is in flight on an io_uring, see
+/// IoUringFileWriter::StartWriteOne().
+class IoUringWrite : public IoUring::Transfer {
+ private:
+  friend class IoUringFileWriter;
+
+  IoUringWrite(FILE* file, const uint8_t* data, int64_t len, int64_t offset,
+      int64_t chunk_len)
+    : IoUring::Transfer(IoUring::Opcode::WRITE, fileno(file), const_cast<uint8_t*>(data),
+          len, offset, chunk_len),
+      file_(file) {}
+
+  /// The file handle opened for the write. Closed by FinishWriteOne().
+  FILE* const file_;
+
+  /// Measures the latency of the write, including opening and closing the file.
+  MonotonicStopWatch timer_;
+};
+
+/// File writer class for the local file system which writes through the io_uring of
+/// the calling disk thread. Each write is split into chunks of --io_uring_chunk_bytes
+/// which are in flight concurrently. Opening and closing files is done through
+/// LocalFileSystem like in LocalFileWriter. Falls back to LocalFileWriter's blocking
+/// writes if io_uring isn't available.
+class IoUringFileWriter : public LocalFileWriter {
+ public:
+  IoUringFileWriter(DiskIoMgr* io_mgr, const char* file_path, int64_t file_size = 0)
+    : LocalFileWriter(io_mgr, file_path, file_size) {}
+  ~IoUringFileWriter() {}
+
+  virtual Status Write(WriteRange* range, int64_t* written_bytes) override;
+  virtual Status WriteOne(WriteRange* range) override;
+
+  /// Starts a write of 'range' like WriteOne() on 'ring' without waiting for it. On
+  /// success, sets 'write' to the started write, which must be passed to
+  /// FinishWriteOne() once it is done. Returns an error if the file couldn't be opened.
+  Status StartWriteOne(IoUring* ring, WriteRange* range,
+      std::unique_ptr<IoUringWrite>* write);
+
+  /// Completes 'write' of 'range': closes the file and updates the write metrics.
+  /// Returns an error if the write failed.
+  Status FinishWriteOne(WriteRange* range, std::unique_ptr<IoUringWrite> write);
+
+ private:
+  /// Writes the data of 'range' to 'fd' at 'offset' through 'ring'.
+  Status WriteRangeHelper(IoUring* ring, int fd, const WriteRange* range,
+      int64_t offset);
+};
+} // namespace io
+} // namespace impala
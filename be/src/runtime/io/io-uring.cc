@@ -0,0 +1,427 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/io/io-uring.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <memory>
+#include <string.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <gflags/gflags.h>
+
+#include "util/error-util.h"
+
+#include "common/names.h"
+
+DECLARE_int32(io_uring_queue_depth);
+
+namespace impala {
+namespace io {
+
+static int IoUringSetup(unsigned entries, io_uring_params* params) {
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+    unsigned flags) {
+  return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr,
+      0);
+}
+
+static int IoUringRegister(int ring_fd, unsigned opcode, void* arg, unsigned nr_args) {
+  return syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+static bool ProbeSupport() {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IoUringSetup(1, &params);
+  if (ring_fd < 0) {
+    LOG(INFO) << "io_uring is not available: " << GetStrErrMsg();
+    return false;
+  }
+  // Check for IORING_OP_READ and IORING_OP_WRITE, which were added after io_uring.
+  const int num_ops = 256;
+  size_t probe_size = sizeof(io_uring_probe) + num_ops * sizeof(io_uring_probe_op);
+  unique_ptr<uint8_t[]> probe_buffer(new uint8_t[probe_size]);
+  memset(probe_buffer.get(), 0, probe_size);
+  io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probe_buffer.get());
+  bool supported =
+      IoUringRegister(ring_fd, IORING_REGISTER_PROBE, probe, num_ops) == 0 &&
+      probe->last_op >= IORING_OP_WRITE &&
+      (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0 &&
+      (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED) != 0;
+  close(ring_fd);
+  if (!supported) LOG(INFO) << "io_uring doesn't support IORING_OP_READ/WRITE";
+  return supported;
+}
+
+bool IoUring::IsSupported() {
+  static const bool supported = ProbeSupport();
+  return supported;
+}
+
+IoUring* IoUring::ThreadLocal() {
+  static thread_local unique_ptr<IoUring> ring;
+  static thread_local bool init_failed = false;
+  if (ring != nullptr) return ring.get();
+  if (init_failed || !IsSupported()) return nullptr;
+  unique_ptr<IoUring> new_ring(new IoUring());
+  Status status = new_ring->Init(FLAGS_io_uring_queue_depth);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to set up io_uring, falling back to blocking I/O: "
+                 << status.GetDetail();
+    init_failed = true;
+    return nullptr;
+  }
+  ring = move(new_ring);
+  return ring.get();
+}
+
+IoUring::~IoUring() {
+  ReleaseResources();
+}
+
+void IoUring::ReleaseResources() {
+  if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ >= 0) close(ring_fd_);
+  sqes_ = nullptr;
+  cq_ring_ = nullptr;
+  sq_ring_ = nullptr;
+  ring_fd_ = -1;
+}
+
+Status IoUring::Init(int queue_depth) {
+  DCHECK_EQ(ring_fd_, -1);
+  DCHECK_GT(queue_depth, 0);
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = IoUringSetup(queue_depth, &params);
+  if (ring_fd_ < 0) {
+    return Status(Substitute("io_uring_setup() failed: $0", GetStrErrMsg()));
+  }
+  queue_depth_ = params.sq_entries;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = max(sq_ring_size_, cq_ring_size_);
+    cq_ring_size_ = sq_ring_size_;
+  }
+  void* sq_ring = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED) {
+    string error_msg = GetStrErrMsg();
+    ReleaseResources();
+    return Status(Substitute("Failed to map io_uring submission queue: $0", error_msg));
+  }
+  sq_ring_ = sq_ring;
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    void* cq_ring = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) {
+      string error_msg = GetStrErrMsg();
+      ReleaseResources();
+      return Status(Substitute("Failed to map io_uring completion queue: $0", error_msg));
+    }
+    cq_ring_ = cq_ring;
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    string error_msg = GetStrErrMsg();
+    ReleaseResources();
+    return Status(Substitute("Failed to map io_uring submission entries: $0", error_msg));
+  }
+  sqes_ = reinterpret_cast<io_uring_sqe*>(sqes);
+
+  uint8_t* sq = reinterpret_cast<uint8_t*>(sq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  uint8_t* cq = reinterpret_cast<uint8_t*>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  return Status::OK();
+}
+
+IoUring::Transfer::Transfer(Opcode opcode, int fd, uint8_t* buffer, int64_t len,
+    int64_t offset, int64_t chunk_len)
+  : opcode_(opcode), fd_(fd) {
+  DCHECK_GT(chunk_len, 0);
+  // A single request transfers less than 2GB.
+  chunk_len = min<int64_t>(chunk_len, 1L << 30);
+  for (int64_t chunk_offset = 0; chunk_offset < len; chunk_offset += chunk_len) {
+    chunks_.push_back({this, buffer + chunk_offset, offset + chunk_offset,
+        min(chunk_len, len - chunk_offset), 0});
+  }
+}
+
+IoUring::Transfer::~Transfer() {
+  // The kernel may still access the buffer of a transfer that isn't done.
+  DCHECK(!started_) << "Transfer freed while in flight";
+}
+
+Status IoUring::Transfer::GetStatus() const {
+  DCHECK(done());
+  if (error_ == 0) return Status::OK();
+  return Status(GetStrErrMsg(error_));
+}
+
+int64_t IoUring::Transfer::bytes_transferred() const {
+  DCHECK(done());
+  // The bytes transferred are those up to the first chunk which hit the end of the
+  // file.
+  int64_t bytes = 0;
+  for (const Chunk& chunk : chunks_) {
+    bytes += chunk.done;
+    if (chunk.done < chunk.len) break;
+  }
+  return bytes;
+}
+
+void IoUring::Start(Transfer* transfer) {
+  DCHECK_GE(ring_fd_, 0);
+  DCHECK(!transfer->started_);
+  transfer->started_ = true;
+  transfer->error_ = 0;
+  transfer->num_outstanding_ = transfer->chunks_.size();
+  ++num_started_;
+  if (transfer->chunks_.empty()) {
+    finished_.push_back(transfer);
+    return;
+  }
+  for (Transfer::Chunk& chunk : transfer->chunks_) {
+    chunk.done = 0;
+    pending_.push_back(&chunk);
+  }
+}
+
+void IoUring::QueuePendingChunks() {
+  while (num_in_flight_ < queue_depth_ && !pending_.empty()) {
+    Transfer::Chunk* chunk = pending_.front();
+    pending_.pop_front();
+    if (chunk->transfer->error_ != 0) {
+      // Stop issuing requests of a failed transfer, but its requests in flight still
+      // reference the buffer.
+      FinishChunk(chunk);
+      continue;
+    }
+    QueueRequest(chunk);
+  }
+}
+
+void IoUring::QueueRequest(Transfer::Chunk* chunk) {
+  DCHECK_LT(num_in_flight_, queue_depth_);
+  // Only this thread produces submissions, so the tail can be read without a barrier.
+  const unsigned tail = *sq_tail_;
+  const unsigned index = tail & *sq_mask_;
+  io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode =
+      chunk->transfer->opcode_ == Opcode::READ ? IORING_OP_READ : IORING_OP_WRITE;
+  sqe->fd = chunk->transfer->fd_;
+  sqe->off = chunk->offset + chunk->done;
+  sqe->addr = reinterpret_cast<uint64_t>(chunk->buffer + chunk->done);
+  sqe->len = chunk->len - chunk->done;
+  sqe->user_data = reinterpret_cast<uint64_t>(chunk);
+  sq_array_[index] = index;
+  // Publish the entry to the kernel.
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++num_to_submit_;
+  ++num_in_flight_;
+}
+
+bool IoUring::PopCompletion(uint64_t* user_data, int32_t* res) {
+  // Only this thread consumes completions, so the head can be read without a barrier.
+  const unsigned head = *cq_head_;
+  if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) return false;
+  const io_uring_cqe* cqe = &cqes_[head & *cq_mask_];
+  *user_data = cqe->user_data;
+  *res = cqe->res;
+  // Release the entry to the kernel.
+  __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void IoUring::FinishChunk(Transfer::Chunk* chunk) {
+  Transfer* transfer = chunk->transfer;
+  DCHECK_GT(transfer->num_outstanding_, 0);
+  if (--transfer->num_outstanding_ == 0) finished_.push_back(transfer);
+}
+
+void IoUring::CompleteRequest(Transfer::Chunk* chunk, int32_t res) {
+  DCHECK_GT(num_in_flight_, 0);
+  --num_in_flight_;
+  Transfer* transfer = chunk->transfer;
+  if (res < 0) {
+    if ((res == -EINTR || res == -EAGAIN) && transfer->error_ == 0) {
+      pending_.push_front(chunk);
+      return;
+    }
+    if (transfer->error_ == 0) transfer->error_ = -res;
+  } else if (res == 0) {
+    // End of file for reads. A write which makes no progress is an error.
+    if (transfer->opcode_ == Opcode::WRITE && transfer->error_ == 0) {
+      transfer->error_ = EIO;
+    }
+  } else {
+    chunk->done += res;
+    DCHECK_LE(chunk->done, chunk->len);
+    if (chunk->done < chunk->len && transfer->error_ == 0) {
+      // Short transfer. Continue with the remainder of the chunk before the chunks
+      // that weren't started yet.
+      pending_.push_front(chunk);
+      return;
+    }
+  }
+  FinishChunk(chunk);
+}
+
+void IoUring::FailAll(int err) {
+  DCHECK_NE(err, 0);
+  uint64_t user_data;
+  int32_t res;
+  if (num_to_submit_ > 0) {
+    // The kernel only consumes submissions in io_uring_enter(), so the requests that it
+    // hasn't consumed yet can be taken back by moving the tail back.
+    unsigned tail = *sq_tail_;
+    for (int i = 0; i < num_to_submit_; ++i) {
+      --tail;
+      const io_uring_sqe* sqe = &sqes_[sq_array_[tail & *sq_mask_]];
+      pending_.push_front(reinterpret_cast<Transfer::Chunk*>(sqe->user_data));
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    num_in_flight_ -= num_to_submit_;
+    num_to_submit_ = 0;
+  }
+  DCHECK_GE(num_in_flight_, 0);
+  while (num_in_flight_ > 0) {
+    while (num_in_flight_ > 0 && PopCompletion(&user_data, &res)) {
+      Transfer::Chunk* chunk = reinterpret_cast<Transfer::Chunk*>(user_data);
+      if (chunk->transfer->error_ == 0) chunk->transfer->error_ = err;
+      --num_in_flight_;
+      FinishChunk(chunk);
+    }
+    if (num_in_flight_ == 0) break;
+    int ret = IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+    if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      // Returning now would let the kernel access the buffers after they are released.
+      LOG(FATAL) << "Failed to wait for " << num_in_flight_
+                 << " io_uring requests in flight: " << GetStrErrMsg();
+    }
+  }
+  for (Transfer::Chunk* chunk : pending_) {
+    if (chunk->transfer->error_ == 0) chunk->transfer->error_ = err;
+    FinishChunk(chunk);
+  }
+  pending_.clear();
+}
+
+void IoUring::Poll(bool wait) {
+  DCHECK_GE(ring_fd_, 0);
+  QueuePendingChunks();
+  while (true) {
+    // Only wait if no completion is available yet.
+    const bool get_events = wait && num_in_flight_ > 0
+        && *cq_head_ == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (num_to_submit_ == 0 && !get_events) break;
+    int ret = IoUringEnter(ring_fd_, num_to_submit_, get_events ? 1 : 0,
+        get_events ? IORING_ENTER_GETEVENTS : 0);
+    if (ret < 0) {
+      const int err = errno;
+      if (err == EINTR) continue;
+      LOG(WARNING) << "io_uring_enter() failed: " << GetStrErrMsg(err);
+      FailAll(err);
+      return;
+    }
+    DCHECK_LE(ret, num_to_submit_);
+    num_to_submit_ -= ret;
+    // Not all requests may have been consumed, e.g. because the completion queue is
+    // full. The remaining ones are submitted by the next call.
+    if (ret == 0 && !get_events) break;
+  }
+  uint64_t user_data;
+  int32_t res;
+  while (PopCompletion(&user_data, &res)) {
+    CompleteRequest(reinterpret_cast<Transfer::Chunk*>(user_data), res);
+  }
+}
+
+IoUring::Transfer* IoUring::PopFinished() {
+  if (finished_.empty()) return nullptr;
+  Transfer* transfer = finished_.front();
+  finished_.pop_front();
+  DCHECK(transfer->started_);
+  transfer->started_ = false;
+  --num_started_;
+  return transfer;
+}
+
+void IoUring::WaitFor(Transfer* transfer) {
+  DCHECK(transfer->started_);
+  while (!transfer->done()) Poll(/*wait=*/true);
+  auto it = find(finished_.begin(), finished_.end(), transfer);
+  DCHECK(it != finished_.end());
+  finished_.erase(it);
+  transfer->started_ = false;
+  --num_started_;
+}
+
+Status IoUring::Read(int fd, uint8_t* buffer, int64_t len, int64_t offset,
+    int64_t chunk_len, int64_t* bytes_read) {
+  Transfer transfer(Opcode::READ, fd, buffer, len, offset, chunk_len);
+  Start(&transfer);
+  WaitFor(&transfer);
+  if (transfer.error() != 0) {
+    Status status = transfer.GetStatus();
+    errno = transfer.error();
+    return status;
+  }
+  *bytes_read = transfer.bytes_transferred();
+  return Status::OK();
+}
+
+Status IoUring::Write(int fd, const uint8_t* buffer, int64_t len, int64_t offset,
+    int64_t chunk_len) {
+  Transfer transfer(
+      Opcode::WRITE, fd, const_cast<uint8_t*>(buffer), len, offset, chunk_len);
+  Start(&transfer);
+  WaitFor(&transfer);
+  if (transfer.error() != 0) {
+    Status status = transfer.GetStatus();
+    errno = transfer.error();
+    return status;
+  }
+  return Status::OK();
+}
+
+} // namespace io
+} // namespace impala
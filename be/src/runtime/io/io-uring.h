@@ -0,0 +1,233 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "common/status.h"
+#include "gutil/macros.h"
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+namespace impala {
+namespace io {
+
+/// Minimal wrapper around a Linux io_uring instance for positional reads and writes
+/// of local files. It talks to the kernel through the raw system calls so that it
+/// doesn't depend on liburing. An io_uring is a pair of ring buffers shared with the
+/// kernel: requests are queued in the submission queue and submitted together with a
+/// single system call, and the kernel posts their results to the completion queue. This
+/// allows a single thread to keep many reads or writes in flight.
+///
+/// A read or write is a Transfer, which is split into chunks that are issued as
+/// separate requests. Start() adds a transfer to the instance and Poll() submits the
+/// requests of all started transfers, up to queue_depth() at a time, and processes
+/// their completions. Transfers that are done are returned by PopFinished(), so a
+/// thread can keep transfers of many different ranges in flight and handle them in the
+/// order they complete. Read() and Write() are blocking wrappers for callers that only
+/// have a single transfer at hand; they may be mixed with asynchronous transfers.
+///
+/// Instances are not thread-safe. The disk threads and the data cache each use the
+/// instance of their thread, see ThreadLocal().
+///
+/// io_uring requires Linux 5.6 or later for IORING_OP_READ and IORING_OP_WRITE and may
+/// also be disabled by seccomp policies, e.g. inside containers. Callers are expected to
+/// fall back to the blocking system calls if IsSupported() is false.
+class IoUring {
+ public:
+  enum class Opcode { READ, WRITE };
+
+  /// A read or write of 'len' bytes of a buffer at 'offset' of the file 'fd', split into
+  /// requests of at most 'chunk_len' bytes. The buffer and the file descriptor must
+  /// remain valid until the transfer is done.
+  class Transfer {
+   public:
+    Transfer(Opcode opcode, int fd, uint8_t* buffer, int64_t len, int64_t offset,
+        int64_t chunk_len);
+    virtual ~Transfer();
+
+    /// True once none of the requests of the transfer are in flight any more.
+    bool done() const { return num_outstanding_ == 0; }
+
+    /// The errno of the first request that failed, or 0 if none failed. Only valid
+    /// once the transfer is done.
+    int error() const { return error_; }
+
+    /// Returns OK if none of the requests failed, otherwise an error with the message
+    /// of error(). Only valid once the transfer is done.
+    Status GetStatus() const;
+
+    /// The number of bytes transferred, which for a read is less than the length of
+    /// the transfer only if the end of the file was reached. Only valid once the
+    /// transfer is done and succeeded.
+    int64_t bytes_transferred() const;
+
+   private:
+    friend class IoUring;
+
+    /// State of a part of the transfer that is issued as a single request.
+    struct Chunk {
+      Transfer* transfer;
+      uint8_t* buffer;
+      int64_t offset;
+      int64_t len;
+      /// Bytes transferred so far.
+      int64_t done;
+    };
+
+    const Opcode opcode_;
+    const int fd_;
+    std::vector<Chunk> chunks_;
+
+    /// Chunks that are not fully transferred yet, including those waiting to be
+    /// submitted. After an error, chunks are dropped instead of being submitted.
+    int num_outstanding_ = 0;
+
+    int error_ = 0;
+
+    /// True while the transfer is started, i.e. from Start() until it is popped.
+    bool started_ = false;
+
+    DISALLOW_COPY_AND_ASSIGN(Transfer);
+  };
+
+  IoUring() = default;
+  ~IoUring();
+
+  /// Returns true if the kernel supports io_uring with the operations used here. The
+  /// check is done once and cached.
+  static bool IsSupported();
+
+  /// Returns the instance of the calling thread, creating it with
+  /// --io_uring_queue_depth entries on first use. Returns nullptr if io_uring isn't
+  /// supported or the instance couldn't be created, which is logged once per thread.
+  static IoUring* ThreadLocal();
+
+  /// Sets up the rings with room for at least 'queue_depth' requests in flight.
+  Status Init(int queue_depth);
+
+  /// Starts 'transfer'. Its requests are submitted by the next calls to Poll(). The
+  /// caller owns 'transfer' and must not free it before it was returned by
+  /// PopFinished() or passed to WaitFor().
+  void Start(Transfer* transfer);
+
+  /// Submits the queued requests of the started transfers and processes the available
+  /// completions. If 'wait' is true and requests are in flight, blocks until at least
+  /// one of them completed. Transfers that are done are returned by PopFinished(). If
+  /// the instance fails to submit the requests, all started transfers fail.
+  void Poll(bool wait);
+
+  /// Returns a started transfer that is done, or nullptr if there is none. The
+  /// transfers are returned in the order they finished.
+  Transfer* PopFinished();
+
+  /// Blocks until 'transfer', which must have been started, is done. Other transfers
+  /// that finish in the meantime are still returned by PopFinished().
+  void WaitFor(Transfer* transfer);
+
+  /// Number of transfers that were started but not yet popped.
+  int num_started() const { return num_started_; }
+
+  /// Reads 'len' bytes at 'offset' of the file 'fd' into 'buffer', keeping up to
+  /// queue_depth() chunks of at most 'chunk_len' bytes in flight at a time. Sets
+  /// 'bytes_read' to the number of bytes read, which is less than 'len' only if the end
+  /// of the file was reached. Returns an error, with errno set, if any of the reads
+  /// failed.
+  Status Read(int fd, uint8_t* buffer, int64_t len, int64_t offset, int64_t chunk_len,
+      int64_t* bytes_read);
+
+  /// Writes 'len' bytes from 'buffer' to the file 'fd' at 'offset' in the same way.
+  /// Returns an error, with errno set, if any of the writes failed or the request
+  /// couldn't be submitted.
+  Status Write(int fd, const uint8_t* buffer, int64_t len, int64_t offset,
+      int64_t chunk_len);
+
+  int queue_depth() const { return queue_depth_; }
+
+ private:
+  /// Moves chunks from 'pending_' into the submission queue while fewer than
+  /// queue_depth() requests are in flight.
+  void QueuePendingChunks();
+
+  /// Queues a request for the untransferred part of 'chunk'.
+  void QueueRequest(Transfer::Chunk* chunk);
+
+  /// Processes the result 'res' of a request for 'chunk'.
+  void CompleteRequest(Transfer::Chunk* chunk, int32_t res);
+
+  /// Marks 'chunk' as no longer outstanding, finishing its transfer if it was the last
+  /// one.
+  void FinishChunk(Transfer::Chunk* chunk);
+
+  /// Called after io_uring_enter() failed with 'err'. Takes back the requests that
+  /// weren't submitted and waits for the completions of the others, so that the kernel
+  /// no longer accesses their buffers, and fails all started transfers with 'err'.
+  void FailAll(int err);
+
+  /// Pops a completion from the completion queue if there is one. Returns false
+  /// otherwise.
+  bool PopCompletion(uint64_t* user_data, int32_t* res);
+
+  void ReleaseResources();
+
+  int ring_fd_ = -1;
+  int queue_depth_ = 0;
+
+  /// Requests queued but not yet submitted.
+  int num_to_submit_ = 0;
+
+  /// Requests queued or submitted whose completion hasn't been processed yet.
+  int num_in_flight_ = 0;
+
+  /// Transfers started but not yet popped.
+  int num_started_ = 0;
+
+  /// Chunks of started transfers that wait for a free slot, either because they
+  /// haven't been issued yet or because their last request only transferred part of
+  /// them.
+  std::deque<Transfer::Chunk*> pending_;
+
+  /// Transfers that are done, in the order they finished.
+  std::deque<Transfer*> finished_;
+
+  /// The mapped rings. 'cq_ring_' is the same as 'sq_ring_' if the kernel maps both
+  /// with a single mmap().
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  /// Pointers into the rings.
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+
+  DISALLOW_COPY_AND_ASSIGN(IoUring);
+};
+
+} // namespace io
+} // namespace impala
@@ -36,7 +36,7 @@ class LocalFileReader : public FileReader {
   virtual void CachedFile(uint8_t** data, int64_t* length) override;
   virtual void Close() override;
 
- private:
+ protected:
   /// Points to a C FILE object between calls to Open() and Close(), otherwise nullptr.
   FILE* file_ = nullptr;
 };
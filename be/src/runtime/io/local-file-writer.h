@@ -37,7 +37,7 @@ class LocalFileWriter : public FileWriter {
   // Open and close the file within the function.
   virtual Status WriteOne(WriteRange* range) override;
 
- private:
+ protected:
   /// Points to a C FILE object between calls to Open() and Close(), otherwise nullptr.
   FILE* file_ = nullptr;
 };
@@ -40,6 +40,9 @@ class DiskQueue;
 class ExclusiveHdfsFileHandle;
 class FileReader;
 class FileWriter;
+class IoUring;
+class IoUringRead;
+class IoUringWrite;
 class RequestContext;
 class ScanRange;
 
@@ -393,6 +396,19 @@ class ScanRange : public RequestRange {
   /// buffer reader.
   ReadOutcome DoReadInternal(DiskQueue* queue, int disk_id, bool use_local_buffer);
 
+  /// Called from a disk I/O thread to start the next read of this range on 'ring'.
+  /// Plain reads of local files that go through an IoUringFileReader are started
+  /// without waiting for them, and the read is returned. The caller must pass it to
+  /// FinishRead() once it is done. Otherwise performs the read like DoRead(), sets
+  /// 'outcome' and returns nullptr. 'outcome' is also set if the read couldn't be
+  /// started. Caller must not hold 'lock_'.
+  std::unique_ptr<IoUringRead> StartRead(
+      DiskQueue* queue, int disk_id, IoUring* ring, ReadOutcome* outcome);
+
+  /// Completes 'read', which was returned by StartRead() and is done, and returns the
+  /// outcome like DoRead().
+  ReadOutcome FinishRead(DiskQueue* queue, std::unique_ptr<IoUringRead> read);
+
   /// Same as Cancel() except it doesn't remove the scan range from
   /// reader_->active_scan_ranges_ or call WaitForInFlightRead(). This allows for
   /// custom handling of in flight reads or active scan ranges. For example, this is
@@ -424,6 +440,21 @@ class ScanRange : public RequestRange {
   /// END: private members that are accessed by other io:: classes
   /////////////////////////////////////////
 
+  /// Prepares the next read of the range: gets the buffer to read into, picks the file
+  /// reader and marks the read as in flight. Returns false and sets 'outcome' if the
+  /// range is cancelled or no buffer is available. Caller must not hold 'lock_'.
+  bool PrepareRead(bool use_local_buffer, std::unique_ptr<BufferDescriptor>* buffer_desc,
+      FileReader** file_reader, ReadOutcome* outcome);
+
+  /// Returns true if reads of this range should use the file handle cache.
+  bool UseFileHandleCache() const;
+
+  /// Completes a read of 'file_reader' into 'buffer_desc' that was prepared by
+  /// PrepareRead() and finished with 'read_status' and 'eof'. Enqueues the buffer, or
+  /// cancels the range if the read failed, and returns the outcome of the read.
+  ReadOutcome CompleteRead(std::unique_ptr<BufferDescriptor> buffer_desc,
+      FileReader* file_reader, const Status& read_status, bool eof);
+
   /// Enqueues a ready buffer with valid data for this range. This does not block.
   /// The caller passes ownership of buffer to the scan range and it is not
   /// valid to access buffer after this call. Returns false if the scan range was
@@ -647,6 +678,17 @@ class WriteRange : public RequestRange {
   /// Handle the status of Function DoWrite().
   Status DoWriteEnd(DiskQueue* queue, const Status& ret_status);
 
+  /// Starts writing this range on 'ring' if it goes to a local file through an
+  /// IoUringFileWriter, without waiting for the write, and returns the write. The
+  /// caller must pass it to FinishWrite() once it is done. Otherwise writes the range
+  /// like DoWrite(), sets 'status' and returns nullptr. 'status' is also set if the
+  /// write couldn't be started.
+  std::unique_ptr<IoUringWrite> StartWrite(IoUring* ring, Status* status);
+
+  /// Completes 'write', which was returned by StartWrite() and is done, and returns
+  /// its status like DoWrite().
+  Status FinishWrite(std::unique_ptr<IoUringWrite> write);
+
   /// Return the data to be written.
   const uint8_t* data() const { return data_; }
 
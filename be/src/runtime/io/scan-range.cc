@@ -19,6 +19,7 @@
 #include "runtime/io/disk-io-mgr-internal.h"
 #include "runtime/io/disk-io-mgr.h"
 #include "runtime/io/hdfs-file-reader.h"
+#include "runtime/io/io-uring-file-reader.h"
 #include "runtime/io/local-file-reader.h"
 #include "util/error-util.h"
 #include "util/hdfs-util.h"
@@ -34,6 +35,7 @@ using std::unique_lock;
 DECLARE_bool(cache_remote_file_handles);
 DECLARE_bool(cache_s3_file_handles);
 DECLARE_bool(cache_abfs_file_handles);
+DECLARE_bool(use_io_uring);
 
 // Implementation of the ScanRange functionality. Each ScanRange contains a queue
 // of ready buffers. For each ScanRange, there is only a single producer and
@@ -122,79 +124,59 @@ void ScanRange::AddUnusedBuffers(vector<unique_ptr<BufferDescriptor>>&& buffers,
   if (unblocked) ScheduleScanRange();
 }
 
-ReadOutcome ScanRange::DoReadInternal(
-    DiskQueue* queue, int disk_id, bool use_local_buff) {
-  int64_t bytes_remaining = bytes_to_read_ - bytes_read_;
-  DCHECK_GT(bytes_remaining, 0);
-
-  unique_ptr<BufferDescriptor> buffer_desc;
-  FileReader* file_reader = nullptr;
-  {
-    unique_lock<mutex> lock(lock_);
-    DCHECK(!read_in_flight_);
-    if (!cancel_status_.ok()) return ReadOutcome::CANCELLED;
+bool ScanRange::PrepareRead(bool use_local_buff,
+    unique_ptr<BufferDescriptor>* buffer_desc, FileReader** file_reader,
+    ReadOutcome* outcome) {
+  unique_lock<mutex> lock(lock_);
+  DCHECK(!read_in_flight_);
+  if (!cancel_status_.ok()) {
+    *outcome = ReadOutcome::CANCELLED;
+    return false;
+  }
 
-    if (buffer_manager_->is_client_buffer()) {
-      buffer_desc = unique_ptr<BufferDescriptor>(new BufferDescriptor(
-          this, client_buffer_.data, client_buffer_.len));
-    } else {
-      DCHECK(buffer_manager_->is_internal_buffer())
-          << "This code path does not handle other buffer types, i.e. HDFS cache. "
-          << "Buffer tag = "
-          << static_cast<int>(buffer_manager_->buffer_tag());
-      buffer_desc = buffer_manager_->GetUnusedBuffer(lock);
-      if (buffer_desc == nullptr) {
-        // No buffer available - the range will be rescheduled when a buffer is added.
-        blocked_on_buffer_ = true;
-        return ReadOutcome::BLOCKED_ON_BUFFER;
-      }
-      buffer_manager_->add_iomgr_buffer_cumulative_bytes_used(buffer_desc->buffer_len());
-    }
-    read_in_flight_ = true;
-    if (use_local_buff) {
-      file_reader = local_buffer_reader_.get();
-      file_ = disk_buffer_file_->path();
-    } else {
-      file_reader = file_reader_.get();
+  if (buffer_manager_->is_client_buffer()) {
+    *buffer_desc = unique_ptr<BufferDescriptor>(new BufferDescriptor(
+        this, client_buffer_.data, client_buffer_.len));
+  } else {
+    DCHECK(buffer_manager_->is_internal_buffer())
+        << "This code path does not handle other buffer types, i.e. HDFS cache. "
+        << "Buffer tag = "
+        << static_cast<int>(buffer_manager_->buffer_tag());
+    *buffer_desc = buffer_manager_->GetUnusedBuffer(lock);
+    if (*buffer_desc == nullptr) {
+      // No buffer available - the range will be rescheduled when a buffer is added.
+      blocked_on_buffer_ = true;
+      *outcome = ReadOutcome::BLOCKED_ON_BUFFER;
+      return false;
     }
-    use_local_buffer_ = use_local_buff;
+    buffer_manager_->add_iomgr_buffer_cumulative_bytes_used((*buffer_desc)->buffer_len());
+  }
+  read_in_flight_ = true;
+  if (use_local_buff) {
+    *file_reader = local_buffer_reader_.get();
+    file_ = disk_buffer_file_->path();
+  } else {
+    *file_reader = file_reader_.get();
   }
-  DCHECK(file_reader != nullptr);
+  use_local_buffer_ = use_local_buff;
+  DCHECK(*file_reader != nullptr);
+  return true;
+}
 
-  // No locks in this section.  Only working on local vars.  We don't want to hold a
-  // lock across the read call.
+bool ScanRange::UseFileHandleCache() const {
   // To use the file handle cache:
   // 1. It must be enabled at the daemon level.
   // 2. The file is a local HDFS file (expected_local_) OR it is a remote HDFS file and
   //    'cache_remote_file_handles' is true
-  bool use_file_handle_cache = false;
-  if (is_file_handle_caching_enabled() &&
+  return is_file_handle_caching_enabled() &&
       (expected_local_ ||
        (FLAGS_cache_remote_file_handles && disk_id_ == io_mgr_->RemoteDfsDiskId()) ||
        (FLAGS_cache_s3_file_handles && disk_id_ == io_mgr_->RemoteS3DiskId()) ||
-       (FLAGS_cache_abfs_file_handles && disk_id_ == io_mgr_->RemoteAbfsDiskId()))) {
-    use_file_handle_cache = true;
-  }
-  Status read_status = file_reader->Open(use_file_handle_cache);
-  bool eof = false;
-  if (read_status.ok()) {
-    COUNTER_ADD_IF_NOT_NULL(reader_->active_read_thread_counter_, 1L);
-    COUNTER_BITOR_IF_NOT_NULL(reader_->disks_accessed_bitmap_, 1LL << disk_id);
-
-    if (sub_ranges_.empty()) {
-      DCHECK(cache_.data == nullptr);
-      read_status =
-          file_reader->ReadFromPos(queue, offset_ + bytes_read_, buffer_desc->buffer_,
-              min(bytes_to_read() - bytes_read_, buffer_desc->buffer_len_),
-              &buffer_desc->len_, &eof);
-    } else {
-      read_status = ReadSubRanges(queue, buffer_desc.get(), &eof, file_reader);
-    }
-
-    COUNTER_ADD_IF_NOT_NULL(reader_->bytes_read_counter_, buffer_desc->len_);
-    COUNTER_ADD_IF_NOT_NULL(reader_->active_read_thread_counter_, -1L);
-  }
+       (FLAGS_cache_abfs_file_handles && disk_id_ == io_mgr_->RemoteAbfsDiskId()));
+}
 
+ReadOutcome ScanRange::CompleteRead(unique_ptr<BufferDescriptor> buffer_desc,
+    FileReader* file_reader, const Status& read_status, bool eof) {
   DCHECK(buffer_desc->buffer_ != nullptr);
   DCHECK(!buffer_desc->is_cached())
       << "Pure HDFS cache reads don't go through this code path.";
@@ -233,6 +215,91 @@ ReadOutcome ScanRange::DoReadInternal(
   return eosr ? ReadOutcome::SUCCESS_EOSR : ReadOutcome::SUCCESS_NO_EOSR;
 }
 
+ReadOutcome ScanRange::DoReadInternal(
+    DiskQueue* queue, int disk_id, bool use_local_buff) {
+  int64_t bytes_remaining = bytes_to_read_ - bytes_read_;
+  DCHECK_GT(bytes_remaining, 0);
+
+  unique_ptr<BufferDescriptor> buffer_desc;
+  FileReader* file_reader = nullptr;
+  ReadOutcome outcome;
+  if (!PrepareRead(use_local_buff, &buffer_desc, &file_reader, &outcome)) return outcome;
+
+  // No locks in this section.  Only working on local vars.  We don't want to hold a
+  // lock across the read call.
+  Status read_status = file_reader->Open(UseFileHandleCache());
+  bool eof = false;
+  if (read_status.ok()) {
+    COUNTER_ADD_IF_NOT_NULL(reader_->active_read_thread_counter_, 1L);
+    COUNTER_BITOR_IF_NOT_NULL(reader_->disks_accessed_bitmap_, 1LL << disk_id);
+
+    if (sub_ranges_.empty()) {
+      DCHECK(cache_.data == nullptr);
+      read_status =
+          file_reader->ReadFromPos(queue, offset_ + bytes_read_, buffer_desc->buffer_,
+              min(bytes_to_read() - bytes_read_, buffer_desc->buffer_len_),
+              &buffer_desc->len_, &eof);
+    } else {
+      read_status = ReadSubRanges(queue, buffer_desc.get(), &eof, file_reader);
+    }
+
+    COUNTER_ADD_IF_NOT_NULL(reader_->bytes_read_counter_, buffer_desc->len_);
+    COUNTER_ADD_IF_NOT_NULL(reader_->active_read_thread_counter_, -1L);
+  }
+  return CompleteRead(move(buffer_desc), file_reader, read_status, eof);
+}
+
+unique_ptr<IoUringRead> ScanRange::StartRead(
+    DiskQueue* queue, int disk_id, IoUring* ring, ReadOutcome* outcome) {
+  // Ranges with sub-ranges issue several reads per buffer and scratch ranges with a
+  // remote file need to hold the file locks across the read, so only plain reads of
+  // local files are issued asynchronously.
+  IoUringFileReader* io_uring_reader =
+      dynamic_cast<IoUringFileReader*>(file_reader_.get());
+  if (io_uring_reader == nullptr || !sub_ranges_.empty()
+      || (disk_file_ != nullptr && disk_file_->disk_type() != DiskFileType::LOCAL)) {
+    *outcome = DoRead(queue, disk_id);
+    return nullptr;
+  }
+  DCHECK_GT(bytes_to_read_ - bytes_read_, 0);
+
+  unique_ptr<BufferDescriptor> buffer_desc;
+  FileReader* file_reader = nullptr;
+  if (!PrepareRead(false, &buffer_desc, &file_reader, outcome)) return nullptr;
+  DCHECK_EQ(file_reader, io_uring_reader);
+
+  Status read_status = file_reader->Open(UseFileHandleCache());
+  if (read_status.ok()) {
+    COUNTER_ADD_IF_NOT_NULL(reader_->active_read_thread_counter_, 1L);
+    COUNTER_BITOR_IF_NOT_NULL(reader_->disks_accessed_bitmap_, 1LL << disk_id);
+    unique_ptr<IoUringRead> read;
+    read_status = io_uring_reader->StartRead(ring, offset_ + bytes_read_,
+        buffer_desc->buffer_,
+        min(bytes_to_read() - bytes_read_, buffer_desc->buffer_len_), &read);
+    if (read_status.ok()) {
+      read->buffer_desc = move(buffer_desc);
+      return read;
+    }
+    COUNTER_ADD_IF_NOT_NULL(reader_->active_read_thread_counter_, -1L);
+  }
+  *outcome = CompleteRead(move(buffer_desc), file_reader, read_status, false);
+  return nullptr;
+}
+
+ReadOutcome ScanRange::FinishRead(DiskQueue* queue, unique_ptr<IoUringRead> read) {
+  DCHECK(read_in_flight_);
+  IoUringFileReader* io_uring_reader =
+      static_cast<IoUringFileReader*>(file_reader_.get());
+  unique_ptr<BufferDescriptor> buffer_desc = move(read->buffer_desc);
+  bool eof = false;
+  Status read_status =
+      io_uring_reader->FinishRead(queue, *read, &buffer_desc->len_, &eof);
+  read.reset();
+  COUNTER_ADD_IF_NOT_NULL(reader_->bytes_read_counter_, buffer_desc->len_);
+  COUNTER_ADD_IF_NOT_NULL(reader_->active_read_thread_counter_, -1L);
+  return CompleteRead(move(buffer_desc), io_uring_reader, read_status, eof);
+}
+
 ReadOutcome ScanRange::DoRead(DiskQueue* queue, int disk_id) {
   bool use_local_buffer = false;
   if (disk_file_ != nullptr && disk_file_->disk_type() != DiskFileType::LOCAL) {
@@ -400,6 +467,13 @@ ScanRange::~ScanRange() {
   DCHECK(!read_in_flight_);
 }
 
+// Returns a reader for the local file system, which reads through io_uring if
+// --use_io_uring is true.
+static unique_ptr<FileReader> NewLocalFileReader(ScanRange* scan_range) {
+  if (FLAGS_use_io_uring) return make_unique<IoUringFileReader>(scan_range);
+  return make_unique<LocalFileReader>(scan_range);
+}
+
 void ScanRange::Reset(hdfsFS fs, const char* file, int64_t len, int64_t offset,
     int disk_id, bool expected_local, int64_t mtime, const BufferOpts& buffer_opts,
     void* meta_data, DiskFile* disk_file, DiskFile* disk_buffer_file) {
@@ -435,9 +509,9 @@ void ScanRange::Reset(hdfsFS fs, const char* file, int64_t len, int64_t offset,
   fs_ = fs;
   if (fs != nullptr) {
     file_reader_ = make_unique<HdfsFileReader>(this, fs_, false);
-    local_buffer_reader_ = make_unique<LocalFileReader>(this);
+    local_buffer_reader_ = NewLocalFileReader(this);
   } else {
-    file_reader_ = make_unique<LocalFileReader>(this);
+    file_reader_ = NewLocalFileReader(this);
   }
   file_ = file;
   len_ = len;
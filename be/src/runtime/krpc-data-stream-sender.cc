@@ -49,6 +49,8 @@
 #include "util/debug-util.h"
 #include "util/network-util.h"
 #include "util/pretty-printer.h"
+#include "util/spinlock.h"
+#include "util/time.h"
 
 #include "gen-cpp/data_stream_service.pb.h"
 #include "gen-cpp/data_stream_service.proxy.h"
@@ -108,6 +110,147 @@ void KrpcDataStreamSenderConfig::Close() {
   DataSinkConfig::Close();
 }
 
+// Chooses the codec used to compress the row batches sent to one or more destinations.
+// Without ADAPTIVE_EXCHANGE_COMPRESSION, this is always the codec from the query option
+// EXCHANGE_COMPRESSION_CODEC, or LZ4 if it's not set.
+//
+// In adaptive mode, the candidates are NONE, LZ4 and ZSTD (at the level from
+// EXCHANGE_COMPRESSION_CODEC if that's ZSTD). Each candidate is first used for
+// MIN_SAMPLES batches. After that the candidate with the lowest estimated cost per
+// uncompressed byte is used, where the cost is the serialization time plus the time to
+// send the serialized bytes at the network throughput measured for the destinations.
+// Both the compression ratio and the serialization time depend on the data, so every
+// RESAMPLE_INTERVAL batches one batch is sent with the candidate sampled least recently
+// to refresh its estimate.
+//
+// NextCodec() and RecordBatch() are called by the fragment instance thread while
+// RecordNetworkThroughput() is called by KRPC reactor threads.
+class KrpcDataStreamSender::CompressionSelector {
+ public:
+  explicit CompressionSelector(const TQueryOptions& query_options)
+    : adaptive_(query_options.adaptive_exchange_compression) {
+    if (query_options.__isset.exchange_compression_codec) {
+      const TCompressionCodec& codec = query_options.exchange_compression_codec;
+      // CompressionTypePB corresponds to THdfsCompression.
+      default_codec_ = static_cast<CompressionTypePB>(codec.codec);
+      if (codec.__isset.compression_level) zstd_level_ = codec.compression_level;
+    }
+    DCHECK(default_codec_ == CompressionTypePB::NONE
+        || default_codec_ == CompressionTypePB::LZ4
+        || default_codec_ == CompressionTypePB::ZSTD);
+  }
+
+  // Returns the codec to try for the next row batch.
+  CompressionTypePB NextCodec() {
+    if (!adaptive_) return default_codec_;
+    std::lock_guard<SpinLock> l(lock_);
+    ++num_batches_;
+    // Take the initial samples of each candidate in turn.
+    for (int i = 0; i < NUM_CANDIDATES; ++i) {
+      int c = (num_batches_ + i) % NUM_CANDIDATES;
+      if (stats_[c].num_samples < MIN_SAMPLES) return CANDIDATES[c];
+    }
+    if (num_batches_ % RESAMPLE_INTERVAL == 0) {
+      int oldest = 0;
+      for (int c = 1; c < NUM_CANDIDATES; ++c) {
+        if (stats_[c].last_sample < stats_[oldest].last_sample) oldest = c;
+      }
+      return CANDIDATES[oldest];
+    }
+    double network_ns_per_byte = static_cast<double>(NANOS_PER_SEC)
+        / (network_throughput_ > 0 ? network_throughput_ : DEFAULT_NETWORK_THROUGHPUT);
+    int best = 0;
+    double best_cost = numeric_limits<double>::max();
+    for (int c = 0; c < NUM_CANDIDATES; ++c) {
+      double cost =
+          stats_[c].ns_per_byte + stats_[c].serialized_ratio * network_ns_per_byte;
+      if (cost < best_cost) {
+        best = c;
+        best_cost = cost;
+      }
+    }
+    return CANDIDATES[best];
+  }
+
+  // The compression level to use if NextCodec() returned ZSTD.
+  int zstd_level() const { return zstd_level_; }
+
+  // Records the serialization of a row batch with 'codec' which took 'time_ns' and
+  // produced 'serialized_bytes' from 'uncompressed_bytes' of tuple data.
+  void RecordBatch(CompressionTypePB codec, int64_t uncompressed_bytes,
+      int64_t serialized_bytes, int64_t time_ns) {
+    if (!adaptive_ || uncompressed_bytes <= 0) return;
+    std::lock_guard<SpinLock> l(lock_);
+    CodecStats* stats = &stats_[CandidateIdx(codec)];
+    double ns_per_byte = static_cast<double>(time_ns) / uncompressed_bytes;
+    double serialized_ratio = static_cast<double>(serialized_bytes) / uncompressed_bytes;
+    if (stats->num_samples == 0) {
+      stats->ns_per_byte = ns_per_byte;
+      stats->serialized_ratio = serialized_ratio;
+    } else {
+      stats->ns_per_byte += SMOOTHING * (ns_per_byte - stats->ns_per_byte);
+      stats->serialized_ratio += SMOOTHING * (serialized_ratio - stats->serialized_ratio);
+    }
+    ++stats->num_samples;
+    stats->last_sample = num_batches_;
+  }
+
+  // Records the network throughput in bytes per second of a completed RPC.
+  void RecordNetworkThroughput(int64_t bytes_per_sec) {
+    if (!adaptive_ || bytes_per_sec <= 0) return;
+    std::lock_guard<SpinLock> l(lock_);
+    if (network_throughput_ == 0) {
+      network_throughput_ = bytes_per_sec;
+    } else {
+      network_throughput_ += SMOOTHING * (bytes_per_sec - network_throughput_);
+    }
+  }
+
+ private:
+  static constexpr int NUM_CANDIDATES = 3;
+  static constexpr CompressionTypePB CANDIDATES[NUM_CANDIDATES] = {
+      CompressionTypePB::NONE, CompressionTypePB::LZ4, CompressionTypePB::ZSTD};
+  static constexpr int MIN_SAMPLES = 2;
+  static constexpr int RESAMPLE_INTERVAL = 64;
+  // Weight of a new sample in the moving averages.
+  static constexpr double SMOOTHING = 0.25;
+  // Network throughput in bytes per second assumed before the first RPC completes.
+  static constexpr double DEFAULT_NETWORK_THROUGHPUT = 1024.0 * 1024.0 * 1024.0;
+
+  static int CandidateIdx(CompressionTypePB codec) {
+    for (int c = 0; c < NUM_CANDIDATES; ++c) {
+      if (CANDIDATES[c] == codec) return c;
+    }
+    DCHECK(false) << "Unexpected codec " << codec;
+    return 0;
+  }
+
+  // Moving averages of the measurements of one candidate.
+  struct CodecStats {
+    // Serialization time per uncompressed byte.
+    double ns_per_byte = 0;
+    // Serialized bytes per uncompressed byte.
+    double serialized_ratio = 1;
+    int64_t num_samples = 0;
+    // Value of 'num_batches_' when the last sample was taken.
+    int64_t last_sample = 0;
+  };
+
+  const bool adaptive_;
+  CompressionTypePB default_codec_ = CompressionTypePB::LZ4;
+  int zstd_level_ = 0;
+
+  // Protects the fields below.
+  SpinLock lock_;
+  int64_t num_batches_ = 0;
+  CodecStats stats_[NUM_CANDIDATES];
+  // Moving average of the network throughput in bytes per second. 0 if not measured yet.
+  double network_throughput_ = 0;
+};
+
+constexpr CompressionTypePB
+    KrpcDataStreamSender::CompressionSelector::CANDIDATES[NUM_CANDIDATES];
+
 // A datastream sender may send row batches to multiple destinations. There is one
 // channel for each destination.
 //
@@ -163,6 +306,14 @@ class KrpcDataStreamSender::Channel : public CacheLineAligned {
   // Returns OK if successful, error indication otherwise.
   Status Init(RuntimeState* state);
 
+  // Returns the compression selector for the batches sent through this channel. The
+  // batches of UNPARTITIONED senders are serialized once for all channels, so the
+  // channels share the parent's selector.
+  CompressionSelector* compression() {
+    if (compression_ != nullptr) return compression_.get();
+    return parent_->broadcast_compression_.get();
+  }
+
   // Serializes the given row batch and send it to the destination. If the preceding
   // RPC is in progress, this function may block until the previous RPC finishes.
   // Return error status if serialization or the preceding RPC failed. Return OK
@@ -224,6 +375,10 @@ class KrpcDataStreamSender::Channel : public CacheLineAligned {
   // Only used if the partitioning scheme is "KUDU" or "HASH_PARTITIONED".
   scoped_ptr<RowBatch> batch_;
 
+  // Chooses the codec for the batches serialized by this channel. nullptr if the
+  // partitioning scheme is UNPARTITIONED.
+  std::unique_ptr<CompressionSelector> compression_;
+
   // The outbound row batches are double-buffered so that we can serialize the next
   // batch while the other is still referenced by the in-flight RPC. Each entry contains
   // a RowBatchHeaderPB and the buffers for the serialized tuple offsets and data.
@@ -371,6 +526,9 @@ Status KrpcDataStreamSender::Channel::Init(RuntimeState* state) {
   int capacity =
       max(1, parent_->per_channel_buffer_size_ / max(row_desc_->GetRowSize(), 1));
   batch_.reset(new RowBatch(row_desc_, capacity, parent_->mem_tracker()));
+  if (parent_->partition_type_ != TPartitionType::UNPARTITIONED) {
+    compression_.reset(new CompressionSelector(state->query_options()));
+  }
 
   // Create a DataStreamService proxy to the destination.
   RETURN_IF_ERROR(DataStreamService::GetProxy(address_, hostname_, &proxy_));
@@ -508,6 +666,7 @@ void KrpcDataStreamSender::Channel::TransmitDataCompleteCb() {
       DCHECK_LE(row_batch_size, numeric_limits<int32_t>::max());
       int64_t network_throughput = row_batch_size * NANOS_PER_SEC / network_time;
       parent_->network_throughput_counter_->UpdateCounter(network_throughput);
+      compression()->RecordNetworkThroughput(network_throughput);
       parent_->network_time_stats_->UpdateCounter(network_time);
     }
     parent_->recvr_time_stats_->UpdateCounter(resp_.receiver_latency_ns());
@@ -594,7 +753,7 @@ Status KrpcDataStreamSender::Channel::SerializeAndSendBatch(RowBatch* batch) {
   ANNOTATE_IGNORE_READS_BEGIN();
   DCHECK(outbound_batch != rpc_in_flight_batch_);
   ANNOTATE_IGNORE_READS_END();
-  RETURN_IF_ERROR(parent_->SerializeBatch(batch, outbound_batch));
+  RETURN_IF_ERROR(parent_->SerializeBatch(batch, outbound_batch, compression()));
   RETURN_IF_ERROR(TransmitData(outbound_batch));
   next_batch_idx_ = (next_batch_idx_ + 1) % NUM_OUTBOUND_BATCHES;
   return Status::OK();
@@ -775,6 +934,13 @@ Status KrpcDataStreamSender::Prepare(
   uncompressed_bytes_counter_ =
       ADD_COUNTER(profile(), "UncompressedRowBatchSize", TUnit::BYTES);
   total_sent_rows_counter_= ADD_COUNTER(profile(), "RowsSent", TUnit::UNIT);
+  lz4_batches_counter_ = ADD_COUNTER(profile(), "Lz4CompressedBatches", TUnit::UNIT);
+  zstd_batches_counter_ = ADD_COUNTER(profile(), "ZstdCompressedBatches", TUnit::UNIT);
+  columnar_batches_counter_ = ADD_COUNTER(profile(), "ColumnarBatches", TUnit::UNIT);
+  columnar_format_ = state->query_options().exchange_columnar_format;
+  if (partition_type_ == TPartitionType::UNPARTITIONED) {
+    broadcast_compression_.reset(new CompressionSelector(state->query_options()));
+  }
   for (int i = 0; i < channels_.size(); ++i) {
     RETURN_IF_ERROR(channels_[i]->Init(state));
   }
@@ -989,10 +1155,17 @@ Status KrpcDataStreamSender::Send(RuntimeState* state, RowBatch* batch) {
   DCHECK(!closed_);
   DCHECK(!flushed_);
 
-  if (batch->num_rows() == 0) return Status::OK();
+  if (batch->num_active_rows() == 0) return Status::OK();
+  // Hash and Kudu partitioning only route the active rows of 'batch'. Serializing the
+  // whole batch copies all tuples anyway, so compact the rows before doing that.
+  if (partition_type_ == TPartitionType::UNPARTITIONED
+      || partition_type_ == TPartitionType::RANDOM || channels_.size() == 1) {
+    batch->CompactSelection();
+  }
   if (partition_type_ == TPartitionType::UNPARTITIONED) {
     OutboundRowBatch* outbound_batch = &outbound_batches_[next_batch_idx_];
-    RETURN_IF_ERROR(SerializeBatch(batch, outbound_batch, channels_.size()));
+    RETURN_IF_ERROR(SerializeBatch(
+        batch, outbound_batch, broadcast_compression_.get(), channels_.size()));
     // TransmitData() will block if there are still in-flight rpcs (and those will
     // reference the previously written serialized batch).
     for (int i = 0; i < channels_.size(); ++i) {
@@ -1008,14 +1181,14 @@ Status KrpcDataStreamSender::Send(RuntimeState* state, RowBatch* batch) {
   } else if (partition_type_ == TPartitionType::KUDU) {
     DCHECK_EQ(partition_expr_evals_.size(), 1);
     int num_channels = channels_.size();
-    const int num_rows = batch->num_rows();
+    const int num_rows = batch->num_active_rows();
     const int hash_batch_size = RowBatch::HASH_BATCH_SIZE;
     int channel_ids[hash_batch_size];
 
     for (int batch_start = 0; batch_start < num_rows; batch_start += hash_batch_size) {
       int batch_window_size = min(num_rows - batch_start, hash_batch_size);
       for (int i = 0; i < batch_window_size; ++i) {
-        TupleRow* row = batch->GetRow(i + batch_start);
+        TupleRow* row = batch->GetActiveRow(i + batch_start);
         int32_t partition =
             *reinterpret_cast<int32_t*>(partition_expr_evals_[0]->GetValue(row));
         if (partition < 0) {
@@ -1028,7 +1201,7 @@ Status KrpcDataStreamSender::Send(RuntimeState* state, RowBatch* batch) {
       }
 
       for (int i = 0; i < batch_window_size; ++i) {
-        TupleRow* row = batch->GetRow(i + batch_start);
+        TupleRow* row = batch->GetActiveRow(i + batch_start);
         RETURN_IF_ERROR(channels_[channel_ids[i]]->AddRow(row));
       }
     }
@@ -1042,7 +1215,7 @@ Status KrpcDataStreamSender::Send(RuntimeState* state, RowBatch* batch) {
       RETURN_IF_ERROR(HashAndAddRows(batch));
     }
   }
-  COUNTER_ADD(total_sent_rows_counter_, batch->num_rows());
+  COUNTER_ADD(total_sent_rows_counter_, batch->num_active_rows());
   expr_results_pool_->Clear();
   RETURN_IF_ERROR(state->CheckQueryState());
   return Status::OK();
@@ -1084,14 +1257,26 @@ void KrpcDataStreamSender::Close(RuntimeState* state) {
   DataSink::Close(state);
 }
 
-Status KrpcDataStreamSender::SerializeBatch(
-    RowBatch* src, OutboundRowBatch* dest, int num_receivers) {
+Status KrpcDataStreamSender::SerializeBatch(RowBatch* src, OutboundRowBatch* dest,
+    CompressionSelector* compression, int num_receivers) {
   VLOG_ROW << "serializing " << src->num_rows() << " rows";
   {
     SCOPED_TIMER(serialize_batch_timer_);
-    RETURN_IF_ERROR(src->Serialize(dest));
+    CompressionTypePB codec = compression->NextCodec();
+    int64_t start_time = MonotonicNanos();
+    RETURN_IF_ERROR(
+        src->Serialize(dest, codec, compression->zstd_level(), columnar_format_));
+    int64_t serialize_time = MonotonicNanos() - start_time;
     int64_t uncompressed_bytes = RowBatch::GetDeserializedSize(*dest);
     COUNTER_ADD(uncompressed_bytes_counter_, uncompressed_bytes * num_receivers);
+    compression->RecordBatch(codec, uncompressed_bytes,
+        RowBatch::GetSerializedSize(*dest), serialize_time);
+    if (dest->header()->compression_type() == CompressionTypePB::LZ4) {
+      COUNTER_ADD(lz4_batches_counter_, 1);
+    } else if (dest->header()->compression_type() == CompressionTypePB::ZSTD) {
+      COUNTER_ADD(zstd_batches_counter_, 1);
+    }
+    if (dest->header()->has_columnar_size()) COUNTER_ADD(columnar_batches_counter_, 1);
   }
   return Status::OK();
 }
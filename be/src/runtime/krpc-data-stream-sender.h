@@ -131,6 +131,7 @@ class KrpcDataStreamSender : public DataSink {
   /// buffers (ie, blocks if there are still in-flight rpcs from the last
   /// Send() call).
   virtual Status Send(RuntimeState* state, RowBatch* batch) override;
+  virtual bool AcceptsSelection() const override { return true; }
 
   /// Shutdown all existing channels to destination hosts. Further FlushFinal() calls are
   /// illegal after calling Close().
@@ -156,12 +157,15 @@ class KrpcDataStreamSender : public DataSink {
 
  private:
   class Channel;
+  class CompressionSelector;
 
-  /// Serializes the src batch into the serialized row batch 'dest' and updates
+  /// Serializes the src batch into the serialized row batch 'dest' with the codec chosen
+  /// by 'compression', in the columnar layout if 'columnar_format_' is set, and updates
   /// various stat counters.
   /// 'num_receivers' is the number of receivers this batch will be sent to. Used for
   /// updating the stat counters.
-  Status SerializeBatch(RowBatch* src, OutboundRowBatch* dest, int num_receivers = 1);
+  Status SerializeBatch(RowBatch* src, OutboundRowBatch* dest,
+      CompressionSelector* compression, int num_receivers = 1);
 
   /// Returns 'partition_expr_evals_[i]'. Used by the codegen'd HashRow() IR function.
   ScalarExprEvaluator* GetPartitionExprEvaluator(int i);
@@ -215,6 +219,14 @@ class KrpcDataStreamSender : public DataSink {
   /// List of all channels. One for each destination.
   std::vector<std::unique_ptr<Channel>> channels_;
 
+  /// Chooses the codec for the batches serialized for all channels. Only used when the
+  /// partitioning strategy is UNPARTITIONED. Each channel has its own otherwise.
+  std::unique_ptr<CompressionSelector> broadcast_compression_;
+
+  /// If true, row batches are serialized with the columnar tuple data layout. Set from
+  /// the EXCHANGE_COLUMNAR_FORMAT query option.
+  bool columnar_format_ = false;
+
   /// Expressions of partition keys. It's used to compute the
   /// per-row partition values for shuffling exchange;
   const std::vector<ScalarExpr*>& partition_exprs_;
@@ -244,6 +256,13 @@ class KrpcDataStreamSender : public DataSink {
   /// Total number of rows sent.
   RuntimeProfile::Counter* total_sent_rows_counter_ = nullptr;
 
+  /// Number of row batches serialized with LZ4 and ZSTD compressed tuple data.
+  RuntimeProfile::Counter* lz4_batches_counter_ = nullptr;
+  RuntimeProfile::Counter* zstd_batches_counter_ = nullptr;
+
+  /// Number of row batches serialized with the columnar tuple data layout.
+  RuntimeProfile::Counter* columnar_batches_counter_ = nullptr;
+
   /// Summary of network throughput for sending row batches. Network time also includes
   /// queuing time in KRPC transfer queue for transmitting the RPC requests and receiving
   /// the responses.
@@ -73,14 +73,33 @@ class RowBatchSerializeTest : public testing::Test {
   // Serializes and deserializes 'batch', then checks that the deserialized batch is valid
   // and has the same contents as 'batch'. If serialization returns an error (e.g. if the
   // row batch is too large to serialize), this will return that error.
+  // 'codec', 'compression_level' and 'columnar' are passed to Serialize(). If
+  // 'expected_compression' is not nullptr, the compression type of the serialized batch
+  // is compared to it.
   Status TestRowBatchInternal(const RowDescriptor& row_desc, RowBatch* batch,
-      bool print_batches, bool full_dedup = false) {
+      bool print_batches, bool full_dedup = false,
+      CompressionTypePB codec = CompressionTypePB::LZ4, int compression_level = 0,
+      const THdfsCompression::type* expected_compression = nullptr,
+      bool columnar = false) {
     if (print_batches) cout << PrintBatch(batch) << endl;
 
     TRowBatch trow_batch;
-    RETURN_IF_ERROR(batch->Serialize(&trow_batch, full_dedup));
+    RETURN_IF_ERROR(batch->Serialize(
+        &trow_batch, full_dedup, codec, compression_level, columnar));
+    if (expected_compression != nullptr) {
+      EXPECT_EQ(*expected_compression, trow_batch.compression_type);
+    }
+    EXPECT_EQ(columnar, trow_batch.__isset.columnar_size);
+    if (columnar) {
+      // The deserializer rejects batches whose columnar size exceeds this bound.
+      EXPECT_LE(trow_batch.columnar_size,
+          ColumnarTupleData::MaxEncodedLen(row_desc, trow_batch.uncompressed_size));
+    }
 
-    RowBatch deserialized_batch(&row_desc, trow_batch, tracker_.get());
+    unique_ptr<RowBatch> deserialized_ptr;
+    RETURN_IF_ERROR(
+        RowBatch::FromThrift(&row_desc, trow_batch, tracker_.get(), &deserialized_ptr));
+    RowBatch& deserialized_batch = *deserialized_ptr;
     if (print_batches) cout << PrintBatch(&deserialized_batch) << endl;
 
     EXPECT_EQ(batch->num_rows(), deserialized_batch.num_rows());
@@ -105,6 +124,17 @@ class RowBatchSerializeTest : public testing::Test {
     EXPECT_OK(TestRowBatchInternal(row_desc, batch, print_batches, full_dedup));
   }
 
+  // Same as TestRowBatch() but serializes 'batch' in the columnar layout with each of
+  // the supported codecs.
+  void TestColumnarRowBatch(const RowDescriptor& row_desc, RowBatch* batch,
+      bool full_dedup = false) {
+    for (CompressionTypePB codec : {CompressionTypePB::NONE, CompressionTypePB::LZ4,
+             CompressionTypePB::ZSTD}) {
+      EXPECT_OK(TestRowBatchInternal(
+          row_desc, batch, false, full_dedup, codec, 0, nullptr, true));
+    }
+  }
+
   // Construct a RowBatch with the specified size by creating a single row with
   // multiple strings, then test whether this RowBatch can be serialized and
   // deserialized successfully. If there is an error during serialization,
@@ -417,6 +447,107 @@ TEST_F(RowBatchSerializeTest, String) {
   TestRowBatch(row_desc, batch, true);
 }
 
+// Test that the batches round-trip with each of the supported codecs.
+TEST_F(RowBatchSerializeTest, CompressionCodecs) {
+  // tuple: (int, string)
+  DescriptorTblBuilder builder(frontend(), &pool_);
+  builder.DeclareTuple() << TYPE_INT << TYPE_STRING;
+  DescriptorTbl* desc_tbl = builder.Build();
+
+  vector<bool> nullable_tuples(1, false);
+  vector<TTupleId> tuple_id(1, (TTupleId) 0);
+  RowDescriptor row_desc(*desc_tbl, tuple_id, nullable_tuples);
+
+  // Build a batch of identical, non-adjacent rows so the data is compressible.
+  const TupleDescriptor* tuple_desc = row_desc.tuple_descriptors()[0];
+  RowBatch* batch = pool_.Add(new RowBatch(&row_desc, 1024, tracker_.get()));
+  MemPool* pool = batch->tuple_data_pool();
+  const string str_val = "a string value repeated in every tuple";
+  for (int i = 0; i < batch->capacity(); ++i) {
+    Tuple* tuple = Tuple::Create(tuple_desc->byte_size(), pool);
+    int32_t int_val = i % 7;
+    RawValue::Write(&int_val, tuple, tuple_desc->slots()[0], pool);
+    StringValue string_val(const_cast<char*>(str_val.data()), str_val.size());
+    RawValue::Write(&string_val, tuple, tuple_desc->slots()[1], pool);
+    int row_idx = batch->AddRow();
+    batch->GetRow(row_idx)->SetTuple(0, tuple);
+    batch->CommitLastRow();
+  }
+
+  const THdfsCompression::type none = THdfsCompression::NONE;
+  const THdfsCompression::type lz4 = THdfsCompression::LZ4;
+  const THdfsCompression::type zstd = THdfsCompression::ZSTD;
+  EXPECT_OK(TestRowBatchInternal(
+      row_desc, batch, false, false, CompressionTypePB::NONE, 0, &none));
+  EXPECT_OK(TestRowBatchInternal(
+      row_desc, batch, false, false, CompressionTypePB::LZ4, 0, &lz4));
+  EXPECT_OK(TestRowBatchInternal(
+      row_desc, batch, false, false, CompressionTypePB::ZSTD, 0, &zstd));
+  EXPECT_OK(TestRowBatchInternal(
+      row_desc, batch, false, true, CompressionTypePB::ZSTD, 9, &zstd));
+
+  // A batch with corrupt compressed data fails to deserialize.
+  for (CompressionTypePB codec : {CompressionTypePB::LZ4, CompressionTypePB::ZSTD}) {
+    TRowBatch trow_batch;
+    ASSERT_OK(batch->Serialize(&trow_batch, false, codec));
+    ASSERT_NE(THdfsCompression::NONE, trow_batch.compression_type);
+    trow_batch.tuple_data.resize(trow_batch.tuple_data.size() / 2);
+    unique_ptr<RowBatch> deserialized_batch;
+    EXPECT_FALSE(RowBatch::FromThrift(
+        &row_desc, trow_batch, tracker_.get(), &deserialized_batch).ok());
+    EXPECT_TRUE(deserialized_batch == nullptr);
+  }
+}
+
+// Test that batches with fixed-length, string, collection slots and zero-length tuples
+// round-trip through the columnar layout.
+TEST_F(RowBatchSerializeTest, Columnar) {
+  // tuples: (int, bigint, string), (array<int>), ()
+  ColumnType array_type;
+  array_type.type = TYPE_ARRAY;
+  array_type.children.push_back(ColumnType(TYPE_INT));
+
+  DescriptorTblBuilder builder(frontend(), &pool_);
+  builder.DeclareTuple() << TYPE_INT << TYPE_BIGINT << TYPE_STRING;
+  builder.DeclareTuple() << array_type;
+  builder.DeclareTuple();
+  DescriptorTbl* desc_tbl = builder.Build();
+
+  vector<bool> nullable_tuples = {true, true, false};
+  vector<TTupleId> tuple_ids = {0, 1, 2};
+  RowDescriptor row_desc(*desc_tbl, tuple_ids, nullable_tuples);
+
+  RowBatch* batch = CreateRowBatch(row_desc);
+  TestColumnarRowBatch(row_desc, batch, false);
+  TestColumnarRowBatch(row_desc, batch, true);
+}
+
+// Test that the columnar layout handles NULL tuples and adjacent and non-adjacent
+// duplicate tuples.
+TEST_F(RowBatchSerializeTest, ColumnarDuplicates) {
+  // tuples: (int), (string)
+  DescriptorTblBuilder builder(frontend(), &pool_);
+  builder.DeclareTuple() << TYPE_INT;
+  builder.DeclareTuple() << TYPE_STRING;
+  DescriptorTbl* desc_tbl = builder.Build();
+
+  vector<bool> nullable_tuples(2, true);
+  vector<TTupleId> tuple_ids = {0, 1};
+  RowDescriptor row_desc(*desc_tbl, tuple_ids, nullable_tuples);
+
+  int num_rows = 1000;
+  vector<int> repeats = {1, 11};
+  RowBatch* batch = pool_.Add(new RowBatch(&row_desc, num_rows, tracker_.get()));
+  vector<vector<Tuple*>> distinct_tuples(2);
+  CreateTuples(*row_desc.tuple_descriptors()[0], batch->tuple_data_pool(), 100, 10, 10,
+      &distinct_tuples[0]);
+  CreateTuples(*row_desc.tuple_descriptors()[1], batch->tuple_data_pool(), 100, 10, 10,
+      &distinct_tuples[1]);
+  AddTuplesToRowBatch(num_rows, distinct_tuples, repeats, batch);
+  TestColumnarRowBatch(row_desc, batch, false);
+  TestColumnarRowBatch(row_desc, batch, true);
+}
+
 TEST_F(RowBatchSerializeTest, RowBatchLZ4Success) {
   // Inputs up to LZ4_MAX_INPUT_SIZE (0x7E000000) should work
   Status status = TestRowBatchLimits(LZ4_MAX_INPUT_SIZE);
@@ -754,7 +885,10 @@ TEST_F(RowBatchSerializeTest, DedupPathologicalFull) {
   // Serialized data should only have one copy of each tuple.
   EXPECT_EQ(total_byte_size, trow_batch.uncompressed_size);
   LOG(INFO) << "Deserializing row batch";
-  RowBatch deserialized_batch(&row_desc, trow_batch, tracker_.get());
+  unique_ptr<RowBatch> deserialized_ptr;
+  ASSERT_OK(
+      RowBatch::FromThrift(&row_desc, trow_batch, tracker_.get(), &deserialized_ptr));
+  RowBatch& deserialized_batch = *deserialized_ptr;
   LOG(INFO) << "Verifying row batch";
   // Need to do special verification: comparing all duplicate strings is too slow.
   EXPECT_EQ(batch->num_rows(), deserialized_batch.num_rows());
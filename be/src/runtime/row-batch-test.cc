@@ -21,6 +21,7 @@
 #include "testutil/gtest-util.h"
 #include "runtime/mem-tracker.h"
 #include "runtime/row-batch.h"
+#include "runtime/tuple-row.h"
 #include "service/fe-support.h"
 #include "service/frontend.h"
 #include "testutil/desc-tbl-builder.h"
@@ -70,6 +71,95 @@ TEST(RowBatchTest, AcquireStateWithMarkFlushResources) {
   }
 }
 
+TEST(RowBatchTest, Selection) {
+  // Test iterating over and compacting a batch with a selection vector.
+  ObjectPool pool;
+  DescriptorTblBuilder builder(fe.get(), &pool);
+  builder.DeclareTuple() << TYPE_INT;
+  DescriptorTbl* desc_tbl = builder.Build();
+
+  vector<bool> nullable_tuples = {false};
+  vector<TTupleId> tuple_id = {static_cast<TupleId>(0)};
+  RowDescriptor row_desc(*desc_tbl, tuple_id, nullable_tuples);
+  MemTracker tracker;
+  const int num_rows = 100;
+  // The tuples are only compared, not dereferenced.
+  vector<uint8_t> tuple_mem(num_rows);
+  vector<Tuple*> tuples(num_rows);
+  for (int i = 0; i < num_rows; ++i) tuples[i] = reinterpret_cast<Tuple*>(&tuple_mem[i]);
+  {
+    RowBatch batch(&row_desc, num_rows, &tracker);
+    batch.set_selection_allowed(true);
+    for (int i = 0; i < num_rows; ++i) {
+      batch.GetRow(batch.AddRow())->SetTuple(0, tuples[i]);
+      batch.CommitLastRow();
+    }
+    EXPECT_FALSE(batch.has_selection());
+    EXPECT_EQ(nullptr, batch.selection());
+    EXPECT_EQ(num_rows, batch.num_active_rows());
+    int num_visited = 0;
+    FOREACH_ACTIVE_ROW(&batch, 0, it) {
+      EXPECT_EQ(tuples[num_visited], it.Get()->GetTuple(0));
+      ++num_visited;
+    }
+    EXPECT_EQ(num_rows, num_visited);
+
+    // Select every third row.
+    int* sel;
+    ASSERT_OK(batch.GetSelectionBuffer(&sel));
+    int num_selected = 0;
+    for (int i = 0; i < num_rows; i += 3) sel[num_selected++] = i;
+    batch.SetSelection(num_selected);
+    EXPECT_TRUE(batch.has_selection());
+    EXPECT_EQ(num_rows, batch.num_rows());
+    EXPECT_EQ(num_selected, batch.num_active_rows());
+    num_visited = 0;
+    FOREACH_ACTIVE_ROW(&batch, 0, it) {
+      EXPECT_EQ(tuples[num_visited * 3], it.Get()->GetTuple(0));
+      EXPECT_EQ(it.Get(), batch.GetActiveRow(num_visited));
+      ++num_visited;
+    }
+    EXPECT_EQ(num_selected, num_visited);
+
+    // Iterate with a start index and a limit.
+    num_visited = 0;
+    FOREACH_ACTIVE_ROW_LIMIT(&batch, 5, 10, it) {
+      EXPECT_EQ(tuples[(5 + num_visited) * 3], it.Get()->GetTuple(0));
+      ++num_visited;
+    }
+    EXPECT_EQ(10, num_visited);
+
+    batch.CompactSelection();
+    EXPECT_FALSE(batch.has_selection());
+    EXPECT_EQ(num_selected, batch.num_rows());
+    for (int i = 0; i < num_selected; ++i) {
+      EXPECT_EQ(tuples[i * 3], batch.GetRow(i)->GetTuple(0));
+    }
+
+    // Reset() drops the selection vector but keeps the batch opted in.
+    ASSERT_OK(batch.GetSelectionBuffer(&sel));
+    sel[0] = 0;
+    batch.SetSelection(1);
+    batch.Reset();
+    EXPECT_FALSE(batch.has_selection());
+    EXPECT_EQ(0, batch.num_active_rows());
+    EXPECT_TRUE(batch.selection_allowed());
+  }
+  EXPECT_EQ(0, tracker.consumption());
+
+  // Allocating the selection vector fails cleanly if it would exceed the limit.
+  {
+    MemTracker limited_tracker(num_rows * sizeof(Tuple*));
+    RowBatch batch(&row_desc, num_rows, &limited_tracker);
+    batch.set_selection_allowed(true);
+    int* sel = nullptr;
+    Status status = batch.GetSelectionBuffer(&sel);
+    EXPECT_EQ(TErrorCode::MEM_LIMIT_EXCEEDED, status.code());
+    EXPECT_EQ(nullptr, sel);
+    EXPECT_FALSE(batch.has_selection());
+  }
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   InitCommonRuntime(argc, argv, true, impala::TestInfo::BE_TEST);
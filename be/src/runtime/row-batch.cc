@@ -21,6 +21,8 @@
 #include <memory>
 #include <boost/scoped_ptr.hpp>
 
+#include "gutil/strings/substitute.h"
+#include "runtime/columnar-tuple-data.h"
 #include "runtime/exec-env.h"
 #include "runtime/mem-tracker.h"
 #include "runtime/string-value.h"
@@ -82,26 +84,40 @@ RowBatch::RowBatch(
   DCHECK(mem_tracker_ != nullptr);
   DCHECK_EQ(num_tuples_per_row_, row_desc_->tuple_descriptors().size());
   DCHECK_GT(tuple_ptrs_size_, 0);
+  mem_tracker_->Consume(tuple_ptrs_size_);
+  tuple_ptrs_ = reinterpret_cast<Tuple**>(malloc(tuple_ptrs_size_));
+  DCHECK(tuple_ptrs_ != nullptr) << "Failed to allocate tuple pointers";
+}
+
+Status RowBatch::FromThrift(const RowDescriptor* row_desc, const TRowBatch& input_batch,
+    MemTracker* mem_tracker, unique_ptr<RowBatch>* row_batch_ptr) {
+  unique_ptr<RowBatch> row_batch(new RowBatch(row_desc, input_batch, mem_tracker));
   kudu::Slice input_tuple_data =
       kudu::Slice(input_batch.tuple_data.c_str(), input_batch.tuple_data.size());
   kudu::Slice input_tuple_offsets = kudu::Slice(
       reinterpret_cast<const char*>(input_batch.tuple_offsets.data()),
       input_batch.tuple_offsets.size() * sizeof(int32_t));
-  const THdfsCompression::type& compression_type = input_batch.compression_type;
-  DCHECK(compression_type == THdfsCompression::NONE ||
-      compression_type == THdfsCompression::LZ4)
+  // CompressionTypePB corresponds to THdfsCompression.
+  const CompressionTypePB compression_type =
+      static_cast<CompressionTypePB>(input_batch.compression_type);
+  DCHECK(compression_type == CompressionTypePB::NONE ||
+      compression_type == CompressionTypePB::LZ4 ||
+      compression_type == CompressionTypePB::ZSTD)
       << "Unexpected compression type: " << input_batch.compression_type;
 
-  mem_tracker_->Consume(tuple_ptrs_size_);
-  tuple_ptrs_ = reinterpret_cast<Tuple**>(malloc(tuple_ptrs_size_));
-  DCHECK(tuple_ptrs_ != nullptr) << "Failed to allocate tuple pointers";
-
   const uint64_t uncompressed_size = input_batch.uncompressed_size;
-  uint8_t* tuple_data = tuple_data_pool_.Allocate(uncompressed_size);
-  DCHECK(tuple_data != nullptr) << "Failed to allocate tuple data";
+  uint8_t* tuple_data = row_batch->tuple_data_pool_.TryAllocate(uncompressed_size);
+  if (UNLIKELY(tuple_data == nullptr)) {
+    return mem_tracker->MemLimitExceeded(
+        nullptr, "Failed to allocate tuple data for row batch", uncompressed_size);
+  }
 
-  Deserialize(input_tuple_offsets, input_tuple_data, uncompressed_size,
-      compression_type == THdfsCompression::LZ4, tuple_data);
+  const int64_t columnar_size =
+      input_batch.__isset.columnar_size ? input_batch.columnar_size : -1;
+  RETURN_IF_ERROR(row_batch->Deserialize(input_tuple_offsets, input_tuple_data,
+      uncompressed_size, columnar_size, compression_type, tuple_data));
+  *row_batch_ptr = move(row_batch);
+  return Status::OK();
 }
 
 RowBatch::RowBatch(const RowDescriptor* row_desc, const RowBatchHeaderPB& header,
@@ -121,26 +137,72 @@ RowBatch::RowBatch(const RowDescriptor* row_desc, const RowBatchHeaderPB& header
   DCHECK_GT(tuple_ptrs_size_, 0);
 }
 
-void RowBatch::Deserialize(const kudu::Slice& input_tuple_offsets,
+Status RowBatch::Deserialize(const kudu::Slice& input_tuple_offsets,
     const kudu::Slice& input_tuple_data, int64_t uncompressed_size,
-    bool is_compressed, uint8_t* tuple_data) {
+    int64_t columnar_size, CompressionTypePB compression_type, uint8_t* tuple_data) {
   DCHECK(tuple_ptrs_ != nullptr);
   DCHECK(tuple_data != nullptr);
-  if (is_compressed) {
+  DCHECK_EQ(input_tuple_offsets.size() % sizeof(int32_t), 0);
+  const int32_t* tuple_offsets =
+      reinterpret_cast<const int32_t*>(input_tuple_offsets.data());
+  int num_tuples = input_tuple_offsets.size() / sizeof(int32_t);
+
+  // Columnar tuple data is decompressed into a temporary buffer and then decoded into
+  // the row-major layout in 'tuple_data'.
+  const bool columnar = columnar_size >= 0;
+  MemPool columnar_pool(mem_tracker_);
+  auto columnar_pool_cleanup =
+      MakeScopeExitTrigger([&columnar_pool]() { columnar_pool.FreeAll(); });
+  uint8_t* decompressed_data = tuple_data;
+  int64_t decompressed_size = uncompressed_size;
+  if (columnar) {
+    // 'columnar_size' comes from the header of the batch. Check it before allocating.
+    if (columnar_size > ColumnarTupleData::MaxEncodedLen(*row_desc_, uncompressed_size)) {
+      return Status(Substitute("Invalid columnar size $0 for $1 bytes of tuple data",
+          columnar_size, uncompressed_size));
+    }
+    decompressed_size = columnar_size;
+    if (compression_type != CompressionTypePB::NONE) {
+      decompressed_data = columnar_pool.TryAllocate(columnar_size);
+      if (UNLIKELY(decompressed_data == nullptr)) {
+        return mem_tracker_->MemLimitExceeded(nullptr,
+            "Failed to allocate buffer to decompress columnar row batch", columnar_size);
+      }
+    }
+  }
+
+  if (compression_type != CompressionTypePB::NONE) {
     // Decompress tuple data into data pool
     const uint8_t* compressed_data = input_tuple_data.data();
     size_t compressed_size = input_tuple_data.size();
 
-    Lz4Decompressor decompressor(nullptr, false);
-    Status status = decompressor.Init();
-    DCHECK(status.ok()) << status.GetDetail();
+    scoped_ptr<Codec> decompressor;
+    if (compression_type == CompressionTypePB::ZSTD) {
+      decompressor.reset(new ZstandardDecompressor(nullptr, false));
+    } else {
+      DCHECK_EQ(compression_type, CompressionTypePB::LZ4);
+      decompressor.reset(new Lz4Decompressor(nullptr, false));
+    }
+    RETURN_IF_ERROR(decompressor->Init());
     auto compressor_cleanup =
-        MakeScopeExitTrigger([&decompressor]() { decompressor.Close(); });
-
-    status = decompressor.ProcessBlock(
-        true, compressed_size, compressed_data, &uncompressed_size, &tuple_data);
-    DCHECK_NE(uncompressed_size, -1) << "RowBatch decompression failed";
-    DCHECK(status.ok()) << "RowBatch decompression failed.";
+        MakeScopeExitTrigger([&decompressor]() { decompressor->Close(); });
+
+    const int64_t expected_size = decompressed_size;
+    RETURN_IF_ERROR(decompressor->ProcessBlock(true, compressed_size, compressed_data,
+        &decompressed_size, &decompressed_data));
+    if (UNLIKELY(decompressed_size != expected_size)) {
+      return Status(Substitute("RowBatch decompression produced $0 bytes, expected $1",
+          decompressed_size, expected_size));
+    }
+    if (columnar) {
+      RETURN_IF_ERROR(ColumnarTupleData::Decode(*row_desc_, tuple_offsets, num_tuples,
+          decompressed_data, decompressed_size, tuple_data, uncompressed_size));
+    }
+  } else if (columnar) {
+    DCHECK_EQ(columnar_size, input_tuple_data.size());
+    RETURN_IF_ERROR(ColumnarTupleData::Decode(*row_desc_, tuple_offsets, num_tuples,
+        input_tuple_data.data(), input_tuple_data.size(), tuple_data,
+        uncompressed_size));
   } else {
     // Tuple data uncompressed, copy directly into data pool
     DCHECK_EQ(uncompressed_size, input_tuple_data.size());
@@ -148,10 +210,6 @@ void RowBatch::Deserialize(const kudu::Slice& input_tuple_offsets,
   }
 
   // Convert input_batch.tuple_offsets into pointers
-  const int32_t* tuple_offsets =
-      reinterpret_cast<const int32_t*>(input_tuple_offsets.data());
-  DCHECK_EQ(input_tuple_offsets.size() % sizeof(int32_t), 0);
-  int num_tuples = input_tuple_offsets.size() / sizeof(int32_t);
   for (int tuple_idx = 0; tuple_idx < num_tuples; ++tuple_idx) {
     int32_t offset = tuple_offsets[tuple_idx];
     if (offset == -1) {
@@ -162,7 +220,7 @@ void RowBatch::Deserialize(const kudu::Slice& input_tuple_offsets,
   }
 
   // Check whether we have slots that require offset-to-pointer conversion.
-  if (!row_desc_->HasVarlenSlots()) return;
+  if (!row_desc_->HasVarlenSlots()) return Status::OK();
 
   // For every unique tuple, convert string offsets contained in tuple data into
   // pointers. Tuples were serialized in the order we are deserializing them in,
@@ -180,6 +238,7 @@ void RowBatch::Deserialize(const kudu::Slice& input_tuple_offsets,
       tuple->ConvertOffsetsToPointers(*desc, tuple_data);
     }
   }
+  return Status::OK();
 }
 
 Status RowBatch::FromProtobuf(const RowDescriptor* row_desc,
@@ -207,10 +266,12 @@ Status RowBatch::FromProtobuf(const RowDescriptor* row_desc,
   row_batch->capacity_ = header.num_rows();
   const CompressionTypePB& compression_type = header.compression_type();
   DCHECK(compression_type == CompressionTypePB::NONE ||
-      compression_type == CompressionTypePB::LZ4)
+      compression_type == CompressionTypePB::LZ4 ||
+      compression_type == CompressionTypePB::ZSTD)
       << "Unexpected compression type: " << compression_type;
-  row_batch->Deserialize(input_tuple_offsets, input_tuple_data, uncompressed_size,
-      compression_type == CompressionTypePB::LZ4, tuple_data);
+  const int64_t columnar_size = header.has_columnar_size() ? header.columnar_size() : -1;
+  RETURN_IF_ERROR(row_batch->Deserialize(input_tuple_offsets, input_tuple_data,
+      uncompressed_size, columnar_size, compression_type, tuple_data));
   *row_batch_ptr = std::move(row_batch);
   return Status::OK();
 }
@@ -227,37 +288,47 @@ RowBatch::~RowBatch() {
     mem_tracker_->Release(tuple_ptrs_size_);
   }
   tuple_ptrs_ = nullptr;
+  if (selection_ != nullptr) mem_tracker_->Release(SelectionBufferSize());
 }
 
 Status RowBatch::Serialize(TRowBatch* output_batch) {
   return Serialize(output_batch, UseFullDedup());
 }
 
-Status RowBatch::Serialize(TRowBatch* output_batch, bool full_dedup) {
+Status RowBatch::Serialize(TRowBatch* output_batch, bool full_dedup,
+    CompressionTypePB codec, int compression_level, bool columnar) {
   // why does Thrift not generate a Clear() function?
   output_batch->row_tuples.clear();
   output_batch->tuple_offsets.clear();
+  output_batch->__isset.columnar_size = false;
   int64_t uncompressed_size;
-  bool is_compressed;
-  RETURN_IF_ERROR(Serialize(full_dedup, &output_batch->tuple_offsets,
-      &output_batch->tuple_data, &uncompressed_size, &is_compressed));
+  int64_t columnar_size;
+  CompressionTypePB compression_type;
+  RETURN_IF_ERROR(Serialize(full_dedup, codec, compression_level, columnar,
+      &output_batch->tuple_offsets, &output_batch->tuple_data, &uncompressed_size,
+      &columnar_size, &compression_type));
   // TODO: max_size() is much larger than the amount of memory we could feasibly
   // allocate. Need better way to detect problem.
   DCHECK_LE(uncompressed_size, output_batch->tuple_data.max_size());
   output_batch->__set_num_rows(num_rows_);
   output_batch->__set_uncompressed_size(uncompressed_size);
+  // CompressionTypePB corresponds to THdfsCompression.
   output_batch->__set_compression_type(
-      is_compressed ? THdfsCompression::LZ4 : THdfsCompression::NONE);
+      static_cast<THdfsCompression::type>(compression_type));
+  if (columnar_size >= 0) output_batch->__set_columnar_size(columnar_size);
   row_desc_->ToThrift(&output_batch->row_tuples);
   return Status::OK();
 }
 
-Status RowBatch::Serialize(OutboundRowBatch* output_batch) {
+Status RowBatch::Serialize(OutboundRowBatch* output_batch, CompressionTypePB codec,
+    int compression_level, bool columnar) {
   int64_t uncompressed_size;
-  bool is_compressed;
+  int64_t columnar_size;
+  CompressionTypePB compression_type;
   output_batch->tuple_offsets_.clear();
-  RETURN_IF_ERROR(Serialize(UseFullDedup(), &output_batch->tuple_offsets_,
-      &output_batch->tuple_data_, &uncompressed_size, &is_compressed));
+  RETURN_IF_ERROR(Serialize(UseFullDedup(), codec, compression_level, columnar,
+      &output_batch->tuple_offsets_, &output_batch->tuple_data_, &uncompressed_size,
+      &columnar_size, &compression_type));
 
   // Initialize the RowBatchHeaderPB
   RowBatchHeaderPB* header = &output_batch->header_;
@@ -265,13 +336,18 @@ Status RowBatch::Serialize(OutboundRowBatch* output_batch) {
   header->set_num_rows(num_rows_);
   header->set_num_tuples_per_row(row_desc_->tuple_descriptors().size());
   header->set_uncompressed_size(uncompressed_size);
-  header->set_compression_type(
-      is_compressed ? CompressionTypePB::LZ4 : CompressionTypePB::NONE);
+  header->set_compression_type(compression_type);
+  if (columnar_size >= 0) header->set_columnar_size(columnar_size);
   return Status::OK();
 }
 
-Status RowBatch::Serialize(bool full_dedup, vector<int32_t>* tuple_offsets,
-    string* tuple_data, int64_t* uncompressed_size, bool* is_compressed) {
+Status RowBatch::Serialize(bool full_dedup, CompressionTypePB codec,
+    int compression_level, bool columnar, vector<int32_t>* tuple_offsets,
+    string* tuple_data, int64_t* uncompressed_size, int64_t* columnar_size,
+    CompressionTypePB* compression_type) {
+  DCHECK(codec == CompressionTypePB::NONE || codec == CompressionTypePB::LZ4 ||
+      codec == CompressionTypePB::ZSTD) << "Unexpected compression type: " << codec;
+  DCHECK(!has_selection()) << "Selection must be compacted before serialization";
   // As part of the serialization process we deduplicate tuples to avoid serializing a
   // Tuple multiple times for the RowBatch. By default we only detect duplicate tuples
   // in adjacent rows only. If full deduplication is enabled, we will build a
@@ -290,38 +366,65 @@ Status RowBatch::Serialize(bool full_dedup, vector<int32_t>* tuple_offsets,
     RETURN_IF_ERROR(SerializeInternal(size, nullptr, tuple_offsets, tuple_data));
   }
   *uncompressed_size = size;
-  *is_compressed = false;
-
-  if (size > 0) {
-    // Try compressing tuple_data to compression_scratch_, swap if compressed data is
-    // smaller
-    Lz4Compressor compressor(nullptr, false);
-    RETURN_IF_ERROR(compressor.Init());
-    auto compressor_cleanup =
-        MakeScopeExitTrigger([&compressor]() { compressor.Close(); });
+  *columnar_size = -1;
+  if (columnar) {
+    RETURN_IF_ERROR(ColumnarTupleData::Encode(*row_desc_, tuple_offsets->data(),
+        tuple_offsets->size(), reinterpret_cast<const uint8_t*>(tuple_data->data()),
+        size, &columnar_scratch_));
+    tuple_data->swap(columnar_scratch_);
+    *columnar_size = tuple_data->size();
+  }
+  *compression_type = CompressionTypePB::NONE;
+  if (!tuple_data->empty() && codec != CompressionTypePB::NONE) {
+    RETURN_IF_ERROR(CompressTupleData(
+        codec, compression_level, tuple_data->size(), tuple_data, compression_type));
+  }
+  return Status::OK();
+}
 
-    // If the input size is too large for LZ4 to compress, MaxOutputLen() will return 0.
-    int64_t compressed_size = compressor.MaxOutputLen(size);
-    if (compressed_size == 0) {
+Status RowBatch::CompressTupleData(CompressionTypePB codec, int compression_level,
+    int64_t size, string* tuple_data, CompressionTypePB* compression_type) {
+  DCHECK_GT(size, 0);
+  // Try compressing tuple_data to compression_scratch_, swap if compressed data is
+  // smaller
+  scoped_ptr<Codec> compressor;
+  if (codec == CompressionTypePB::ZSTD) {
+    compressor.reset(new ZstandardCompressor(nullptr, false,
+        compression_level > 0 ? compression_level : ZSTD_CLEVEL_DEFAULT));
+  } else {
+    DCHECK_EQ(codec, CompressionTypePB::LZ4);
+    compressor.reset(new Lz4Compressor(nullptr, false));
+  }
+  RETURN_IF_ERROR(compressor->Init());
+  auto compressor_cleanup =
+      MakeScopeExitTrigger([&compressor]() { compressor->Close(); });
+
+  // If the input size is too large for the codec to compress, MaxOutputLen() will
+  // return 0.
+  int64_t compressed_size = compressor->MaxOutputLen(size);
+  if (compressed_size == 0) {
+    if (codec == CompressionTypePB::LZ4) {
       return Status(TErrorCode::LZ4_COMPRESSION_INPUT_TOO_LARGE, size);
     }
-    DCHECK_GT(compressed_size, 0);
-    if (compression_scratch_.size() < compressed_size) {
-      compression_scratch_.resize(compressed_size);
-    }
-    uint8_t* input =
-        const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(tuple_data->c_str()));
-    uint8_t* compressed_output = const_cast<uint8_t*>(
-        reinterpret_cast<const uint8_t*>(compression_scratch_.c_str()));
-    RETURN_IF_ERROR(
-        compressor.ProcessBlock(true, size, input, &compressed_size, &compressed_output));
-    if (LIKELY(compressed_size < size)) {
-      compression_scratch_.resize(compressed_size);
-      tuple_data->swap(compression_scratch_);
-      *is_compressed = true;
-    }
-    VLOG_ROW << "uncompressed size: " << size << ", compressed size: " << compressed_size;
+    return Status(TErrorCode::COMPRESSION_INPUT_TOO_LARGE,
+        CompressionTypePB_Name(codec), size);
   }
+  DCHECK_GT(compressed_size, 0);
+  if (compression_scratch_.size() < compressed_size) {
+    compression_scratch_.resize(compressed_size);
+  }
+  uint8_t* input =
+      const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(tuple_data->c_str()));
+  uint8_t* compressed_output = const_cast<uint8_t*>(
+      reinterpret_cast<const uint8_t*>(compression_scratch_.c_str()));
+  RETURN_IF_ERROR(
+      compressor->ProcessBlock(true, size, input, &compressed_size, &compressed_output));
+  if (LIKELY(compressed_size < size)) {
+    compression_scratch_.resize(compressed_size);
+    tuple_data->swap(compression_scratch_);
+    *compression_type = codec;
+  }
+  VLOG_ROW << "uncompressed size: " << size << ", compressed size: " << compressed_size;
   return Status::OK();
 }
 
@@ -431,6 +534,7 @@ void RowBatch::FreeBuffers() {
 
 void RowBatch::Reset() {
   num_rows_ = 0;
+  num_selected_ = -1;
   capacity_ = tuple_ptrs_size_ / (num_tuples_per_row_ * sizeof(Tuple*));
   tuple_data_pool_.FreeAll();
   FreeBuffers();
@@ -457,9 +561,42 @@ void RowBatch::TransferResourceOwnership(RowBatch* dest) {
 void RowBatch::SetMemTracker(MemTracker* new_tracker) {
   tuple_data_pool_.SetMemTracker(new_tracker);
   mem_tracker_->TransferTo(new_tracker, tuple_ptrs_size_);
+  if (selection_ != nullptr) mem_tracker_->TransferTo(new_tracker, SelectionBufferSize());
   mem_tracker_ = new_tracker;
 }
 
+Status RowBatch::GetSelectionBuffer(int** buffer) {
+  if (selection_ == nullptr) {
+    const int64_t buffer_size = SelectionBufferSize();
+    if (UNLIKELY(!mem_tracker_->TryConsume(buffer_size))) {
+      return mem_tracker_->MemLimitExceeded(
+          nullptr, "Failed to allocate selection vector for row batch", buffer_size);
+    }
+    selection_.reset(new int[InitialCapacity()]);
+  }
+  *buffer = selection_.get();
+  return Status::OK();
+}
+
+void RowBatch::SetSelection(int num_selected) {
+  DCHECK(selection_allowed_);
+  DCHECK(selection_ != nullptr);
+  DCHECK_GE(num_selected, 0);
+  DCHECK_LE(num_selected, num_rows_);
+  num_selected_ = num_selected;
+}
+
+void RowBatch::CompactSelection() {
+  if (!has_selection()) return;
+  for (int i = 0; i < num_selected_; ++i) {
+    DCHECK(i == 0 || selection_[i] > selection_[i - 1]);
+    // The selection vector is increasing, so rows are never moved to a later position.
+    if (selection_[i] != i) CopyRow(GetRow(selection_[i]), GetRow(i));
+  }
+  num_rows_ = num_selected_;
+  num_selected_ = -1;
+}
+
 int64_t RowBatch::GetDeserializedSize(const TRowBatch& batch) {
   return batch.uncompressed_size + batch.tuple_offsets.size() * sizeof(Tuple*);
 }
@@ -495,6 +632,8 @@ void RowBatch::AcquireState(RowBatch* src) {
   // The destination row batch should be empty.
   DCHECK(!needs_deep_copy_);
   DCHECK_EQ(num_rows_, 0);
+  DCHECK(!has_selection());
+  DCHECK(!src->has_selection());
   DCHECK_EQ(attached_buffer_bytes_, 0);
 
   num_rows_ = src->num_rows_;
@@ -507,6 +646,7 @@ void RowBatch::AcquireState(RowBatch* src) {
 
 void RowBatch::DeepCopyTo(RowBatch* dst) {
   DCHECK(dst->row_desc_->Equals(*row_desc_));
+  DCHECK(!has_selection());
   DCHECK_EQ(dst->num_rows_, 0);
   DCHECK_GE(dst->capacity_, num_rows_);
   dst->AddRows(num_rows_);
@@ -574,9 +714,9 @@ Status RowBatch::ResizeAndAllocateTupleBuffer(RuntimeState* state, MemPool* pool
 
 void RowBatch::VLogRows(const string& context) {
   if (!VLOG_ROW_IS_ON) return;
-  VLOG_ROW << context << ": #rows=" << num_rows_;
-  for (int i = 0; i < num_rows_; ++i) {
-    VLOG_ROW << PrintRow(GetRow(i), *row_desc_);
+  VLOG_ROW << context << ": #rows=" << num_active_rows();
+  for (int i = 0; i < num_active_rows(); ++i) {
+    VLOG_ROW << PrintRow(GetActiveRow(i), *row_desc_);
   }
 }
 
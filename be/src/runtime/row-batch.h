@@ -19,6 +19,7 @@
 #define IMPALA_RUNTIME_ROW_BATCH_H
 
 #include <cstring>
+#include <memory>
 #include <vector>
 #include <boost/scoped_ptr.hpp>
 
@@ -122,6 +123,15 @@ class OutboundRowBatch {
 ///
 /// A row batch is considered at capacity if all the rows are full or it has accumulated
 /// auxiliary memory up to a soft cap. (See at_capacity_mem_usage_ comment).
+///
+/// Selection vectors: a filtering operator can hand over a batch without compacting the
+/// rows that passed its predicates by attaching a selection vector, an increasing list
+/// of the indices of the active rows. The other rows are still present but must be
+/// ignored. Since most code assumes that all rows of a batch are active, an operator
+/// may only attach a selection vector if the consumer of the batch opted in with
+/// set_selection_allowed(). Selection-aware consumers iterate over the batch with
+/// FOREACH_ACTIVE_ROW or GetActiveRow() and use num_active_rows() instead of
+/// num_rows(), or call CompactSelection() to fall back to a dense batch.
 class RowBatch {
  public:
   /// Flag indicating whether the resources attached to a RowBatch need to be flushed.
@@ -137,13 +147,15 @@ class RowBatch {
   /// tracker cannot be NULL.
   RowBatch(const RowDescriptor* row_desc, int capacity, MemTracker* tracker);
 
-  /// Populate a row batch from a serialized thrift input_batch by copying
+  /// Creates a row batch from a serialized thrift input_batch by copying
   /// input_batch's tuple_data into the row batch's mempool and converting all
-  /// offsets in the data back into pointers.
+  /// offsets in the data back into pointers. The newly created row batch is stored in
+  /// 'row_batch_ptr'. Returns an error if the tuple data can't be allocated or if
+  /// input_batch is corrupt.
   /// TODO: figure out how to transfer the data from input_batch to this RowBatch
   /// (so that we don't need to make yet another copy)
-  RowBatch(const RowDescriptor* row_desc, const TRowBatch& input_batch,
-      MemTracker* tracker);
+  static Status FromThrift(const RowDescriptor* row_desc, const TRowBatch& input_batch,
+      MemTracker* tracker, std::unique_ptr<RowBatch>* row_batch_ptr) WARN_UNUSED_RESULT;
 
   /// Creates a row batch from the protobuf row batch header, decompress / copy
   /// 'input_tuple_data' into a buffer and convert all offsets in 'input_tuple_offsets'
@@ -211,6 +223,51 @@ class RowBatch {
     return reinterpret_cast<TupleRow*>(tuple_ptrs_ + row_idx * num_tuples_per_row_);
   }
 
+  /// Returns true if a selection vector may be attached to this batch. Set by the
+  /// consumer of the batch and preserved by Reset().
+  bool selection_allowed() const { return selection_allowed_; }
+  void set_selection_allowed(bool allowed) {
+    DCHECK(allowed || !has_selection());
+    selection_allowed_ = allowed;
+  }
+
+  /// Returns true if only the rows in the selection vector are active.
+  bool ALWAYS_INLINE has_selection() const { return num_selected_ >= 0; }
+
+  /// Returns the selection vector or nullptr if all rows are active.
+  const int* ALWAYS_INLINE selection() const {
+    return has_selection() ? selection_.get() : nullptr;
+  }
+
+  /// Returns the number of rows that are active: the number of rows in the selection
+  /// vector if there is one, otherwise num_rows().
+  int ALWAYS_INLINE num_active_rows() const {
+    return has_selection() ? num_selected_ : num_rows_;
+  }
+
+  /// Returns the 'idx'th active row.
+  TupleRow* ALWAYS_INLINE GetActiveRow(int idx) {
+    DCHECK_LT(idx, num_active_rows());
+    return GetRow(has_selection() ? selection_[idx] : idx);
+  }
+
+  /// Returns in 'buffer' a buffer with room for InitialCapacity() row indices, which the
+  /// caller fills before calling SetSelection(). The buffer is allocated on the first
+  /// call. Returns an error if that would exceed the memory limit.
+  Status GetSelectionBuffer(int** buffer) WARN_UNUSED_RESULT;
+
+  /// Makes the first 'num_selected' entries of the buffer returned by
+  /// GetSelectionBuffer() the selection vector of this batch. The entries must be
+  /// increasing indices of committed rows. Only valid if selection_allowed() is true.
+  void SetSelection(int num_selected);
+
+  /// Drops the selection vector, if any, which makes all rows active again.
+  void ClearSelection() { num_selected_ = -1; }
+
+  /// Moves the active rows to the front of the batch and drops the selection vector.
+  /// Afterwards num_rows() == num_active_rows(). No-op if there is no selection vector.
+  void CompactSelection();
+
   /// An iterator for going through a row batch, starting at 'row_idx'.
   /// If 'limit' is specified, it will iterate up to row number 'row_idx + limit'
   /// or the last row, whichever comes first. Otherwise, it will iterate till the last
@@ -268,6 +325,45 @@ class RowBatch {
     RowBatch* const parent_;
   };
 
+  /// An iterator for going through the active rows of a row batch, starting at the
+  /// 'idx'th active row and visiting at most 'limit' rows if 'limit' is not -1. It
+  /// visits the same rows as Iterator if the batch has no selection vector.
+  class ActiveRowIterator {
+   public:
+    ActiveRowIterator(RowBatch* parent, int idx, int limit = -1) :
+        num_tuples_per_row_(parent->num_tuples_per_row_),
+        tuple_ptrs_(parent->tuple_ptrs_),
+        selection_(parent->selection()),
+        idx_(idx),
+        end_(limit == -1 ? parent->num_active_rows() :
+                           std::min<int>(idx + limit, parent->num_active_rows())) {
+      DCHECK_GE(idx, 0);
+      DCHECK_GT(num_tuples_per_row_, 0);
+    }
+
+    TupleRow* IR_ALWAYS_INLINE Get() {
+      int row_idx = selection_ == nullptr ? idx_ : selection_[idx_];
+      return reinterpret_cast<TupleRow*>(tuple_ptrs_ + num_tuples_per_row_ * row_idx);
+    }
+
+    void IR_ALWAYS_INLINE Next() { ++idx_; }
+
+    bool IR_ALWAYS_INLINE AtEnd() { return idx_ >= end_; }
+
+   private:
+    const int num_tuples_per_row_;
+    Tuple** const tuple_ptrs_;
+
+    /// The selection vector of the batch or nullptr if all rows are active.
+    const int* const selection_;
+
+    /// Index of the current row among the active rows.
+    int idx_;
+
+    /// Index after the last active row to visit.
+    const int end_;
+  };
+
   int num_tuples_per_row() { return num_tuples_per_row_; }
   MemPool* tuple_data_pool() { return &tuple_data_pool_; }
   int num_buffers() const { return buffers_.size(); }
@@ -371,11 +467,16 @@ class RowBatch {
   /// Create a serialized version of this row batch in output_batch, attaching all of the
   /// data it references to output_batch.tuple_data. This function attempts to detect
   /// duplicate tuples in the row batch to reduce the serialized size.
-  /// output_batch.tuple_data will be LZ4-compressed unless the compressed data is larger
-  /// larger than the uncompressed data. Use output_batch.compression_type to determine
-  /// whether tuple_data is compressed. If an in-flight row is present in this row batch,
-  /// it is ignored. This function does not Reset().
-  Status Serialize(OutboundRowBatch* output_batch);
+  /// output_batch.tuple_data will be compressed with 'codec' unless the compressed data
+  /// is larger than the uncompressed data. 'codec' must be NONE, LZ4 or ZSTD.
+  /// 'compression_level' is only used for ZSTD, where 0 selects the default level. Use
+  /// output_batch.compression_type to determine whether tuple_data is compressed. If
+  /// 'columnar' is true, tuple_data is converted to the columnar layout of
+  /// ColumnarTupleData before compression. If an in-flight row is present in this row
+  /// batch, it is ignored. This function does not Reset().
+  Status Serialize(OutboundRowBatch* output_batch,
+      CompressionTypePB codec = CompressionTypePB::LZ4, int compression_level = 0,
+      bool columnar = false);
   Status Serialize(TRowBatch* output_batch);
 
   /// Utility function: returns total byte size of a batch in either serialized or
@@ -441,6 +542,11 @@ class RowBatch {
   RowBatch(const RowDescriptor* row_desc, const RowBatchHeaderPB& header,
       MemTracker* mem_tracker);
 
+  /// Creates a row batch with tuple pointers for the rows in the serialized thrift
+  /// 'input_batch'. Called from FromThrift() above before deserialization.
+  RowBatch(const RowDescriptor* row_desc, const TRowBatch& input_batch,
+      MemTracker* mem_tracker);
+
   /// Allocate from buffer pool a buffer of 'len' using the client handle 'client'.
   /// The actual buffer size is 'len' rounded up to power of 2 or minimum buffer size,
   /// whichever is larger. The reservation of 'client' may be increased. On success,
@@ -452,29 +558,50 @@ class RowBatch {
   /// Free all BufferInfo and the associated buffers in 'buffers_'.
   void FreeBuffers();
 
+  /// Size in bytes of 'selection_'.
+  int64_t SelectionBufferSize() const { return InitialCapacity() * sizeof(int); }
+
   /// Decide whether to do full tuple deduplication based on row composition. Full
   /// deduplication is enabled only when there is risk of the serialized size being
   /// much larger than in-memory size due to non-adjacent duplicate tuples.
   bool UseFullDedup();
 
-  /// Overload for testing that allows the test to force the deduplication level.
-  Status Serialize(TRowBatch* output_batch, bool full_dedup);
+  /// Overload for testing that allows the test to force the deduplication level, the
+  /// compression codec and the columnar layout.
+  Status Serialize(TRowBatch* output_batch, bool full_dedup,
+      CompressionTypePB codec = CompressionTypePB::LZ4, int compression_level = 0,
+      bool columnar = false);
 
   /// Shared implementation between thrift and protobuf to serialize this row batch.
   ///
   /// 'full_dedup': true if full deduplication is used.
+  /// 'codec': the codec to try on 'tuple_data'. One of NONE, LZ4 or ZSTD.
+  /// 'compression_level': the compression level for ZSTD. 0 selects the default level.
+  /// 'columnar': true if 'tuple_data' is converted to the columnar layout of
+  ///             ColumnarTupleData before compression.
   /// 'tuple_offsets': Updated to contain offsets of all tuples into 'tuple_data' upon
   ///                  return. There are a total of num_rows * num_tuples_per_row offsets.
   ///                  An offset of -1 records a NULL.
-  /// 'tuple_data': Updated to hold the serialized tuples' data. If 'is_compressed'
-  ///               is true, this is LZ4 compressed.
-  /// 'uncompressed_size': Updated with the uncompressed size of 'tuple_data'.
-  /// 'is_compressed': true if compression is applied on 'tuple_data'.
+  /// 'tuple_data': Updated to hold the serialized tuples' data. Compressed with
+  ///               'compression_type'.
+  /// 'uncompressed_size': Updated with the size of the row-major 'tuple_data'.
+  /// 'columnar_size': Updated with the size of the columnar 'tuple_data' before
+  ///                  compression, or -1 if 'columnar' is false.
+  /// 'compression_type': set to 'codec' if compression is applied on 'tuple_data' and
+  ///                     to NONE otherwise.
   ///
   /// Returns error status if serialization failed. Returns OK otherwise.
   /// TODO: clean this up once the thrift RPC implementation is removed.
-  Status Serialize(bool full_dedup, vector<int32_t>* tuple_offsets, string* tuple_data,
-      int64_t* uncompressed_size, bool* is_compressed);
+  Status Serialize(bool full_dedup, CompressionTypePB codec, int compression_level,
+      bool columnar, vector<int32_t>* tuple_offsets, string* tuple_data,
+      int64_t* uncompressed_size, int64_t* columnar_size,
+      CompressionTypePB* compression_type);
+
+  /// Compresses 'tuple_data' of 'size' bytes with 'codec' into 'compression_scratch_'
+  /// and swaps the two if the compressed data is smaller. Sets 'compression_type' to
+  /// 'codec' in that case and leaves it unchanged otherwise.
+  Status CompressTupleData(CompressionTypePB codec, int compression_level, int64_t size,
+      string* tuple_data, CompressionTypePB* compression_type);
 
   /// Shared implementation between thrift and protobuf to deserialize a row batch.
   ///
@@ -482,18 +609,23 @@ class RowBatch {
   /// Used for populating the tuples in the row batch with actual pointers.
   ///
   /// 'input_tuple_data': contains pointer and size of tuples' data buffer.
-  /// If 'is_compressed' is true, the data is compressed.
+  /// The data is compressed with 'compression_type'.
+  ///
+  /// 'uncompressed_size': the size of the row-major tuple data.
   ///
-  /// 'uncompressed_size': the uncompressed size of 'input_tuple_data' if it's compressed.
+  /// 'columnar_size': the size of the columnar 'input_tuple_data' after decompression,
+  /// or -1 if 'input_tuple_data' is in the row-major layout.
   ///
-  /// 'is_compressed': True if 'input_tuple_data' is compressed.
+  /// 'compression_type': the codec 'input_tuple_data' is compressed with. One of NONE,
+  /// LZ4 or ZSTD.
   ///
   /// 'tuple_data': buffer of 'uncompressed_size' bytes for holding tuple data.
   ///
+  /// Returns an error if the columnar tuple data is corrupt.
   /// TODO: clean this up once the thrift RPC implementation is removed.
-  void Deserialize(const kudu::Slice& input_tuple_offsets,
-      const kudu::Slice& input_tuple_data, int64_t uncompressed_size, bool is_compressed,
-      uint8_t* tuple_data);
+  Status Deserialize(const kudu::Slice& input_tuple_offsets,
+      const kudu::Slice& input_tuple_data, int64_t uncompressed_size,
+      int64_t columnar_size, CompressionTypePB compression_type, uint8_t* tuple_data);
 
   typedef FixedSizeHashTable<Tuple*, int> DedupMap;
 
@@ -572,6 +704,20 @@ class RowBatch {
   /// assuming all row batches are roughly the same size, all strings will eventually be
   /// allocated to the right size.
   std::string compression_scratch_;
+
+  /// String to write the columnar tuple data to in Serialize(). Swapped with the
+  /// row-major tuple data for the same reasons as 'compression_scratch_'.
+  std::string columnar_scratch_;
+
+  /// True if the consumer of this batch accepts a selection vector.
+  bool selection_allowed_ = false;
+
+  /// Number of entries in the selection vector or -1 if there is no selection vector.
+  int num_selected_ = -1;
+
+  /// Buffer for the selection vector with InitialCapacity() entries. Allocated on the
+  /// first call to GetSelectionBuffer() and reused across Reset().
+  std::unique_ptr<int[]> selection_;
 };
 }
 
@@ -588,4 +734,14 @@ class RowBatch {
     for (RowBatch::Iterator _iter(_row_batch, _start_row_idx, _limit);  \
          !_iter.AtEnd(); _iter.Next())
 
+/// Same as above, but only visits the active rows of '_row_batch'. '_start_idx' is the
+/// index of the first row to visit among the active rows.
+#define FOREACH_ACTIVE_ROW(_row_batch, _start_idx, _iter)                    \
+    for (RowBatch::ActiveRowIterator _iter(_row_batch, _start_idx);          \
+         !_iter.AtEnd(); _iter.Next())
+
+#define FOREACH_ACTIVE_ROW_LIMIT(_row_batch, _start_idx, _limit, _iter)      \
+    for (RowBatch::ActiveRowIterator _iter(_row_batch, _start_idx, _limit);  \
+         !_iter.AtEnd(); _iter.Next())
+
 #endif
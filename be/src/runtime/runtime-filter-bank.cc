@@ -38,6 +38,7 @@
 #include "service/data-stream-service.h"
 #include "service/impala-server.h"
 #include "util/bit-util.h"
+#include "util/bitmap-filter.h"
 #include "util/bloom-filter.h"
 #include "util/debug-util.h"
 #include "util/min-max-filter.h"
@@ -59,6 +60,17 @@ DEFINE_double(max_filter_error_rate, 0.75, "(Advanced) The target false positive
 const int64_t RuntimeFilterBank::MIN_BLOOM_FILTER_SIZE;
 const int64_t RuntimeFilterBank::MAX_BLOOM_FILTER_SIZE;
 
+int RuntimeFilterBank::MinBloomFilterLogSpace(
+    const TQueryOptions& query_options, int64_t ndv) {
+  double fpp = query_options.__isset.runtime_filter_error_rate ?
+      query_options.runtime_filter_error_rate :
+      FLAGS_max_filter_error_rate;
+  int64_t min_size = max<int64_t>(query_options.runtime_filter_min_size,
+      ExecEnv::GetInstance()->buffer_pool()->min_buffer_len());
+  return max(BloomFilter::MinLogSpace(max<int64_t>(ndv, 1), fpp),
+      BitUtil::Log2Ceiling64(min_size));
+}
+
 RuntimeFilterBank::RuntimeFilterBank(QueryState* query_state,
     const unordered_map<int32_t, FilterRegistration>& filters,
     long total_filter_mem_required)
@@ -161,7 +173,8 @@ void RuntimeFilterBank::UpdateFilterCompleteCb(
 
 void RuntimeFilterBank::UpdateFilterFromLocal(
     int32_t filter_id, BloomFilter* bloom_filter, MinMaxFilter* min_max_filter,
-    InListFilter* in_list_filter) {
+    InListFilter* in_list_filter, BitmapFilter* bitmap_filter,
+    int64_t bloom_ndv_upper_bound) {
   DCHECK_NE(query_state_->query_options().runtime_filter_mode, TRuntimeFilterMode::OFF)
       << "Should not be calling UpdateFilterFromLocal() if filtering is disabled";
   // This function is only called from ExecNode::Open() or more specifically
@@ -171,6 +184,8 @@ void RuntimeFilterBank::UpdateFilterFromLocal(
   bool has_local_target = false;
   bool has_remote_target = false;
   RuntimeFilter* complete_filter = nullptr; // Set if the filter should be sent out.
+  // Set for partitioned join filters that should be sent out.
+  int64_t total_bloom_ndv_upper_bound = -1;
   auto it = filters_.find(filter_id);
   DCHECK(it != filters_.end()) << "Tried to update unregistered filter: " << filter_id;
   PerFilterState* fs = it->second.get();
@@ -190,17 +205,19 @@ void RuntimeFilterBank::UpdateFilterFromLocal(
         return;
       }
       VLOG(3) << "Setting broadcast filter " << filter_id;
-      result_filter->SetFilter(bloom_filter, min_max_filter, in_list_filter);
+      result_filter->SetFilter(
+          bloom_filter, min_max_filter, in_list_filter, bitmap_filter);
       complete_filter = result_filter;
     } else {
       DCHECK(in_list_filter == nullptr)
           << "InListFilter should only be generated for broadcast joins";
+      produced_filter.bloom_ndv_upper_bound += bloom_ndv_upper_bound;
       // Merge partitioned join filters in parallel - each thread setting the filter will
       // try to merge its filter with a previously merged filter, looping until either
       // it has produced the final filter or it runs out of other filters to merge.
       unique_ptr<RuntimeFilter> tmp_filter = make_unique<RuntimeFilter>(
           result_filter->filter_desc(), result_filter->filter_size());
-      tmp_filter->SetFilter(bloom_filter, min_max_filter, nullptr);
+      tmp_filter->SetFilter(bloom_filter, min_max_filter, nullptr, bitmap_filter);
       while (produced_filter.pending_merge_filter != nullptr) {
         unique_ptr<RuntimeFilter> pending_merge =
             std::move(produced_filter.pending_merge_filter);
@@ -221,6 +238,7 @@ void RuntimeFilterBank::UpdateFilterFromLocal(
         // Everything was merged into 'tmp_filter'. It is therefore the result filter.
         result_filter->SetFilter(tmp_filter.get());
         complete_filter = result_filter;
+        total_bloom_ndv_upper_bound = produced_filter.bloom_ndv_upper_bound;
         VLOG(3) << "Partitioned join filter " << filter_id << " is locally complete.";
       }
     }
@@ -277,11 +295,16 @@ void RuntimeFilterBank::UpdateFilterFromLocal(
     TRuntimeFilterType::type type = complete_filter->filter_desc().type;
     if (type == TRuntimeFilterType::BLOOM) {
       BloomFilter::ToProtobuf(bloom_filter, controller, params.mutable_bloom_filter());
+      if (total_bloom_ndv_upper_bound >= 0) {
+        params.set_bloom_filter_ndv_upper_bound(total_bloom_ndv_upper_bound);
+      }
     } else if (type == TRuntimeFilterType::MIN_MAX) {
       min_max_filter->ToProtobuf(params.mutable_min_max_filter());
-    } else {
-      DCHECK_EQ(type, TRuntimeFilterType::IN_LIST);
+    } else if (type == TRuntimeFilterType::IN_LIST) {
       InListFilter::ToProtobuf(in_list_filter, params.mutable_in_list_filter());
+    } else {
+      DCHECK_EQ(type, TRuntimeFilterType::BITMAP);
+      BitmapFilter::ToProtobuf(bitmap_filter, params.mutable_bitmap_filter());
     }
     const NetworkAddressPB& krpc_address =
         FromTNetworkAddress(query_state_->query_ctx().coord_ip_address);
@@ -330,6 +353,7 @@ void RuntimeFilterBank::PublishGlobalFilter(
   BloomFilter* bloom_filter = nullptr;
   MinMaxFilter* min_max_filter = nullptr;
   InListFilter* in_list_filter = nullptr;
+  BitmapFilter* bitmap_filter = nullptr;
   string details;
   if (fs->consumed_filter->is_bloom_filter()) {
     DCHECK(params.has_bloom_filter());
@@ -367,6 +391,9 @@ void RuntimeFilterBank::PublishGlobalFilter(
           fs->bloom_filters.push_back(bloom_filter);
           DCHECK_EQ(required_space, bloom_filter->GetBufferPoolSpaceUsed());
           bloom_memory_allocated_->Add(bloom_filter->GetBufferPoolSpaceUsed());
+          // The producers or the coordinator may have shrunk the filter.
+          details = Substitute(" of $0",
+              PrettyPrinter::Print(bloom_filter->GetBufferPoolSpaceUsed(), TUnit::BYTES));
         }
       }
     }
@@ -375,6 +402,11 @@ void RuntimeFilterBank::PublishGlobalFilter(
     min_max_filter = MinMaxFilter::Create(params.min_max_filter(),
         fs->consumed_filter->type(), &obj_pool_, filter_mem_tracker_);
     fs->min_max_filters.push_back(min_max_filter);
+  } else if (fs->consumed_filter->is_bitmap_filter()) {
+    DCHECK(params.has_bitmap_filter());
+    bitmap_filter = BitmapFilter::Create(params.bitmap_filter(),
+        fs->consumed_filter->filter_size(), &obj_pool_, filter_mem_tracker_);
+    fs->bitmap_filters.push_back(bitmap_filter);
   } else {
     DCHECK(fs->consumed_filter->is_in_list_filter());
     DCHECK(params.has_in_list_filter());
@@ -386,7 +418,8 @@ void RuntimeFilterBank::PublishGlobalFilter(
     total_in_list_filter_items_->Add(params.in_list_filter().value_size());
     details = Substitute(" with $0 items", params.in_list_filter().value_size());
   }
-  fs->consumed_filter->SetFilter(bloom_filter, min_max_filter, in_list_filter);
+  fs->consumed_filter->SetFilter(
+      bloom_filter, min_max_filter, in_list_filter, bitmap_filter);
   query_state_->host_profile()->AddInfoString(
       Substitute("Filter $0 arrival$1", params.filter_id(), details),
       PrettyPrinter::Print(fs->consumed_filter->arrival_delay_ms(), TUnit::TIME_MS));
@@ -448,6 +481,20 @@ InListFilter* RuntimeFilterBank::AllocateScratchInListFilter(
   return in_list_filter;
 }
 
+BitmapFilter* RuntimeFilterBank::AllocateScratchBitmapFilter(int32_t filter_id) {
+  auto it = filters_.find(filter_id);
+  DCHECK(it != filters_.end()) << "Filter ID " << filter_id << " not registered";
+  PerFilterState* fs = it->second.get();
+  lock_guard<SpinLock> l(fs->lock);
+  if (closed_) return nullptr;
+
+  // The bitmap is allocated on demand as values are inserted, up to the filter size.
+  BitmapFilter* bitmap_filter = obj_pool_.Add(new BitmapFilter(
+      fs->produced_filter.result_filter->filter_size(), filter_mem_tracker_));
+  fs->bitmap_filters.push_back(bitmap_filter);
+  return bitmap_filter;
+}
+
 vector<unique_lock<SpinLock>> RuntimeFilterBank::LockAllFilters() {
   vector<unique_lock<SpinLock>> locks;
   for (auto& entry : filters_) locks.emplace_back(entry.second->lock);
@@ -491,6 +538,7 @@ void RuntimeFilterBank::Close() {
     for (BloomFilter* filter : entry.second->bloom_filters) filter->Close();
     for (MinMaxFilter* filter : entry.second->min_max_filters) filter->Close();
     for (InListFilter* filter : entry.second->in_list_filters) filter->Close();
+    for (BitmapFilter* filter : entry.second->bitmap_filters) filter->Close();
   }
   obj_pool_.Clear();
   if (buffer_pool_client_.is_registered()) {
@@ -47,11 +47,13 @@ class BloomFilter;
 class MemTracker;
 class MinMaxFilter;
 class InListFilter;
+class BitmapFilter;
 class RuntimeFilter;
 class QueryState;
 class TBloomFilter;
 class TRuntimeFilterDesc;
 class TQueryCtx;
+class TQueryOptions;
 
 /// Metadata about each filter required to initialize the RuntimeFilterBank for a query
 /// running on a backend.
@@ -119,13 +121,16 @@ class RuntimeFilterBank {
   /// to check for the filter's arrival.
   RuntimeFilter* RegisterConsumer(const TRuntimeFilterDesc& filter_desc);
 
-  /// Updates a filter's 'bloom_filter', 'min_max_filter' or 'in_list_filter' which has
-  /// been produced by some operator in a local fragment instance. At most one of
-  /// 'bloom_filter', 'min_max_filter' and 'in_list_filter' may be non-NULL, depending on
-  /// the filter's type. They may both be NULL, representing a filter that allows all rows
-  /// to pass.
+  /// Updates a filter's 'bloom_filter', 'min_max_filter', 'in_list_filter' or
+  /// 'bitmap_filter' which has been produced by some operator in a local fragment
+  /// instance. At most one of them may be non-NULL, depending on the filter's type. They
+  /// may all be NULL, representing a filter that allows all rows to pass.
+  /// 'bloom_ndv_upper_bound' is an upper bound on the number of distinct values inserted
+  /// into 'bloom_filter'. For partitioned joins, the bounds of all producers are summed
+  /// and sent to the coordinator with the aggregated filter.
   void UpdateFilterFromLocal(int32_t filter_id, BloomFilter* bloom_filter,
-      MinMaxFilter* min_max_filter, InListFilter* in_list_filter);
+      MinMaxFilter* min_max_filter, InListFilter* in_list_filter,
+      BitmapFilter* bitmap_filter, int64_t bloom_ndv_upper_bound);
 
   /// Makes a bloom_filter (aggregated globally from all producer fragments) available for
   /// consumption by operators that wish to use it for filtering.
@@ -147,6 +152,9 @@ class RuntimeFilterBank {
   /// Returns a new InListFilter. Handles memory the same as AllocateScratchBloomFilter().
   InListFilter* AllocateScratchInListFilter(int32_t filter_id, ColumnType type);
 
+  /// Returns a new BitmapFilter. Handles memory the same as AllocateScratchBloomFilter().
+  BitmapFilter* AllocateScratchBitmapFilter(int32_t filter_id);
+
   /// Default hash seed to use when computing hashed values to insert into filters.
   static int32_t IR_ALWAYS_INLINE DefaultHashSeed() { return 1234; }
 
@@ -160,6 +168,11 @@ class RuntimeFilterBank {
   static const int64_t MIN_BLOOM_FILTER_SIZE = 4 * 1024;           // 4KB
   static const int64_t MAX_BLOOM_FILTER_SIZE = 512 * 1024 * 1024; // 512MB
 
+  /// Returns the log2 of the size in bytes of the smallest bloom filter that achieves the
+  /// target false positive rate of 'query_options' for 'ndv' distinct values, but is not
+  /// smaller than the minimum filter size. The planner uses the same rate and minimum.
+  static int MinBloomFilterLogSpace(const TQueryOptions& query_options, int64_t ndv);
+
  private:
   struct PerFilterState;
 
@@ -189,6 +202,10 @@ class RuntimeFilterBank {
     // UpdateFilterFromLocal() for details on the algorithm for merging.
     // Only used for partitioned join filters.
     std::unique_ptr<RuntimeFilter> pending_merge_filter;
+
+    // Sum of the 'bloom_ndv_upper_bound' passed to UpdateFilterFromLocal() so far. Only
+    // used for partitioned join filters.
+    int64_t bloom_ndv_upper_bound = 0;
   };
 
   /// All state tracked for a particular filter in this filter bank. PerFilterStates are
@@ -230,6 +247,10 @@ class RuntimeFilterBank {
     /// Contains references to all the in-list filters generated. Used in Close() to
     /// safely release all memory allocated for InListFilters.
     vector<InListFilter*> in_list_filters;
+
+    /// Contains references to all the bitmap filters generated. Used in Close() to
+    /// safely release all memory allocated for BitmapFilters.
+    vector<BitmapFilter*> bitmap_filters;
   } CACHELINE_ALIGNED;
 
   /// Object pool for objects that will be freed in Close(), e.g. allocated filters.
@@ -44,6 +44,12 @@ bool IR_ALWAYS_INLINE RuntimeFilter::Eval(
         return filter->Find(val, col_type);
       }
     }
+    case TRuntimeFilterType::BITMAP: {
+      BitmapFilter* filter = get_bitmap_filter();
+      if (LIKELY(filter && !filter->AlwaysTrue())) {
+        return filter->Find(val, col_type);
+      }
+    }
   }
   return true;
 }
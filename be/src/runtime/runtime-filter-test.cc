@@ -93,7 +93,7 @@ TEST_F(RuntimeFilterTest, Arrived) {
   SleepForMs(100); // give waiting thread a head start
   workers.add_thread(
       new thread([&tc] {
-        tc.runtime_filter->SetFilter(nullptr, tc.min_max_filter, nullptr);
+        tc.runtime_filter->SetFilter(nullptr, tc.min_max_filter, nullptr, nullptr);
       }));
   workers.join_all();
   sw.Stop();
@@ -22,6 +22,7 @@
 #include "gen-cpp/ExternalDataSource_types.h"
 #include "runtime/raw-value.h"
 #include "runtime/runtime-filter-bank.h"
+#include "util/bitmap-filter.h"
 #include "util/bloom-filter.h"
 #include "util/in-list-filter.h"
 #include "util/condition-variable.h"
@@ -41,13 +42,14 @@ class RuntimeFilterTest;
 /// early on in the plan tree (e.g. the scan that feeds the probe side of that join node
 /// could eliminate rows from consideration for join matching).
 ///
-/// A RuntimeFilter may compute its set-membership predicate as a bloom filters or a
-/// min-max filter, depending on its filter description.
+/// A RuntimeFilter may compute its set-membership predicate as a bloom filter, a min-max
+/// filter, an in-list filter or a bitmap filter, depending on its filter description.
 class RuntimeFilter {
  public:
   RuntimeFilter(const TRuntimeFilterDesc& filter, int64_t filter_size)
       : bloom_filter_(nullptr), min_max_filter_(nullptr), in_list_filter_(nullptr),
-        filter_desc_(filter), registration_time_(MonotonicMillis()), arrival_time_(0L),
+        bitmap_filter_(nullptr), filter_desc_(filter),
+        registration_time_(MonotonicMillis()), arrival_time_(0L),
         filter_size_(filter_size) {
     DCHECK(filter_desc_.type == TRuntimeFilterType::MIN_MAX || filter_size_ > 0);
   }
@@ -68,6 +70,9 @@ class RuntimeFilter {
   bool is_in_list_filter() const {
     return filter_desc().type == TRuntimeFilterType::IN_LIST;
   }
+  bool is_bitmap_filter() const {
+    return filter_desc().type == TRuntimeFilterType::BITMAP;
+  }
 
   extdatasource::TComparisonOp::type getCompareOp() const {
     return filter_desc().compareOp;
@@ -76,12 +81,13 @@ class RuntimeFilter {
   BloomFilter* get_bloom_filter() const { return bloom_filter_.Load(); }
   MinMaxFilter* get_min_max() const { return min_max_filter_.Load(); }
   InListFilter* get_in_list_filter() const { return in_list_filter_.Load(); }
+  BitmapFilter* get_bitmap_filter() const { return bitmap_filter_.Load(); }
 
-  /// Sets the internal filter to 'bloom_filter', 'min_max_filter' or 'in_list_filter'
-  /// depending on the type of this RuntimeFilter. Can only legally be called
-  /// once per filter. Does not acquire the memory associated with 'bloom_filter'.
+  /// Sets the internal filter to 'bloom_filter', 'min_max_filter', 'in_list_filter' or
+  /// 'bitmap_filter' depending on the type of this RuntimeFilter. Can only legally be
+  /// called once per filter. Does not acquire the memory associated with 'bloom_filter'.
   void SetFilter(BloomFilter* bloom_filter, MinMaxFilter* min_max_filter,
-      InListFilter* in_list_filter);
+      InListFilter* in_list_filter, BitmapFilter* bitmap_filter);
 
   /// Set the internal bloom or min-max filter to the equivalent filter from 'other'.
   /// The parameters of 'other' must be compatible and the filters must have the same
@@ -89,8 +95,8 @@ class RuntimeFilter {
   /// the other filter.
   void SetFilter(RuntimeFilter* other);
 
-  /// Merge 'bloom_filter' or 'min_max_filter' into this filter. The caller must provide
-  /// the appropriate kind of filter for this RuntimeFilter instance.
+  /// Merge the bloom, min-max or bitmap filter of 'other' into this filter. The caller
+  /// must provide the appropriate kind of filter for this RuntimeFilter instance.
   /// Not thread-safe.
   void Or(RuntimeFilter* other);
 
@@ -154,6 +160,9 @@ class RuntimeFilter {
   /// May be NULL even after arrival_time_ is set if filter_desc_.in_list_filter is false.
   AtomicPtr<InListFilter> in_list_filter_;
 
+  /// May be NULL even after arrival_time_ is set if filter_desc_.type is not BITMAP.
+  AtomicPtr<BitmapFilter> bitmap_filter_;
+
   /// Reference to the filter's thrift descriptor in the thrift Plan tree.
   const TRuntimeFilterDesc& filter_desc_;
 
@@ -36,6 +36,8 @@ inline bool RuntimeFilter::AlwaysTrue() const {
       return HasFilter() && min_max_filter_.Load()->AlwaysTrue();
     case TRuntimeFilterType::IN_LIST:
       return HasFilter() && in_list_filter_.Load()->AlwaysTrue();
+    case TRuntimeFilterType::BITMAP:
+      return HasFilter() && bitmap_filter_.Load()->AlwaysTrue();
   }
   return false;
 }
@@ -49,6 +51,8 @@ inline bool RuntimeFilter::AlwaysFalse() const {
       return min_max_filter_.Load() != nullptr && min_max_filter_.Load()->AlwaysFalse();
     case TRuntimeFilterType::IN_LIST:
       return in_list_filter_.Load() != nullptr && in_list_filter_.Load()->AlwaysFalse();
+    case TRuntimeFilterType::BITMAP:
+      return bitmap_filter_.Load() != nullptr && bitmap_filter_.Load()->AlwaysFalse();
   }
   return false;
 }
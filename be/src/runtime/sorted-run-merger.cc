@@ -17,6 +17,7 @@
 #include "runtime/row-batch.h"
 #include "runtime/sorter.h"
 #include "runtime/tuple-row.h"
+#include "util/normalized-key.h"
 #include "util/runtime-profile-counters.h"
 #include "util/tuple-row-compare.h"
 
@@ -59,6 +60,7 @@ class SortedRunMerger::SortedRunWrapper {
     ++input_row_batch_index_;
     if (input_row_batch_index_ < input_row_batch_->num_rows()) {
       *eos = false;
+      UpdateKey();
       return Status::OK();
     }
 
@@ -80,6 +82,7 @@ class SortedRunMerger::SortedRunWrapper {
 
     *eos = input_row_batch_ == NULL;
     input_row_batch_index_ = 0;
+    if (!*eos) UpdateKey();
     return Status::OK();
   }
 
@@ -87,9 +90,19 @@ class SortedRunMerger::SortedRunWrapper {
     return input_row_batch_->GetRow(input_row_batch_index_);
   }
 
+  const NormalizedKeyEncoder::Key& current_key() const { return current_key_; }
+
  private:
   friend class SortedRunMerger;
 
+  /// Computes the normalized key of the current row if the merger uses normalized keys.
+  void UpdateKey() {
+    const NormalizedKeyEncoder* key_encoder = parent_->key_encoder_;
+    if (key_encoder == nullptr) return;
+    key_encoder->Encode(parent_->comparator_.ordering_expr_evals().data(),
+        current_row(), &current_key_);
+  }
+
   /// The run from which this object supplies rows.
   RunBatchSupplierFn sorted_run_;
 
@@ -101,17 +114,28 @@ class SortedRunMerger::SortedRunWrapper {
 
   /// The parent merger instance.
   SortedRunMerger* parent_;
+
+  /// The normalized key of the current row. Only valid if the parent has a key encoder.
+  NormalizedKeyEncoder::Key current_key_;
 };
 
+bool SortedRunMerger::Less(
+    const SortedRunWrapper* lhs, const SortedRunWrapper* rhs) const {
+  if (key_encoder_ != nullptr) {
+    int result = lhs->current_key().Compare(rhs->current_key());
+    if (result != 0 || key_encoder_->is_complete()) return result < 0;
+  }
+  return comparator_.Less(lhs->current_row(), rhs->current_row());
+}
+
 void SortedRunMerger::Heapify(int parent_index) {
   int left_index = 2 * parent_index + 1;
   int right_index = left_index + 1;
   if (left_index >= min_heap_.size()) return;
   int least_child;
   // Find the least child of parent.
-  if (right_index >= min_heap_.size() ||
-      comparator_.Less(
-          min_heap_[left_index]->current_row(), min_heap_[right_index]->current_row())) {
+  if (right_index >= min_heap_.size()
+      || Less(min_heap_[left_index], min_heap_[right_index])) {
     least_child = left_index;
   } else {
     least_child = right_index;
@@ -119,16 +143,17 @@ void SortedRunMerger::Heapify(int parent_index) {
 
   // If the parent is out of place, swap it with the least child and invoke
   // Heapify recursively.
-  if (comparator_.Less(min_heap_[least_child]->current_row(),
-          min_heap_[parent_index]->current_row())) {
+  if (Less(min_heap_[least_child], min_heap_[parent_index])) {
     iter_swap(min_heap_.begin() + least_child, min_heap_.begin() + parent_index);
     Heapify(least_child);
   }
 }
 
 SortedRunMerger::SortedRunMerger(const TupleRowComparator& comparator,
-    const RowDescriptor* row_desc, RuntimeProfile* profile, bool deep_copy_input)
+    const RowDescriptor* row_desc, RuntimeProfile* profile, bool deep_copy_input,
+    const NormalizedKeyEncoder* key_encoder)
   : comparator_(comparator),
+    key_encoder_(key_encoder),
     input_row_desc_(row_desc),
     deep_copy_input_(deep_copy_input) {
   get_next_timer_ = ADD_TIMER(profile, "MergeGetNext");
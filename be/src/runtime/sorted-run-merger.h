@@ -25,6 +25,7 @@
 
 namespace impala {
 
+class NormalizedKeyEncoder;
 class RowBatch;
 class RowDescriptor;
 class TupleRowComparator;
@@ -46,6 +47,10 @@ class TupleRowComparator;
 /// set. This is because AdvanceMinRow() gets the next batch before freeing resources
 /// from the previous batch.
 /// TODO: it would be nice to fix this to avoid unnecessary copies.
+///
+/// If a NormalizedKeyEncoder is provided, the normalized key of the current row of each
+/// run is computed once when the run advances, and rows are ordered by their keys. The
+/// comparator is only used for rows with equal keys if the keys are incomplete.
 class SortedRunMerger {
  public:
   /// Function that returns the next batch of rows from an input sorted run. The batch
@@ -54,8 +59,11 @@ class SortedRunMerger {
   /// zero).
   typedef boost::function<Status (RowBatch**)> RunBatchSupplierFn;
 
+  /// 'key_encoder' must have been created from the same config as 'comparator' if it is
+  /// non-NULL.
   SortedRunMerger(const TupleRowComparator& comparator, const RowDescriptor* row_desc,
-      RuntimeProfile* profile, bool deep_copy_input);
+      RuntimeProfile* profile, bool deep_copy_input,
+      const NormalizedKeyEncoder* key_encoder = nullptr);
 
   /// Prepare this merger to merge and return rows from the sorted runs in 'input_runs'.
   /// Retrieves the first batch from each run and sets up the binary heap implementing
@@ -81,6 +89,9 @@ class SortedRunMerger {
   /// restore the heap property (i.e. swap elements so parent <= children).
   void Heapify(int parent_index);
 
+  /// Returns true if the current row of 'lhs' is less than the current row of 'rhs'.
+  bool Less(const SortedRunWrapper* lhs, const SortedRunWrapper* rhs) const;
+
   /// The binary min-heap used to merge rows from the sorted input runs. Since the heap is
   /// stored in a 0-indexed array, the 0-th element is the minimum element in the heap,
   /// and the children of the element at index i are 2*i+1 and 2*i+2. The heap property is
@@ -93,6 +104,9 @@ class SortedRunMerger {
   /// Row comparator. Returns true if lhs < rhs.
   const TupleRowComparator& comparator_;
 
+  /// Encoder for the normalized keys of the rows. Not owned. May be NULL.
+  const NormalizedKeyEncoder* const key_encoder_;
+
   /// Descriptor for the rows provided by the input runs. Owned by the exec-node through
   /// which this merger was created.
   const RowDescriptor* input_row_desc_;
@@ -424,10 +424,16 @@ class Sorter::TupleIterator {
 /// Quick sort is used for sequences of tuples larger that 16 elements, and insertion
 /// sort is used for smaller sequences. The TupleSorter is initialized with a
 /// RuntimeState instance to check for cancellation during an in-memory sort.
+///
+/// If a NormalizedKeyEncoder is provided, the run is instead sorted by computing the
+/// normalized key of every tuple, sorting the (key, tuple) pairs and moving the tuples
+/// into the sorted order. Complete keys are sorted with a radix sort and the comparator
+/// is not needed. Incomplete keys are sorted with std::sort, which only invokes the
+/// comparator for tuples with equal keys.
 class Sorter::TupleSorter {
  public:
   TupleSorter(Sorter* parent, const TupleRowComparator& comparator,
-        int tuple_size, RuntimeState* state);
+      const NormalizedKeyEncoder* key_encoder, int tuple_size, RuntimeState* state);
 
   ~TupleSorter();
 
@@ -463,6 +469,9 @@ class Sorter::TupleSorter {
   /// Tuple comparator with method Less() that returns true if lhs < rhs.
   const TupleRowComparator& comparator_;
 
+  /// Encoder for normalized keys of the tuples. Not owned. May be NULL.
+  const NormalizedKeyEncoder* const key_encoder_;
+
   /// Number of times comparator_.Less() can be invoked again before
   /// comparator_. expr_results_pool_.Clear() needs to be called.
   int num_comparisons_till_free_;
@@ -528,6 +537,10 @@ class Sorter::TupleSorter {
   /// Return an error status for any errors or if the query is cancelled.
   Status SortHelper(TupleIterator begin, TupleIterator end);
 
+  /// Sorts 'run_' by the normalized keys of its tuples. Sets 'sorted' to false without
+  /// modifying the run if the memory for the keys could not be obtained.
+  Status SortNormalizedKeys(bool* sorted);
+
   /// Select a pivot to partition [begin, end).
   Tuple* IR_ALWAYS_INLINE SelectPivot(TupleIterator begin, TupleIterator end,
       bool* has_equals);
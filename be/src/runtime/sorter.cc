@@ -17,6 +17,8 @@
 
 #include "runtime/sorter-internal.h"
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 #include <gutil/strings/substitute.h>
 
@@ -30,7 +32,10 @@
 #include "runtime/query-state.h"
 #include "runtime/runtime-state.h"
 #include "runtime/sorted-run-merger.h"
+#include "util/normalized-key.h"
 #include "util/pretty-printer.h"
+#include "util/radix-sort.h"
+#include "util/scope-exit-trigger.h"
 #include "util/ubsan.h"
 
 #include "common/names.h"
@@ -734,10 +739,11 @@ Sorter::TupleIterator::TupleIterator(Sorter::Run* run, int64_t index)
 }
 
 Sorter::TupleSorter::TupleSorter(Sorter* parent, const TupleRowComparator& comp,
-    int tuple_size, RuntimeState* state)
+    const NormalizedKeyEncoder* key_encoder, int tuple_size, RuntimeState* state)
   : parent_(parent),
     tuple_size_(tuple_size),
     comparator_(comp),
+    key_encoder_(key_encoder),
     num_comparisons_till_free_(state->batch_size()),
     state_(state) {
   temp_tuple_buffer_ = new uint8_t[tuple_size];
@@ -753,17 +759,98 @@ Status Sorter::TupleSorter::Sort(Run* run) {
   DCHECK(run->is_finalized());
   DCHECK(!run->is_sorted());
   run_ = run;
-  const SortHelperFn sort_helper_fn = parent_->codegend_sort_helper_fn_.load();
-  if (sort_helper_fn != nullptr) {
-    RETURN_IF_ERROR(
-        sort_helper_fn(this, TupleIterator::Begin(run_), TupleIterator::End(run_)));
-  } else {
-    RETURN_IF_ERROR(SortHelper(TupleIterator::Begin(run_), TupleIterator::End(run_)));
+  bool sorted = false;
+  if (key_encoder_ != nullptr) RETURN_IF_ERROR(SortNormalizedKeys(&sorted));
+  if (!sorted) {
+    const SortHelperFn sort_helper_fn = parent_->codegend_sort_helper_fn_.load();
+    if (sort_helper_fn != nullptr) {
+      RETURN_IF_ERROR(
+          sort_helper_fn(this, TupleIterator::Begin(run_), TupleIterator::End(run_)));
+    } else {
+      RETURN_IF_ERROR(SortHelper(TupleIterator::Begin(run_), TupleIterator::End(run_)));
+    }
   }
   run_->set_sorted();
   return Status::OK();
 }
 
+Status Sorter::TupleSorter::SortNormalizedKeys(bool* sorted) {
+  // The normalized key of a tuple and the tuple's position in the run.
+  struct KeyEntry {
+    NormalizedKeyEncoder::Key key;
+    Tuple* tuple;
+    int64_t index;
+  };
+  *sorted = false;
+  const int64_t num_tuples = run_->num_tuples();
+  if (num_tuples < 2) return Status::OK();
+  // Complete keys are radix sorted, which needs a second array of entries.
+  const bool complete_keys = key_encoder_->is_complete();
+  const int64_t num_entries = complete_keys ? 2 * num_tuples : num_tuples;
+  // The keys are not part of the run's reservation, so fall back to sorting the tuples
+  // directly if they don't fit into the memory limit. This is why normalized keys are
+  // only used if SORT_NORMALIZED_KEYS is enabled.
+  const int64_t mem_needed = num_entries * sizeof(KeyEntry);
+  MemTracker* mem_tracker = parent_->mem_tracker_;
+  if (!mem_tracker->TryConsume(mem_needed)) return Status::OK();
+  vector<KeyEntry> entries(num_entries);
+  const auto release_mem = MakeScopeExitTrigger([&]() {
+    vector<KeyEntry>().swap(entries);
+    mem_tracker->Release(mem_needed);
+  });
+
+  ScalarExprEvaluator* const* evals = comparator_.ordering_expr_evals().data();
+  TupleIterator iter = TupleIterator::Begin(run_);
+  for (int64_t i = 0; i < num_tuples; ++i) {
+    KeyEntry* entry = &entries[i];
+    key_encoder_->Encode(evals, iter.row(), &entry->key);
+    entry->tuple = iter.tuple();
+    entry->index = i;
+    FreeExprResultPoolIfNeeded();
+    iter.Next(run_, tuple_size_);
+    if (UNLIKELY(i % state_->batch_size() == 0)) RETURN_IF_CANCELLED(state_);
+  }
+
+  if (complete_keys) {
+    RadixSortByKey(entries.data(), entries.data() + num_tuples, num_tuples,
+        key_encoder_->num_key_bytes());
+  } else {
+    std::sort(entries.begin(), entries.end(),
+        [this](const KeyEntry& lhs, const KeyEntry& rhs) {
+          int result = lhs.key.Compare(rhs.key);
+          if (result != 0) return result < 0;
+          return Less(reinterpret_cast<const TupleRow*>(&lhs.tuple),
+              reinterpret_cast<const TupleRow*>(&rhs.tuple));
+        });
+  }
+  RETURN_IF_CANCELLED(state_);
+  RETURN_IF_ERROR(state_->GetQueryStatus());
+
+  // Move the tuples into the sorted order by following the cycles of the permutation.
+  // The tuple that belongs to position 'i' is the one at position 'entries[i].index',
+  // which was stored at 'entries[i].tuple' before any tuple was moved. Each cycle
+  // is rotated through 'temp_tuple_buffer_'.
+  for (int64_t i = 0; i < num_tuples; ++i) {
+    if (entries[i].index == i) continue;
+    Tuple* dst = TupleIterator(run_, i).tuple();
+    memcpy(temp_tuple_buffer_, dst, tuple_size_);
+    int64_t j = i;
+    while (true) {
+      int64_t src = entries[j].index;
+      entries[j].index = j;
+      if (src == i) {
+        memcpy(dst, temp_tuple_buffer_, tuple_size_);
+        break;
+      }
+      memcpy(dst, entries[j].tuple, tuple_size_);
+      dst = entries[j].tuple;
+      j = src;
+    }
+  }
+  *sorted = true;
+  return Status::OK();
+}
+
 Sorter::Sorter(const TupleRowComparatorConfig& tuple_row_comparator_config,
     const vector<ScalarExpr*>& sort_tuple_exprs, RowDescriptor* output_row_desc,
     MemTracker* mem_tracker, BufferPool::ClientHandle* buffer_pool_client,
@@ -804,6 +891,10 @@ Sorter::Sorter(const TupleRowComparatorConfig& tuple_row_comparator_config,
     default:
       DCHECK(false);
   }
+  if (state_->query_options().sort_normalized_keys) {
+    key_encoder_.reset(new NormalizedKeyEncoder(tuple_row_comparator_config));
+    if (!key_encoder_->IsUsable()) key_encoder_.reset();
+  }
 
   if (estimated_input_size > 0) ComputeSpillEstimate(estimated_input_size);
 }
@@ -848,8 +939,8 @@ Status Sorter::Prepare(ObjectPool* obj_pool) {
         PrettyPrinter::Print(state_->query_options().max_row_size, TUnit::BYTES));
   }
   has_var_len_slots_ = sort_tuple_desc->HasVarlenSlots();
-  in_mem_tuple_sorter_.reset(
-      new TupleSorter(this, *compare_less_than_, sort_tuple_desc->byte_size(), state_));
+  in_mem_tuple_sorter_.reset(new TupleSorter(this, *compare_less_than_,
+      key_encoder_.get(), sort_tuple_desc->byte_size(), state_));
 
   if (enable_spilling_) {
     initial_runs_counter_ = ADD_COUNTER(profile_, "InitialRunsCreated", TUnit::UNIT);
@@ -1154,8 +1245,8 @@ Status Sorter::CreateMerger(int num_runs) {
   // TODO: 'deep_copy_input' is set to true, which forces the merger to copy all rows
   // from the runs being merged. This is unnecessary overhead that is not required if we
   // correctly transfer resources.
-  merger_.reset(
-      new SortedRunMerger(*compare_less_than_, output_row_desc_, profile_, true));
+  merger_.reset(new SortedRunMerger(
+      *compare_less_than_, output_row_desc_, profile_, true, key_encoder_.get()));
 
   vector<function<Status (RowBatch**)>> merge_runs;
   merge_runs.reserve(num_runs);
@@ -26,6 +26,7 @@
 
 namespace impala {
 
+class NormalizedKeyEncoder;
 class SortedRunMerger;
 class RowBatch;
 
@@ -254,6 +255,12 @@ class Sorter {
   boost::scoped_ptr<TupleRowComparator> compare_less_than_;
   boost::scoped_ptr<TupleSorter> in_mem_tuple_sorter_;
 
+  /// Encoder for the normalized keys of the sort tuples. Set if the SORT_NORMALIZED_KEYS
+  /// query option is enabled and the ordering exprs can be encoded. Used by the in-memory
+  /// sort, which radix sorts the tuples if the keys are complete, and by the mergers to
+  /// compare keys before evaluating the ordering exprs.
+  boost::scoped_ptr<NormalizedKeyEncoder> key_encoder_;
+
   /// A reference to the codegened version of TupleSorter::SortHelper() that is stored
   /// inside SortPlanNode and PartialSortPlanNode.
   const CodegenFnPtr<SortHelperFn>& codegend_sort_helper_fn_;
@@ -117,7 +117,7 @@ void DataStreamService::UpdateFilter(
   DCHECK(req->has_filter_id());
   DCHECK(req->has_query_id());
   DCHECK(req->has_bloom_filter() || req->has_min_max_filter()
-      || req->has_in_list_filter());
+      || req->has_in_list_filter() || req->has_bitmap_filter());
   ExecEnv::GetInstance()->impala_server()->UpdateFilter(resp, *req, context);
   RespondAndReleaseRpc(Status::OK(), resp, context, mem_tracker_.get());
 }
@@ -129,7 +129,7 @@ void DataStreamService::PublishFilter(
   DCHECK(req->has_filter_id());
   DCHECK(req->has_dst_query_id());
   DCHECK(req->has_bloom_filter() || req->has_min_max_filter()
-      || req->has_in_list_filter());
+      || req->has_in_list_filter() || req->has_bitmap_filter());
   QueryState::ScopedRef qs(ProtoToQueryId(req->dst_query_id()));
 
   if (qs.get() != nullptr) {
@@ -73,6 +73,8 @@
 #include "runtime/client-cache.h"
 #include "runtime/coordinator.h"
 #include "runtime/exec-env.h"
+#include "runtime/io/data-cache.h"
+#include "runtime/io/disk-io-mgr.h"
 #include "runtime/lib-cache.h"
 #include "runtime/query-driver.h"
 #include "runtime/timestamp-value.h"
@@ -3241,6 +3243,10 @@ Status ImpalaServer::StartShutdown(
     }
   }
   LOG(INFO) << "Shutdown complete, going down.";
+  // Checkpoint the data cache's metadata so the cached content can be reused after the
+  // restart. Nothing else runs the cache's destructor as _exit() is used below.
+  io::DataCache* data_cache = ExecEnv::GetInstance()->disk_io_mgr()->remote_data_cache();
+  if (data_cache != nullptr) discard_result(data_cache->Checkpoint());
   // Use _exit here instead since exit() does cleanup which interferes with the shutdown
   // signal handler thread causing a data race.
   ShutdownLogging();
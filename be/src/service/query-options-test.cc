@@ -554,6 +554,51 @@ TEST(QueryOptions, CompressionCodec) {
 #undef ENTRY
 }
 
+TEST(QueryOptions, ExchangeCompressionCodec) {
+  const string KEY = "exchange_compression_codec";
+  TQueryOptions options;
+  EXPECT_FALSE(options.__isset.exchange_compression_codec);
+  EXPECT_TRUE(SetQueryOption(KEY, "none", &options, nullptr).ok());
+  EXPECT_EQ(THdfsCompression::NONE, options.exchange_compression_codec.codec);
+  EXPECT_TRUE(SetQueryOption(KEY, "lz4", &options, nullptr).ok());
+  EXPECT_EQ(THdfsCompression::LZ4, options.exchange_compression_codec.codec);
+  EXPECT_TRUE(SetQueryOption(KEY, "zstd", &options, nullptr).ok());
+  EXPECT_EQ(THdfsCompression::ZSTD, options.exchange_compression_codec.codec);
+  EXPECT_EQ(ZSTD_CLEVEL_DEFAULT, options.exchange_compression_codec.compression_level);
+  EXPECT_TRUE(SetQueryOption(KEY, "ZSTD:7", &options, nullptr).ok());
+  EXPECT_EQ(7, options.exchange_compression_codec.compression_level);
+
+  // Only codecs supported by row batch serialization are accepted.
+  EXPECT_FALSE(SetQueryOption(KEY, "snappy", &options, nullptr).ok());
+  EXPECT_FALSE(SetQueryOption(KEY, "gzip", &options, nullptr).ok());
+  EXPECT_FALSE(SetQueryOption(KEY, "lz4:1", &options, nullptr).ok());
+  EXPECT_FALSE(SetQueryOption(KEY, "zstd:0", &options, nullptr).ok());
+  EXPECT_FALSE(SetQueryOption(KEY, "foo", &options, nullptr).ok());
+  EXPECT_EQ(THdfsCompression::ZSTD, options.exchange_compression_codec.codec);
+  EXPECT_EQ(7, options.exchange_compression_codec.compression_level);
+}
+
+TEST(QueryOptions, ParquetWriteEncodings) {
+  const string KEY = "parquet_write_encodings";
+  TQueryOptions options;
+  EXPECT_TRUE(SetQueryOption(KEY, "", &options, nullptr).ok());
+  EXPECT_TRUE(SetQueryOption(KEY, "bigint:delta_binary_packed", &options, nullptr).ok());
+  EXPECT_EQ("bigint:delta_binary_packed", options.parquet_write_encodings);
+  EXPECT_TRUE(SetQueryOption(KEY,
+      "INT:DELTA_BINARY_PACKED, STRING:DELTA_BYTE_ARRAY,double:byte_stream_split",
+      &options, nullptr).ok());
+  EXPECT_TRUE(SetQueryOption(KEY, "string:plain", &options, nullptr).ok());
+
+  // Only encodings that the writer supports for the type are accepted.
+  EXPECT_FALSE(SetQueryOption(KEY, "string:delta_binary_packed", &options, nullptr).ok());
+  EXPECT_FALSE(SetQueryOption(KEY, "bigint:byte_stream_split", &options, nullptr).ok());
+  EXPECT_FALSE(SetQueryOption(KEY, "bigint:rle_dictionary", &options, nullptr).ok());
+  EXPECT_FALSE(SetQueryOption(KEY, "bigint", &options, nullptr).ok());
+  EXPECT_FALSE(SetQueryOption(KEY, "foo:plain", &options, nullptr).ok());
+  EXPECT_FALSE(SetQueryOption(KEY, "bigint:foo", &options, nullptr).ok());
+  EXPECT_EQ("string:plain", options.parquet_write_encodings);
+}
+
 void VerifyFilterTypes(const set<TRuntimeFilterType::type>& types,
     const std::initializer_list<TRuntimeFilterType::type>& expects) {
   EXPECT_EQ(expects.size(), types.size());
@@ -572,7 +617,8 @@ TEST(QueryOptions, EnabledRuntimeFilterTypes) {
         {
             TRuntimeFilterType::BLOOM,
             TRuntimeFilterType::MIN_MAX,
-            TRuntimeFilterType::IN_LIST
+            TRuntimeFilterType::IN_LIST,
+            TRuntimeFilterType::BITMAP
         });
   }
   {
@@ -608,6 +654,15 @@ TEST(QueryOptions, EnabledRuntimeFilterTypes) {
                           TRuntimeFilterType::IN_LIST
                       });
   }
+  {
+    TQueryOptions options;
+    EXPECT_TRUE(SetQueryOption(KEY, "bloom,bitmap", &options, nullptr).ok());
+    VerifyFilterTypes(options.enabled_runtime_filter_types,
+        {
+            TRuntimeFilterType::BLOOM,
+            TRuntimeFilterType::BITMAP
+        });
+  }
 }
 
 // Tests for setting of MAX_RESULT_SPOOLING_MEM and
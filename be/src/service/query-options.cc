@@ -1227,6 +1227,60 @@ Status impala::SetQueryOption(const string& key, const string& value,
         query_options->__set_orc_schema_resolution(enum_type);
         break;
       }
+      case TImpalaQueryOptions::EXCHANGE_COMPRESSION_CODEC: {
+        THdfsCompression::type enum_type;
+        int compression_level;
+        RETURN_IF_ERROR(
+            ParseUtil::ParseCompressionCodec(value, &enum_type, &compression_level));
+        if (enum_type != THdfsCompression::NONE && enum_type != THdfsCompression::LZ4
+            && enum_type != THdfsCompression::ZSTD) {
+          return Status(Substitute("Invalid value for EXCHANGE_COMPRESSION_CODEC: '$0'. "
+              "Valid values are NONE, LZ4 and ZSTD[:level].", value));
+        }
+        TCompressionCodec compression_codec;
+        compression_codec.__set_codec(enum_type);
+        if (enum_type == THdfsCompression::ZSTD) {
+          compression_codec.__set_compression_level(compression_level);
+        }
+        query_options->__set_exchange_compression_codec(compression_codec);
+        break;
+      }
+      case TImpalaQueryOptions::ADAPTIVE_EXCHANGE_COMPRESSION:
+        query_options->__set_adaptive_exchange_compression(IsTrue(value));
+        break;
+      case TImpalaQueryOptions::EXCHANGE_COLUMNAR_FORMAT:
+        query_options->__set_exchange_columnar_format(IsTrue(value));
+        break;
+      case TImpalaQueryOptions::SORT_NORMALIZED_KEYS:
+        query_options->__set_sort_normalized_keys(IsTrue(value));
+        break;
+      case TImpalaQueryOptions::HASH_TABLE_GROUP_PROBING:
+        query_options->__set_hash_table_group_probing(IsTrue(value));
+        break;
+      case TImpalaQueryOptions::ENABLE_BAND_JOIN:
+        query_options->__set_enable_band_join(IsTrue(value));
+        break;
+      case TImpalaQueryOptions::VECTORIZED_CONJUNCTS:
+        query_options->__set_vectorized_conjuncts(IsTrue(value));
+        break;
+      case TImpalaQueryOptions::SPILLED_AGG_PREAGG:
+        query_options->__set_spilled_agg_preagg(IsTrue(value));
+        break;
+      case TImpalaQueryOptions::PARQUET_WRITE_ENCODINGS: {
+        map<TPrimitiveType::type, parquet::Encoding::type> encodings;
+        RETURN_IF_ERROR(ParseUtil::ParseParquetWriteEncodings(value, &encodings));
+        query_options->__set_parquet_write_encodings(value);
+        break;
+      }
+      case TImpalaQueryOptions::PARQUET_DICTIONARY_ROW_FILTERING:
+        query_options->__set_parquet_dictionary_row_filtering(IsTrue(value));
+        break;
+      case TImpalaQueryOptions::PARQUET_SPLIT_ROW_GROUPS:
+        query_options->__set_parquet_split_row_groups(IsTrue(value));
+        break;
+      case TImpalaQueryOptions::AGG_RADIX_PARTITIONING:
+        query_options->__set_agg_radix_partitioning(IsTrue(value));
+        break;
       default:
         if (IsRemovedQueryOption(key)) {
           LOG(WARNING) << "Ignoring attempt to set removed query option '" << key << "'";
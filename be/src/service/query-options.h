@@ -50,7 +50,7 @@ typedef std::unordered_map<string, beeswax::TQueryOptionLevel::type>
 // time we add or remove a query option to/from the enum TImpalaQueryOptions.
 #define QUERY_OPTS_TABLE                                                                 \
   DCHECK_EQ(_TImpalaQueryOptions_VALUES_TO_NAMES.size(),                                 \
-      TImpalaQueryOptions::ORC_SCHEMA_RESOLUTION + 1);                                   \
+      TImpalaQueryOptions::AGG_RADIX_PARTITIONING + 1);                                  \
   REMOVED_QUERY_OPT_FN(abort_on_default_limit_exceeded, ABORT_ON_DEFAULT_LIMIT_EXCEEDED) \
   QUERY_OPT_FN(abort_on_error, ABORT_ON_ERROR, TQueryOptionLevel::REGULAR)               \
   REMOVED_QUERY_OPT_FN(allow_unsupported_formats, ALLOW_UNSUPPORTED_FORMATS)             \
@@ -274,7 +274,27 @@ typedef std::unordered_map<string, beeswax::TQueryOptionLevel::type>
   QUERY_OPT_FN(enable_replan, ENABLE_REPLAN, TQueryOptionLevel::ADVANCED)                \
   QUERY_OPT_FN(test_replan, TEST_REPLAN, TQueryOptionLevel::ADVANCED)                    \
   QUERY_OPT_FN(lock_max_wait_time_s, LOCK_MAX_WAIT_TIME_S, TQueryOptionLevel::REGULAR)   \
-  QUERY_OPT_FN(orc_schema_resolution, ORC_SCHEMA_RESOLUTION, TQueryOptionLevel::REGULAR);
+  QUERY_OPT_FN(orc_schema_resolution, ORC_SCHEMA_RESOLUTION, TQueryOptionLevel::REGULAR) \
+  QUERY_OPT_FN(exchange_compression_codec, EXCHANGE_COMPRESSION_CODEC,                   \
+      TQueryOptionLevel::ADVANCED)                                                       \
+  QUERY_OPT_FN(adaptive_exchange_compression, ADAPTIVE_EXCHANGE_COMPRESSION,             \
+      TQueryOptionLevel::ADVANCED)                                                       \
+  QUERY_OPT_FN(exchange_columnar_format, EXCHANGE_COLUMNAR_FORMAT,                       \
+      TQueryOptionLevel::ADVANCED)                                                       \
+  QUERY_OPT_FN(sort_normalized_keys, SORT_NORMALIZED_KEYS, TQueryOptionLevel::ADVANCED)  \
+  QUERY_OPT_FN(hash_table_group_probing, HASH_TABLE_GROUP_PROBING,                       \
+      TQueryOptionLevel::ADVANCED)                                                       \
+  QUERY_OPT_FN(enable_band_join, ENABLE_BAND_JOIN, TQueryOptionLevel::ADVANCED)          \
+  QUERY_OPT_FN(vectorized_conjuncts, VECTORIZED_CONJUNCTS, TQueryOptionLevel::ADVANCED)  \
+  QUERY_OPT_FN(spilled_agg_preagg, SPILLED_AGG_PREAGG, TQueryOptionLevel::ADVANCED)      \
+  QUERY_OPT_FN(parquet_write_encodings, PARQUET_WRITE_ENCODINGS,                         \
+      TQueryOptionLevel::ADVANCED)                                                       \
+  QUERY_OPT_FN(parquet_dictionary_row_filtering, PARQUET_DICTIONARY_ROW_FILTERING,       \
+      TQueryOptionLevel::ADVANCED)                                                       \
+  QUERY_OPT_FN(parquet_split_row_groups, PARQUET_SPLIT_ROW_GROUPS,                       \
+      TQueryOptionLevel::ADVANCED)                                                       \
+  QUERY_OPT_FN(agg_radix_partitioning, AGG_RADIX_PARTITIONING,                           \
+      TQueryOptionLevel::ADVANCED);
 
 /// Enforce practical limits on some query options to avoid undesired query state.
 static const int64_t SPILLABLE_BUFFER_LIMIT = 1LL << 40; // 1 TB
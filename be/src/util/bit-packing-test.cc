@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <numeric>
 #include <random>
 #include <unordered_map>
 
@@ -26,6 +27,7 @@
 #include "testutil/mem-util.h"
 #include "util/bit-packing.h"
 #include "util/bit-stream-utils.inline.h"
+#include "util/cpu-info.h"
 
 #include "common/names.h"
 
@@ -201,6 +203,13 @@ TEST(BitPackingTest, RandomUnpack64) {
   RandomUnpackTest<uint64_t>();
 }
 
+// The tests above use the AVX2 kernels for uint32_t if the CPU supports them. Also
+// test the scalar code for those.
+TEST(BitPackingTest, RandomUnpack32NoAvx2) {
+  CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+  RandomUnpackTest<uint32_t>();
+}
+
 // This is not the full dictionary encoding, only a big bit-packed literal run, no RLE is
 // used.
 template <typename T>
@@ -319,4 +328,46 @@ TEST(BitPackingTest, RandomUnpackAndDecode64) {
   RandomUnpackAndDecodeTest<uint64_t>();
 }
 
+TEST(BitPackingTest, RandomUnpackAndDecode32NoAvx2) {
+  CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+  RandomUnpackAndDecodeTest<uint32_t>();
+}
+
+TEST(BitPackingTest, RandomUnpackAndDecode64NoAvx2) {
+  CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+  RandomUnpackAndDecodeTest<uint64_t>();
+}
+
+// Test that an out of range index is reported when it is in the middle of the batches
+// decoded with AVX2, and that the values around it are still decoded.
+TEST(BitPackingTest, UnpackAndDecodeOutOfRange) {
+  constexpr int BIT_WIDTH = 8;
+  constexpr int NUM_VALUES = 1024;
+  constexpr int BAD_IDX_POS = 500;
+  std::vector<uint64_t> dict(100);
+  std::iota(dict.begin(), dict.end(), 1000);
+  std::vector<uint8_t> data(NUM_VALUES * BIT_WIDTH / 8);
+  BitWriter writer(data.data(), data.size());
+  for (int i = 0; i < NUM_VALUES; ++i) {
+    EXPECT_TRUE(writer.PutValue(i == BAD_IDX_POS ? dict.size() : i % dict.size(),
+        BIT_WIDTH));
+  }
+  writer.Flush();
+
+  for (bool use_avx2 : {true, false}) {
+    CpuInfo::TempDisable disable_avx2(use_avx2 ? 0 : CpuInfo::AVX2);
+    std::vector<uint64_t> out(NUM_VALUES, 0);
+    bool decode_error = false;
+    std::pair<const uint8_t*, int64_t> res = BitPacking::UnpackAndDecodeValues<uint64_t>(
+        BIT_WIDTH, data.data(), data.size(), dict.data(), dict.size(), NUM_VALUES,
+        out.data(), sizeof(uint64_t), &decode_error);
+    EXPECT_TRUE(decode_error);
+    EXPECT_EQ(NUM_VALUES, res.second);
+    for (int i = 0; i < NUM_VALUES; ++i) {
+      if (i == BAD_IDX_POS) continue;
+      EXPECT_EQ(dict[i % dict.size()], out[i]) << i;
+    }
+  }
+}
+
 }
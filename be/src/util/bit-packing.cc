@@ -17,6 +17,11 @@
 
 #include "util/bit-packing.inline.h"
 
+#ifndef __aarch64__
+#include <immintrin.h>
+#endif
+#include <cstring>
+
 #include "runtime/date-value.h"
 #include "runtime/decimal-value.h"
 #include "runtime/string-value.h"
@@ -24,6 +29,189 @@
 
 namespace impala {
 
+#ifndef __aarch64__
+namespace {
+
+// Value 'i' of a group of 8 values with 'bit_width' that starts at a byte boundary
+// starts at bit BitOffset() of the 32-bit little-endian word with index WordIdx().
+constexpr int WordIdx(int bit_width, int i) { return i * bit_width / 32; }
+constexpr int BitOffset(int bit_width, int i) { return i * bit_width % 32; }
+
+// Unpacks the 8 values with BIT_WIDTH that start at 'in' into the 32-bit lanes of the
+// result. The values take up BIT_WIDTH bytes, but 32 bytes are loaded from 'in'. Each
+// value is put together from the word that it starts in and the next word, which are
+// permuted into its lane. The variable shifts return 0 for a shift of 32, i.e. if the
+// value starts at the beginning of a word.
+template <int BIT_WIDTH>
+__attribute__((target("avx2")))
+inline __m256i Unpack8Values(const uint8_t* __restrict__ in) {
+  const __m256i lo_idx = _mm256_setr_epi32(WordIdx(BIT_WIDTH, 0), WordIdx(BIT_WIDTH, 1),
+      WordIdx(BIT_WIDTH, 2), WordIdx(BIT_WIDTH, 3), WordIdx(BIT_WIDTH, 4),
+      WordIdx(BIT_WIDTH, 5), WordIdx(BIT_WIDTH, 6), WordIdx(BIT_WIDTH, 7));
+  const __m256i hi_idx = _mm256_add_epi32(lo_idx, _mm256_set1_epi32(1));
+  const __m256i lo_shift = _mm256_setr_epi32(BitOffset(BIT_WIDTH, 0),
+      BitOffset(BIT_WIDTH, 1), BitOffset(BIT_WIDTH, 2), BitOffset(BIT_WIDTH, 3),
+      BitOffset(BIT_WIDTH, 4), BitOffset(BIT_WIDTH, 5), BitOffset(BIT_WIDTH, 6),
+      BitOffset(BIT_WIDTH, 7));
+  const __m256i hi_shift = _mm256_sub_epi32(_mm256_set1_epi32(32), lo_shift);
+  const __m256i mask = _mm256_set1_epi32(
+      static_cast<int32_t>(static_cast<uint32_t>((1ULL << BIT_WIDTH) - 1)));
+
+  const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+  const __m256i lo =
+      _mm256_srlv_epi32(_mm256_permutevar8x32_epi32(data, lo_idx), lo_shift);
+  const __m256i hi =
+      _mm256_sllv_epi32(_mm256_permutevar8x32_epi32(data, hi_idx), hi_shift);
+  return _mm256_and_si256(_mm256_or_si256(lo, hi), mask);
+}
+
+// Stores the 4 or 8 values of type T in 'vals' to 'out' with a stride of 'stride' bytes.
+template <typename T>
+__attribute__((target("avx2")))
+inline void StoreValues(__m256i vals, uint8_t* __restrict__ out, int64_t stride) {
+  if (stride == sizeof(T)) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), vals);
+    return;
+  }
+  constexpr int NUM_VALUES = sizeof(__m256i) / sizeof(T);
+  T buffer[NUM_VALUES];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer), vals);
+  for (int i = 0; i < NUM_VALUES; ++i) memcpy(out + i * stride, &buffer[i], sizeof(T));
+}
+
+// Looks up the 8 indices in 'idx' in 'dict' and stores the values to 'out'.
+__attribute__((target("avx2")))
+inline void GatherValues(const uint32_t* __restrict__ dict, __m256i idx,
+    uint8_t* __restrict__ out, int64_t stride) {
+  StoreValues<uint32_t>(
+      _mm256_i32gather_epi32(reinterpret_cast<const int*>(dict), idx, sizeof(uint32_t)),
+      out, stride);
+}
+
+__attribute__((target("avx2")))
+inline void GatherValues(const uint64_t* __restrict__ dict, __m256i idx,
+    uint8_t* __restrict__ out, int64_t stride) {
+  const long long* values = reinterpret_cast<const long long*>(dict);
+  StoreValues<uint64_t>(_mm256_i32gather_epi64(
+      values, _mm256_castsi256_si128(idx), sizeof(uint64_t)), out, stride);
+  StoreValues<uint64_t>(_mm256_i32gather_epi64(
+      values, _mm256_extracti128_si256(idx, 1), sizeof(uint64_t)), out + 4 * stride,
+      stride);
+}
+
+template <int BIT_WIDTH>
+__attribute__((target("avx2")))
+void UnpackBatches(const uint8_t* __restrict__ in, int64_t num_batches,
+    uint32_t* __restrict__ out) {
+  for (int64_t i = 0; i < num_batches; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8 * j),
+          Unpack8Values<BIT_WIDTH>(in + j * BIT_WIDTH));
+    }
+    in += 4 * BIT_WIDTH;
+    out += 32;
+  }
+  _mm256_zeroupper();
+}
+
+template <int BIT_WIDTH, typename DictType>
+__attribute__((target("avx2")))
+int64_t UnpackAndDecodeBatches(const uint8_t* __restrict__ in, int64_t num_batches,
+    const DictType* __restrict__ dict, int64_t dict_len, uint8_t* __restrict__ out,
+    int64_t stride) {
+  const __m256i max_idx = _mm256_set1_epi32(static_cast<int32_t>(dict_len - 1));
+  int64_t i = 0;
+  for (; i < num_batches; ++i) {
+    __m256i idx[4];
+    __m256i in_range = _mm256_set1_epi32(-1);
+    for (int j = 0; j < 4; ++j) {
+      idx[j] = Unpack8Values<BIT_WIDTH>(in + j * BIT_WIDTH);
+      // As unsigned integers, idx <= max_idx iff max(idx, max_idx) == max_idx.
+      in_range = _mm256_and_si256(in_range,
+          _mm256_cmpeq_epi32(_mm256_max_epu32(idx[j], max_idx), max_idx));
+    }
+    if (UNLIKELY(_mm256_movemask_epi8(in_range) != -1)) break;
+    for (int j = 0; j < 4; ++j) GatherValues(dict, idx[j], out + 8 * j * stride, stride);
+    in += 4 * BIT_WIDTH;
+    out += 32 * stride;
+  }
+  _mm256_zeroupper();
+  return i;
+}
+
+} // anonymous namespace
+
+void BitPacking::UnpackBatchesAvx2(int bit_width, const uint8_t* __restrict__ in,
+    int64_t num_batches, uint32_t* __restrict__ out) {
+#pragma push_macro("UNPACK_BATCHES_CASE")
+#define UNPACK_BATCHES_CASE(ignore1, i, ignore2) \
+  case i:                                        \
+    return UnpackBatches<i>(in, num_batches, out);
+
+  switch (bit_width) {
+    // Expand cases from 1 to 32.
+    BOOST_PP_REPEAT_FROM_TO(1, 33, UNPACK_BATCHES_CASE, ignore);
+    default:
+      DCHECK(false);
+  }
+#pragma pop_macro("UNPACK_BATCHES_CASE")
+}
+
+#pragma push_macro("UNPACK_AND_DECODE_BATCHES_CASE")
+#define UNPACK_AND_DECODE_BATCHES_CASE(ignore1, i, ignore2) \
+  case i:                                                   \
+    return UnpackAndDecodeBatches<i>(in, num_batches, dict, dict_len, out, stride);
+
+int64_t BitPacking::UnpackAndDecodeBatchesAvx2(int bit_width,
+    const uint8_t* __restrict__ in, int64_t num_batches,
+    const uint32_t* __restrict__ dict, int64_t dict_len, uint8_t* __restrict__ out,
+    int64_t stride) {
+  switch (bit_width) {
+    // Expand cases from 1 to 32.
+    BOOST_PP_REPEAT_FROM_TO(1, 33, UNPACK_AND_DECODE_BATCHES_CASE, ignore);
+    default:
+      DCHECK(false);
+      return 0;
+  }
+}
+
+int64_t BitPacking::UnpackAndDecodeBatchesAvx2(int bit_width,
+    const uint8_t* __restrict__ in, int64_t num_batches,
+    const uint64_t* __restrict__ dict, int64_t dict_len, uint8_t* __restrict__ out,
+    int64_t stride) {
+  switch (bit_width) {
+    // Expand cases from 1 to 32.
+    BOOST_PP_REPEAT_FROM_TO(1, 33, UNPACK_AND_DECODE_BATCHES_CASE, ignore);
+    default:
+      DCHECK(false);
+      return 0;
+  }
+}
+#pragma pop_macro("UNPACK_AND_DECODE_BATCHES_CASE")
+#else
+// NumAvx2Batches() always returns 0 on ARM, so these are never called.
+void BitPacking::UnpackBatchesAvx2(int bit_width, const uint8_t* __restrict__ in,
+    int64_t num_batches, uint32_t* __restrict__ out) {
+  DCHECK(false);
+}
+
+int64_t BitPacking::UnpackAndDecodeBatchesAvx2(int bit_width,
+    const uint8_t* __restrict__ in, int64_t num_batches,
+    const uint32_t* __restrict__ dict, int64_t dict_len, uint8_t* __restrict__ out,
+    int64_t stride) {
+  DCHECK(false);
+  return 0;
+}
+
+int64_t BitPacking::UnpackAndDecodeBatchesAvx2(int bit_width,
+    const uint8_t* __restrict__ in, int64_t num_batches,
+    const uint64_t* __restrict__ dict, int64_t dict_len, uint8_t* __restrict__ out,
+    int64_t stride) {
+  DCHECK(false);
+  return 0;
+}
+#endif
+
 // Instantiate all of the templated functions needed by the rest of Impala.
 #define INSTANTIATE_UNPACK_VALUES(OUT_TYPE)                                       \
   template std::pair<const uint8_t*, int64_t> BitPacking::UnpackValues<OUT_TYPE>( \
@@ -131,5 +131,29 @@ class BitPacking {
   /// Compute the number of values with the given bit width that can be unpacked from
   /// an input buffer of 'in_bytes' into an output buffer with space for 'num_values'.
   static int64_t NumValuesToUnpack(int bit_width, int64_t in_bytes, int64_t num_values);
+
+  /// Returns how many of the first 'num_batches' batches of 32 values with 'bit_width'
+  /// in an input buffer of 'in_bytes' can be unpacked by the AVX2 functions below.
+  /// These load 32 bytes at the start of every 8 values, so the last batches are left to
+  /// the scalar code if the loads would run past the end of the buffer. Returns 0 if the
+  /// CPU does not support AVX2 or 'bit_width' is not in [1, 32].
+  static int64_t NumAvx2Batches(int bit_width, int64_t in_bytes, int64_t num_batches);
+
+  /// Unpacks 'num_batches' batches of 32 values with 'bit_width' from 'in' to 'out' with
+  /// AVX2, eight values at a time. Only valid if NumAvx2Batches() allows it.
+  static void UnpackBatchesAvx2(int bit_width, const uint8_t* __restrict__ in,
+      int64_t num_batches, uint32_t* __restrict__ out);
+
+  /// Same as UnpackBatchesAvx2() with dictionary decoding of 4 or 8 byte values, which
+  /// are looked up with AVX2 gathers. Writes the values to 'out' with a stride of
+  /// 'stride' bytes. Stops at the first batch with an index of 'dict_len' or more and
+  /// leaves it to the scalar code to report the error. Returns the number of batches
+  /// decoded. 'dict_len' must be in [1, INT32_MAX].
+  static int64_t UnpackAndDecodeBatchesAvx2(int bit_width, const uint8_t* __restrict__ in,
+      int64_t num_batches, const uint32_t* __restrict__ dict, int64_t dict_len,
+      uint8_t* __restrict__ out, int64_t stride);
+  static int64_t UnpackAndDecodeBatchesAvx2(int bit_width, const uint8_t* __restrict__ in,
+      int64_t num_batches, const uint64_t* __restrict__ dict, int64_t dict_len,
+      uint8_t* __restrict__ out, int64_t stride);
 };
 }
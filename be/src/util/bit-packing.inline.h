@@ -25,6 +25,7 @@
 #include "util/bit-packing.h"
 
 #include <algorithm>
+#include <limits>
 #include <type_traits>
 
 #include <boost/preprocessor/repetition/repeat_from_to.hpp>
@@ -32,6 +33,7 @@
 #include "common/compiler-util.h"
 #include "common/logging.h"
 #include "util/bit-util.h"
+#include "util/cpu-info.h"
 
 namespace impala {
 
@@ -48,6 +50,21 @@ inline int64_t BitPacking::NumValuesToUnpack(
   }
 }
 
+inline int64_t BitPacking::NumAvx2Batches(
+    int bit_width, int64_t in_bytes, int64_t num_batches) {
+#ifndef __aarch64__
+  if (bit_width == 0 || bit_width > 32 || !CpuInfo::IsSupported(CpuInfo::AVX2)) {
+    return 0;
+  }
+  // The last 32-byte load of batch i starts at byte (4 * i + 3) * bit_width.
+  const int64_t last_load_bytes = in_bytes - 3 * bit_width - 32;
+  if (last_load_bytes < 0) return 0;
+  return std::min(num_batches, last_load_bytes / (4 * bit_width) + 1);
+#else
+  return 0;
+#endif
+}
+
 template <typename T>
 constexpr bool IsSupportedUnpackingType () {
   return std::is_same<T, uint8_t>::value
@@ -91,9 +108,22 @@ std::pair<const uint8_t*, int64_t> BitPacking::UnpackValues(
   const int64_t remainder_values = values_to_read % BATCH_SIZE;
   const uint8_t* in_pos = in;
   OutType* out_pos = out;
-
-  // First unpack as many full batches as possible.
-  for (int64_t i = 0; i < batches_to_read; ++i) {
+  int64_t i = 0;
+
+  // First unpack as many full batches as possible, with AVX2 if the values fit in the
+  // 32-bit lanes of the output.
+  if (std::is_same<OutType, uint32_t>::value) {
+    const int64_t avx2_batches = NumAvx2Batches(BIT_WIDTH, in_bytes, batches_to_read);
+    if (avx2_batches > 0) {
+      UnpackBatchesAvx2(BIT_WIDTH, in_pos, avx2_batches,
+          reinterpret_cast<uint32_t*>(out_pos));
+      i = avx2_batches;
+      in_pos += avx2_batches * BATCH_SIZE * BIT_WIDTH / CHAR_BIT;
+      out_pos += avx2_batches * BATCH_SIZE;
+      in_bytes -= avx2_batches * BATCH_SIZE * BIT_WIDTH / CHAR_BIT;
+    }
+  }
+  for (; i < batches_to_read; ++i) {
     in_pos = Unpack32Values<OutType, BIT_WIDTH>(in_pos, in_bytes, out_pos);
     out_pos += BATCH_SIZE;
     in_bytes -= (BATCH_SIZE * BIT_WIDTH) / CHAR_BIT;
@@ -138,8 +168,23 @@ std::pair<const uint8_t*, int64_t> BitPacking::UnpackAndDecodeValues(
   const int64_t remainder_values = values_to_read % BATCH_SIZE;
   const uint8_t* in_pos = in;
   uint8_t* out_pos = reinterpret_cast<uint8_t*>(out);
-  // First unpack as many full batches as possible.
-  for (int64_t i = 0; i < batches_to_read; ++i) {
+  int64_t i = 0;
+  // First unpack as many full batches as possible. Dictionaries of 4 or 8 byte values
+  // are decoded with AVX2 gathers, which take signed 32-bit indices.
+  if ((sizeof(OutType) == 4 || sizeof(OutType) == 8) && dict_len > 0
+      && dict_len <= std::numeric_limits<int32_t>::max()) {
+    const int64_t avx2_batches = NumAvx2Batches(BIT_WIDTH, in_bytes, batches_to_read);
+    if (avx2_batches > 0) {
+      using DictWord =
+          typename std::conditional<sizeof(OutType) == 4, uint32_t, uint64_t>::type;
+      i = UnpackAndDecodeBatchesAvx2(BIT_WIDTH, in_pos, avx2_batches,
+          reinterpret_cast<const DictWord*>(dict), dict_len, out_pos, stride);
+      in_pos += i * BATCH_SIZE * BIT_WIDTH / CHAR_BIT;
+      out_pos += i * BATCH_SIZE * stride;
+      in_bytes -= i * BATCH_SIZE * BIT_WIDTH / CHAR_BIT;
+    }
+  }
+  for (; i < batches_to_read; ++i) {
     in_pos = UnpackAndDecode32Values<OutType, BIT_WIDTH>(
         in_pos, in_bytes, dict, dict_len, reinterpret_cast<OutType*>(out_pos), stride,
         decode_error);
@@ -282,8 +327,8 @@ const uint8_t* BitPacking::UnpackAndDecode32Values(const uint8_t* __restrict__ i
   static_assert(BIT_WIDTH <= MAX_BITWIDTH, "BIT_WIDTH too high");
   constexpr int BYTES_TO_READ = BitUtil::RoundUpNumBytes(32 * BIT_WIDTH);
   DCHECK_GE(in_bytes, BYTES_TO_READ);
-  // TODO: this could be optimised further by using SIMD instructions.
-  // https://lemire.me/blog/2016/08/25/faster-dictionary-decoding-with-simd-instructions/
+  // This is the scalar version. UnpackAndDecodeValues() decodes most batches with
+  // UnpackAndDecodeBatchesAvx2() if the CPU supports it.
 
   static_assert(BIT_WIDTH <= MAX_DICT_BITWIDTH,
       "Too high bit width for dictionary index.");
@@ -0,0 +1,37 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/bitmap-filter.h"
+
+namespace impala {
+
+#define BITMAP_FILTER_INSERT(TYPE)                                                    \
+  template <>                                                                         \
+  void BitmapFilter::Insert<TYPE>(const void* val) noexcept {                         \
+    if (UNLIKELY(val == nullptr)) {                                                   \
+      contains_null_ = true;                                                          \
+      return;                                                                         \
+    }                                                                                 \
+    Insert(static_cast<int64_t>(*reinterpret_cast<const TYPE*>(val)));                \
+  }
+
+BITMAP_FILTER_INSERT(int8_t)
+BITMAP_FILTER_INSERT(int16_t)
+BITMAP_FILTER_INSERT(int32_t)
+BITMAP_FILTER_INSERT(int64_t)
+
+} // namespace impala
@@ -0,0 +1,272 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "testutil/gtest-util.h"
+#include "util/bitmap-filter.h"
+
+#include "common/object-pool.h"
+#include "runtime/date-value.h"
+#include "runtime/mem-tracker.h"
+
+using namespace impala;
+
+template<typename T, PrimitiveType SLOT_TYPE>
+void TestNumericBitmapFilter() {
+  MemTracker mem_tracker;
+  ColumnType col_type(SLOT_TYPE);
+  BitmapFilter filter(1024, &mem_tracker);
+  EXPECT_TRUE(filter.AlwaysFalse());
+  EXPECT_FALSE(filter.AlwaysTrue());
+
+  // Insert every third value, in both directions from the first one so that the bitmap
+  // has to grow on both sides.
+  for (T v = 0; v < 100; v += 3) filter.Insert<T>(&v);
+  for (T v = -3; v > -100; v -= 3) filter.Insert<T>(&v);
+  EXPECT_FALSE(filter.AlwaysFalse());
+  EXPECT_FALSE(filter.ContainsNull());
+  EXPECT_EQ(-99, filter.min());
+  EXPECT_EQ(99, filter.max());
+  for (T v = -100; v <= 100; ++v) {
+    EXPECT_EQ(v % 3 == 0 && v >= -99 && v <= 99, filter.Find(&v, col_type)) << (int)v;
+  }
+  EXPECT_FALSE(filter.Find(nullptr, col_type));
+  filter.Insert<T>(nullptr);
+  EXPECT_TRUE(filter.ContainsNull());
+  EXPECT_TRUE(filter.Find(nullptr, col_type));
+  EXPECT_GT(mem_tracker.consumption(), 0);
+  filter.Close();
+  EXPECT_EQ(0, mem_tracker.consumption());
+}
+
+TEST(BitmapFilterTest, TestTinyint) {
+  TestNumericBitmapFilter<int8_t, TYPE_TINYINT>();
+}
+
+TEST(BitmapFilterTest, TestSmallint) {
+  TestNumericBitmapFilter<int16_t, TYPE_SMALLINT>();
+}
+
+TEST(BitmapFilterTest, TestInt) {
+  TestNumericBitmapFilter<int32_t, TYPE_INT>();
+}
+
+TEST(BitmapFilterTest, TestBigint) {
+  TestNumericBitmapFilter<int64_t, TYPE_BIGINT>();
+}
+
+TEST(BitmapFilterTest, TestDate) {
+  MemTracker mem_tracker;
+  ColumnType col_type(TYPE_DATE);
+  BitmapFilter filter(1024, &mem_tracker);
+  DateValue d1(2022, 1, 1);
+  DateValue d2(2022, 3, 1);
+  DateValue d3(2022, 2, 1);
+  filter.Insert(&d1, col_type);
+  filter.Insert(&d2, col_type);
+  EXPECT_TRUE(filter.Find(&d1, col_type));
+  EXPECT_TRUE(filter.Find(&d2, col_type));
+  EXPECT_FALSE(filter.Find(&d3, col_type));
+  filter.Close();
+}
+
+TEST(BitmapFilterTest, TestBigintExtremes) {
+  MemTracker mem_tracker;
+  BitmapFilter filter(1024, &mem_tracker);
+  filter.Insert(std::numeric_limits<int64_t>::max());
+  EXPECT_TRUE(filter.Find(std::numeric_limits<int64_t>::max()));
+  EXPECT_FALSE(filter.Find(std::numeric_limits<int64_t>::min()));
+  EXPECT_FALSE(filter.Find(0));
+  // The range would not fit, the filter falls back to always true.
+  filter.Insert(std::numeric_limits<int64_t>::min());
+  EXPECT_TRUE(filter.AlwaysTrue());
+  EXPECT_EQ(0, mem_tracker.consumption());
+}
+
+// Test falling back to an always true filter when the range exceeds the size limit.
+TEST(BitmapFilterTest, TestOverflow) {
+  MemTracker mem_tracker;
+  // 16 words, i.e. 1024 values.
+  BitmapFilter filter(16 * sizeof(uint64_t), &mem_tracker);
+  filter.Insert(1024);
+  filter.Insert(1024 + 1023);
+  EXPECT_FALSE(filter.AlwaysTrue());
+  EXPECT_TRUE(filter.Find(1024));
+  EXPECT_TRUE(filter.Find(1024 + 1023));
+  EXPECT_FALSE(filter.Find(1025));
+  EXPECT_EQ(16 * sizeof(uint64_t), mem_tracker.consumption());
+  filter.Insert(1024 + 1024);
+  EXPECT_TRUE(filter.AlwaysTrue());
+  EXPECT_FALSE(filter.AlwaysFalse());
+  EXPECT_EQ(0, mem_tracker.consumption());
+  // Inserting into an always true filter is a no-op.
+  filter.Insert(0);
+  EXPECT_TRUE(filter.AlwaysTrue());
+  EXPECT_EQ(0, mem_tracker.consumption());
+}
+
+// Test falling back to an always true filter when the memory can not be allocated.
+TEST(BitmapFilterTest, TestMemLimit) {
+  MemTracker mem_tracker(16 * sizeof(uint64_t));
+  BitmapFilter filter(1024 * 1024, &mem_tracker);
+  filter.Insert(0);
+  EXPECT_FALSE(filter.AlwaysTrue());
+  filter.Insert(64 * 100);
+  EXPECT_TRUE(filter.AlwaysTrue());
+  EXPECT_EQ(0, mem_tracker.consumption());
+}
+
+TEST(BitmapFilterTest, TestAnyInRange) {
+  MemTracker mem_tracker;
+  BitmapFilter filter(1024, &mem_tracker);
+  // Empty filters contain no value.
+  EXPECT_FALSE(filter.AnyInRange(std::numeric_limits<int64_t>::min(),
+      std::numeric_limits<int64_t>::max()));
+  filter.Insert(-70);
+  filter.Insert(10);
+  filter.Insert(200);
+  EXPECT_TRUE(filter.AnyInRange(-70, -70));
+  EXPECT_TRUE(filter.AnyInRange(-100, -50));
+  EXPECT_FALSE(filter.AnyInRange(-69, 9));
+  EXPECT_TRUE(filter.AnyInRange(-69, 10));
+  EXPECT_FALSE(filter.AnyInRange(11, 199));
+  EXPECT_TRUE(filter.AnyInRange(11, 200));
+  EXPECT_FALSE(filter.AnyInRange(201, 1000));
+  EXPECT_FALSE(filter.AnyInRange(-1000, -71));
+  EXPECT_TRUE(filter.AnyInRange(std::numeric_limits<int64_t>::min(),
+      std::numeric_limits<int64_t>::max()));
+  filter.SetAlwaysTrue();
+  EXPECT_TRUE(filter.AnyInRange(11, 199));
+}
+
+TEST(BitmapFilterTest, TestOr) {
+  MemTracker mem_tracker;
+  BitmapFilter f1(1024, &mem_tracker);
+  BitmapFilter f2(1024, &mem_tracker);
+  for (int64_t v = 0; v < 100; v += 2) f1.Insert(v);
+  for (int64_t v = -301; v < 0; v += 2) f2.Insert(v);
+  f2.Insert(static_cast<const void*>(nullptr), ColumnType(TYPE_BIGINT));
+  f1.Or(f2);
+  EXPECT_TRUE(f1.ContainsNull());
+  EXPECT_EQ(-301, f1.min());
+  EXPECT_EQ(98, f1.max());
+  for (int64_t v = -310; v < 110; ++v) {
+    bool expected = (v >= 0 && v < 100 && v % 2 == 0) || (v >= -301 && v < 0 && v % 2);
+    EXPECT_EQ(expected, f1.Find(v)) << v;
+  }
+  // An empty filter is the identity of Or().
+  BitmapFilter empty(1024, &mem_tracker);
+  f1.Or(empty);
+  EXPECT_EQ(-301, f1.min());
+  EXPECT_EQ(98, f1.max());
+  // An always true filter makes the result always true.
+  BitmapFilter always_true(1024, &mem_tracker);
+  always_true.SetAlwaysTrue();
+  f1.Or(always_true);
+  EXPECT_TRUE(f1.AlwaysTrue());
+  f2.Close();
+  EXPECT_EQ(0, mem_tracker.consumption());
+}
+
+TEST(BitmapFilterTest, TestProtobuf) {
+  MemTracker mem_tracker;
+  ObjectPool obj_pool;
+  BitmapFilter filter(1024, &mem_tracker);
+  BitmapFilterPB pb;
+  BitmapFilter::ToProtobuf(&filter, &pb);
+  EXPECT_TRUE(BitmapFilter::AlwaysFalse(pb));
+  for (int64_t v = 1000; v < 1500; v += 7) filter.Insert(v);
+
+  pb.Clear();
+  BitmapFilter::ToProtobuf(&filter, &pb);
+  EXPECT_FALSE(pb.always_true());
+  EXPECT_EQ(1000, pb.min());
+  EXPECT_EQ(1497, pb.max());
+  // Only the words between min and max are sent.
+  EXPECT_EQ(1497 / 64 - 1000 / 64 + 1, pb.words_size());
+
+  BitmapFilter* copy = BitmapFilter::Create(pb, 1024, &obj_pool, &mem_tracker);
+  for (int64_t v = 900; v < 1600; ++v) {
+    EXPECT_EQ(filter.Find(v), copy->Find(v)) << v;
+  }
+  copy->Close();
+
+  // Merge with a second filter in protobuf representation.
+  BitmapFilter other(1024, &mem_tracker);
+  other.Insert(-5);
+  BitmapFilterPB other_pb;
+  BitmapFilter::ToProtobuf(&other, &other_pb);
+  BitmapFilter::Or(other_pb, &pb, 1024);
+  EXPECT_EQ(-5, pb.min());
+  EXPECT_EQ(1497, pb.max());
+  BitmapFilter* merged = BitmapFilter::Create(pb, 1024, &obj_pool, &mem_tracker);
+  EXPECT_TRUE(merged->Find(-5));
+  EXPECT_TRUE(merged->Find(1000));
+  EXPECT_TRUE(merged->Find(1497));
+  EXPECT_FALSE(merged->Find(1001));
+  merged->Close();
+
+  // The union spans 25 words, which does not fit into 16 words.
+  BitmapFilter::Or(other_pb, &pb, 16 * sizeof(uint64_t));
+  EXPECT_TRUE(pb.always_true());
+
+  // A nullptr filter is converted to an always true filter.
+  BitmapFilterPB always_true_pb;
+  BitmapFilter::ToProtobuf(nullptr, &always_true_pb);
+  EXPECT_TRUE(always_true_pb.always_true());
+  BitmapFilter* always_true =
+      BitmapFilter::Create(always_true_pb, 1024, &obj_pool, &mem_tracker);
+  EXPECT_TRUE(always_true->AlwaysTrue());
+
+  filter.Close();
+  other.Close();
+  EXPECT_EQ(0, mem_tracker.consumption());
+}
+
+TEST(BitmapFilterTest, TestInvalidProtobuf) {
+  MemTracker mem_tracker;
+  ObjectPool obj_pool;
+  BitmapFilter filter(1024, &mem_tracker);
+  for (int64_t v = 0; v < 200; v += 5) filter.Insert(v);
+  BitmapFilterPB valid_pb;
+  BitmapFilter::ToProtobuf(&filter, &valid_pb);
+  EXPECT_TRUE(BitmapFilter::IsValid(valid_pb));
+
+  // More words than [min, max] covers, fewer words, and an inverted range.
+  BitmapFilterPB too_many_words = valid_pb;
+  for (int i = 0; i < 100; ++i) too_many_words.add_words(~0ULL);
+  BitmapFilterPB too_few_words = valid_pb;
+  too_few_words.mutable_words()->RemoveLast();
+  BitmapFilterPB inverted_range = valid_pb;
+  inverted_range.set_min(valid_pb.max() + 64);
+  BitmapFilterPB words_without_range;
+  words_without_range.set_always_true(false);
+  words_without_range.add_words(1);
+  for (const BitmapFilterPB* pb :
+      {&too_many_words, &too_few_words, &inverted_range, &words_without_range}) {
+    EXPECT_FALSE(BitmapFilter::IsValid(*pb));
+    // An invalid filter is treated as always true instead of being read.
+    BitmapFilter* created = BitmapFilter::Create(*pb, 1024, &obj_pool, &mem_tracker);
+    EXPECT_TRUE(created->AlwaysTrue());
+    EXPECT_TRUE(created->AnyInRange(1000, 2000));
+    BitmapFilterPB merged = valid_pb;
+    BitmapFilter::Or(*pb, &merged, 1024);
+    EXPECT_TRUE(merged.always_true());
+    EXPECT_EQ(0, merged.words_size());
+  }
+  filter.Close();
+  EXPECT_EQ(0, mem_tracker.consumption());
+}
@@ -0,0 +1,263 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/bitmap-filter.h"
+
+#include <sstream>
+
+#include "common/object-pool.h"
+#include "runtime/mem-tracker.h"
+#include "util/bit-util.h"
+
+#include "common/names.h"
+
+namespace impala {
+
+BitmapFilter::BitmapFilter(int64_t max_bytes, MemTracker* mem_tracker)
+  : max_words_(MaxWords(max_bytes)), mem_tracker_(mem_tracker) {}
+
+void BitmapFilter::Close() {
+  mem_tracker_->Release(words_.size() * sizeof(uint64_t));
+  vector<uint64_t>().swap(words_);
+}
+
+bool BitmapFilter::IsSupportedType(const ColumnType& type) {
+  switch (type.type) {
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_DATE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void BitmapFilter::Insert(const void* val, const ColumnType& type) noexcept {
+  if (UNLIKELY(val == nullptr)) {
+    contains_null_ = true;
+    return;
+  }
+  Insert(GetValue(val, type));
+}
+
+void BitmapFilter::SetAlwaysTrue() {
+  always_true_ = true;
+  Close();
+}
+
+void BitmapFilter::Extend(int64_t word) {
+  DCHECK(!Covers(word));
+  int64_t size = words_.size();
+  int64_t lo = size == 0 ? word : std::min(base_word_, word);
+  int64_t hi = size == 0 ? word : std::max(base_word_ + size - 1, word);
+  // Computed as unsigned to not overflow for BIGINT.
+  uint64_t needed = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo) + 1;
+  if (needed > static_cast<uint64_t>(max_words_)) {
+    VLOG(3) << "Bitmap filter range exceeds " << max_words_ << " words. Disabled.";
+    SetAlwaysTrue();
+    return;
+  }
+  // Grow geometrically so that the cost of copying the words is amortized. The new
+  // words are added on the side of 'word' since more values are likely to come from
+  // there, e.g. if the build side is sorted.
+  int64_t new_size = std::min(max_words_,
+      std::max<int64_t>({static_cast<int64_t>(needed), 2 * size, MIN_WORDS}));
+  int64_t new_base = (size > 0 && word < base_word_) ? hi - new_size + 1 : lo;
+  if (!mem_tracker_->TryConsume((new_size - size) * sizeof(uint64_t))) {
+    VLOG(3) << "Could not allocate " << new_size << " words for bitmap filter. Disabled.";
+    SetAlwaysTrue();
+    return;
+  }
+  vector<uint64_t> new_words(new_size, 0);
+  if (size > 0) {
+    std::copy(words_.begin(), words_.end(), new_words.begin() + (base_word_ - new_base));
+  }
+  words_.swap(new_words);
+  base_word_ = new_base;
+}
+
+bool BitmapFilter::AnyInRange(int64_t lo, int64_t hi) const {
+  if (always_true_) return true;
+  lo = std::max(lo, min_);
+  hi = std::min(hi, max_);
+  if (lo > hi) return false;
+  // 'words_' covers [min_, max_] so all the words below are valid.
+  int64_t first = WordOf(lo) - base_word_;
+  int64_t last = WordOf(hi) - base_word_;
+  uint64_t first_mask = ~0ULL << (lo & 63);
+  uint64_t last_mask = ~0ULL >> (63 - (hi & 63));
+  if (first == last) return (words_[first] & first_mask & last_mask) != 0;
+  if ((words_[first] & first_mask) != 0) return true;
+  for (int64_t i = first + 1; i < last; ++i) {
+    if (words_[i] != 0) return true;
+  }
+  return (words_[last] & last_mask) != 0;
+}
+
+void BitmapFilter::Or(const BitmapFilter& other) {
+  if (always_true_) return;
+  if (other.always_true_) {
+    SetAlwaysTrue();
+    return;
+  }
+  contains_null_ |= other.contains_null_;
+  if (other.IsEmpty()) return;
+  int64_t first = WordOf(other.min_);
+  int64_t last = WordOf(other.max_);
+  for (int64_t word : {first, last}) {
+    if (!Covers(word)) Extend(word);
+    if (always_true_) return;
+  }
+  for (int64_t word = first; word <= last; ++word) {
+    words_[word - base_word_] |= other.words_[word - other.base_word_];
+  }
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+string BitmapFilter::DebugString() const {
+  std::stringstream ss;
+  ss << "Bitmap filter";
+  if (always_true_) {
+    ss << " (always true)";
+  } else if (IsEmpty()) {
+    ss << " (empty)";
+  } else {
+    int64_t num_values = 0;
+    for (uint64_t word : words_) num_values += BitUtil::Popcount(word);
+    ss << " of " << num_values << " values in [" << min_ << ", " << max_ << "], "
+       << words_.size() << " words";
+  }
+  if (contains_null_) ss << " with NULL";
+  return ss.str();
+}
+
+BitmapFilter* BitmapFilter::Create(const BitmapFilterPB& protobuf, int64_t max_bytes,
+    ObjectPool* pool, MemTracker* mem_tracker) {
+  BitmapFilter* filter = pool->Add(new BitmapFilter(max_bytes, mem_tracker));
+  if (protobuf.always_true()) {
+    filter->always_true_ = true;
+    return filter;
+  }
+  if (!IsValid(protobuf)) {
+    LOG(WARNING) << "Invalid bitmap filter: " << DebugString(protobuf);
+    filter->always_true_ = true;
+    return filter;
+  }
+  filter->contains_null_ = protobuf.contains_null();
+  if (!protobuf.has_min()) return filter;
+  int64_t num_words = protobuf.words_size();
+  if (num_words > filter->max_words_
+      || !mem_tracker->TryConsume(num_words * sizeof(uint64_t))) {
+    filter->always_true_ = true;
+    return filter;
+  }
+  filter->words_.assign(protobuf.words().begin(), protobuf.words().end());
+  filter->base_word_ = WordOf(protobuf.min());
+  filter->min_ = protobuf.min();
+  filter->max_ = protobuf.max();
+  return filter;
+}
+
+void BitmapFilter::ToProtobuf(const BitmapFilter* filter, BitmapFilterPB* protobuf) {
+  DCHECK(protobuf != nullptr);
+  if (filter == nullptr || filter->always_true_) {
+    protobuf->set_always_true(true);
+    return;
+  }
+  protobuf->set_always_true(false);
+  protobuf->set_contains_null(filter->contains_null_);
+  if (filter->IsEmpty()) return;
+  protobuf->set_min(filter->min_);
+  protobuf->set_max(filter->max_);
+  int64_t first = WordOf(filter->min_) - filter->base_word_;
+  int64_t last = WordOf(filter->max_) - filter->base_word_;
+  protobuf->mutable_words()->Reserve(last - first + 1);
+  for (int64_t i = first; i <= last; ++i) protobuf->add_words(filter->words_[i]);
+}
+
+void BitmapFilter::Or(const BitmapFilterPB& in, BitmapFilterPB* out, int64_t max_bytes) {
+  if (out->always_true()) return;
+  if (in.always_true() || !IsValid(in)) {
+    LOG_IF(WARNING, !in.always_true()) << "Invalid bitmap filter: " << DebugString(in);
+    out->Clear();
+    out->set_always_true(true);
+    return;
+  }
+  DCHECK(IsValid(*out));
+  if (in.contains_null()) out->set_contains_null(true);
+  if (!in.has_min()) return;
+  if (!out->has_min()) {
+    out->set_min(in.min());
+    out->set_max(in.max());
+    *out->mutable_words() = in.words();
+    return;
+  }
+  int64_t min_val = std::min(in.min(), out->min());
+  int64_t max_val = std::max(in.max(), out->max());
+  int64_t first = WordOf(min_val);
+  // Computed as unsigned to not overflow for BIGINT.
+  uint64_t num_words =
+      static_cast<uint64_t>(WordOf(max_val)) - static_cast<uint64_t>(first) + 1;
+  if (num_words > static_cast<uint64_t>(MaxWords(max_bytes))) {
+    out->Clear();
+    out->set_always_true(true);
+    return;
+  }
+  google::protobuf::RepeatedField<uint64_t> words;
+  words.Resize(num_words, 0);
+  for (const BitmapFilterPB* pb : {&in, static_cast<const BitmapFilterPB*>(out)}) {
+    uint64_t* dst = words.mutable_data() + (WordOf(pb->min()) - first);
+    for (int i = 0; i < pb->words_size(); ++i) dst[i] |= pb->words(i);
+  }
+  out->mutable_words()->Swap(&words);
+  out->set_min(min_val);
+  out->set_max(max_val);
+}
+
+bool BitmapFilter::IsValid(const BitmapFilterPB& filter) {
+  if (filter.always_true()) return true;
+  if (!filter.has_min()) return !filter.has_max() && filter.words_size() == 0;
+  if (!filter.has_max() || filter.min() > filter.max()) return false;
+  // Computed as unsigned to not overflow for BIGINT.
+  uint64_t num_words = static_cast<uint64_t>(WordOf(filter.max()))
+      - static_cast<uint64_t>(WordOf(filter.min())) + 1;
+  return static_cast<uint64_t>(filter.words_size()) == num_words;
+}
+
+bool BitmapFilter::AlwaysFalse(const BitmapFilterPB& filter) {
+  return !filter.always_true() && !filter.contains_null() && !filter.has_min();
+}
+
+string BitmapFilter::DebugString(const BitmapFilterPB& filter) {
+  std::stringstream ss;
+  ss << "Bitmap filter";
+  if (filter.always_true()) {
+    ss << " (always true)";
+  } else if (!filter.has_min()) {
+    ss << " (empty)";
+  } else {
+    ss << " of [" << filter.min() << ", " << filter.max() << "], "
+       << filter.words_size() << " words";
+  }
+  if (filter.contains_null()) ss << " with NULL";
+  return ss.str();
+}
+
+} // namespace impala
@@ -0,0 +1,216 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "common/compiler-util.h"
+#include "common/logging.h"
+#include "gen-cpp/data_stream_service.pb.h"
+#include "runtime/date-value.h"
+#include "runtime/types.h"
+
+namespace impala {
+
+class MemTracker;
+class ObjectPool;
+
+/// BitmapFilter is an exact set of integer values, stored as one bit per value of the
+/// range between the smallest and the largest value inserted. For join keys that are
+/// dense integers, e.g. surrogate keys of a dimension table, it is smaller than a bloom
+/// filter with the same NDV, has no false positives and is probed with a single load.
+/// Supports TINYINT, SMALLINT, INT, BIGINT and DATE values, which are all widened to
+/// int64_t.
+///
+/// The bitmap is grown on demand to cover the inserted values. Its size is bounded by
+/// 'max_bytes', the filter size computed by the planner, so that it never takes more
+/// memory than a bloom filter for the same join would. If the values span a wider range
+/// than that, the filter is set to always true and its memory is released.
+class BitmapFilter {
+ public:
+  BitmapFilter(int64_t max_bytes, MemTracker* mem_tracker);
+
+  /// Releases the memory of the bitmap.
+  void Close();
+
+  /// Returns true if 'type' can be held by a bitmap filter.
+  static bool IsSupportedType(const ColumnType& type);
+
+  /// Returns the value at 'val' of 'type' widened to int64_t. 'val' must not be null.
+  static inline int64_t GetValue(const void* val, const ColumnType& type);
+
+  /// Adds the value at 'val' of type T, or NULL if 'val' is nullptr. T is the native
+  /// type of the slot, with int32_t for DATE. Cross-compiled for the codegen'd build
+  /// side of the join, see FilterContext::CodegenInsert().
+  template <typename T>
+  void Insert(const void* val) noexcept;
+
+  /// Same as above, for a value of 'type'.
+  void Insert(const void* val, const ColumnType& type) noexcept;
+
+  /// Adds 'v' to the filter.
+  inline void Insert(int64_t v) noexcept;
+
+  /// Returns true if 'v' was inserted into the filter. Does not check AlwaysTrue().
+  inline bool Find(int64_t v) const noexcept;
+
+  /// Returns true if the value at 'val' of 'type', or NULL if 'val' is nullptr, may be in
+  /// the filter. Inlined in the IR of RuntimeFilter::Eval() so that 'type' is constant.
+  inline bool Find(const void* val, const ColumnType& type) const noexcept;
+
+  /// Returns false if no value of [lo, hi] is in the filter, e.g. if a Parquet row group
+  /// or page with these min/max stats can be skipped. Returns true otherwise.
+  bool AnyInRange(int64_t lo, int64_t hi) const;
+
+  bool AlwaysTrue() const { return always_true_; }
+  bool AlwaysFalse() const { return !always_true_ && !contains_null_ && IsEmpty(); }
+  bool ContainsNull() const { return contains_null_; }
+
+  /// Makes this filter always return true and releases the bitmap.
+  void SetAlwaysTrue();
+
+  /// The smallest and largest values in the filter. Only valid if the filter holds any
+  /// non-NULL value.
+  int64_t min() const { return min_; }
+  int64_t max() const { return max_; }
+
+  /// Returns the number of bytes of the bitmap that ToProtobuf() copies, i.e. of the
+  /// words between min() and max().
+  int64_t NumBytes() const {
+    if (always_true_ || IsEmpty()) return 0;
+    return (WordOf(max_) - WordOf(min_) + 1) * sizeof(uint64_t);
+  }
+
+  /// Merges 'other' into this filter.
+  void Or(const BitmapFilter& other);
+
+  std::string DebugString() const;
+
+  /// Returns a new BitmapFilter created from the protobuf representation, allocated from
+  /// 'pool'. Its memory is tracked by 'mem_tracker'. The filter is always true if
+  /// 'protobuf' is not well-formed, see IsValid().
+  static BitmapFilter* Create(const BitmapFilterPB& protobuf, int64_t max_bytes,
+      ObjectPool* pool, MemTracker* mem_tracker);
+
+  /// Converts 'filter' to its protobuf representation. Only the words between min() and
+  /// max() are copied. If 'filter' is nullptr, it is interpreted as a complete filter
+  /// which contains all elements, i.e. always true.
+  static void ToProtobuf(const BitmapFilter* filter, BitmapFilterPB* protobuf);
+
+  /// Merges 'in' into 'out'. 'out' becomes always true if the union of their ranges
+  /// would not fit into 'max_bytes' or if 'in' is not well-formed. Used at the
+  /// coordinator, which aggregates the filters in their protobuf representation.
+  static void Or(const BitmapFilterPB& in, BitmapFilterPB* out, int64_t max_bytes);
+
+  /// Returns true if the words of 'filter' match its [min, max] range. Filters are
+  /// received over the network, so this is checked before the words are accessed.
+  static bool IsValid(const BitmapFilterPB& filter);
+
+  static bool AlwaysFalse(const BitmapFilterPB& filter);
+  static std::string DebugString(const BitmapFilterPB& filter);
+
+  /// Returns the maximum number of 64-bit words in a filter of 'max_bytes'.
+  static int64_t MaxWords(int64_t max_bytes) {
+    return std::max<int64_t>(1, max_bytes / sizeof(uint64_t));
+  }
+
+ private:
+  /// Minimum number of words allocated when the bitmap is first grown.
+  static const int64_t MIN_WORDS = 8;
+
+  /// Returns the index of the word holding 'v' if 'base_word_' was 0. Also valid for
+  /// negative values, which gives the floor of v / 64.
+  static int64_t WordOf(int64_t v) { return v >> 6; }
+
+  bool IsEmpty() const { return min_ > max_; }
+
+  /// Returns true if 'words_' holds the bits of 'word'. Words below 'base_word_' wrap
+  /// around to a large index. Computed as unsigned to not overflow for BIGINT.
+  bool Covers(int64_t word) const {
+    return static_cast<uint64_t>(word) - static_cast<uint64_t>(base_word_)
+        < words_.size();
+  }
+
+  /// Grows 'words_' so that it covers 'word'. Sets the filter to always true instead if
+  /// the covered range would exceed 'max_words_' or if the memory can not be allocated.
+  void Extend(int64_t word);
+
+  /// Maximum number of words in 'words_'.
+  const int64_t max_words_;
+
+  /// Tracks the memory of 'words_'.
+  MemTracker* const mem_tracker_;
+
+  /// Bit i of words_[j] is set iff the value 64 * (base_word_ + j) + i is in the filter.
+  int64_t base_word_ = 0;
+  std::vector<uint64_t> words_;
+
+  /// The smallest and largest values inserted. min_ > max_ if none were inserted.
+  int64_t min_ = std::numeric_limits<int64_t>::max();
+  int64_t max_ = std::numeric_limits<int64_t>::min();
+
+  bool always_true_ = false;
+  bool contains_null_ = false;
+};
+
+inline int64_t BitmapFilter::GetValue(const void* val, const ColumnType& type) {
+  switch (type.type) {
+    case TYPE_TINYINT:
+      return *reinterpret_cast<const int8_t*>(val);
+    case TYPE_SMALLINT:
+      return *reinterpret_cast<const int16_t*>(val);
+    case TYPE_INT:
+      return *reinterpret_cast<const int32_t*>(val);
+    case TYPE_BIGINT:
+      return *reinterpret_cast<const int64_t*>(val);
+    case TYPE_DATE:
+      return reinterpret_cast<const DateValue*>(val)->Value();
+    default:
+      DCHECK(false) << "Not supported bitmap filter type: " << type;
+      return 0;
+  }
+}
+
+inline void BitmapFilter::Insert(int64_t v) noexcept {
+  if (UNLIKELY(always_true_)) return;
+  int64_t word = WordOf(v);
+  if (UNLIKELY(!Covers(word))) {
+    Extend(word);
+    if (UNLIKELY(always_true_)) return;
+  }
+  words_[word - base_word_] |= 1ULL << (v & 63);
+  if (v < min_) min_ = v;
+  if (v > max_) max_ = v;
+}
+
+inline bool BitmapFilter::Find(int64_t v) const noexcept {
+  int64_t word = WordOf(v);
+  if (!Covers(word)) return false;
+  return (words_[word - base_word_] >> (v & 63)) & 1;
+}
+
+inline bool BitmapFilter::Find(const void* val, const ColumnType& type) const noexcept {
+  if (val == nullptr) return contains_null_;
+  return Find(GetValue(val, type));
+}
+
+} // namespace impala
@@ -455,5 +455,69 @@ TEST_F(BloomFilterTest, ProtobufOr) {
   ASSERT_FALSE(BfFind(*bf4, 81));
 }
 
+// A folded filter must find every element of the original filter.
+TEST_F(BloomFilterTest, Fold) {
+  const int log_space = BloomFilter::MinLogSpace(10000, 0.01);
+  const int folded_log_space = BloomFilter::MinLogSpace(100, 0.01);
+  ASSERT_LT(folded_log_space, log_space);
+  BloomFilter* bf = CreateBloomFilter(log_space);
+  vector<uint32_t> hashes;
+  for (int i = 0; i < 100; ++i) hashes.push_back(MakeRand());
+  for (uint32_t hash : hashes) BfInsert(*bf, hash);
+
+  // The folded copy can not be charged to a tracker without room for it, so the filter
+  // is left unchanged.
+  MemTracker limited_tracker(
+      BloomFilter::GetExpectedMemoryUsed(folded_log_space) - 1, "limited");
+  ASSERT_OK(bf->Fold(folded_log_space, &limited_tracker));
+  EXPECT_EQ(log_space, bf->log_bufferpool_space());
+  EXPECT_EQ(0, limited_tracker.consumption());
+
+  // The copy of the folded buckets is released again.
+  int64_t consumption = tracker_->consumption();
+  ASSERT_OK(bf->Fold(folded_log_space, tracker_.get()));
+  EXPECT_EQ(consumption, tracker_->consumption());
+  EXPECT_EQ(folded_log_space, bf->log_bufferpool_space());
+  EXPECT_EQ(BloomFilter::GetExpectedMemoryUsed(folded_log_space),
+      bf->GetBufferPoolSpaceUsed());
+  EXPECT_FALSE(bf->AlwaysFalse());
+  for (uint32_t hash : hashes) ASSERT_TRUE(BfFind(*bf, hash)) << hash;
+
+  // Folding to a larger size does nothing, and an empty filter stays empty.
+  ASSERT_OK(bf->Fold(log_space, tracker_.get()));
+  EXPECT_EQ(folded_log_space, bf->log_bufferpool_space());
+  BloomFilter* empty = CreateBloomFilter(log_space);
+  ASSERT_OK(empty->Fold(folded_log_space, tracker_.get()));
+  EXPECT_EQ(folded_log_space, empty->log_bufferpool_space());
+  EXPECT_TRUE(empty->AlwaysFalse());
+}
+
+// A filter folded in its Protobuf representation finds every element of the original
+// filter and can be OR-ed with a filter of the folded size.
+TEST_F(BloomFilterTest, FoldProtobuf) {
+  const int large_log_space = BloomFilter::MinLogSpace(10000, 0.01);
+  const int small_log_space = BloomFilter::MinLogSpace(100, 0.01);
+  BloomFilter* large = CreateBloomFilter(large_log_space);
+  BloomFilter* small = CreateBloomFilter(small_log_space);
+  for (int i = 0; i < 50; ++i) BfInsert(*large, i);
+  for (int i = 50; i < 100; ++i) BfInsert(*small, i);
+
+  BloomFilterPB large_pb;
+  RpcController controller;
+  BloomFilter::ToProtobuf(large, &controller, &large_pb);
+  kudu::Slice large_directory = large->GetBlockBloomFilter()->directory();
+  string directory(
+      reinterpret_cast<const char*>(large_directory.data()), large_directory.size());
+  BloomFilter::Fold(small_log_space, &large_pb, &directory);
+  EXPECT_EQ(small_log_space, large_pb.log_bufferpool_space());
+  EXPECT_EQ(BloomFilter::GetExpectedMemoryUsed(small_log_space), directory.size());
+  BloomFilter* folded = CreateBloomFilter(large_pb, directory);
+  for (int i = 0; i < 50; ++i) ASSERT_TRUE(BfFind(*folded, i)) << i;
+
+  small->Or(*folded);
+  EXPECT_EQ(small_log_space, small->log_bufferpool_space());
+  for (int i = 0; i < 100; ++i) ASSERT_TRUE(BfFind(*small, i)) << i;
+}
+
 }  // namespace impala
 
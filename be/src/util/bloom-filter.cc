@@ -36,6 +36,7 @@
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 #include "runtime/exec-env.h"
+#include "runtime/mem-tracker.h"
 #include "util/kudu-status-util.h"
 
 using namespace std;
@@ -50,6 +51,7 @@ BloomFilter::BloomFilter(BufferPool::ClientHandle* client)
 BloomFilter::~BloomFilter() {}
 
 Status BloomFilter::Init(const int log_bufferpool_space, uint32_t hash_seed) {
+  hash_seed_ = hash_seed;
   KUDU_RETURN_IF_ERROR(
       block_bloom_filter_.Init(log_bufferpool_space, kudu::FAST_HASH, hash_seed),
       "Failed to init Block Bloom Filter");
@@ -58,6 +60,7 @@ Status BloomFilter::Init(const int log_bufferpool_space, uint32_t hash_seed) {
 
 Status BloomFilter::Init(const BloomFilterPB& protobuf, const uint8_t* directory_in,
     size_t directory_in_size, uint32_t hash_seed) {
+  hash_seed_ = hash_seed;
   if (protobuf.always_false() || directory_in_size == 0) {
     // Directory size equal 0 only when it's always false.
     KUDU_RETURN_IF_ERROR(block_bloom_filter_.Init(
@@ -140,6 +143,18 @@ int64_t BloomFilter::GetBufferPoolSpaceUsed() {
   return buffer_allocator_.IsAllocated() ? block_bloom_filter_.GetSpaceUsed() : -1;
 }
 
+/// Folds the 'directory_size' bytes at 'directory' in halves until 'target_size' bytes
+/// remain, OR-ing the upper half into the lower half each time.
+static void FoldDirectory(uint8_t* directory, int64_t directory_size,
+    int64_t target_size) {
+  DCHECK_LE(target_size, directory_size);
+  while (directory_size > target_size) {
+    directory_size /= 2;
+    kudu::BlockBloomFilter::OrEqualArray(
+        directory_size, directory + directory_size, directory);
+  }
+}
+
 void BloomFilter::Or(const BloomFilter& other) {
   DCHECK_NE(this, &other);
   DCHECK_NE(&other, ALWAYS_TRUE_FILTER);
@@ -149,6 +164,44 @@ void BloomFilter::Or(const BloomFilter& other) {
   block_bloom_filter_.Or(other.block_bloom_filter_);
 }
 
+Status BloomFilter::Fold(int log_bufferpool_space, MemTracker* tracker) {
+  if (log_bufferpool_space >= block_bloom_filter_.log_space_bytes()) return Status::OK();
+  if (block_bloom_filter_.always_false()) return Init(log_bufferpool_space, hash_seed_);
+  int64_t folded_size = GetExpectedMemoryUsed(log_bufferpool_space);
+  if (!tracker->TryConsume(folded_size)) {
+    VLOG(2) << "Not enough memory to fold bloom filter of "
+            << block_bloom_filter_.GetSpaceUsed() << " bytes to " << folded_size;
+    return Status::OK();
+  }
+  // The directory belongs to this filter and is replaced below, so it can be folded in
+  // place. Only the folded buckets are copied out while the directory is reallocated.
+  kudu::Slice directory = block_bloom_filter_.directory();
+  uint8_t* directory_data = const_cast<uint8_t*>(directory.data());
+  FoldDirectory(directory_data, directory.size(), folded_size);
+  kudu::Status status;
+  {
+    string folded(reinterpret_cast<const char*>(directory_data), folded_size);
+    status = block_bloom_filter_.InitFromDirectory(log_bufferpool_space,
+        kudu::Slice(folded), false, kudu::FAST_HASH, hash_seed_);
+  }
+  tracker->Release(folded_size);
+  KUDU_RETURN_IF_ERROR(status, "Failed to fold Block Bloom Filter");
+  return Status::OK();
+}
+
+void BloomFilter::Fold(
+    int log_bufferpool_space, BloomFilterPB* protobuf, string* directory) {
+  DCHECK(!protobuf->always_false());
+  DCHECK(!protobuf->always_true());
+  if (log_bufferpool_space >= protobuf->log_bufferpool_space()) return;
+  int64_t folded_size =
+      kudu::BlockBloomFilter::GetExpectedMemoryUsed(log_bufferpool_space);
+  FoldDirectory(reinterpret_cast<uint8_t*>(&(*directory)[0]), directory->size(),
+      folded_size);
+  directory->resize(folded_size);
+  protobuf->set_log_bufferpool_space(log_bufferpool_space);
+}
+
 void BloomFilter::Or(const BloomFilterPB& in, const uint8_t* directory_in,
     BloomFilterPB* out, uint8_t* directory_out, size_t directory_size) {
   DCHECK(out != nullptr);
@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <cstring>
 #include <limits>
+#include <string>
 
 #ifndef __aarch64__
 #include <immintrin.h>
@@ -47,6 +48,7 @@ class RpcController;
 namespace impala {
 class BloomFilter;
 class BloomFilterPB;
+class MemTracker;
 } // namespace impala
 
 // Need this forward declaration since we make bloom_filter_test_util::BfUnion() a friend
@@ -118,6 +120,26 @@ class BloomFilter {
   /// filter.
   void Or(const BloomFilter& other);
 
+  /// Shrinks the filter to (1 << log_bufferpool_space) bytes if it is larger. A smaller
+  /// filter with the same elements can be obtained by OR-ing together the buckets that
+  /// only differ in the high bits of their index, because Find() picks the bucket from
+  /// the low bits of the hash. The false positive rate of the result is the one of a
+  /// filter of the new size with the same number of elements. The directory is
+  /// reallocated from the same buffer pool client, so this never needs more reservation
+  /// than the filter already has. The folded buckets are copied out while the directory
+  /// is reallocated, which is charged to 'tracker'. If 'tracker' can not hold the copy,
+  /// the filter is left unchanged. If an error is returned, the filter is lost.
+  Status Fold(int log_bufferpool_space, MemTracker* tracker);
+
+  /// Same as above for a filter in its Protobuf representation. 'directory' holds the
+  /// directory of the filter and is shrunk in place. 'protobuf' must not be always true
+  /// or always false.
+  static void Fold(
+      int log_bufferpool_space, BloomFilterPB* protobuf, std::string* directory);
+
+  /// Returns the log (base 2) of the size of the directory in bytes.
+  int log_bufferpool_space() const { return block_bloom_filter_.log_space_bytes(); }
+
   /// This function computes the logical OR of 'directory_in' with 'directory_out'
   /// and stores the result in 'directory_out'. 'in' must be a valid filter object
   /// (i.e. not ALWAYS_TRUE_FILTER).
@@ -179,6 +201,9 @@ class BloomFilter {
   /// Embedded Kudu BlockBloomFilter object
   kudu::BlockBloomFilter block_bloom_filter_;
 
+  /// The hash seed passed to Init(). Used to re-initialize the filter when it is folded.
+  uint32_t hash_seed_ = 0;
+
   /// Serializes this filter as Protobuf.
   void ToProtobuf(BloomFilterPB* protobuf, kudu::rpc::RpcController* controller) const;
 
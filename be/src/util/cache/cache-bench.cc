@@ -18,6 +18,7 @@
 #include <atomic>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -44,6 +45,8 @@
 DEFINE_int32(num_threads, 16, "The number of threads to access the cache concurrently.");
 DEFINE_int32(run_seconds, 1, "The number of seconds to run the benchmark");
 DEFINE_string(eviction_policy, "LRU", "The eviction policy to use for the cache.");
+DEFINE_string(admission_policy, "ALWAYS", "The admission policy to use for the cache "
+    "unless the test case sets one.");
 
 using std::atomic;
 using std::pair;
@@ -66,7 +69,11 @@ struct BenchSetup {
     // vast majority of lookups.
     ZIPFIAN,
     // Every item is equally likely to be looked up.
-    UNIFORM
+    UNIFORM,
+    // Zipfian lookups interleaved with a scan: every other lookup is for the next
+    // key of a sequence of keys which are never looked up again. This mimics large
+    // scans competing with a hot working set.
+    ZIPFIAN_SCAN
   };
   Pattern pattern;
 
@@ -76,13 +83,18 @@ struct BenchSetup {
   // in the cache.
   double dataset_cache_ratio;
 
+  // The admission policy to use. Unset to use --admission_policy.
+  string admission_policy = "";
+
   string ToString() const {
     string ret;
     switch (pattern) {
       case Pattern::ZIPFIAN: ret += "ZIPFIAN"; break;
       case Pattern::UNIFORM: ret += "UNIFORM"; break;
+      case Pattern::ZIPFIAN_SCAN: ret += "ZIPFIAN_SCAN"; break;
     }
     ret += StringPrintf(" ratio=%.2fx n_unique=%d", dataset_cache_ratio, max_key());
+    if (!admission_policy.empty()) ret += " admission=" + admission_policy;
     return ret;
   }
 
@@ -96,8 +108,12 @@ class CacheBench : public testing::Test,
                    public testing::WithParamInterface<BenchSetup>{
  public:
   void SetUp() override {
+    const BenchSetup& setup = GetParam();
+    const string& admission_policy = setup.admission_policy.empty() ?
+        FLAGS_admission_policy : setup.admission_policy;
     cache_.reset(NewCache(Cache::ParseEvictionPolicy(FLAGS_eviction_policy),
-        kCacheCapacity, "test-cache"));
+        kCacheCapacity, "test-cache", Cache::ParseAdmissionPolicy(admission_policy),
+        kCacheCapacity / kEntrySize));
     Status status = cache_->Init();
     ASSERT_OK(status);
   }
@@ -114,7 +130,13 @@ class CacheBench : public testing::Test,
     if (max_key == 0) return {0, 0};
     while (!*done) {
       uint32_t int_key;
-      if (setup.pattern == BenchSetup::Pattern::ZIPFIAN) {
+      if (setup.pattern == BenchSetup::Pattern::ZIPFIAN_SCAN && (lookups & 1)) {
+        // Scanned keys are above the keys of the working set. Each thread scans
+        // different keys.
+        int_key = max_key + next_scan_key_.fetch_add(1, std::memory_order_relaxed) %
+            (std::numeric_limits<uint32_t>::max() - max_key);
+      } else if (setup.pattern == BenchSetup::Pattern::ZIPFIAN ||
+          setup.pattern == BenchSetup::Pattern::ZIPFIAN_SCAN) {
         int_key = r.Skewed(Bits::Log2Floor(max_key));
       } else {
         int_key = r.Uniform(max_key);
@@ -159,6 +181,9 @@ class CacheBench : public testing::Test,
 
  protected:
   unique_ptr<Cache> cache_;
+
+  // The next key to look up by the scans of the ZIPFIAN_SCAN pattern.
+  atomic<uint64_t> next_scan_key_{0};
 };
 
 // Test both distributions, and for each, test both the case where the data
@@ -169,6 +194,11 @@ INSTANTIATE_TEST_CASE_P(Patterns, CacheBench, testing::ValuesIn(std::vector<Benc
       {BenchSetup::Pattern::UNIFORM, 1.0},
       {BenchSetup::Pattern::UNIFORM, 3.0},
       {BenchSetup::Pattern::UNIFORM, 500.0},
+      // Compare the admission policies on a hot working set competing with scans.
+      {BenchSetup::Pattern::ZIPFIAN_SCAN, 0.5, "ALWAYS"},
+      {BenchSetup::Pattern::ZIPFIAN_SCAN, 0.5, "TINYLFU"},
+      {BenchSetup::Pattern::ZIPFIAN_SCAN, 3.0, "ALWAYS"},
+      {BenchSetup::Pattern::ZIPFIAN_SCAN, 3.0, "TINYLFU"},
     }));
 
 TEST_P(CacheBench, RunBench) {
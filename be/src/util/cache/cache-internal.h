@@ -16,6 +16,7 @@
 #include "kudu/util/malloc.h"
 #include "kudu/util/mem_tracker.h"
 #include "kudu/util/slice.h"
+#include "util/cache/frequency-sketch.h"
 
 using kudu::Slice;
 using std::shared_ptr;
@@ -205,6 +206,12 @@ class CacheShard {
   virtual void Release(HandleBase* handle) = 0;
   virtual void Erase(const Slice& key, uint32_t hash) = 0;
   virtual size_t Invalidate(const Cache::InvalidationControl& ctl) = 0;
+
+  // Used by the admission policy. Returns true and sets 'victim_hash' to the hash of
+  // the entry which would be evicted first if an entry with charge 'charge' were
+  // inserted now. Returns false if the insertion wouldn't evict anything. This is only
+  // a snapshot: concurrent operations may change the victim.
+  virtual bool EvictionCandidate(size_t charge, uint32_t* victim_hash) = 0;
 };
 
 // Function to build a cache shard using the given eviction algorithm.
@@ -223,8 +230,10 @@ CacheShard* NewCacheShardInt(kudu::MemTracker* mem_tracker, size_t capacity);
 // the cache shard. This, in turn, determines the number of shards.
 int DetermineShardBits();
 
-// Helper function to provide a string representation of an eviction policy.
+// Helper functions to provide a string representation of an eviction policy and
+// an admission policy.
 string ToString(Cache::EvictionPolicy p);
+string ToString(Cache::AdmissionPolicy p);
 
 // This is a minimal sharding cache implementation. It passes almost all functions
 // through to the underlying CacheShard unless the function can be answered by the
@@ -232,7 +241,8 @@ string ToString(Cache::EvictionPolicy p);
 // do a right shift to get the shard index.
 class ShardedCache : public Cache {
  public:
-  explicit ShardedCache(Cache::EvictionPolicy policy, size_t capacity, const string& id)
+  explicit ShardedCache(Cache::EvictionPolicy policy, size_t capacity, const string& id,
+      Cache::AdmissionPolicy admission_policy, int64_t expected_entries)
       : shard_bits_(DetermineShardBits()) {
     // A cache is often a singleton, so:
     // 1. We reuse its MemTracker if one already exists, and
@@ -247,6 +257,14 @@ class ShardedCache : public Cache {
     for (int s = 0; s < num_shards; ++s) {
       shards_.push_back(NewCacheShard(policy, mem_tracker_.get(), per_shard));
     }
+    if (admission_policy == Cache::AdmissionPolicy::TINY_LFU) {
+      DCHECK_GT(expected_entries, 0);
+      const int64_t per_shard_entries =
+          (expected_entries + (num_shards - 1)) / num_shards;
+      for (int s = 0; s < num_shards; ++s) {
+        sketches_.emplace_back(new FrequencySketch(per_shard_entries));
+      }
+    }
   }
 
   virtual ~ShardedCache() {
@@ -262,6 +280,7 @@ class ShardedCache : public Cache {
 
   UniqueHandle Lookup(const Slice& key, LookupBehavior behavior) override {
     const uint32_t hash = HashSlice(key);
+    if (!sketches_.empty() && behavior == NORMAL) sketches_[Shard(hash)]->Increment(hash);
     HandleBase* h = shards_[Shard(hash)]->Lookup(key, hash, behavior == NO_UPDATE);
     return UniqueHandle(reinterpret_cast<Cache::Handle*>(h), Cache::HandleDeleter(this));
   }
@@ -278,7 +297,16 @@ class ShardedCache : public Cache {
   UniqueHandle Insert(UniquePendingHandle handle,
       Cache::EvictionCallback* eviction_callback) override {
     HandleBase* h_in = reinterpret_cast<HandleBase*>(DCHECK_NOTNULL(handle.release()));
-    HandleBase* h_out = shards_[Shard(h_in->hash())]->Insert(h_in, eviction_callback);
+    CacheShard* shard = shards_[Shard(h_in->hash())];
+    if (!sketches_.empty() && !Admit(h_in)) {
+      // Same as a failed insertion into the shard.
+      if (eviction_callback != nullptr) {
+        eviction_callback->EvictedEntry(h_in->key(), h_in->value());
+      }
+      shard->Free(h_in);
+      return UniqueHandle(nullptr, Cache::HandleDeleter(this));
+    }
+    HandleBase* h_out = shard->Insert(h_in, eviction_callback);
     return UniqueHandle(reinterpret_cast<Cache::Handle*>(h_out),
         Cache::HandleDeleter(this));
   }
@@ -319,6 +347,10 @@ class ShardedCache : public Cache {
   shared_ptr<kudu::MemTracker> mem_tracker_;
   vector<CacheShard*> shards_;
 
+  // Frequency sketch of each shard for AdmissionPolicy::TINY_LFU. Empty with
+  // AdmissionPolicy::ALWAYS.
+  vector<unique_ptr<FrequencySketch>> sketches_;
+
   // Number of bits of hash used to determine the shard.
   const int shard_bits_;
 
@@ -326,6 +358,18 @@ class ShardedCache : public Cache {
     return util_hash::CityHash64(reinterpret_cast<const char *>(s.data()), s.size());
   }
 
+  // Returns true if 'handle' should be inserted according to TinyLFU: if inserting it
+  // would evict another entry, its key must be more frequent than the victim's.
+  bool Admit(HandleBase* handle) {
+    const uint32_t hash = handle->hash();
+    uint32_t victim_hash;
+    if (!shards_[Shard(hash)]->EvictionCandidate(handle->charge(), &victim_hash)) {
+      return true;
+    }
+    const FrequencySketch& sketch = *sketches_[Shard(hash)];
+    return sketch.Frequency(hash) > sketch.Frequency(victim_hash);
+  }
+
   uint32_t Shard(uint32_t hash) {
     // Widen to uint64 before shifting, or else on a single CPU,
     // we would try to shift a uint32_t by 32 bits, which is undefined.
@@ -16,6 +16,7 @@
 
 #include "kudu/util/mem_tracker.h"
 #include "testutil/gtest-util.h"
+#include "util/cache/frequency-sketch.h"
 
 DECLARE_bool(cache_force_single_shard);
 
@@ -191,5 +192,100 @@ TEST_P(CacheTest, HeavyEntries) {
   ASSERT_LE(cached_weight, cache_size() + cache_size() / 10);
 }
 
-}  // namespace impala
+class CacheAdmissionTest :
+    public CacheBaseTest,
+    public ::testing::WithParamInterface<Cache::EvictionPolicy> {
+ public:
+  CacheAdmissionTest()
+      : CacheBaseTest(100) {
+  }
+
+  void SetUp() override {
+    FLAGS_cache_force_single_shard = true;
+    // The sketch is oversized to make collisions between keys unlikely.
+    cache_.reset(NewCache(GetParam(), cache_size(), "cache_admission_test",
+        Cache::AdmissionPolicy::TINY_LFU, 10 * cache_size()));
+    ASSERT_OK(cache_->Init());
+  }
+
+  // Looks up 'key' and inserts it on a miss, like a typical caller would. Returns true
+  // if the key is cached afterwards.
+  bool LookupOrInsert(int key) {
+    if (Lookup(key) != -1) return true;
+    return Insert(key, key);
+  }
+};
+
+INSTANTIATE_TEST_CASE_P(
+    CacheTypes, CacheAdmissionTest,
+    ::testing::Values(Cache::EvictionPolicy::FIFO, Cache::EvictionPolicy::LRU,
+        Cache::EvictionPolicy::LIRS));
+
+// Tests that a scan of keys which are only accessed once doesn't evict a frequently
+// accessed working set with the TinyLFU admission policy.
+TEST_P(CacheAdmissionTest, ScanResistance) {
+  // Entries are admitted unconditionally while the cache has space.
+  const int num_hot_keys = cache_size();
+  for (int i = 0; i < num_hot_keys; ++i) ASSERT_TRUE(LookupOrInsert(i));
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < num_hot_keys; ++i) ASSERT_TRUE(LookupOrInsert(i));
+  }
+  ASSERT_TRUE(evicted_keys_.empty());
 
+  // A key accessed more often than the hot keys is admitted and evicts one of them.
+  const int frequent_key = 100000;
+  for (int i = 0; i < 10; ++i) Lookup(frequent_key);
+  ASSERT_TRUE(LookupOrInsert(frequent_key));
+  ASSERT_EQ(1, evicted_keys_.size());
+  ASSERT_NE(frequent_key, evicted_keys_[0]);
+  evicted_keys_.clear();
+
+  // None of the scanned keys are admitted. Rejected entries go through the eviction
+  // callback.
+  const int num_scan_keys = 5 * cache_size();
+  for (int i = 0; i < num_scan_keys; ++i) {
+    ASSERT_FALSE(LookupOrInsert(num_hot_keys + i));
+  }
+  ASSERT_EQ(num_scan_keys, evicted_keys_.size());
+  ASSERT_GE(Lookup(frequent_key), 0);
+  int num_hot_keys_cached = 0;
+  for (int i = 0; i < num_hot_keys; ++i) {
+    if (Lookup(i, Cache::NO_UPDATE) != -1) ++num_hot_keys_cached;
+  }
+  ASSERT_EQ(num_hot_keys - 1, num_hot_keys_cached);
+}
+
+TEST(FrequencySketchTest, Basic) {
+  FrequencySketch sketch(1024);
+  ASSERT_EQ(0, sketch.Frequency(1));
+  for (int i = 1; i <= 5; ++i) {
+    sketch.Increment(1);
+    ASSERT_EQ(i, sketch.Frequency(1));
+  }
+  ASSERT_EQ(0, sketch.Frequency(2));
+  // Counters saturate.
+  for (int i = 0; i < 100; ++i) sketch.Increment(3);
+  ASSERT_EQ(FrequencySketch::MAX_FREQUENCY, sketch.Frequency(3));
+}
+
+TEST(FrequencySketchTest, Aging) {
+  const int expected_entries = 64;
+  FrequencySketch sketch(expected_entries);
+  for (int i = 0; i < 8; ++i) sketch.Increment(1);
+  ASSERT_EQ(8, sketch.Frequency(1));
+  // Counters are halved after 10 increments per expected entry. Other keys may collide
+  // with the counters of key 1, so only the ratio of the estimates is checked.
+  int num_increments = 8;
+  uint32_t hash = 2;
+  while (num_increments < 10 * expected_entries - 1) {
+    sketch.Increment(hash++);
+    ++num_increments;
+  }
+  int frequency_before = sketch.Frequency(1);
+  ASSERT_GE(frequency_before, 8);
+  sketch.Increment(hash);
+  ASSERT_GE(sketch.Frequency(1), frequency_before / 2);
+  ASSERT_LE(sketch.Frequency(1), (frequency_before + 1) / 2);
+}
+
+}  // namespace impala
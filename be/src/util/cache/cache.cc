@@ -95,8 +95,21 @@ CacheShard* NewCacheShard(Cache::EvictionPolicy policy, kudu::MemTracker* mem_tr
   }
 }
 
-Cache* NewCache(Cache::EvictionPolicy policy, size_t capacity, const std::string& id) {
-  return new ShardedCache(policy, capacity, id);
+string ToString(Cache::AdmissionPolicy p) {
+  switch (p) {
+    case Cache::AdmissionPolicy::ALWAYS:
+      return "always";
+    case Cache::AdmissionPolicy::TINY_LFU:
+      return "tinylfu";
+    default:
+      LOG(FATAL) << "unexpected cache admission policy: " << static_cast<int>(p);
+  }
+  return "unknown";
+}
+
+Cache* NewCache(Cache::EvictionPolicy policy, size_t capacity, const std::string& id,
+    Cache::AdmissionPolicy admission_policy, int64_t expected_entries) {
+  return new ShardedCache(policy, capacity, id, admission_policy, expected_entries);
 }
 
 }  // namespace impala
@@ -63,6 +63,33 @@ class Cache {
     return Cache::EvictionPolicy::LRU;
   }
 
+  // Supported admission policies for the cache. Admission policy determines whether
+  // a new item is inserted at all if the cache is at capacity. It applies on top of any
+  // eviction policy.
+  enum class AdmissionPolicy {
+    // Every item is admitted (the default).
+    ALWAYS,
+
+    // TinyLFU: the access frequency of keys is estimated with a count-min sketch
+    // which counts calls to Lookup() with LookupBehavior NORMAL, whether or not they
+    // hit. A new item which would evict another item is only admitted if its key was
+    // accessed more frequently than the key of the item which would be evicted first.
+    // This prevents items which are only accessed once (e.g. by a large scan) from
+    // evicting items which are accessed repeatedly.
+    TINY_LFU,
+  };
+
+  static AdmissionPolicy ParseAdmissionPolicy(const std::string& policy_string) {
+    string upper_policy = boost::to_upper_copy(policy_string);
+    if (upper_policy == "ALWAYS") {
+      return Cache::AdmissionPolicy::ALWAYS;
+    } else if (upper_policy == "TINYLFU") {
+      return Cache::AdmissionPolicy::TINY_LFU;
+    }
+    LOG(FATAL) << "Unsupported admission policy: " << policy_string;
+    return Cache::AdmissionPolicy::ALWAYS;
+  }
+
   // Callback interface which is called when an entry is evicted from the
   // cache.
   class EvictionCallback {
@@ -249,7 +276,8 @@ class Cache {
   // Cache::Allocate() above.
   //
   // This method is not guaranteed to succeed. If it succeeds, it returns a handle
-  // that corresponds to the mapping. If it fails, it returns a null handle.
+  // that corresponds to the mapping. If it fails (including if the admission policy
+  // rejects the entry), it returns a null handle.
   //
   // Handles are not intended to be held for significant periods of time. Also,
   // threads should avoid getting multiple handles for the same key simultaneously.
@@ -363,7 +391,11 @@ class Cache {
 };
 
 // Instantiate a cache of a particular 'policy' flavor with the specified 'capacity'
-// and identifier 'id'.
-Cache* NewCache(Cache::EvictionPolicy policy, size_t capacity, const std::string& id);
+// and identifier 'id'. 'admission_policy' is applied in front of Insert(). For
+// AdmissionPolicy::TINY_LFU, 'expected_entries' is the expected number of entries in
+// the cache at capacity, which sizes the frequency sketch.
+Cache* NewCache(Cache::EvictionPolicy policy, size_t capacity, const std::string& id,
+    Cache::AdmissionPolicy admission_policy = Cache::AdmissionPolicy::ALWAYS,
+    int64_t expected_entries = 0);
 
 } // namespace impala
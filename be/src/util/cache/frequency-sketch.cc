@@ -0,0 +1,85 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/cache/frequency-sketch.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "kudu/gutil/bits.h"
+
+namespace impala {
+
+// Seeds of the hash functions of the rows. Taken from the sketch used by Caffeine.
+static constexpr uint64_t SEEDS[] = {0xc3a5c85c97cb3127UL, 0xb492b66fbe98f273UL,
+    0x9ae16a3b2f90404fUL, 0xcbf29ce484222325UL};
+
+// Mask of the top 3 bits of all counters in a word, used when aging.
+static constexpr uint64_t RESET_MASK = 0x7777777777777777UL;
+
+// Spreads the bits of a cache hash, which are not uniform within a shard since its top
+// bits select the shard.
+static inline uint64_t Spread(uint32_t hash) {
+  uint64_t x = hash;
+  x = ((x >> 16) ^ x) * 0x45d9f3b;
+  x = ((x >> 16) ^ x) * 0x45d9f3b;
+  return (x >> 16) ^ x;
+}
+
+FrequencySketch::FrequencySketch(int64_t expected_entries)
+  : table_(1L << Bits::Log2Ceiling64(std::max<int64_t>(expected_entries, 64))),
+    table_mask_(table_.size() - 1),
+    sample_size_(10 * std::max<int64_t>(expected_entries, 64)) {}
+
+int64_t FrequencySketch::WordIndex(uint64_t spread, int row) const {
+  uint64_t h = (spread + SEEDS[row]) * SEEDS[row];
+  h += h >> 32;
+  return h & table_mask_;
+}
+
+void FrequencySketch::Increment(uint32_t hash) {
+  const uint64_t spread = Spread(hash);
+  std::lock_guard<kudu::simple_spinlock> l(lock_);
+  bool incremented = false;
+  for (int row = 0; row < DEPTH; ++row) {
+    uint64_t& word = table_[WordIndex(spread, row)];
+    const int shift = CounterShift(spread, row);
+    if (((word >> shift) & 0xf) < MAX_FREQUENCY) {
+      word += 1UL << shift;
+      incremented = true;
+    }
+  }
+  if (incremented && ++num_increments_ >= sample_size_) Age();
+}
+
+int FrequencySketch::Frequency(uint32_t hash) const {
+  const uint64_t spread = Spread(hash);
+  std::lock_guard<kudu::simple_spinlock> l(lock_);
+  int frequency = MAX_FREQUENCY;
+  for (int row = 0; row < DEPTH; ++row) {
+    const uint64_t word = table_[WordIndex(spread, row)];
+    frequency = std::min<int>(frequency, (word >> CounterShift(spread, row)) & 0xf);
+  }
+  return frequency;
+}
+
+void FrequencySketch::Age() {
+  for (uint64_t& word : table_) word = (word >> 1) & RESET_MASK;
+  num_increments_ /= 2;
+}
+
+} // namespace impala
@@ -0,0 +1,89 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/locks.h"
+
+namespace impala {
+
+// A count-min sketch which estimates the access frequency of cache keys with a small,
+// fixed memory footprint. This is the frequency histogram used by the TinyLFU admission
+// policy (see Cache::AdmissionPolicy). Each key maps to 4 counters of 4 bits, one in
+// each of 4 rows of the sketch, and its frequency is estimated as the minimum of the
+// counters, so the estimate is never lower than the true frequency since the last
+// reset (capped at 15). To keep the estimate biased towards recent accesses, all
+// counters are halved once the number of increments reaches 10 times the expected
+// number of entries ("aging").
+//
+// The rows are stored interleaved in an array of 64-bit words so that all counters of a
+// key fall into 4 words. This class is thread-safe.
+class FrequencySketch {
+ public:
+  // 'expected_entries' is the expected number of distinct keys in the cache, which
+  // determines the size of the sketch and the aging period.
+  explicit FrequencySketch(int64_t expected_entries);
+
+  // Records an access to the key with hash 'hash'.
+  void Increment(uint32_t hash);
+
+  // Returns the estimated number of accesses to the key with hash 'hash' since it was
+  // last aged, between 0 and MAX_FREQUENCY.
+  int Frequency(uint32_t hash) const;
+
+  static constexpr int MAX_FREQUENCY = 15;
+
+ private:
+  // Number of rows of the sketch, i.e. counters per key.
+  static constexpr int DEPTH = 4;
+
+  // Returns the index into 'table_' of the word holding the counter of row 'row' of a
+  // key with the spread hash 'spread'.
+  int64_t WordIndex(uint64_t spread, int row) const;
+
+  // Returns the bit offset within its word of the counter of row 'row' of a key with
+  // the spread hash 'spread'.
+  static int CounterShift(uint64_t spread, int row) {
+    return (((spread & 3) << 2) + row) << 2;
+  }
+
+  // Halves all counters. Called with 'lock_' held.
+  void Age();
+
+  // Protects the fields below.
+  mutable kudu::simple_spinlock lock_;
+
+  // Counters, 16 per word.
+  std::vector<uint64_t> table_;
+
+  // table_.size() - 1. The size is a power of 2.
+  const int64_t table_mask_;
+
+  // Number of increments after which the counters are aged.
+  const int64_t sample_size_;
+
+  // Number of increments since the last aging, halved on each aging.
+  int64_t num_increments_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(FrequencySketch);
+};
+
+} // namespace impala
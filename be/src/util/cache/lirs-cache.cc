@@ -330,6 +330,7 @@ class LIRSCacheShard : public CacheShard {
   void Release(HandleBase* handle) override;
   void Erase(const Slice& key, uint32_t hash) override;
   size_t Invalidate(const Cache::InvalidationControl& ctl) override;
+  bool EvictionCandidate(size_t charge, uint32_t* victim_hash) override;
 
  private:
 
@@ -1079,6 +1080,20 @@ size_t LIRSCacheShard::Invalidate(const Cache::InvalidationControl& ctl) {
   return 0;
 }
 
+bool LIRSCacheShard::EvictionCandidate(size_t charge, uint32_t* victim_hash) {
+  DCHECK(initialized_);
+  std::lock_guard<MutexType> l(mutex_);
+  // A new entry goes into the protected area while there is space for it, which never
+  // evicts anything. Otherwise, it becomes an UNPROTECTED entry and the oldest
+  // UNPROTECTED entry is evicted first if the unprotected area is full. This ignores
+  // new entries which replace a TOMBSTONE entry as the key isn't known here.
+  if (protected_usage_ + charge <= protected_capacity_) return false;
+  if (unprotected_usage_ + charge <= unprotected_capacity_) return false;
+  if (unprotected_list_front_ == nullptr) return false;
+  *victim_hash = unprotected_list_front_->hash();
+  return true;
+}
+
 }  // end anonymous namespace
 
 template<>
@@ -93,6 +93,7 @@ class RLCacheShard : public CacheShard {
   void Release(HandleBase* handle) override;
   void Erase(const Slice& key, uint32_t hash) override;
   size_t Invalidate(const Cache::InvalidationControl& ctl) override;
+  bool EvictionCandidate(size_t charge, uint32_t* victim_hash) override;
 
  private:
   void RL_Remove(RLHandle* e);
@@ -419,6 +420,16 @@ size_t RLCacheShard<policy>::Invalidate(const Cache::InvalidationControl& ctl) {
   return invalid_entry_count;
 }
 
+template<Cache::EvictionPolicy policy>
+bool RLCacheShard<policy>::EvictionCandidate(size_t charge, uint32_t* victim_hash) {
+  DCHECK(initialized_);
+  std::lock_guard<decltype(mutex_)> l(mutex_);
+  // The oldest entry is evicted first, see Insert().
+  if (usage_ + charge <= capacity_ || rl_.next == &rl_) return false;
+  *victim_hash = rl_.next->hash();
+  return true;
+}
+
 }  // end anonymous namespace
 
 template<>
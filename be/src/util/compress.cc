@@ -331,7 +331,9 @@ ZstandardCompressor::ZstandardCompressor(MemPool* mem_pool, bool reuse_buffer, i
   : Codec(mem_pool, reuse_buffer), clevel_(clevel) {}
 
 int64_t ZstandardCompressor::MaxOutputLen(int64_t input_len, const uint8_t* input) {
-  return ZSTD_compressBound(input_len);
+  size_t bound = ZSTD_compressBound(input_len);
+  // ZSTD_compressBound() returns an error code if the input is too large.
+  return ZSTD_isError(bound) ? 0 : bound;
 }
 
 Status ZstandardCompressor::ProcessBlock(bool output_preallocated, int64_t input_length,
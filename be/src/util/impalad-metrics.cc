@@ -77,8 +77,20 @@ const char* ImpaladMetricKeys::IO_MGR_REMOTE_DATA_CACHE_DROPPED_BYTES =
     "impala-server.io-mgr.remote-data-cache-dropped-bytes";
 const char* ImpaladMetricKeys::IO_MGR_REMOTE_DATA_CACHE_DROPPED_ENTRIES =
     "impala-server.io-mgr.remote-data-cache-dropped-entries";
+const char* ImpaladMetricKeys::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_DEPTH =
+    "impala-server.io-mgr.remote-data-cache-write-queue-depth";
+const char* ImpaladMetricKeys::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_BYTES =
+    "impala-server.io-mgr.remote-data-cache-write-queue-bytes";
 const char* ImpaladMetricKeys::IO_MGR_REMOTE_DATA_CACHE_INSTANT_EVICTIONS =
     "impala-server.io-mgr.remote-data-cache-instant-evictions";
+const char* ImpaladMetricKeys::IO_MGR_FILE_METADATA_CACHE_HIT_COUNT =
+    "impala-server.io-mgr.file-metadata-cache-hit-count";
+const char* ImpaladMetricKeys::IO_MGR_FILE_METADATA_CACHE_MISS_COUNT =
+    "impala-server.io-mgr.file-metadata-cache-miss-count";
+const char* ImpaladMetricKeys::IO_MGR_FILE_METADATA_CACHE_TOTAL_BYTES =
+    "impala-server.io-mgr.file-metadata-cache-total-bytes";
+const char* ImpaladMetricKeys::IO_MGR_FILE_METADATA_CACHE_NUM_ENTRIES =
+    "impala-server.io-mgr.file-metadata-cache-num-entries";
 const char* ImpaladMetricKeys::IO_MGR_BYTES_WRITTEN =
     "impala-server.io-mgr.bytes-written";
 const char* ImpaladMetricKeys::IO_MGR_NUM_CACHED_FILE_HANDLES =
@@ -175,6 +187,8 @@ IntCounter* ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_NUM_WRITES = nullptr;
 IntCounter* ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_DROPPED_BYTES = nullptr;
 IntCounter* ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_DROPPED_ENTRIES = nullptr;
 IntCounter* ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_INSTANT_EVICTIONS = nullptr;
+IntCounter* ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_HIT_COUNT = nullptr;
+IntCounter* ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_MISS_COUNT = nullptr;
 IntCounter* ImpaladMetrics::IO_MGR_BYTES_WRITTEN = nullptr;
 IntCounter* ImpaladMetrics::IO_MGR_CACHED_FILE_HANDLES_REOPENED = nullptr;
 IntCounter* ImpaladMetrics::HEDGED_READ_OPS = nullptr;
@@ -207,6 +221,10 @@ IntGauge* ImpaladMetrics::IO_MGR_CACHED_FILE_HANDLES_HIT_COUNT = nullptr;
 IntGauge* ImpaladMetrics::IO_MGR_CACHED_FILE_HANDLES_MISS_COUNT = nullptr;
 IntGauge* ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_TOTAL_BYTES = nullptr;
 IntGauge* ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_NUM_ENTRIES = nullptr;
+IntGauge* ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_DEPTH = nullptr;
+IntGauge* ImpaladMetrics::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_BYTES = nullptr;
+IntGauge* ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_TOTAL_BYTES = nullptr;
+IntGauge* ImpaladMetrics::IO_MGR_FILE_METADATA_CACHE_NUM_ENTRIES = nullptr;
 IntGauge* ImpaladMetrics::NUM_FILES_OPEN_FOR_INSERT = nullptr;
 IntGauge* ImpaladMetrics::NUM_QUERIES_REGISTERED = nullptr;
 IntGauge* ImpaladMetrics::RESULTSET_CACHE_TOTAL_NUM_ROWS = nullptr;
@@ -366,6 +384,19 @@ void ImpaladMetrics::CreateMetrics(MetricGroup* m) {
       ImpaladMetricKeys::IO_MGR_REMOTE_DATA_CACHE_DROPPED_ENTRIES, 0);
   IO_MGR_REMOTE_DATA_CACHE_INSTANT_EVICTIONS = IO_MGR_METRICS->AddCounter(
       ImpaladMetricKeys::IO_MGR_REMOTE_DATA_CACHE_INSTANT_EVICTIONS, 0);
+  IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_DEPTH = IO_MGR_METRICS->AddGauge(
+      ImpaladMetricKeys::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_DEPTH, 0);
+  IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_BYTES = IO_MGR_METRICS->AddGauge(
+      ImpaladMetricKeys::IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_BYTES, 0);
+
+  IO_MGR_FILE_METADATA_CACHE_HIT_COUNT = IO_MGR_METRICS->AddCounter(
+      ImpaladMetricKeys::IO_MGR_FILE_METADATA_CACHE_HIT_COUNT, 0);
+  IO_MGR_FILE_METADATA_CACHE_MISS_COUNT = IO_MGR_METRICS->AddCounter(
+      ImpaladMetricKeys::IO_MGR_FILE_METADATA_CACHE_MISS_COUNT, 0);
+  IO_MGR_FILE_METADATA_CACHE_TOTAL_BYTES = IO_MGR_METRICS->AddGauge(
+      ImpaladMetricKeys::IO_MGR_FILE_METADATA_CACHE_TOTAL_BYTES, 0);
+  IO_MGR_FILE_METADATA_CACHE_NUM_ENTRIES = IO_MGR_METRICS->AddGauge(
+      ImpaladMetricKeys::IO_MGR_FILE_METADATA_CACHE_NUM_ENTRIES, 0);
 
   IO_MGR_CACHED_FILE_HANDLES_HIT_RATIO =
       StatsMetric<uint64_t, StatsType::MEAN>::CreateAndRegister(IO_MGR_METRICS,
@@ -98,16 +98,34 @@ class ImpaladMetricKeys {
   static const char* IO_MGR_REMOTE_DATA_CACHE_NUM_WRITES;
 
   /// Total number of bytes not inserted into the remote data cache due to
-  /// concurrency limit.
+  /// concurrency limit or a full write-behind queue.
   static const char* IO_MGR_REMOTE_DATA_CACHE_DROPPED_BYTES;
 
   /// Total number of entries not inserted into the remote data cache due to
-  /// concurrency limit.
+  /// concurrency limit or a full write-behind queue.
   static const char* IO_MGR_REMOTE_DATA_CACHE_DROPPED_ENTRIES;
 
+  /// Current number of entries in the write-behind queues of the remote data cache.
+  static const char* IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_DEPTH;
+
+  /// Current number of bytes in the write-behind queues of the remote data cache.
+  static const char* IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_BYTES;
+
   /// Total number of entries evicted immediately from the remote data cache.
   static const char* IO_MGR_REMOTE_DATA_CACHE_INSTANT_EVICTIONS;
 
+  /// Total number of cache hits for the file metadata cache.
+  static const char* IO_MGR_FILE_METADATA_CACHE_HIT_COUNT;
+
+  /// Total number of cache misses for the file metadata cache.
+  static const char* IO_MGR_FILE_METADATA_CACHE_MISS_COUNT;
+
+  /// Current estimated byte size of the file metadata cache.
+  static const char* IO_MGR_FILE_METADATA_CACHE_TOTAL_BYTES;
+
+  /// Current number of entries in the file metadata cache.
+  static const char* IO_MGR_FILE_METADATA_CACHE_NUM_ENTRIES;
+
   /// Total number of bytes written to disk by the io mgr (for spilling)
   static const char* IO_MGR_BYTES_WRITTEN;
 
@@ -266,6 +284,8 @@ class ImpaladMetrics {
   static IntCounter* IO_MGR_REMOTE_DATA_CACHE_DROPPED_BYTES;
   static IntCounter* IO_MGR_REMOTE_DATA_CACHE_DROPPED_ENTRIES;
   static IntCounter* IO_MGR_REMOTE_DATA_CACHE_INSTANT_EVICTIONS;
+  static IntCounter* IO_MGR_FILE_METADATA_CACHE_HIT_COUNT;
+  static IntCounter* IO_MGR_FILE_METADATA_CACHE_MISS_COUNT;
   static IntCounter* IO_MGR_SHORT_CIRCUIT_BYTES_READ;
   static IntCounter* IO_MGR_BYTES_WRITTEN;
   static IntCounter* IO_MGR_CACHED_FILE_HANDLES_REOPENED;
@@ -303,6 +323,10 @@ class ImpaladMetrics {
   static IntGauge* IO_MGR_CACHED_FILE_HANDLES_MISS_COUNT;
   static IntGauge* IO_MGR_REMOTE_DATA_CACHE_TOTAL_BYTES;
   static IntGauge* IO_MGR_REMOTE_DATA_CACHE_NUM_ENTRIES;
+  static IntGauge* IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_DEPTH;
+  static IntGauge* IO_MGR_REMOTE_DATA_CACHE_WRITE_QUEUE_BYTES;
+  static IntGauge* IO_MGR_FILE_METADATA_CACHE_TOTAL_BYTES;
+  static IntGauge* IO_MGR_FILE_METADATA_CACHE_NUM_ENTRIES;
   static IntGauge* NUM_FILES_OPEN_FOR_INSERT;
   static IntGauge* NUM_QUERIES_REGISTERED;
   static IntGauge* RESULTSET_CACHE_TOTAL_NUM_ROWS;
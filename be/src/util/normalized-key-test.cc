@@ -0,0 +1,339 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "exprs/slot-ref.h"
+#include "runtime/date-value.h"
+#include "runtime/decimal-value.inline.h"
+#include "runtime/mem-pool.h"
+#include "runtime/mem-tracker.h"
+#include "runtime/string-value.h"
+#include "runtime/test-env.h"
+#include "runtime/timestamp-value.inline.h"
+#include "runtime/tuple-row.h"
+#include "runtime/types.h"
+#include "testutil/gtest-util.h"
+#include "util/normalized-key.h"
+#include "util/radix-sort.h"
+#include "util/tuple-row-compare.h"
+
+#include "common/names.h"
+
+namespace impala {
+
+class NormalizedKeyTest : public testing::Test {
+ public:
+  NormalizedKeyTest() : expr_perm_pool_(&tracker_), expr_results_pool_(&tracker_) {}
+
+ protected:
+  scoped_ptr<TestEnv> test_env_;
+  RuntimeState* runtime_state_ = nullptr;
+  RowDescriptor desc_;
+
+  ObjectPool pool_;
+  MemTracker tracker_;
+  MemPool expr_perm_pool_;
+  MemPool expr_results_pool_;
+
+  TSortInfo tsort_info_;
+  vector<ScalarExpr*> ordering_exprs_;
+  scoped_ptr<TupleRowComparatorConfig> config_;
+  scoped_ptr<TupleRowLexicalComparator> comparator_;
+  scoped_ptr<NormalizedKeyEncoder> encoder_;
+
+  /// Offsets of the slots in the tuple. The first byte of the tuple holds the null
+  /// indicator of the first slot, which is the only nullable one.
+  vector<int> slot_offsets_;
+  int tuple_size_ = 0;
+
+  virtual void SetUp() {
+    test_env_.reset(new TestEnv());
+    ASSERT_OK(test_env_->Init());
+    ASSERT_OK(test_env_->CreateQueryState(0, nullptr, &runtime_state_));
+  }
+
+  virtual void TearDown() {
+    if (comparator_ != nullptr) comparator_->Close(runtime_state_);
+    ScalarExpr::Close(ordering_exprs_);
+    runtime_state_ = nullptr;
+    test_env_.reset();
+    expr_perm_pool_.FreeAll();
+    expr_results_pool_.FreeAll();
+    pool_.Clear();
+  }
+
+  /// Frees all state so that Init() can be called again.
+  void Reset() {
+    TearDown();
+    comparator_.reset();
+    encoder_.reset();
+    config_.reset();
+    ordering_exprs_.clear();
+    slot_offsets_.clear();
+    SetUp();
+  }
+
+  /// Creates the comparator and the encoder for ordering exprs that are slot refs of
+  /// 'types' in a single tuple.
+  void Init(const vector<ColumnType>& types, const vector<bool>& is_asc,
+      const vector<bool>& nulls_first,
+      TSortingOrder::type sorting_order = TSortingOrder::LEXICAL) {
+    int offset = 1;
+    for (int i = 0; i < types.size(); ++i) {
+      // The null indicator bit of a test SlotRef is its offset within the first byte.
+      SlotRef* slot_ref = pool_.Add(new SlotRef(types[i], offset, i == 0));
+      ASSERT_OK(slot_ref->Init(desc_, true, nullptr));
+      ordering_exprs_.push_back(slot_ref);
+      slot_offsets_.push_back(offset);
+      offset += types[i].GetSlotSize();
+    }
+    tuple_size_ = offset;
+    tsort_info_.sorting_order = sorting_order;
+    tsort_info_.is_asc_order = is_asc;
+    tsort_info_.nulls_first = nulls_first;
+    config_.reset(new TupleRowComparatorConfig(tsort_info_, ordering_exprs_));
+    encoder_.reset(new NormalizedKeyEncoder(*config_));
+    if (sorting_order != TSortingOrder::LEXICAL) return;
+    comparator_.reset(new TupleRowLexicalComparator(*config_));
+    ASSERT_OK(comparator_->Open(
+        &pool_, runtime_state_, &expr_perm_pool_, &expr_results_pool_));
+  }
+
+  TupleRow* CreateRow() {
+    Tuple* tuple = Tuple::Create(tuple_size_, &expr_perm_pool_);
+    TupleRow* row =
+        reinterpret_cast<TupleRow*>(expr_perm_pool_.Allocate(sizeof(Tuple*)));
+    row->SetTuple(0, tuple);
+    return row;
+  }
+
+  template <typename T>
+  void SetSlot(TupleRow* row, int slot_idx, const T& value) {
+    memcpy(row->GetTuple(0)->GetSlot(slot_offsets_[slot_idx]), &value, sizeof(T));
+  }
+
+  void SetStringSlot(TupleRow* row, int slot_idx, const string& value) {
+    char* ptr = reinterpret_cast<char*>(expr_perm_pool_.Allocate(value.size()));
+    memcpy(ptr, value.data(), value.size());
+    SetSlot(row, slot_idx, StringValue(ptr, value.size()));
+  }
+
+  void SetFirstSlotNull(TupleRow* row) {
+    row->GetTuple(0)->SetNull(NullIndicatorOffset(0, 1));
+  }
+
+  NormalizedKeyEncoder::Key Encode(const TupleRow* row) {
+    NormalizedKeyEncoder::Key key;
+    encoder_->Encode(comparator_->ordering_expr_evals().data(), row, &key);
+    return key;
+  }
+
+  /// Checks that the order of the keys of all pairs of 'rows' is consistent with the
+  /// comparator. If the encoder is complete, the keys must also be equal for equal rows.
+  void CheckOrder(const vector<TupleRow*>& rows) {
+    ASSERT_TRUE(encoder_->IsUsable());
+    vector<NormalizedKeyEncoder::Key> keys;
+    for (TupleRow* row : rows) keys.push_back(Encode(row));
+    for (int i = 0; i < rows.size(); ++i) {
+      for (int j = 0; j < rows.size(); ++j) {
+        int cmp = comparator_->Compare(rows[i], rows[j]);
+        cmp = cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+        int key_cmp = keys[i].Compare(keys[j]);
+        if (encoder_->is_complete() || key_cmp != 0) {
+          EXPECT_EQ(cmp, key_cmp) << "rows " << i << " and " << j;
+        }
+      }
+    }
+  }
+};
+
+TEST_F(NormalizedKeyTest, Integers) {
+  Init({ColumnType(TYPE_INT), ColumnType(TYPE_TINYINT), ColumnType(TYPE_SMALLINT)},
+      {true, true, false}, {true, true, true});
+  EXPECT_TRUE(encoder_->is_complete());
+  EXPECT_EQ(3, encoder_->num_encoded_exprs());
+  std::mt19937 rng(1234);
+  vector<int32_t> ints = {numeric_limits<int32_t>::min(), -1000, -1, 0, 1, 1000,
+      numeric_limits<int32_t>::max()};
+  vector<TupleRow*> rows;
+  for (int i = 0; i < 200; ++i) {
+    TupleRow* row = CreateRow();
+    SetSlot<int32_t>(row, 0, ints[rng() % ints.size()]);
+    SetSlot<int8_t>(row, 1, static_cast<int8_t>(rng() % 5 - 2));
+    SetSlot<int16_t>(row, 2, static_cast<int16_t>(rng()));
+    rows.push_back(row);
+  }
+  CheckOrder(rows);
+}
+
+TEST_F(NormalizedKeyTest, FloatingPoint) {
+  Init({ColumnType(TYPE_DOUBLE), ColumnType(TYPE_FLOAT)}, {true, false}, {true, true});
+  EXPECT_TRUE(encoder_->is_complete());
+  vector<double> doubles = {-numeric_limits<double>::infinity(),
+      numeric_limits<double>::lowest(), -1.5, -numeric_limits<double>::denorm_min(),
+      -0.0, 0.0, numeric_limits<double>::denorm_min(), 1.5,
+      numeric_limits<double>::max(), numeric_limits<double>::infinity(),
+      numeric_limits<double>::quiet_NaN(), -numeric_limits<double>::quiet_NaN()};
+  vector<float> floats = {-numeric_limits<float>::infinity(), -2.5f, -0.0f, 0.0f, 2.5f,
+      numeric_limits<float>::infinity(), numeric_limits<float>::quiet_NaN()};
+  vector<TupleRow*> rows;
+  for (double d : doubles) {
+    for (float f : floats) {
+      TupleRow* row = CreateRow();
+      SetSlot(row, 0, d);
+      SetSlot(row, 1, f);
+      rows.push_back(row);
+    }
+  }
+  CheckOrder(rows);
+}
+
+TEST_F(NormalizedKeyTest, Nulls) {
+  for (bool nulls_first : {true, false}) {
+    for (bool is_asc : {true, false}) {
+      Reset();
+      Init({ColumnType(TYPE_BIGINT), ColumnType(TYPE_INT)}, {is_asc, true},
+          {nulls_first, true});
+      EXPECT_TRUE(encoder_->is_complete());
+      vector<TupleRow*> rows;
+      for (int64_t v : {numeric_limits<int64_t>::min(), 0L, 7L}) {
+        for (int32_t v2 : {-1, 1}) {
+          TupleRow* row = CreateRow();
+          SetSlot(row, 0, v);
+          SetSlot(row, 1, v2);
+          rows.push_back(row);
+          TupleRow* null_row = CreateRow();
+          SetFirstSlotNull(null_row);
+          SetSlot(null_row, 1, v2);
+          rows.push_back(null_row);
+        }
+      }
+      CheckOrder(rows);
+    }
+  }
+}
+
+TEST_F(NormalizedKeyTest, Strings) {
+  Init({ColumnType(TYPE_STRING), ColumnType(TYPE_INT)}, {false, true}, {false, true});
+  // The key only contains a prefix of the string.
+  EXPECT_FALSE(encoder_->is_complete());
+  EXPECT_EQ(1, encoder_->num_encoded_exprs());
+  vector<string> strings = {"", "a", string("a\0", 2), "ab", "abc", "b",
+      "abcdefghijklmnop", "abcdefghijklmnoq", "abcdefghijklmnopq", "\xff"};
+  vector<TupleRow*> rows;
+  for (const string& s : strings) {
+    TupleRow* row = CreateRow();
+    SetStringSlot(row, 0, s);
+    SetSlot<int32_t>(row, 1, s.size());
+    rows.push_back(row);
+  }
+  TupleRow* null_row = CreateRow();
+  SetFirstSlotNull(null_row);
+  rows.push_back(null_row);
+  CheckOrder(rows);
+}
+
+TEST_F(NormalizedKeyTest, DateTimestampDecimal) {
+  Init({ColumnType(TYPE_DATE), ColumnType(TYPE_TIMESTAMP)}, {true, false},
+      {true, true});
+  // 1 + 4 bytes for the date and 1 + 12 bytes for the timestamp.
+  EXPECT_EQ(2, encoder_->num_encoded_exprs());
+  EXPECT_FALSE(encoder_->is_complete());
+  vector<string> timestamps = {"1400-01-01 00:00:00", "1969-12-31 23:59:59.999999999",
+      "1970-01-01 00:00:00", "2015-04-09 14:07:46.580465000",
+      "2015-04-09 14:07:46.580465001", "9999-12-31 23:59:59.999999999"};
+  vector<TupleRow*> rows;
+  for (int32_t days : {-1000, -1, 0, 1, 20000}) {
+    for (const string& ts : timestamps) {
+      TupleRow* row = CreateRow();
+      SetSlot(row, 0, DateValue(days));
+      SetSlot(row, 1, TimestampValue::ParseSimpleDateFormat(ts));
+      rows.push_back(row);
+    }
+  }
+  CheckOrder(rows);
+
+  Reset();
+  ColumnType decimal16 = ColumnType::CreateDecimalType(38, 2);
+  Init({decimal16}, {true}, {true});
+  // The 16-byte value does not fit after the null byte and is truncated.
+  EXPECT_EQ(1, encoder_->num_encoded_exprs());
+  EXPECT_FALSE(encoder_->is_complete());
+  rows.clear();
+  for (int64_t v : {numeric_limits<int64_t>::min(), -256L, -255L, -1L, 0L, 1L, 255L,
+           256L, numeric_limits<int64_t>::max()}) {
+    bool overflow = false;
+    TupleRow* row = CreateRow();
+    SetSlot(row, 0, Decimal16Value::FromInt(38, 2, v, &overflow));
+    rows.push_back(row);
+  }
+  CheckOrder(rows);
+}
+
+TEST_F(NormalizedKeyTest, Unsupported) {
+  // CHAR values are compared without padding and can't be encoded.
+  Init({ColumnType::CreateCharType(4), ColumnType(TYPE_INT)}, {true, true},
+      {true, true});
+  EXPECT_FALSE(encoder_->IsUsable());
+
+  Reset();
+  Init({ColumnType(TYPE_INT), ColumnType(TYPE_INT)}, {true, true}, {true, true},
+      TSortingOrder::ZORDER);
+  EXPECT_FALSE(encoder_->IsUsable());
+}
+
+TEST_F(NormalizedKeyTest, RadixSort) {
+  struct Entry {
+    NormalizedKeyEncoder::Key key;
+    int index;
+  };
+  std::mt19937_64 rng(1234);
+  for (int num_key_bytes : {1, 5, 9, 16}) {
+    for (int num_entries : {0, 1, 2, 100, 10000}) {
+      vector<Entry> entries(num_entries);
+      for (int i = 0; i < num_entries; ++i) {
+        // Use few distinct values per byte to have duplicate keys and constant bytes.
+        uint8_t bytes[NormalizedKeyEncoder::KEY_BYTES] = {0};
+        for (int b = 0; b < num_key_bytes; ++b) bytes[b] = b % 3 == 0 ? 7 : rng() % 4;
+        for (int w = 0; w < 2; ++w) {
+          uint64_t word = 0;
+          for (int b = 0; b < sizeof(uint64_t); ++b) {
+            word = (word << 8) | bytes[w * sizeof(uint64_t) + b];
+          }
+          entries[i].key.words[w] = word;
+        }
+        entries[i].index = i;
+      }
+      vector<Entry> expected = entries;
+      std::stable_sort(expected.begin(), expected.end(),
+          [](const Entry& lhs, const Entry& rhs) { return lhs.key < rhs.key; });
+      vector<Entry> scratch(num_entries);
+      RadixSortByKey(entries.data(), scratch.data(), num_entries, num_key_bytes);
+      for (int i = 0; i < num_entries; ++i) {
+        ASSERT_EQ(expected[i].index, entries[i].index) << num_key_bytes << " " << i;
+      }
+    }
+  }
+}
+
+} // namespace impala
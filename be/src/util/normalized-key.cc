@@ -0,0 +1,219 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/normalized-key.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "exprs/scalar-expr-evaluator.h"
+#include "exprs/scalar-expr.h"
+#include "runtime/date-value.h"
+#include "runtime/string-value.h"
+#include "runtime/timestamp-value.h"
+#include "util/bit-util.h"
+#include "util/tuple-row-compare.h"
+
+#include "common/names.h"
+
+namespace impala {
+
+/// Writes 'value' to 'dst' in big-endian byte order.
+template <typename T>
+static inline void PutBigEndian(T value, uint8_t* dst) {
+  for (int i = sizeof(T) - 1; i >= 0; --i) {
+    dst[i] = static_cast<uint8_t>(value);
+    value >>= 8;
+  }
+}
+
+/// Writes the signed integer 'value' to 'dst' in big-endian byte order with the sign bit
+/// flipped, so that the unsigned byte order matches the signed order of the values.
+template <typename UNSIGNED_T, typename T>
+static inline void PutSignFlipped(T value, uint8_t* dst) {
+  UNSIGNED_T bits = static_cast<UNSIGNED_T>(value);
+  bits ^= static_cast<UNSIGNED_T>(1) << (sizeof(UNSIGNED_T) * 8 - 1);
+  PutBigEndian(bits, dst);
+}
+
+/// Writes the floating point 'value' to 'dst' so that the unsigned byte order matches
+/// the order of RawValue::Compare(), which treats NaN as smaller than all other values.
+template <typename UNSIGNED_T, typename FLOAT_T>
+static inline void PutFloat(FLOAT_T value, uint8_t* dst) {
+  const UNSIGNED_T sign_bit = static_cast<UNSIGNED_T>(1) << (sizeof(UNSIGNED_T) * 8 - 1);
+  UNSIGNED_T bits = 0;
+  if (!std::isnan(value)) {
+    // Make -0.0 and 0.0 equal.
+    if (value == 0) value = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = (bits & sign_bit) ? ~bits : bits | sign_bit;
+  }
+  PutBigEndian(bits, dst);
+}
+
+NormalizedKeyEncoder::NormalizedKeyEncoder(const TupleRowComparatorConfig& config)
+  : num_key_bytes_(0), is_complete_(false) {
+  if (config.sorting_order_ != TSortingOrder::LEXICAL) return;
+  const vector<ScalarExpr*>& exprs = config.ordering_exprs_;
+  DCHECK_EQ(exprs.size(), config.is_asc_.size());
+  DCHECK_EQ(exprs.size(), config.nulls_first_.size());
+  for (int i = 0; i < exprs.size(); ++i) {
+    // Each field needs at least a null byte and one value byte.
+    int remaining = KEY_BYTES - num_key_bytes_ - 1;
+    int encoded_size = EncodedSize(exprs[i]->type());
+    if (remaining < 1 || encoded_size < 0) return;
+    Field field;
+    field.expr_idx = i;
+    field.type = exprs[i]->type();
+    field.offset = num_key_bytes_;
+    field.num_bytes = encoded_size == 0 ? remaining : min(encoded_size, remaining);
+    field.invert = !config.is_asc_[i];
+    field.null_byte = config.nulls_first_[i] < 0 ? 0 : 2;
+    fields_.push_back(field);
+    num_key_bytes_ += 1 + field.num_bytes;
+    // Variable-length values and truncated values do not determine the order.
+    if (encoded_size == 0 || encoded_size > remaining) return;
+  }
+  is_complete_ = true;
+}
+
+int NormalizedKeyEncoder::EncodedSize(const ColumnType& type) {
+  switch (type.type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+    case TYPE_DATE:
+    case TYPE_DECIMAL:
+      return type.GetByteSize();
+    case TYPE_TIMESTAMP:
+      // The day number and the nanoseconds of the day.
+      return sizeof(uint32_t) + sizeof(int64_t);
+    case TYPE_STRING:
+    case TYPE_VARCHAR:
+      return 0;
+    default:
+      // CHAR values are compared without their padding, which can't be expressed as a
+      // prefix of the value. Complex types are not comparable.
+      return -1;
+  }
+}
+
+void NormalizedKeyEncoder::EncodeValue(
+    const Field& field, const void* value, uint8_t* dst) {
+  switch (field.type.type) {
+    case TYPE_BOOLEAN:
+      dst[0] = *reinterpret_cast<const bool*>(value) ? 1 : 0;
+      break;
+    case TYPE_TINYINT:
+      PutSignFlipped<uint8_t>(*reinterpret_cast<const int8_t*>(value), dst);
+      break;
+    case TYPE_SMALLINT:
+      PutSignFlipped<uint16_t>(*reinterpret_cast<const int16_t*>(value), dst);
+      break;
+    case TYPE_INT:
+      PutSignFlipped<uint32_t>(*reinterpret_cast<const int32_t*>(value), dst);
+      break;
+    case TYPE_BIGINT:
+      PutSignFlipped<uint64_t>(*reinterpret_cast<const int64_t*>(value), dst);
+      break;
+    case TYPE_DATE:
+      PutSignFlipped<uint32_t>(reinterpret_cast<const DateValue*>(value)->Value(), dst);
+      break;
+    case TYPE_FLOAT:
+      PutFloat<uint32_t>(*reinterpret_cast<const float*>(value), dst);
+      break;
+    case TYPE_DOUBLE:
+      PutFloat<uint64_t>(*reinterpret_cast<const double*>(value), dst);
+      break;
+    case TYPE_DECIMAL:
+      switch (field.type.GetByteSize()) {
+        case 4: {
+          int32_t v;
+          memcpy(&v, value, sizeof(v));
+          PutSignFlipped<uint32_t>(v, dst);
+          break;
+        }
+        case 8: {
+          int64_t v;
+          memcpy(&v, value, sizeof(v));
+          PutSignFlipped<uint64_t>(v, dst);
+          break;
+        }
+        case 16: {
+          // Use memcpy() since the slot may not be 16-byte aligned.
+          __int128_t v;
+          memcpy(&v, value, sizeof(v));
+          PutSignFlipped<__uint128_t>(v, dst);
+          break;
+        }
+        default:
+          DCHECK(false) << field.type;
+      }
+      break;
+    case TYPE_TIMESTAMP: {
+      const TimestampValue* ts = reinterpret_cast<const TimestampValue*>(value);
+      // Timestamps without a valid date or time are left as zeros.
+      if (!ts->HasDateAndTime()) break;
+      PutBigEndian<uint32_t>(ts->date().day_number(), dst);
+      PutSignFlipped<uint64_t>(ts->time().ticks(), dst + sizeof(uint32_t));
+      break;
+    }
+    case TYPE_STRING:
+    case TYPE_VARCHAR: {
+      const StringValue* sv = reinterpret_cast<const StringValue*>(value);
+      memcpy(dst, sv->ptr, min(sv->len, field.num_bytes));
+      break;
+    }
+    default:
+      DCHECK(false) << field.type;
+  }
+}
+
+void NormalizedKeyEncoder::Encode(
+    ScalarExprEvaluator* const* evals, const TupleRow* row, Key* key) const {
+  uint8_t bytes[KEY_BYTES];
+  memset(bytes, 0, sizeof(bytes));
+  for (const Field& field : fields_) {
+    uint8_t* dst = bytes + field.offset;
+    void* value = evals[field.expr_idx]->GetValue(row);
+    if (value == nullptr) {
+      // The value bytes of NULLs are left as zeros.
+      dst[0] = field.null_byte;
+      continue;
+    }
+    dst[0] = 1;
+    uint8_t value_bytes[KEY_BYTES];
+    memset(value_bytes, 0, sizeof(value_bytes));
+    EncodeValue(field, value, value_bytes);
+    if (field.invert) {
+      for (int i = 0; i < field.num_bytes; ++i) dst[1 + i] = ~value_bytes[i];
+    } else {
+      memcpy(dst + 1, value_bytes, field.num_bytes);
+    }
+  }
+  for (int i = 0; i < KEY_BYTES / sizeof(uint64_t); ++i) {
+    uint64_t word;
+    memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(word));
+    key->words[i] = BitUtil::ByteSwap(word);
+  }
+}
+
+} // namespace impala
@@ -0,0 +1,131 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/compiler-util.h"
+#include "runtime/types.h"
+
+namespace impala {
+
+class ScalarExprEvaluator;
+class TupleRow;
+class TupleRowComparatorConfig;
+
+/// Encodes the values of the leading ordering exprs of a lexical sort order into a
+/// fixed-size key ("normalized key") that can be compared with unsigned integer
+/// comparisons instead of evaluating and comparing the ordering exprs. For any two rows
+/// 'a' and 'b', key(a) < key(b) implies that 'a' sorts before 'b' according to
+/// TupleRowLexicalComparator. If the keys are equal, the rows are equal if the encoder
+/// is complete; otherwise the comparator must be used to break the tie.
+///
+/// Each encoded expr occupies a null byte, followed by its value in a big-endian,
+/// unsigned representation that preserves the order of RawValue::Compare():
+///  - Integers, DATE and DECIMAL have their sign bit flipped.
+///  - FLOAT and DOUBLE have their sign bit flipped if positive and all bits inverted if
+///    negative. -0.0 is encoded as 0.0 and NaNs are encoded as 0, which sorts them
+///    before all other values.
+///  - TIMESTAMP is the day number of the date, followed by the time of day.
+///  - STRING and VARCHAR are a zero-padded prefix of the string. They make the encoder
+///    incomplete since the prefix does not determine the order of the strings.
+/// The value bytes are inverted for descending exprs. The null byte orders NULLs before
+/// or after all other values regardless of the direction. Encoding stops at the first
+/// expr that does not fit into the key or has an unsupported type (e.g. CHAR), which
+/// also makes the encoder incomplete.
+class NormalizedKeyEncoder {
+ public:
+  /// Size of the normalized key in bytes.
+  static const int KEY_BYTES = 16;
+
+  /// A normalized key. Stored as big-endian words so that comparing the words as
+  /// unsigned integers is equivalent to comparing the key bytes with memcmp().
+  struct Key {
+    uint64_t words[KEY_BYTES / sizeof(uint64_t)];
+
+    bool ALWAYS_INLINE operator<(const Key& other) const {
+      return words[0] < other.words[0]
+          || (words[0] == other.words[0] && words[1] < other.words[1]);
+    }
+
+    bool ALWAYS_INLINE operator==(const Key& other) const {
+      return words[0] == other.words[0] && words[1] == other.words[1];
+    }
+
+    /// Returns -1, 0 or 1 if this key is less than, equal to or greater than 'other'.
+    int ALWAYS_INLINE Compare(const Key& other) const {
+      if (*this < other) return -1;
+      return *this == other ? 0 : 1;
+    }
+  };
+
+  /// Creates an encoder for the ordering exprs in 'config'. Only lexical sort orders
+  /// can be encoded. 'config' must outlive the encoder.
+  explicit NormalizedKeyEncoder(const TupleRowComparatorConfig& config);
+
+  /// Returns true if at least one ordering expr is encoded, i.e. if comparing the keys
+  /// can avoid any comparisons of the ordering exprs.
+  bool IsUsable() const { return !fields_.empty(); }
+
+  /// Returns true if the keys determine the order of rows on their own, i.e. if rows with
+  /// equal keys are equal according to the comparator.
+  bool is_complete() const { return is_complete_; }
+
+  /// Number of ordering exprs that are at least partially encoded in the key.
+  int num_encoded_exprs() const { return fields_.size(); }
+
+  /// Number of leading bytes of the key that are used by the encoded exprs. The
+  /// remaining bytes are always zero.
+  int num_key_bytes() const { return num_key_bytes_; }
+
+  /// Encodes the key of 'row' into 'key'. 'evals' are the evaluators of the ordering
+  /// exprs, e.g. the ones of the TupleRowComparator created from the same config.
+  void Encode(ScalarExprEvaluator* const* evals, const TupleRow* row, Key* key) const;
+
+ private:
+  /// The encoding of one ordering expr in the key.
+  struct Field {
+    /// Index of the ordering expr.
+    int expr_idx;
+    ColumnType type;
+    /// Offset of the null byte in the key. The value starts at the following byte.
+    int offset;
+    /// Number of value bytes in the key. Smaller than the encoded size of fixed-width
+    /// values if the value was truncated to fit into the key.
+    int num_bytes;
+    /// True if the values are inverted, i.e. the order is descending.
+    bool invert;
+    /// Value of the null byte for NULLs: 0 to sort NULLs first, 2 to sort them last.
+    uint8_t null_byte;
+  };
+
+  /// Returns the number of bytes of the order-preserving encoding of values of 'type', 0
+  /// for variable-length types and -1 for types that cannot be encoded.
+  static int EncodedSize(const ColumnType& type);
+
+  /// Writes the order-preserving encoding of the non-NULL 'value' of 'field' to 'dst',
+  /// which must have room for KEY_BYTES bytes.
+  static void EncodeValue(const Field& field, const void* value, uint8_t* dst);
+
+  std::vector<Field> fields_;
+  int num_key_bytes_;
+  bool is_complete_;
+};
+
+} // namespace impala
@@ -151,6 +151,58 @@ Status ParseUtil::ParseCompressionCodec(
   return Status::OK();
 }
 
+/// Returns true if the Parquet writer can write columns of 'type' with 'encoding'.
+static bool IsParquetWriteEncodingSupported(
+    TPrimitiveType::type type, parquet::Encoding::type encoding) {
+  switch (encoding) {
+    case parquet::Encoding::PLAIN:
+      return true;
+    case parquet::Encoding::DELTA_BINARY_PACKED:
+      return type == TPrimitiveType::TINYINT || type == TPrimitiveType::SMALLINT
+          || type == TPrimitiveType::INT || type == TPrimitiveType::BIGINT
+          || type == TPrimitiveType::DATE || type == TPrimitiveType::TIMESTAMP;
+    case parquet::Encoding::DELTA_LENGTH_BYTE_ARRAY:
+    case parquet::Encoding::DELTA_BYTE_ARRAY:
+      return type == TPrimitiveType::STRING || type == TPrimitiveType::VARCHAR
+          || type == TPrimitiveType::CHAR;
+    case parquet::Encoding::BYTE_STREAM_SPLIT:
+      return type == TPrimitiveType::FLOAT || type == TPrimitiveType::DOUBLE;
+    default:
+      return false;
+  }
+}
+
+Status ParseUtil::ParseParquetWriteEncodings(const string& value,
+    map<TPrimitiveType::type, parquet::Encoding::type>* encodings) {
+  encodings->clear();
+  vector<string> pairs;
+  split(pairs, value, is_any_of(","), token_compress_on);
+  for (string& pair : pairs) {
+    trim(pair);
+    if (pair.empty()) continue;
+    vector<string> tokens;
+    split(tokens, pair, is_any_of(":"));
+    if (tokens.size() != 2) {
+      return Status(Substitute("Invalid Parquet write encoding '$0'. Expected "
+          "<type>:<encoding>, e.g. BIGINT:DELTA_BINARY_PACKED.", pair));
+    }
+    trim(tokens[0]);
+    trim(tokens[1]);
+    TPrimitiveType::type type;
+    parquet::Encoding::type encoding;
+    RETURN_IF_ERROR(
+        GetThriftEnum(tokens[0], "column type", _TPrimitiveType_VALUES_TO_NAMES, &type));
+    RETURN_IF_ERROR(GetThriftEnum(
+        tokens[1], "Parquet encoding", parquet::_Encoding_VALUES_TO_NAMES, &encoding));
+    if (!IsParquetWriteEncodingSupported(type, encoding)) {
+      return Status(Substitute("Parquet encoding $0 is not supported for writing $1 "
+          "columns.", tokens[1], tokens[0]));
+    }
+    (*encodings)[type] = encoding;
+  }
+  return Status::OK();
+}
+
 // Return all enum values in a string format, e.g. FOO(1), BAR(2), BAZ(3).
 string GetThriftEnumValues(const map<int, const char*>& enum_values_to_names) {
   bool first = true;
@@ -25,6 +25,8 @@
 
 #include "common/status.h"
 #include "gen-cpp/CatalogObjects_types.h" // for THdfsCompression
+#include "gen-cpp/Types_types.h"
+#include "gen-cpp/parquet_types.h"
 #include "gutil/strings/substitute.h"
 
 namespace impala {
@@ -50,6 +52,13 @@ class ParseUtil {
 
   static Status ParseCompressionCodec(
       const std::string& compression_codec, THdfsCompression::type* type, int* level);
+
+  /// Parses the value of the PARQUET_WRITE_ENCODINGS query option, a comma-separated
+  /// list of '<type>:<encoding>' pairs, e.g. 'BIGINT:DELTA_BINARY_PACKED', into
+  /// 'encodings'. Returns an error if a pair is malformed or if the Parquet writer can
+  /// not write columns of the type with the encoding.
+  static Status ParseParquetWriteEncodings(const std::string& value,
+      std::map<TPrimitiveType::type, parquet::Encoding::type>* encodings);
 };
 
 std::string GetThriftEnumValues(const std::map<int, const char*>& enum_values_to_names);
@@ -0,0 +1,75 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "common/logging.h"
+#include "util/normalized-key.h"
+
+namespace impala {
+
+/// Returns the byte at 'byte_idx' of 'key', where byte 0 is the most significant one.
+inline uint8_t NormalizedKeyByte(const NormalizedKeyEncoder::Key& key, int byte_idx) {
+  int shift = (sizeof(uint64_t) - 1 - byte_idx % sizeof(uint64_t)) * 8;
+  return static_cast<uint8_t>(key.words[byte_idx / sizeof(uint64_t)] >> shift);
+}
+
+/// Sorts the 'num_entries' elements of 'entries' by their 'key' member, which must be
+/// a NormalizedKeyEncoder::Key, with a least significant digit radix sort over the
+/// first 'num_key_bytes' bytes of the keys. The remaining bytes of the keys must be
+/// equal. 'scratch' must have room for 'num_entries' elements. The sort is stable and
+/// takes one pass over the entries to build the histograms of all bytes, plus one pass
+/// for every byte that differs between keys. Bytes that are equal in all keys, e.g.
+/// the null bytes of columns without NULLs or the high bytes of small integers, are
+/// skipped.
+template <typename T>
+void RadixSortByKey(T* entries, T* scratch, int64_t num_entries, int num_key_bytes) {
+  DCHECK_GE(num_key_bytes, 0);
+  DCHECK_LE(num_key_bytes, NormalizedKeyEncoder::KEY_BYTES);
+  if (num_entries < 2 || num_key_bytes == 0) return;
+  std::vector<int64_t> counts(num_key_bytes * 256, 0);
+  for (int64_t i = 0; i < num_entries; ++i) {
+    for (int b = 0; b < num_key_bytes; ++b) {
+      ++counts[b * 256 + NormalizedKeyByte(entries[i].key, b)];
+    }
+  }
+  T* src = entries;
+  T* dst = scratch;
+  for (int b = num_key_bytes - 1; b >= 0; --b) {
+    int64_t* byte_counts = &counts[b * 256];
+    if (byte_counts[NormalizedKeyByte(src[0].key, b)] == num_entries) continue;
+    // Turn the counts into the offsets of the buckets in 'dst'.
+    int64_t offset = 0;
+    for (int v = 0; v < 256; ++v) {
+      int64_t count = byte_counts[v];
+      byte_counts[v] = offset;
+      offset += count;
+    }
+    for (int64_t i = 0; i < num_entries; ++i) {
+      dst[byte_counts[NormalizedKeyByte(src[i].key, b)]++] = src[i];
+    }
+    std::swap(src, dst);
+  }
+  if (src != entries) memcpy(entries, src, num_entries * sizeof(T));
+}
+
+} // namespace impala
@@ -166,6 +166,12 @@ class TupleRowComparator {
     return Less(lhs_row, rhs_row);
   }
 
+  /// Returns the evaluators of the ordering exprs, e.g. for computing normalized keys
+  /// with NormalizedKeyEncoder. Only valid after Open().
+  const std::vector<ScalarExprEvaluator*>& ordering_expr_evals() const {
+    return ordering_expr_evals_lhs_;
+  }
+
   /// A Symbol (or a substring of the symbol) of following.
   ///
   /// int Compare(ScalarExprEvaluator* const* evaluator_lhs,
@@ -536,7 +536,9 @@ enum TImpalaQueryOptions {
   // min-max filter for HDFS.
   //     BLOOM   - apply bloom filter only,
   //     MIN_MAX - apply min-max filter only.
-  //     ALL     - apply both bloom filter and min-max filter (default).
+  //     BITMAP  - apply exact bitmap filter on integer join keys with a narrow range.
+  //     ALL     - apply all filter types.
+  // The default is BLOOM,MIN_MAX.
   ENABLED_RUNTIME_FILTER_TYPES = 103
 
   // Enable asynchronous codegen.
@@ -736,6 +738,92 @@ enum TImpalaQueryOptions {
 
   // Determines how to resolve ORC files' schemas. Valid values are "position" and "name".
   ORC_SCHEMA_RESOLUTION = 146;
+
+  // Compression codec applied to row batches sent between fragments. Valid values are
+  // NONE, LZ4 and ZSTD, optionally followed by a compression level for ZSTD, e.g.
+  // "ZSTD:3". Defaults to LZ4. Compressed data is only sent if it is smaller than the
+  // uncompressed data.
+  EXCHANGE_COMPRESSION_CODEC = 147;
+
+  // If true, data stream senders choose the codec for each destination among NONE, LZ4
+  // and the ZSTD level from EXCHANGE_COMPRESSION_CODEC based on the measured compression
+  // ratio, serialization time and network throughput. Each candidate is sampled
+  // periodically to track changes in the data.
+  ADAPTIVE_EXCHANGE_COMPRESSION = 148;
+
+  // If true, row batches sent between fragments are converted to a columnar layout in
+  // which each fixed-length field is stored contiguously and encoded with dictionary,
+  // run-length or frame-of-reference encoding before compression. This reduces the
+  // amount of data sent at the cost of extra CPU time on the sender and the receiver.
+  EXCHANGE_COLUMNAR_FORMAT = 149;
+
+  // If true, sorts encode a binary-comparable prefix of the leading ordering exprs of
+  // each row ("normalized key") and compare the prefixes before evaluating the ordering
+  // exprs. The full comparison is only needed for rows with equal prefixes. Only applies
+  // to lexical sort orders. Sorts on fixed-width slots that fit into the prefix are
+  // radix sorted by their normalized keys. The keys are allocated outside of the
+  // sort's memory reservation.
+  SORT_NORMALIZED_KEYS = 150;
+
+  // If true, hash joins and aggregations keep a 7-bit tag of the hash of every bucket in
+  // a separate byte array and probe the hash table by comparing the tags of 16 buckets
+  // at a time with SIMD instructions. Buckets with a different tag are skipped without
+  // touching the bucket or the row it points to.
+  HASH_TABLE_GROUP_PROBING = 151;
+
+  // If true, the planner executes inner joins without equi-join predicates whose
+  // predicates compare a probe-side expr with the bounds of a band on the build side
+  // (e.g. 'a.ts BETWEEN b.start_ts AND b.end_ts') with a band join that sorts both
+  // sides, instead of a nested-loop join. The band join can spill to disk.
+  ENABLE_BAND_JOIN = 152;
+
+  // If true, conjuncts of SELECT nodes and Parquet/ORC scans that compare a fixed-width
+  // column (optionally cast or combined with constants by +, - or *) with constants,
+  // IS [NOT] NULL and integer IN lists are evaluated a row batch at a time with SIMD
+  // kernels. The other conjuncts are still evaluated one row at a time.
+  VECTORIZED_CONJUNCTS = 153;
+
+  // If true, rows that a non-streaming aggregation adds to a spilled partition are
+  // first aggregated in a small per-partition cache, and the partial aggregates are
+  // spilled instead of the input rows. The cache of a partition is turned off if it
+  // does not reduce the number of bytes spilled.
+  SPILLED_AGG_PREAGG = 154;
+
+  // Comma-separated list of <type>:<encoding> pairs that choose the encoding of the data
+  // pages of Parquet columns written by Impala, e.g.
+  // "BIGINT:DELTA_BINARY_PACKED,STRING:DELTA_BYTE_ARRAY,DOUBLE:BYTE_STREAM_SPLIT".
+  // Columns of the listed types are written with that encoding and without a
+  // dictionary. Supported encodings are PLAIN for all types, DELTA_BINARY_PACKED for
+  // TINYINT, SMALLINT, INT, BIGINT, DATE and TIMESTAMP, DELTA_LENGTH_BYTE_ARRAY and
+  // DELTA_BYTE_ARRAY for STRING, VARCHAR and CHAR, and BYTE_STREAM_SPLIT for FLOAT and
+  // DOUBLE. TIMESTAMP columns written as INT96 keep the default encoding. Columns of
+  // other types are dictionary encoded if possible, as before.
+  PARQUET_WRITE_ENCODINGS = 155;
+
+  // If true, the Parquet scanner evaluates the dictionary filter conjuncts on a string
+  // column once per dictionary entry of each row group, and drops the rows whose entry
+  // fails them before the remaining conjuncts are evaluated and before the other
+  // columns are materialized. Only has an effect if PARQUET_DICTIONARY_FILTERING is
+  // true. Off by default.
+  PARQUET_DICTIONARY_ROW_FILTERING = 156;
+
+  // If true, a Parquet row group that spans the splits of several scan ranges is not
+  // scanned only by the scanner of the split that contains its midpoint. Instead, its
+  // rows are divided among the scanners of all those splits in proportion to the
+  // overlap, and each scanner reads only the pages of its rows. This lets the
+  // instances of a scan with MT_DOP > 0 scan a file with a single large row group in
+  // parallel. Requires the offset index of the Parquet page index for all columns of
+  // the row group, and PARQUET_READ_PAGE_INDEX to be true. Once a row group is split,
+  // the query fails if a scanner cannot use its page index, e.g. because it is corrupt,
+  // since the rows of that scanner would otherwise be lost or read twice. Off by
+  // default.
+  PARQUET_SPLIT_ROW_GROUPS = 157;
+
+  // If true, once the hash tables of a non-streaming aggregation have outgrown the CPU
+  // caches, its input rows are buffered per hash partition and a buffer is aggregated
+  // at once, so that one hash table is accessed at a time. The buffers are taken from
+  // the aggregation's memory reservation.
+  AGG_RADIX_PARTITIONING = 158;
 }
 
 // The summary of a DML statement.
@@ -51,6 +51,7 @@ enum TPlanNodeType {
   KUDU_SCAN_NODE = 15
   CARDINALITY_CHECK_NODE = 16
   MULTI_AGGREGATION_NODE = 17
+  BAND_JOIN_NODE = 18
 }
 
 // phases of an execution node
@@ -130,6 +131,7 @@ enum TRuntimeFilterType {
   BLOOM = 0
   MIN_MAX = 1
   IN_LIST = 2
+  BITMAP = 3
 }
 
 // The level of filtering of enabled min/max filters to be applied to Parquet scan nodes.
@@ -495,6 +497,33 @@ struct TSortInfo {
   6: optional i32 num_lexical_keys_in_zorder
 }
 
+// Inner join whose join predicates include one or two inequalities between a probe
+// key and the bounds of a band on the build side, e.g.
+// 'probe.ts BETWEEN build.start_ts AND build.end_ts'. Both sides are sorted and matched
+// with a sweep over the sort order. All other predicates are stored in
+// TPlanNode.conjuncts.
+struct TBandJoinNode {
+  // Sort order of the probe side. The only ordering expr is the probe key. Its
+  // direction is the direction of the sweep.
+  1: required TSortInfo probe_sort_info
+
+  // Sort order of the build side. The first ordering expr is the start of the band,
+  // i.e. the bound that the probe key reaches first in the direction of the sweep. The
+  // optional second ordering expr is the end of the band.
+  2: required TSortInfo build_sort_info
+
+  // Tuples materialized by the probe and build side sorts.
+  3: required Types.TTupleId probe_sort_tuple_id
+  4: required Types.TTupleId build_sort_tuple_id
+
+  // True if a probe key that is equal to the start of a band matches it.
+  5: required bool start_inclusive
+
+  // True if a probe key that is equal to the end of a band matches it. Only set if the
+  // band has an end.
+  6: optional bool end_inclusive
+}
+
 enum TSortType {
   // Sort the entire input.
   TOTAL = 0
@@ -716,6 +745,8 @@ struct TPlanNode {
   25: required ResourceProfile.TBackendResourceProfile resource_profile
 
   26: optional TCardinalityCheckNode cardinality_check_node
+
+  28: optional TBandJoinNode band_join_node
 }
 
 // A flattened representation of a tree of PlanNodes, obtained by depth-first
@@ -594,6 +594,42 @@ struct TQueryOptions {
 
   // See comment in ImpalaService.thrift
   147: optional TSchemaResolutionStrategy orc_schema_resolution = 0;
+
+  // See comment in ImpalaService.thrift. LZ4 is used if not set.
+  148: optional CatalogObjects.TCompressionCodec exchange_compression_codec
+
+  // See comment in ImpalaService.thrift
+  149: optional bool adaptive_exchange_compression = false;
+
+  // See comment in ImpalaService.thrift
+  150: optional bool exchange_columnar_format = false;
+
+  // See comment in ImpalaService.thrift
+  151: optional bool sort_normalized_keys = false;
+
+  // See comment in ImpalaService.thrift
+  152: optional bool hash_table_group_probing = false;
+
+  // See comment in ImpalaService.thrift
+  153: optional bool enable_band_join = false;
+
+  // See comment in ImpalaService.thrift
+  154: optional bool vectorized_conjuncts = false;
+
+  // See comment in ImpalaService.thrift
+  155: optional bool spilled_agg_preagg = false;
+
+  // See comment in ImpalaService.thrift
+  156: optional string parquet_write_encodings = "";
+
+  // See comment in ImpalaService.thrift
+  157: optional bool parquet_dictionary_row_filtering = false;
+
+  // See comment in ImpalaService.thrift
+  158: optional bool parquet_split_row_groups = false;
+
+  // See comment in ImpalaService.thrift
+  159: optional bool agg_radix_partitioning = false;
 }
 
 // Impala currently has three types of sessions: Beeswax, HiveServer2 and external
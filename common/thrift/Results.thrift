@@ -44,6 +44,11 @@ struct TRowBatch {
 
   // Indicates the uncompressed size
   6:i32 uncompressed_size
+
+  // If set, tuple_data is in the columnar layout of be/src/runtime/columnar-tuple-data.h
+  // and this is its size before compression. uncompressed_size is still the size of
+  // the row-major tuple data it decodes to.
+  7: optional i64 columnar_size
 }
 
 struct TResultSetMetadata {
@@ -477,6 +477,12 @@ error_codes = (
   ("JWT_VERIFY_FAILED", 154, "Error verifying JWT Token: $0."),
 
   ("PARQUET_ROWS_SKIPPING", 155, "Couldn't skip rows in column '$0' in file '$1'."),
+
+  ("PARQUET_CORRUPT_ENCODED_VALUES", 156, "File '$0' is corrupt: error decoding $1 "
+   "encoded values of column '$2': $3"),
+
+  ("COMPRESSION_INPUT_TOO_LARGE", 157,
+   "The input size is too large for $0 compression: $1"),
 )
 
 import sys
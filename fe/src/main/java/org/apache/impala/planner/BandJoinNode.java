@@ -0,0 +1,386 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+package org.apache.impala.planner;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+
+import org.apache.impala.analysis.Analyzer;
+import org.apache.impala.analysis.BinaryPredicate;
+import org.apache.impala.analysis.Expr;
+import org.apache.impala.analysis.JoinOperator;
+import org.apache.impala.analysis.SlotDescriptor;
+import org.apache.impala.analysis.SlotRef;
+import org.apache.impala.analysis.SortInfo;
+import org.apache.impala.analysis.TupleDescriptor;
+import org.apache.impala.analysis.TupleId;
+import org.apache.impala.catalog.Type;
+import org.apache.impala.common.ImpalaException;
+import org.apache.impala.common.Pair;
+import org.apache.impala.thrift.TBandJoinNode;
+import org.apache.impala.thrift.TExplainLevel;
+import org.apache.impala.thrift.TPlanNode;
+import org.apache.impala.thrift.TPlanNodeType;
+import org.apache.impala.thrift.TQueryOptions;
+import org.apache.impala.thrift.TSortInfo;
+
+import com.google.common.base.MoreObjects;
+import com.google.common.base.Preconditions;
+import com.google.common.collect.Lists;
+
+/**
+ * Inner join whose predicates include one or two inequalities between an expr of the
+ * outer (probe) input and exprs of the inner (build) input that bound a band of probe
+ * values, e.g. 'a.ts BETWEEN b.start_ts AND b.end_ts' or 'a.x > b.y'. Both inputs are
+ * sorted: the probe input by the probe expr and the build input by the bound of the band
+ * that the probe values reach first. The join then sweeps over the sorted inputs and only
+ * compares each build row with the probe rows inside its band, instead of comparing all
+ * pairs of rows like a nested-loop join.
+ *
+ * A band join replaces a NestedLoopJoinNode if the query option ENABLE_BAND_JOIN is set
+ * and the join has a band predicate on a type with a total order. The band predicates
+ * are not evaluated again, all other predicates of the join remain in conjuncts_. This
+ * includes comma joins and cross joins with band predicates in the WHERE clause, which
+ * NestedLoopJoinNode.init() turns into inner joins. Outer, semi and anti joins are not
+ * executed as band joins.
+ *
+ * Each sort materializes all slots of its input into a sort tuple. The BE copies the
+ * sorted tuples back into the tuples of the input, so the output rows have the same
+ * layout as the ones of a nested-loop join and the node keeps the tuple ids of its
+ * children.
+ */
+public class BandJoinNode extends JoinNode {
+  // The inequalities that define the band, in their original form.
+  private final List<Expr> bandPredicates_;
+
+  // The probe expr and the start and optional end of the band over the build input.
+  private final Expr probeExpr_;
+  private final Expr startExpr_;
+  private final Expr endExpr_;
+
+  // True if the probe values are swept in ascending order.
+  private final boolean isAsc_;
+  private final boolean startInclusive_;
+  private final boolean endInclusive_;
+
+  // Set in init().
+  private SortInfo probeSortInfo_;
+  private SortInfo buildSortInfo_;
+
+  /**
+   * A band predicate normalized to '<probeExpr> <op> <buildExpr>'.
+   */
+  private static class BandBound {
+    public final BinaryPredicate pred;
+    public final Expr probeExpr;
+    public final Expr buildExpr;
+    public final BinaryPredicate.Operator op;
+
+    public BandBound(BinaryPredicate pred, Expr probeExpr, Expr buildExpr,
+        BinaryPredicate.Operator op) {
+      this.pred = pred;
+      this.probeExpr = probeExpr;
+      this.buildExpr = buildExpr;
+      this.op = op;
+    }
+
+    // True if the build expr is a lower bound of the probe values.
+    public boolean isLowerBound() {
+      return op == BinaryPredicate.Operator.GT || op == BinaryPredicate.Operator.GE;
+    }
+
+    public boolean isInclusive() {
+      return op == BinaryPredicate.Operator.GE || op == BinaryPredicate.Operator.LE;
+    }
+  }
+
+  private BandJoinNode(NestedLoopJoinNode nlj, BandBound start, BandBound end,
+      List<Expr> conjuncts) {
+    super(nlj.getChild(0), nlj.getChild(1), nlj.isStraightJoin(),
+        nlj.getDistributionModeHint(), JoinOperator.INNER_JOIN,
+        Collections.<BinaryPredicate>emptyList(), Collections.<Expr>emptyList(),
+        "BAND JOIN");
+    bandPredicates_ = new ArrayList<>();
+    bandPredicates_.add(start.pred);
+    if (end != null) bandPredicates_.add(end.pred);
+    probeExpr_ = start.probeExpr;
+    startExpr_ = start.buildExpr;
+    endExpr_ = end == null ? null : end.buildExpr;
+    // A band that is only bounded from above is swept in descending order, starting at
+    // its upper bound.
+    isAsc_ = start.isLowerBound();
+    startInclusive_ = start.isInclusive();
+    endInclusive_ = end != null && end.isInclusive();
+    conjuncts_ = conjuncts;
+  }
+
+  /**
+   * Returns a band join that replaces 'nlj', or null if 'nlj' can't be executed as a band
+   * join. 'nlj' must be initialized. The returned node is initialized.
+   */
+  public static BandJoinNode tryCreate(NestedLoopJoinNode nlj, Analyzer analyzer)
+      throws ImpalaException {
+    if (!analyzer.getQueryOptions().isEnable_band_join()) return null;
+    // A cross join with predicates was already turned into an inner join, a cross join
+    // without predicates has no band.
+    if (nlj.getJoinOp() != JoinOperator.INNER_JOIN) return null;
+    Preconditions.checkState(nlj.getEqJoinConjuncts().isEmpty());
+    if (!nlj.getOtherJoinConjuncts().isEmpty()) return null;
+    if (nlj.getChild(1) instanceof SingularRowSrcNode) return null;
+    for (PlanNode child : nlj.getChildren()) {
+      if (!canSortInput(child, analyzer)) return null;
+    }
+
+    List<TupleId> probeTids = nlj.getChild(0).getTupleIds();
+    List<TupleId> buildTids = nlj.getChild(1).getTupleIds();
+    List<BandBound> bounds = new ArrayList<>();
+    for (Expr conjunct : nlj.getConjuncts()) {
+      BandBound bound = getBandBound(conjunct, probeTids, buildTids);
+      if (bound != null) bounds.add(bound);
+    }
+    if (bounds.isEmpty()) return null;
+
+    // Prefer a band with two bounds on the same probe expr.
+    BandBound start = null;
+    BandBound end = null;
+    for (BandBound lower : bounds) {
+      if (!lower.isLowerBound()) continue;
+      for (BandBound upper : bounds) {
+        if (upper.isLowerBound() || !upper.probeExpr.equals(lower.probeExpr)) continue;
+        start = lower;
+        end = upper;
+        break;
+      }
+      if (start != null) break;
+    }
+    if (start == null) start = bounds.get(0);
+
+    List<Expr> conjuncts = new ArrayList<>();
+    for (Expr conjunct : nlj.getConjuncts()) {
+      if (conjunct != start.pred && (end == null || conjunct != end.pred)) {
+        conjuncts.add(conjunct);
+      }
+    }
+    BandJoinNode result = new BandJoinNode(nlj, start, end, conjuncts);
+    result.init(analyzer);
+    return result;
+  }
+
+  /**
+   * Returns true if the tuples of 'input' can be restored from a sort tuple.
+   */
+  private static boolean canSortInput(PlanNode input, Analyzer analyzer) {
+    // The sort tuple can't represent a NULL tuple.
+    if (!input.getNullableTupleIds().isEmpty()) return false;
+    for (TupleId tid : input.getTupleIds()) {
+      for (SlotDescriptor slot : analyzer.getTupleDesc(tid).getSlots()) {
+        if (slot.isMaterialized() && slot.getType().isComplexType()) return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Returns 'conjunct' as a band bound if it is an inequality between an expr bound by
+   * 'probeTids' and an expr bound by 'buildTids' of a type that can be swept.
+   */
+  private static BandBound getBandBound(Expr conjunct, List<TupleId> probeTids,
+      List<TupleId> buildTids) {
+    if (!(conjunct instanceof BinaryPredicate)) return null;
+    BinaryPredicate pred = (BinaryPredicate) conjunct;
+    BinaryPredicate.Operator op = pred.getOp();
+    if (op != BinaryPredicate.Operator.LT && op != BinaryPredicate.Operator.LE
+        && op != BinaryPredicate.Operator.GT && op != BinaryPredicate.Operator.GE) {
+      return null;
+    }
+    Expr lhs = pred.getChild(0);
+    Expr rhs = pred.getChild(1);
+    if (!lhs.getType().equals(rhs.getType()) || !isSweepableType(lhs.getType())) {
+      return null;
+    }
+    if (isBoundByOnly(lhs, probeTids, buildTids)
+        && isBoundByOnly(rhs, buildTids, probeTids)) {
+      return new BandBound(pred, lhs, rhs, op);
+    }
+    if (isBoundByOnly(rhs, probeTids, buildTids)
+        && isBoundByOnly(lhs, buildTids, probeTids)) {
+      return new BandBound(pred, rhs, lhs, op.converse());
+    }
+    return null;
+  }
+
+  private static boolean isBoundByOnly(Expr e, List<TupleId> tids,
+      List<TupleId> otherTids) {
+    return e.isBoundByTupleIds(tids) && !e.isBoundByTupleIds(otherTids);
+  }
+
+  /**
+   * Returns true if the values of 'type' have a total order that the BE sorts and
+   * compares consistently. Floating point types are excluded because of NaNs and CHAR
+   * because of its padding.
+   */
+  private static boolean isSweepableType(Type type) {
+    if (!type.isScalarType()) return false;
+    switch (type.getPrimitiveType()) {
+      case TINYINT:
+      case SMALLINT:
+      case INT:
+      case BIGINT:
+      case DECIMAL:
+      case DATE:
+      case TIMESTAMP:
+      case STRING:
+      case VARCHAR:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /**
+   * Creates the sort of 'input' by 'sortExprs' that materializes all slots of 'input'.
+   */
+  private static SortInfo createSortInfo(PlanNode input, List<Expr> sortExprs,
+      boolean isAsc, Analyzer analyzer) {
+    // NULLs never match and are sorted last, regardless of the direction.
+    SortInfo sortInfo = new SortInfo(Expr.cloneList(sortExprs),
+        Lists.newArrayList(Collections.nCopies(sortExprs.size(), isAsc)),
+        Lists.newArrayList(Collections.nCopies(sortExprs.size(), false)));
+    List<Expr> inputSlotRefs = new ArrayList<>();
+    for (TupleId tid : input.getTupleIds()) {
+      for (SlotDescriptor slot : analyzer.getTupleDesc(tid).getSlots()) {
+        if (slot.isMaterialized()) inputSlotRefs.add(new SlotRef(slot));
+      }
+    }
+    sortInfo.createSortTupleInfo(inputSlotRefs, analyzer);
+    TupleDescriptor sortTupleDesc = sortInfo.getSortTupleDescriptor();
+    for (SlotDescriptor slot : sortTupleDesc.getSlots()) slot.setIsMaterialized(true);
+    sortTupleDesc.computeMemLayout();
+    return sortInfo;
+  }
+
+  @Override
+  public boolean isBlockingJoinNode() { return true; }
+
+  // The sorts are created for a fixed probe and build input.
+  @Override
+  public boolean isInvertible(boolean isLocalPlan) { return false; }
+
+  @Override
+  public void init(Analyzer analyzer) throws ImpalaException {
+    super.init(analyzer);
+    Preconditions.checkState(eqJoinConjuncts_.isEmpty());
+    Preconditions.checkState(otherJoinConjuncts_.isEmpty());
+    Preconditions.checkState(joinOp_ == JoinOperator.INNER_JOIN);
+    List<Expr> buildExprs = Lists.newArrayList(startExpr_);
+    if (endExpr_ != null) buildExprs.add(endExpr_);
+    probeSortInfo_ =
+        createSortInfo(getChild(0), Lists.newArrayList(probeExpr_), isAsc_, analyzer);
+    buildSortInfo_ = createSortInfo(getChild(1), buildExprs, isAsc_, analyzer);
+    orderJoinConjunctsByCost();
+    computeStats(analyzer);
+  }
+
+  @Override
+  public Pair<ResourceProfile, ResourceProfile> computeJoinResourceProfile(
+      TQueryOptions queryOptions) {
+    // All sorts and streams use a single buffer size that fits the maximum row size.
+    long bufferSize = computeMaxSpillableBufferSize(
+        queryOptions.getDefault_spillable_buffer_size(), queryOptions.getMax_row_size());
+    // Must be kept in sync with BandJoinNode::Prepare() in be: each sorter needs the
+    // min reservation of Sorter::ComputeMinReservation() and the active set needs a
+    // read and a write page.
+    long probeMinReservation =
+        3 * bufferSize * getSortPageMultiplier(probeSortInfo_) + 2 * bufferSize;
+    long buildMinReservation = 3 * bufferSize * getSortPageMultiplier(buildSortInfo_);
+    long probeMemEstimate = estimateInputSize(getChild(0));
+    long buildMemEstimate = estimateInputSize(getChild(1));
+    ResourceProfile probeProfile = new ResourceProfileBuilder()
+        .setMemEstimateBytes(Math.max(probeMemEstimate, probeMinReservation))
+        .setMinMemReservationBytes(probeMinReservation)
+        .setSpillableBufferBytes(bufferSize).setMaxRowBufferBytes(bufferSize).build();
+    ResourceProfile buildProfile = new ResourceProfileBuilder()
+        .setMemEstimateBytes(Math.max(buildMemEstimate, buildMinReservation))
+        .setMinMemReservationBytes(buildMinReservation)
+        .setSpillableBufferBytes(bufferSize).setMaxRowBufferBytes(bufferSize).build();
+    return Pair.create(probeProfile, buildProfile);
+  }
+
+  /**
+   * Returns the factor for the number of pages of a sort, which writes fixed-len and
+   * var-len data into separate pages.
+   */
+  private static int getSortPageMultiplier(SortInfo sortInfo) {
+    return sortInfo.getSortTupleDescriptor().hasVarLenSlots() ? 2 : 1;
+  }
+
+  private long estimateInputSize(PlanNode input) {
+    if (input.getCardinality() == -1 || input.getAvgRowSize() == -1
+        || numNodes_ == 0) {
+      return DEFAULT_PER_INSTANCE_MEM;
+    }
+    return (long) Math.ceil(input.getCardinality() * input.getAvgRowSize());
+  }
+
+  @Override
+  protected String getNodeExplainString(String prefix, String detailPrefix,
+      TExplainLevel detailLevel) {
+    StringBuilder output = new StringBuilder();
+    output.append(String.format("%s%s:%s [%s]\n", prefix, id_.toString(),
+        displayName_, getDisplayLabelDetail()));
+    if (detailLevel.ordinal() >= TExplainLevel.STANDARD.ordinal()) {
+      output.append(detailPrefix + "band predicates: ")
+          .append(Expr.getExplainString(bandPredicates_, detailLevel) + "\n");
+      if (!conjuncts_.isEmpty()) {
+        output.append(detailPrefix + "predicates: ")
+            .append(Expr.getExplainString(conjuncts_, detailLevel) + "\n");
+      }
+    }
+    return output.toString();
+  }
+
+  @Override
+  protected void toThrift(TPlanNode msg) {
+    msg.node_type = TPlanNodeType.BAND_JOIN_NODE;
+    msg.join_node = joinNodeToThrift();
+    TBandJoinNode bandJoinNode = new TBandJoinNode(sortInfoToThrift(probeSortInfo_),
+        sortInfoToThrift(buildSortInfo_),
+        probeSortInfo_.getSortTupleDescriptor().getId().asInt(),
+        buildSortInfo_.getSortTupleDescriptor().getId().asInt(), startInclusive_);
+    if (endExpr_ != null) bandJoinNode.setEnd_inclusive(endInclusive_);
+    msg.band_join_node = bandJoinNode;
+  }
+
+  private static TSortInfo sortInfoToThrift(SortInfo sortInfo) {
+    TSortInfo result = new TSortInfo(Expr.treesToThrift(sortInfo.getSortExprs()),
+        sortInfo.getIsAscOrder(), sortInfo.getNullsFirst(), sortInfo.getSortingOrder());
+    result.setSort_tuple_slot_exprs(
+        Expr.treesToThrift(sortInfo.getMaterializedExprs()));
+    return result;
+  }
+
+  @Override
+  protected String debugString() {
+    return MoreObjects.toStringHelper(this)
+        .add("bandPredicates", Expr.debugString(bandPredicates_))
+        .add("isAsc", isAsc_)
+        .addValue(super.debugString())
+        .toString();
+  }
+}
@@ -117,9 +117,9 @@ public class DistributedPlanner {
       Preconditions.checkState(childFragments.size() == 2);
       result = createHashJoinFragment((HashJoinNode) root,
           childFragments.get(1), childFragments.get(0), fragments);
-    } else if (root instanceof NestedLoopJoinNode) {
+    } else if (root instanceof NestedLoopJoinNode || root instanceof BandJoinNode) {
       Preconditions.checkState(childFragments.size() == 2);
-      result = createNestedLoopJoinFragment((NestedLoopJoinNode) root,
+      result = createNestedLoopJoinFragment((JoinNode) root,
           childFragments.get(1), childFragments.get(0), fragments);
     } else if (root instanceof SubplanNode) {
       Preconditions.checkState(childFragments.size() == 1);
@@ -337,11 +337,11 @@ public class DistributedPlanner {
   }
 
   /**
-   * Modifies the leftChildFragment to execute a cross join. The right child input is
-   * provided by an ExchangeNode, which is the destination of the rightChildFragment's
-   * output.
+   * Modifies the leftChildFragment to execute a cross join or a band join. The right
+   * child input is provided by an ExchangeNode, which is the destination of the
+   * rightChildFragment's output.
    */
-  private PlanFragment createNestedLoopJoinFragment(NestedLoopJoinNode node,
+  private PlanFragment createNestedLoopJoinFragment(JoinNode node,
       PlanFragment rightChildFragment, PlanFragment leftChildFragment,
       List<PlanFragment> fragments) throws ImpalaException {
     node.setDistributionMode(DistributionMode.BROADCAST);
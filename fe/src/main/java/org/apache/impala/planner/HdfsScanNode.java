@@ -854,12 +854,13 @@ public class HdfsScanNode extends ScanNode {
   }
 
   // Try to compute the overlap predicate for the filter. Return true if an overlap
-  // predicate can be formed utilizing the min/max filter 'filter' against the
+  // predicate can be formed utilizing the min/max or bitmap filter 'filter' against the
   // target expr 'targetExpr'. Return false otherwise.
   public Boolean tryToComputeOverlapPredicate(Analyzer analyzer, RuntimeFilter filter,
       Expr targetExpr, boolean isBoundByPartitionColumns) {
-    // This optimization is only valid for min/max filters and Parquet tables.
-    if (filter.getType() != TRuntimeFilterType.MIN_MAX) return false;
+    // This optimization is only valid for min/max and bitmap filters and Parquet tables.
+    boolean isBitmap = filter.getType() == TRuntimeFilterType.BITMAP;
+    if (filter.getType() != TRuntimeFilterType.MIN_MAX && !isBitmap) return false;
     if (!allParquet_) return false;
 
     // The unwrapped targetExpr should refer to a column in the scan node.
@@ -877,7 +878,12 @@ public class HdfsScanNode extends ScanNode {
 
     Column column = slotRefInScan.getDesc().getColumn();
     FeTable table = slotRefInScan.getDesc().getParent().getTable();
-    if (!allowMinMaxFilter(
+    if (isBitmap) {
+      // A bitmap filter is exact, so it is always worth checking against the row group
+      // and page stats of a non-partition column, regardless of the min/max filter
+      // threshold and the sort order of the table.
+      if (column == null || isBoundByPartitionColumns) return false;
+    } else if (!allowMinMaxFilter(
             table, column, analyzer.getQueryOptions(), isBoundByPartitionColumns)) {
       return false;
     }
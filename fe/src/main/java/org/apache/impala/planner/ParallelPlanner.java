@@ -101,7 +101,8 @@ public class ParallelPlanner {
    * in this fragment or the rhs of a SubplanNode.
    */
   private void collectJoins(PlanNode node, List<JoinNode> result) {
-    if (node instanceof JoinNode) {
+    // A band join sorts its build input itself and has no separate build.
+    if (node instanceof JoinNode && !(node instanceof BandJoinNode)) {
       result.add((JoinNode)node);
       // for joins, only descend through the probe side;
       // we're recursively traversing the build side when constructing the build plan
@@ -118,6 +118,12 @@ public final class RuntimeFilterGenerator {
           PrimitiveType.BIGINT, PrimitiveType.DATE, PrimitiveType.STRING,
           PrimitiveType.CHAR, PrimitiveType.VARCHAR));
 
+  // Should be in sync with BitmapFilter::IsSupportedType() in bitmap-filter.cc.
+  private static final Set<PrimitiveType> BITMAP_FILTER_SUPPORTED_TYPES =
+      new HashSet<>(Arrays.asList(
+          PrimitiveType.TINYINT, PrimitiveType.SMALLINT, PrimitiveType.INT,
+          PrimitiveType.BIGINT, PrimitiveType.DATE));
+
   // Map of base table tuple ids to a list of runtime filters that
   // can be applied at the corresponding scan nodes.
   private final Map<TupleId, List<RuntimeFilter>> runtimeFiltersByTid_ =
@@ -388,13 +394,20 @@ public final class RuntimeFilterGenerator {
       Preconditions.checkNotNull(joinPredicate);
       Preconditions.checkNotNull(filterSrcNode);
       // Only consider binary equality predicates under hash joins for runtime bloom
-      // filters and in-list filters.
-      if (type == TRuntimeFilterType.BLOOM || type == TRuntimeFilterType.IN_LIST) {
+      // filters, in-list filters and bitmap filters.
+      if (type == TRuntimeFilterType.BLOOM || type == TRuntimeFilterType.IN_LIST
+          || type == TRuntimeFilterType.BITMAP) {
         if (!Predicate.isEquivalencePredicate(joinPredicate)
             || filterSrcNode instanceof NestedLoopJoinNode) {
           return null;
         }
       }
+      if (type == TRuntimeFilterType.BITMAP) {
+        PrimitiveType lhsType = joinPredicate.getChild(0).getType().getPrimitiveType();
+        PrimitiveType rhsType = joinPredicate.getChild(1).getType().getPrimitiveType();
+        Preconditions.checkState(lhsType == rhsType, "Unanalyzed equivalence pred!");
+        if (!BITMAP_FILTER_SUPPORTED_TYPES.contains(lhsType)) return null;
+      }
       if (type == TRuntimeFilterType.IN_LIST) {
         PrimitiveType lhsType = joinPredicate.getChild(0).getType().getPrimitiveType();
         PrimitiveType rhsType = joinPredicate.getChild(1).getType().getPrimitiveType();
@@ -677,6 +690,8 @@ public final class RuntimeFilterGenerator {
      * the max and minimum filter sizes supplied to it by 'filterSizeLimits'.
      * For min-max filters, we ignore the size since each filter only keeps two values.
      * For in-list filters, the size is calculated based on the data types.
+     * Bitmap filters are given the size of the equivalent bloom filter, which bounds
+     * the range of values they can hold.
      */
     private void calculateFilterSize(FilterSizeLimits filterSizeLimits) {
       if (type_ == TRuntimeFilterType.MIN_MAX) return;
@@ -930,8 +945,9 @@ public final class RuntimeFilterGenerator {
    *    to 'scanNode' if the filter is produced within the same fragment that contains the
    *    scan node.
    * 3. Only Hdfs and Kudu scan nodes are supported:
-   *     a. If the target is an HdfsScanNode, the filter must be type BLOOM/IN_LIST for
-   *        non Parquet tables, or type BLOOM/MIN_MAX/IN_LIST for Parquet tables.
+   *     a. If the target is an HdfsScanNode, the filter must be type
+   *        BLOOM/IN_LIST/BITMAP for non Parquet tables, or type
+   *        BLOOM/MIN_MAX/IN_LIST/BITMAP for Parquet tables.
    *     b. If the target is a KuduScanNode, the filter could be type MIN_MAX, and/or
    *        BLOOM, the target must be a slot ref on a column, and the comp op cannot
    *        be 'not distinct'.
@@ -992,6 +1008,13 @@ public final class RuntimeFilterGenerator {
           if (!((HdfsScanNode) scanNode).getFileFormats().contains(HdfsFileFormat.ORC)) {
             continue;
           }
+        } else if (filter.getType() == TRuntimeFilterType.BITMAP) {
+          // Bitmap filters are applied to rows in all formats. On Parquet tables, also
+          // try to use them to skip row groups and pages via an overlap predicate.
+          if (enable_overlap_filter) {
+            ((HdfsScanNode) scanNode).tryToComputeOverlapPredicate(
+                analyzer, filter, targetExpr, isBoundByPartitionColumns);
+          }
         }
       } else {
         // assign filters to KuduScanNode
@@ -1030,6 +1053,9 @@ public final class RuntimeFilterGenerator {
               || filter.getExprCompOp() == Operator.NOT_DISTINCT) {
             continue;
           }
+        } else if (filter.getType() == TRuntimeFilterType.BITMAP) {
+          // Kudu has no predicate that could be built from a bitmap filter.
+          continue;
         } else {
           Preconditions.checkState(filter.getType() == TRuntimeFilterType.IN_LIST);
           Preconditions.checkState(
@@ -611,13 +611,14 @@ public class SingleNodePlanner {
           break;
         }
 
-        // Always prefer Hash Join over Nested-Loop Join due to limited costing
+        // Always prefer Hash Join over Nested-Loop or Band Join due to limited costing
         // infrastructure.
         if (newRoot == null
             || (candidate.getClass().equals(newRoot.getClass())
                 && candidate.getCardinality() < newRoot.getCardinality())
             || (candidate instanceof HashJoinNode
-                && newRoot instanceof NestedLoopJoinNode)) {
+                && (newRoot instanceof NestedLoopJoinNode
+                    || newRoot instanceof BandJoinNode))) {
           newRoot = candidate;
           minEntry = entry;
         }
@@ -2079,6 +2080,11 @@ public class SingleNodePlanner {
           otherJoinConjuncts);
     }
     result.init(analyzer);
+    if (result instanceof NestedLoopJoinNode) {
+      BandJoinNode bandJoin =
+          BandJoinNode.tryCreate((NestedLoopJoinNode) result, analyzer);
+      if (bandJoin != null) return bandJoin;
+    }
     return result;
   }
 
@@ -20,6 +20,9 @@ package org.apache.impala.planner;
 import static org.junit.Assert.assertEquals;
 
 import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
 
 import org.apache.impala.catalog.Catalog;
 import org.apache.impala.catalog.ColumnStats;
@@ -38,8 +41,13 @@ import org.apache.impala.thrift.TExplainLevel;
 import org.apache.impala.thrift.TExplainResult;
 import org.apache.impala.thrift.TJoinDistributionMode;
 import org.apache.impala.thrift.TKuduReplicaSelection;
+import org.apache.impala.thrift.TOverlapPredicateDesc;
+import org.apache.impala.thrift.TPlanExecInfo;
+import org.apache.impala.thrift.TPlanFragment;
+import org.apache.impala.thrift.TPlanNode;
 import org.apache.impala.thrift.TQueryCtx;
 import org.apache.impala.thrift.TQueryOptions;
+import org.apache.impala.thrift.TRuntimeFilterDesc;
 import org.apache.impala.thrift.TRuntimeFilterMode;
 import org.junit.Assert;
 import org.junit.BeforeClass;
@@ -383,6 +391,13 @@ public class PlannerTest extends PlannerTestBase {
         ImmutableSet.of(PlannerTestOption.VALIDATE_CARDINALITY));
   }
 
+  @Test
+  public void testBandJoins() {
+    TQueryOptions options = defaultQueryOptions();
+    options.setEnable_band_join(true);
+    runPlannerTestFile("band-join", options);
+  }
+
   @Test
   public void testOuterJoins() {
     runPlannerTestFile("outer-joins",
@@ -1008,6 +1023,117 @@ public class PlannerTest extends PlannerTestBase {
     runPlannerTestFile("min-max-runtime-filters", options);
   }
 
+  /**
+   * Plans 'stmt' with 'options' and returns the nodes of the plan by node id.
+   */
+  private Map<Integer, TPlanNode> getPlanNodes(String stmt, TQueryOptions options)
+      throws ImpalaException {
+    TQueryCtx queryCtx = TestUtils.createQueryContext(
+        Catalog.DEFAULT_DB, System.getProperty("user.name"));
+    queryCtx.client_request.setStmt(stmt);
+    queryCtx.client_request.query_options = options;
+    TExecRequest request = frontend_.createExecRequest(new PlanCtx(queryCtx));
+    Map<Integer, TPlanNode> nodes = new HashMap<>();
+    for (TPlanExecInfo execInfo: request.query_exec_request.plan_exec_info) {
+      for (TPlanFragment fragment: execInfo.fragments) {
+        for (TPlanNode node: fragment.plan.nodes) nodes.put(node.node_id, node);
+      }
+    }
+    return nodes;
+  }
+
+  /**
+   * Returns the types of the runtime filters produced or consumed by 'node'.
+   */
+  private static List<TRuntimeFilterType> getFilterTypes(TPlanNode node) {
+    List<TRuntimeFilterType> types = new ArrayList<>();
+    if (node.isSetRuntime_filters()) {
+      for (TRuntimeFilterDesc filter: node.runtime_filters) types.add(filter.type);
+    }
+    return types;
+  }
+
+  /**
+   * Returns the number of overlap predicates of the HDFS scan node 'node'.
+   */
+  private static int getNumOverlapPredicates(TPlanNode node) {
+    Preconditions.checkState(node.isSetHdfs_scan_node());
+    List<TOverlapPredicateDesc> descs = node.hdfs_scan_node.overlap_predicate_descs;
+    return descs == null ? 0 : descs.size();
+  }
+
+  /**
+   * Tests which joins produce bitmap runtime filters, which scans they are assigned to
+   * and on which scans they also get an overlap predicate to skip Parquet row groups
+   * and pages. Node 0 is the probe side scan, node 1 the build side scan and node 2 the
+   * join in all queries.
+   */
+  @Test
+  public void testBitmapRuntimeFilters() throws ImpalaException {
+    TQueryOptions options = defaultQueryOptions();
+    options.setRuntime_filter_mode(TRuntimeFilterMode.GLOBAL);
+    options.unsetEnabled_runtime_filter_types();
+    options.addToEnabled_runtime_filter_types(TRuntimeFilterType.BITMAP);
+    List<TRuntimeFilterType> bitmap = Lists.newArrayList(TRuntimeFilterType.BITMAP);
+
+    // Integer key of a Parquet table: the filter gets an overlap predicate.
+    Map<Integer, TPlanNode> nodes = getPlanNodes("select straight_join count(*) "
+        + "from functional_parquet.alltypes a join functional.alltypestiny b "
+        + "on a.int_col = b.int_col", options);
+    assertEquals(bitmap, getFilterTypes(nodes.get(2)));
+    assertEquals(bitmap, getFilterTypes(nodes.get(0)));
+    assertEquals(1, getNumOverlapPredicates(nodes.get(0)));
+    int filterId = nodes.get(2).runtime_filters.get(0).filter_id;
+    assertEquals(filterId,
+        nodes.get(0).hdfs_scan_node.overlap_predicate_descs.get(0).filter_id);
+
+    // Text tables have no row group stats, so the filter is only applied to rows.
+    nodes = getPlanNodes("select straight_join count(*) "
+        + "from functional.alltypes a join functional.alltypestiny b "
+        + "on a.bigint_col = b.bigint_col", options);
+    assertEquals(bitmap, getFilterTypes(nodes.get(0)));
+    assertEquals(0, getNumOverlapPredicates(nodes.get(0)));
+
+    // Partition columns are filtered by partition, not by row group stats.
+    nodes = getPlanNodes("select straight_join count(*) "
+        + "from functional_parquet.alltypes a join functional.alltypestiny b "
+        + "on a.month = b.month", options);
+    assertEquals(bitmap, getFilterTypes(nodes.get(0)));
+    assertEquals(0, getNumOverlapPredicates(nodes.get(0)));
+
+    // DATE keys are supported.
+    nodes = getPlanNodes("select straight_join count(*) "
+        + "from functional_parquet.date_tbl a join functional.date_tbl b "
+        + "on a.date_col = b.date_col", options);
+    assertEquals(bitmap, getFilterTypes(nodes.get(0)));
+
+    // No bitmap filters for non-integer keys, non-equi joins and Kudu targets.
+    for (String stmt: new String[] {
+        "select straight_join count(*) from functional_parquet.alltypes a "
+            + "join functional.alltypestiny b on a.string_col = b.string_col",
+        "select straight_join count(*) from functional_parquet.alltypes a "
+            + "join functional.alltypestiny b on a.double_col = b.double_col",
+        "select straight_join count(*) from functional_parquet.alltypes a "
+            + "join functional.alltypestiny b on a.int_col < b.int_col",
+        "select straight_join count(*) from functional_kudu.alltypes a "
+            + "join functional.alltypestiny b on a.int_col = b.int_col"}) {
+      nodes = getPlanNodes(stmt, options);
+      assertEquals(stmt, 0, getFilterTypes(nodes.get(0)).size());
+      assertEquals(stmt, 0, getFilterTypes(nodes.get(2)).size());
+    }
+
+    // A bitmap filter is produced next to the other enabled filter types.
+    options.addToEnabled_runtime_filter_types(TRuntimeFilterType.BLOOM);
+    options.addToEnabled_runtime_filter_types(TRuntimeFilterType.MIN_MAX);
+    nodes = getPlanNodes("select straight_join count(*) "
+        + "from functional_parquet.alltypes a join functional.alltypestiny b "
+        + "on a.int_col = b.int_col", options);
+    Assert.assertTrue(getFilterTypes(nodes.get(2)).contains(TRuntimeFilterType.BITMAP));
+    Assert.assertTrue(getFilterTypes(nodes.get(2)).contains(TRuntimeFilterType.BLOOM));
+    Assert.assertTrue(
+        getFilterTypes(nodes.get(2)).contains(TRuntimeFilterType.MIN_MAX));
+  }
+
   @Test
   public void testCardinalityOverflow() throws ImpalaException {
     String tblName = "tpch.cardinality_overflow";
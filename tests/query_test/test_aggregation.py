@@ -18,6 +18,8 @@
 # Validates all aggregate functions across all datatypes
 #
 import pytest
+import re
+from copy import deepcopy
 
 from testdata.common import widetable
 from tests.common.impala_test_suite import ImpalaTestSuite
@@ -499,3 +501,32 @@ class TestTPCHAggregationQueries(ImpalaTestSuite):
 
   def test_min_multiple_distinct(self, vector, unique_database):
     self.run_test_case('min-multiple-distinct-aggs', vector)
+
+  # High-cardinality aggregations whose hash tables outgrow the CPU caches, so that
+  # their input is radix partitioned if AGG_RADIX_PARTITIONING is set.
+  RADIX_PARTITIONING_QUERIES = [
+    """select count(*), sum(c), sum(q) from (
+         select l_orderkey, l_partkey, count(*) c, sum(l_quantity) q
+         from tpch_parquet.lineitem group by 1, 2) v""",
+    # Var-len grouping values and aggregate states.
+    """select count(*), sum(c), sum(length(m)) from (
+         select l_comment, count(*) c, min(l_shipinstruct) m
+         from tpch_parquet.lineitem group by 1) v"""]
+
+  def test_agg_radix_partitioning(self, vector):
+    """Test that aggregations return the same results with and without
+    AGG_RADIX_PARTITIONING, with and without codegen. The hashes of the radix
+    partitioned rows are reused when they are aggregated, so they must match the hashes
+    computed by the codegen'd code."""
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['num_nodes'] = 1
+    for disable_codegen in ['false', 'true']:
+      exec_option['disable_codegen'] = disable_codegen
+      for query in self.RADIX_PARTITIONING_QUERIES:
+        exec_option['agg_radix_partitioning'] = 'false'
+        expected = self.execute_query(query, exec_option)
+        exec_option['agg_radix_partitioning'] = 'true'
+        result = self.execute_query(query, exec_option)
+        assert result.data == expected.data, query
+        assert re.search(r"RowsRadixPartitioned: .* \([1-9][0-9]*\)",
+            result.runtime_profile), query
@@ -23,7 +23,8 @@ from collections import namedtuple
 from datetime import (datetime, date)
 from decimal import Decimal
 from subprocess import check_call
-from parquet.ttypes import ColumnOrder, SortingColumn, TypeDefinedOrder, ConvertedType
+from parquet.ttypes import (ColumnOrder, SortingColumn, TypeDefinedOrder, ConvertedType,
+    Encoding)
 
 from tests.common.environ import impalad_basedir
 from tests.common.impala_test_suite import ImpalaTestSuite
@@ -530,6 +531,53 @@ class TestHdfsParquetTableWriter(ImpalaTestSuite):
     self._ctas_and_check_int64_timestamps(vector, unique_database, tmpdir, "micros")
     self._ctas_and_check_int64_timestamps(vector, unique_database, tmpdir, "nanos")
 
+  def test_write_encodings(self, vector, unique_database, tmpdir):
+    """Tests that PARQUET_WRITE_ENCODINGS writes the requested encodings and that the
+    written files read back the same values as the source table. alltypesagg has NULLs
+    in most columns and the page row count limit makes every column span several
+    pages."""
+    source = "functional.alltypesagg"
+    vector.get_value('exec_option')['parquet_write_encodings'] = (
+        "TINYINT:DELTA_BINARY_PACKED,SMALLINT:DELTA_BINARY_PACKED,"
+        "INT:DELTA_BINARY_PACKED,BIGINT:DELTA_BINARY_PACKED,FLOAT:BYTE_STREAM_SPLIT,"
+        "DOUBLE:BYTE_STREAM_SPLIT,STRING:DELTA_BYTE_ARRAY")
+    vector.get_value('exec_option')['parquet_page_row_count_limit'] = 1000
+    file_metadata = self._ctas_and_get_metadata(vector, unique_database, tmpdir.strpath,
+                                                source, table_name="write_encodings")
+
+    expected_encodings = {
+        "id": Encoding.DELTA_BINARY_PACKED,
+        "tinyint_col": Encoding.DELTA_BINARY_PACKED,
+        "smallint_col": Encoding.DELTA_BINARY_PACKED,
+        "int_col": Encoding.DELTA_BINARY_PACKED,
+        "bigint_col": Encoding.DELTA_BINARY_PACKED,
+        "float_col": Encoding.BYTE_STREAM_SPLIT,
+        "double_col": Encoding.BYTE_STREAM_SPLIT,
+        "date_string_col": Encoding.DELTA_BYTE_ARRAY,
+        "string_col": Encoding.DELTA_BYTE_ARRAY,
+        "day": Encoding.DELTA_BINARY_PACKED}
+    for row_group in file_metadata.row_groups:
+      for column in row_group.columns:
+        col_name = column.meta_data.path_in_schema[0]
+        if col_name not in expected_encodings:
+          continue
+        assert expected_encodings[col_name] in column.meta_data.encodings, col_name
+        assert Encoding.PLAIN_DICTIONARY not in column.meta_data.encodings, col_name
+
+    # Read the values back without the option and compare them with the source.
+    del vector.get_value('exec_option')['parquet_write_encodings']
+    del vector.get_value('exec_option')['parquet_page_row_count_limit']
+    columns = ("id, bool_col, tinyint_col, smallint_col, int_col, bigint_col, "
+               "float_col, double_col, date_string_col, string_col, timestamp_col, "
+               "day")
+    base_result = self.execute_query(
+        "select {0} from {1}".format(columns, source), vector.get_value('exec_option'))
+    test_result = self.execute_query(
+        "select {0} from {1}.write_encodings".format(columns, unique_database),
+        vector.get_value('exec_option'))
+    assert len(test_result.data) == 11000
+    assert sorted(test_result.data) == sorted(base_result.data)
+
   # Skip test for non-HDFS environment as it uses Hive statement.
   # Hive statement is being used as Impala's result are converted
   # by python to string. In both HS2 and beewax, it only handles float
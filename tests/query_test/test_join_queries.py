@@ -18,6 +18,7 @@
 # Targeted tests for Impala joins
 #
 import pytest
+import re
 from copy import deepcopy
 
 from tests.common.impala_test_suite import ImpalaTestSuite
@@ -126,6 +127,52 @@ class TestJoinQueries(ImpalaTestSuite):
     new_vector.get_value('exec_option')['mt_dop'] = vector.get_value('mt_dop')
     self.run_test_case('QueryTest/empty-build-joins', new_vector)
 
+  # Band joins, each checked against the same query executed as a nested-loop join.
+  BAND_JOIN_QUERIES = [
+    # Both bounds with NULL and duplicate keys on both sides.
+    """select a.id, a.k, b.id, b.k
+    from (select id, if(id % 7 = 0, null, smallint_col) k
+          from functional_parquet.alltypesagg where day = 1 and id < 300) a
+    join (select id, if(id % 11 = 0, null, smallint_col) k
+          from functional_parquet.alltypesagg where day = 2) b
+    on a.k >= b.k and a.k < cast(b.k + 3 as smallint)""",
+    # A band that is only bounded from above, with a residual predicate.
+    """select a.id, b.id from functional_parquet.alltypesagg a
+    join functional_parquet.alltypessmall b
+    on a.tinyint_col < b.tinyint_col and a.smallint_col != b.smallint_col
+    where a.day is null""",
+    # Comma join with a BETWEEN predicate on strings in the WHERE clause.
+    """select a.id, b.id
+    from functional_parquet.alltypessmall a, functional_parquet.alltypestiny b
+    where a.string_col between b.string_col and concat(b.string_col, 'z')""",
+    # Exclusive bounds on timestamps.
+    """select a.id, b.id
+    from functional_parquet.alltypes a join functional_parquet.alltypestiny b
+    on a.timestamp_col > b.timestamp_col
+      and a.timestamp_col < b.timestamp_col + interval 1 day""",
+    # Empty build side.
+    """select a.id, b.id from functional_parquet.alltypessmall a
+    join (select * from functional_parquet.alltypestiny where id > 100) b
+    on a.int_col >= b.int_col""",
+    # Empty probe side.
+    """select a.id, b.id
+    from (select * from functional_parquet.alltypestiny where id > 100) a
+    join functional_parquet.alltypessmall b
+    on a.int_col >= b.int_col"""]
+
+  def test_band_joins(self, vector):
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['batch_size'] = vector.get_value('batch_size')
+    exec_option['mt_dop'] = vector.get_value('mt_dop')
+    for query in self.BAND_JOIN_QUERIES:
+      exec_option['enable_band_join'] = 'false'
+      expected = self.execute_query(query, exec_option)
+      assert 'NESTED_LOOP_JOIN_NODE' in expected.runtime_profile
+      exec_option['enable_band_join'] = 'true'
+      result = self.execute_query(query, exec_option)
+      assert 'BAND_JOIN_NODE' in result.runtime_profile, query
+      assert sorted(result.data) == sorted(expected.data), query
+
 class TestTPCHJoinQueries(ImpalaTestSuite):
   # Uses the TPC-H dataset in order to have larger joins. Needed for example to test
   # the repartitioning codepaths.
@@ -156,6 +203,28 @@ class TestTPCHJoinQueries(ImpalaTestSuite):
     new_vector.get_value('exec_option')['batch_size'] = vector.get_value('batch_size')
     self.run_test_case('tpch-outer-joins', new_vector)
 
+  def test_band_join_spilling(self, vector):
+    """Checks a band join whose sorts spill against the same join computed by hash
+    joins on each value of the band."""
+    query = """select count(*), sum(o_orderkey), sum(c_custkey)
+        from tpch_parquet.orders join tpch_parquet.customer
+          on o_custkey >= c_custkey and o_custkey < c_custkey + 2"""
+    expected_query = """select count(*), sum(o_orderkey), sum(c_custkey) from (
+          select o_orderkey, c_custkey from tpch_parquet.orders
+            join tpch_parquet.customer on o_custkey = c_custkey
+          union all
+          select o_orderkey, c_custkey from tpch_parquet.orders
+            join tpch_parquet.customer on o_custkey = c_custkey + 1) v"""
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['batch_size'] = vector.get_value('batch_size')
+    expected = self.execute_query(expected_query, exec_option)
+    exec_option['enable_band_join'] = 'true'
+    exec_option['debug_action'] = '-1:OPEN:SET_DENY_RESERVATION_PROBABILITY@1.0'
+    result = self.execute_query(query, exec_option)
+    assert 'BAND_JOIN_NODE' in result.runtime_profile
+    assert re.search(r'SpilledRuns: [1-9]', result.runtime_profile) is not None
+    assert result.data == expected.data
+
 class TestSemiJoinQueries(ImpalaTestSuite):
   @classmethod
   def get_workload(cls):
@@ -19,6 +19,7 @@
 
 import pytest
 import logging
+import re
 
 from copy import deepcopy
 from tests.common.environ import ImpalaTestClusterProperties, build_flavor_timeout
@@ -27,6 +28,7 @@ from tests.common.impala_test_suite import ImpalaTestSuite
 from tests.common.kudu_test_suite import KuduTestSuite
 from tests.common.skip import SkipIfABFS, SkipIfEC, SkipIfNotHdfsMinicluster
 from tests.common.test_vector import ImpalaTestDimension
+from tests.util.cancel_util import cancel_query_and_validate_state
 from tests.util.filesystem_utils import IS_HDFS
 
 LOG = logging.getLogger('test_mt_dop')
@@ -183,3 +185,81 @@ class TestMtDopScheduling(ImpalaTestSuite):
   def test_scheduling(self, vector):
     vector.get_value('exec_option')['mt_dop'] = vector.get_value('mt_dop')
     self.run_test_case('QueryTest/mt-dop-parquet-scheduling', vector)
+
+
+class TestMtDopParallelJoinBuild(ImpalaTestSuite):
+  """Tests for separate join builds whose hash tables are built in parallel by the
+  probe-side fragment instances that wait for them."""
+  # The broadcast build side has about 600 duplicates per join key, so inserting the rows
+  # allocates duplicate nodes while the hash tables are built in parallel.
+  DUPLICATE_KEYS_QUERY = """
+      select straight_join count(*), sum(l_quantity), sum(s_acctbal)
+      from tpch_parquet.supplier
+        join /* +broadcast */ tpch_parquet.lineitem on s_suppkey = l_suppkey"""
+
+  # Each build task sleeps, so that the probe-side fragment instances are waiting for
+  # the build while there are tasks left.
+  SLOW_BUILD_TASKS = 'PHJ_BUILD_HASH_TABLE_TASK:SLEEP@100'
+
+  @classmethod
+  def get_workload(cls):
+    return 'functional-query'
+
+  @classmethod
+  def add_test_dimensions(cls):
+    super(TestMtDopParallelJoinBuild, cls).add_test_dimensions()
+    cls.ImpalaTestMatrix.add_dimension(ImpalaTestDimension('mt_dop', 2, 8))
+    cls.ImpalaTestMatrix.add_constraint(
+        lambda v: v.get_value('table_format').file_format == 'parquet')
+
+  def _expected_result(self, vector, query):
+    """Returns the result of 'query' without mt_dop, i.e. with an embedded join build."""
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['mt_dop'] = 0
+    return self.execute_query(query, exec_option).data
+
+  def test_duplicate_keys(self, vector):
+    """Test that a build with many duplicate keys returns the right result when its hash
+    tables are built in parallel."""
+    expected = self._expected_result(vector, self.DUPLICATE_KEYS_QUERY)
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['mt_dop'] = vector.get_value('mt_dop')
+    exec_option['debug_action'] = self.SLOW_BUILD_TASKS
+    result = self.execute_query(self.DUPLICATE_KEYS_QUERY, exec_option)
+    assert result.data == expected
+    assert re.search(r"NumHashTablesBuiltByProbeThreads: .* \([1-9][0-9]*\)",
+        result.runtime_profile)
+
+  def test_spilling(self, vector):
+    """Test that a build that spills some of its partitions returns the right result when
+    the hash tables of the other partitions are built in parallel."""
+    expected = self._expected_result(vector, self.DUPLICATE_KEYS_QUERY)
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['mt_dop'] = vector.get_value('mt_dop')
+    exec_option['buffer_pool_limit'] = '100m'
+    result = self.execute_query(self.DUPLICATE_KEYS_QUERY, exec_option)
+    assert result.data == expected
+    assert re.search(r"SpilledPartitions: .* \([1-9][0-9]*\)", result.runtime_profile)
+
+  def test_failed_build_task(self, vector):
+    """Test that an error in a build task that may run on a probe-side thread fails the
+    query."""
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['mt_dop'] = vector.get_value('mt_dop')
+    exec_option['debug_action'] = 'PHJ_BUILD_HASH_TABLE_TASK:FAIL@1.0'
+    result = self.execute_query_expect_failure(
+        self.client, self.DUPLICATE_KEYS_QUERY, exec_option)
+    assert 'PHJ_BUILD_HASH_TABLE_TASK' in str(result)
+
+  def test_cancellation(self, vector):
+    """Test cancelling a query while the hash tables are built in parallel."""
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['mt_dop'] = vector.get_value('mt_dop')
+    exec_option['debug_action'] = 'PHJ_BUILD_HASH_TABLE_TASK:SLEEP@500'
+    for cancel_delay in [1, 3]:
+      cancel_query_and_validate_state(self.client, self.DUPLICATE_KEYS_QUERY,
+          exec_option, None, cancel_delay)
+    # The query still runs after the cancelled builds.
+    expected = self._expected_result(vector, self.DUPLICATE_KEYS_QUERY)
+    del exec_option['debug_action']
+    assert self.execute_query(self.DUPLICATE_KEYS_QUERY, exec_option).data == expected
@@ -35,3 +35,8 @@ class TestParquetLateMaterialization(ImpalaTestSuite):
 
   def test_parquet_late_materialization(self, vector):
     self.run_test_case('QueryTest/parquet-late-materialization', vector)
+
+  def test_parquet_dictionary_row_filtering(self, vector, unique_database):
+    vector.get_value('exec_option')['parquet_dictionary_row_filtering'] = True
+    self.run_test_case('QueryTest/parquet-dictionary-row-filtering', vector,
+        unique_database)
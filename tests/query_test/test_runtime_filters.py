@@ -170,6 +170,54 @@ class TestRuntimeFilters(ImpalaTestSuite):
                                    new_vector.get_value('exec_option'))
     assert re.search("Splits rejected: [^0] \([^0]\)", result.runtime_profile) is not None
 
+  def test_late_arriving_filter_queued_batches(self, vector):
+    """Test that a filter that arrives after the scan has queued up row batches is applied
+    to those batches when they are dequeued, and that the filtered rows are counted
+    only once in the filter statistics."""
+    table_format = vector.get_value('table_format')
+    if table_format.file_format not in ['parquet', 'text']:
+      pytest.skip("Only HDFS tables are scanned with a row batch queue")
+    if vector.get_value('mt_dop') != 0:
+      pytest.skip("Scans with mt_dop > 0 do not queue row batches")
+    self.change_database(self.client, table_format)
+    exec_options = deepcopy(vector.get_value('exec_option'))
+    exec_options['runtime_filter_mode'] = 'GLOBAL'
+    exec_options['runtime_filter_wait_time_ms'] = 0
+    exec_options['batch_size'] = 100
+    # Slow down the consumer of the alltypes scan so that its scanner threads fill the
+    # row batch queue before the filter from the slow build side arrives.
+    exec_options['debug_action'] = '0:GETNEXT:DELAY@300'
+    result = self.execute_query("""select straight_join count(*) from alltypes
+                                   join /*+shuffle*/
+                                     (select distinct id from alltypessmall
+                                      where sleep(30)) v
+                                   on v.id = alltypes.id""", exec_options)
+    assert result.data == ['100']
+    profile = result.runtime_profile
+    assert re.search(r"RowsRejectedByLateRuntimeFilters: [1-9]", profile) is not None
+    # Only the alltypes scan has a filter. Every row that it scanned was evaluated
+    # against the filter at most once, either by a scanner or when it was dequeued, and
+    # each of its 24 single-split files was counted at most once.
+    assert 0 < self._sum_instance_counters(profile, "Rows total") <= 7300
+    assert self._sum_instance_counters(profile, "Splits total") <= 24
+
+  def _sum_instance_counters(self, profile, name):
+    """Returns the sum of the counters called 'name' in the fragment instance profiles,
+    skipping the averaged fragment profiles."""
+    total = 0
+    in_instance = False
+    for line in profile.splitlines():
+      line = line.strip()
+      if line.startswith("Instance "):
+        in_instance = True
+      elif line.startswith("Averaged Fragment") or line.startswith("Fragment ") \
+          or line.startswith("Coordinator Fragment"):
+        in_instance = False
+      elif in_instance:
+        match = re.match(r"- %s: (?:\S+ \()?(\d+)\)?$" % name, line)
+        if match: total += int(match.group(1))
+    return total
+
 
 @SkipIfLocal.multiple_impalad
 class TestBloomFilters(ImpalaTestSuite):
@@ -360,6 +408,27 @@ class TestInListFilters(ImpalaTestSuite):
     self.run_test_case('QueryTest/in_list_filters', vector)
 
 
+class TestBitmapFilters(ImpalaTestSuite):
+  @classmethod
+  def get_workload(cls):
+    return 'functional-query'
+
+  @classmethod
+  def add_test_dimensions(cls):
+    super(TestBitmapFilters, cls).add_test_dimensions()
+    # Bitmap filters skip row groups on Parquet. The test also covers a text table.
+    cls.ImpalaTestMatrix.add_constraint(
+        lambda v: v.get_value('table_format').file_format in ['parquet'])
+    # Enable query option ASYNC_CODEGEN for slow build
+    if build_runs_slowly:
+      add_exec_option_dimension(cls, "async_codegen", 1)
+
+  def test_bitmap_filters(self, vector):
+    vector.get_value('exec_option')['enabled_runtime_filter_types'] = 'bitmap'
+    vector.get_value('exec_option')['runtime_filter_wait_time_ms'] = WAIT_TIME_MS
+    self.run_test_case('QueryTest/bitmap_filters', vector)
+
+
 # Apply Bloom filter, Minmax filter and IN-list filters
 class TestAllRuntimeFilters(ImpalaTestSuite):
   @classmethod
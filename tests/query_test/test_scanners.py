@@ -392,6 +392,10 @@ class TestParquet(ImpalaTestSuite):
   def test_parquet(self, vector):
     self.run_test_case('QueryTest/parquet', vector)
 
+  def test_split_row_groups(self, vector, unique_database):
+    create_table_from_parquet(self.client, unique_database, 'alltypes_invalid_pages')
+    self.run_test_case('QueryTest/parquet-split-row-groups', vector, unique_database)
+
   def test_corrupt_files(self, vector):
     new_vector = deepcopy(vector)
     del new_vector.get_value('exec_option')['num_nodes']  # .test file sets num_nodes
@@ -481,6 +485,15 @@ class TestParquet(ImpalaTestSuite):
     assert len(result.data) == 1
     assert "4294967294" in result.data
 
+  def test_delta_and_byte_stream_split_encodings(self, vector, unique_database):
+    """Tests scanning a file written by an external writer with DELTA_BINARY_PACKED,
+    DELTA_LENGTH_BYTE_ARRAY, DELTA_BYTE_ARRAY and BYTE_STREAM_SPLIT pages that contain
+    NULLs and span several pages per column."""
+    create_table_from_parquet(self.client, unique_database,
+        "parquet_delta_and_byte_stream_split")
+    self.run_test_case('QueryTest/parquet-delta-and-byte-stream-split', vector,
+        unique_database)
+
   @SkipIfABFS.hive
   @SkipIfADLS.hive
   @SkipIfIsilon.hive
@@ -16,6 +16,7 @@
 # under the License.
 
 import pytest
+import re
 from copy import deepcopy
 
 from tests.common.environ import ImpalaTestClusterProperties
@@ -133,6 +134,83 @@ class TestSpillingNoDebugActionDimensions(ImpalaTestSuite):
        These tests either run with no debug action set or set their own debug action."""
     self.run_test_case('QueryTest/spilling-no-debug-action', vector)
 
+  # Queries for test_spilled_agg_preagg(), each with regexes that the profile must
+  # match with SPILLED_AGG_PREAGG enabled.
+  SPILLED_AGG_PREAGG_QUERIES = [
+    # lineitem is clustered by l_orderkey, so each group has two runs of rows far apart
+    # and is spilled as several partial aggregates. The spilled partitions are too
+    # large for the minimum reservation and are repartitioned.
+    ("""select count(*), sum(c), sum(q), sum(p), sum(a) from (
+          select l_orderkey % 3000000 k, count(*) c, sum(l_quantity) q,
+            min(l_partkey) p, avg(l_extendedprice) a
+          from tpch_parquet.lineitem group by 1) v""",
+     [r"SpillCacheInputRows: .* \([1-9][0-9]*\)",
+      r"NumRepartitions: .* \([1-9][0-9]*\)"]),
+    # Aggregate functions with a serialize step.
+    ("""select count(*), sum(c), sum(n), sum(length(g)) from (
+          select l_orderkey % 3000000 k, count(*) c, ndv(l_partkey) n,
+            group_concat(l_shipmode) g
+          from tpch_parquet.lineitem group by 1) v""",
+     [r"SpillCacheInputRows: .* \([1-9][0-9]*\)"]),
+    # lineitem is not clustered by l_partkey, so the cache does not reduce the bytes
+    # spilled and the partitions fall back to spilling unaggregated rows.
+    ("""select count(*), sum(c), sum(q) from (
+          select l_partkey, count(*) c, sum(l_quantity) q
+          from tpch_parquet.lineitem group by 1) v""",
+     [r"SpillCachesDisabled: .* \([1-9][0-9]*\)"])]
+
+  def test_spilled_agg_preagg(self, vector):
+    """Test that spilled aggregations return the same results with and without
+    SPILLED_AGG_PREAGG, with partitions that spill partial aggregates, get
+    repartitioned, or turn the partial aggregation off."""
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['num_nodes'] = 1
+    exec_option['debug_action'] = '-1:OPEN:SET_DENY_RESERVATION_PROBABILITY@1.0'
+    for query, profile_regexes in self.SPILLED_AGG_PREAGG_QUERIES:
+      exec_option['spilled_agg_preagg'] = 'false'
+      expected = self.execute_query(query, exec_option)
+      exec_option['spilled_agg_preagg'] = 'true'
+      result = self.execute_query(query, exec_option)
+      assert result.data == expected.data, query
+      assert re.search(r"SpilledPartitions: .* \([1-9][0-9]*\)",
+          result.runtime_profile), query
+      for regex in profile_regexes:
+        assert re.search(regex, result.runtime_profile), (query, regex)
+
+  def test_spilled_agg_preagg_no_mem(self, vector):
+    """Test that the spill caches are turned off instead of failing the query when
+    their memory, which is not part of the reservation, can not be allocated."""
+    query, _ = self.SPILLED_AGG_PREAGG_QUERIES[0]
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['num_nodes'] = 1
+    exec_option['debug_action'] = '-1:OPEN:SET_DENY_RESERVATION_PROBABILITY@1.0'
+    exec_option['spilled_agg_preagg'] = 'false'
+    expected = self.execute_query(query, exec_option)
+    exec_option['debug_action'] += '|AGG_SPILL_CACHE_NO_MEM:FAIL'
+    exec_option['spilled_agg_preagg'] = 'true'
+    result = self.execute_query(query, exec_option)
+    assert result.data == expected.data
+    assert re.search(r"SpillCachesDisabled: .* \([1-9][0-9]*\)", result.runtime_profile)
+    assert re.search(r"SpillCacheOutputRows: 0 \(0\)", result.runtime_profile)
+
+  def test_spilled_agg_radix_partitioning(self, vector):
+    """Test that an aggregation that radix partitions its input and then spills returns
+    the same results as without AGG_RADIX_PARTITIONING. The buffer pool limit leaves
+    room for the hash tables to outgrow the CPU caches before they are spilled."""
+    query = """select count(*), sum(c), sum(q) from (
+                 select l_orderkey, l_partkey, count(*) c, sum(l_quantity) q
+                 from tpch_parquet.lineitem group by 1, 2) v"""
+    exec_option = deepcopy(vector.get_value('exec_option'))
+    exec_option['num_nodes'] = 1
+    exec_option['buffer_pool_limit'] = '100m'
+    exec_option['agg_radix_partitioning'] = 'false'
+    expected = self.execute_query(query, exec_option)
+    exec_option['agg_radix_partitioning'] = 'true'
+    result = self.execute_query(query, exec_option)
+    assert result.data == expected.data
+    assert re.search(r"RowsRadixPartitioned: .* \([1-9][0-9]*\)", result.runtime_profile)
+    assert re.search(r"SpilledPartitions: .* \([1-9][0-9]*\)", result.runtime_profile)
+
 
 @pytest.mark.xfail(IMPALA_TEST_CLUSTER_PROPERTIES.is_remote_cluster(),
                    reason='Queries may not spill on larger clusters')